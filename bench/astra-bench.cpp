@@ -0,0 +1,521 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+// Host-side microbenchmarks.  Each benchmark drives the real library code
+// against MockUSBDevice, which accepts every write and answers like a device
+// that never fails, so the numbers are the host's own overhead per operation.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cxxopts.hpp>
+
+#include "astra_boot_image.hpp"
+#include "astra_device.hpp"
+#include "astra_log.hpp"
+#include "boot_image_collection.hpp"
+#include "boot_packet_cache.hpp"
+#include "fastboot_device.hpp"
+#include "image.hpp"
+#include "image_store.hpp"
+#include "usb_device.hpp"
+
+namespace {
+
+constexpr size_t kImageSize = 32 * 1024 * 1024;
+// Same block size as the SL16XX image send loop.
+constexpr size_t kImageBlockSize = (1 * 1024 * 1024) + 4;
+constexpr size_t kCollectionSize = 64;
+constexpr size_t kCollectionFilesPerImage = 6;
+
+// Zero status in the host header, then one spare word for the ROM variants
+// that append one (see GetBootloaderVersion).  Raw, sized and version
+// requests all accept this reply.
+const std::vector<uint8_t> kSL26XXResponse = {
+    0x5B, 0x5A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+};
+
+std::atomic<size_t> g_sink{0};
+
+/**
+ * USBDevice that discards bulk data and answers from memory.  Every flush
+ * delivers the configured response as an interrupt event, and ReadBulk()
+ * answers fastboot commands with DATA or OKAY.
+ */
+class MockUSBDevice : public USBDevice {
+public:
+    MockUSBDevice(uint16_t vendorId = 0, uint16_t productId = 0, uint8_t numInterfaces = 0)
+        : USBDevice("bench"), m_vendorId(vendorId), m_productId(productId), m_numInterfaces(numInterfaces)
+    {}
+
+    ~MockUSBDevice() override
+    {
+        Close();
+    }
+
+    void SetResponse(const std::vector<uint8_t> &response) { m_response = response; }
+
+    int Open(std::function<void(USBEvent event, uint8_t *buf, size_t size)> usbEventCallback) override
+    {
+        m_usbEventCallback = usbEventCallback;
+        return 0;
+    }
+
+    void Close() override
+    {
+        if (m_callbackThreadRunning.exchange(false)) {
+            WakeCallbackWorker();
+            if (m_callbackThread.joinable()) {
+                m_callbackThread.join();
+            }
+        }
+    }
+
+    int Write(uint8_t *data, size_t size, int *transferred) override
+    {
+        m_command.assign(reinterpret_cast<const char *>(data), size);
+        *transferred = static_cast<int>(size);
+        return 0;
+    }
+
+    int WriteQueued(const uint8_t * /*data*/, size_t /*size*/) override { return 0; }
+
+    int FlushQueuedWrites() override
+    {
+        if (!m_response.empty()) {
+            QueueCallbackEvent(USB_DEVICE_EVENT_INTERRUPT, m_response.data(), m_response.size());
+        }
+        return 0;
+    }
+
+    int ReadBulk(uint8_t *data, size_t size, int *transferred, int /*timeoutMs*/) override
+    {
+        std::string response = "OKAY";
+        if (m_command.rfind("download:", 0) == 0) {
+            response = "DATA" + m_command.substr(9);
+        }
+        m_command.clear();
+
+        const size_t length = std::min(size, response.size());
+        std::copy(response.begin(), response.begin() + length, data);
+        *transferred = static_cast<int>(length);
+        return 0;
+    }
+
+    int WriteInterruptData(const uint8_t * /*data*/, size_t /*size*/) override { return 0; }
+
+    uint16_t GetVendorId() const override { return m_vendorId; }
+    uint16_t GetProductId() const override { return m_productId; }
+    uint8_t GetNumInterfaces() const override { return m_numInterfaces; }
+
+private:
+    uint16_t m_vendorId;
+    uint16_t m_productId;
+    uint8_t m_numInterfaces;
+    std::vector<uint8_t> m_response;
+    std::string m_command;
+};
+
+struct BenchContext {
+    std::filesystem::path workDir;
+    std::filesystem::path imagePath;
+    std::filesystem::path collectionPath;
+    std::shared_ptr<ImageStore> imageStore = std::make_shared<ImageStore>();
+    std::shared_ptr<const ImageMapping> imageMapping;
+    std::shared_ptr<AstraBootImage> sl26xxBootImage;
+    std::shared_ptr<BootPacketCache> bootPacketCache = std::make_shared<BootPacketCache>();
+};
+
+struct Benchmark {
+    std::string name;
+    uint64_t bytesPerOp;
+    std::function<void(BenchContext &context, size_t iterations)> run;
+};
+
+// Pseudo-random contents so no size or zero-block shortcut applies.
+void WriteTestFile(const std::filesystem::path &path, size_t size, uint32_t seed)
+{
+    std::vector<uint8_t> data(size);
+    uint32_t state = seed * 2654435761U + 1;
+    for (uint8_t &byte : data) {
+        state = state * 1664525U + 1013904223U;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to write " + path.string());
+    }
+}
+
+void WriteManifest(const std::filesystem::path &dir, const std::string &manifest)
+{
+    std::ofstream file(dir / "manifest.yaml", std::ios::trunc);
+    file << manifest;
+    if (!file) {
+        throw std::runtime_error("Failed to write manifest in " + dir.string());
+    }
+}
+
+void CreateFixtures(BenchContext &context)
+{
+    std::filesystem::remove_all(context.workDir);
+    std::filesystem::create_directories(context.workDir);
+
+    context.imagePath = context.workDir / "image.bin";
+    WriteTestFile(context.imagePath, kImageSize, 1);
+    context.imageMapping = context.imageStore->Acquire(context.imagePath.string());
+    if (context.imageMapping == nullptr) {
+        throw std::runtime_error("Failed to map " + context.imagePath.string());
+    }
+
+    const std::filesystem::path sl26xxPath = context.workDir / "sl2610-boot";
+    std::filesystem::create_directories(sl26xxPath);
+    WriteManifest(sl26xxPath,
+        "id: bench-sl2610\n"
+        "chip: sl2610\n"
+        "board: bench\n"
+        "console: usb\n"
+        "uenv_support: false\n"
+        "vendor_id: \"06CB\"\n"
+        "product_id: \"019E\"\n"
+        "sysmgr_vendor_id: \"06CB\"\n"
+        "sysmgr_product_id: \"02A0\"\n"
+        "secure_boot: genx\n"
+        "memory_layout: 2gb\n"
+        "uboot: suboot\n");
+    WriteTestFile(sl26xxPath / "key.bin", 2 * 1024, 2);
+    WriteTestFile(sl26xxPath / "spk.bin", 64 * 1024, 3);
+    WriteTestFile(sl26xxPath / "m52bl.bin", 128 * 1024, 4);
+    WriteTestFile(sl26xxPath / "sysmgr.subimg", 1024 * 1024, 5);
+
+    context.sl26xxBootImage = std::make_shared<AstraBootImage>(sl26xxPath.string());
+    if (!context.sl26xxBootImage->Load()) {
+        throw std::runtime_error("Failed to load " + sl26xxPath.string());
+    }
+
+    context.collectionPath = context.workDir / "boot-images";
+    for (size_t i = 0; i < kCollectionSize; ++i) {
+        const std::filesystem::path dir = context.collectionPath / ("sl1680-board" + std::to_string(i));
+        std::filesystem::create_directories(dir);
+        std::ostringstream productId;
+        productId << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << (0x0100 + i);
+        WriteManifest(dir,
+            "id: sl1680-board" + std::to_string(i) + "\n"
+            "chip: sl1680\n"
+            "board: board" + std::to_string(i) + "\n"
+            "console: uart\n"
+            "uenv_support: true\n"
+            "vendor_id: \"06CB\"\n"
+            "product_id: \"" + productId.str() + "\"\n"
+            "secure_boot: genx\n"
+            "memory_layout: " + (i % 2 ? "2gb" : "4gb") + "\n"
+            "uboot: suboot\n");
+        for (size_t file = 0; file < kCollectionFilesPerImage; ++file) {
+            WriteTestFile(dir / ("image" + std::to_string(file) + ".bin"), 4096, static_cast<uint32_t>(i + file));
+        }
+    }
+
+    // Leave the index in place for the indexed load benchmark.
+    BootImageCollection collection(context.collectionPath.string());
+    collection.Load();
+}
+
+// Read an image with GetDataBlock() straight into transfer buffers, as the
+// SL16XX image send loop does.
+void SendImageBlocks(Image &image, USBDevice &device)
+{
+    if (image.Load() < 0) {
+        throw std::runtime_error("Failed to load " + image.GetPath());
+    }
+
+    size_t sent = 0;
+    while (sent < image.GetSize()) {
+        const size_t blockSize = std::min(kImageBlockSize, image.GetSize() - sent);
+        uint8_t *block = device.AcquireWriteBuffer(blockSize);
+        const int length = image.GetDataBlock(block, blockSize);
+        if (length <= 0) {
+            device.CommitQueuedWrite(0);
+            throw std::runtime_error("Failed to read " + image.GetPath());
+        }
+        device.CommitQueuedWrite(static_cast<size_t>(length));
+        sent += static_cast<size_t>(length);
+    }
+    device.FlushQueuedWrites();
+}
+
+void BenchImageFile(BenchContext &context, size_t iterations)
+{
+    MockUSBDevice device;
+    for (size_t i = 0; i < iterations; ++i) {
+        Image image(context.imagePath.string(), ASTRA_IMAGE_TYPE_UPDATE_EMMC);
+        SendImageBlocks(image, device);
+    }
+}
+
+void BenchImageMapped(BenchContext &context, size_t iterations)
+{
+    MockUSBDevice device;
+    for (size_t i = 0; i < iterations; ++i) {
+        Image image(context.imagePath.string(), ASTRA_IMAGE_TYPE_UPDATE_EMMC);
+        image.SetMapping(context.imageMapping);
+        SendImageBlocks(image, device);
+    }
+}
+
+void BenchFastbootStageFile(BenchContext &context, size_t iterations)
+{
+    MockUSBDevice device;
+    FastBootDevice fastboot(&device);
+    if (!fastboot.Open()) {
+        throw std::runtime_error("Failed to open fastboot device");
+    }
+
+    for (size_t i = 0; i < iterations; ++i) {
+        if (!fastboot.StageFile(context.imagePath.string())) {
+            throw std::runtime_error("StageFile failed");
+        }
+    }
+}
+
+void BenchFastbootStageData(BenchContext &context, size_t iterations)
+{
+    MockUSBDevice device;
+    FastBootDevice fastboot(&device);
+    if (!fastboot.Open()) {
+        throw std::runtime_error("Failed to open fastboot device");
+    }
+
+    for (size_t i = 0; i < iterations; ++i) {
+        if (!fastboot.StageData(context.imageMapping->GetData(), context.imageMapping->GetSize())) {
+            throw std::runtime_error("StageData failed");
+        }
+    }
+}
+
+// One SL26XX session per iteration, including opening and closing the mock
+// device.  Boot packets come from a shared cache as in the device manager.
+void RunSL26XXBoot(BenchContext &context, size_t iterations, uint16_t productId, uint8_t numInterfaces,
+    AstraDeviceBootStage bootStage, int expected)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        auto usbDevice = std::make_unique<MockUSBDevice>(0x06CB, productId, numInterfaces);
+        usbDevice->SetResponse(kSL26XXResponse);
+
+        AstraDevice device(std::move(usbDevice), context.workDir.string(), true, "", ASTRA_SERIES_SL26XX);
+        device.SetImageStore(context.imageStore);
+        device.SetBootPacketCache(context.bootPacketCache);
+        const int ret = device.Boot(context.sl26xxBootImage, bootStage);
+        if (ret != expected) {
+            throw std::runtime_error("SL26XX boot returned " + std::to_string(ret));
+        }
+    }
+}
+
+void BenchSL26XXSysMgrVersion(BenchContext &context, size_t iterations)
+{
+    // A device enumerating as SysMgr only answers the version request.
+    RunSL26XXBoot(context, iterations, 0x02A0, 1, ASTRA_DEVICE_BOOT_STAGE_SYSMGR, 0);
+}
+
+void BenchSL26XXRunSpk(BenchContext &context, size_t iterations)
+{
+    RunSL26XXBoot(context, iterations, 0x019E, 2, ASTRA_DEVICE_BOOT_STAGE_AUTO, 1);
+}
+
+void BenchSL26XXRunSm(BenchContext &context, size_t iterations)
+{
+    RunSL26XXBoot(context, iterations, 0x019E, 1, ASTRA_DEVICE_BOOT_STAGE_AUTO, 1);
+}
+
+// The log store runs at INFO, so DEBUG messages are filtered and INFO
+// messages are formatted and written.
+void BenchLogDisabled(BenchContext & /*context*/, size_t iterations)
+{
+    ASTRA_LOG;
+
+    const std::string imageName = "sysmgr.subimg";
+    for (size_t i = 0; i < iterations; ++i) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Sending block " << static_cast<int>(i) << " of " << imageName << endLog;
+    }
+}
+
+void BenchLogEnabled(BenchContext & /*context*/, size_t iterations)
+{
+    ASTRA_LOG;
+
+    const std::string imageName = "sysmgr.subimg";
+    for (size_t i = 0; i < iterations; ++i) {
+        log(ASTRA_LOG_LEVEL_INFO) << "Sending block " << static_cast<int>(i) << " of " << imageName << endLog;
+    }
+    AstraLogStore::getInstance().Flush();
+}
+
+void BenchLogScope(BenchContext & /*context*/, size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        ASTRA_LOG;
+    }
+}
+
+void BenchLogFormat(BenchContext & /*context*/, size_t iterations)
+{
+    const std::string message = "Device status: ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS Progress: 42";
+    for (size_t i = 0; i < iterations; ++i) {
+        g_sink += AstraLog::FormatLog(ASTRA_LOG_LEVEL_INFO, __FUNCTION__, message).size();
+    }
+}
+
+void BenchCollectionLoad(BenchContext &context, size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        // Drop the collection's manifest index (BootImageCollection::kIndexFileName).
+        std::filesystem::remove(context.collectionPath / ".boot_image_index");
+        BootImageCollection collection(context.collectionPath.string());
+        collection.Load();
+        g_sink += collection.GetDeviceIDs().size();
+    }
+}
+
+void BenchCollectionLoadIndexed(BenchContext &context, size_t iterations)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        BootImageCollection collection(context.collectionPath.string());
+        collection.Load();
+        g_sink += collection.GetDeviceIDs().size();
+    }
+}
+
+// Run benchmark with doubling iteration counts until one run lasts minSeconds.
+void RunBenchmark(const Benchmark &benchmark, BenchContext &context, double minSeconds)
+{
+    constexpr size_t kMaxIterations = 1000000000;
+
+    size_t iterations = 1;
+    double elapsed = 0;
+    for (;;) {
+        const auto start = std::chrono::steady_clock::now();
+        benchmark.run(context, iterations);
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= minSeconds || iterations >= kMaxIterations) {
+            break;
+        }
+
+        // Aim just past minSeconds, growing at most tenfold per run.
+        const double scale = elapsed > 0 ? (minSeconds * 1.2) / elapsed : 10.0;
+        iterations = std::min(kMaxIterations,
+            std::max(iterations + 1, static_cast<size_t>(static_cast<double>(iterations) * std::min(scale, 10.0))));
+    }
+
+    const double nsPerOp = elapsed * 1e9 / static_cast<double>(iterations);
+    std::cout << std::left << std::setw(36) << benchmark.name << std::right
+        << std::setw(12) << iterations
+        << std::setw(16) << std::fixed << std::setprecision(1) << nsPerOp << " ns/op";
+    if (benchmark.bytesPerOp > 0) {
+        const double megabytesPerSecond = static_cast<double>(benchmark.bytesPerOp) * iterations / elapsed / 1e6;
+        std::cout << std::setw(12) << std::setprecision(1) << megabytesPerSecond << " MB/s";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("AstraBench", "Astra Update host-side microbenchmarks");
+
+    options.add_options()
+        ("h,help", "Print usage")
+        ("l,list", "List benchmarks without running them", cxxopts::value<bool>()->default_value("false"))
+        ("t,min-time", "Minimum run time per benchmark in seconds", cxxopts::value<double>()->default_value("0.5"))
+        ("T,temp-dir", "Directory for generated test images", cxxopts::value<std::string>()->default_value(""))
+        ("filter", "Run only benchmarks whose name contains this string", cxxopts::value<std::string>()->default_value(""));
+
+    options.parse_positional({"filter"});
+
+    cxxopts::ParseResult result;
+    try {
+        result = options.parse(argc, argv);
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    const std::vector<Benchmark> benchmarks = {
+        {"image/get-data-block/file", kImageSize, BenchImageFile},
+        {"image/get-data-block/mapped", kImageSize, BenchImageMapped},
+        {"fastboot/stage-file", kImageSize, BenchFastbootStageFile},
+        {"fastboot/stage-data", kImageSize, BenchFastbootStageData},
+        {"sl26xx/sysmgr-version", 0, BenchSL26XXSysMgrVersion},
+        {"sl26xx/run-spk", 0, BenchSL26XXRunSpk},
+        {"sl26xx/run-sm", 0, BenchSL26XXRunSm},
+        {"log/debug-disabled", 0, BenchLogDisabled},
+        {"log/info", 0, BenchLogEnabled},
+        {"log/scope", 0, BenchLogScope},
+        {"log/format", 0, BenchLogFormat},
+        {"boot-image-collection/load", 0, BenchCollectionLoad},
+        {"boot-image-collection/load-indexed", 0, BenchCollectionLoadIndexed},
+    };
+
+    const std::string filter = result["filter"].as<std::string>();
+    std::vector<const Benchmark *> selected;
+    for (const Benchmark &benchmark : benchmarks) {
+        if (benchmark.name.find(filter) != std::string::npos) {
+            selected.push_back(&benchmark);
+        }
+    }
+
+    if (result["list"].as<bool>()) {
+        for (const Benchmark *benchmark : selected) {
+            std::cout << benchmark->name << std::endl;
+        }
+        return 0;
+    }
+
+    const std::string tempDir = result["temp-dir"].as<std::string>();
+    const std::filesystem::path workDir = tempDir.empty() ? std::filesystem::temp_directory_path() / "astra-bench" :
+        std::filesystem::path(tempDir);
+
+    BenchContext context;
+    context.workDir = workDir;
+
+    int ret = 0;
+    try {
+        CreateFixtures(context);
+        AstraLogStore::getInstance().Open((context.workDir / "astra-bench.log").string(), ASTRA_LOG_LEVEL_INFO);
+
+        const double minSeconds = result["min-time"].as<double>();
+        for (const Benchmark *benchmark : selected) {
+            RunBenchmark(*benchmark, context, minSeconds);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        ret = 1;
+    }
+
+    AstraLogStore::getInstance().Close();
+    // Release the mappings before deleting the files behind them.
+    context = BenchContext();
+    std::error_code ec;
+    std::filesystem::remove_all(workDir, ec);
+
+    return ret;
+}
@@ -3,9 +3,13 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <memory>
 #include <cstdint>
 #include <functional>
+#include <string>
+#include <vector>
 
 #include "flash_image.hpp"
 
@@ -45,6 +49,15 @@ class USBDevice;
 class AstraBootImage;
 class AstraDeviceManagerResponse;
 class AstraDeviceImpl;
+class ImageStore;
+class ImageBroadcast;
+class DeviceScheduler;
+class BootPacketCache;
+class ResponseTimes;
+class EventExecutor;
+class TransferTuner;
+class UpdateCheckpoints;
+class BootSessions;
 
 class AstraDevice
 {
@@ -81,6 +94,63 @@ public:
         std::function<void(const std::string &)> registerFn,
         std::function<void(const std::string &)> unregisterFn);
 
+    /**
+     * Share a process-wide image store so every device maps each boot and
+     * update file once instead of re-reading it.
+     */
+    void SetImageStore(std::shared_ptr<ImageStore> imageStore);
+
+    /**
+     * Share the manager's image broadcast so a compressed update image sent
+     * to several devices at once is decompressed once for all of them.
+     */
+    void SetImageBroadcast(std::shared_ptr<ImageBroadcast> imageBroadcast);
+
+    /**
+     * Share the manager's boot packet cache so devices booted from the same
+     * boot image reuse one set of framed ROM boot packets.
+     */
+    void SetBootPacketCache(std::shared_ptr<BootPacketCache> bootPacketCache);
+
+    /**
+     * Share the manager's response times so boot handshake timeouts are
+     * learned from the devices which answered before.
+     */
+    void SetResponseTimes(std::shared_ptr<ResponseTimes> responseTimes);
+
+    /**
+     * Share the manager's event executor, which delivers the USB events of
+     * all devices on one small pool of threads.
+     */
+    void SetEventExecutor(std::shared_ptr<EventExecutor> eventExecutor);
+
+    /**
+     * Share the manager's scheduler; the impl takes a transfer slot from it
+     * before serving update images.
+     */
+    void SetDeviceScheduler(std::shared_ptr<DeviceScheduler> scheduler);
+
+    /** Share the manager's transfer tuner, which picks how update images are sent. */
+    void SetTransferTuner(std::shared_ptr<TransferTuner> transferTuner);
+
+    /** Share the manager's update checkpoints, so an interrupted update can resume. */
+    void SetUpdateCheckpoints(std::shared_ptr<UpdateCheckpoints> updateCheckpoints);
+
+    /**
+     * Share the manager's record of the session UUIDs it wrote, and name the
+     * job this device is booted for, so a board is only taken to be running
+     * this job's update script if one of them was written for it.
+     */
+    void SetBootSessions(std::shared_ptr<BootSessions> bootSessions, const std::string &job);
+
+    /**
+     * Wait at most this long for each image request before checking whether
+     * the device has finished or stalled in its boot.
+     */
+    void SetImageRequestTimeout(std::chrono::seconds timeout);
+
+    static constexpr std::chrono::seconds kDefaultImageRequestTimeout{10};
+
     static const std::string AstraDeviceStatusToString(AstraDeviceStatus status);
     static const std::string AstraDeviceSeriesToString(AstraDeviceSeries series);
     static AstraDeviceBootStage BootStageFromString(const std::string &stage);
@@ -97,3 +167,80 @@ struct DeviceResponse
     std::string m_imageName;
     std::string m_message;
 };
+
+struct ImageTransferStats
+{
+    std::string m_imageName;
+    uint64_t m_bytes = 0;
+    double m_seconds = 0.0;                 // image request received until the send completed
+    double m_firstWriteLatencyMs = -1.0;    // image request received until the first USB write; -1 if none
+    bool m_skipped = false;                 // delta update: payload not sent
+
+    double GetMBps() const { return m_seconds > 0.0 ? static_cast<double>(m_bytes) / m_seconds / 1e6 : 0.0; }
+};
+
+/**
+ * Transfer counters for one device, reported once when the device reaches
+ * a final boot / update status.
+ */
+struct DeviceTransferStats
+{
+    static constexpr size_t kLatencyBucketCount = 24;
+
+    std::string m_deviceName;
+    uint64_t m_bytesSent = 0;
+    double m_transferSeconds = 0.0;         // sum of per-image send times
+    double m_wallSeconds = 0.0;             // first image request until the last send completed
+    std::vector<ImageTransferStats> m_images;
+
+    // SL26XX: fb_exit until the re-enumerated fastboot device was rebound.
+    unsigned m_rebindCount = 0;
+    double m_rebindSeconds = 0.0;           // sum over all rebinds
+    double m_maxRebindSeconds = 0.0;
+    std::vector<double> m_rebindDurations;  // each rebind, in seconds
+
+    // Bucket i counts USB write completions that took [2^i, 2^(i+1))
+    // microseconds.  The last bucket is open-ended.
+    std::array<uint64_t, kLatencyBucketCount> m_writeLatencyHistogram{};
+
+    double GetMBps() const
+    {
+        return m_transferSeconds > 0.0 ? static_cast<double>(m_bytesSent) / m_transferSeconds / 1e6 : 0.0;
+    }
+
+    /** @return the upper bound in microseconds of the bucket holding the given percentile (0-100). */
+    uint64_t GetWriteLatencyPercentileUs(double percentile) const
+    {
+        uint64_t total = 0;
+        for (uint64_t count : m_writeLatencyHistogram) {
+            total += count;
+        }
+        if (total == 0) {
+            return 0;
+        }
+
+        const double target = static_cast<double>(total) * percentile / 100.0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < m_writeLatencyHistogram.size(); ++i) {
+            seen += m_writeLatencyHistogram[i];
+            if (static_cast<double>(seen) >= target) {
+                return 1ULL << (i + 1);
+            }
+        }
+        return 1ULL << kLatencyBucketCount;
+    }
+};
+
+/**
+ * Update-phase traffic of every device that shared one USB hub (or root
+ * port), as accounted by the manager's device scheduler.
+ */
+struct BusTransferStats
+{
+    std::string m_hub;                      // "<bus>-<port chain>" of the hub, or "<bus>" for root ports
+    size_t m_devices = 0;                   // update sessions admitted on this hub
+    uint64_t m_bytes = 0;
+    double m_busySeconds = 0.0;             // time at least one device on the hub was updating
+
+    double GetMBps() const { return m_busySeconds > 0.0 ? static_cast<double>(m_bytes) / m_busySeconds / 1e6 : 0.0; }
+};
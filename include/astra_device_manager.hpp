@@ -26,6 +26,20 @@ enum AstraDeviceManangerMode {
     ASTRA_DEVICE_MANAGER_MODE_UPDATE,
 };
 
+// Simulated boards, served instead of real USB devices so the host side can
+// be exercised at scale.  A zero m_deviceCount disables the simulator.
+struct AstraSimulatorConfig
+{
+    unsigned m_deviceCount = 0;                 // boards plugged in at start
+    unsigned m_devicesPerHub = 7;               // boards sharing one simulated hub
+    unsigned m_cycles = 1;                      // boards run on each port, one after another
+    double m_linkMBps = 40.0;                   // bulk OUT bandwidth per board, 0 for unlimited
+    double m_hubMBps = 0.0;                     // bandwidth shared by the boards on a hub, 0 for unlimited
+    unsigned m_latencyUs = 200;                 // device response latency
+    unsigned m_resetMs = 100;                   // time for a board to reset and enumerate again
+    unsigned m_interruptImage = 0;              // fastboot boards drop off once while sent this update image, 0 for never
+};
+
 class AstraDeviceManager {
 public:
     AstraDeviceManager(std::function<void(AstraDeviceManagerResponse)> responseCallback,
@@ -34,14 +48,140 @@ public:
         const std::string &logPath = "",
         const std::string &tempDir = "",
         const std::string &filterPorts = "",
-        bool usbDebug = false
+        bool usbDebug = false,
+        bool trace = false,
+        bool mergeDeviceLogs = false,
+        unsigned maxActiveTransfers = 0,
+        unsigned maxTransfersPerHub = 0
     );
     ~AstraDeviceManager();
 
+    /** Serve simulated boards instead of USB devices.  Call before Update() or Boot(). */
+    void SetSimulator(const AstraSimulatorConfig &config);
+
+    /** Only serve devices on these ports, as for filterPorts, from the next Update() or Boot() on. */
+    void SetFilterPorts(const std::string &filterPorts);
+
+    /**
+     * Deliver image send progress for each device at most every milliseconds
+     * (100 by default; 0 for every update).  Responses are delivered on a
+     * dispatch thread, so a slow callback does not hold up the devices;
+     * progress updates it has not caught up with are merged, other
+     * responses are never dropped.
+     */
+    void SetProgressInterval(unsigned milliseconds);
+
+    /**
+     * Tune the bulk write chunk size and write queue depth per protocol and
+     * USB hub: the first large update images try the candidates in turn,
+     * then the fastest is kept and saved to statePath (a per-user file for
+     * this host if empty) for later runs.  Call before Update() or Boot().
+     */
+    void EnableTransferTuning(const std::string &statePath = "");
+
+    /**
+     * Checkpoint each update image a board acknowledges, by the session UUID
+     * it reports.  A board that comes back within windowSeconds of its last
+     * checkpoint, in this run or a later one, skips the images it already
+     * holds.  Checkpoints are saved to statePath (a per-user file for this
+     * host if empty).  Call before Update().
+     */
+    void EnableUpdateResume(unsigned windowSeconds, const std::string &statePath = "");
+
+    /**
+     * Share budgetBytes of host memory for transfer buffers between the
+     * devices in their update phase.  A device whose buffers do not fit in
+     * what is left waits for others to finish; one needing more than the
+     * whole budget runs alone.  Call before Update().
+     */
+    void SetTransferMemoryBudget(uint64_t budgetBytes);
+
+    /**
+     * Wait at most seconds for a device's next image request (10 by
+     * default).  A device still booting then fails; one which has finished
+     * is let go.  This is only a safety net: the requests normally end with
+     * the final image or a disconnect.  Call before Update() or Boot().
+     */
+    void SetImageRequestTimeout(unsigned seconds);
+
+    /**
+     * Decompress each compressed update image once for all the devices
+     * sending it at the same time, instead of once per device.  A device
+     * more than slackBytes behind the fastest one goes on reading the image
+     * on its own.  Call before Update().
+     */
+    void EnableImageBroadcast(uint64_t slackBytes);
+
+    /**
+     * Count the calls and time spent in each instrumented function, on all
+     * threads, and write the totals as astra_profile.txt next to the log
+     * file at Shutdown().  Call before Update() or Boot().
+     */
+    void EnableProfiling();
+
+    /**
+     * Serve station metrics in Prometheus text format on address:
+     * "[host]:port" for HTTP over TCP, or a Unix domain socket path.  The
+     * metrics are built from the responses the manager delivers, plus the
+     * USB hub traffic at scrape time.  Call before Update() or Boot().
+     * @return false if the address cannot be listened on.
+     */
+    bool EnableMetrics(const std::string &address);
+
     void Update(std::shared_ptr<FlashImage> flashImage, std::string bootImagePath);
     void Boot(std::string bootImagesPath, std::string bootCommand = "", AstraDeviceBootStage bootStage = ASTRA_DEVICE_BOOT_STAGE_AUTO);
+
+    /**
+     * Start updating the devices on filterPorts (all ports if empty) with
+     * flashImage, alongside the jobs already running.  Update() and Boot()
+     * start a job too.  A device goes to the job that expects its boot ROM
+     * VID:PID and names the most specific of its ports, so jobs for
+     * different chips can share ports.  Jobs share the USB transports, image
+     * store and device threads.  Two jobs for the same chip on the same
+     * ports are rejected, as is a second job in the simulator.
+     * @param responseCallback  Receives this job's responses instead of the
+     *                          manager's callback, if set.
+     * @return the job ID for EndJob().
+     */
+    int AddUpdateJob(std::shared_ptr<FlashImage> flashImage, std::string bootImagesPath,
+        const std::string &filterPorts = "",
+        std::function<void(AstraDeviceManagerResponse)> responseCallback = nullptr);
+
+    /**
+     * Close the job's devices and wait for their threads.  Other jobs keep
+     * running.  Not to be called from a response callback.
+     * @return true if a failure was reported during the job.
+     */
+    bool EndJob(int jobId);
+
+    /**
+     * End every job and keep the manager ready for the next one: the log,
+     * temp directory, boot image collection and, when the next job needs
+     * the same devices and ports, the USB transports stay open.  Devices
+     * arriving while no job wants them are held for the next one.
+     * @return true if a failure was reported during any of the jobs.
+     */
+    bool EndRun();
+
     bool Shutdown();
     std::string GetLogFile() const;
+    std::string GetTraceFile() const;
+    std::string GetProfileFile() const;
+
+    /** @return update throughput aggregated per USB hub, for libusb devices. */
+    std::vector<BusTransferStats> GetBusTransferStats() const;
+
+    /**
+     * Set the priority and CPUs of the library's threads by role, e.g.
+     * "usb=realtime:2,3;transfer=high:0-3;background=normal".  Roles are
+     * usb (USB event and CDC I/O threads), transfer (device flows, image
+     * decompression and digests) and background (logging, enumeration,
+     * metrics, response delivery); priorities normal, high and realtime.
+     * Applies to every manager in the process; set it before constructing
+     * one, as running threads keep the policy they started with.
+     * @return false with error set if spec is malformed.
+     */
+    static bool SetThreadPolicy(const std::string &spec, std::string &error);
 
     static std::string GetVersion() {
         return ASTRA_DEVICE_MANAGER_VERSION;
@@ -59,7 +199,7 @@ struct ManagerResponse {
 
 class AstraDeviceManagerResponse {
 public:
-    using ResponseVariant = std::variant<ManagerResponse, DeviceResponse>;
+    using ResponseVariant = std::variant<ManagerResponse, DeviceResponse, DeviceTransferStats>;
 
     AstraDeviceManagerResponse(ManagerResponse managerResponse)
         : response(managerResponse) {}
@@ -67,6 +207,9 @@ public:
         AstraDeviceManagerResponse(DeviceResponse deviceResponse)
         : response(deviceResponse) {}
 
+    AstraDeviceManagerResponse(DeviceTransferStats deviceStats)
+        : response(std::move(deviceStats)) {}
+
     bool IsDeviceManagerResponse() const {
         return std::holds_alternative<ManagerResponse>(response);
     }
@@ -75,6 +218,10 @@ public:
         return std::holds_alternative<DeviceResponse>(response);
     }
 
+    bool IsDeviceStatsResponse() const {
+        return std::holds_alternative<DeviceTransferStats>(response);
+    }
+
     const ManagerResponse& GetDeviceManagerResponse() const {
         return std::get<ManagerResponse>(response);
     }
@@ -83,6 +230,10 @@ public:
         return std::get<DeviceResponse>(response);
     }
 
+    const DeviceTransferStats& GetDeviceStatsResponse() const {
+        return std::get<DeviceTransferStats>(response);
+    }
+
 private:
     ResponseVariant response;
 };
@@ -9,6 +9,12 @@
 #include <memory>
 #include <mutex>
 #include <iomanip>
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <vector>
+
+#include "astra_profile.hpp"
 
 enum AstraLogLevel {
     ASTRA_LOG_LEVEL_TRACE,
@@ -19,27 +25,82 @@ enum AstraLogLevel {
     ASTRA_LOG_LEVEL_NONE
 };
 
+// Levels below this are compiled out of ASTRA_LOG_ENABLED() checks and of the
+// ASTRA_LOG enter/exit trace, e.g. -DASTRA_LOG_COMPILE_MIN_LEVEL=ASTRA_LOG_LEVEL_INFO.
+#ifndef ASTRA_LOG_COMPILE_MIN_LEVEL
+#define ASTRA_LOG_COMPILE_MIN_LEVEL ASTRA_LOG_LEVEL_TRACE
+#endif
+
 class AstraLog {
 public:
-    std::ostringstream m_os;
-    std::string m_funcName;
+    std::optional<std::ostringstream> m_os;
+    const char *m_funcName;
     AstraLogLevel m_logLevel;
+    bool m_enabled = false;
+
+    AstraLog(const char *funcName) : m_funcName{funcName}, m_logLevel{ASTRA_LOG_LEVEL_NONE}
+    {
+        if (IsEnabled(ASTRA_LOG_LEVEL_TRACE)) {
+            LogTrace("-> Entering");
+        }
+    }
+
+    ~AstraLog()
+    {
+        if (IsEnabled(ASTRA_LOG_LEVEL_TRACE)) {
+            LogTrace("<- Exiting");
+        }
+    }
+
+    // Messages below the active level skip formatting entirely.
+    AstraLog & operator()(AstraLogLevel level) {
+        m_logLevel = level;
+        m_enabled = IsEnabled(level);
+        if (m_enabled && !m_os) {
+            m_os.emplace();
+        }
+        return *this;
+    }
+
+    AstraLog & operator<<(const char *str) {
+        if (m_enabled) {
+            *m_os << str;
+        }
+        return *this;
+    }
+
+    AstraLog & operator<<(const std::string &str) {
+        if (m_enabled) {
+            *m_os << str;
+        }
+        return *this;
+    }
 
-    AstraLog(const std::string &funcName);
-    ~AstraLog();
+    AstraLog & operator<<(int val) {
+        if (m_enabled) {
+            *m_os << val;
+        }
+        return *this;
+    }
 
-    AstraLog & operator()(AstraLogLevel level);
-    AstraLog & operator<<(const char *str);
-    AstraLog & operator<<(const std::string &str);
-    AstraLog & operator<<(int val);
-    AstraLog & operator<<(unsigned int val);
+    AstraLog & operator<<(unsigned int val) {
+        if (m_enabled) {
+            *m_os << val;
+        }
+        return *this;
+    }
 
     template <typename T>
     AstraLog & operator<<(T manupulator) {
-        m_os << manupulator;
+        if (m_enabled) {
+            *m_os << manupulator;
+        }
         return *this;
     }
 
+    static bool IsEnabled(AstraLogLevel level);
+    void LogTrace(const char *message);
+
     static AstraLogLevel StringToLevel(const std::string &level);
     static std::string LevelToString(AstraLogLevel level);
     static std::string FormatLog(AstraLogLevel level, const
@@ -47,28 +108,63 @@ public:
 
 };
 
+#define ASTRA_LOG_ENABLED(level) AstraLog::IsEnabled(level)
+
 AstraLog & endLog(AstraLog &log);
 AstraLog & operator<<(AstraLog &log, AstraLog &(*finalizeLog)(AstraLog &));
 
+class AstraLogSink;
+
+// Log records are queued in a bounded ring and written in batches by a single
+// writer thread, so device and libusb threads never block on file I/O unless
+// the ring is full.  Threads bound to a device sink (see SetThreadSink) log to
+// that device's own file instead of the shared one.
 class AstraLogStore {
 public:
     static AstraLogStore& getInstance();
     void Log(AstraLogLevel level, const std::string& message);
     AstraLogLevel GetMinLogLevel() const { return m_minLogLevel; }
+
+    // Readable without the singleton so disabled levels cost one relaxed load.
+    static inline std::atomic<int> s_activeMinLogLevel{ASTRA_LOG_LEVEL_NONE};
     void Open(const std::string &logPath, AstraLogLevel minLogLevel);
+    // Block until every queued record has been written and flushed.
+    void Flush();
     void Close();
     ~AstraLogStore();
 
+    // Give each device its own log file; optionally copy device records into
+    // the main log, prefixed with the device name.
+    void EnableDeviceLogs(bool mergeIntoMainLog);
+    // @return nullptr unless device logs are enabled.
+    std::shared_ptr<AstraLogSink> OpenDeviceLog(const std::string &deviceName, const std::string &logPath);
+    // Route records from the calling thread to sink (nullptr for the main log).
+    static void SetThreadSink(std::shared_ptr<AstraLogSink> sink);
+
 private:
     AstraLogStore();
     AstraLogStore(const AstraLogStore&) = delete;
     AstraLogStore& operator=(const AstraLogStore&) = delete;
 
-    std::unique_ptr<std::ostream> m_logStream;
-    std::ofstream m_logFile;
-    AstraLogLevel m_minLogLevel;
+    static void TerminateHandler();
+
+    AstraLogLevel m_minLogLevel = ASTRA_LOG_LEVEL_NONE;
+    std::atomic<bool> m_deviceLogsEnabled{false};
+    std::atomic<bool> m_mergeDeviceLogs{false};
+    std::mutex m_sinksMutex;
+    std::shared_ptr<AstraLogSink> m_mainSink;   // accessed with std::atomic_load/store
+    std::vector<std::weak_ptr<AstraLogSink>> m_deviceSinks;
+    std::terminate_handler m_previousTerminateHandler = nullptr;
+    static thread_local std::shared_ptr<AstraLogSink> t_threadSink;
     static std::unique_ptr<AstraLogStore> instance;
     static std::once_flag initInstanceFlag;
 };
 
-#define ASTRA_LOG AstraLog log(__FUNCTION__)
\ No newline at end of file
+// Also profiles the function; see AstraProfileStore.
+#define ASTRA_LOG ASTRA_PROFILE; AstraLog log(__FUNCTION__)
+
+inline bool AstraLog::IsEnabled(AstraLogLevel level)
+{
+    return level >= ASTRA_LOG_COMPILE_MIN_LEVEL &&
+        static_cast<int>(level) >= AstraLogStore::s_activeMinLogLevel.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Define to compile ASTRA_PROFILE (and the profiling half of ASTRA_LOG) out entirely.
+// #define ASTRA_PROFILE_COMPILED_OUT
+
+/** One instrumented code location, a function-local static registered on first use. */
+struct AstraProfileSite {
+    AstraProfileSite(const char *function, const char *file, int line);
+
+    const char *m_function;
+    const char *m_file;
+    int m_line;
+    uint32_t m_index;
+};
+
+/**
+ * Function-level profiler.  When opened, every ASTRA_PROFILE scope adds its
+ * duration to a call count, total and maximum kept per site in a buffer of
+ * the calling thread, so recording takes no lock and no shared cache line.
+ * Close() merges the buffers of all threads, including those which already
+ * exited, and writes a table sorted by total time.  When not opened, a scope
+ * costs a relaxed atomic load.
+ */
+class AstraProfileStore {
+public:
+    static AstraProfileStore& getInstance();
+    ~AstraProfileStore();
+
+    void Open(const std::string &profilePath);
+    void Close();
+
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    std::string GetProfilePath() const { return m_profilePath; }
+
+    uint32_t RegisterSite(const AstraProfileSite *site);
+    static void Record(const AstraProfileSite &site, uint64_t durationNs);
+
+private:
+    AstraProfileStore() = default;
+    AstraProfileStore(const AstraProfileStore&) = delete;
+    AstraProfileStore& operator=(const AstraProfileStore&) = delete;
+
+    static constexpr uint32_t kSitesPerChunk = 256;
+    static constexpr uint32_t kMaxChunks = 64;
+
+    // Written only by the owning thread; atomics so Close() may read them.
+    struct Counter {
+        std::atomic<uint64_t> m_calls{0};
+        std::atomic<uint64_t> m_totalNs{0};
+        std::atomic<uint64_t> m_maxNs{0};
+    };
+
+    struct Totals {
+        uint64_t m_calls = 0;
+        uint64_t m_totalNs = 0;
+        uint64_t m_maxNs = 0;
+    };
+
+    // Counters are allocated a chunk of sites at a time, on first use.
+    struct ThreadCounters {
+        ~ThreadCounters();
+        std::array<std::atomic<Counter *>, kMaxChunks> m_chunks{};
+    };
+
+    // Hands a thread's counters back to the store when the thread exits.
+    struct ThreadHandle {
+        ~ThreadHandle();
+        ThreadCounters *m_counters = nullptr;
+    };
+
+    static ThreadCounters *AdoptThread();
+    void RetireThread(ThreadCounters *counters);
+    static void Accumulate(const ThreadCounters &counters, std::vector<Totals> &totals);
+
+    static inline std::atomic<bool> s_enabled{false};
+    std::string m_profilePath;
+    std::chrono::steady_clock::time_point m_origin;
+    std::mutex m_mutex;
+    std::vector<const AstraProfileSite *> m_sites;
+    std::vector<ThreadCounters *> m_threads;
+    std::vector<Totals> m_retired;
+    static thread_local ThreadHandle t_thread;
+    static std::unique_ptr<AstraProfileStore> instance;
+    static std::once_flag initInstanceFlag;
+};
+
+/** Times its own lifetime against site if profiling was enabled when it started. */
+class AstraProfileScope {
+public:
+    explicit AstraProfileScope(const AstraProfileSite &site) : m_site{site}
+    {
+        if (AstraProfileStore::IsEnabled()) {
+            m_active = true;
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~AstraProfileScope()
+    {
+        if (m_active) {
+            AstraProfileStore::Record(m_site, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count()));
+        }
+    }
+
+    AstraProfileScope(const AstraProfileScope&) = delete;
+    AstraProfileScope& operator=(const AstraProfileScope&) = delete;
+
+private:
+    const AstraProfileSite &m_site;
+    bool m_active = false;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Profile the enclosing function.  ASTRA_LOG already does this, so use it
+// only in functions which do not log.
+#if defined(ASTRA_PROFILE_COMPILED_OUT)
+#define ASTRA_PROFILE do {} while (0)
+#else
+#define ASTRA_PROFILE \
+    static const AstraProfileSite astraProfileSite{__FUNCTION__, __FILE__, __LINE__}; \
+    AstraProfileScope astraProfileScope{astraProfileSite}
+#endif
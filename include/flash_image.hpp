@@ -4,12 +4,15 @@
 #pragma once
 
 #include <string>
+#include <future>
 #include <memory>
 #include <vector>
 #include <map>
 
 #include "image.hpp"
 
+class FlashImageBundle;
+
 enum FlashImageType {
     FLASH_IMAGE_TYPE_UNKNOWN,
     FLASH_IMAGE_TYPE_SPI,
@@ -26,7 +29,9 @@ public:
         m_chipName{chipName}, m_boardName{boardName}, m_secureBootVersion{secureBootVersion}, m_memoryLayout{memoryLayout}, m_memoryDDRType{memoryDDRType}, m_resetWhenComplete{resetWhenComplete}, m_manifestMaps{std::move(manifestMaps)}
     {}
     virtual ~FlashImage()
-    {}
+    {
+        WaitForPreprocessing();
+    }
 
     virtual int Load() = 0;
 
@@ -34,17 +39,42 @@ public:
     std::string GetChipName() const { return m_chipName; }
     std::string GetBoardName() const { return m_boardName; }
     std::string GetFlashCommand() const { return m_flashCommand; }
+    const std::string &GetImagePath() const { return m_imagePath; }
     const std::string &GetFinalImage() const { return m_finalImage; }
+    // Image names in the order the device is expected to request them (may be empty).
+    const std::vector<std::string> &GetImageOrder() const { return m_imageOrder; }
     AstraSecureBootVersion GetSecureBootVersion() const { return m_secureBootVersion; }
     AstraMemoryLayout GetMemoryLayout() const { return m_memoryLayout; }
     AstraMemoryDDRType GetMemoryDDRType() const { return m_memoryDDRType; }
-    const std::vector<Image>& GetImages() const { return m_images; }
+    // Waits for the preprocessing Load() started in the background, if any.
+    const std::vector<Image>& GetImages() const { WaitForPreprocessing(); return m_images; }
     FlashImageType GetFlashImageType() const { return m_flashImageType; }
     bool GetResetWhenComplete() const { return m_resetWhenComplete; }
+    bool GetDeltaUpdate() const { return m_deltaUpdate; }
+    void SetDeltaUpdate(bool deltaUpdate) { m_deltaUpdate = deltaUpdate; }
+    bool GetVerifyUpdate() const { return m_verifyUpdate; }
+    void SetVerifyUpdate(bool verifyUpdate) { m_verifyUpdate = verifyUpdate; }
+    // Set when the image path is a single-file bundle rather than a directory.
+    const std::shared_ptr<const FlashImageBundle> &GetBundle() const { return m_bundle; }
+    void SetBundle(std::shared_ptr<const FlashImageBundle> bundle) { m_bundle = std::move(bundle); }
+
+    /**
+     * Pack the loaded eMMC image into the single-file bundle bundlePath,
+     * which FlashImageFactory() loads like an image directory.
+     * @return false with error set on failure.
+     */
+    bool WriteBundle(const std::string &bundlePath, std::string &error) const;
 
     static std::shared_ptr<FlashImage> FlashImageFactory(std::string imagePath, std::map<std::string, std::string> &config, std::string manifest="");
 
 protected:
+    // Read the images on a pool of threads while the caller goes on, e.g.
+    // to enumerate and boot devices: digest them for delta and verified
+    // updates and map the uniform blocks of raw eMMC images, reusing what
+    // the image index of their directory already holds.  Called at the end
+    // of a successful Load().
+    void StartPreprocessing();
+
     FlashImageType m_flashImageType;
     std::string m_bootImageId;
     std::string m_chipName;
@@ -56,9 +86,23 @@ protected:
     std::vector<Image> m_images;
     std::string m_flashCommand;
     std::string m_finalImage;
+    std::vector<std::string> m_imageOrder;
     std::unique_ptr<std::vector<std::map<std::string, std::string>>> m_manifestMaps;
     bool m_resetWhenComplete = true;
+    bool m_deltaUpdate = false;
+    bool m_verifyUpdate = false;
+    std::shared_ptr<const FlashImageBundle> m_bundle;
     const std::string m_resetCommand = "; sleep 1; reset"; // sleep before resetting to let console messages be sent to the host
+
+private:
+    void WaitForPreprocessing() const
+    {
+        if (m_preprocessing.valid()) {
+            m_preprocessing.wait();
+        }
+    }
+
+    std::shared_future<void> m_preprocessing;
 };
 
 struct ChipDetectionResult {
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <filesystem>
 
@@ -36,36 +38,102 @@ enum AstraImageType {
     ASTRA_IMAGE_TYPE_UPDATE_NAND,
 };
 
+enum AstraImageCompression {
+    ASTRA_IMAGE_COMPRESSION_NONE,
+    ASTRA_IMAGE_COMPRESSION_GZIP,
+    ASTRA_IMAGE_COMPRESSION_ZSTD,
+};
+
 enum AstraTransportType {
     ASTRA_TRANSPORT_USB,
     ASTRA_TRANSPORT_USB_CDC,
 };
 
+class ImageDecompressor;
+class ImageMapping;
+struct UniformBlockMap;
+
 class Image
 {
 public:
     Image(std::string imagePath, AstraImageType imageType) : m_imagePath{imagePath}, m_imageSize{0},
         m_imageType{imageType}, m_fp{nullptr}
     {
-        m_imageName = std::filesystem::path(m_imagePath).filename().string();
+        m_compression = CompressionFromPath(m_imagePath);
+        m_imageName = NameFromPath(m_imagePath, m_compression);
     }
+    // Copies share the memory mapping (if any) but never the FILE handle or
+    // decompressor; each copy opens its own in Load().
     Image(const Image &other) : m_imagePath{other.m_imagePath}, m_imageName{other.m_imageName},
-        m_imageSize{other.m_imageSize}, m_imageType{other.m_imageType}, m_fp{other.m_fp}
+        m_imageSize{other.m_imageSize}, m_imageType{other.m_imageType}, m_fp{nullptr},
+        m_mapping{other.m_mapping}, m_compression{other.m_compression},
+        m_uncompressedSize{other.m_uncompressedSize}, m_digest{other.m_digest},
+        m_uniformBlocks{other.m_uniformBlocks}, m_filePath{other.m_filePath}, m_fileOffset{other.m_fileOffset}
     {}
     ~Image();
 
-    Image &operator=(const Image &other)
-    {
-        m_imagePath = other.m_imagePath;
-        m_imageName = other.m_imageName;
-        m_imageSize = other.m_imageSize;
-        m_imageType = other.m_imageType;
-        m_fp = other.m_fp;
-        return *this;
-    }
+    Image &operator=(const Image &other);
 
     int Load();
 
+    /**
+     * Serve this image from a shared read-only mapping instead of the file.
+     * Load() and GetDataBlock() then read from memory without any syscalls.
+     */
+    void SetMapping(std::shared_ptr<const ImageMapping> mapping) { m_mapping = std::move(mapping); }
+
+    /** @return the mapped image contents, or nullptr if the image is not mapped. */
+    const uint8_t *GetMappedData() const;
+
+    /**
+     * Ask the OS to start reading the front of the image in the background
+     * so a later Load() / GetDataBlock() does not wait on the disk.  Only a
+     * hint: it returns immediately and has no effect if unsupported.
+     */
+    void Prefetch() const;
+
+    /**
+     * Compressed images (.gz, .zst) are decompressed while they are read.
+     * GetName() drops the compression extension and GetSize() reports the
+     * uncompressed size.
+     */
+    bool IsCompressed() const { return m_compression != ASTRA_IMAGE_COMPRESSION_NONE; }
+
+    /** Expected uncompressed size, overriding the size stored in the stream. */
+    void SetUncompressedSize(uint64_t size) { m_uncompressedSize = size; }
+
+    /**
+     * The size found by loading another copy of the image, e.g. the one a
+     * shared stream decompresses, so this copy need not be loaded to report
+     * it.  Load() still opens the image and sets the size again.
+     */
+    void SetLoadedSize(size_t size) { m_imageSize = size; }
+
+    /**
+     * Expected SHA-256 of the image contents (lowercase hex), used by delta
+     * updates to skip partitions the device already holds.  Empty if unknown.
+     */
+    void SetDigest(const std::string &digest) { m_digest = digest; }
+    const std::string &GetDigest() const { return m_digest; }
+
+    /**
+     * Blocks of a raw image that repeat one word, found when the flash image
+     * was loaded, so senders can skip scanning it.  Null if not scanned.
+     */
+    void SetUniformBlocks(std::shared_ptr<const UniformBlockMap> blocks) { m_uniformBlocks = std::move(blocks); }
+    const std::shared_ptr<const UniformBlockMap> &GetUniformBlocks() const { return m_uniformBlocks; }
+
+    /**
+     * The image is the bytes at offset of filePath, e.g. one image of a flash
+     * image bundle, and is served from its mapping.  GetPath() still names
+     * the image on its own; readers which open the file use GetFilePath()
+     * and GetFileOffset().
+     */
+    void SetFileSlice(const std::string &filePath, uint64_t offset) { m_filePath = filePath; m_fileOffset = offset; }
+    bool IsFileSlice() const { return !m_filePath.empty(); }
+    const std::string &GetFilePath() const { return m_filePath.empty() ? m_imagePath : m_filePath; }
+    uint64_t GetFileOffset() const { return m_fileOffset; }
+
     std::string GetName() const { return m_imageName; }
     std::string GetPath() const { return m_imagePath; }
     int GetDataBlock(uint8_t *data, size_t size);
@@ -79,6 +147,20 @@ private:
     AstraImageType m_imageType;
 
     FILE *m_fp;
+    std::shared_ptr<const ImageMapping> m_mapping;
+    size_t m_readOffset = 0;
+
+    AstraImageCompression m_compression = ASTRA_IMAGE_COMPRESSION_NONE;
+    uint64_t m_uncompressedSize = 0;
+    std::shared_ptr<ImageDecompressor> m_decompressor;
+    std::string m_digest;
+    std::shared_ptr<const UniformBlockMap> m_uniformBlocks;
+    std::string m_filePath;
+    uint64_t m_fileOffset = 0;
+
+    int LoadCompressed();
+    static AstraImageCompression CompressionFromPath(const std::string &path);
+    static std::string NameFromPath(const std::string &path, AstraImageCompression compression);
 };
 
 static std::string AstraSecureBootVersionToString(AstraSecureBootVersion version)
@@ -2,6 +2,7 @@
 // Copyright 2025 Synaptics Incorporated
 
 #include <iostream>
+#include <sstream>
 #include <yaml-cpp/yaml.h>
 #include <stdexcept>
 #include <iomanip>
@@ -146,49 +147,170 @@ bool AstraBootImage::LoadManifest(std::string manifestPath)
 }
 
 bool AstraBootImage::Load()
+{
+    return LoadHeader() && LoadImages();
+}
+
+bool AstraBootImage::LoadHeader()
 {
     ASTRA_LOG;
 
-    bool ret;
+    if (!std::filesystem::exists(m_path) || !std::filesystem::is_directory(m_path)) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Boot image path does not exist: " << m_path << endLog;
+        return false;
+    }
+
+    m_directoryName = std::filesystem::path(m_path).filename().string();
 
-    if (std::filesystem::exists(m_path) && std::filesystem::is_directory(m_path)) {
-        for (const auto& entry : std::filesystem::directory_iterator(m_path)) {
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Found file: " << entry.path() << endLog;
-            if (entry.path().filename().string() == "manifest.yaml") {
-                ret = LoadManifest(entry.path().string());
-                if (!ret) {
-                    return ret;
-                }
+    return LoadManifest((std::filesystem::path(m_path) / "manifest.yaml").string());
+}
+
+bool AstraBootImage::LoadImages()
+{
+    ASTRA_LOG;
+
+    if (m_imagesLoaded) {
+        return true;
+    }
+
+    if (!std::filesystem::exists(m_path) || !std::filesystem::is_directory(m_path)) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Boot image path does not exist: " << m_path << endLog;
+        return false;
+    }
+
+    m_images.clear();
+    for (const auto& entry : std::filesystem::directory_iterator(m_path)) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Found file: " << entry.path() << endLog;
+        if (entry.path().filename().string() != "manifest.yaml") {
+            m_images.push_back(Image(entry.path().string(), ASTRA_IMAGE_TYPE_BOOT));
+        }
+    }
+
+    if (std::filesystem::exists(m_path + "/Image.gz") && std::filesystem::exists(m_path + "/ramdisk.cpio.gz")) {
+        m_linuxBoot = true;
+        m_finalBootImage = "ramdisk.cpio.gz";
+    } else if (std::filesystem::exists(m_path + "/Image") && std::filesystem::exists(m_path + "/rootfs.cpio.gz")) {
+        m_linuxBoot = true;
+        m_finalBootImage = "rootfs.cpio.gz";
+    } else {
+        if (m_secureBootVersion == ASTRA_SECURE_BOOT_V2) {
+            m_finalBootImage = "minildr.img";
+        } else if (m_secureBootVersion == ASTRA_SECURE_BOOT_V3) {
+            if (m_uEnvSupport) {
+                m_finalBootImage = "uEnv.txt";
             } else {
-                m_images.push_back(Image(entry.path().string(), ASTRA_IMAGE_TYPE_BOOT));
+                m_finalBootImage = "gen3_uboot.bin.usb";
             }
         }
+    }
+    m_imagesLoaded = true;
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Loaded boot images: " << m_directoryName << endLog;
 
-        if (std::filesystem::exists(m_path + "/Image.gz") && std::filesystem::exists(m_path + "/ramdisk.cpio.gz")) {
-            m_linuxBoot = true;
-            m_finalBootImage = "ramdisk.cpio.gz";
-        } else if (std::filesystem::exists(m_path + "/Image") && std::filesystem::exists(m_path + "/rootfs.cpio.gz")) {
-            m_linuxBoot = true;
-            m_finalBootImage = "rootfs.cpio.gz";
-        } else {
-            if (m_secureBootVersion == ASTRA_SECURE_BOOT_V2) {
-                m_finalBootImage = "minildr.img";
-            } else if (m_secureBootVersion == ASTRA_SECURE_BOOT_V3) {
-                if (m_uEnvSupport) {
-                    m_finalBootImage = "uEnv.txt";
-                } else {
-                    m_finalBootImage = "gen3_uboot.bin.usb";
+    return true;
+}
+
+void AstraBootImage::WriteIndexEntry(std::ostream &os) const
+{
+    os << "id " << m_id << "\n";
+    os << "chip " << m_chipName << "\n";
+    os << "board " << m_boardName << "\n";
+    os << "uenv_support " << m_uEnvSupport << "\n";
+    os << "nand_support " << m_nandSupport << "\n";
+    os << "secure_boot " << m_secureBootVersion << "\n";
+    os << "console " << m_ubootConsole << "\n";
+    os << "memory_layout " << m_memoryLayout << "\n";
+    os << "ddr_type " << m_memoryDDRType << "\n";
+    os << "transport " << m_transportType << "\n";
+    os << "ids " << m_vendorId << " " << m_productId << " " << m_sysMgrVendorId << " " << m_sysMgrProductId
+       << " " << m_fastbootVendorId << " " << m_fastbootProductId << "\n";
+    os << "uboot " << m_ubootVariant << "\n";
+    os << "boot_stage " << m_defaultBootStage << "\n";
+    // The file list is only known once the image has been selected and loaded.
+    if (m_imagesLoaded) {
+        os << "images\n";
+        os << "linux_boot " << m_linuxBoot << "\n";
+        os << "final_image " << m_finalBootImage << "\n";
+        for (const auto &image : m_images) {
+            os << "file " << std::filesystem::path(image.GetPath()).filename().string() << "\n";
+        }
+    }
+    os << "end\n";
+}
+
+bool AstraBootImage::ReadIndexEntry(std::istream &is)
+{
+    ASTRA_LOG;
+
+    // Manifest fields an entry must carry; anything else would leave members unset.
+    unsigned fields = 0;
+    constexpr unsigned kRequiredFields = 13;
+
+    std::string line;
+    try {
+        while (std::getline(is, line)) {
+            const size_t space = line.find(' ');
+            const std::string key = line.substr(0, space);
+            const std::string value = (space == std::string::npos) ? "" : line.substr(space + 1);
+
+            if (key == "end") {
+                m_directoryName = std::filesystem::path(m_path).filename().string();
+                return fields == kRequiredFields;
+            } else if (key == "images") {
+                m_imagesLoaded = true;
+                continue;
+            } else if (key == "file") {
+                m_images.push_back(Image((std::filesystem::path(m_path) / value).string(), ASTRA_IMAGE_TYPE_BOOT));
+                continue;
+            } else if (key == "linux_boot") {
+                m_linuxBoot = std::stoi(value) != 0;
+                continue;
+            } else if (key == "final_image") {
+                m_finalBootImage = value;
+                continue;
+            }
+
+            ++fields;
+            if (key == "id") {
+                m_id = value;
+            } else if (key == "chip") {
+                m_chipName = value;
+            } else if (key == "board") {
+                m_boardName = value;
+            } else if (key == "uenv_support") {
+                m_uEnvSupport = std::stoi(value) != 0;
+            } else if (key == "nand_support") {
+                m_nandSupport = std::stoi(value) != 0;
+            } else if (key == "secure_boot") {
+                m_secureBootVersion = static_cast<AstraSecureBootVersion>(std::stoi(value));
+            } else if (key == "console") {
+                m_ubootConsole = static_cast<AstraUbootConsole>(std::stoi(value));
+            } else if (key == "memory_layout") {
+                m_memoryLayout = static_cast<AstraMemoryLayout>(std::stoi(value));
+            } else if (key == "ddr_type") {
+                m_memoryDDRType = static_cast<AstraMemoryDDRType>(std::stoi(value));
+            } else if (key == "transport") {
+                m_transportType = static_cast<AstraTransportType>(std::stoi(value));
+            } else if (key == "ids") {
+                std::istringstream ids(value);
+                if (!(ids >> m_vendorId >> m_productId >> m_sysMgrVendorId >> m_sysMgrProductId
+                    >> m_fastbootVendorId >> m_fastbootProductId))
+                {
+                    return false;
                 }
+            } else if (key == "uboot") {
+                m_ubootVariant = static_cast<AstraUbootVariant>(std::stoi(value));
+            } else if (key == "boot_stage") {
+                m_defaultBootStage = static_cast<AstraDeviceBootStage>(std::stoi(value));
+            } else {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Unknown boot image index field: " << key << endLog;
+                return false;
             }
         }
-        m_directoryName = std::filesystem::path(m_path).filename().string();
-        log(ASTRA_LOG_LEVEL_DEBUG) << "Loaded boot images: " << m_directoryName << endLog;
-    } else {
-        log(ASTRA_LOG_LEVEL_ERROR) << "Boot image path does not exist: " << m_path << endLog;
-        return false;
+    } catch (const std::exception &e) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Malformed boot image index entry: " << e.what() << endLog;
     }
 
-    return true;
+    return false;
 }
 
 AstraBootImage::~AstraBootImage()
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -28,8 +29,32 @@ public:
     {}
     ~AstraBootImage();
 
+    /** Parse the manifest and list the image files; LoadHeader() then LoadImages(). */
     bool Load();
 
+    /**
+     * Parse only manifest.yaml.  Enough to match the boot image against an
+     * update image; call LoadImages() once it has been selected.
+     */
+    bool LoadHeader();
+
+    /** List the image files and pick the final boot image.  No-op once loaded. */
+    bool LoadImages();
+    bool ImagesLoaded() const { return m_imagesLoaded; }
+
+    /**
+     * Write the manifest fields and file list as one BootImageCollection
+     * index entry, so later runs can skip parsing manifest.yaml.
+     */
+    void WriteIndexEntry(std::ostream &os) const;
+
+    /**
+     * Restore a boot image from an entry written by WriteIndexEntry().  File
+     * names are resolved against the path given to the constructor.
+     * @return false if the entry is malformed or truncated.
+     */
+    bool ReadIndexEntry(std::istream &is);
+
     uint16_t GetVendorId() const { return m_vendorId; }
     uint16_t GetProductId() const { return m_productId; }
     std::vector<std::pair<uint16_t, uint16_t>> GetVendorProductIdPairs() const;
@@ -40,6 +65,7 @@ public:
     std::string GetChipName() const { return m_chipName; }
     std::string GetBoardName() const { return m_boardName; }
     std::string GetID() const { return m_id; }
+    const std::string &GetPath() const { return m_path; }
     bool GetUEnvSupport() const { return m_uEnvSupport; }
     bool GetNandSupport() const { return m_nandSupport; }
     AstraSecureBootVersion GetSecureBootVersion() const { return m_secureBootVersion; }
@@ -77,6 +103,7 @@ private:
     bool m_linuxBoot = false;
     AstraDeviceBootStage m_defaultBootStage = ASTRA_DEVICE_BOOT_STAGE_AUTO;
     bool m_nandSupport = false;
+    bool m_imagesLoaded = false;
 
     bool LoadManifest(std::string manifestPath);
 };
\ No newline at end of file
@@ -5,64 +5,182 @@
 
 #include "astra_console.hpp"
 #include "astra_log.hpp"
+#include "thread_policy.hpp"
 
-AstraConsole::AstraConsole(std::string deviceName, std::string logPath)
+namespace {
+
+bool IsConsoleSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+} // namespace
+
+AstraConsole::AstraConsole(std::string deviceName, std::string logPath, size_t capacity)
+    : m_capacity{std::max<size_t>(capacity, 1)}
 {
     ASTRA_LOG;
 
     std::string logFile = logPath + "/console.log";
     m_consoleLog = std::ofstream(logFile, std::ios::out | std::ios::trunc);
+    m_logThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-console", &AstraConsole::LogWriterThread, this);
 }
 
 AstraConsole::~AstraConsole()
 {
     ASTRA_LOG;
+
+    Shutdown();
+}
+
+bool AstraConsole::MatchPrompt(const std::string &data)
+{
+    // As before, the prompt must end the output once trailing whitespace is
+    // ignored; only the tail of this chunk and the carry need looking at.
+    size_t end = data.size();
+    while (end > 0 && IsConsoleSpace(data[end - 1])) {
+        --end;
+    }
+
+    const size_t promptSize = m_uBootPrompt.size();
+    bool matched = false;
+    if (end > 0) {
+        std::string window;
+        if (end < promptSize) {
+            window = m_promptCarry + data.substr(0, end);
+        } else {
+            window = data.substr(end - promptSize, promptSize);
+        }
+        matched = window.size() >= promptSize &&
+            window.compare(window.size() - promptSize, promptSize, m_uBootPrompt) == 0;
+    }
+
+    m_promptCarry += data;
+    if (m_promptCarry.size() > promptSize - 1) {
+        m_promptCarry.erase(0, m_promptCarry.size() - (promptSize - 1));
+    }
+    return matched;
 }
 
 void AstraConsole::Append(const std::string &data)
 {
     ASTRA_LOG;
 
-    std::string trimmedData = data;
-    trimmedData.erase(trimmedData.find_last_not_of(" \t\n\r\f\v") + 1);
+    if (data.empty()) {
+        return;
+    }
 
-    if (trimmedData.size() >= m_uBootPrompt.size() &&
-        trimmedData.rfind(m_uBootPrompt) == (trimmedData.size() - m_uBootPrompt.size()))
+    bool promptDetected = false;
     {
+        std::lock_guard<std::mutex> lock(m_consoleMutex);
+        promptDetected = MatchPrompt(data);
+
+        // Keep only the most recent m_capacity bytes.
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+        size_t size = data.size();
+        if (size >= m_capacity) {
+            bytes += size - m_capacity;
+            size = m_capacity;
+            m_consoleData.Clear();
+        } else if (m_consoleData.Size() + size > m_capacity) {
+            m_consoleData.Discard(m_consoleData.Size() + size - m_capacity);
+        }
+        m_consoleData.Write(bytes, size);
+    }
+
+    if (promptDetected) {
         log(ASTRA_LOG_LEVEL_DEBUG) << "U-Boot prompt detected." << endLog;
+        {
+            std::lock_guard<std::mutex> lock(m_promptMutex);
+            ++m_promptsSeen;
+        }
         m_promptCV.notify_one();
     }
 
-    m_consoleData += data;
-    m_consoleLog << data;
-    m_consoleLog.flush();
+    {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        if (m_logStop) {
+            return;
+        }
+        // Never block the USB event thread on a slow disk.
+        if (m_pendingLog.size() + data.size() > kMaxPendingLog) {
+            m_droppedLogBytes += data.size();
+            return;
+        }
+        m_pendingLog += data;
+    }
+    m_logCV.notify_one();
 }
 
-std::string &AstraConsole::Get()
+std::string AstraConsole::Get() const
 {
     ASTRA_LOG;
 
-    return m_consoleData;
+    std::lock_guard<std::mutex> lock(m_consoleMutex);
+    std::string data(m_consoleData.Size(), '\0');
+    m_consoleData.Peek(reinterpret_cast<uint8_t *>(data.data()), data.size());
+    return data;
 }
 
 bool AstraConsole::WaitForPrompt()
 {
     ASTRA_LOG;
 
+    // A prompt which arrived before the wait still counts; several count once.
     std::unique_lock<std::mutex> lock(m_promptMutex);
-    m_promptCV.wait(lock);
+    m_promptCV.wait(lock, [this] { return m_shutdown.load() || m_promptsSeen > m_promptsWaited; });
     if (m_shutdown.load()) {
         return false;
     }
 
+    m_promptsWaited = m_promptsSeen;
     return true;
 }
 
+void AstraConsole::LogWriterThread()
+{
+    std::string batch;
+
+    std::unique_lock<std::mutex> lock(m_logMutex);
+    while (true) {
+        m_logCV.wait(lock, [this] { return !m_pendingLog.empty() || m_droppedLogBytes > 0 || m_logStop; });
+        if (m_pendingLog.empty() && m_droppedLogBytes == 0 && m_logStop) {
+            break;
+        }
+
+        batch.swap(m_pendingLog);
+        const size_t dropped = m_droppedLogBytes;
+        m_droppedLogBytes = 0;
+        lock.unlock();
+
+        m_consoleLog << batch;
+        if (dropped > 0) {
+            m_consoleLog << "\n[astra-update: " << dropped << " console bytes not logged]\n";
+        }
+        m_consoleLog.flush();
+        batch.clear();
+
+        lock.lock();
+    }
+}
+
 void AstraConsole::Shutdown()
 {
     ASTRA_LOG;
 
-    m_shutdown.store(true);
+    {
+        std::lock_guard<std::mutex> lock(m_promptMutex);
+        m_shutdown.store(true);
+    }
     m_promptCV.notify_all();
+
+    {
+        std::lock_guard<std::mutex> lock(m_logMutex);
+        m_logStop = true;
+    }
+    m_logCV.notify_one();
+    if (m_logThread.joinable()) {
+        m_logThread.join();
+    }
     m_consoleLog.close();
-}
\ No newline at end of file
+}
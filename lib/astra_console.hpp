@@ -4,29 +4,63 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <condition_variable>
 #include <mutex>
 #include <fstream>
+#include <thread>
 
+#include "byte_ring_buffer.hpp"
+
+/**
+ * Output of a device's U-Boot console.  The most recent capacity bytes are
+ * kept in memory for ReceiveFromConsole(), the whole output goes to
+ * console.log from a writer thread in batches, and the prompt is matched
+ * as the data streams in, including a prompt split across chunks.
+ */
 class AstraConsole
 {
 public:
-    AstraConsole(std::string deviceName, std::string logPath);
+    static constexpr size_t kDefaultCapacity = 256 * 1024;
+
+    AstraConsole(std::string deviceName, std::string logPath, size_t capacity = kDefaultCapacity);
     ~AstraConsole();
 
     void Append(const std::string &data);
-    std::string &Get();
+    std::string Get() const;
 
+    /** Wait for a prompt not yet waited for.  @return false on Shutdown(). */
     bool WaitForPrompt();
     void Shutdown();
 
 private:
-    std::string m_consoleData;
+    // Past this much unwritten log, new output is dropped and a marker logged.
+    static constexpr size_t kMaxPendingLog = 4 * 1024 * 1024;
+
+    bool MatchPrompt(const std::string &data);
+    void LogWriterThread();
+
     const std::string m_uBootPrompt = "=>";
+    const size_t m_capacity;
+
+    mutable std::mutex m_consoleMutex;
+    ByteRingBuffer m_consoleData;
+    // The last m_uBootPrompt.size() - 1 bytes of output, for split prompts.
+    std::string m_promptCarry;
+
     std::condition_variable m_promptCV;
     std::mutex m_promptMutex;
+    uint64_t m_promptsSeen = 0;
+    uint64_t m_promptsWaited = 0;
     std::atomic<bool> m_shutdown{false};
+
+    std::mutex m_logMutex;
+    std::condition_variable m_logCV;
+    std::string m_pendingLog;
+    size_t m_droppedLogBytes = 0;
+    bool m_logStop = false;
     std::ofstream m_consoleLog;
-};
\ No newline at end of file
+    std::thread m_logThread;
+};
@@ -84,6 +84,56 @@ void AstraDevice::SetRegistrationCallbacks(
     pImpl->SetRegistrationCallbacks(std::move(registerFn), std::move(unregisterFn));
 }
 
+void AstraDevice::SetImageStore(std::shared_ptr<ImageStore> imageStore)
+{
+    pImpl->SetImageStore(std::move(imageStore));
+}
+
+void AstraDevice::SetImageBroadcast(std::shared_ptr<ImageBroadcast> imageBroadcast)
+{
+    pImpl->SetImageBroadcast(std::move(imageBroadcast));
+}
+
+void AstraDevice::SetBootPacketCache(std::shared_ptr<BootPacketCache> bootPacketCache)
+{
+    pImpl->SetBootPacketCache(std::move(bootPacketCache));
+}
+
+void AstraDevice::SetImageRequestTimeout(std::chrono::seconds timeout)
+{
+    pImpl->SetImageRequestTimeout(timeout);
+}
+
+void AstraDevice::SetResponseTimes(std::shared_ptr<ResponseTimes> responseTimes)
+{
+    pImpl->SetResponseTimes(std::move(responseTimes));
+}
+
+void AstraDevice::SetEventExecutor(std::shared_ptr<EventExecutor> eventExecutor)
+{
+    pImpl->SetEventExecutor(std::move(eventExecutor));
+}
+
+void AstraDevice::SetDeviceScheduler(std::shared_ptr<DeviceScheduler> scheduler)
+{
+    pImpl->SetDeviceScheduler(std::move(scheduler));
+}
+
+void AstraDevice::SetTransferTuner(std::shared_ptr<TransferTuner> transferTuner)
+{
+    pImpl->SetTransferTuner(std::move(transferTuner));
+}
+
+void AstraDevice::SetUpdateCheckpoints(std::shared_ptr<UpdateCheckpoints> updateCheckpoints)
+{
+    pImpl->SetUpdateCheckpoints(std::move(updateCheckpoints));
+}
+
+void AstraDevice::SetBootSessions(std::shared_ptr<BootSessions> bootSessions, const std::string &job)
+{
+    pImpl->SetBootSessions(std::move(bootSessions), job);
+}
+
 const std::string AstraDevice::AstraDeviceStatusToString(AstraDeviceStatus status)
 {
     static const std::string statusStrings[] = {
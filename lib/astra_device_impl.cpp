@@ -10,6 +10,37 @@
 
 #include "astra_boot_image.hpp"
 
+// ---------------------------------------------------------------------------
+// MakeDeviceDirName / OpenDeviceLog
+// ---------------------------------------------------------------------------
+std::string AstraDeviceImpl::MakeDeviceDirName(const std::string &deviceName)
+{
+    std::string dirName = deviceName;
+    dirName.erase(std::remove(dirName.begin(), dirName.end(), ':'), dirName.end());
+    std::replace(dirName.begin(), dirName.end(), '.', '_');
+    return dirName;
+}
+
+void AstraDeviceImpl::OpenDeviceLog()
+{
+    ASTRA_LOG;
+
+    if (m_logSink) {
+        AstraLogStore::SetThreadSink(m_logSink);
+        return;
+    }
+
+    const std::string logDir = m_tempDir + "/" + MakeDeviceDirName(m_deviceName);
+    std::error_code ec;
+    std::filesystem::create_directories(logDir, ec);
+
+    m_logSink = AstraLogStore::getInstance().OpenDeviceLog(m_deviceName, logDir + "/device.log");
+    if (m_logSink) {
+        log(ASTRA_LOG_LEVEL_INFO) << "Logging " << m_deviceName << " to " << logDir << "/device.log" << endLog;
+        AstraLogStore::SetThreadSink(m_logSink);
+    }
+}
+
 // ---------------------------------------------------------------------------
 // BuildBootImageList
 // Populates m_images from bootImage subimages and (if needed) a synthesised
@@ -24,8 +55,10 @@ void AstraDeviceImpl::BuildBootImageList(std::shared_ptr<AstraBootImage> bootIma
     m_uEnvSupport  = bootImage->GetUEnvSupport();
     m_finalBootImage = bootImage->GetFinalBootImage();
     m_finalUpdateImage.clear();
+    m_updateImagesAdded = false;
 
     std::vector<Image> subimages = bootImage->GetImages();
+    MapImageSet(subimages);
 
     std::lock_guard<std::mutex> lock(m_imageMutex);
     m_images.insert(m_images.end(), subimages.begin(), subimages.end());
@@ -68,10 +101,393 @@ void AstraDeviceImpl::AppendUpdateImages(std::shared_ptr<FlashImage> flashImage)
 {
     m_finalUpdateImage  = flashImage->GetFinalImage();
     m_resetWhenComplete = flashImage->GetResetWhenComplete();
+    m_deltaUpdate       = flashImage->GetDeltaUpdate();
+    m_verifyUpdate      = flashImage->GetVerifyUpdate();
+    m_updateImageOrder  = flashImage->GetImageOrder();
+    m_updateImageOrderPos = 0;
 
-    std::lock_guard<std::mutex> lock(m_imageMutex);
-    const std::vector<Image> &imgs = flashImage->GetImages();
-    m_images.insert(m_images.end(), imgs.begin(), imgs.end());
+    std::vector<Image> imgs = flashImage->GetImages();
+    MapImages(imgs);
+
+    {
+        std::lock_guard<std::mutex> lock(m_imageMutex);
+        m_images.insert(m_images.end(), imgs.begin(), imgs.end());
+        m_updateImagesAdded = true;
+    }
+    // The task may be waiting for them.
+    ResumeImageRequestTask();
+}
+
+// ---------------------------------------------------------------------------
+// StartImageDigest / VerifyImage
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::StartImageDigest()
+{
+    if (m_streamDigest == nullptr) {
+        m_streamDigest = std::make_unique<StreamDigest>();
+    }
+    m_streamDigest->Start();
+    m_digestedBytes = 0;
+    m_digestActive = true;
+}
+
+bool AstraDeviceImpl::VerifyImage(const Image &image, bool sent)
+{
+    ASTRA_LOG;
+
+    m_digestActive = false;
+    std::string digest = m_streamDigest->Finish();
+    if (!sent) {
+        return true;
+    }
+
+    // Payloads which were not streamed whole (re-sparsed images) leave
+    // nothing to compare on the host.
+    if (m_digestedBytes != image.GetSize()) {
+        digest.clear();
+    }
+
+    if (!digest.empty() && !image.GetDigest().empty() && digest != image.GetDigest()) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Digest mismatch for " << image.GetName() << ": expected "
+            << image.GetDigest() << " sent " << digest << endLog;
+        return false;
+    }
+
+    const std::string &expected = image.GetDigest().empty() ? digest : image.GetDigest();
+    if (expected.empty()) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "No digest to verify " << image.GetName() << " against" << endLog;
+        return true;
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Digest of " << image.GetName() << ": " << expected << endLog;
+    return VerifyImageOnDevice(image, expected);
+}
+
+// ---------------------------------------------------------------------------
+// BeginTunedTransfer / EndTunedTransfer
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::BeginTunedTransfer(const Image &image)
+{
+    ASTRA_LOG;
+
+    m_tunedTransferActive = false;
+    const std::vector<size_t> chunkSizes = GetTunableChunkSizes();
+    if (m_transferTuner == nullptr || m_usbDevice == nullptr || chunkSizes.empty()) {
+        return;
+    }
+
+    // The device's current depth first, then the others it supports.
+    std::vector<size_t> queueDepths{m_usbDevice->GetWriteQueueDepth()};
+    for (size_t depth = 1; depth <= m_usbDevice->GetMaxWriteQueueDepth(); depth *= 2) {
+        if (depth != queueDepths.front()) {
+            queueDepths.push_back(depth);
+        }
+    }
+
+    // One link per protocol, identified by the VID:PID, behind one hub.
+    std::ostringstream link;
+    link << std::hex << std::setfill('0') << std::setw(4) << m_usbDevice->GetVendorId() << ":"
+         << std::setw(4) << m_usbDevice->GetProductId();
+    const std::string hub = DeviceScheduler::HubFromUSBPath(GetUSBPath());
+    link << " " << (hub.empty() ? "any" : hub);
+
+    // The image is not loaded yet; its file size is close enough to decide
+    // whether the transfer is worth measuring.
+    uint64_t expectedBytes = image.GetSize();
+    if (expectedBytes == 0) {
+        std::error_code ec;
+        expectedBytes = std::filesystem::file_size(image.GetFilePath(), ec);
+        if (ec) {
+            expectedBytes = 0;
+        }
+    }
+
+    m_tunedLink = link.str();
+    m_tunedParameters = m_transferTuner->Select(m_tunedLink, expectedBytes, chunkSizes, queueDepths);
+
+    if (m_tunedParameters.m_queueDepth != m_usbDevice->GetWriteQueueDepth() &&
+        !m_usbDevice->SetWriteQueueDepth(m_tunedParameters.m_queueDepth))
+    {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Cannot set write queue depth " << m_tunedParameters.m_queueDepth << endLog;
+        m_transferTuner->Report(m_tunedLink, m_tunedParameters, expectedBytes, {});
+        return;
+    }
+    SetTransferChunkSize(m_tunedParameters.m_chunkSize);
+
+    m_tunedTransferActive = true;
+    m_tunedStart = std::chrono::steady_clock::now();
+}
+
+void AstraDeviceImpl::EndTunedTransfer(const Image &image, bool sent)
+{
+    if (!m_tunedTransferActive) {
+        return;
+    }
+    m_tunedTransferActive = false;
+
+    const auto elapsed = sent ? std::chrono::steady_clock::now() - m_tunedStart : std::chrono::steady_clock::duration{};
+    m_transferTuner->Report(m_tunedLink, m_tunedParameters, image.GetSize(), elapsed);
+}
+
+// ---------------------------------------------------------------------------
+// GetTransferMemory
+// ---------------------------------------------------------------------------
+uint64_t AstraDeviceImpl::GetTransferMemory() const
+{
+    const std::vector<size_t> chunkSizes = GetTunableChunkSizes();
+    if (m_usbDevice == nullptr || chunkSizes.empty()) {
+        return 0;
+    }
+
+    uint64_t bytes = static_cast<uint64_t>(chunkSizes.front()) * m_usbDevice->GetWriteQueueDepth();
+    if (m_transferTuner != nullptr) {
+        // Candidates are capped at TransferTuner::kMaxQueuedBytes in flight.
+        bytes = std::max<uint64_t>(bytes, TransferTuner::kMaxQueuedBytes);
+    }
+    if (m_verifyUpdate) {
+        bytes += StreamDigest::kMaxQueuedBytes;
+    }
+    return bytes;
+}
+
+// ---------------------------------------------------------------------------
+// CheckpointImage / IsImageCheckpointed
+// Only the entries of the image list are checkpointed.  U-Boot fetches the
+// list files it works from whenever it starts the list, so they are always
+// sent again.
+// ---------------------------------------------------------------------------
+bool AstraDeviceImpl::IsResumable(const Image &image)
+{
+    if (m_updateCheckpoints == nullptr || !CanResumeUpdate()) {
+        return false;
+    }
+    return std::any_of(m_updateImageOrder.begin(), m_updateImageOrder.end(), [&image](const std::string &entry) {
+        return image.GetName().find(entry) != std::string::npos;
+    });
+}
+
+void AstraDeviceImpl::CheckpointImage(const Image &image)
+{
+    if (IsResumable(image)) {
+        m_updateCheckpoints->Record(m_updateSessionUuid, image);
+    }
+}
+
+bool AstraDeviceImpl::IsImageCheckpointed(const Image &image)
+{
+    ASTRA_LOG;
+
+    if (!IsResumable(image) || !m_updateCheckpoints->IsRecorded(m_updateSessionUuid, image)) {
+        return false;
+    }
+
+    if (!m_updateResumed) {
+        m_updateResumed = true;
+
+        // The first entry of the image list the device does not hold yet.
+        std::string nextImageName;
+        for (const auto &entry : m_updateImageOrder) {
+            auto it = std::find_if(m_images.begin(), m_images.end(), [&entry](const Image &img) {
+                return img.GetImageType() != ASTRA_IMAGE_TYPE_BOOT && img.GetName().find(entry) != std::string::npos;
+            });
+            if (it != m_images.end() && !m_updateCheckpoints->IsRecorded(m_updateSessionUuid, *it)) {
+                nextImageName = it->GetName();
+                break;
+            }
+        }
+
+        m_updateResumeAccepted = OnResumeUpdate(nextImageName);
+        if (m_updateResumeAccepted) {
+            log(ASTRA_LOG_LEVEL_INFO) << "Resuming interrupted update of session " << m_updateSessionUuid
+                << (nextImageName.empty() ? "" : " at " + nextImageName) << endLog;
+        } else {
+            log(ASTRA_LOG_LEVEL_INFO) << "Device cannot resume the interrupted update of session "
+                << m_updateSessionUuid << ", sending every image again" << endLog;
+        }
+    }
+    return m_updateResumeAccepted;
+}
+
+// ---------------------------------------------------------------------------
+// CollectImageBatch
+// Follows m_updateImageOrder from the position PrefetchNextImage() matched
+// the requested image at.  The final update image is left out, so the update
+// still completes on its own request, and so is any image checkpointed by an
+// earlier session, which the device skips.
+// ---------------------------------------------------------------------------
+std::vector<Image *> AstraDeviceImpl::CollectImageBatch(Image &image)
+{
+    std::vector<Image *> batch{&image};
+
+    auto isFinal = [this](const Image &img) {
+        return !m_finalUpdateImage.empty() && img.GetName().find(m_finalUpdateImage) != std::string::npos;
+    };
+    if (m_updateImageOrderPos == 0 || isFinal(image) ||
+        image.GetName().find(m_updateImageOrder[m_updateImageOrderPos - 1]) == std::string::npos)
+    {
+        return batch;
+    }
+
+    for (size_t pos = m_updateImageOrderPos; pos < m_updateImageOrder.size() && batch.size() < kMaxImageBatchCount;
+        ++pos)
+    {
+        const std::string &entry = m_updateImageOrder[pos];
+        auto it = std::find_if(m_images.begin(), m_images.end(), [&entry](const Image &img) {
+            return img.GetImageType() != ASTRA_IMAGE_TYPE_BOOT && img.GetName().find(entry) != std::string::npos;
+        });
+        if (it == m_images.end() || isFinal(*it) || &*it == &image ||
+            (IsResumable(*it) && m_updateCheckpoints->IsRecorded(m_updateSessionUuid, *it)))
+        {
+            break;
+        }
+        batch.push_back(&*it);
+    }
+
+    return batch;
+}
+
+// ---------------------------------------------------------------------------
+// PrefetchNextImage
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::PrefetchNextImage(const std::string &currentName)
+{
+    ASTRA_LOG;
+
+    if (m_updateImageOrder.empty()) {
+        return;
+    }
+
+    // Entries are matched the same way as the final update image.  Search
+    // forward from the last match first so repeated entries resolve in order.
+    auto matches = [&currentName](const std::string &entry) {
+        return currentName.find(entry) != std::string::npos;
+    };
+    auto orderBegin = m_updateImageOrder.begin();
+    auto orderIt = std::find_if(orderBegin + static_cast<std::ptrdiff_t>(m_updateImageOrderPos),
+        m_updateImageOrder.end(), matches);
+    if (orderIt == m_updateImageOrder.end()) {
+        orderIt = std::find_if(orderBegin, m_updateImageOrder.end(), matches);
+    }
+    if (orderIt == m_updateImageOrder.end()) {
+        return;
+    }
+
+    m_updateImageOrderPos = static_cast<size_t>(orderIt - orderBegin) + 1;
+    if (m_updateImageOrderPos >= m_updateImageOrder.size()) {
+        return;
+    }
+
+    const std::string &nextEntry = m_updateImageOrder[m_updateImageOrderPos];
+    auto imageIt = std::find_if(m_images.begin(), m_images.end(), [&nextEntry](const Image &img) {
+        return img.GetName().find(nextEntry) != std::string::npos;
+    });
+    if (imageIt != m_images.end() && imageIt->GetName() != currentName) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Prefetching predicted next image: " << imageIt->GetName() << endLog;
+        imageIt->Prefetch();
+        PrepareImage(*imageIt);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RecordImageStats
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::RecordImageStats(const Image &image, bool skipped, TransferStats::Clock::time_point requestTime)
+{
+    const auto endTime = TransferStats::Clock::now();
+
+    ImageTransferStats stats;
+    stats.m_imageName = image.GetName();
+    stats.m_bytes = skipped ? 0 : image.GetSize();
+    stats.m_seconds = std::chrono::duration<double>(endTime - requestTime).count();
+    stats.m_skipped = skipped;
+
+    TransferStats::Clock::time_point firstWrite;
+    if (!skipped && m_transferStats->GetFirstWriteTime(firstWrite)) {
+        stats.m_firstWriteLatencyMs = std::chrono::duration<double, std::milli>(firstWrite - requestTime).count();
+    }
+
+    m_transferStats->RecordImage(stats, requestTime, endTime);
+    if (m_transferSlot != nullptr) {
+        m_transferSlot->AddBytes(stats.m_bytes);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ReportTransferStats
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::ReportTransferStats()
+{
+    ASTRA_LOG;
+
+    DeviceTransferStats stats = m_transferStats->Snapshot(m_deviceName);
+
+    for (const auto &image : stats.m_images) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Image " << image.m_imageName << ": " << image.m_bytes << " bytes in "
+            << image.m_seconds << " s (" << image.GetMBps() << " MB/s), first write after "
+            << image.m_firstWriteLatencyMs << " ms" << (image.m_skipped ? " [skipped]" : "") << endLog;
+    }
+    log(ASTRA_LOG_LEVEL_INFO) << "Transfer stats: " << stats.m_bytesSent << " bytes, " << stats.m_transferSeconds
+        << " s sending, " << stats.m_wallSeconds << " s wall, " << stats.GetMBps() << " MB/s, write latency p50 <= "
+        << stats.GetWriteLatencyPercentileUs(50) << " us, p99 <= " << stats.GetWriteLatencyPercentileUs(99)
+        << " us" << endLog;
+    if (stats.m_rebindCount > 0) {
+        log(ASTRA_LOG_LEVEL_INFO) << "Rebind stats: " << stats.m_rebindCount << " rebinds, "
+            << stats.m_rebindSeconds << " s total, " << stats.m_maxRebindSeconds << " s max" << endLog;
+    }
+
+    if (m_statusCallback) {
+        m_statusCallback({std::move(stats)});
+    }
+}
+
+// ---------------------------------------------------------------------------
+// MapImages
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::MapImages(std::vector<Image> &images)
+{
+    ASTRA_LOG;
+
+    if (m_imageStore == nullptr) {
+        return;
+    }
+
+    for (auto &image : images) {
+        if (image.IsCompressed() || image.IsFileSlice()) {
+            // Compressed images are streamed through the decompressor, and
+            // bundled images already hold a view of their bundle.
+            continue;
+        }
+        // A null mapping leaves the image on the regular file-read path.
+        image.SetMapping(m_imageStore->Acquire(image.GetPath()));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// MapImageSet
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::MapImageSet(std::vector<Image> &images)
+{
+    if (m_imageStore == nullptr) {
+        return;
+    }
+
+    std::vector<Image *> arenaImages;
+    std::vector<std::string> paths;
+    for (auto &image : images) {
+        if (!image.IsCompressed() && !image.IsFileSlice()) {
+            arenaImages.push_back(&image);
+            paths.push_back(image.GetPath());
+        }
+    }
+
+    std::vector<std::shared_ptr<const ImageMapping>> views = m_imageStore->AcquireArena(paths);
+    if (views.empty()) {
+        MapImages(images);
+        return;
+    }
+    for (size_t i = 0; i < arenaImages.size(); ++i) {
+        arenaImages[i]->SetMapping(std::move(views[i]));
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -107,250 +523,627 @@ bool AstraDeviceImpl::WriteUEnvFile(const std::string &bootCommand)
 
     uEnvFile << uEnv;
     uEnvFile.close();
+
+    if (m_bootSessions) {
+        m_bootSessions->Record(m_updateSessionUuid, m_bootSessionJob);
+    }
+    if (m_updateCheckpoints) {
+        m_updateCheckpoints->RecordJob(m_updateSessionUuid, m_bootSessionJob);
+    }
     return true;
 }
 
+bool AstraDeviceImpl::IsBootSessionOfJob(const std::string &sessionUuid)
+{
+    return (m_bootSessions && m_bootSessions->IsSessionOf(sessionUuid, m_bootSessionJob)) ||
+        (m_updateCheckpoints && m_updateCheckpoints->IsSessionOf(sessionUuid, m_bootSessionJob));
+}
+
 // ---------------------------------------------------------------------------
-// StartImageRequestThread
-// Sets m_running, starts the thread, then blocks until the thread signals
-// that it is ready to accept image requests.
+// StartImageRequestTask
+// Resets the step state and posts the first step; returns at once.
 // ---------------------------------------------------------------------------
-int AstraDeviceImpl::StartImageRequestThread()
+int AstraDeviceImpl::StartImageRequestTask()
 {
     ASTRA_LOG;
 
     m_imageCount = 0;
-    m_imageRequestThreadReady.store(false);
+    m_imageRequestStage = IMAGE_REQUEST_STAGE_WAIT;
+    m_imageRequestSpan.reset();
+    m_updateImagesDeadline = {};
+    m_waitForSizeRequest = false;
     m_running.store(true);
-    m_imageRequestThread = std::thread(&AstraDeviceImpl::ImageRequestThreadFunc, this);
 
-    log(ASTRA_LOG_LEVEL_DEBUG) << "Waiting for image request thread to be ready" << endLog;
-    std::unique_lock<std::mutex> lock(m_imageRequestThreadReadyMutex);
-    m_imageRequestThreadReadyCV.wait(lock, [this] {
-        return m_imageRequestThreadReady.load();
-    });
+    if (m_imageRequestExecutor == nullptr) {
+        m_imageRequestExecutor = m_eventExecutor != nullptr ? m_eventExecutor : std::make_shared<EventExecutor>(1);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+        m_imageRequestTaskStarted = true;
+        m_imageRequestTaskFinished = false;
+        m_imageRequestStepScheduled = false;
+        m_imageRequestResumePending = false;
+        m_imageRequestOperations = 0;
+        m_imageRequestTimer = 0;
+        m_transferSlotTicket = 0;
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Starting image request task" << endLog;
+    ResumeImageRequestTask();
 
     return 0;
 }
 
 // ---------------------------------------------------------------------------
-// StopImageRequestThread
-// Signals m_running = false, wakes the thread (via virtual hook and deviceEventCV),
-// then joins and clears m_images.
+// StopImageRequestTask
+// Signals m_running = false, withdraws a pending transfer slot request and
+// resumes the task so it sees the shutdown, then waits for it to finish and
+// clears m_images.
 // ---------------------------------------------------------------------------
-void AstraDeviceImpl::StopImageRequestThread()
+void AstraDeviceImpl::StopImageRequestTask()
 {
     ASTRA_LOG;
 
     m_running.store(false);
     m_deviceEventCV.notify_all();
-    WakeImageRequestThread();
 
-    if (m_imageRequestThread.joinable()) {
-        log(ASTRA_LOG_LEVEL_DEBUG) << "Joining image request thread" << endLog;
-        m_imageRequestThread.join();
+    uint64_t ticket = 0;
+    bool started = false;
+    {
+        std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+        started = m_imageRequestTaskStarted;
+        ticket = m_transferSlotTicket;
+    }
+
+    if (started) {
+        // The scheduler only calls back once a slot is free, which may be never.
+        if (ticket != 0 && m_deviceScheduler->CancelTransferSlotRequest(ticket)) {
+            CompleteImageRequestOperation();
+        }
+        ResumeImageRequestTask();
+
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Waiting for image request task" << endLog;
+        std::unique_lock<std::mutex> lock(m_imageRequestTaskMutex);
+        m_imageRequestTaskCV.wait(lock, [this] { return m_imageRequestTaskFinished; });
+        m_imageRequestTaskStarted = false;
     }
 
     std::lock_guard<std::mutex> lock(m_imageMutex);
     m_images.clear();
 }
 
-// ---------------------------------------------------------------------------
-// ImageRequestThreadFunc  (thin wrapper so the lambda / bind is cleaner)
-// ---------------------------------------------------------------------------
-void AstraDeviceImpl::ImageRequestThreadFunc()
+bool AstraDeviceImpl::IsImageRequestTaskStarted()
 {
-    RunImageRequestLoop();
+    std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+    return m_imageRequestTaskStarted;
 }
 
 // ---------------------------------------------------------------------------
-// RunImageRequestLoop
-// The shared image-serving loop.  Mirrors SL16XX HandleImageRequests but uses
-// the three virtual hooks (WaitForImageRequest / SendImagePayload / OnImageSent)
-// so both SL16XX (interrupt-driven) and SL26XX (fastboot poll-driven) can plug in.
+// Task scheduling
+// As for USBDevice's callback drains, at most one step is posted or running
+// at a time; a resume meanwhile runs one more step once it returns, unless
+// an operation is outstanding, whose completion runs it instead.
 // ---------------------------------------------------------------------------
-void AstraDeviceImpl::RunImageRequestLoop()
+void AstraDeviceImpl::ResumeImageRequestTask()
 {
-    ASTRA_LOG;
+    {
+        std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+        if (m_imageRequestTaskFinished) {
+            return;
+        }
+        if (m_imageRequestStepScheduled || m_imageRequestOperations > 0) {
+            m_imageRequestResumePending = true;
+            return;
+        }
+        m_imageRequestStepScheduled = true;
+    }
+    m_imageRequestExecutor->Post([this]() { RunImageRequestStep(); });
+}
+
+void AstraDeviceImpl::ResumeImageRequestTaskAt(std::chrono::steady_clock::time_point time)
+{
+    EventExecutor::TimerId previous;
+    {
+        std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+        if (m_imageRequestTaskFinished) {
+            return;
+        }
+        previous = m_imageRequestTimer;
+        m_imageRequestTimer = m_imageRequestExecutor->PostAfter(time - std::chrono::steady_clock::now(),
+            [this]() { ResumeImageRequestTask(); });
+    }
+    if (previous != 0) {
+        m_imageRequestExecutor->CancelTimer(previous);
+    }
+}
+
+void AstraDeviceImpl::AwaitImageRequestOperation()
+{
+    std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+    // May reach zero here: the operation can complete before its step returns.
+    ++m_imageRequestOperations;
+}
+
+void AstraDeviceImpl::CompleteImageRequestOperation()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+        --m_imageRequestOperations;
+    }
+    ResumeImageRequestTask();
+}
+
+bool AstraDeviceImpl::PollWriteBuffer()
+{
+    if (m_usbDevice->PollWriteBuffer(ImageRequestResumer())) {
+        return true;
+    }
+    AwaitImageRequestOperation();
+    return false;
+}
 
-    log(ASTRA_LOG_LEVEL_DEBUG) << "Signal image request thread ready" << endLog;
-    m_imageRequestThreadReady.store(true);
-    m_imageRequestThreadReadyCV.notify_all();
+bool AstraDeviceImpl::PollQueuedWrites()
+{
+    if (m_usbDevice->PollQueuedWrites(ImageRequestResumer())) {
+        return true;
+    }
+    AwaitImageRequestOperation();
+    return false;
+}
 
-    bool waitForSizeRequest = false;
+void AstraDeviceImpl::RunImageRequestStep()
+{
+    AstraLogStore::SetThreadSink(m_logSink);
+    const bool waiting = RunImageRequestStages();
 
-    while (true) {
-        std::string requestedImageName;
-        uint8_t imageType = 0;
+    if (!waiting) {
+        m_imageRequestSpan.reset();
+        m_transferSlot.reset();
 
-        const auto timeout = std::chrono::seconds(10);
-        bool gotRequest = WaitForImageRequest(requestedImageName, imageType, timeout);
+        EventExecutor::TimerId timer;
+        {
+            std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+            timer = m_imageRequestTimer;
+            m_imageRequestTimer = 0;
+        }
+        if (timer != 0) {
+            m_imageRequestExecutor->CancelTimer(timer);
+        }
+        AstraLogStore::SetThreadSink(nullptr);
+
+        std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+        m_imageRequestTaskFinished = true;
+        m_imageRequestStepScheduled = false;
+        m_imageRequestTaskCV.notify_all();
+        return;
+    }
+    AstraLogStore::SetThreadSink(nullptr);
 
-        if (!m_running.load()) {
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Image request loop: shutting down" << endLog;
-            m_deviceEventCV.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+        if (!m_imageRequestResumePending || m_imageRequestOperations > 0) {
+            m_imageRequestResumePending = false;
+            m_imageRequestStepScheduled = false;
             return;
         }
+        m_imageRequestResumePending = false;
+    }
+    m_imageRequestExecutor->Post([this]() { RunImageRequestStep(); });
+}
 
-        if (!gotRequest) {
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Timeout waiting for image request: status: "
-                << AstraDevice::AstraDeviceStatusToString(m_status) << endLog;
+// ---------------------------------------------------------------------------
+// RunImageRequestStages
+// The shared image-serving loop, as a state machine.  Mirrors SL16XX
+// HandleImageRequests but uses the virtual hooks (PollImageRequest /
+// SendImagePayload / OnImageSent) so both SL16XX (interrupt-driven) and
+// SL26XX (fastboot poll-driven) can plug in.  Each stage either moves on or
+// returns true to wait for the task to be resumed.
+// ---------------------------------------------------------------------------
+bool AstraDeviceImpl::RunImageRequestStages()
+{
+    ASTRA_LOG;
 
-            if (m_status == ASTRA_DEVICE_STATUS_BOOT_PROGRESS) {
-                ReportStatus(ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, "",
-                    "Timeout during boot, press RESET while holding USB_BOOT to try again");
-                m_running.store(false);
-                m_deviceEventCV.notify_all();
-                return;
+    for (;;) {
+        switch (m_imageRequestStage) {
+        case IMAGE_REQUEST_STAGE_WAIT: {
+            if (!m_imageRequestSpan) {
+                m_imageRequestSpan.emplace("WaitForImageRequest", AstraTraceStore::Args{{"device", m_deviceName}});
+                m_imageRequestDeadline = std::chrono::steady_clock::now() + m_imageRequestTimeout;
+                m_servingImageName.clear();
+                m_servingImageType = 0;
             }
 
-            if (m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE) {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "Update complete: shutting down image request thread" << endLog;
-                m_running.store(false);
-                m_deviceEventCV.notify_all();
-                return;
+            const ImageRequestPoll poll = m_running.load() ?
+                PollImageRequest(m_servingImageName, m_servingImageType, m_imageRequestDeadline) : IMAGE_REQUEST_NONE;
+            if (poll == IMAGE_REQUEST_PENDING) {
+                return true;
             }
+            const bool gotRequest = poll == IMAGE_REQUEST_RECEIVED;
+            m_imageRequestSpan->AddArg("image", m_servingImageName);
+            m_imageRequestSpan.reset();
+            m_requestTime = TransferStats::Clock::now();
+            m_transferStats->ArmFirstWrite();
 
-            if (m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE && m_bootOnly) {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "Boot-only complete: shutting down image request thread" << endLog;
-                m_running.store(false);
+            if (!m_running.load()) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Image request task: shutting down" << endLog;
                 m_deviceEventCV.notify_all();
-                return;
+                return false;
             }
 
-            if (m_status == ASTRA_DEVICE_STATUS_BOOT_START) {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "Boot failed to start" << endLog;
-                m_running.store(false);
-                m_deviceEventCV.notify_all();
-                return;
+            if (!gotRequest) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Timeout waiting for image request: status: "
+                    << AstraDevice::AstraDeviceStatusToString(m_status) << endLog;
+
+                if (m_status == ASTRA_DEVICE_STATUS_BOOT_PROGRESS) {
+                    ReportStatus(ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, "",
+                        "Timeout during boot, press RESET while holding USB_BOOT to try again");
+                    m_running.store(false);
+                    m_deviceEventCV.notify_all();
+                    return false;
+                }
+
+                if (m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE) {
+                    log(ASTRA_LOG_LEVEL_DEBUG) << "Update complete: shutting down image request task" << endLog;
+                    m_running.store(false);
+                    m_deviceEventCV.notify_all();
+                    return false;
+                }
+
+                if (m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE && m_bootOnly) {
+                    log(ASTRA_LOG_LEVEL_DEBUG) << "Boot-only complete: shutting down image request task" << endLog;
+                    m_running.store(false);
+                    m_deviceEventCV.notify_all();
+                    return false;
+                }
+
+                if (m_status == ASTRA_DEVICE_STATUS_BOOT_START) {
+                    log(ASTRA_LOG_LEVEL_DEBUG) << "Boot failed to start" << endLog;
+                    m_running.store(false);
+                    m_deviceEventCV.notify_all();
+                    return false;
+                }
+
+                // Wait for the next request.
+                continue;
             }
 
+            // Strip a leading directory component (e.g. "boot/uEnv.txt" → "uEnv.txt").
+            if (m_servingImageName.find('/') != std::string::npos) {
+                size_t pos = m_servingImageName.find('/');
+                std::string prefix = m_servingImageName.substr(0, pos);
+                m_servingImageName = m_servingImageName.substr(pos + 1);
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Image name prefix: '" << prefix
+                    << "', name: '" << m_servingImageName << "'" << endLog;
+            }
+
+            // Bulk update transfers are admitted through the scheduler; boot images are not.
+            if (m_deviceScheduler != nullptr && m_transferSlot == nullptr && !m_bootOnly &&
+                (m_status == ASTRA_DEVICE_STATUS_UPDATE_START || m_status == ASTRA_DEVICE_STATUS_UPDATE_PROGRESS))
+            {
+                m_imageRequestSpan.emplace("WaitForTransferSlot", AstraTraceStore::Args{{"device", m_deviceName}});
+                m_imageRequestStage = IMAGE_REQUEST_STAGE_SLOT;
+                AwaitImageRequestOperation();
+                const uint64_t ticket = m_deviceScheduler->RequestTransferSlot(m_deviceName, GetUSBPath(),
+                    GetTransferMemory(), [this](std::unique_ptr<DeviceScheduler::TransferSlot> slot) {
+                        m_transferSlot = std::move(slot);
+                        CompleteImageRequestOperation();
+                    });
+                std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+                m_transferSlotTicket = ticket;
+                return true;
+            }
+
+            m_imageRequestStage = IMAGE_REQUEST_STAGE_IMAGES;
             continue;
         }
 
-        // Strip a leading directory component (e.g. "boot/uEnv.txt" → "uEnv.txt").
-        if (requestedImageName.find('/') != std::string::npos) {
-            size_t pos = requestedImageName.find('/');
-            std::string prefix = requestedImageName.substr(0, pos);
-            requestedImageName = requestedImageName.substr(pos + 1);
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Image name prefix: '" << prefix
-                << "', name: '" << requestedImageName << "'" << endLog;
-        }
+        case IMAGE_REQUEST_STAGE_SLOT:
+            {
+                std::lock_guard<std::mutex> lock(m_imageRequestTaskMutex);
+                m_transferSlotTicket = 0;
+            }
+            m_imageRequestSpan.reset();
+            if (m_transferSlot == nullptr) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Image request task: shut down while waiting for a transfer slot" << endLog;
+                m_running.store(false);
+                m_deviceEventCV.notify_all();
+                return false;
+            }
+            m_imageRequestStage = IMAGE_REQUEST_STAGE_IMAGES;
+            continue;
 
-        {
-            std::lock_guard<std::mutex> lock(m_imageMutex);
+        case IMAGE_REQUEST_STAGE_IMAGES: {
+            std::unique_lock<std::mutex> lock(m_imageMutex);
+
+            auto it = std::find_if(m_images.begin(), m_images.end(), [this](const Image &img) {
+                return img.GetName() == m_servingImageName;
+            });
 
-            auto it = std::find_if(m_images.begin(), m_images.end(),
-                [&requestedImageName](const Image &img) {
-                    return img.GetName() == requestedImageName;
-                });
+            // A board already past its boot stage can ask for an update image
+            // before Update() has added them.
+            if (it == m_images.end() && !m_bootOnly && !m_updateImagesAdded && m_running.load()) {
+                const auto now = std::chrono::steady_clock::now();
+                if (m_updateImagesDeadline == std::chrono::steady_clock::time_point{}) {
+                    log(ASTRA_LOG_LEVEL_DEBUG) << "Waiting for update images before serving: " << m_servingImageName << endLog;
+                    m_updateImagesDeadline = now + kUpdateImagesTimeout;
+                }
+                if (now < m_updateImagesDeadline) {
+                    // AppendUpdateImages() resumes the task.
+                    ResumeImageRequestTaskAt(m_updateImagesDeadline);
+                    return true;
+                }
+            }
+            m_updateImagesDeadline = {};
 
             if (it == m_images.end()) {
-                log(ASTRA_LOG_LEVEL_ERROR) << "Requested image not found: " << requestedImageName << endLog;
+                log(ASTRA_LOG_LEVEL_ERROR) << "Requested image not found: " << m_servingImageName << endLog;
                 if (m_status == ASTRA_DEVICE_STATUS_BOOT_START ||
                     m_status == ASTRA_DEVICE_STATUS_BOOT_PROGRESS)
                 {
-                    ReportStatus(ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, requestedImageName,
-                        requestedImageName + " image not found");
+                    ReportStatus(ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, m_servingImageName,
+                        m_servingImageName + " image not found");
                 } else if (m_status == ASTRA_DEVICE_STATUS_UPDATE_START ||
                            m_status == ASTRA_DEVICE_STATUS_UPDATE_PROGRESS)
                 {
-                    ReportStatus(ASTRA_DEVICE_STATUS_UPDATE_FAIL, 0, requestedImageName,
-                        requestedImageName + " image not found");
+                    ReportStatus(ASTRA_DEVICE_STATUS_UPDATE_FAIL, 0, m_servingImageName,
+                        m_servingImageName + " image not found");
                 } else {
-                    log(ASTRA_LOG_LEVEL_WARNING) << "Requested image not found: " << requestedImageName
+                    log(ASTRA_LOG_LEVEL_WARNING) << "Requested image not found: " << m_servingImageName
                         << " while in " << AstraDevice::AstraDeviceStatusToString(m_status) << endLog;
                 }
                 m_running.store(false);
                 m_deviceEventCV.notify_all();
-                return;
+                return false;
             }
 
-            Image &image = *it;
+            StartServingImage(*it);
+            m_imageRequestStage = IMAGE_REQUEST_STAGE_SEND;
+            continue;
+        }
 
-            if (m_status == ASTRA_DEVICE_STATUS_BOOT_START) {
-                m_status = ASTRA_DEVICE_STATUS_BOOT_PROGRESS;
-            } else if (m_status == ASTRA_DEVICE_STATUS_UPDATE_START) {
-                m_status = ASTRA_DEVICE_STATUS_UPDATE_PROGRESS;
-            }
+        case IMAGE_REQUEST_STAGE_SEND: {
+            bool sessionComplete = false;
+            {
+                std::unique_lock<std::mutex> lock(m_imageMutex);
+                const int ret = SendServingImage();
+                if (ret == kImageSendPending) {
+                    return true;
+                }
+                if (!FinishServingImage(ret)) {
+                    return false;
+                }
 
-            if (!ShouldSuppressImageStatus(image.GetName())) {
-                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_START, 0, image.GetName());
+                // The device asks for nothing after its final image or size
+                // request, so there is no next request to wait out.
+                sessionComplete = m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE ||
+                    (m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE && m_bootOnly);
             }
 
-            int ret = SendImagePayload(image);
-            log(ASTRA_LOG_LEVEL_DEBUG) << "After SendImagePayload: " << image.GetName() << endLog;
-
-            if (ret < 0) {
-                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to send image: " << image.GetName() << endLog;
-                if (m_status == ASTRA_DEVICE_STATUS_BOOT_START ||
-                    m_status == ASTRA_DEVICE_STATUS_BOOT_PROGRESS)
+            if (sessionComplete) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << AstraDevice::AstraDeviceStatusToString(m_status)
+                    << ": shutting down image request task" << endLog;
                 {
-                    m_status = ASTRA_DEVICE_STATUS_BOOT_FAIL;
-                } else if (m_status == ASTRA_DEVICE_STATUS_UPDATE_START ||
-                           m_status == ASTRA_DEVICE_STATUS_UPDATE_PROGRESS)
-                {
-                    m_status = ASTRA_DEVICE_STATUS_UPDATE_FAIL;
-                }
-                if (!ShouldSuppressImageStatus(image.GetName())) {
-                    ReportStatus(m_status, 0, image.GetName(), "Failed to send image");
+                    // Under the mutex so a WaitForCompletion() about to wait sees it.
+                    std::lock_guard<std::mutex> lock(m_deviceEventMutex);
+                    m_running.store(false);
                 }
-                OnImageSent(image, false);
-                m_running.store(false);
                 m_deviceEventCV.notify_all();
-                return;
+                return false;
             }
 
-            if (!ShouldSuppressImageStatus(image.GetName())) {
-                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE, 100, image.GetName());
-            }
+            m_imageRequestStage = IMAGE_REQUEST_STAGE_WAIT;
+            continue;
+        }
+        }
+    }
+}
 
-            OnImageSent(image, true);
+// ---------------------------------------------------------------------------
+// StartServingImage / SendServingImage / FinishServingImage
+// One request from its image being found to its completion tracking; all
+// three run with m_imageMutex held.
+// ---------------------------------------------------------------------------
+void AstraDeviceImpl::StartServingImage(Image &image)
+{
+    ASTRA_LOG;
 
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Image sent: " << image.GetName()
-                << "  finalBoot='" << m_finalBootImage
-                << "'  finalUpdate='" << m_finalUpdateImage << "'" << endLog;
+    PrefetchNextImage(image.GetName());
 
-            // ---- completion tracking ----
-            if (!m_finalBootImage.empty() &&
-                image.GetName().find(m_finalBootImage) != std::string::npos)
-            {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "Final boot image sent" << endLog;
-                if (!m_bootOnly) {
-                    m_status = ASTRA_DEVICE_STATUS_BOOT_COMPLETE;
-                    ReportStatus(m_status, 100, "", "Success");
-                } else {
-                    // In boot-only mode the size-request image (07_IMAGE for SL16XX) gates
-                    // completion; skip if no size-request image is configured.
-                    waitForSizeRequest = !m_sizeRequestImageFilename.empty();
-                    if (!waitForSizeRequest) {
-                        // No size-request handshake; boot is complete once the final image is served.
-                        m_status = ASTRA_DEVICE_STATUS_BOOT_COMPLETE;
-                    }
-                }
-            } else if (!m_finalUpdateImage.empty() &&
-                       image.GetName().find(m_finalUpdateImage) != std::string::npos)
-            {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "Final update image sent" << endLog;
-                if (!m_sizeRequestImageFilename.empty() &&
-                    (image.GetImageType() == ASTRA_IMAGE_TYPE_UPDATE_EMMC ||
-                     image.GetImageType() == ASTRA_IMAGE_TYPE_UPDATE_SPI))
-                {
-                    waitForSizeRequest = true;
-                } else {
-                    m_status = ASTRA_DEVICE_STATUS_UPDATE_COMPLETE;
-                }
-            } else if (waitForSizeRequest &&
-                       !m_sizeRequestImageFilename.empty() &&
-                       image.GetName() == m_sizeRequestImageFilename)
-            {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "Size-request image sent" << endLog;
-                m_status = ASTRA_DEVICE_STATUS_UPDATE_COMPLETE;
-                waitForSizeRequest = false;
-            }
+    if (m_status == ASTRA_DEVICE_STATUS_BOOT_START) {
+        m_status = ASTRA_DEVICE_STATUS_BOOT_PROGRESS;
+    } else if (m_status == ASTRA_DEVICE_STATUS_UPDATE_START) {
+        m_status = ASTRA_DEVICE_STATUS_UPDATE_PROGRESS;
+    }
+
+    if (!ShouldSuppressImageStatus(image.GetName())) {
+        ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_START, 0, image.GetName());
+    }
+
+    m_imageRequestSpan.emplace("SendImage", AstraTraceStore::Args{{"device", m_deviceName}, {"image", image.GetName()}});
+    m_servingImage = &image;
+    m_servingUpdateImage = image.GetImageType() != ASTRA_IMAGE_TYPE_BOOT &&
+        image.GetName() != m_sizeRequestImageFilename;
+    m_servingResumed = m_servingUpdateImage && IsImageCheckpointed(image);
+    m_servingSkipped = m_servingResumed ||
+        (m_deltaUpdate && !image.GetDigest().empty() && IsImageUnchanged(image));
+    m_servingVerify = m_verifyUpdate && m_servingUpdateImage;
+    m_servingSendStarted = false;
+    m_servingFailReason = "Failed to send image";
+
+    // Delta and verified updates check each image on the device, so
+    // their images are staged one at a time.
+    m_servingBatch = {&image};
+    if (m_servingUpdateImage && !m_servingSkipped && !m_deltaUpdate && !m_verifyUpdate) {
+        m_servingBatch = CollectImageBatch(image);
+        if (m_servingBatch.size() > 1) {
+            FitImageBatch(m_servingBatch);
+        }
+    }
+
+    if (m_servingResumed) {
+        log(ASTRA_LOG_LEVEL_INFO) << "Image sent before the interruption, skipping: " << image.GetName() << endLog;
+    } else if (m_servingSkipped) {
+        log(ASTRA_LOG_LEVEL_INFO) << "Image unchanged on device, skipping: " << image.GetName() << endLog;
+    } else if (m_servingBatch.size() > 1) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Staging " << m_servingBatch.size() << " images in one download, from "
+            << image.GetName() << " to " << m_servingBatch.back()->GetName() << endLog;
+        m_imageRequestSpan->AddArg("batch", std::to_string(m_servingBatch.size()));
+    }
+}
+
+int AstraDeviceImpl::SendServingImage()
+{
+    ASTRA_LOG;
+
+    Image &image = *m_servingImage;
+
+    if (m_servingSkipped) {
+        return 0;
+    }
 
-            ++m_imageCount;
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Image count: " << m_imageCount << endLog;
+    if (m_servingBatch.size() > 1) {
+        return SendImageBatch(m_servingBatch);
+    }
+
+    if (!m_servingSendStarted) {
+        m_servingSendStarted = true;
+        if (m_servingVerify) {
+            StartImageDigest();
+        }
+        if (m_servingUpdateImage) {
+            BeginTunedTransfer(image);
+        }
+    }
+
+    int ret = SendImagePayload(image);
+    if (ret == kImageSendPending) {
+        return ret;
+    }
+
+    if (m_servingUpdateImage) {
+        EndTunedTransfer(image, ret == 0);
+    }
+    log(ASTRA_LOG_LEVEL_DEBUG) << "After SendImagePayload: " << image.GetName() << endLog;
+    if (m_servingVerify && !VerifyImage(image, ret == 0)) {
+        ret = -1;
+        m_servingFailReason = "Image verification failed";
+    }
+
+    return ret;
+}
+
+// Returns false if the request failed, which ends the task.
+bool AstraDeviceImpl::FinishServingImage(int ret)
+{
+    ASTRA_LOG;
+
+    Image &image = *m_servingImage;
+    m_servingImage = nullptr;
+
+    m_imageRequestSpan->AddArg("bytes", std::to_string(image.GetSize()));
+    m_imageRequestSpan->AddArg("result", ret < 0 ? "fail" : (m_servingSkipped ? "skipped" : "ok"));
+    m_imageRequestSpan.reset();
+
+    if (ret < 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to send image: " << image.GetName() << endLog;
+        if (m_status == ASTRA_DEVICE_STATUS_BOOT_START ||
+            m_status == ASTRA_DEVICE_STATUS_BOOT_PROGRESS)
+        {
+            m_status = ASTRA_DEVICE_STATUS_BOOT_FAIL;
+        } else if (m_status == ASTRA_DEVICE_STATUS_UPDATE_START ||
+                   m_status == ASTRA_DEVICE_STATUS_UPDATE_PROGRESS)
+        {
+            m_status = ASTRA_DEVICE_STATUS_UPDATE_FAIL;
+        }
+        if (!ShouldSuppressImageStatus(image.GetName())) {
+            ReportStatus(m_status, 0, image.GetName(), m_servingFailReason);
+        }
+        OnImageSent(image, false);
+        m_running.store(false);
+        m_deviceEventCV.notify_all();
+        return false;
+    }
+
+    if (!ShouldSuppressImageStatus(image.GetName())) {
+        ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE, 100, image.GetName(),
+            m_servingResumed ? "Already sent" : (m_servingSkipped ? "Unchanged" : ""));
+    }
+
+    RecordImageStats(image, m_servingSkipped, m_requestTime);
+
+    if (m_servingSkipped) {
+        OnImageSkipped(image);
+    } else {
+        OnImageSent(image, true);
+    }
+
+    if (m_servingUpdateImage && !m_servingResumed) {
+        CheckpointImage(image);
+    }
+
+    // The rest of a batch went down with the requested image.
+    for (size_t i = 1; i < m_servingBatch.size(); ++i) {
+        Image &batched = *m_servingBatch[i];
+        if (!ShouldSuppressImageStatus(batched.GetName())) {
+            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_START, 0, batched.GetName());
+            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE, 100, batched.GetName(), "Batched");
+        }
+        RecordImageStats(batched, false, m_requestTime);
+        CheckpointImage(batched);
+        PrefetchNextImage(batched.GetName());
+        ++m_imageCount;
+    }
+    m_servingBatch.clear();
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Image sent: " << image.GetName()
+        << "  finalBoot='" << m_finalBootImage
+        << "'  finalUpdate='" << m_finalUpdateImage << "'" << endLog;
+
+    // ---- completion tracking ----
+    if (!m_finalBootImage.empty() &&
+        image.GetName().find(m_finalBootImage) != std::string::npos)
+    {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Final boot image sent" << endLog;
+        if (!m_bootOnly) {
+            m_status = ASTRA_DEVICE_STATUS_BOOT_COMPLETE;
+            ReportStatus(m_status, 100, "", "Success");
+        } else {
+            // In boot-only mode the size-request image (07_IMAGE for SL16XX) gates
+            // completion; skip if no size-request image is configured.
+            m_waitForSizeRequest = !m_sizeRequestImageFilename.empty();
+            if (!m_waitForSizeRequest) {
+                // No size-request handshake; boot is complete once the final image is served.
+                m_status = ASTRA_DEVICE_STATUS_BOOT_COMPLETE;
+            }
+        }
+    } else if (!m_finalUpdateImage.empty() &&
+               image.GetName().find(m_finalUpdateImage) != std::string::npos)
+    {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Final update image sent" << endLog;
+        if (!m_sizeRequestImageFilename.empty() &&
+            (image.GetImageType() == ASTRA_IMAGE_TYPE_UPDATE_EMMC ||
+             image.GetImageType() == ASTRA_IMAGE_TYPE_UPDATE_SPI))
+        {
+            m_waitForSizeRequest = true;
+        } else {
+            m_status = ASTRA_DEVICE_STATUS_UPDATE_COMPLETE;
         }
+    } else if (m_waitForSizeRequest &&
+               !m_sizeRequestImageFilename.empty() &&
+               image.GetName() == m_sizeRequestImageFilename)
+    {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Size-request image sent" << endLog;
+        m_status = ASTRA_DEVICE_STATUS_UPDATE_COMPLETE;
+        m_waitForSizeRequest = false;
     }
+
+    if (m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE && m_updateCheckpoints != nullptr) {
+        m_updateCheckpoints->Clear(m_updateSessionUuid);
+    }
+
+    ++m_imageCount;
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Image count: " << m_imageCount << endLog;
+
+    return true;
 }
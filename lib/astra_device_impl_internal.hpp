@@ -7,9 +7,11 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <sstream>
 #include <iomanip>
@@ -20,7 +22,19 @@
 #include "astra_device.hpp"
 #include "astra_device_manager.hpp"
 #include "astra_log.hpp"
+#include "boot_packet_cache.hpp"
+#include "boot_sessions.hpp"
+#include "device_scheduler.hpp"
+#include "event_executor.hpp"
 #include "image.hpp"
+#include "image_broadcast.hpp"
+#include "image_store.hpp"
+#include "response_times.hpp"
+#include "stream_digest.hpp"
+#include "astra_trace.hpp"
+#include "transfer_stats.hpp"
+#include "transfer_tuner.hpp"
+#include "update_checkpoints.hpp"
 #include "usb_device.hpp"
 
 class AstraDeviceImpl {
@@ -30,6 +44,10 @@ public:
         : m_usbDevice{std::move(device)}, m_tempDir{tempDir}, m_bootOnly{bootOnly}, m_bootCommand{bootCommand}
     {
         ASTRA_LOG;
+
+        if (m_usbDevice != nullptr) {
+            m_usbDevice->SetTransferStats(m_transferStats);
+        }
     }
 
     virtual ~AstraDeviceImpl()
@@ -70,6 +88,97 @@ public:
         m_unregisterFastbootSerial = std::move(unregisterFn);
     }
 
+    /**
+     * Share the manager's image store so boot and update images are served
+     * from one mapping per file instead of being re-read by every device.
+     */
+    void SetImageStore(std::shared_ptr<ImageStore> imageStore)
+    {
+        m_imageStore = std::move(imageStore);
+    }
+
+    /**
+     * Share the manager's image broadcast so devices sending the same
+     * compressed image together decompress it once.
+     */
+    void SetImageBroadcast(std::shared_ptr<ImageBroadcast> imageBroadcast)
+    {
+        m_imageBroadcast = std::move(imageBroadcast);
+    }
+
+    /**
+     * Share the manager's boot packet cache; implementations with a fixed ROM
+     * handshake build their packets once per boot image there.
+     */
+    void SetBootPacketCache(std::shared_ptr<BootPacketCache> bootPacketCache)
+    {
+        m_bootPacketCache = std::move(bootPacketCache);
+    }
+
+    /**
+     * Share the manager's response times; implementations with a ROM
+     * handshake take their timeouts from it.
+     */
+    void SetResponseTimes(std::shared_ptr<ResponseTimes> responseTimes)
+    {
+        m_responseTimes = std::move(responseTimes);
+    }
+
+    /**
+     * Share the manager's event executor; the USB device hands it its
+     * events instead of running a callback thread of its own.
+     */
+    void SetEventExecutor(std::shared_ptr<EventExecutor> eventExecutor)
+    {
+        m_eventExecutor = std::move(eventExecutor);
+        if (m_usbDevice) {
+            m_usbDevice->SetEventExecutor(m_eventExecutor);
+        }
+    }
+
+    /**
+     * Share the manager's scheduler so the update phase waits for a
+     * transfer slot when the number of concurrent updates is limited.
+     */
+    void SetDeviceScheduler(std::shared_ptr<DeviceScheduler> scheduler)
+    {
+        m_deviceScheduler = std::move(scheduler);
+    }
+
+    /**
+     * Share the manager's transfer tuner, which picks the chunk size and
+     * write queue depth each update image is sent with.
+     */
+    void SetTransferTuner(std::shared_ptr<TransferTuner> transferTuner)
+    {
+        m_transferTuner = std::move(transferTuner);
+    }
+
+    /**
+     * Share the manager's update checkpoints, which let a board that comes
+     * back during its update skip the images it already acknowledged.
+     */
+    void SetUpdateCheckpoints(std::shared_ptr<UpdateCheckpoints> updateCheckpoints)
+    {
+        m_updateCheckpoints = std::move(updateCheckpoints);
+    }
+
+    /**
+     * Share the manager's boot sessions; the session UUID of each uEnv.txt
+     * written is recorded in them, and in the update checkpoints, for job.
+     */
+    void SetBootSessions(std::shared_ptr<BootSessions> bootSessions, const std::string &job)
+    {
+        m_bootSessions = std::move(bootSessions);
+        m_bootSessionJob = job;
+    }
+
+    /** How long the image request loop waits for a request which never comes. */
+    void SetImageRequestTimeout(std::chrono::seconds timeout)
+    {
+        m_imageRequestTimeout = timeout;
+    }
+
     virtual std::string GetDeviceName()
     {
         return m_deviceName;
@@ -114,11 +223,24 @@ protected:
         log(ASTRA_LOG_LEVEL_INFO) << "Device status: " << AstraDevice::AstraDeviceStatusToString(status)
             << " Progress: " << progress << " Image: " << imageName << " Message: " << message << endLog;
 
+        const bool finalStatus = status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE ||
+            status == ASTRA_DEVICE_STATUS_UPDATE_FAIL ||
+            status == ASTRA_DEVICE_STATUS_BOOT_FAIL ||
+            (status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE && m_bootOnly);
+        if (finalStatus && !m_transferStatsReported.exchange(true)) {
+            AstraTraceStore::getInstance().AddInstant(AstraDevice::AstraDeviceStatusToString(status),
+                {{"device", m_deviceName}, {"message", message}});
+            ReportTransferStats();
+        }
+
         if (m_statusCallback) {
             m_statusCallback({DeviceResponse{m_deviceName, status, progress, imageName, message}});
         }
     }
 
+    // Send the accumulated transfer counters to the status callback and log them.
+    void ReportTransferStats();
+
     // -----------------------------------------------------------------------
     // Shared image-request loop infrastructure
     // Derived classes call BuildBootImageList / AppendUpdateImages / Start/Stop,
@@ -133,33 +255,130 @@ protected:
     // Append flash-image sub-images to m_images; update final-image tracking.
     void AppendUpdateImages(std::shared_ptr<FlashImage> flashImage);
 
+    // Add one image's timing to m_transferStats once its request is answered.
+    void RecordImageStats(const Image &image, bool skipped, TransferStats::Clock::time_point requestTime);
+
+    // Speculatively warm the image expected after currentName in
+    // m_updateImageOrder, so its first reads overlap the current transfer,
+    // and hand it to PrepareImage().  A wrong guess costs only page cache
+    // and the transport's preparation.  Called with m_imageMutex held.
+    void PrefetchNextImage(const std::string &currentName);
+
+    // Verify updates: begin digesting the image about to be sent, then, once
+    // SendImagePayload returned, compare the digest with the manifest sha256
+    // and call VerifyImageOnDevice().  Returns false if verification failed.
+    void StartImageDigest();
+    bool VerifyImage(const Image &image, bool sent);
+
+    // Transfer tuning: apply the parameters m_transferTuner selects for an
+    // update image before SendImagePayload, and report how fast it went.
+    void BeginTunedTransfer(const Image &image);
+    void EndTunedTransfer(const Image &image, bool sent);
+
+    // Resumed updates: record an image list entry the device acknowledged,
+    // and on a later connection of the same session, tell whether it still
+    // holds it.  The first time it does, OnResumeUpdate() is told which
+    // entry of m_updateImageOrder comes next, and decides whether checkpoints
+    // are used at all.  Called with m_imageMutex held.
+    bool IsResumable(const Image &image);
+    void CheckpointImage(const Image &image);
+    bool IsImageCheckpointed(const Image &image);
+
+    // Batched staging: the requested image followed by the image list entries
+    // expected right after it, for FitImageBatch() to trim.  Called with
+    // m_imageMutex held.
+    std::vector<Image *> CollectImageBatch(Image &image);
+
+    // Attach shared mappings from m_imageStore (if set) to images read from the
+    // boot / update directories.  Synthesised per-device images are not mapped
+    // since they are rewritten during the session.
+    void MapImages(std::vector<Image> &images);
+
+    // MapImages() for a boot image set: its files are read once into one
+    // arena of m_imageStore, so boot image requests never touch the disk.
+    // Falls back to MapImages() for a set that does not fit.
+    void MapImageSet(std::vector<Image> &images);
+
     // Write a uEnv.txt to m_deviceDir with "bootcmd=<bootCommand>".
     bool WriteUEnvFile(const std::string &bootCommand);
 
-    // Start the image-request thread.  Waits until the thread signals ready.
-    int StartImageRequestThread();
+    // "device:1-2.3" -> "device1-2_3", safe for use as a directory name.
+    static std::string MakeDeviceDirName(const std::string &deviceName);
+
+    // Open <tempDir>/<device dir>/device.log (when per-device logs are enabled)
+    // and route the calling thread's log records to it.  Call once m_deviceName is set.
+    void OpenDeviceLog();
+
+    // Start serving image requests as a task on m_eventExecutor, or on an
+    // executor thread of this device's own when the manager shares none.
+    // The task runs in steps which never overlap; a step returns whenever
+    // the task would wait, and the task is resumed by the hooks below.
+    int StartImageRequestTask();
+
+    // Signal shutdown, wait for the image-request task to finish and clear
+    // m_images.  Must not be called from the task itself.
+    void StopImageRequestTask();
+
+    // True from StartImageRequestTask() until StopImageRequestTask().
+    bool IsImageRequestTaskStarted();
+
+    // Run the task's next step: call whenever something it waits for may
+    // have changed, e.g. an image request arrived.  Safe from any thread.
+    void ResumeImageRequestTask();
+
+    // Resume the task at time unless something resumes it earlier.  There is
+    // one such timer per device; arming it again replaces the earlier one.
+    void ResumeImageRequestTaskAt(std::chrono::steady_clock::time_point time);
+
+    // For hooks waiting on an asynchronous operation, e.g. a USB read: call
+    // AwaitImageRequestOperation() when returning pending, and have the
+    // operation's completion call the ImageRequestResumer().  No step runs
+    // while an operation is outstanding, so the completion may hand its
+    // results to the next step through members.
+    void AwaitImageRequestOperation();
+    void CompleteImageRequestOperation();
+    std::function<void()> ImageRequestResumer()
+    {
+        return [this]() { CompleteImageRequestOperation(); };
+    }
 
-    // Signal shutdown and join the image-request thread; clears m_images.
-    // Derived Close() must also call WakeImageRequestThread() (or equivalent)
-    // BEFORE calling StopImageRequestThread() so the thread wakes promptly.
-    void StopImageRequestThread();
+    // Non-blocking queued writes for SendImagePayload(): true if the next
+    // AcquireWriteBuffer() / WriteQueued() (or FlushQueuedWrites()) will not
+    // wait.  Otherwise the task is resumed once it will not and the hook
+    // returns kImageSendPending.
+    bool PollWriteBuffer();
+    bool PollQueuedWrites();
 
     // -----------------------------------------------------------------------
     // Transport-specific hooks (override in derived classes)
     // -----------------------------------------------------------------------
 
-    // Block until the next image-request arrives.
-    // Returns true if a request was received, false on timeout / shutdown.
+    enum ImageRequestPoll {
+        IMAGE_REQUEST_NONE,         // timed out, shutting down or failed
+        IMAGE_REQUEST_RECEIVED,
+        IMAGE_REQUEST_PENDING,      // the hook arranged for the task to be resumed
+    };
+
+    // Check for the next image request without waiting for it.  Until deadline
+    // passes, return IMAGE_REQUEST_PENDING after arranging to be resumed
+    // (ResumeImageRequestTaskAt(deadline), an asynchronous operation or a
+    // ResumeImageRequestTask() from an event); the hook is then called again.
+    // The hook may move deadline, e.g. while the device re-enumerates.
     // imageType: transport-specific type byte (0 when unused, e.g. fastboot).
-    virtual bool WaitForImageRequest(std::string &name, uint8_t &imageType,
-        std::chrono::milliseconds timeout)
+    virtual ImageRequestPoll PollImageRequest(std::string &name, uint8_t &imageType,
+        std::chrono::steady_clock::time_point &deadline)
     {
-        (void)name; (void)imageType; (void)timeout;
-        return false;
+        (void)name; (void)imageType; (void)deadline;
+        return IMAGE_REQUEST_NONE;
     }
 
-    // Send the image payload to the device.  Returns 0 on success, < 0 on failure.
-    // Called while m_imageMutex is held; do not re-enter the lock.
+    // SendImagePayload() or SendImageBatch() is waiting for the device; it is
+    // called again with the same images when the task resumes.
+    static constexpr int kImageSendPending = 1;
+
+    // Send the image payload to the device.  Returns 0 on success, < 0 on
+    // failure, or kImageSendPending.  Called while m_imageMutex is held; do
+    // not re-enter the lock.
     virtual int SendImagePayload(Image &image)
     {
         (void)image;
@@ -175,6 +394,123 @@ protected:
         (void)image; (void)success;
     }
 
+    // Delta updates: return true if the device already holds image (its digest
+    // matches Image::GetDigest()), so the payload can be skipped.  Only called
+    // when the flash image enables delta updates.
+    // Default: never skip (the transport cannot acknowledge without a payload).
+    virtual bool IsImageUnchanged(const Image &image)
+    {
+        (void)image;
+        return false;
+    }
+
+    // Verify updates: check that the device holds image, whose contents hash
+    // to expectedDigest, once it has been sent.  The check may be deferred
+    // while the next image is sent; a failure then fails that request.
+    // Return false to fail the update.
+    // Default: nothing to check on the device.
+    virtual bool VerifyImageOnDevice(const Image &image, const std::string &expectedDigest)
+    {
+        (void)image; (void)expectedDigest;
+        return true;
+    }
+
+    // Called instead of SendImagePayload / OnImageSent for a skipped image;
+    // must acknowledge the request without sending the payload.
+    // Default: treat as a successful send.
+    virtual void OnImageSkipped(const Image &image)
+    {
+        OnImageSent(image, true);
+    }
+
+    // Verify updates: SendImagePayload passes each block of image data here as
+    // it is sent, so the digest is computed alongside the transfer.  No-op
+    // unless the image being sent is verified.  DigestSharedImageData() does
+    // not copy: data must stay valid until SendImagePayload returns.
+    void DigestImageData(const uint8_t *data, size_t size)
+    {
+        if (m_digestActive) {
+            m_streamDigest->Update(data, size);
+            m_digestedBytes += size;
+        }
+    }
+
+    void DigestSharedImageData(const uint8_t *data, size_t size)
+    {
+        if (m_digestActive) {
+            m_streamDigest->UpdateShared(data, size);
+            m_digestedBytes += size;
+        }
+    }
+
+    bool IsImageDigestActive() const { return m_digestActive; }
+
+    // Transfer tuning: the chunk sizes update images may be sent in, the one
+    // used by default first, and the hook applying the selected one.
+    // Default: none, so transfers are not tuned.
+    virtual std::vector<size_t> GetTunableChunkSizes() const
+    {
+        return {};
+    }
+
+    virtual void SetTransferChunkSize(size_t chunkSize)
+    {
+        (void)chunkSize;
+    }
+
+    // Memory budget: bytes of transfer buffers the update phase may hold at
+    // once, reserved from the scheduler's budget with the transfer slot.
+    // Default: the write queue filled with chunks of the tunable sizes, or
+    // what the tuner may try; 0 if transfers are not tunable.
+    virtual uint64_t GetTransferMemory() const;
+
+    // Resumed updates: true if the device reports the same session UUID each
+    // time it connects (see m_updateSessionUuid), so it can be checkpointed.
+    // Default: no session identity, so every update starts over.
+    virtual bool CanResumeUpdate() const
+    {
+        return false;
+    }
+
+    // Resumed updates: called once, when the device first requests an image
+    // it already holds, with the first one it still needs (empty if it holds
+    // them all).  Return true if the device can be told to skip the images it
+    // holds, after telling it to continue its image list at nextImageName;
+    // false sends every image again.
+    // Default: the device cannot skip images.
+    virtual bool OnResumeUpdate(const std::string &nextImageName)
+    {
+        (void)nextImageName;
+        return false;
+    }
+
+    // Batched staging: images holds the requested image and the update images
+    // expected after it.  Trim it to the leading images the device can take
+    // as one download; a single image is staged on its own.
+    // Default: no batches.
+    virtual void FitImageBatch(std::vector<Image *> &images)
+    {
+        images.resize(1);
+    }
+
+    // Batched staging: send the images left by FitImageBatch(), the requested
+    // one first, as one download.  Called instead of SendImagePayload; the
+    // request is then finished with OnImageSent as for a single image.
+    // Returns 0 on success, < 0 on failure, or kImageSendPending.
+    virtual int SendImageBatch(const std::vector<Image *> &images)
+    {
+        (void)images;
+        return -1;
+    }
+
+    // Called for the update image expected after the one being sent, with
+    // m_imageMutex held, so work on it can overlap the current transfer.
+    // Default: nothing beyond the prefetch.
+    virtual void PrepareImage(const Image &image)
+    {
+        (void)image;
+    }
+
     // Return true if status events for the given image name should be suppressed.
     // SL16XX uses this to suppress 07_IMAGE (size-request) status events.
     // Default: never suppress.
@@ -184,37 +520,50 @@ protected:
         return false;
     }
 
-    // Wake any CV that WaitForImageRequest is sleeping on so the thread can see
-    // m_running == false and exit promptly.  Called by StopImageRequestThread().
-    // Default: no-op (works for poll-based implementations with short timeouts).
-    virtual void WakeImageRequestThread() {}
-
     // -----------------------------------------------------------------------
     // Shared state (initialised / used by the image-request loop)
     // -----------------------------------------------------------------------
 
-    std::vector<Image> m_images;
+    // A deque: the image being sent stays put while AppendUpdateImages()
+    // adds the update images between steps of the task.
+    std::deque<Image> m_images;
     std::mutex m_imageMutex;
+    // Set by AppendUpdateImages(); guarded by m_imageMutex.
+    bool m_updateImagesAdded = false;
+    static constexpr std::chrono::seconds kUpdateImagesTimeout{5};
+
+    // Only a safety net: the image request loop ends as soon as the final
+    // image or size request is served or the device goes away.
+    std::chrono::seconds m_imageRequestTimeout{AstraDevice::kDefaultImageRequestTimeout};
 
     std::string m_finalBootImage;
     std::string m_finalUpdateImage;
 
+    // Expected update request order (from emmc_image_list) and the position
+    // just past the most recent request matched against it.
+    std::vector<std::string> m_updateImageOrder;
+    size_t m_updateImageOrderPos = 0;
+    // Batched staging: most images CollectImageBatch() offers at once.
+    static constexpr size_t kMaxImageBatchCount = 16;
+
     // Set empty to disable size-request image logic (SL16XX sets "07_IMAGE").
     std::string m_sizeRequestImageFilename;
 
     bool m_uEnvSupport = false;
     bool m_resetWhenComplete = false;
+    bool m_deltaUpdate = false;
+    bool m_verifyUpdate = false;
+
+    // Digest of the update image being sent, see DigestImageData().
+    std::unique_ptr<StreamDigest> m_streamDigest;
+    bool m_digestActive = false;
+    size_t m_digestedBytes = 0;
 
     std::atomic<bool> m_running{false};
 
     std::condition_variable m_deviceEventCV;
     std::mutex m_deviceEventMutex;
 
-    std::thread m_imageRequestThread;
-    std::condition_variable m_imageRequestThreadReadyCV;
-    std::mutex m_imageRequestThreadReadyMutex;
-    std::atomic<bool> m_imageRequestThreadReady{false};
-
     int m_imageCount = 0;
 
     // Directory used for synthesised images (uEnv.txt, SL16XX-specific files).
@@ -226,11 +575,58 @@ protected:
     // Sessions 2+ (so the same UUID is re-written and U-Boot keeps the same serialno).
     std::string m_updateSessionUuid;
 
+    // Where WriteUEnvFile() records m_updateSessionUuid for m_bootSessionJob;
+    // IsBootSessionOfJob() looks a serial# up there and in the checkpoints.
+    std::shared_ptr<BootSessions> m_bootSessions;
+    std::string m_bootSessionJob;
+    bool IsBootSessionOfJob(const std::string &sessionUuid);
+
     // Callbacks injected by the manager so the impl can register/unregister
     // its UUID in the fastboot-serial rebind registry.
     std::function<void(const std::string &)> m_registerFastbootSerial;
     std::function<void(const std::string &)> m_unregisterFastbootSerial;
 
+    // Process-wide image mappings owned by the manager; may be null.
+    std::shared_ptr<ImageStore> m_imageStore;
+
+    // Shared by the manager's devices when broadcasting is enabled; may be null.
+    std::shared_ptr<ImageBroadcast> m_imageBroadcast;
+
+    // Framed boot packets shared by the manager's devices; may be null.
+    std::shared_ptr<BootPacketCache> m_bootPacketCache;
+
+    // Handshake response times learned by the manager's devices; may be null.
+    std::shared_ptr<ResponseTimes> m_responseTimes;
+
+    // Delivers the USB device's events; null gives it a callback thread.
+    std::shared_ptr<EventExecutor> m_eventExecutor;
+
+    // Held from the first update request until the image-request task ends.
+    // Declared after m_deviceScheduler so the slot is released first.
+    std::shared_ptr<DeviceScheduler> m_deviceScheduler;
+    std::unique_ptr<DeviceScheduler::TransferSlot> m_transferSlot;
+
+    // Shared by the manager's devices when tuning is enabled; may be null.
+    std::shared_ptr<TransferTuner> m_transferTuner;
+    // The transfer BeginTunedTransfer() started, if any.
+    bool m_tunedTransferActive = false;
+    std::string m_tunedLink;
+    TransferTuner::Parameters m_tunedParameters;
+    std::chrono::steady_clock::time_point m_tunedStart;
+
+    // Shared by the manager's devices when resuming is enabled; may be null.
+    // m_updateResumed is set once OnResumeUpdate() has been asked, and
+    // m_updateResumeAccepted if it agreed; otherwise checkpoints are ignored.
+    std::shared_ptr<UpdateCheckpoints> m_updateCheckpoints;
+    bool m_updateResumed = false;
+    bool m_updateResumeAccepted = false;
+
+    // Per-device log sink; null when all devices share the main log.
+    std::shared_ptr<AstraLogSink> m_logSink;
+
+    // Transfer counters; shared with whichever USBDevice is currently bound.
+    std::shared_ptr<TransferStats> m_transferStats = std::make_shared<TransferStats>();
+    std::atomic<bool> m_transferStatsReported{false};
 
     // -----------------------------------------------------------------------
     // Existing base state
@@ -259,8 +655,51 @@ protected:
     std::atomic<bool> m_shutdown{false};
 
 private:
-    void ImageRequestThreadFunc();
-    void RunImageRequestLoop();
+    enum ImageRequestStage {
+        IMAGE_REQUEST_STAGE_WAIT,           // for the next request
+        IMAGE_REQUEST_STAGE_SLOT,           // for a transfer slot
+        IMAGE_REQUEST_STAGE_IMAGES,         // for Update() to add the update images
+        IMAGE_REQUEST_STAGE_SEND,           // for the image, or batch, to be sent
+    };
+
+    void RunImageRequestStep();
+    // Run stages until the task has to wait; false once it is done.
+    bool RunImageRequestStages();
+    // Serving one request: what to send, sending it, and what it completed.
+    void StartServingImage(Image &image);
+    int SendServingImage();
+    bool FinishServingImage(int ret);
+
+    // Scheduling, guarded by m_imageRequestTaskMutex.  At most one step is
+    // posted or running; resumes meanwhile are noted in m_imageRequestResumePending.
+    std::mutex m_imageRequestTaskMutex;
+    std::condition_variable m_imageRequestTaskCV;
+    std::shared_ptr<EventExecutor> m_imageRequestExecutor;
+    bool m_imageRequestTaskStarted = false;
+    bool m_imageRequestTaskFinished = true;
+    bool m_imageRequestStepScheduled = false;
+    bool m_imageRequestResumePending = false;
+    int m_imageRequestOperations = 0;
+    EventExecutor::TimerId m_imageRequestTimer = 0;
+    uint64_t m_transferSlotTicket = 0;
+
+    // Step state; only steps touch it.
+    ImageRequestStage m_imageRequestStage = IMAGE_REQUEST_STAGE_WAIT;
+    std::optional<AstraTraceSpan> m_imageRequestSpan;
+    std::chrono::steady_clock::time_point m_imageRequestDeadline;
+    std::chrono::steady_clock::time_point m_updateImagesDeadline{};
+    TransferStats::Clock::time_point m_requestTime;
+    std::string m_servingImageName;
+    uint8_t m_servingImageType = 0;
+    Image *m_servingImage = nullptr;
+    std::vector<Image *> m_servingBatch;
+    bool m_servingUpdateImage = false;
+    bool m_servingResumed = false;
+    bool m_servingSkipped = false;
+    bool m_servingVerify = false;
+    bool m_servingSendStarted = false;
+    std::string m_servingFailReason;
+    bool m_waitForSizeRequest = false;
 };
 
 std::unique_ptr<AstraDeviceImpl> CreateAstraDeviceSL16XXImpl(std::unique_ptr<USBDevice> device,
@@ -57,12 +57,9 @@ public:
 
         m_deviceName = "device:" + m_usbDevice->GetUSBPath();
         log(ASTRA_LOG_LEVEL_INFO) << "Device name: " << m_deviceName << endLog;
+        OpenDeviceLog();
 
-        std::string modifiedDeviceName = m_deviceName;
-        modifiedDeviceName.erase(
-            std::remove(modifiedDeviceName.begin(), modifiedDeviceName.end(), ':'),
-            modifiedDeviceName.end());
-        std::replace(modifiedDeviceName.begin(), modifiedDeviceName.end(), '.', '_');
+        const std::string modifiedDeviceName = MakeDeviceDirName(m_deviceName);
 
         m_deviceDir = m_tempDir + "/" + modifiedDeviceName;
         std::filesystem::create_directories(m_deviceDir);
@@ -95,8 +92,8 @@ public:
 
         m_status = ASTRA_DEVICE_STATUS_BOOT_START;
 
-        // Start the shared image-request loop thread.
-        StartImageRequestThread();
+        // Start the shared image-request task.
+        StartImageRequestTask();
 
         ret = m_usbDevice->EnableInterrupts();
         if (ret < 0) {
@@ -135,7 +132,9 @@ public:
         if (m_uEnvSupport || m_ubootConsole == ASTRA_UBOOT_CONSOLE_UART) {
             for (;;) {
                 std::unique_lock<std::mutex> lock(m_deviceEventMutex);
-                m_deviceEventCV.wait(lock);
+                if (m_running.load()) {
+                    m_deviceEventCV.wait(lock);
+                }
                 if (m_bootOnly) {
                     if (m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE) {
                         // Device successfully reset after boot.
@@ -205,11 +204,10 @@ public:
             }
         }
 
-        // Wake the image-request thread (m_imageRequestCV) and join it.
-        // StopImageRequestThread() handles m_running=false, deviceEventCV
-        // notify, WakeImageRequestThread() (overridden below to notify
-        // m_imageRequestCV), join, and clears m_images.
-        StopImageRequestThread();
+        // StopImageRequestTask() handles m_running=false, deviceEventCV
+        // notify, resuming the task so it sees the shutdown, waiting for it,
+        // and clears m_images.
+        StopImageRequestTask();
 
         if (m_console != nullptr) {
             m_console->Shutdown();
@@ -226,16 +224,27 @@ public:
     }
 
 private:
-    // Interrupt / image-request signalling.
-    std::condition_variable m_imageRequestCV;
+    // Interrupt / image-request signalling; the name and type are guarded
+    // by m_imageRequestMutex.
     std::mutex m_imageRequestMutex;
     std::atomic<bool> m_imageRequestReady{false};
     uint8_t m_imageType = 0;
     std::string m_requestedImageName;
 
-    // Bulk-write buffer.
+    // Size of each bulk-write block, read straight into the device's transfer buffers.
     static constexpr int m_imageBufferSize = (1 * 1024 * 1024) + 4;
-    uint8_t m_imageBuffer[m_imageBufferSize];
+
+    // SendImagePayload() progress, kept while it waits for the write queue.
+    enum SendStage {
+        SEND_STAGE_IDLE,
+        SEND_STAGE_HEADER,
+        SEND_STAGE_DATA,
+        SEND_STAGE_FLUSH,
+    };
+    SendStage m_sendStage = SEND_STAGE_IDLE;
+    std::unique_ptr<ImageBroadcast::Reader> m_sendBroadcast;
+    int m_sendTransferred = 0;
+    int m_sendTotal = 0;
 
     // Console.
     std::unique_ptr<AstraConsole> m_console;
@@ -250,39 +259,33 @@ private:
     const std::string m_imageRequestString = "i*m*g*r*q*";
 
     // -----------------------------------------------------------------------
-    // Virtual hook: WaitForImageRequest
-    // Uses m_imageRequestCV set by HandleInterrupt (interrupt thread).
+    // Virtual hook: PollImageRequest
+    // Takes the request HandleInterrupt (interrupt thread) left, which also
+    // resumes the task.
     // -----------------------------------------------------------------------
-    bool WaitForImageRequest(std::string &name, uint8_t &imageType,
-        std::chrono::milliseconds timeout) override
+    ImageRequestPoll PollImageRequest(std::string &name, uint8_t &imageType,
+        std::chrono::steady_clock::time_point &deadline) override
     {
         ASTRA_LOG;
 
-        bool notified = false;
-        {
-            std::unique_lock<std::mutex> lock(m_imageRequestMutex);
-            log(ASTRA_LOG_LEVEL_DEBUG) << "WaitForImageRequest: waiting" << endLog;
-
-            notified = m_imageRequestCV.wait_for(lock, timeout, [this] {
-                bool prev = m_imageRequestReady.load();
-                if (prev) {
-                    m_imageRequestReady.store(false);
-                }
-                return prev || !m_running.load();
-            });
+        if (!m_running.load()) {
+            return IMAGE_REQUEST_NONE; // shutdown
         }
 
-        if (!m_running.load()) {
-            return false; // shutdown
+        if (m_imageRequestReady.exchange(false)) {
+            std::lock_guard<std::mutex> lock(m_imageRequestMutex);
+            name      = m_requestedImageName;
+            imageType = m_imageType;
+            return IMAGE_REQUEST_RECEIVED;
         }
 
-        if (!notified) {
-            return false; // timeout
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return IMAGE_REQUEST_NONE; // timeout
         }
 
-        name      = m_requestedImageName;
-        imageType = m_imageType;
-        return true;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "PollImageRequest: waiting" << endLog;
+        ResumeImageRequestTaskAt(deadline);
+        return IMAGE_REQUEST_PENDING;
     }
 
     void HandleInterrupt(uint8_t *buf, size_t size)
@@ -300,6 +303,7 @@ private:
             }
 
             it += m_imageRequestString.size();
+            std::unique_lock<std::mutex> lock(m_imageRequestMutex);
             m_imageType = buf[it];
             log(ASTRA_LOG_LEVEL_DEBUG) << "Image type: " << std::hex << m_imageType << std::dec << endLog;
 
@@ -315,8 +319,10 @@ private:
 
             log(ASTRA_LOG_LEVEL_DEBUG) << "Requested image name: '" << m_requestedImageName << "'" << endLog;
 
+            lock.unlock();
+
             m_imageRequestReady.store(true);
-            m_imageRequestCV.notify_one();
+            ResumeImageRequestTask();
         } else if (m_console != nullptr) {
             m_console->Append(message);
         }
@@ -387,72 +393,134 @@ private:
 
     // -----------------------------------------------------------------------
     // Virtual hook: SendImagePayload
-    // Sends the SL16XX size-header then bulk-streams image data.
-    // START / COMPLETE / FAIL status events are emitted by RunImageRequestLoop;
-    // this method only emits IMAGE_SEND_PROGRESS.
+    // Sends the SL16XX size-header then bulk-streams image data, returning
+    // kImageSendPending whenever the write queue is full.
+    // START / COMPLETE / FAIL status events are emitted by the image request
+    // task; this method only emits IMAGE_SEND_PROGRESS.
     // -----------------------------------------------------------------------
     int SendImagePayload(Image &image) override
     {
         ASTRA_LOG;
 
-        int totalTransferred = 0;
-        int transferred = 0;
+        const int imageHeaderSize = sizeof(uint32_t) * 2;
+        int ret = 0;
 
-        int ret = image.Load();
-        if (ret < 0) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to load image" << endLog;
-            return ret;
+        if (m_sendStage == SEND_STAGE_IDLE) {
+            // Compressed images are decompressed once for all devices sending
+            // them together if broadcasting; a broadcast reader does not load
+            // the image itself.
+            m_sendBroadcast = m_imageBroadcast ? m_imageBroadcast->Join(image) : nullptr;
+
+            ret = m_sendBroadcast ? 0 : image.Load();
+            if (ret < 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to load image" << endLog;
+                return FinishSend(ret);
+            }
+
+            m_sendTransferred = 0;
+            m_sendTotal = image.GetSize() + imageHeaderSize;
+            m_sendStage = SEND_STAGE_HEADER;
         }
 
-        const int imageHeaderSize = sizeof(uint32_t) * 2;
-        uint32_t imageSizeLE = HostToLE(image.GetSize());
-        std::memset(m_imageBuffer, 0, imageHeaderSize);
-        std::memcpy(m_imageBuffer, &imageSizeLE, sizeof(imageSizeLE));
+        // Header and data blocks are queued so earlier blocks are still on the
+        // bus while the next one is read from disk straight into a transfer
+        // buffer.  Each queued write is a separate bulk transfer, matching the
+        // framing the boot ROM expects.
+        if (m_sendStage == SEND_STAGE_HEADER) {
+            if (!PollWriteBuffer()) {
+                return kImageSendPending;
+            }
 
-        const int totalTransferSize = image.GetSize() + imageHeaderSize;
+            uint32_t imageSizeLE = HostToLE(image.GetSize());
+            uint8_t imageHeader[imageHeaderSize] = {};
+            std::memcpy(imageHeader, &imageSizeLE, sizeof(imageSizeLE));
 
-        ret = m_usbDevice->Write(m_imageBuffer, imageHeaderSize, &transferred);
-        if (ret < 0) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to write image header" << endLog;
-            return ret;
-        }
-        totalTransferred += transferred;
+            ret = m_usbDevice->WriteQueued(imageHeader, imageHeaderSize);
+            if (ret < 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to write image header" << endLog;
+                return FinishSend(ret);
+            }
+            m_sendTransferred += imageHeaderSize;
+
+            if (!ShouldSuppressImageStatus(image.GetName())) {
+                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS,
+                    (static_cast<double>(m_sendTransferred) / m_sendTotal) * 100.0,
+                    image.GetName());
+            }
 
-        if (!ShouldSuppressImageStatus(image.GetName())) {
-            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS,
-                (static_cast<double>(totalTransferred) / totalTransferSize) * 100.0,
-                image.GetName());
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Total transfer size: " << m_sendTotal << endLog;
+            m_sendStage = SEND_STAGE_DATA;
         }
 
-        log(ASTRA_LOG_LEVEL_DEBUG) << "Total transfer size: " << totalTransferSize << endLog;
+        while (m_sendStage == SEND_STAGE_DATA && m_sendTransferred < m_sendTotal) {
+            if (!PollWriteBuffer()) {
+                return kImageSendPending;
+            }
 
-        while (totalTransferred < totalTransferSize) {
-            int dataBlockSize = image.GetDataBlock(m_imageBuffer, m_imageBufferSize);
+            const size_t blockSize = std::min<size_t>(m_imageBufferSize, m_sendTotal - m_sendTransferred);
+            uint8_t *dataBlock = m_usbDevice->AcquireWriteBuffer(blockSize);
+            if (dataBlock == nullptr) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to get transfer buffer" << endLog;
+                m_usbDevice->FlushQueuedWrites();
+                return FinishSend(-1);
+            }
+
+            int dataBlockSize = m_sendBroadcast ? m_sendBroadcast->Read(dataBlock, blockSize) : image.GetDataBlock(dataBlock, blockSize);
             if (dataBlockSize < 0) {
                 log(ASTRA_LOG_LEVEL_ERROR) << "Failed to get data block" << endLog;
-                return -1;
+                m_usbDevice->CommitQueuedWrite(0);
+                m_usbDevice->FlushQueuedWrites();
+                return FinishSend(-1);
             }
 
-            ret = m_usbDevice->Write(m_imageBuffer, dataBlockSize, &transferred);
+            if (dataBlockSize == 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Unexpected end of image data" << endLog;
+                m_usbDevice->CommitQueuedWrite(0);
+                break;
+            }
+
+            ret = m_usbDevice->CommitQueuedWrite(dataBlockSize);
             if (ret < 0) {
                 log(ASTRA_LOG_LEVEL_ERROR) << "Failed to write image data" << endLog;
-                return ret;
+                m_usbDevice->FlushQueuedWrites();
+                return FinishSend(ret);
             }
-            totalTransferred += transferred;
+            // The block stays untouched until its buffer is acquired again,
+            // so it is hashed while already on the bus.
+            DigestImageData(dataBlock, dataBlockSize);
+            m_sendTransferred += dataBlockSize;
 
             if (!ShouldSuppressImageStatus(image.GetName())) {
                 ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS,
-                    (static_cast<double>(totalTransferred) / totalTransferSize) * 100.0,
+                    (static_cast<double>(m_sendTransferred) / m_sendTotal) * 100.0,
                     image.GetName());
             }
         }
+        m_sendStage = SEND_STAGE_FLUSH;
+
+        if (!PollQueuedWrites()) {
+            return kImageSendPending;
+        }
+
+        ret = m_usbDevice->FlushQueuedWrites();
+        if (ret < 0) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to write image data" << endLog;
+            return FinishSend(ret);
+        }
 
-        if (totalTransferred != totalTransferSize) {
+        if (m_sendTransferred != m_sendTotal) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Failed to transfer entire image" << endLog;
-            return -1;
+            return FinishSend(-1);
         }
 
-        return 0;
+        return FinishSend(0);
+    }
+
+    int FinishSend(int ret)
+    {
+        m_sendBroadcast.reset();
+        m_sendStage = SEND_STAGE_IDLE;
+        return ret;
     }
 
     // -----------------------------------------------------------------------
@@ -468,21 +536,22 @@ private:
     }
 
     // -----------------------------------------------------------------------
-    // Virtual hook: ShouldSuppressImageStatus
-    // Suppresses status events for the 07_IMAGE (size-request) image.
+    // Virtual hook: GetTunableChunkSizes
+    // The boot ROM expects each data block as one bulk transfer of
+    // m_imageBufferSize, so only the write queue depth is tuned.
     // -----------------------------------------------------------------------
-    bool ShouldSuppressImageStatus(const std::string &imageName) override
+    std::vector<size_t> GetTunableChunkSizes() const override
     {
-        return imageName == m_sizeRequestImageFilename;
+        return {static_cast<size_t>(m_imageBufferSize)};
     }
 
     // -----------------------------------------------------------------------
-    // Virtual hook: WakeImageRequestThread
-    // Notifies m_imageRequestCV so WaitForImageRequest returns immediately.
+    // Virtual hook: ShouldSuppressImageStatus
+    // Suppresses status events for the 07_IMAGE (size-request) image.
     // -----------------------------------------------------------------------
-    void WakeImageRequestThread() override
+    bool ShouldSuppressImageStatus(const std::string &imageName) override
     {
-        m_imageRequestCV.notify_all();
+        return imageName == m_sizeRequestImageFilename;
     }
 };
 
@@ -9,9 +9,9 @@
 #include <condition_variable>
 #include <cstdint>
 #include <cctype>
-#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <limits>
 #include <optional>
 #include <sstream>
@@ -21,7 +21,14 @@
 #include <vector>
 
 #include "astra_boot_image.hpp"
+#include "block_scanner.hpp"
+#include "boot_packet_cache.hpp"
+#include "byte_ring_buffer.hpp"
+#include "fastboot_batch.hpp"
 #include "fastboot_device.hpp"
+#include "scratch_arena.hpp"
+#include "sparse_image.hpp"
+#include "thread_policy.hpp"
 #include "usb_cdc_device.hpp"
 
 namespace {
@@ -56,6 +63,24 @@ constexpr uint32_t kImgTypeOptee = 0x00020014;
 
 constexpr size_t kStreamChunkSize = 3 * 1024 * 1024;
 
+// Largest response payload accepted after a host header.
+constexpr uint32_t kMaxResponsePayload = 4U * 1024U * 1024U;
+
+// Worst-case waits for the version queries probing a stage, and for the
+// extra word some ROM variants append to the M52BL version response.
+constexpr std::chrono::milliseconds kVersionProbeTimeout{2000};
+constexpr std::chrono::milliseconds kVersionTrailerTimeout{50};
+
+// Longest wait requested per "fb_command_wait" query, and the extra host-side
+// read timeout allowed for the reply to arrive after the device's wait ends.
+constexpr int kFbCommandWaitMs = 1000;
+constexpr int kFbCommandWaitMarginMs = 2000;
+
+// Pause between "fb_command" polls on U-Boot builds without fb_command_wait,
+// and how long the board may take to come back after fb_exit.
+constexpr std::chrono::milliseconds kFbCommandPollInterval{25};
+constexpr std::chrono::seconds kRebindTimeout{30};
+
 enum M52BLReturnCode {
     M52BL_RC_SUCCESS             = 0x00000000,
     M52BL_RC_FAILURE             = 0x00000001,
@@ -83,12 +108,14 @@ std::string ToLower(std::string value)
     return value;
 }
 
-void AppendU32LE(std::vector<uint8_t> &buffer, uint32_t value)
+// Write value at out and return the byte after it.
+uint8_t *AppendU32LE(uint8_t *out, uint32_t value)
 {
-    buffer.push_back(static_cast<uint8_t>(value & 0xFF));
-    buffer.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
-    buffer.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
-    buffer.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+    out[0] = static_cast<uint8_t>(value & 0xFF);
+    out[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    out[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+    out[3] = static_cast<uint8_t>((value >> 24) & 0xFF);
+    return out + 4;
 }
 
 uint32_t ReadU32LE(const uint8_t *ptr)
@@ -99,6 +126,89 @@ uint32_t ReadU32LE(const uint8_t *ptr)
         (static_cast<uint32_t>(ptr[3]) << 24);
 }
 
+// 0xFF bytes padding a payload to whole words.
+constexpr std::array<uint8_t, 3> kPayloadPadding = {0xFF, 0xFF, 0xFF};
+
+size_t PayloadPadding(size_t payloadSize)
+{
+    return (4 - (payloadSize % 4)) % 4;
+}
+
+// Headers of one operation for the boot ROM, M52BL or SysMgr carrying
+// payloadSize bytes; the payload and its PayloadPadding() follow them on the
+// wire.  Unless rawMode, the operation is wrapped in a host API header.
+// Written to out, which holds at least kMaxPacketHeaderSize bytes; returns
+// the header size.
+constexpr size_t kMaxPacketHeaderSize = kHostHeaderSize + kOpHeaderSize;
+
+size_t BuildPacketHeader(ByteSpan out, uint8_t serviceId, uint8_t opcode, size_t payloadSize,
+    uint8_t hostOpcode, uint32_t addr, uint32_t imageType, bool isLast,
+    std::optional<uint32_t> numWordsOverride = std::nullopt, bool rawMode = false)
+{
+    const size_t paddedSize = payloadSize + PayloadPadding(payloadSize);
+
+    uint32_t numWords = 0;
+    if (numWordsOverride.has_value()) {
+        numWords = *numWordsOverride;
+    } else {
+        numWords = static_cast<uint32_t>(paddedSize / 4);
+    }
+
+    uint8_t *p = out.data();
+    if (!rawMode) {
+        *p++ = kHostSync1;
+        *p++ = kHostSync2;
+        *p++ = kHostApiServiceId;
+        *p++ = hostOpcode;
+        p = AppendU32LE(p, static_cast<uint32_t>(kOpHeaderSize + paddedSize));
+    }
+    *p++ = kHostSync1;
+    *p++ = kHostSync2;
+    *p++ = serviceId;
+    *p++ = opcode;
+    p = AppendU32LE(p, 0);
+    p = AppendU32LE(p, numWords);
+    p = AppendU32LE(p, 0);
+    p = AppendU32LE(p, addr);
+    p = AppendU32LE(p, imageType);
+    p = AppendU32LE(p, isLast ? 1U : 0U);
+    p = AppendU32LE(p, 0);
+    return static_cast<size_t>(p - out.data());
+}
+
+// Header of a boot ROM bootstrap upload (key, SPK or M52BL); the payload
+// follows unpadded.  Written to out, which holds at least kOpHeaderSize bytes.
+void BuildSpkHeader(ByteSpan out, uint8_t opcode, uint32_t payloadSize)
+{
+    uint8_t *p = out.data();
+    *p++ = kHostSync1;
+    *p++ = kHostSync2;
+    *p++ = kServiceIdBoot;
+    *p++ = opcode;
+    p = AppendU32LE(p, payloadSize);
+    for (int i = 0; i < 6; ++i) {
+        p = AppendU32LE(p, 0);
+    }
+}
+
+// The same headers for a BootPacket, which keeps its own copy in the cache.
+std::vector<uint8_t> BuildPacketHeader(uint8_t serviceId, uint8_t opcode, size_t payloadSize,
+    uint8_t hostOpcode, uint32_t addr, uint32_t imageType, bool isLast,
+    std::optional<uint32_t> numWordsOverride = std::nullopt, bool rawMode = false)
+{
+    std::vector<uint8_t> header(kMaxPacketHeaderSize);
+    header.resize(BuildPacketHeader(ByteSpan{header.data(), header.size()}, serviceId, opcode, payloadSize,
+        hostOpcode, addr, imageType, isLast, numWordsOverride, rawMode));
+    return header;
+}
+
+std::vector<uint8_t> BuildSpkHeader(uint8_t opcode, uint32_t payloadSize)
+{
+    std::vector<uint8_t> header(kOpHeaderSize);
+    BuildSpkHeader(ByteSpan{header.data(), header.size()}, opcode, payloadSize);
+    return header;
+}
+
 // Returns true if s looks like the 32-char hex UUID we write into uEnv.txt.
 bool IsAstraUuid(const std::string &s)
 {
@@ -187,6 +297,7 @@ public:
 
         m_deviceOpened = true;
         m_deviceName = "device:" + m_usbDevice->GetUSBPath();
+        OpenDeviceLog();
         m_status = ASTRA_DEVICE_STATUS_OPENED;
 
         m_status = ASTRA_DEVICE_STATUS_BOOT_START;
@@ -195,7 +306,7 @@ public:
         {
             std::lock_guard<std::mutex> lock(m_rxMutex);
             m_deviceDisconnected = false;
-            m_rxBuffer.clear();
+            m_rxBuffer.Clear();
         }
         m_expectResetDisconnect = false;
 
@@ -213,6 +324,7 @@ public:
             return ret;
         }
 
+        const auto detectStart = std::chrono::steady_clock::now();
         const uint16_t devVid = m_usbDevice->GetVendorId();
         const uint16_t devPid = m_usbDevice->GetProductId();
         const uint8_t numInterfaces = m_usbDevice->GetNumInterfaces();
@@ -236,7 +348,23 @@ public:
                                   << " numInterfaces=" << static_cast<int>(numInterfaces)
                                   << " vid=0x" << std::hex << devVid << " pid=0x" << devPid << std::dec << endLog;
 
+        // The descriptors settle the mode without a round trip; only the
+        // version query of a loader stage talks to the device.
+        AstraTraceSpan detectSpan("DetectSL26XXMode", {{"device", m_deviceName},
+            {"mode", DeviceModeToString(resolvedMode)}});
+        auto reportDetection = [&](const std::string &probe, bool answered) {
+            const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - detectStart).count();
+            detectSpan.AddArg("probe", probe.empty() ? "none" : probe + (answered ? " answered" : " unanswered"));
+            detectSpan.End();
+            log(ASTRA_LOG_LEVEL_INFO) << "SL26XX mode " << DeviceModeToString(resolvedMode) << " detected in "
+                                      << elapsedMs << " ms"
+                                      << (probe.empty() ? "" : ", " + probe + (answered ? " answered" : " unanswered"))
+                                      << endLog;
+        };
+
         if (resolvedMode == SL26XXDeviceMode::SL26XX_DEVICE_MODE_BOOTROM) {
+            reportDetection("", false);
             if (!RunSpkBootSequence(*bootImage)) {
                 m_status = ASTRA_DEVICE_STATUS_BOOT_FAIL;
                 ReportStatus(ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, "", "Failed to run SL26XX key/spk/m52bl boot sequence");
@@ -248,13 +376,15 @@ public:
             return 1;
         } else if (resolvedMode == SL26XXDeviceMode::SL26XX_DEVICE_MODE_M52BL) {
             uint32_t blVersion = 0;
-            if (GetBootloaderVersion(blVersion)) {
+            const bool blAnswered = GetBootloaderVersion(blVersion);
+            if (blAnswered) {
                 log(ASTRA_LOG_LEVEL_INFO) << "SL26XX M52BL version: " << VersionToString(blVersion)
                                           << " (0x" << std::hex << std::uppercase << blVersion
                                           << std::dec << ")" << endLog;
             } else {
                 log(ASTRA_LOG_LEVEL_WARNING) << "SL26XX M52BL version query failed" << endLog;
             }
+            reportDetection("M52BL version query", blAnswered);
 
             if (bootStage == ASTRA_DEVICE_BOOT_STAGE_M52BL) {
                 // Target stage reached: device is already in M52BL.
@@ -276,13 +406,15 @@ public:
         } else if (resolvedMode == SL26XXDeviceMode::SL26XX_DEVICE_MODE_SYSMGR) {
             // Device is already in SysMgr — no boot sequence needed.
             uint32_t smVersion = 0;
-            if (GetSysMgrVersion(smVersion)) {
+            const bool smAnswered = GetSysMgrVersion(smVersion);
+            if (smAnswered) {
                 log(ASTRA_LOG_LEVEL_INFO) << "SL26XX SysMgr version: " << VersionToString(smVersion)
                                           << " (0x" << std::hex << std::uppercase << smVersion
                                           << std::dec << ")" << endLog;
             } else {
                 log(ASTRA_LOG_LEVEL_WARNING) << "SL26XX SysMgr version query failed" << endLog;
             }
+            reportDetection("SysMgr version query", smAnswered);
 
             if (bootStage == ASTRA_DEVICE_BOOT_STAGE_BOOTLOADER) {
                 if (!RunAcoreSequence(*bootImage)) {
@@ -307,6 +439,7 @@ public:
             ReportStatus(ASTRA_DEVICE_STATUS_BOOT_COMPLETE, 100, "", "Device already in SysMgr");
             return 0;
         } else if (resolvedMode == SL26XXDeviceMode::SL26XX_DEVICE_MODE_FASTBOOT) {
+            reportDetection("", false);
             // Device is in fastboot mode; open the fastboot transport and start the
             // shared image-serving loop.  Boot and update images are served from the
             // same loop — Update() simply appends flash images while the loop runs.
@@ -342,10 +475,27 @@ public:
                 }
             }
 
-            m_deviceDir = m_tempDir;
+            // Per-device directory: boards booting side by side each stage
+            // their own uEnv.txt, carrying their own session UUID.
+            m_deviceDir = m_tempDir + "/" + MakeDeviceDirName(m_deviceName);
+            std::filesystem::create_directories(m_deviceDir);
+
+            if (m_rebindArmed.load() && !m_bootOnly && IsBootSessionOfJob(m_updateSessionUuid)) {
+                // This manager, or an earlier run through the saved checkpoints,
+                // wrote the serial# into a uEnv.txt for this job, e.g. before a
+                // failed update.  Skip the boot images and serve update images
+                // from the first stage request.  A UUID from anywhere else may
+                // come with another job's script, so such boards boot in full.
+                log(ASTRA_LOG_LEVEL_INFO) << "SL26XX already in U-Boot fastboot, skipping boot" << endLog;
+                m_status = ASTRA_DEVICE_STATUS_BOOT_COMPLETE;
+                ReportStatus(ASTRA_DEVICE_STATUS_BOOT_COMPLETE, 100, "", "Device already in U-Boot fastboot");
+                StartImageRequestTask();
+                return 0;
+            }
+
             BuildBootImageList(bootImage, bootStage);
             m_status = ASTRA_DEVICE_STATUS_BOOT_START;
-            StartImageRequestThread();
+            StartImageRequestTask();
             return 0;
         }
 
@@ -372,7 +522,7 @@ public:
     {
         ASTRA_LOG;
 
-        if (m_imageRequestThread.joinable()) {
+        if (IsImageRequestTaskStarted()) {
             // Fastboot mode: wait for the shared image-serving loop to finish.
             std::unique_lock<std::mutex> lock(m_deviceEventMutex);
             m_deviceEventCV.wait(lock, [this] { return !m_running.load(); });
@@ -422,12 +572,10 @@ public:
         }
 
         // Mark transport as disconnected so any blocked rx waiters wake.
-        // (WakeImageRequestThread() below also notifies m_rxCV, but the
-        // m_deviceDisconnected flag is what their predicate checks.)
         {
             std::lock_guard<std::mutex> rxLock(m_rxMutex);
             m_deviceDisconnected = true;
-            m_rxBuffer.clear();
+            m_rxBuffer.Clear();
             m_rxCV.notify_all();
         }
         m_expectResetDisconnect = false;
@@ -437,11 +585,14 @@ public:
             m_unregisterFastbootSerial(m_updateSessionUuid);
         }
 
-        // Wake the image-request loop (m_rebindCV via WakeImageRequestThread,
-        // m_deviceEventCV from the helper) and join it before tearing down
-        // m_fastbootDevice / m_usbDevice.  The loop may still be calling into
-        // m_fastbootDevice until it observes m_running=false and exits.
-        StopImageRequestThread();
+        // Resume the image-request task and wait for it to finish before
+        // tearing down m_fastbootDevice / m_usbDevice.  The task may still be
+        // calling into m_fastbootDevice until it observes m_running=false.
+        StopImageRequestTask();
+        m_fbCommandQuery.reset();
+        m_stageTransfer.reset();
+        m_stageBroadcast.reset();
+        m_rebindSpan.reset();
 
         // Close the underlying USB device (stops and joins its callback
         // thread) BEFORE destroying FastBootDevice -- the callback thread
@@ -464,30 +615,79 @@ private:
     bool m_deviceOpened = false;
 
     // Rebind-mode state: armed once the device carries our UUID as serialno.
-    // m_rebindReady is set by Rebind() and cleared by WaitForRebind().
-    // m_fbExitPending is set after sending fb_exit so that WaitForImageRequest
+    // m_rebindReady is set by Rebind() and cleared by PollImageRequest(),
+    // which waits for it until m_rebindDeadline while m_rebindSpan is open.
+    // m_fbExitPending is set after sending fb_exit so that PollImageRequest
     // skips all USB communication until the disconnect actually occurs.
     std::atomic<bool> m_rebindArmed{false};
     std::atomic<bool> m_rebindReady{false};
     std::atomic<bool> m_fbExitPending{false};
+    std::chrono::steady_clock::time_point m_rebindDeadline{};
+    std::optional<AstraTraceSpan> m_rebindSpan;
+    // When the last fb_exit was sent, to measure how long the board takes
+    // to come back.  Guarded by m_rebindMutex.
+    std::chrono::steady_clock::time_point m_fbExitTime{};
+    // Cleared once U-Boot fails a "sha256:<image>" query so delta and verified
+    // updates stop asking.
+    bool m_deviceDigestSupported = true;
+    // Verified updates: image sent in the previous session and its expected
+    // digest, checked by VerifyPendingImage().
+    std::string m_pendingVerifyImage;
+    std::string m_pendingVerifyDigest;
+    // Cleared once U-Boot fails "fb_command_wait"; PollImageRequest then
+    // falls back to polling fb_command, no sooner than m_fbNextPoll.
+    // m_fbCommandQuery is the query the image request task is waiting on.
+    bool m_fbCommandWaitSupported = true;
+    std::unique_ptr<FastBootDevice::Transfer> m_fbCommandQuery;
+    bool m_fbCommandQueryWaits = false;
+    std::chrono::steady_clock::time_point m_fbNextPoll{};
+    // The stage SendImagePayload() / SendImageBatch() is waiting on, and the
+    // broadcast reader or batch it sends from.
+    std::unique_ptr<FastBootDevice::Transfer> m_stageTransfer;
+    std::unique_ptr<ImageBroadcast::Reader> m_stageBroadcast;
+    std::vector<uint8_t> m_stageBatch;
+    // Batched staging: the largest batch U-Boot takes, 0 until it has been
+    // asked for fb_batch.  m_imageBatchSupported is cleared once it fails to
+    // report one; m_imageBatchStaged marks the pending request as a batch.
+    bool m_imageBatchSupported = true;
+    size_t m_maxImageBatchSize = 0;
+    bool m_imageBatchStaged = false;
+    // Sparsified staging: only for a staging script which reports fb_sparse,
+    // asked once; uniform blocks found in the image expected next, scanned in
+    // the background while the current image is sent.
+    bool m_sparseStagingSupported = true;
+    bool m_sparseStagingChecked = false;
+    std::string m_scannedImagePath;
+    std::future<std::vector<BlockScanner::Run>> m_imageScan;
     std::mutex m_rebindMutex;
-    std::condition_variable m_rebindCV;
 
     std::mutex m_rxMutex;
     std::condition_variable m_rxCV;
-    std::deque<uint8_t> m_rxBuffer;
+    ByteRingBuffer m_rxBuffer;
+    // Headers and response frames of the boot protocol, reused from packet to
+    // packet and freed with the device.  Used by the thread running Boot().
+    ScratchArena m_scratch;
     bool m_deviceDisconnected = false;
+    // Bytes the reader blocked on m_rxCV needs before it is woken.  With
+    // m_rxSizedFrame set, the count grows to the whole frame once the host
+    // header and its length field have arrived.
+    size_t m_rxWanted = 0;
+    bool m_rxSizedFrame = false;
     std::atomic<bool> m_expectResetDisconnect{false};
 
+    // Supplies the next upload chunk of chunkSize bytes.  The returned pointer
+    // stays valid until the following call.  Returns <= 0 on failure.
+    using UploadChunkSource = std::function<int(const uint8_t **chunk, size_t chunkSize)>;
+
     void USBEventHandler(USBDevice::USBEvent event, uint8_t *buf, size_t size)
     {
         if (event == USBDevice::USB_DEVICE_EVENT_INTERRUPT) {
             if (buf != nullptr && size > 0) {
                 std::lock_guard<std::mutex> lock(m_rxMutex);
-                for (size_t i = 0; i < size; ++i) {
-                    m_rxBuffer.push_back(buf[i]);
+                m_rxBuffer.Write(buf, size);
+                if (RxReadyLocked()) {
+                    m_rxCV.notify_all();
                 }
-                m_rxCV.notify_all();
             }
             return;
         }
@@ -527,7 +727,45 @@ private:
     void ClearRxBuffer()
     {
         std::lock_guard<std::mutex> lock(m_rxMutex);
-        m_rxBuffer.clear();
+        m_rxBuffer.Clear();
+    }
+
+    // Incremental frame parser, run with m_rxMutex held whenever data arrives
+    // or a reader checks its wait.  @return true once m_rxWanted bytes are buffered.
+    bool RxReadyLocked()
+    {
+        if (m_rxSizedFrame && m_rxBuffer.Size() >= kHostHeaderSize) {
+            uint8_t header[kHostHeaderSize];
+            m_rxBuffer.Peek(header, sizeof(header));
+            m_rxSizedFrame = false;
+
+            // A malformed header completes the frame so the reader can report it.
+            const uint32_t payloadSize = ReadU32LE(&header[4]);
+            if (header[0] == kHostSync1 && header[1] == kHostSync2 && payloadSize <= kMaxResponsePayload) {
+                m_rxWanted = kHostHeaderSize + payloadSize;
+            }
+        }
+
+        return m_rxBuffer.Size() >= m_rxWanted;
+    }
+
+    // Wait for one response frame: the host header, plus the payload its
+    // length field announces unless rawMode.  Returns what arrived, in
+    // m_scratch, which is less than a whole frame on timeout or disconnect.
+    ByteSpan ReadFrame(bool rawMode, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_rxMutex);
+        m_rxWanted = kHostHeaderSize;
+        m_rxSizedFrame = !rawMode;
+        m_rxCV.wait_for(lock, timeout, [this]() {
+            return RxReadyLocked() || m_deviceDisconnected;
+        });
+
+        ByteSpan frame = m_scratch.Allocate(std::min(m_rxBuffer.Size(), m_rxWanted));
+        m_rxBuffer.Read(frame.data(), frame.size());
+        m_rxWanted = 0;
+        m_rxSizedFrame = false;
+        return frame;
     }
 
     bool WaitForDeviceDisconnect(std::chrono::milliseconds timeout)
@@ -538,144 +776,131 @@ private:
         });
     }
 
-    bool ReadExactBytes(size_t bytesToRead, std::vector<uint8_t> &out,
-        std::chrono::milliseconds timeout)
+    // Wait for bytesToRead bytes and read them into out, in m_scratch.
+    bool ReadExactBytes(size_t bytesToRead, ByteSpan &out, std::chrono::milliseconds timeout)
     {
-        out.clear();
+        out = ByteSpan{};
 
         std::unique_lock<std::mutex> lock(m_rxMutex);
-        const bool ready = m_rxCV.wait_for(lock, timeout, [this, bytesToRead]() {
-            return m_rxBuffer.size() >= bytesToRead || m_deviceDisconnected;
+        m_rxWanted = bytesToRead;
+        m_rxSizedFrame = false;
+        m_rxCV.wait_for(lock, timeout, [this]() {
+            return RxReadyLocked() || m_deviceDisconnected;
         });
+        m_rxWanted = 0;
 
-        if (!ready || m_rxBuffer.size() < bytesToRead) {
+        if (m_rxBuffer.Size() < bytesToRead) {
             return false;
         }
 
-        out.reserve(bytesToRead);
-        for (size_t i = 0; i < bytesToRead; ++i) {
-            out.push_back(m_rxBuffer.front());
-            m_rxBuffer.pop_front();
+        out = m_scratch.Allocate(bytesToRead);
+        m_rxBuffer.Read(out.data(), bytesToRead);
+        return true;
+    }
+
+    bool QueueWrite(const uint8_t *data, size_t size)
+    {
+        USBDevice *usbDevice = m_usbDevice.get();
+        if (usbDevice == nullptr) {
+            return false;
         }
 
-        return true;
+        return usbDevice->WriteQueued(data, size) == 0;
     }
 
-    bool WriteAll(const uint8_t *data, size_t size)
+    bool QueueWriteGather(const USBDevice::WriteSegment *segments, size_t count)
     {
         USBDevice *usbDevice = m_usbDevice.get();
         if (usbDevice == nullptr) {
             return false;
         }
 
-        size_t offset = 0;
-        while (offset < size) {
-            int transferred = 0;
-            const int ret = usbDevice->Write(const_cast<uint8_t *>(data + offset), size - offset, &transferred);
-            if (ret < 0 || transferred <= 0) {
-                return false;
-            }
+        return usbDevice->WriteQueuedGather(segments, count) == 0;
+    }
 
-            offset += static_cast<size_t>(transferred);
+    bool FlushWrites()
+    {
+        USBDevice *usbDevice = m_usbDevice.get();
+        if (usbDevice == nullptr) {
+            return false;
         }
 
-        return true;
+        return usbDevice->FlushQueuedWrites() == 0;
+    }
+
+    bool WriteAll(const uint8_t *data, size_t size)
+    {
+        const bool queued = QueueWrite(data, size);
+        const bool flushed = FlushWrites();
+        return queued && flushed;
     }
 
     int ReadResponseCode(bool rawMode, std::chrono::milliseconds timeout)
     {
         ASTRA_LOG;
 
-        std::vector<uint8_t> responseHeader;
-        if (!ReadExactBytes(kHostHeaderSize, responseHeader, timeout)) {
+        ScratchArena::Scope scratchScope(m_scratch);
+        const ByteSpan frame = ReadFrame(rawMode, timeout);
+        if (frame.size() < kHostHeaderSize) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Timed out waiting for protocol response header" << endLog;
             return -1;
         }
 
-        if (responseHeader[0] != kHostSync1 || responseHeader[1] != kHostSync2) {
+        if (frame[0] != kHostSync1 || frame[1] != kHostSync2) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Invalid protocol sync bytes in response header" << endLog;
             return -1;
         }
 
         if (rawMode) {
-            return static_cast<int>(ReadU32LE(&responseHeader[4]));
+            return static_cast<int>(ReadU32LE(&frame[4]));
         }
 
-        const uint32_t payloadSize = ReadU32LE(&responseHeader[4]);
+        const uint32_t payloadSize = ReadU32LE(&frame[4]);
         if (payloadSize == 0) {
             return 0;
         }
 
-        if (payloadSize > (4U * 1024U * 1024U)) {
+        if (payloadSize > kMaxResponsePayload) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Protocol response payload too large: " << payloadSize << endLog;
             return -1;
         }
 
-        std::vector<uint8_t> payload;
-        if (!ReadExactBytes(payloadSize, payload, timeout)) {
+        if (frame.size() < kHostHeaderSize + payloadSize) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Timed out waiting for protocol response payload" << endLog;
             return -1;
         }
 
-        if (payload.size() < sizeof(uint32_t)) {
+        if (payloadSize < sizeof(uint32_t)) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Protocol response payload too small" << endLog;
             return -1;
         }
 
-        return static_cast<int>(ReadU32LE(payload.data()));
+        return static_cast<int>(ReadU32LE(&frame[kHostHeaderSize]));
     }
 
-    int SendPacket(uint8_t serviceId, uint8_t opcode, const std::vector<uint8_t> &payload,
+    int SendPacket(uint8_t serviceId, uint8_t opcode, const uint8_t *payload, size_t payloadSize,
         uint8_t hostOpcode, uint32_t addr, uint32_t imageType, bool isLast,
         std::chrono::milliseconds timeout, std::optional<uint32_t> numWordsOverride = std::nullopt,
         bool rawMode = false, bool waitForResponse = true)
     {
         ASTRA_LOG;
 
-        std::vector<uint8_t> paddedPayload = payload;
-        const size_t padding = (4 - (paddedPayload.size() % 4)) % 4;
-        if (padding > 0) {
-            paddedPayload.insert(paddedPayload.end(), padding, 0xFF);
-        }
-
-        uint32_t numWords = 0;
-        if (numWordsOverride.has_value()) {
-            numWords = *numWordsOverride;
-        } else {
-            numWords = static_cast<uint32_t>(paddedPayload.size() / 4);
-        }
-
-        std::vector<uint8_t> innerPacket;
-        innerPacket.reserve(kOpHeaderSize + paddedPayload.size());
-        innerPacket.push_back(kHostSync1);
-        innerPacket.push_back(kHostSync2);
-        innerPacket.push_back(serviceId);
-        innerPacket.push_back(opcode);
-        AppendU32LE(innerPacket, 0);
-        AppendU32LE(innerPacket, numWords);
-        AppendU32LE(innerPacket, 0);
-        AppendU32LE(innerPacket, addr);
-        AppendU32LE(innerPacket, imageType);
-        AppendU32LE(innerPacket, isLast ? 1U : 0U);
-        AppendU32LE(innerPacket, 0);
-        innerPacket.insert(innerPacket.end(), paddedPayload.begin(), paddedPayload.end());
-
-        std::vector<uint8_t> finalPacket;
-        if (rawMode) {
-            finalPacket = std::move(innerPacket);
-        } else {
-            finalPacket.reserve(kHostHeaderSize + innerPacket.size());
-            finalPacket.push_back(kHostSync1);
-            finalPacket.push_back(kHostSync2);
-            finalPacket.push_back(kHostApiServiceId);
-            finalPacket.push_back(hostOpcode);
-            AppendU32LE(finalPacket, static_cast<uint32_t>(innerPacket.size()));
-            finalPacket.insert(finalPacket.end(), innerPacket.begin(), innerPacket.end());
-        }
+        // Headers, payload and padding go out as one gathered write.
+        ScratchArena::Scope scratchScope(m_scratch);
+        const ByteSpan header = m_scratch.Allocate(kMaxPacketHeaderSize);
+        const size_t headerSize = BuildPacketHeader(header, serviceId, opcode, payloadSize, hostOpcode,
+            addr, imageType, isLast, numWordsOverride, rawMode);
+        const USBDevice::WriteSegment segments[] = {
+            {header.data(), headerSize},
+            {payload, payloadSize},
+            {kPayloadPadding.data(), PayloadPadding(payloadSize)},
+        };
 
         ClearRxBuffer();
 
-        if (!WriteAll(finalPacket.data(), finalPacket.size())) {
+        const bool queued = QueueWriteGather(segments, 3);
+        const bool flushed = FlushWrites();
+        if (!queued || !flushed) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Failed to write protocol packet" << endLog;
             return -1;
         }
@@ -687,38 +912,36 @@ private:
         return ReadResponseCode(rawMode, timeout);
     }
 
-    int SendSpkCommand(uint8_t opcode, const uint8_t *payload, uint32_t payloadSize,
-        std::chrono::milliseconds timeout)
+    // Probe timeouts learned from the manager's earlier devices, or ceiling
+    // without m_responseTimes.  key names the stage and the request.
+    std::chrono::milliseconds ProbeTimeout(const std::string &key, std::chrono::milliseconds ceiling) const
     {
-        ASTRA_LOG;
+        return m_responseTimes != nullptr ? m_responseTimes->ProbeTimeout(key, ceiling) : ceiling;
+    }
 
-        std::vector<uint8_t> packet;
-        packet.reserve(kOpHeaderSize + payloadSize);
-        packet.push_back(kHostSync1);
-        packet.push_back(kHostSync2);
-        packet.push_back(kServiceIdBoot);
-        packet.push_back(opcode);
-        AppendU32LE(packet, payloadSize);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
+    void ObserveResponse(const std::string &key, std::chrono::steady_clock::time_point sent,
+        std::chrono::milliseconds timeout, bool answered)
+    {
+        ASTRA_LOG;
 
-        if (payloadSize > 0 && payload != nullptr) {
-            packet.insert(packet.end(), payload, payload + payloadSize);
+        const auto elapsed = std::chrono::steady_clock::now() - sent;
+        const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+        log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX " << key << (answered ? " answered in " : " unanswered after ")
+            << elapsedMs.count() << " ms (timeout " << timeout.count() << " ms)" << endLog;
+        if (m_responseTimes == nullptr) {
+            return;
         }
 
-        ClearRxBuffer();
-
-        if (!WriteAll(packet.data(), packet.size())) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to write SPK bootstrap packet, opcode=0x"
-                << std::hex << std::uppercase << static_cast<uint32_t>(opcode) << std::dec << endLog;
-            return -1;
+        const auto expected = m_responseTimes->ExpectedTime(key);
+        if (answered && expected.count() > 0 && elapsedMs > expected) {
+            log(ASTRA_LOG_LEVEL_INFO) << "SL26XX " << key << " answered in " << elapsedMs.count()
+                << " ms, later than the usual " << expected.count() << " ms" << endLog;
+        }
+        if (answered) {
+            m_responseTimes->Observe(key, elapsed);
+        } else {
+            m_responseTimes->ObserveMiss(key);
         }
-
-        return ReadResponseCode(true, timeout);
     }
 
     bool GetBootloaderVersion(uint32_t &version)
@@ -727,19 +950,10 @@ private:
 
         version = 0;
 
-        std::vector<uint8_t> packet;
-        packet.reserve(kOpHeaderSize);
-        packet.push_back(kHostSync1);
-        packet.push_back(kHostSync2);
-        packet.push_back(kServiceIdBoot);
-        packet.push_back(kOpcodeVersion);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
-        AppendU32LE(packet, 0);
+        // The version request is a bootstrap header without a payload.
+        ScratchArena::Scope scratchScope(m_scratch);
+        const ByteSpan packet = m_scratch.Allocate(kOpHeaderSize);
+        BuildSpkHeader(packet, kOpcodeVersion, 0);
 
         ClearRxBuffer();
 
@@ -748,8 +962,13 @@ private:
             return false;
         }
 
-        std::vector<uint8_t> responseHeader;
-        if (!ReadExactBytes(kHostHeaderSize, responseHeader, std::chrono::seconds(2))) {
+        const std::string key = "m52bl version";
+        const auto timeout = ProbeTimeout(key, kVersionProbeTimeout);
+        const auto sent = std::chrono::steady_clock::now();
+        ByteSpan responseHeader;
+        const bool answered = ReadExactBytes(kHostHeaderSize, responseHeader, timeout);
+        ObserveResponse(key, sent, timeout, answered);
+        if (!answered) {
             log(ASTRA_LOG_LEVEL_DEBUG) << "Timed out waiting for SL26XX BL version response" << endLog;
             return false;
         }
@@ -762,9 +981,15 @@ private:
         // BL VERSION typically encodes version in response header bytes [4..7].
         version = ReadU32LE(&responseHeader[4]);
 
-        // Some ROM variants append an extra 4-byte word after the response header.
-        std::vector<uint8_t> trailing;
-        (void)ReadExactBytes(sizeof(uint32_t), trailing, std::chrono::milliseconds(50));
+        // Some ROM variants append an extra 4-byte word after the response
+        // header.  Once a station's boards are known not to, it is hardly
+        // waited for.
+        const std::string trailerKey = "m52bl version trailer";
+        const auto trailerTimeout = ProbeTimeout(trailerKey, kVersionTrailerTimeout);
+        const auto headerRead = std::chrono::steady_clock::now();
+        ByteSpan trailing;
+        ObserveResponse(trailerKey, headerRead, trailerTimeout,
+            ReadExactBytes(sizeof(uint32_t), trailing, trailerTimeout));
 
         return true;
     }
@@ -775,8 +1000,12 @@ private:
 
         version = 0;
 
-        const int rc = SendPacket(kServiceIdBoot, kOpcodeVersion, {}, kHostApiOpcodeVersion,
-                                  0, 0, false, std::chrono::seconds(2));
+        const std::string key = "sysmgr version";
+        const auto timeout = ProbeTimeout(key, kVersionProbeTimeout);
+        const auto sent = std::chrono::steady_clock::now();
+        const int rc = SendPacket(kServiceIdBoot, kOpcodeVersion, nullptr, 0, kHostApiOpcodeVersion,
+                                  0, 0, false, timeout);
+        ObserveResponse(key, sent, timeout, rc >= 0);
         if (rc < 0) {
             log(ASTRA_LOG_LEVEL_DEBUG) << "Failed to query SL26XX SysMgr version" << endLog;
             return false;
@@ -786,47 +1015,199 @@ private:
         return true;
     }
 
-    bool SendSpkFile(const std::filesystem::path &path, const std::string &imageName, uint8_t opcode)
+    // Point packet's payload at a boot file: the shared mapping when there is
+    // one, otherwise a copy read from disk.
+    bool ReadBootFile(const Image &image, BootPacket &packet)
     {
         ASTRA_LOG;
 
-        std::ifstream input(path, std::ios::binary | std::ios::ate);
+        if (m_imageStore != nullptr) {
+            std::shared_ptr<const ImageMapping> mapping = m_imageStore->Acquire(image.GetPath());
+            if (mapping != nullptr && mapping->GetSize() <= std::numeric_limits<uint32_t>::max()) {
+                packet.payload = mapping->GetData();
+                packet.payloadSize = mapping->GetSize();
+                packet.payloadOwner = mapping;
+                return true;
+            }
+        }
+
+        std::ifstream input(image.GetPath(), std::ios::binary | std::ios::ate);
         if (!input) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open SPK bootstrap file: " << path.string() << endLog;
-            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Failed to open image");
+            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open boot file: " << image.GetPath() << endLog;
+            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, image.GetName(), "Failed to open image");
             return false;
         }
 
         const std::streamoff endPos = input.tellg();
         if (endPos < 0 || static_cast<uint64_t>(endPos) > std::numeric_limits<uint32_t>::max()) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Invalid SPK bootstrap file size for " << imageName << endLog;
-            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Invalid image size");
+            log(ASTRA_LOG_LEVEL_ERROR) << "Invalid boot file size for " << image.GetName() << endLog;
+            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, image.GetName(), "Invalid image size");
             return false;
         }
 
-        const uint32_t size = static_cast<uint32_t>(endPos);
+        auto data = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(endPos));
         input.seekg(0, std::ios::beg);
-
-        std::vector<uint8_t> buffer;
-        buffer.resize(size);
-        if (size > 0) {
-            input.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(size));
-            if (input.gcount() != static_cast<std::streamsize>(size)) {
-                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to read SPK bootstrap image: " << path.string() << endLog;
-                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Failed to read image");
+        if (!data->empty()) {
+            input.read(reinterpret_cast<char *>(data->data()), static_cast<std::streamsize>(data->size()));
+            if (input.gcount() != static_cast<std::streamsize>(data->size())) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to read boot file: " << image.GetPath() << endLog;
+                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, image.GetName(), "Failed to read image");
                 return false;
             }
         }
 
-        ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_START, 0, imageName);
-        const int rc = SendSpkCommand(opcode, buffer.data(), size, std::chrono::seconds(5));
-        if (rc != 0) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "SPK bootstrap upload failed for " << imageName << ", rc=" << rc << endLog;
-            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Bootstrap upload failed");
+        packet.payload = data->data();
+        packet.payloadSize = data->size();
+        packet.payloadOwner = data;
+        return true;
+    }
+
+    bool AppendSpkPacket(BootPacketSequence &sequence, const Image &image, uint8_t opcode)
+    {
+        BootPacket packet;
+        if (!ReadBootFile(image, packet)) {
             return false;
         }
 
-        ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE, 100, imageName);
+        packet.imageName = image.GetName();
+        packet.description = "bootstrap upload";
+        packet.header = BuildSpkHeader(opcode, static_cast<uint32_t>(packet.payloadSize));
+        packet.rawResponse = true;
+        sequence.push_back(std::move(packet));
+        return true;
+    }
+
+    // Upload setup, then the image itself; the device answers the second
+    // packet once it has verified the image.
+    bool AppendUploadPackets(BootPacketSequence &sequence, const Image &image, uint32_t imageType,
+        uint32_t loadAddress = kAddrAcLoad, bool rawMode = false)
+    {
+        BootPacket payload;
+        if (!ReadBootFile(image, payload)) {
+            return false;
+        }
+
+        BootPacket setup;
+        setup.imageName = image.GetName();
+        setup.description = "upload setup";
+        setup.header = BuildPacketHeader(kServiceIdBoot, kOpcodeUpload, 0, kHostApiOpcodeGeneric,
+            loadAddress, imageType, false, static_cast<uint32_t>(payload.payloadSize), rawMode);
+        setup.rawResponse = rawMode;
+        sequence.push_back(std::move(setup));
+
+        payload.imageName = image.GetName();
+        payload.description = "upload verification";
+        payload.reportProgress = true;
+        payload.rawResponse = rawMode;
+        payload.timeout = std::chrono::seconds(20);
+        sequence.push_back(std::move(payload));
+        return true;
+    }
+
+    // Write the header and payload in kStreamChunkSize pieces, gathering the
+    // header into the first one.
+    bool WriteBootPacket(const BootPacket &packet)
+    {
+        size_t offset = 0;
+        do {
+            const size_t chunkSize = std::min(kStreamChunkSize, packet.payloadSize - offset);
+            USBDevice::WriteSegment segments[2];
+            size_t count = 0;
+            if (offset == 0 && !packet.header.empty()) {
+                segments[count++] = {packet.header.data(), packet.header.size()};
+            }
+            if (chunkSize > 0) {
+                segments[count++] = {packet.payload + offset, chunkSize};
+            }
+            offset += chunkSize;
+
+            if (!QueueWriteGather(segments, count)) {
+                FlushWrites();
+                return false;
+            }
+
+            if (packet.reportProgress && packet.payloadSize > 0) {
+                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS,
+                    (static_cast<double>(offset) / static_cast<double>(packet.payloadSize)) * 100.0,
+                    packet.imageName);
+            }
+        } while (offset < packet.payloadSize);
+
+        return FlushWrites();
+    }
+
+    /**
+     * Boot packets for one step of the boot flow, taken from the manager's
+     * cache so they are framed once per boot image rather than per device.
+     */
+    std::shared_ptr<const BootPacketSequence> GetBootPackets(const AstraBootImage &bootImage,
+        const std::string &sequenceName, const BootPacketCache::Builder &build)
+    {
+        if (m_bootPacketCache != nullptr) {
+            return m_bootPacketCache->Get(bootImage.GetPath() + ":" + sequenceName, build);
+        }
+
+        auto sequence = std::make_shared<BootPacketSequence>();
+        if (!build(*sequence)) {
+            return nullptr;
+        }
+        return sequence;
+    }
+
+    bool RunBootPackets(const BootPacketSequence &sequence)
+    {
+        ASTRA_LOG;
+
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            const BootPacket &packet = sequence[i];
+            const bool imagePacket = !packet.imageName.empty();
+            const bool firstOfImage = imagePacket && (i == 0 || sequence[i - 1].imageName != packet.imageName);
+            const bool lastOfImage = imagePacket &&
+                (i + 1 == sequence.size() || sequence[i + 1].imageName != packet.imageName);
+
+            if (firstOfImage) {
+                log(ASTRA_LOG_LEVEL_INFO) << "SL26XX uploading " << packet.imageName << endLog;
+                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_START, 0, packet.imageName);
+            }
+
+            if (packet.expectDisconnect) {
+                m_expectResetDisconnect = true;
+            }
+
+            ClearRxBuffer();
+
+            const bool written = WriteBootPacket(packet);
+
+            int rc = written ? 0 : -1;
+            if (written && packet.waitForResponse) {
+                // Timed from the end of the write, so the wait covers the
+                // device's work and not the transfer.  The boot cannot do
+                // without the answer, so it gets the packet's full timeout.
+                const std::string key = packet.description + (imagePacket ? " " + packet.imageName : "");
+                const auto timeout = packet.timeout;
+                const auto sent = std::chrono::steady_clock::now();
+                rc = ReadResponseCode(packet.rawResponse, timeout);
+                ObserveResponse(key, sent, timeout, rc >= 0);
+            }
+
+            if (rc != 0) {
+                if (packet.expectDisconnect) {
+                    m_expectResetDisconnect = false;
+                }
+                log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX " << packet.description << " failed"
+                    << (imagePacket ? " for " + packet.imageName : "") << ", rc=" << rc << endLog;
+                if (imagePacket) {
+                    ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, packet.imageName,
+                        "SL26XX " + packet.description + " failed");
+                }
+                return false;
+            }
+
+            if (lastOfImage) {
+                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE, 100, packet.imageName);
+            }
+        }
+
         return true;
     }
 
@@ -908,32 +1289,30 @@ private:
     bool RunSpkBootSequence(const AstraBootImage &bootImage)
     {
         ASTRA_LOG;
+        AstraTraceSpan traceSpan("RunSpkBootSequence", {{"device", m_deviceName}});
 
-        const Image *keyImage = FindKeyBootImage(bootImage);
-        const Image *spkImage = FindSpkBootImage(bootImage);
-        const Image *m52BlImage = FindM52BlBootImage(bootImage);
+        auto packets = GetBootPackets(bootImage, "run-spk", [this, &bootImage](BootPacketSequence &sequence) {
+            ASTRA_LOG;
 
-        if (keyImage == nullptr || spkImage == nullptr || m52BlImage == nullptr) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Missing key/spk/m52bl image in boot image set" << endLog;
-            return false;
-        }
+            const Image *keyImage = FindKeyBootImage(bootImage);
+            const Image *spkImage = FindSpkBootImage(bootImage);
+            const Image *m52BlImage = FindM52BlBootImage(bootImage);
 
-        log(ASTRA_LOG_LEVEL_INFO) << "SL26XX run-spk: uploading " << keyImage->GetName() << ", "
-                                  << spkImage->GetName() << ", and " << m52BlImage->GetName() << endLog;
-
-        if (!SendSpkFile(keyImage->GetPath(), keyImage->GetName(), kOpcodeUploadKey)) {
-            return false;
-        }
-
-        if (!SendSpkFile(spkImage->GetPath(), spkImage->GetName(), kOpcodeUploadSpk)) {
-            return false;
-        }
+            if (keyImage == nullptr || spkImage == nullptr || m52BlImage == nullptr) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Missing key/spk/m52bl image in boot image set" << endLog;
+                return false;
+            }
 
-        if (!SendSpkFile(m52BlImage->GetPath(), m52BlImage->GetName(), kOpcodeUploadM52Bl)) {
+            return AppendSpkPacket(sequence, *keyImage, kOpcodeUploadKey) &&
+                AppendSpkPacket(sequence, *spkImage, kOpcodeUploadSpk) &&
+                AppendSpkPacket(sequence, *m52BlImage, kOpcodeUploadM52Bl);
+        });
+        if (packets == nullptr) {
             return false;
         }
 
-        return true;
+        log(ASTRA_LOG_LEVEL_INFO) << "SL26XX run-spk: sending key, spk and m52bl" << endLog;
+        return RunBootPackets(*packets);
     }
 
     const Image *FindSysMgrBootImage(const AstraBootImage &bootImage)
@@ -966,29 +1345,38 @@ private:
     bool RunSmBootSequence(const AstraBootImage &bootImage)
     {
         ASTRA_LOG;
+        AstraTraceSpan traceSpan("RunSmBootSequence", {{"device", m_deviceName}});
 
-        const Image *sysMgrImage = FindSysMgrBootImage(bootImage);
-        if (sysMgrImage == nullptr) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Unable to find SysMgr image in boot image set" << endLog;
-            return false;
-        }
+        auto packets = GetBootPackets(bootImage, "run-sm", [this, &bootImage](BootPacketSequence &sequence) {
+            ASTRA_LOG;
 
-        log(ASTRA_LOG_LEVEL_INFO) << "SL26XX run-sm: uploading " << sysMgrImage->GetName()
-                                  << " to 0x" << std::hex << std::uppercase << kAddrSmLoad
-                                  << " and sending Run Image command" << std::dec << endLog;
+            const Image *sysMgrImage = FindSysMgrBootImage(bootImage);
+            if (sysMgrImage == nullptr) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Unable to find SysMgr image in boot image set" << endLog;
+                return false;
+            }
 
-        if (!UploadFile(sysMgrImage->GetPath(), sysMgrImage->GetName(), kImgTypeSm, kAddrSmLoad, true)) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to upload SysMgr image: " << sysMgrImage->GetName() << endLog;
+            if (!AppendUploadPackets(sequence, *sysMgrImage, kImgTypeSm, kAddrSmLoad, true)) {
+                return false;
+            }
+
+            BootPacket run;
+            run.description = "Run Image command";
+            run.header = BuildPacketHeader(kServiceIdBoot, kOpcodeRunImage, 0, kHostApiOpcodeGeneric,
+                kAddrSmLoad, 0, false, std::nullopt, true);
+            run.waitForResponse = false;
+            run.expectDisconnect = true;
+            sequence.push_back(std::move(run));
+            return true;
+        });
+        if (packets == nullptr) {
             return false;
         }
 
-        m_expectResetDisconnect = true;
+        log(ASTRA_LOG_LEVEL_INFO) << "SL26XX run-sm: uploading SysMgr to 0x" << std::hex << std::uppercase
+                                  << kAddrSmLoad << " and sending Run Image command" << std::dec << endLog;
 
-        const int runRc = SendPacket(kServiceIdBoot, kOpcodeRunImage, {}, kHostApiOpcodeGeneric,
-            kAddrSmLoad, 0, false, std::chrono::seconds(5), std::nullopt, true, false);
-        if (runRc != 0) {
-            m_expectResetDisconnect = false;
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to send Run Image command, rc=" << runRc << endLog;
+        if (!RunBootPackets(*packets)) {
             return false;
         }
 
@@ -1051,42 +1439,44 @@ private:
     bool RunAcoreSequence(const AstraBootImage &bootImage)
     {
         ASTRA_LOG;
+        AstraTraceSpan traceSpan("RunAcoreSequence", {{"device", m_deviceName}});
 
-        const Image *blImage = FindBlBootImage(bootImage);
-        const Image *tzkImage = FindTzkBootImage(bootImage);
+        auto packets = GetBootPackets(bootImage, "run-acore", [this, &bootImage](BootPacketSequence &sequence) {
+            ASTRA_LOG;
 
-        if (blImage == nullptr || tzkImage == nullptr) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Missing BL or TZK image for A-Core sequence" << endLog;
-            return false;
-        }
+            const Image *blImage = FindBlBootImage(bootImage);
+            const Image *tzkImage = FindTzkBootImage(bootImage);
 
-        log(ASTRA_LOG_LEVEL_INFO) << "SL26XX run-acore: uploading " << blImage->GetName()
-                                  << " and " << tzkImage->GetName() << endLog;
+            if (blImage == nullptr || tzkImage == nullptr) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Missing BL or TZK image for A-Core sequence" << endLog;
+                return false;
+            }
 
-        if (!UploadFile(blImage->GetPath(), blImage->GetName(), kImgTypeBl)) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to upload BL image: " << blImage->GetName() << endLog;
-            return false;
-        }
+            BootPacket exec;
+            exec.description = "exec command";
+            exec.header = BuildPacketHeader(kServiceIdBoot, kOpcodeExec0C, 0, kHostApiOpcodeExec, 0, 0, false);
 
-        const int execRc1 = SendPacket(kServiceIdBoot, kOpcodeExec0C, {}, kHostApiOpcodeExec,
-            0, 0, false, std::chrono::seconds(5));
-        if (execRc1 != 0) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "BL exec command failed, rc=" << execRc1 << endLog;
-            return false;
-        }
+            if (!AppendUploadPackets(sequence, *blImage, kImgTypeBl)) {
+                return false;
+            }
+            sequence.push_back(exec);
 
-        if (!UploadFile(tzkImage->GetPath(), tzkImage->GetName(), kImgTypeOptee)) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to upload TZK image: " << tzkImage->GetName() << endLog;
+            if (!AppendUploadPackets(sequence, *tzkImage, kImgTypeOptee)) {
+                return false;
+            }
+            // A-Core takes control immediately after the TZK exec — SysMgr never sends a response.
+            exec.waitForResponse = false;
+            exec.expectDisconnect = true;
+            sequence.push_back(std::move(exec));
+            return true;
+        });
+        if (packets == nullptr) {
             return false;
         }
 
-        // A-Core takes control immediately after the TZK exec — SysMgr never sends a response.
-        m_expectResetDisconnect = true;
-        const int execRc2 = SendPacket(kServiceIdBoot, kOpcodeExec0C, {}, kHostApiOpcodeExec,
-            0, 0, false, std::chrono::seconds(5), std::nullopt, false, false);
-        if (execRc2 != 0) {
-            m_expectResetDisconnect = false;
-            log(ASTRA_LOG_LEVEL_ERROR) << "TZK exec command failed, rc=" << execRc2 << endLog;
+        log(ASTRA_LOG_LEVEL_INFO) << "SL26XX run-acore: uploading BL and TZK" << endLog;
+
+        if (!RunBootPackets(*packets)) {
             return false;
         }
 
@@ -1097,6 +1487,21 @@ private:
     bool UploadData(const uint8_t *data, uint64_t size, const std::string &imageName,
         uint32_t imageType, uint32_t loadAddress = kAddrAcLoad, bool rawMode = false,
         bool reportStatus = true, uint64_t totalSize = 0, uint64_t byteOffset = 0)
+    {
+        uint64_t offset = 0;
+        auto source = [data, &offset](const uint8_t **chunk, size_t chunkSize) {
+            *chunk = data + offset;
+            offset += chunkSize;
+            return static_cast<int>(chunkSize);
+        };
+
+        return UploadStream(source, size, imageName, imageType, loadAddress, rawMode,
+            reportStatus, totalSize, byteOffset);
+    }
+
+    bool UploadStream(const UploadChunkSource &source, uint64_t size, const std::string &imageName,
+        uint32_t imageType, uint32_t loadAddress = kAddrAcLoad, bool rawMode = false,
+        bool reportStatus = true, uint64_t totalSize = 0, uint64_t byteOffset = 0)
     {
         ASTRA_LOG;
 
@@ -1108,7 +1513,7 @@ private:
 
         if (reportStatus) ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_START, 0, imageName);
 
-        const int setupRc = SendPacket(kServiceIdBoot, kOpcodeUpload, {}, kHostApiOpcodeGeneric,
+        const int setupRc = SendPacket(kServiceIdBoot, kOpcodeUpload, nullptr, 0, kHostApiOpcodeGeneric,
             loadAddress, imageType, false, std::chrono::seconds(5), static_cast<uint32_t>(size), rawMode);
         if (setupRc != 0) {
             log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX upload setup failed for " << imageName << ", rc=" << setupRc << endLog;
@@ -1124,7 +1529,16 @@ private:
         uint64_t sent = 0;
         while (sent < size) {
             const size_t chunkSize = static_cast<size_t>(std::min<uint64_t>(kStreamChunkSize, size - sent));
-            if (!WriteAll(data + sent, chunkSize)) {
+            const uint8_t *chunk = nullptr;
+            if (source(&chunk, chunkSize) != static_cast<int>(chunkSize)) {
+                FlushWrites();
+                log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX upload read failed for " << imageName << endLog;
+                if (reportStatus) ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Upload read failed");
+                return false;
+            }
+
+            if (!QueueWrite(chunk, chunkSize)) {
+                FlushWrites();
                 log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX upload write failed for " << imageName << endLog;
                 if (reportStatus) ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Upload write failed");
                 return false;
@@ -1138,6 +1552,12 @@ private:
             }
         }
 
+        if (!FlushWrites()) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX upload write failed for " << imageName << endLog;
+            if (reportStatus) ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Upload write failed");
+            return false;
+        }
+
         const int verifyRc = ReadResponseCode(rawMode, std::chrono::seconds(20));
         if (verifyRc != 0) {
             log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX upload verification failed for " << imageName << ", rc=" << verifyRc << endLog;
@@ -1149,40 +1569,6 @@ private:
         return true;
     }
 
-    bool UploadFile(const std::filesystem::path &path, const std::string &imageName, uint32_t imageType,
-        uint32_t loadAddress = kAddrAcLoad, bool rawMode = false)
-    {
-        ASTRA_LOG;
-
-        std::ifstream input(path, std::ios::binary | std::ios::ate);
-        if (!input) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open upload file: " << path.string() << endLog;
-            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL, 0, imageName, "Failed to open image");
-            return false;
-        }
-
-        const std::streamoff endPos = input.tellg();
-        if (endPos < 0) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to query file size: " << path.string() << endLog;
-            return false;
-        }
-
-        const uint64_t size = static_cast<uint64_t>(endPos);
-        input.seekg(0, std::ios::beg);
-
-        std::vector<uint8_t> buffer;
-        buffer.resize(static_cast<size_t>(size));
-        if (size > 0) {
-            input.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(size));
-            if (input.gcount() != static_cast<std::streamsize>(size)) {
-                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to read file data: " << path.string() << endLog;
-                return false;
-            }
-        }
-
-        return UploadData(buffer.data(), size, imageName, imageType, loadAddress, rawMode);
-    }
-
     bool UploadBuffer(const std::vector<uint8_t> &buffer, const std::string &imageName, uint32_t imageType,
         uint32_t loadAddress = kAddrAcLoad, bool rawMode = false, bool reportStatus = true,
         uint64_t totalSize = 0, uint64_t byteOffset = 0)
@@ -1190,23 +1576,11 @@ private:
         return UploadData(buffer.data(), buffer.size(), imageName, imageType, loadAddress, rawMode, reportStatus, totalSize, byteOffset);
     }
 
-    // -----------------------------------------------------------------------
-    // Virtual hook: WakeImageRequestThread
-    // Notify all CVs so a thread blocked in WaitForImageRequest, WaitForRebind,
-    // or any rx-buffer wait wakes up promptly when m_running is cleared by
-    // Close() / shutdown.
-    // -----------------------------------------------------------------------
-    void WakeImageRequestThread() override
-    {
-        m_rebindCV.notify_all();
-        std::lock_guard<std::mutex> lock(m_rxMutex);
-        m_rxCV.notify_all();
-    }
-
     // -----------------------------------------------------------------------
     // Virtual hook: Rebind
     // Called by the manager when a fastboot device reconnects with a matching
-    // UUID serial.  Swaps the USB device and wakes the waiting image loop.
+    // UUID serial.  Swaps the USB device and resumes the waiting image
+    // request task.
     // -----------------------------------------------------------------------
     void Rebind(std::unique_ptr<USBDevice> newDevice) override
     {
@@ -1233,8 +1607,12 @@ private:
 
         // Take ownership of the new USB device.
         m_usbDevice = std::move(newDevice);
+        m_usbDevice->SetTransferStats(m_transferStats);
+        m_usbDevice->SetEventExecutor(m_eventExecutor);
 
         // Reconstruct FastBootDevice over the new USB device.
+        // The re-enumerated device may run a different U-Boot; probe it afresh.
+        m_fbCommandWaitSupported = true;
         m_fastbootDevice = std::make_unique<FastBootDevice>(m_usbDevice.get());
         if (!m_fastbootDevice->Open([this]() {
                 if (!m_rebindArmed.load()) {
@@ -1246,131 +1624,174 @@ private:
             m_fastbootDevice.reset();
             m_running.store(false);
             m_deviceEventCV.notify_all();
-            m_rebindCV.notify_all();
+            ResumeImageRequestTask();
             return;
         }
 
-        // Signal WaitForImageRequest that a new device is ready.
+        // Signal PollImageRequest that a new device is ready.
         {
             std::lock_guard<std::mutex> lock(m_rebindMutex);
+            if (m_fbExitTime != std::chrono::steady_clock::time_point{}) {
+                const auto latency = std::chrono::steady_clock::now() - m_fbExitTime;
+                m_fbExitTime = {};
+                m_transferStats->RecordRebind(latency);
+                log(ASTRA_LOG_LEVEL_INFO) << "SL26XX fastboot: device back "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(latency).count()
+                    << " ms after fb_exit" << endLog;
+            }
             m_rebindReady.store(true);
         }
-        m_rebindCV.notify_all();
+        ResumeImageRequestTask();
         log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: rebind complete" << endLog;
     }
 
     // -----------------------------------------------------------------------
-    // WaitForRebind
-    // Blocks until a new USB device is rebound (m_rebindReady), the impl is
-    // shut down (m_running cleared), or the timeout elapses.
-    // Returns true if a rebind arrived; false on timeout or shutdown.
+    // StartRebindWait
+    // PollImageRequest then waits for a new USB device to be rebound
+    // (m_rebindReady), the impl to be shut down (m_running cleared), or
+    // kRebindTimeout to elapse.
     // -----------------------------------------------------------------------
-    bool WaitForRebind()
+    void StartRebindWait()
     {
-        ASTRA_LOG;
-
-        constexpr auto kTimeout = std::chrono::seconds(30);
-        std::unique_lock<std::mutex> lock(m_rebindMutex);
-        bool ok = m_rebindCV.wait_for(lock, kTimeout,
-            [this] { return m_rebindReady.load() || !m_running.load(); });
-
-        if (!ok || !m_running.load()) {
-            if (!ok) {
-                log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX fastboot: timeout waiting for reconnect" << endLog;
-            }
-            return false;
-        }
-        m_rebindReady.store(false);
-        log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: rebind received, resuming image loop" << endLog;
-        return true;
+        m_rebindSpan.emplace("WaitForRebind", AstraTraceStore::Args{{"device", m_deviceName}});
+        m_rebindDeadline = std::chrono::steady_clock::now() + kRebindTimeout;
     }
 
     // -----------------------------------------------------------------------
-    // Virtual hook: WaitForImageRequest
-    // Polls the SL26XX fastboot fb_command variable.  Blocks internally until
-    // a "stage <filename>" command arrives, the device disconnects, m_running
-    // is cleared, or the caller-supplied timeout elapses.
+    // Virtual hook: PollImageRequest
+    // Asks U-Boot for the next request with "getvar:fb_command_wait:<ms>",
+    // which the device holds until a stage request is pending or its wait
+    // expires, so a request is seen as soon as it is made.  U-Boot builds
+    // without that variable reject it and are polled via fb_command instead.
+    // Each query is a FastBootDevice::Transfer continued as its responses
+    // arrive; returns once a "stage <filename>" command arrives, the device
+    // disconnects, m_running is cleared, or the deadline passes.
     // -----------------------------------------------------------------------
-    bool WaitForImageRequest(std::string &name, uint8_t &imageType,
-        std::chrono::milliseconds timeout) override
+    ImageRequestPoll PollImageRequest(std::string &name, uint8_t &imageType,
+        std::chrono::steady_clock::time_point &deadline) override
     {
         ASTRA_LOG;
 
-        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (m_running.load()) {
+            const auto now = std::chrono::steady_clock::now();
 
-        while (m_running.load() && std::chrono::steady_clock::now() < deadline) {
-            if (!m_fastbootDevice || m_fastbootDevice->IsDisconnected()) {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot device disconnected" << endLog;
-                m_fbExitPending.store(false);
-                if (m_rebindArmed.load() && WaitForRebind()) {
+            if (m_rebindDeadline != std::chrono::steady_clock::time_point{}) {
+                if (m_rebindReady.exchange(false)) {
+                    m_rebindDeadline = {};
+                    m_rebindSpan.reset();
+                    log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: rebind received, resuming image loop" << endLog;
                     // Rebind succeeded; reset the deadline and retry.
-                    deadline = std::chrono::steady_clock::now() + timeout;
+                    deadline = now + m_imageRequestTimeout;
                     continue;
                 }
-                m_running.store(false);
-                m_deviceEventCV.notify_all();
-                return false;
+                if (now >= m_rebindDeadline) {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX fastboot: timeout waiting for reconnect" << endLog;
+                    break;
+                }
+                // Rebind() resumes the task.
+                ResumeImageRequestTaskAt(m_rebindDeadline);
+                return IMAGE_REQUEST_PENDING;
             }
 
-            // fb_exit was sent.  In rebind-mode we cannot rely on
-            // IsDisconnected() because bulk-only fastboot has no pending
-            // USB transfers, so the no-device event is never fired and
-            // m_disconnected is never set.  Go directly to WaitForRebind()
-            // — but only while the update is still in progress.  Once
-            // UPDATE_COMPLETE (or BOOT_COMPLETE in boot-only mode) is set,
-            // the fb_exit is the final disconnect; disarm rebind and let
-            // the loop exit cleanly.
-            if (m_fbExitPending.load()) {
-                if (m_rebindArmed.load()) {
-                    const bool updateDone =
-                        (m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE) ||
-                        (m_bootOnly && m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE);
-                    if (updateDone) {
-                        // Final fb_exit — no more images to serve.
-                        log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: update done, stopping after final fb_exit" << endLog;
-                        m_rebindArmed.store(false);
-                        m_fbExitPending.store(false);
-                        m_running.store(false);
-                        m_deviceEventCV.notify_all();
-                        return false;
-                    }
-                    log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: fb_exit pending, waiting for rebind" << endLog;
+            if (m_fbCommandQuery == nullptr) {
+                if (now >= deadline) {
+                    return IMAGE_REQUEST_NONE;
+                }
+
+                if (!m_fastbootDevice || m_fastbootDevice->IsDisconnected()) {
+                    log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot device disconnected" << endLog;
                     m_fbExitPending.store(false);
-                    if (WaitForRebind()) {
-                        deadline = std::chrono::steady_clock::now() + timeout;
+                    if (m_rebindArmed.load()) {
+                        StartRebindWait();
                         continue;
                     }
-                    m_running.store(false);
-                    m_deviceEventCV.notify_all();
-                    return false;
+                    break;
+                }
+
+                // fb_exit was sent.  In rebind-mode we cannot rely on
+                // IsDisconnected() because bulk-only fastboot has no pending
+                // USB transfers, so the no-device event is never fired and
+                // m_disconnected is never set.  Go directly to the rebind
+                // wait — but only while the update is still in progress.
+                // Once UPDATE_COMPLETE (or BOOT_COMPLETE in boot-only mode)
+                // is set, the fb_exit is the final disconnect; disarm rebind
+                // and let the task finish cleanly.
+                if (m_fbExitPending.load()) {
+                    if (m_rebindArmed.load()) {
+                        const bool updateDone =
+                            (m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE) ||
+                            (m_bootOnly && m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE);
+                        if (updateDone) {
+                            // Final fb_exit — no more images to serve.
+                            log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: update done, stopping after final fb_exit" << endLog;
+                            m_rebindArmed.store(false);
+                            m_fbExitPending.store(false);
+                            m_running.store(false);
+                            m_deviceEventCV.notify_all();
+                            return IMAGE_REQUEST_NONE;
+                        }
+                        log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: fb_exit pending, waiting for rebind" << endLog;
+                        m_fbExitPending.store(false);
+                        StartRebindWait();
+                        continue;
+                    }
+                    // Non-rebind mode: fall through to the query below.  The
+                    // transfer will fail immediately with NO_DEVICE once the
+                    // device disconnects after fb_exit, which sets
+                    // m_running=false and lets the image request task finish
+                    // cleanly without reporting a spurious BOOT_FAIL.
+                    m_fbExitPending.store(false);
+                }
+
+                if (m_fbCommandWaitSupported) {
+                    // Keep each device-side wait short so shutdown and the
+                    // caller's deadline are still honoured promptly.
+                    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - now).count();
+                    const int waitMs = static_cast<int>(std::clamp<int64_t>(remaining, 1, kFbCommandWaitMs));
+                    m_fbCommandQuery = m_fastbootDevice->StartGetVar("fb_command_wait:" + std::to_string(waitMs),
+                        ImageRequestResumer(), waitMs + kFbCommandWaitMarginMs);
+                } else if (now < m_fbNextPoll) {
+                    ResumeImageRequestTaskAt(std::min(m_fbNextPoll, deadline));
+                    return IMAGE_REQUEST_PENDING;
+                } else {
+                    m_fbCommandQuery = m_fastbootDevice->StartGetVar("fb_command", ImageRequestResumer());
                 }
-                // Non-rebind mode: fall through to the GetVar attempt below.
-                // The transfer will fail immediately with NO_DEVICE once the
-                // device disconnects after fb_exit, which sets m_running=false
-                // and allows RunImageRequestLoop to exit cleanly without
-                // reporting a spurious BOOT_FAIL.
-                m_fbExitPending.store(false);
+                m_fbCommandQueryWaits = m_fbCommandWaitSupported;
+            }
+
+            const int ret = m_fbCommandQuery ? m_fbCommandQuery->Continue() : -1;
+            if (ret == FastBootDevice::kTransferPending) {
+                AwaitImageRequestOperation();
+                return IMAGE_REQUEST_PENDING;
+            }
+            const std::unique_ptr<FastBootDevice::Transfer> query = std::move(m_fbCommandQuery);
+
+            const bool gotCommand = ret == 0 && query->GetStatus() == "OKAY";
+            if (!gotCommand && ret == 0 && m_fbCommandQueryWaits) {
+                // Expected from bootloaders without the variable.
+                log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fb_command_wait rejected: " << query->GetStatus()
+                    << " " << query->GetMessage() << endLog;
+                log(ASTRA_LOG_LEVEL_INFO) << "SL26XX device does not support fb_command_wait, polling fb_command" << endLog;
+                m_fbCommandWaitSupported = false;
+                continue;
             }
 
-            std::string fbCommand;
-            if (!m_fastbootDevice->GetVar("fb_command", fbCommand)) {
-                // GetVar failure means the USB connection dropped.
+            if (!gotCommand) {
+                // A failed query means the USB connection dropped.
                 if (m_rebindArmed.load()) {
                     log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot: GetVar failed (rebind-mode), waiting for reconnect" << endLog;
-                    if (WaitForRebind()) {
-                        deadline = std::chrono::steady_clock::now() + timeout;
-                        continue;
-                    }
+                    StartRebindWait();
+                    continue;
                 } else if (m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE) {
                     log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot disconnected after boot phase, waiting for reconnect" << endLog;
                 } else {
                     log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX failed to get fb_command" << endLog;
                 }
-                m_running.store(false);
-                m_deviceEventCV.notify_all();
-                return false;
+                break;
             }
 
+            const std::string &fbCommand = query->GetMessage();
             if (!fbCommand.empty()) {
                 // Parse "stage <filename>".
                 std::istringstream iss(fbCommand);
@@ -1382,9 +1803,7 @@ private:
 
                 if (parts.empty() || parts[0] != "stage" || parts.size() < 2) {
                     log(ASTRA_LOG_LEVEL_WARNING) << "SL26XX unexpected fb_command: " << fbCommand << endLog;
-                    m_running.store(false);
-                    m_deviceEventCV.notify_all();
-                    return false;
+                    break;
                 }
 
                 // Mirror SL16XX HandleInterrupt: transition to UPDATE when a request
@@ -1393,42 +1812,253 @@ private:
                     m_status = ASTRA_DEVICE_STATUS_UPDATE_START;
                 }
 
+                if (!VerifyPendingImage()) {
+                    break;
+                }
+
                 name      = parts[1];
                 imageType = 0; // SL26XX does not use interrupt-based image types
                 log(ASTRA_LOG_LEVEL_INFO) << "SL26XX stage request: " << name << endLog;
-                return true;
+                return IMAGE_REQUEST_RECEIVED;
             }
 
-            // fb_command is empty — nothing pending yet; retry after a short sleep.
-            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            // fb_command is empty — nothing pending yet.  A blocking query has
+            // already waited on the device; when polling, retry after a short pause.
+            if (!m_fbCommandWaitSupported) {
+                m_fbNextPoll = std::chrono::steady_clock::now() + kFbCommandPollInterval;
+            }
         }
 
-        return false;
+        m_rebindDeadline = {};
+        m_rebindSpan.reset();
+        m_running.store(false);
+        m_deviceEventCV.notify_all();
+        return IMAGE_REQUEST_NONE;
     }
 
     // -----------------------------------------------------------------------
     // Virtual hook: SendImagePayload
-    // Sends the requested file via fastboot StageFile.
-    // START / COMPLETE / FAIL events are managed by RunImageRequestLoop.
+    // Sends the requested file via a fastboot stage, continued by the image
+    // request task as the device takes the data.
+    // START / COMPLETE / FAIL events are managed by the image request task.
     // -----------------------------------------------------------------------
     int SendImagePayload(Image &image) override
     {
         ASTRA_LOG;
 
+        if (m_stageTransfer != nullptr) {
+            return ContinueStage();
+        }
+
         if (!m_fastbootDevice) {
             log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX fastboot device not available" << endLog;
             return -1;
         }
 
-        const bool ok = m_fastbootDevice->StageFile(image.GetPath(),
-            [this, &image](size_t sent, size_t total) {
-                const double pct = (total > 0)
-                    ? static_cast<double>(sent) / static_cast<double>(total) * 100.0
-                    : 100.0;
-                ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS, pct, image.GetName());
-            });
+        auto progress = [this, &image](size_t sent, size_t total) {
+            const double pct = (total > 0)
+                ? static_cast<double>(sent) / static_cast<double>(total) * 100.0
+                : 100.0;
+            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS, pct, image.GetName());
+        };
+
+        auto readImage = [this, &image](uint8_t *data, size_t size) {
+            const int bytesRead = image.GetDataBlock(data, size);
+            if (bytesRead > 0) {
+                DigestImageData(data, static_cast<size_t>(bytesRead));
+            }
+            return bytesRead;
+        };
+
+        // Compressed images are decompressed as they are sent, once
+        // for all devices sending them together if broadcasting.  Sparse
+        // images may need re-sparsing to fit max-download-size, and raw eMMC
+        // images with enough uniform blocks are sent sparse.  Images backed
+        // by the shared image store are staged straight from the mapping;
+        // everything else is read from disk, through the image when it is
+        // digested.
+        // The image stays in m_images while the stage runs.
+        const auto resume = ImageRequestResumer();
+        SparseImage sparse;
+        if (image.IsCompressed()) {
+            // A broadcast reader does not load the image itself.
+            m_stageBroadcast = m_imageBroadcast ? m_imageBroadcast->Join(image) : nullptr;
+            if (m_stageBroadcast) {
+                auto readBroadcast = [this](uint8_t *data, size_t size) {
+                    const int bytesRead = m_stageBroadcast->Read(data, size);
+                    if (bytesRead > 0) {
+                        DigestImageData(data, static_cast<size_t>(bytesRead));
+                    }
+                    return bytesRead;
+                };
+                m_stageTransfer = m_fastbootDevice->StartStageStream(image.GetSize(), readBroadcast, resume, progress);
+            } else if (image.Load() == 0) {
+                m_stageTransfer = m_fastbootDevice->StartStageStream(image.GetSize(), readImage, resume, progress);
+            }
+        } else if (SparseImage::IsSparse(image.GetFilePath(), image.GetFileOffset())) {
+            if (image.IsFileSlice() && image.GetMappedData() != nullptr && image.Load() == 0) {
+                m_stageTransfer = m_fastbootDevice->StartStageSparseData(image.GetFilePath(), image.GetFileOffset(),
+                    image.GetMappedData(), image.GetSize(), resume, progress);
+            } else {
+                m_stageTransfer = m_fastbootDevice->StartStageSparseFile(image.GetPath(), resume, progress);
+            }
+        } else if (SparsifyImage(image, sparse)) {
+            // U-Boot expands the FILL chunks back into the same bytes.
+            DigestSharedImageData(image.GetMappedData(), image.GetSize());
+            m_stageTransfer = m_fastbootDevice->StartStageSparse(sparse, resume, progress);
+        } else if (image.GetMappedData() != nullptr && image.Load() == 0) {
+            // The mapping outlives the transfer, so it is hashed in place.
+            DigestSharedImageData(image.GetMappedData(), image.GetSize());
+            m_stageTransfer = m_fastbootDevice->StartStageData(image.GetMappedData(), image.GetSize(), resume, progress);
+        } else if (IsImageDigestActive() && image.Load() == 0) {
+            m_stageTransfer = m_fastbootDevice->StartStageStream(image.GetSize(), readImage, resume, progress);
+        } else {
+            m_stageTransfer = m_fastbootDevice->StartStageFile(image.GetPath(), resume, progress);
+        }
+
+        if (m_stageTransfer == nullptr) {
+            m_stageBroadcast.reset();
+            return -1;
+        }
+        return ContinueStage();
+    }
+
+    // Continue the stage started by SendImagePayload() or SendImageBatch().
+    int ContinueStage()
+    {
+        const int ret = m_stageTransfer->Continue();
+        if (ret == FastBootDevice::kTransferPending) {
+            AwaitImageRequestOperation();
+            return kImageSendPending;
+        }
+        m_stageTransfer.reset();
+        m_stageBroadcast.reset();
+        m_stageBatch = std::vector<uint8_t>();
+        return ret < 0 ? -1 : 0;
+    }
+
+    // -----------------------------------------------------------------------
+    // Virtual hook: PrepareImage
+    // Start scanning the next image for uniform blocks so SparsifyImage()
+    // finds the result waiting instead of reading the image first.
+    // -----------------------------------------------------------------------
+    void PrepareImage(const Image &image) override
+    {
+        // The copy shares the mapping and keeps it alive for the scan.
+        Image scanned = image;
+        if (!m_sparseStagingSupported || !CanSparsify(scanned) || HasIndexedUniformBlocks(scanned) ||
+            scanned.GetPath() == m_scannedImagePath)
+        {
+            return;
+        }
+
+        m_scannedImagePath = scanned.GetPath();
+        std::packaged_task<std::vector<BlockScanner::Run>()> scan([scanned]() {
+            return BlockScanner::FindUniformRuns(scanned.GetMappedData(), scanned.GetSize(), kSparseBlockSize);
+        });
+        m_imageScan = scan.get_future();
+
+        // The scan holds its own copy of the image, so it may outlive the device.
+        ThreadPolicy::Start(THREAD_ROLE_TRANSFER, "astra-scan", std::move(scan)).detach();
+    }
+
+    // -----------------------------------------------------------------------
+    // SparsifyImage
+    // Describe a raw eMMC image as a sparse one when that keeps at least
+    // kMinSparsifiedBytes of uniform blocks off the wire.  Only mapped images
+    // are scanned, since the scan reads all of the image.  A raw list entry
+    // is written as it was downloaded, so this needs a staging script which
+    // reports getvar:fb_sparse and expands sparse downloads for every entry;
+    // older scripts get raw entries raw.
+    // -----------------------------------------------------------------------
+    static constexpr uint32_t kSparseBlockSize = 4096;
+    static constexpr uint64_t kMinSparsifiedBytes = 1024 * 1024;
+
+    static bool CanSparsify(Image &image)
+    {
+        return image.GetImageType() == ASTRA_IMAGE_TYPE_UPDATE_EMMC && !image.IsCompressed() &&
+            image.GetMappedData() != nullptr && !SparseImage::IsSparse(image.GetFilePath(), image.GetFileOffset()) && image.Load() == 0 &&
+            image.GetSize() >= kMinSparsifiedBytes && (image.GetSize() % kSparseBlockSize) == 0;
+    }
+
+    static bool HasIndexedUniformBlocks(const Image &image)
+    {
+        return image.GetUniformBlocks() != nullptr && image.GetUniformBlocks()->m_blockSize == kSparseBlockSize;
+    }
+
+    bool SparsifyImage(Image &image, SparseImage &sparse)
+    {
+        ASTRA_LOG;
+
+        if (!CanSparsify(image) || !IsSparseStagingSupported()) {
+            return false;
+        }
+
+        // Found when the flash image was loaded, by the background scan, or now.
+        std::vector<BlockScanner::Run> scannedRuns;
+        const std::vector<BlockScanner::Run> *runs = &scannedRuns;
+        if (HasIndexedUniformBlocks(image)) {
+            runs = &image.GetUniformBlocks()->m_runs;
+        } else if (m_imageScan.valid() && m_scannedImagePath == image.GetPath()) {
+            scannedRuns = m_imageScan.get();
+        } else {
+            scannedRuns = BlockScanner::FindUniformRuns(image.GetMappedData(), image.GetSize(), kSparseBlockSize);
+        }
+
+        uint64_t uniformBlocks = 0;
+        for (const auto &run : *runs) {
+            uniformBlocks += run.m_blocks;
+        }
+        if (uniformBlocks * kSparseBlockSize < kMinSparsifiedBytes ||
+            sparse.FromRaw(image.GetFilePath(), image.GetSize(), kSparseBlockSize, *runs, image.GetFileOffset()) < 0)
+        {
+            return false;
+        }
+
+        log(ASTRA_LOG_LEVEL_INFO) << "Sending " << image.GetName() << " sparse: " << uniformBlocks << " of "
+            << image.GetSize() / kSparseBlockSize << " blocks uniform, " << sparse.GetFileSize()
+            << " bytes on the wire" << endLog;
+        return true;
+    }
+
+    bool IsSparseStagingSupported()
+    {
+        ASTRA_LOG;
+
+        if (!m_sparseStagingChecked && m_fastbootDevice) {
+            m_sparseStagingChecked = true;
+            std::string sparse;
+            if (!m_fastbootDevice->GetVar("fb_sparse", sparse)) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX device does not support fb_sparse, sending raw images raw" << endLog;
+                m_sparseStagingSupported = false;
+            }
+        }
+        return m_sparseStagingSupported && m_sparseStagingChecked;
+    }
+
+    // -----------------------------------------------------------------------
+    // Virtual hook: GetTunableChunkSizes / SetTransferChunkSize
+    // Fastboot downloads may be split into bulk writes of any size.
+    // -----------------------------------------------------------------------
+    std::vector<size_t> GetTunableChunkSizes() const override
+    {
+        return {FastBootDevice::kDownloadChunkSize, 1024 * 1024, 2 * 1024 * 1024, 8 * 1024 * 1024};
+    }
+
+    void SetTransferChunkSize(size_t chunkSize) override
+    {
+        if (m_fastbootDevice) {
+            m_fastbootDevice->SetDownloadChunkSize(chunkSize);
+        }
+    }
 
-        return ok ? 0 : -1;
+    // -----------------------------------------------------------------------
+    // Virtual hook: GetTransferMemory
+    // A staged batch is encoded into its own buffer before it is downloaded.
+    // -----------------------------------------------------------------------
+    uint64_t GetTransferMemory() const override
+    {
+        return AstraDeviceImpl::GetTransferMemory() + (m_imageBatchSupported ? kMaxImageBatchSize : 0);
     }
 
     // -----------------------------------------------------------------------
@@ -1438,15 +2068,251 @@ private:
     void OnImageSent(const Image &image, bool success) override
     {
         (void)image;
+        const bool batch = m_imageBatchStaged;
+        m_imageBatchStaged = false;
+        FinishStageRequest(success ? (batch ? "BATCH" : "OKAY") : "FAIL");
+    }
+
+    // -----------------------------------------------------------------------
+    // Virtual hook: FitImageBatch / SendImageBatch
+    // A staging script that reports getvar:fb_batch unpacks a FastbootBatch
+    // download when its request is answered with fb_ret BATCH: it writes
+    // every image in the batch and continues its list after the last one.
+    // Only small plain images are batched; the bytes they save are round
+    // trips, which a large image does not notice.
+    // -----------------------------------------------------------------------
+    static constexpr size_t kMaxBatchedImageSize = 64 * 1024;
+    static constexpr size_t kMaxImageBatchSize = 1024 * 1024;
+
+    void FitImageBatch(std::vector<Image *> &images) override
+    {
+        ASTRA_LOG;
+
+        if (!m_fastbootDevice || !m_imageBatchSupported) {
+            images.resize(1);
+            return;
+        }
+
+        if (m_maxImageBatchSize == 0) {
+            std::string version;
+            if (!m_fastbootDevice->GetVar("fb_batch", version) ||
+                version != std::to_string(FastbootBatch::kVersion))
+            {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX device does not support fb_batch, staging images one at a time" << endLog;
+                m_imageBatchSupported = false;
+                images.resize(1);
+                return;
+            }
+            m_maxImageBatchSize = std::min(m_fastbootDevice->GetMaxDownloadSize(), kMaxImageBatchSize);
+            log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX fastboot batches of up to " << m_maxImageBatchSize << " bytes" << endLog;
+        }
+
+        std::vector<size_t> payloadSizes;
+        size_t count = 0;
+        for (Image *image : images) {
+            if (image->IsCompressed() || image->GetName().size() > FastbootBatch::kMaxNameLength ||
+                SparseImage::IsSparse(image->GetFilePath(), image->GetFileOffset()) || image->Load() != 0 ||
+                image->GetSize() > kMaxBatchedImageSize)
+            {
+                break;
+            }
+            payloadSizes.push_back(image->GetSize());
+            if (FastbootBatch::GetEncodedSize(payloadSizes) > m_maxImageBatchSize) {
+                break;
+            }
+            ++count;
+        }
+        images.resize(std::max<size_t>(count, 1));
+    }
+
+    int SendImageBatch(const std::vector<Image *> &images) override
+    {
+        ASTRA_LOG;
+
+        if (m_stageTransfer != nullptr) {
+            return FinishImageBatch(ContinueStage());
+        }
+
+        if (!m_fastbootDevice) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "SL26XX fastboot device not available" << endLog;
+            return -1;
+        }
+
+        std::vector<FastbootBatch::Entry> entries;
+        for (Image *image : images) {
+            FastbootBatch::Entry entry{image->GetName(), std::vector<uint8_t>(image->GetSize())};
+            size_t offset = 0;
+            if (image->Load() == 0) {
+                while (offset < entry.m_data.size()) {
+                    const int bytesRead = image->GetDataBlock(entry.m_data.data() + offset, entry.m_data.size() - offset);
+                    if (bytesRead <= 0) {
+                        break;
+                    }
+                    offset += static_cast<size_t>(bytesRead);
+                }
+            }
+            if (offset != entry.m_data.size()) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to read " << image->GetName() << " into the batch" << endLog;
+                return -1;
+            }
+            entries.push_back(std::move(entry));
+        }
+        m_stageBatch = FastbootBatch::Encode(entries);
+
+        const std::string imageName = images.front()->GetName();
+        auto progress = [this, imageName](size_t sent, size_t total) {
+            const double pct = (total > 0)
+                ? static_cast<double>(sent) / static_cast<double>(total) * 100.0
+                : 100.0;
+            ReportStatus(ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS, pct, imageName);
+        };
+
+        m_stageTransfer = m_fastbootDevice->StartStageData(m_stageBatch.data(), m_stageBatch.size(),
+            ImageRequestResumer(), progress);
+        if (m_stageTransfer == nullptr) {
+            m_stageBatch = std::vector<uint8_t>();
+            return -1;
+        }
+        return FinishImageBatch(ContinueStage());
+    }
+
+    int FinishImageBatch(int ret)
+    {
+        if (ret == 0) {
+            m_imageBatchStaged = true;
+        }
+        return ret;
+    }
+
+    // -----------------------------------------------------------------------
+    // Virtual hook: IsImageUnchanged
+    // Delta updates: U-Boot reports the SHA-256 of the region the requested
+    // image would be written to via "getvar:sha256:<image>".
+    // -----------------------------------------------------------------------
+    bool IsImageUnchanged(const Image &image) override
+    {
+        ASTRA_LOG;
+
+        if (!m_fastbootDevice || !m_deviceDigestSupported) {
+            return false;
+        }
+
+        std::string deviceDigest;
+        if (!m_fastbootDevice->GetVar("sha256:" + image.GetName(), deviceDigest)) {
+            log(ASTRA_LOG_LEVEL_WARNING) << "Device does not report image digests; delta update disabled" << endLog;
+            m_deviceDigestSupported = false;
+            return false;
+        }
+
+        std::transform(deviceDigest.begin(), deviceDigest.end(), deviceDigest.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Digest of " << image.GetName() << ": host " << image.GetDigest()
+            << " device " << deviceDigest << endLog;
+        return deviceDigest == image.GetDigest();
+    }
+
+    // -----------------------------------------------------------------------
+    // Virtual hook: VerifyImageOnDevice
+    // U-Boot only writes a staged image after fb_exit, so its digest can be
+    // queried in the next session: the check is left pending until the
+    // device asks for its next image (see VerifyPendingImage).
+    // -----------------------------------------------------------------------
+    bool VerifyImageOnDevice(const Image &image, const std::string &expectedDigest) override
+    {
+        if (m_deviceDigestSupported) {
+            m_pendingVerifyImage = image.GetName();
+            m_pendingVerifyDigest = expectedDigest;
+        }
+        return true;
+    }
+
+    // Check the image sent in the previous session against the digest U-Boot
+    // reports for it.  Returns false (and reports UPDATE_FAIL) on a mismatch.
+    bool VerifyPendingImage()
+    {
+        ASTRA_LOG;
+
+        if (m_pendingVerifyImage.empty()) {
+            return true;
+        }
+        const std::string imageName = std::move(m_pendingVerifyImage);
+        m_pendingVerifyImage.clear();
+
+        std::string deviceDigest;
+        if (!m_fastbootDevice->GetVar("sha256:" + imageName, deviceDigest)) {
+            log(ASTRA_LOG_LEVEL_WARNING) << "Device does not report image digests; device verification disabled" << endLog;
+            m_deviceDigestSupported = false;
+            return true;
+        }
+
+        std::transform(deviceDigest.begin(), deviceDigest.end(), deviceDigest.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (deviceDigest != m_pendingVerifyDigest) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Device digest mismatch for " << imageName << ": expected "
+                << m_pendingVerifyDigest << " device " << deviceDigest << endLog;
+            m_status = ASTRA_DEVICE_STATUS_UPDATE_FAIL;
+            ReportStatus(m_status, 0, imageName, "Image verification failed");
+            return false;
+        }
+
+        log(ASTRA_LOG_LEVEL_INFO) << "Image verified on device: " << imageName << endLog;
+        return true;
+    }
+
+    // -----------------------------------------------------------------------
+    // Virtual hook: CanResumeUpdate / OnResumeUpdate
+    // U-Boot keeps the serial# from our uEnv.txt across fastboot reconnects.
+    // A staging script that can resume its image list reports fb_resume;
+    // setting it to the next image jumps there once the current request is
+    // answered with SKIP.  Older scripts only know OKAY and FAIL, so they
+    // are sent every image again.
+    // -----------------------------------------------------------------------
+    bool CanResumeUpdate() const override
+    {
+        return true;
+    }
+
+    bool OnResumeUpdate(const std::string &nextImageName) override
+    {
+        ASTRA_LOG;
+
+        std::string resume;
+        if (!m_fastbootDevice || !m_fastbootDevice->GetVar("fb_resume", resume)) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "SL26XX device does not support fb_resume" << endLog;
+            return false;
+        }
+        if (!nextImageName.empty()) {
+            m_fastbootDevice->Oem("run:setenv fb_resume " + nextImageName);
+        }
+        return true;
+    }
+
+    // -----------------------------------------------------------------------
+    // Virtual hook: OnImageSkipped
+    // fb_ret SKIP tells the staging loop to leave the partition untouched.
+    // -----------------------------------------------------------------------
+    void OnImageSkipped(const Image &image) override
+    {
+        (void)image;
+        FinishStageRequest("SKIP");
+    }
+
+    // Report the result of a stage request and leave the U-Boot staging loop.
+    void FinishStageRequest(const std::string &result)
+    {
         if (!m_fastbootDevice) {
             return;
         }
-        m_fastbootDevice->Oem("run:setenv fb_ret " + std::string(success ? "OKAY" : "FAIL"));
+        m_fastbootDevice->Oem("run:setenv fb_ret " + result);
         // Send fb_exit without waiting for a response: U-Boot exits its staging
         // loop and resets the USB connection before it can send OKAY back.
-        // Set m_fbExitPending so WaitForImageRequest does not attempt any further
+        // Set m_fbExitPending so PollImageRequest does not attempt any further
         // USB transfers until the disconnect is detected and (if in rebind-mode)
         // a new device instance arrives.
+        {
+            std::lock_guard<std::mutex> lock(m_rebindMutex);
+            m_fbExitTime = std::chrono::steady_clock::now();
+        }
         m_fbExitPending.store(true);
         m_fastbootDevice->OemNoWait("run:setenv fb_exit 1");
     }
@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <iterator>
+#include <map>
 #include <queue>
 #include <memory>
 #include <thread>
@@ -14,12 +16,29 @@
 #include "astra_device.hpp"
 #include "astra_device_manager.hpp"
 #include "boot_image_collection.hpp"
+#include "boot_packet_cache.hpp"
+#include "boot_sessions.hpp"
+#include "device_scheduler.hpp"
+#include "event_executor.hpp"
 #include "fastboot_device.hpp"
 #include "libusb_transport.hpp"
+#include "metrics_server.hpp"
 #include "posix_usb_cdc_transport.hpp"
+#include "response_dispatcher.hpp"
+#include "response_times.hpp"
+#include "sha256.hpp"
+#include "simulated_usb_transport.hpp"
+#include "station_metrics.hpp"
+#include "thread_policy.hpp"
+#include "transfer_tuner.hpp"
+#include "update_checkpoints.hpp"
 #include "usb_cdc_transport.hpp"
 #include "image.hpp"
+#include "image_broadcast.hpp"
+#include "image_store.hpp"
 #include "astra_log.hpp"
+#include "astra_profile.hpp"
+#include "astra_trace.hpp"
 #include "utils.hpp"
 
 #if PLATFORM_WINDOWS
@@ -32,9 +51,11 @@ public:
     AstraDeviceManagerImpl(std::function<void(AstraDeviceManagerResponse)> responseCallback,
         bool runContinuously,
         AstraLogLevel minLogLevel, const std::string &logPath,
-                const std::string &tempDir, const std::string &filterPorts, bool usbDebug)
+                const std::string &tempDir, const std::string &filterPorts, bool usbDebug, bool trace,
+                bool mergeDeviceLogs, unsigned maxActiveTransfers, unsigned maxTransfersPerHub)
         : m_responseCallback{responseCallback}, m_runContinuously{runContinuously}, m_filterPorts{filterPorts},
-                    m_usbDebug{usbDebug}
+                    m_usbDebug{usbDebug},
+                    m_deviceScheduler{std::make_shared<DeviceScheduler>(maxActiveTransfers, maxTransfersPerHub)}
     {
         if (tempDir.empty()) {
             m_tempDir = MakeTempDirectory();
@@ -52,122 +73,275 @@ public:
             m_modifiedLogPath = m_tempDir + "/astra_device_manager.log";
         }
         AstraLogStore::getInstance().Open(m_modifiedLogPath, minLogLevel);
+        if (m_runContinuously) {
+            // Each device logs to <temp>/<device>/device.log so devices don't
+            // contend on one stream and a failing board's log stands alone.
+            AstraLogStore::getInstance().EnableDeviceLogs(mergeDeviceLogs);
+        }
 
         ASTRA_LOG;
 
         log(ASTRA_LOG_LEVEL_INFO) << "astra-update v" << AstraDeviceManager::GetVersion() << endLog;
+        if (maxActiveTransfers > 0) {
+            log(ASTRA_LOG_LEVEL_INFO) << "Limiting concurrent device updates to " << maxActiveTransfers << endLog;
+        }
+        if (maxTransfersPerHub > 0) {
+            log(ASTRA_LOG_LEVEL_INFO) << "Limiting concurrent device updates per USB hub to " << maxTransfersPerHub << endLog;
+        }
+
+        if (trace) {
+            m_traceFile = SessionOutputPath("astra_trace.json");
+            AstraTraceStore::getInstance().Open(m_traceFile);
+            AstraTraceStore::getInstance().SetThreadName("device manager");
+            log(ASTRA_LOG_LEVEL_INFO) << "Recording trace to " << m_traceFile << endLog;
+        }
     }
 
-    void Update(std::shared_ptr<FlashImage> flashImage, std::string bootImagesPath)
+    void SetSimulator(const AstraSimulatorConfig &config)
+    {
+        m_simulatorConfig = config;
+    }
+
+    void SetFilterPorts(const std::string &filterPorts)
+    {
+        m_filterPorts = filterPorts;
+    }
+
+    void SetProgressInterval(unsigned milliseconds)
+    {
+        m_responseDispatcher->SetProgressInterval(std::chrono::milliseconds(milliseconds));
+    }
+
+    void EnableTransferTuning(const std::string &statePath)
     {
         ASTRA_LOG;
 
-        m_flashImage = flashImage;
-        m_bootCommand = flashImage->GetFlashCommand();
+        // Simulated links would only teach the tuner about the simulator.
+        std::string path = statePath;
+        if (path.empty() && m_simulatorConfig.m_deviceCount == 0) {
+            path = TransferTuner::DefaultStatePath();
+        }
+        m_transferTuner = std::make_shared<TransferTuner>(path);
+        log(ASTRA_LOG_LEVEL_INFO) << "Tuning transfers" << (path.empty() ? "" : ", state in " + path) << endLog;
+    }
 
-        m_managerMode = ASTRA_DEVICE_MANAGER_MODE_UPDATE;
+    void EnableUpdateResume(unsigned windowSeconds, const std::string &statePath)
+    {
+        ASTRA_LOG;
 
-        BootImageCollection bootImageCollection = BootImageCollection(bootImagesPath);
-        bootImageCollection.Load();
+        // Simulated boards never come back from an earlier run.
+        std::string path = statePath;
+        if (path.empty() && m_simulatorConfig.m_deviceCount == 0) {
+            path = UpdateCheckpoints::DefaultStatePath();
+        }
+        m_updateCheckpoints = std::make_shared<UpdateCheckpoints>(path, std::chrono::seconds(windowSeconds));
+        log(ASTRA_LOG_LEVEL_INFO) << "Resuming updates interrupted in the last " << windowSeconds << " s"
+            << (path.empty() ? "" : ", checkpoints in " + path) << endLog;
+    }
 
-        const bool requiresNandBootSupport =
-            m_flashImage->GetFlashImageType() == FLASH_IMAGE_TYPE_NAND;
+    void SetTransferMemoryBudget(uint64_t budgetBytes)
+    {
+        ASTRA_LOG;
 
-        if (m_flashImage->GetBootImageId().empty()) {
-            // No boot images specified.
-            // Try to find the best boot image based on other properties
-            if (m_flashImage->GetChipName().empty()) {
-                throw std::runtime_error("Chip name and boot bootImage ID missing!");
-            }
+        m_deviceScheduler->SetMemoryBudget(budgetBytes);
+        log(ASTRA_LOG_LEVEL_INFO) << "Transfer buffers limited to " << (budgetBytes >> 20) << " MiB" << endLog;
+    }
 
-            std::vector<std::shared_ptr<AstraBootImage>> bootImages = bootImageCollection.GetBootImagesForChip(m_flashImage->GetChipName(),
-            m_flashImage->GetSecureBootVersion(), m_flashImage->GetMemoryLayout(), m_flashImage->GetMemoryDDRType(), m_flashImage->GetBoardName());
-            if (requiresNandBootSupport) {
-                bootImages.erase(std::remove_if(bootImages.begin(), bootImages.end(),
-                    [](const std::shared_ptr<AstraBootImage> &bootImage) {
-                        return !bootImage->GetNandSupport();
-                    }),
-                    bootImages.end());
-            }
-            if (bootImages.size() == 0) {
-                if (requiresNandBootSupport) {
-                    throw std::runtime_error("No NAND-capable boot image found for chip: " + m_flashImage->GetChipName());
-                }
-                throw std::runtime_error("No boot image found for chip: " + m_flashImage->GetChipName());
-            } else if (bootImages.size() > 1) {
-                m_bootImage = bootImages[0];
-                for (const auto& bootImage : bootImages) {
-                    log(ASTRA_LOG_LEVEL_INFO) << "Boot Image: " << bootImage->GetChipName() << " " << bootImage->GetBoardName() << endLog;
-                    if (bootImage->GetUbootVariant() == ASTRA_UBOOT_VARIANT_SYNAPTICS && bootImage->GetUEnvSupport()) {
-                        // Boot bootImages with Synaptics u-boot variant is preferred
-                        m_bootImage = bootImage;
-                        break;
-                    } else if (bootImage->GetUEnvSupport()) {
-                        // Boot bootImages with uEnv support is preferred
-                        m_bootImage = bootImage;
-                    } else if (!m_bootImage->GetUEnvSupport() && bootImage->GetUbootConsole() == ASTRA_UBOOT_CONSOLE_USB) {
-                        // Boot bootImages with USB console is preferred over UART
-                        // But only if there is no uEnv support
-                        m_bootImage = bootImage;
-                    }
-                }
-            } else {
-                // Try the only option
-                m_bootImage = bootImages[0];
-            }
-        } else {
-            // Exact boot bootImages specified
-            m_bootImage = std::make_shared<AstraBootImage>(bootImageCollection.GetBootImage(m_flashImage->GetBootImageId()));
-            if (requiresNandBootSupport && !m_bootImage->GetNandSupport()) {
-                throw std::runtime_error("Selected boot image does not support NAND flash updates");
-            }
+    void SetImageRequestTimeout(unsigned seconds)
+    {
+        m_imageRequestTimeout = std::chrono::seconds(seconds);
+    }
+
+    void EnableImageBroadcast(uint64_t slackBytes)
+    {
+        ASTRA_LOG;
+
+        m_imageBroadcast = std::make_shared<ImageBroadcast>(slackBytes);
+        log(ASTRA_LOG_LEVEL_INFO) << "Broadcasting compressed images with " << (slackBytes >> 20)
+            << " MiB of slack" << endLog;
+    }
+
+    void EnableProfiling()
+    {
+        ASTRA_LOG;
+
+        m_profileFile = SessionOutputPath("astra_profile.txt");
+        AstraProfileStore::getInstance().Open(m_profileFile);
+        log(ASTRA_LOG_LEVEL_INFO) << "Profiling to " << m_profileFile << endLog;
+    }
+
+    bool EnableMetrics(const std::string &address)
+    {
+        ASTRA_LOG;
+
+        m_stationMetrics = std::make_shared<StationMetrics>();
+        m_metricsServer = std::make_unique<MetricsServer>([this]() {
+            return m_stationMetrics->Render(m_deviceScheduler->GetBusTransferStats());
+        });
+        if (!m_metricsServer->Start(address)) {
+            m_metricsServer.reset();
+            m_stationMetrics.reset();
+            return false;
         }
+        return true;
+    }
+
+    void Update(std::shared_ptr<FlashImage> flashImage, std::string bootImagesPath)
+    {
+        AddUpdateJob(flashImage, bootImagesPath, m_filterPorts, nullptr);
+    }
+
+    int AddUpdateJob(std::shared_ptr<FlashImage> flashImage, std::string bootImagesPath, const std::string &filterPorts,
+        std::function<void(AstraDeviceManagerResponse)> responseCallback)
+    {
+        ASTRA_LOG;
 
-        log(ASTRA_LOG_LEVEL_INFO) << "Selected boot image: " << m_bootImage->GetChipName() << " " << m_bootImage->GetBoardName() << " (" << m_bootImage->GetID() << ")" << endLog;
+        std::lock_guard<std::mutex> controlLock(m_jobControlMutex);
+
+        auto job = std::make_shared<Job>();
+        job->m_managerMode = ASTRA_DEVICE_MANAGER_MODE_UPDATE;
+        job->m_flashImage = flashImage;
+        job->m_bootCommand = flashImage->GetFlashCommand();
+        job->m_filterPorts = filterPorts;
+        job->m_responseCallback = responseCallback;
+        job->m_bootImage = SelectBootImage(*flashImage, LoadBootImageCollection(bootImagesPath));
+
+        // The collection only parsed manifests; list the selected image's files now.
+        if (!job->m_bootImage->LoadImages()) {
+            throw std::runtime_error("Failed to load boot image: " + job->m_bootImage->GetID());
+        }
 
-        Init();
+        return AddJob(job);
     }
 
     void Boot(std::string bootImagePath, std::string bootCommand, AstraDeviceBootStage bootStage)
     {
         ASTRA_LOG;
 
-        m_managerMode = ASTRA_DEVICE_MANAGER_MODE_BOOT;
-        m_bootCommand = bootCommand;
-        m_bootStage = bootStage;
+        std::lock_guard<std::mutex> controlLock(m_jobControlMutex);
+
+        auto job = std::make_shared<Job>();
+        job->m_managerMode = ASTRA_DEVICE_MANAGER_MODE_BOOT;
+        job->m_bootCommand = bootCommand;
+        job->m_bootStage = bootStage;
+        job->m_filterPorts = m_filterPorts;
 
         AstraBootImage bootImage{bootImagePath};
         if (!bootImage.Load()) {
             throw std::runtime_error("Failed to load boot image");
         }
 
-        m_bootImage = std::make_shared<AstraBootImage>(bootImage);
+        job->m_bootImage = std::make_shared<AstraBootImage>(bootImage);
 
         // Allow manifest to set default stage; CLI overrides it.
-        if (m_bootStage == ASTRA_DEVICE_BOOT_STAGE_AUTO && m_bootImage->GetDefaultBootStage() != ASTRA_DEVICE_BOOT_STAGE_AUTO) {
-            m_bootStage = m_bootImage->GetDefaultBootStage();
+        if (job->m_bootStage == ASTRA_DEVICE_BOOT_STAGE_AUTO && job->m_bootImage->GetDefaultBootStage() != ASTRA_DEVICE_BOOT_STAGE_AUTO) {
+            job->m_bootStage = job->m_bootImage->GetDefaultBootStage();
         }
 
-        Init();
+        AddJob(job);
     }
 
-    bool Shutdown()
+    bool EndJob(int jobId)
     {
         ASTRA_LOG;
 
+        std::lock_guard<std::mutex> controlLock(m_jobControlMutex);
+
         // Snapshot and clear under the lock, then Close() outside it.
         // Close() → UnregisterFastbootSerial() also acquires m_devicesMutex;
         // calling Close() while holding the lock would re-enter a non-recursive
         // mutex and throw std::system_error in the MSVC debug CRT.
+        std::shared_ptr<Job> job;
         std::vector<std::shared_ptr<AstraDevice>> devicesToClose;
         {
             std::lock_guard<std::mutex> lock(m_devicesMutex);
-            devicesToClose = std::move(m_devices);
-            m_devices.clear();
+            auto it = m_jobs.find(jobId);
+            if (it == m_jobs.end()) {
+                log(ASTRA_LOG_LEVEL_WARNING) << "No job " << jobId << " to end" << endLog;
+                return false;
+            }
+            job = it->second;
+            m_jobs.erase(it);
+            devicesToClose = std::move(job->m_devices);
+            job->m_devices.clear();
         }
-        for (auto& device : devicesToClose) {
+
+        std::vector<std::string> usbPaths;
+        for (auto &device : devicesToClose) {
+            usbPaths.push_back(device->GetUSBPath());
             device->Close();
         }
+
+        {
+            std::unique_lock<std::mutex> lock(job->m_threadMutex);
+            if (!job->m_threadCV.wait_for(lock, kDeviceThreadJoinTimeout, [&job]() { return job->m_activeThreads == 0; })) {
+                log(ASTRA_LOG_LEVEL_WARNING) << "Job " << jobId << " still has " << job->m_activeThreads
+                    << " device thread(s) running" << endLog;
+            }
+        }
+
+        // A successful device stays in the transports' active sets so it is
+        // not served twice within a job; a later job may serve its port again.
+        for (const auto &usbPath : usbPaths) {
+            if (job->m_transport) { job->m_transport->RemoveActiveDevice(usbPath); }
+            if (job->m_fastbootTransport) { job->m_fastbootTransport->RemoveActiveDevice(usbPath); }
+        }
+
+        devicesToClose.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            for (auto it = m_fastbootDeviceBySerial.begin(); it != m_fastbootDeviceBySerial.end();) {
+                it = it->second.expired() ? m_fastbootDeviceBySerial.erase(it) : std::next(it);
+            }
+        }
+
+        // The job's callback may go away once we return.
+        m_responseDispatcher->Flush();
+
+        const bool failed = job->m_failureReported.load();
+        log(ASTRA_LOG_LEVEL_INFO) << "Job " << jobId << " finished" << (failed ? " with failures" : "") << endLog;
+        return failed;
+    }
+
+    bool EndRun()
+    {
+        ASTRA_LOG;
+
+        std::vector<int> jobIds;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            for (const auto &[jobId, job] : m_jobs) {
+                jobIds.push_back(jobId);
+            }
+        }
+
+        bool failed = false;
+        for (int jobId : jobIds) {
+            failed = EndJob(jobId) || failed;
+        }
+
+        log(ASTRA_LOG_LEVEL_INFO) << "Run finished" << (failed ? " with failures" : "") << endLog;
+        return failed;
+    }
+
+    bool Shutdown()
+    {
+        ASTRA_LOG;
+
+        CloseDevices();
+
+        // Device threads still touch the transports; let them unwind first.
+        m_deviceScheduler->JoinAll(kDeviceThreadJoinTimeout);
+        m_responseDispatcher->Stop();
+
+        for (const auto &hubStats : m_deviceScheduler->GetBusTransferStats()) {
+            log(ASTRA_LOG_LEVEL_INFO) << "USB hub " << hubStats.m_hub << ": " << hubStats.m_devices << " device(s), "
+                << hubStats.m_bytes << " bytes in " << hubStats.m_busySeconds << " s busy, "
+                << hubStats.GetMBps() << " MB/s" << endLog;
+        }
+
+        AstraProfileStore::getInstance().Close();
+        AstraTraceStore::getInstance().Close();
         AstraLogStore::getInstance().Close();
 
         if (m_removeTempOnClose) {
@@ -178,12 +352,7 @@ public:
             }
         }
 
-        m_transport->Shutdown();
-
-        if (m_fastbootTransport) {
-            m_fastbootTransport->Shutdown();
-            m_fastbootTransport.reset();
-        }
+        ShutdownTransports();
 
         return m_failureReported;
     }
@@ -194,44 +363,228 @@ public:
         return m_modifiedLogPath;
     }
 
+    std::string GetTraceFile() const
+    {
+        return m_traceFile;
+    }
+
+    std::string GetProfileFile() const
+    {
+        return m_profileFile;
+    }
+
+    std::vector<BusTransferStats> GetBusTransferStats() const
+    {
+        return m_deviceScheduler->GetBusTransferStats();
+    }
+
 private:
-    std::shared_ptr<USBTransport> m_transport;
-    std::shared_ptr<USBTransport> m_fastbootTransport;
+    // One Update() or Boot() and the devices serving it.  Jobs run side by
+    // side; each arriving device goes to the job whose ports match it most
+    // specifically among those expecting its VID:PID.
+    struct Job
+    {
+        int m_id = 0;
+        AstraDeviceManangerMode m_managerMode = ASTRA_DEVICE_MANAGER_MODE_UPDATE;
+        std::shared_ptr<AstraBootImage> m_bootImage;
+        std::shared_ptr<FlashImage> m_flashImage;
+        std::string m_bootCommand;
+        AstraDeviceBootStage m_bootStage = ASTRA_DEVICE_BOOT_STAGE_AUTO;
+        AstraDeviceSeries m_deviceSeries = ASTRA_SERIES_SL16XX;
+        AstraTransportType m_transportType = ASTRA_TRANSPORT_USB;
+        std::string m_filterPorts;
+        std::vector<std::string> m_ports;
+        // Boot ROM and system manager IDs, which tell the chips apart.
+        std::vector<USBVendorProductId> m_chipIds;
+        // VID:PID of the fastboot USB device, or 0:0.
+        uint16_t m_fastbootVid = 0;
+        uint16_t m_fastbootPid = 0;
+        // Falls back to the manager's callback when empty.
+        std::function<void(AstraDeviceManagerResponse)> m_responseCallback;
+
+        // The transport of m_transportType and, for USB CDC jobs, the
+        // libusb transport serving their fastboot devices.
+        std::shared_ptr<USBTransport> m_transport;
+        std::shared_ptr<USBTransport> m_fastbootTransport;
+
+        std::atomic<bool> m_completed{false};
+        std::atomic<bool> m_failureReported{false};
+        // Without -c the job completes once every simulated board has.
+        std::atomic<unsigned> m_simulatedCompletions{0};
+
+        // Guarded by the manager's m_devicesMutex.
+        std::vector<std::shared_ptr<AstraDevice>> m_devices;
+
+        // Device threads still running for this job.
+        std::mutex m_threadMutex;
+        std::condition_variable m_threadCV;
+        unsigned m_activeThreads = 0;
+
+        // Fastboot devices are always bulk USB, whatever the job's transport.
+        bool ExpectsDevice(AstraTransportType transportType, uint16_t vendorId, uint16_t productId) const
+        {
+            if (transportType == ASTRA_TRANSPORT_USB && m_fastbootVid != 0 && m_fastbootPid != 0 &&
+                vendorId == m_fastbootVid && productId == m_fastbootPid)
+            {
+                return true;
+            }
+            return transportType == m_transportType &&
+                std::find(m_chipIds.begin(), m_chipIds.end(), USBVendorProductId{vendorId, productId}) != m_chipIds.end();
+        }
+    };
+
+    // The devices and ports a transport was initialized or reconfigured for.
+    struct TransportFilter
+    {
+        std::vector<USBVendorProductId> m_deviceIds;
+        std::vector<std::string> m_ports;  // empty for every port
+
+        bool operator==(const TransportFilter &other) const
+        {
+            return m_deviceIds == other.m_deviceIds && m_ports == other.m_ports;
+        }
+
+        // Widen to also cover other.
+        void Merge(const TransportFilter &other)
+        {
+            for (const auto &id : other.m_deviceIds) {
+                if (std::find(m_deviceIds.begin(), m_deviceIds.end(), id) == m_deviceIds.end()) {
+                    m_deviceIds.push_back(id);
+                }
+            }
+            if (m_ports.empty() || other.m_ports.empty()) {
+                m_ports.clear();
+                return;
+            }
+            for (const auto &port : other.m_ports) {
+                if (std::find(m_ports.begin(), m_ports.end(), port) == m_ports.end()) {
+                    m_ports.push_back(port);
+                }
+            }
+        }
+
+        std::string PortString() const
+        {
+            std::string ports;
+            for (const auto &port : m_ports) {
+                ports += (ports.empty() ? "" : ",") + port;
+            }
+            return ports;
+        }
+    };
+
+    // A transport and what it was initialized or reconfigured for.
+    struct TransportEntry
+    {
+        std::shared_ptr<USBTransport> m_transport;
+        TransportFilter m_filter;
+    };
+
+    // Held devices keep handles into the transport's context.
+    struct HeldDevice
+    {
+        AstraTransportType m_transportType;
+        std::unique_ptr<USBDevice> m_device;
+    };
+
     std::function<void(AstraDeviceManagerResponse)> m_responseCallback;
-    std::shared_ptr<AstraBootImage> m_bootImage;
-    std::shared_ptr<FlashImage> m_flashImage;
-    std::string m_bootCommand;
+    // Runs the response callbacks off the device threads and coalesces progress.
+    std::shared_ptr<ResponseDispatcher> m_responseDispatcher =
+        std::make_shared<ResponseDispatcher>(ResponseDispatcher::kDefaultProgressInterval);
+    // Shared by every device so each image file is mapped once per process.
+    std::shared_ptr<ImageStore> m_imageStore = std::make_shared<ImageStore>();
+    // Shared by every device when broadcasting is enabled, otherwise null.
+    std::shared_ptr<ImageBroadcast> m_imageBroadcast;
+    std::shared_ptr<BootPacketCache> m_bootPacketCache = std::make_shared<BootPacketCache>();
+    std::shared_ptr<ResponseTimes> m_responseTimes = std::make_shared<ResponseTimes>();
+    // The session UUIDs devices wrote into uEnv.txt, by the job they booted for.
+    std::shared_ptr<BootSessions> m_bootSessions = std::make_shared<BootSessions>();
+    std::chrono::seconds m_imageRequestTimeout{AstraDevice::kDefaultImageRequestTimeout};
+    // Delivers the USB events of every device, one thread per core.
+    std::shared_ptr<EventExecutor> m_eventExecutor = std::make_shared<EventExecutor>();
     std::string m_tempDir;
-    AstraDeviceManangerMode m_managerMode;
     bool m_removeTempOnClose = false;
     bool m_runContinuously = false;
     bool m_deviceFound = false;
     bool m_usbDebug = false;
-    AstraTransportType m_transportType = ASTRA_TRANSPORT_USB;
-    AstraDeviceSeries m_deviceSeries = ASTRA_SERIES_SL16XX;
-    AstraDeviceBootStage m_bootStage = ASTRA_DEVICE_BOOT_STAGE_AUTO;
+    // Runs AstraDeviceThread for each device and throttles update transfers.
+    std::shared_ptr<DeviceScheduler> m_deviceScheduler;
+    // Shared by every device when transfer tuning is enabled, otherwise null.
+    std::shared_ptr<TransferTuner> m_transferTuner;
+    // Shared by every device when resuming is enabled, otherwise null.
+    std::shared_ptr<UpdateCheckpoints> m_updateCheckpoints;
+    // Fed from ResponseCallback() when the metrics endpoint is enabled, otherwise null.
+    // The server renders from the scheduler, so it is declared after it and stopped first.
+    std::shared_ptr<StationMetrics> m_stationMetrics;
+    std::unique_ptr<MetricsServer> m_metricsServer;
+    static constexpr std::chrono::seconds kDeviceThreadJoinTimeout{10};
     bool m_failureReported = false;
     std::string m_modifiedLogPath;
+    std::string m_traceFile;
+    std::string m_profileFile;
+    // Ports for the jobs started by Update() and Boot().
     std::string m_filterPorts;
-    std::atomic<bool> m_completed{false};
 
-    // VID:PID of the fastboot USB device (set in Init(), used in DeviceAddedCallback).
-    uint16_t m_fastbootVid = 0;
-    uint16_t m_fastbootPid = 0;
+    // Simulated boards replace the USB bus when m_deviceCount is non-zero.
+    AstraSimulatorConfig m_simulatorConfig;
+
+    // The boot image collection last loaded, kept for the following jobs.
+    std::unique_ptr<BootImageCollection> m_bootImageCollection;
+    std::string m_bootImageCollectionPath;
+    std::filesystem::file_time_type m_bootImageCollectionTime{};
 
-    std::vector<std::shared_ptr<AstraDevice>> m_devices;
+    // One transport per type, shared by the jobs.  A job alone asking for
+    // the same transports keeps them instead of paying for libusb and udev
+    // setup again; a job joining others widens them.  The libusb transport
+    // also serves the fastboot devices of USB CDC jobs.  Entries change under
+    // m_jobControlMutex and m_devicesMutex.
+    std::map<AstraTransportType, TransportEntry> m_transports;
+
+    // Serializes adding and ending jobs, which may reinitialize the transports.
+    std::mutex m_jobControlMutex;
+    int m_nextJobId = 1;
+
+    // Guards m_jobs, each job's m_devices and m_heldDevices.
     std::mutex m_devicesMutex;
+    std::map<int, std::shared_ptr<Job>> m_jobs;
+
+    // Arrivals no job wants yet are held, newest per USB path, and offered
+    // to each job that is added.
+    std::map<std::string, HeldDevice> m_heldDevices;
 
     // Registry mapping fastboot UUID serials → waiting AstraDevice impls.
     // Guarded by m_devicesMutex.  Values are weak_ptr to avoid extending lifetime.
     std::unordered_map<std::string, std::weak_ptr<AstraDevice>> m_fastbootDeviceBySerial;
+    // The port each registered board left from and will come back on, with
+    // its serial.  Guarded by m_devicesMutex.
+    std::unordered_map<std::string, std::string> m_expectedRebindSerialByPath;
+
+    // What a board booted for job runs: its boot image, boot command and
+    // flash image, hashed into one token for BootSessions.
+    static std::string BootSessionJob(const Job &job)
+    {
+        std::string identity = job.m_bootImage ? job.m_bootImage->GetID() : "";
+        identity += "\n" + job.m_bootCommand + "\n";
+        identity += job.m_flashImage ? job.m_flashImage->GetImagePath() : "";
+
+        Sha256 sha256;
+        sha256.Update(reinterpret_cast<const uint8_t *>(identity.data()), identity.size());
+        return sha256.FinalHex();
+    }
 
     void RegisterFastbootSerial(const std::string &uuid, std::weak_ptr<AstraDevice> device)
     {
         ASTRA_LOG;
+        std::string usbPath;
+        if (auto astraDevice = device.lock()) {
+            usbPath = astraDevice->GetUSBPath();
+        }
         std::lock_guard<std::mutex> lock(m_devicesMutex);
         m_fastbootDeviceBySerial[uuid] = std::move(device);
-        log(ASTRA_LOG_LEVEL_DEBUG) << "Registered fastboot serial " << uuid << endLog;
+        if (!usbPath.empty()) {
+            m_expectedRebindSerialByPath[usbPath] = uuid;
+        }
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Registered fastboot serial " << uuid << " on " << usbPath << endLog;
     }
 
     void UnregisterFastbootSerial(const std::string &uuid)
@@ -239,9 +592,166 @@ private:
         ASTRA_LOG;
         std::lock_guard<std::mutex> lock(m_devicesMutex);
         m_fastbootDeviceBySerial.erase(uuid);
+        for (auto it = m_expectedRebindSerialByPath.begin(); it != m_expectedRebindSerialByPath.end();) {
+            it = it->second == uuid ? m_expectedRebindSerialByPath.erase(it) : std::next(it);
+        }
         log(ASTRA_LOG_LEVEL_DEBUG) << "Unregistered fastboot serial " << uuid << endLog;
     }
 
+    // The impl waiting for the fastboot device with this serial, if any.
+    std::shared_ptr<AstraDevice> FindFastbootDevice(const std::string &serial)
+    {
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        auto it = m_fastbootDeviceBySerial.find(serial);
+        if (it == m_fastbootDeviceBySerial.end()) {
+            return nullptr;
+        }
+        std::shared_ptr<AstraDevice> existing = it->second.lock();
+        if (!existing) {
+            // Weak pointer expired; prune the stale entry.
+            m_fastbootDeviceBySerial.erase(it);
+        }
+        return existing;
+    }
+
+    // Close the devices of every job and drop the jobs.
+    void CloseDevices()
+    {
+        // Snapshot and clear under the lock, then Close() outside it; see EndJob().
+        std::vector<std::shared_ptr<AstraDevice>> devicesToClose;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            for (auto &[jobId, job] : m_jobs) {
+                std::move(job->m_devices.begin(), job->m_devices.end(), std::back_inserter(devicesToClose));
+                job->m_devices.clear();
+            }
+            m_jobs.clear();
+        }
+        for (auto& device : devicesToClose) {
+            device->Close();
+        }
+    }
+
+    // Session output goes next to the log; keep the temp dir if that is where it lands.
+    std::string SessionOutputPath(const std::string &fileName)
+    {
+        std::filesystem::path dir = m_tempDir;
+        if (m_modifiedLogPath != "stdout") {
+            dir = std::filesystem::path(m_modifiedLogPath).parent_path();
+        }
+        if (dir.empty()) {
+            dir = ".";
+        }
+        if (dir == std::filesystem::path(m_tempDir)) {
+            m_removeTempOnClose = false;
+        }
+        return (dir / fileName).string();
+    }
+
+    void ShutdownTransports()
+    {
+        std::map<AstraTransportType, TransportEntry> transports;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            m_heldDevices.clear();
+            transports = std::move(m_transports);
+            m_transports.clear();
+        }
+
+        for (auto &[transportType, entry] : transports) {
+            entry.m_transport->Shutdown();
+        }
+    }
+
+    const BootImageCollection &LoadBootImageCollection(const std::string &bootImagesPath)
+    {
+        ASTRA_LOG;
+
+        // Adding or removing a boot image changes the directory's modification time.
+        std::error_code ec;
+        const auto writeTime = std::filesystem::last_write_time(bootImagesPath, ec);
+        if (m_bootImageCollection && !ec && m_bootImageCollectionPath == bootImagesPath &&
+            m_bootImageCollectionTime == writeTime)
+        {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Reusing boot image collection " << bootImagesPath << endLog;
+            return *m_bootImageCollection;
+        }
+
+        m_bootImageCollection.reset();
+        auto bootImageCollection = std::make_unique<BootImageCollection>(bootImagesPath);
+        bootImageCollection->Load();
+
+        m_bootImageCollection = std::move(bootImageCollection);
+        m_bootImageCollectionPath = bootImagesPath;
+        m_bootImageCollectionTime = ec ? std::filesystem::file_time_type{} : writeTime;
+        return *m_bootImageCollection;
+    }
+
+    static std::shared_ptr<AstraBootImage> SelectBootImage(const FlashImage &flashImage,
+        const BootImageCollection &bootImageCollection)
+    {
+        ASTRA_LOG;
+
+        std::shared_ptr<AstraBootImage> selectedBootImage;
+
+        const bool requiresNandBootSupport =
+            flashImage.GetFlashImageType() == FLASH_IMAGE_TYPE_NAND;
+
+        if (flashImage.GetBootImageId().empty()) {
+            // No boot images specified.
+            // Try to find the best boot image based on other properties
+            if (flashImage.GetChipName().empty()) {
+                throw std::runtime_error("Chip name and boot bootImage ID missing!");
+            }
+
+            std::vector<std::shared_ptr<AstraBootImage>> bootImages = bootImageCollection.GetBootImagesForChip(flashImage.GetChipName(),
+            flashImage.GetSecureBootVersion(), flashImage.GetMemoryLayout(), flashImage.GetMemoryDDRType(), flashImage.GetBoardName());
+            if (requiresNandBootSupport) {
+                bootImages.erase(std::remove_if(bootImages.begin(), bootImages.end(),
+                    [](const std::shared_ptr<AstraBootImage> &bootImage) {
+                        return !bootImage->GetNandSupport();
+                    }),
+                    bootImages.end());
+            }
+            if (bootImages.size() == 0) {
+                if (requiresNandBootSupport) {
+                    throw std::runtime_error("No NAND-capable boot image found for chip: " + flashImage.GetChipName());
+                }
+                throw std::runtime_error("No boot image found for chip: " + flashImage.GetChipName());
+            } else if (bootImages.size() > 1) {
+                selectedBootImage = bootImages[0];
+                for (const auto& bootImage : bootImages) {
+                    log(ASTRA_LOG_LEVEL_INFO) << "Boot Image: " << bootImage->GetChipName() << " " << bootImage->GetBoardName() << endLog;
+                    if (bootImage->GetUbootVariant() == ASTRA_UBOOT_VARIANT_SYNAPTICS && bootImage->GetUEnvSupport()) {
+                        // Boot bootImages with Synaptics u-boot variant is preferred
+                        selectedBootImage = bootImage;
+                        break;
+                    } else if (bootImage->GetUEnvSupport()) {
+                        // Boot bootImages with uEnv support is preferred
+                        selectedBootImage = bootImage;
+                    } else if (!selectedBootImage->GetUEnvSupport() && bootImage->GetUbootConsole() == ASTRA_UBOOT_CONSOLE_USB) {
+                        // Boot bootImages with USB console is preferred over UART
+                        // But only if there is no uEnv support
+                        selectedBootImage = bootImage;
+                    }
+                }
+            } else {
+                // Try the only option
+                selectedBootImage = bootImages[0];
+            }
+        } else {
+            // Exact boot bootImages specified
+            selectedBootImage = std::make_shared<AstraBootImage>(bootImageCollection.GetBootImage(flashImage.GetBootImageId()));
+            if (requiresNandBootSupport && !selectedBootImage->GetNandSupport()) {
+                throw std::runtime_error("Selected boot image does not support NAND flash updates");
+            }
+        }
+
+        log(ASTRA_LOG_LEVEL_INFO) << "Selected boot image: " << selectedBootImage->GetChipName() << " " << selectedBootImage->GetBoardName() << " (" << selectedBootImage->GetID() << ")" << endLog;
+
+        return selectedBootImage;
+    }
+
     static AstraDeviceSeries DetectDeviceSeries(const std::string &chipName)
     {
         std::string chipNameLower = chipName;
@@ -257,114 +767,249 @@ private:
         return ASTRA_SERIES_SL16XX;
     }
 
-    void Init()
+    // Describe the job, set up the transports for it and start routing
+    // devices to it.  Called with m_jobControlMutex held.  @return its ID.
+    int AddJob(std::shared_ptr<Job> job)
     {
         ASTRA_LOG;
 
-        if (m_bootImage == nullptr) {
+        const std::shared_ptr<AstraBootImage> &bootImage = job->m_bootImage;
+        if (bootImage == nullptr) {
             throw std::runtime_error("Boot image not found");
         }
 
-        std::string bootImageDescription = "Boot Image: " + m_bootImage->GetChipName() + " " + m_bootImage->GetBoardName() + " (" + m_bootImage->GetID() + ")\n";
-        bootImageDescription += "    Secure Boot: " + AstraSecureBootVersionToString(m_bootImage->GetSecureBootVersion()) + "\n";
-        bootImageDescription += "    Memory Layout: " + AstraMemoryLayoutToString(m_bootImage->GetMemoryLayout()) + "\n";
-        bootImageDescription += "    Memory DDR Type: " + AstraMemoryDDRTypeToString(m_bootImage->GetMemoryDDRType()) + "\n";
+        std::string bootImageDescription = "Boot Image: " + bootImage->GetChipName() + " " + bootImage->GetBoardName() + " (" + bootImage->GetID() + ")\n";
+        bootImageDescription += "    Secure Boot: " + AstraSecureBootVersionToString(bootImage->GetSecureBootVersion()) + "\n";
+        bootImageDescription += "    Memory Layout: " + AstraMemoryLayoutToString(bootImage->GetMemoryLayout()) + "\n";
+        bootImageDescription += "    Memory DDR Type: " + AstraMemoryDDRTypeToString(bootImage->GetMemoryDDRType()) + "\n";
+
+        job->m_deviceSeries = DetectDeviceSeries(bootImage->GetChipName());
+
+        bootImageDescription += "    Device Series: " + AstraDevice::AstraDeviceSeriesToString(job->m_deviceSeries) + "\n";
+        bootImageDescription += "    Transport Type: " + AstraTransportToString(bootImage->GetTransportType()) + "\n";
+        bootImageDescription += "    U-Boot Console: " + std::string(bootImage->GetUbootConsole() == ASTRA_UBOOT_CONSOLE_UART ? "UART" : "USB") + "\n";
+        bootImageDescription += "    uEnv.txt Support: " + std::string(bootImage->GetUEnvSupport() ? "enabled" : "disabled") + "\n";
+        bootImageDescription += "    NAND Support: " + std::string(bootImage->GetNandSupport() ? "enabled" : "disabled") + "\n";
+        bootImageDescription += "    U-Boot Variant: " + std::string(bootImage->GetUbootVariant() == ASTRA_UBOOT_VARIANT_UBOOT ? "U-Boot" : "Synaptics U-Boot");
+        ResponseCallback(*job, {ManagerResponse{ASTRA_DEVICE_MANAGER_STATUS_INFO, bootImageDescription}});
+
+        job->m_chipIds = bootImage->GetVendorProductIdPairs();
+        job->m_ports = USBTransport::ParseFilterPortString(job->m_filterPorts);
+        job->m_fastbootVid = bootImage->GetFastbootVendorId();
+        job->m_fastbootPid = bootImage->GetFastbootProductId();
+        const uint16_t fbVid = job->m_fastbootVid;
+        const uint16_t fbPid = job->m_fastbootPid;
+
+        job->m_transportType = bootImage->GetTransportType();
+        const bool simulated = m_simulatorConfig.m_deviceCount > 0;
+        if (simulated) {
+            // Simulated boards enumerate in every mode on one transport.
+            job->m_transportType = ASTRA_TRANSPORT_USB;
+        }
 
-        m_deviceSeries = DetectDeviceSeries(m_bootImage->GetChipName());
+        // What the job needs from each transport.
+        std::map<AstraTransportType, TransportFilter> filters;
+        TransportFilter &filter = filters[job->m_transportType];
+        filter = TransportFilter{job->m_chipIds, job->m_ports};
 
-        bootImageDescription += "    Device Series: " + AstraDevice::AstraDeviceSeriesToString(m_deviceSeries) + "\n";
-        bootImageDescription += "    Transport Type: " + AstraTransportToString(m_bootImage->GetTransportType()) + "\n";
-        bootImageDescription += "    U-Boot Console: " + std::string(m_bootImage->GetUbootConsole() == ASTRA_UBOOT_CONSOLE_UART ? "UART" : "USB") + "\n";
-        bootImageDescription += "    uEnv.txt Support: " + std::string(m_bootImage->GetUEnvSupport() ? "enabled" : "disabled") + "\n";
-        bootImageDescription += "    NAND Support: " + std::string(m_bootImage->GetNandSupport() ? "enabled" : "disabled") + "\n";
-        bootImageDescription += "    U-Boot Variant: " + std::string(m_bootImage->GetUbootVariant() == ASTRA_UBOOT_VARIANT_UBOOT ? "U-Boot" : "Synaptics U-Boot");
-        ResponseCallback({ManagerResponse{ASTRA_DEVICE_MANAGER_STATUS_INFO, bootImageDescription}});
+        // When the primary transport is libusb, the fastboot VID/PID can share it.
+        // When the primary is CDC, the libusb transport is used for them instead.
+        if (fbVid != 0 && fbPid != 0) {
+            if (job->m_transportType != ASTRA_TRANSPORT_USB_CDC) {
+                filter.m_deviceIds.push_back({fbVid, fbPid});
+                log(ASTRA_LOG_LEVEL_INFO) << "Including fastboot VID:0x"
+                    << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbVid
+                    << " PID:0x" << std::setw(4) << std::setfill('0') << fbPid << std::dec
+                    << " in primary transport" << endLog;
+            } else {
+                filters[ASTRA_TRANSPORT_USB] = TransportFilter{{{fbVid, fbPid}}, job->m_ports};
+            }
+        }
 
-        std::vector<USBVendorProductId> vendorProductIds = m_bootImage->GetVendorProductIdPairs();
+        log(ASTRA_LOG_LEVEL_INFO) << "Using device series implementation: " << AstraDevice::AstraDeviceSeriesToString(job->m_deviceSeries) << endLog;
 
-        const uint16_t fbVid = m_bootImage->GetFastbootVendorId();
-        const uint16_t fbPid = m_bootImage->GetFastbootProductId();
+        bool otherJobs = false;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            for (const auto &[otherId, other] : m_jobs) {
+                otherJobs = true;
+                const bool sameChipIds = std::any_of(job->m_chipIds.begin(), job->m_chipIds.end(),
+                    [&other](const USBVendorProductId &id) {
+                        return std::find(other->m_chipIds.begin(), other->m_chipIds.end(), id) != other->m_chipIds.end();
+                    });
+                // USB CDC ports are named after their tty, so only separate
+                // port lists keep a libusb job off a CDC job's devices.
+                const bool sharedPorts = SamePorts(other->m_ports, job->m_ports) ||
+                    (other->m_transportType != job->m_transportType && (other->m_ports.empty() || job->m_ports.empty()));
+                if (sameChipIds && sharedPorts) {
+                    throw std::runtime_error("Job " + std::to_string(otherId) +
+                        " already serves devices with the same VID:PID on these ports");
+                }
+            }
+        }
 
-        m_fastbootVid = fbVid;
-        m_fastbootPid = fbPid;
+        if (!otherJobs) {
+            // The simulator scripts its boards for one job, so it never carries over.
+            bool reuseTransport = !simulated && m_transports.size() == filters.size();
+            for (const auto &[transportType, transportFilter] : filters) {
+                auto it = m_transports.find(transportType);
+                reuseTransport = reuseTransport && it != m_transports.end() && it->second.m_filter == transportFilter;
+            }
+            if (reuseTransport) {
+                log(ASTRA_LOG_LEVEL_INFO) << "Reusing USB transport from the previous run" << endLog;
+            } else {
+                ShutdownTransports();
+            }
+        } else if (simulated) {
+            throw std::runtime_error("The simulator serves one job at a time");
+        }
 
-        m_transportType = m_bootImage->GetTransportType();
+        for (const auto &[transportType, transportFilter] : filters) {
+            const bool primary = transportType == job->m_transportType;
+            if (!StartOrExtendTransport(transportType, transportFilter, *job, simulated)) {
+                if (primary) {
+                    throw std::runtime_error("Failed to initialize USB transport");
+                }
+                log(ASTRA_LOG_LEVEL_WARNING) << "Failed to initialize fastboot transport" << endLog;
+            }
+        }
 
-        // When the primary transport is libusb, the fastboot VID/PID can share it.
-        // When the primary is CDC, a separate libusb transport is created below instead.
-        if (fbVid != 0 && fbPid != 0 && m_transportType != ASTRA_TRANSPORT_USB_CDC) {
-            vendorProductIds.push_back({fbVid, fbPid});
-            log(ASTRA_LOG_LEVEL_INFO) << "Including fastboot VID:0x"
-                << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbVid
-                << " PID:0x" << std::setw(4) << std::setfill('0') << fbPid << std::dec
-                << " in primary transport" << endLog;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            job->m_transport = m_transports.at(job->m_transportType).m_transport;
+            if (job->m_transportType == ASTRA_TRANSPORT_USB_CDC && filters.count(ASTRA_TRANSPORT_USB) &&
+                m_transports.count(ASTRA_TRANSPORT_USB))
+            {
+                job->m_fastbootTransport = m_transports.at(ASTRA_TRANSPORT_USB).m_transport;
+            }
         }
 
-#if PLATFORM_WINDOWS
-        if (m_transportType == ASTRA_TRANSPORT_USB_CDC) {
-            m_transport = std::make_shared<WinUSBCDCTransport>(m_usbDebug);
-        } else {
-            m_transport = std::make_shared<WinLibUSBTransport>(m_usbDebug);
+        std::ostringstream os;
+        os << "Waiting for Astra Device(s):";
+        for (const auto& [vid, pid] : filter.m_deviceIds) {
+            os << " (" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << vid
+               << ":" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << pid << ")";
         }
-#else
-        if (m_transportType == ASTRA_TRANSPORT_USB_CDC) {
-            m_transport = std::make_shared<PosixUSBCDCTransport>(m_usbDebug);
-        } else {
-            m_transport = std::make_shared<LibUSBTransport>(m_usbDebug);
+        if (job->m_fastbootTransport) {
+            os << " (" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbVid
+               << ":" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbPid << ")";
         }
-#endif
-
-        log(ASTRA_LOG_LEVEL_INFO) << "Using USB transport: "
-            << (m_transportType == ASTRA_TRANSPORT_USB_CDC ? "cdc" : "usb") << endLog;
-        log(ASTRA_LOG_LEVEL_INFO) << "Using device series implementation: " << AstraDevice::AstraDeviceSeriesToString(m_deviceSeries) << endLog;
+        if (!job->m_filterPorts.empty()) {
+            os << " on " << job->m_filterPorts;
+        }
+        ResponseCallback(*job, {ManagerResponse{ASTRA_DEVICE_MANAGER_STATUS_START, os.str()}});
 
-        if (m_transport->Init(vendorProductIds, m_filterPorts,
-                std::bind(&AstraDeviceManagerImpl::DeviceAddedCallback, this, std::placeholders::_1)) < 0)
+        std::map<std::string, HeldDevice> heldDevices;
         {
-            throw std::runtime_error("Failed to initialize USB transport");
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            job->m_id = m_nextJobId++;
+            m_jobs[job->m_id] = job;
+            heldDevices = std::move(m_heldDevices);
+            m_heldDevices.clear();
         }
+        log(ASTRA_LOG_LEVEL_INFO) << "Started job " << job->m_id << endLog;
 
-        log(ASTRA_LOG_LEVEL_DEBUG) << "USB transport initialized successfully" << endLog;
+        // Devices the new job does not want are held again.
+        for (auto &[usbPath, heldDevice] : heldDevices) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Offering held device " << usbPath << " to the jobs" << endLog;
+            DeviceAddedCallback(heldDevice.m_transportType, std::move(heldDevice.m_device));
+        }
+
+        return job->m_id;
+    }
+
+    static bool SamePorts(std::vector<std::string> ports, std::vector<std::string> otherPorts)
+    {
+        std::sort(ports.begin(), ports.end());
+        std::sort(otherPorts.begin(), otherPorts.end());
+        return ports == otherPorts;
+    }
+
+    std::shared_ptr<USBTransport> CreateTransport(AstraTransportType transportType, const Job &job, bool simulated)
+    {
+        if (simulated) {
+            return std::make_shared<SimulatedUSBTransport>(m_usbDebug, m_simulatorConfig,
+                SimulatedUSBTransport::BuildScript(*job.m_bootImage,
+                    job.m_managerMode == ASTRA_DEVICE_MANAGER_MODE_UPDATE ? job.m_flashImage : nullptr,
+                    job.m_deviceSeries, job.m_bootCommand));
+        }
 
-        // When the primary is CDC, fastboot devices are bulk USB and need a separate libusb transport.
-        if (fbVid != 0 && fbPid != 0 && m_transportType == ASTRA_TRANSPORT_USB_CDC) {
 #if PLATFORM_WINDOWS
-            m_fastbootTransport = std::make_shared<WinLibUSBTransport>(m_usbDebug);
+        if (transportType == ASTRA_TRANSPORT_USB_CDC) {
+            return std::make_shared<WinUSBCDCTransport>(m_usbDebug);
+        }
+        return std::make_shared<WinLibUSBTransport>(m_usbDebug);
 #else
-            m_fastbootTransport = std::make_shared<LibUSBTransport>(m_usbDebug);
+        if (transportType == ASTRA_TRANSPORT_USB_CDC) {
+            return std::make_shared<PosixUSBCDCTransport>(m_usbDebug);
+        }
+        return std::make_shared<LibUSBTransport>(m_usbDebug);
 #endif
-            log(ASTRA_LOG_LEVEL_INFO) << "Creating secondary libusb transport for fastboot VID:0x"
-                << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbVid
-                << " PID:0x" << std::setw(4) << std::setfill('0') << fbPid << std::dec << endLog;
+    }
 
-            if (m_fastbootTransport->Init({{fbVid, fbPid}}, m_filterPorts,
-                    std::bind(&AstraDeviceManagerImpl::DeviceAddedCallback, this, std::placeholders::_1)) < 0)
-            {
-                log(ASTRA_LOG_LEVEL_WARNING) << "Failed to initialize fastboot transport" << endLog;
-                m_fastbootTransport.reset();
+    // Start the transport of transportType for filter, or widen the running
+    // one to also cover it.  Called with m_jobControlMutex held.
+    // @return false if the transport could not be started.
+    bool StartOrExtendTransport(AstraTransportType transportType, const TransportFilter &filter, const Job &job, bool simulated)
+    {
+        ASTRA_LOG;
+
+        auto it = m_transports.find(transportType);
+        if (it != m_transports.end()) {
+            TransportFilter merged = it->second.m_filter;
+            merged.Merge(filter);
+            if (merged == it->second.m_filter) {
+                return true;
             }
+
+            log(ASTRA_LOG_LEVEL_INFO) << "Reconfiguring " << AstraTransportToString(transportType) << " transport for ports: "
+                << (merged.m_ports.empty() ? "all" : merged.PortString()) << endLog;
+            if (it->second.m_transport->Reconfigure(merged.m_deviceIds, merged.PortString()) < 0) {
+                throw std::runtime_error("USB transport cannot add devices or ports while other jobs are running");
+            }
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            it->second.m_filter = merged;
+            return true;
         }
 
-        std::ostringstream os;
-        os << "Waiting for Astra Device(s):";
-        for (const auto& [vid, pid] : vendorProductIds) {
-            os << " (" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << vid
-               << ":" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << pid << ")";
+        std::shared_ptr<USBTransport> transport = CreateTransport(transportType, job, simulated);
+        if (transportType != job.m_transportType) {
+            const auto [fbVid, fbPid] = filter.m_deviceIds.front();
+            log(ASTRA_LOG_LEVEL_INFO) << "Creating secondary libusb transport for fastboot VID:0x"
+                << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbVid
+                << " PID:0x" << std::setw(4) << std::setfill('0') << fbPid << std::dec << endLog;
+        } else {
+            log(ASTRA_LOG_LEVEL_INFO) << "Using USB transport: "
+                << (simulated ? "simulated" : transportType == ASTRA_TRANSPORT_USB_CDC ? "cdc" : "usb") << endLog;
         }
-        if (m_fastbootTransport) {
-            os << " (" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbVid
-               << ":" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << fbPid << ")";
+
+        if (transport->Init(filter.m_deviceIds, filter.PortString(),
+                std::bind(&AstraDeviceManagerImpl::DeviceAddedCallback, this, transportType, std::placeholders::_1)) < 0)
+        {
+            transport->Shutdown();
+            return false;
         }
-        ResponseCallback({ManagerResponse{ASTRA_DEVICE_MANAGER_STATUS_START, os.str()}});
+
+        log(ASTRA_LOG_LEVEL_DEBUG) << "USB transport initialized successfully" << endLog;
+
+        std::lock_guard<std::mutex> lock(m_devicesMutex);
+        m_transports[transportType] = TransportEntry{transport, filter};
+        return true;
     }
 
-    void ResponseCallback(AstraDeviceManagerResponse response)
+    std::function<void(AstraDeviceManagerResponse)> JobResponseCallback(const Job &job) const
+    {
+        return job.m_responseCallback ? job.m_responseCallback : m_responseCallback;
+    }
+
+    void ResponseCallback(Job &job, AstraDeviceManagerResponse response)
     {
         // If a failure is reported then retain the temp directory containing logs
         if (response.IsDeviceManagerResponse()) {
             if (response.GetDeviceManagerResponse().m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_FAILURE) {
                 m_removeTempOnClose = false;
                 m_failureReported = true;
+                job.m_failureReported.store(true);
             }
         } else if (response.IsDeviceResponse()) {
             if (response.GetDeviceResponse().m_status == ASTRA_DEVICE_STATUS_BOOT_FAIL ||
@@ -372,42 +1017,97 @@ private:
             {
                 m_removeTempOnClose = false;
                 m_failureReported = true;
+                job.m_failureReported.store(true);
+            }
+        }
+        if (m_stationMetrics) {
+            m_stationMetrics->Observe(response, job.m_managerMode == ASTRA_DEVICE_MANAGER_MODE_BOOT);
+        }
+        m_responseDispatcher->Post(JobResponseCallback(job), std::move(response));
+    }
+
+    // Port match of usbPath for job: 0 if the job takes every port, else 1 +
+    // the length of the longest of its ports that usbPath is on, so the most
+    // specific job wins.  -1 if usbPath is on none of them.
+    static int PortMatchScore(const Job &job, const USBTransport &transport, const std::string &usbPath)
+    {
+        if (job.m_ports.empty()) {
+            return 0;
+        }
+
+        int score = -1;
+        for (const auto &port : job.m_ports) {
+            if (transport.IsPortInFilter(usbPath, {port})) {
+                score = std::max(score, 1 + static_cast<int>(port.size()));
+            }
+        }
+        return score;
+    }
+
+    // Called with m_devicesMutex held.  @return nullptr if no job wants device.
+    std::shared_ptr<Job> FindJobLocked(AstraTransportType transportType, USBDevice &device) const
+    {
+        auto transport = m_transports.find(transportType);
+        if (transport == m_transports.end()) {
+            return nullptr;
+        }
+
+        std::shared_ptr<Job> bestJob;
+        int bestScore = -1;
+        for (const auto &[jobId, job] : m_jobs) {
+            if (!job->ExpectsDevice(transportType, device.GetVendorId(), device.GetProductId())) {
+                continue;
+            }
+            const int score = PortMatchScore(*job, *transport->second.m_transport, device.GetUSBPath());
+            if (score > bestScore) {
+                bestJob = job;
+                bestScore = score;
             }
         }
-        m_responseCallback(response);
+        return bestJob;
     }
 
-    void AstraDeviceThread(std::shared_ptr<AstraDevice> astraDevice)
+    void AstraDeviceThread(std::shared_ptr<AstraDevice> astraDevice, std::shared_ptr<Job> job)
     {
         ASTRA_LOG;
 
         log(ASTRA_LOG_LEVEL_DEBUG) << "Booting device" << endLog;
 
         if (astraDevice) {
+            const std::shared_ptr<USBTransport> transport = job->m_transport;
+            const std::shared_ptr<USBTransport> fastbootTransport = job->m_fastbootTransport;
+
+            AstraTraceStore::getInstance().SetThreadName("device " + astraDevice->GetUSBPath());
+            AstraTraceSpan sessionSpan("DeviceSession", {{"usb_path", astraDevice->GetUSBPath()}});
+
             // Block device enumeration for entire boot/update process
-            bool enumerationBlocked = m_transport->BlockDeviceEnumeration();
-            if (m_fastbootTransport) { m_fastbootTransport->BlockDeviceEnumeration(); }
+            bool enumerationBlocked = transport->BlockDeviceEnumeration();
+            if (fastbootTransport) { fastbootTransport->BlockDeviceEnumeration(); }
             if (!enumerationBlocked) {
                 log(ASTRA_LOG_LEVEL_ERROR) << "Failed to block device enumeration, aborting device operation" << endLog;
-                m_transport->RemoveActiveDevice(astraDevice->GetUSBPath());
-                if (m_fastbootTransport) { m_fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
-                ResponseCallback({ DeviceResponse{astraDevice->GetDeviceName(), ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, "", "Failed to acquire device enumeration lock"}});
+                transport->RemoveActiveDevice(astraDevice->GetUSBPath());
+                if (fastbootTransport) { fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
+                ResponseCallback(*job, { DeviceResponse{astraDevice->GetDeviceName(), ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, "", "Failed to acquire device enumeration lock"}});
                 return;
             }
 
-            astraDevice->SetStatusCallback(m_responseCallback);
+            astraDevice->SetStatusCallback([dispatcher = m_responseDispatcher, callback = JobResponseCallback(*job)](
+                AstraDeviceManagerResponse response) { dispatcher->Post(callback, std::move(response)); });
 
             log(ASTRA_LOG_LEVEL_DEBUG) << "Calling boot" << endLog;
-            int ret = astraDevice->Boot(m_bootImage, m_bootStage);
+            AstraTraceSpan bootSpan("Boot");
+            int ret = astraDevice->Boot(job->m_bootImage, job->m_bootStage);
+            bootSpan.AddArg("device", astraDevice->GetDeviceName());
+            bootSpan.End();
             if (ret < 0) {
                 log(ASTRA_LOG_LEVEL_ERROR) << "Failed to boot device" << endLog;
-                m_transport->RemoveActiveDevice(astraDevice->GetUSBPath());
-                if (m_fastbootTransport) { m_fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
+                transport->RemoveActiveDevice(astraDevice->GetUSBPath());
+                if (fastbootTransport) { fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
                 if (enumerationBlocked) {
-                    m_transport->UnblockDeviceEnumeration();
-                    if (m_fastbootTransport) { m_fastbootTransport->UnblockDeviceEnumeration(); }
+                    transport->UnblockDeviceEnumeration();
+                    if (fastbootTransport) { fastbootTransport->UnblockDeviceEnumeration(); }
                 }
-                ResponseCallback({ DeviceResponse{astraDevice->GetDeviceName(), ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, "", "Failed to Boot Device"}});
+                ResponseCallback(*job, { DeviceResponse{astraDevice->GetDeviceName(), ASTRA_DEVICE_STATUS_BOOT_FAIL, 0, "", "Failed to Boot Device"}});
                 return;
             }
 
@@ -417,11 +1117,11 @@ private:
                 // re-enumerated device is picked up by DeviceAddedCallback.
                 log(ASTRA_LOG_LEVEL_DEBUG) << "Boot in progress, device will re-enumerate" << endLog;
                 astraDevice->Close();
-                m_transport->RemoveActiveDevice(astraDevice->GetUSBPath());
-                if (m_fastbootTransport) { m_fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
+                transport->RemoveActiveDevice(astraDevice->GetUSBPath());
+                if (fastbootTransport) { fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
                 if (enumerationBlocked) {
-                    m_transport->UnblockDeviceEnumeration();
-                    if (m_fastbootTransport) { m_fastbootTransport->UnblockDeviceEnumeration(); }
+                    transport->UnblockDeviceEnumeration();
+                    if (fastbootTransport) { fastbootTransport->UnblockDeviceEnumeration(); }
                 }
                 return;
             }
@@ -430,39 +1130,43 @@ private:
             // The device will disconnect and reconnect (possibly multiple times) via fb_exit.
             // Release the fastboot transport's active-device entry now so each reconnect
             // passes through ProcessPendingDevices and reaches DeviceAddedCallback / Rebind().
-            if (m_fastbootTransport) {
-                m_fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath());
+            if (fastbootTransport) {
+                fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath());
             }
 
-            if (m_managerMode == ASTRA_DEVICE_MANAGER_MODE_UPDATE) {
+            if (job->m_managerMode == ASTRA_DEVICE_MANAGER_MODE_UPDATE) {
                 log(ASTRA_LOG_LEVEL_DEBUG) << "calling from Update" << endLog;
-                ret = astraDevice->Update(m_flashImage);
+                AstraTraceSpan updateSpan("Update", {{"device", astraDevice->GetDeviceName()}});
+                ret = astraDevice->Update(job->m_flashImage);
+                updateSpan.End();
                 if (ret < 0) {
                     log(ASTRA_LOG_LEVEL_ERROR) << "Failed to update device" << endLog;
-                    m_transport->RemoveActiveDevice(astraDevice->GetUSBPath());
-                    if (m_fastbootTransport) { m_fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
+                    transport->RemoveActiveDevice(astraDevice->GetUSBPath());
+                    if (fastbootTransport) { fastbootTransport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
                     if (enumerationBlocked) {
-                        m_transport->UnblockDeviceEnumeration();
-                        if (m_fastbootTransport) { m_fastbootTransport->UnblockDeviceEnumeration(); }
+                        transport->UnblockDeviceEnumeration();
+                        if (fastbootTransport) { fastbootTransport->UnblockDeviceEnumeration(); }
                     }
                     return;
                 }
             }
 
             log(ASTRA_LOG_LEVEL_DEBUG) << "calling from WaitForCompletion" << endLog;
+            AstraTraceSpan completionSpan("WaitForCompletion", {{"device", astraDevice->GetDeviceName()}});
             ret = astraDevice->WaitForCompletion();
+            completionSpan.End();
             if (ret < 0) {
                 log(ASTRA_LOG_LEVEL_ERROR) << "Failed to wait for completion" << endLog;
                 // Remove from active set first (before Close() which may block),
                 // then close to release the libusb handle, then unblock enumeration
                 // so ProcessPendingDevices can accept a reconnect.
                 const std::string usbPathOnFail = astraDevice->GetUSBPath();
-                m_transport->RemoveActiveDevice(usbPathOnFail);
-                if (m_fastbootTransport) { m_fastbootTransport->RemoveActiveDevice(usbPathOnFail); }
+                transport->RemoveActiveDevice(usbPathOnFail);
+                if (fastbootTransport) { fastbootTransport->RemoveActiveDevice(usbPathOnFail); }
                 astraDevice->Close();
                 if (enumerationBlocked) {
-                    m_transport->UnblockDeviceEnumeration();
-                    if (m_fastbootTransport) { m_fastbootTransport->UnblockDeviceEnumeration(); }
+                    transport->UnblockDeviceEnumeration();
+                    if (fastbootTransport) { fastbootTransport->UnblockDeviceEnumeration(); }
                 }
                 return;
             }
@@ -476,14 +1180,19 @@ private:
             // application cannot destroy the manager (and invalidate 'this') while
             // AstraDeviceThread is still accessing it.
             const bool terminalSuccess =
-                (m_managerMode == ASTRA_DEVICE_MANAGER_MODE_BOOT && status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE) ||
+                (job->m_managerMode == ASTRA_DEVICE_MANAGER_MODE_BOOT && status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE) ||
                 (status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE);
-            const bool shouldNotifyShutdown = terminalSuccess && !m_runContinuously;
+            bool runComplete = terminalSuccess;
+            if (terminalSuccess && m_simulatorConfig.m_deviceCount > 0) {
+                const unsigned expected = m_simulatorConfig.m_deviceCount * std::max(m_simulatorConfig.m_cycles, 1U);
+                runComplete = ++job->m_simulatedCompletions >= expected;
+            }
+            const bool shouldNotifyShutdown = runComplete && !m_runContinuously;
 
-            if (terminalSuccess) {
+            if (runComplete) {
                 // Gate DeviceAddedCallback before Close() can trigger WM_DEVICECHANGE
                 // that would re-discover the still-connected device.
-                m_completed.store(true);
+                job->m_completed.store(true);
             }
 
             // Capture USB path and remove from active set BEFORE Close().
@@ -493,16 +1202,18 @@ private:
             // ProcessPendingDevices can accept the reconnect even if Close() is slow.
             const std::string usbPathForClose = astraDevice->GetUSBPath();
             if (!terminalSuccess || m_runContinuously) {
-                m_transport->RemoveActiveDevice(usbPathForClose);
-                if (m_fastbootTransport) { m_fastbootTransport->RemoveActiveDevice(usbPathForClose); }
+                transport->RemoveActiveDevice(usbPathForClose);
+                if (fastbootTransport) { fastbootTransport->RemoveActiveDevice(usbPathForClose); }
             }
 
             astraDevice->Close();
+            sessionSpan.AddArg("status", AstraDevice::AstraDeviceStatusToString(status));
+            sessionSpan.End();
 
             // Always release the enumeration mutex so ProcessPendingDevices can run.
             if (enumerationBlocked) {
-                m_transport->UnblockDeviceEnumeration();
-                if (m_fastbootTransport) { m_fastbootTransport->UnblockDeviceEnumeration(); }
+                transport->UnblockDeviceEnumeration();
+                if (fastbootTransport) { fastbootTransport->UnblockDeviceEnumeration(); }
             }
 
             // Send SHUTDOWN last — only after all cleanup that touches 'this'.
@@ -510,64 +1221,110 @@ private:
             // inside the callback; doing it last ensures we never access member
             // variables of this object after the callback returns.
             if (shouldNotifyShutdown) {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "Shutting down Astra Device Manager" << endLog;
-                ResponseCallback({ManagerResponse{ASTRA_DEVICE_MANAGER_STATUS_SHUTDOWN, "Astra Device Manager shutting down"}});
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Job " << job->m_id << " complete" << endLog;
+                ResponseCallback(*job, {ManagerResponse{ASTRA_DEVICE_MANAGER_STATUS_SHUTDOWN, "Astra Device Manager shutting down"}});
             }
         }
     }
 
-    void DeviceAddedCallback(std::unique_ptr<USBDevice> device)
+    void DeviceAddedCallback(AstraTransportType transportType, std::unique_ptr<USBDevice> device)
     {
         ASTRA_LOG;
 
-        if (!m_runContinuously && m_completed.load()) {
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Boot/update already completed, ignoring spurious device arrival" << endLog;
-            return;
+        std::shared_ptr<USBTransport> transport;
+        bool fastbootDevice = false;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            auto it = m_transports.find(transportType);
+            if (it != m_transports.end()) {
+                transport = it->second.m_transport;
+            }
+            for (const auto &[jobId, job] : m_jobs) {
+                if (transportType == ASTRA_TRANSPORT_USB && job->m_fastbootVid != 0 && job->m_fastbootPid != 0 &&
+                    device->GetVendorId() == job->m_fastbootVid &&
+                    device->GetProductId() == job->m_fastbootPid)
+                {
+                    fastbootDevice = true;
+                    break;
+                }
+            }
         }
 
-        log(ASTRA_LOG_LEVEL_DEBUG) << "Device added AstraDeviceManagerImpl::DeviceAddedCallback" << endLog;
-
         // If this looks like a fastboot device, probe its serial to see whether
-        // an existing impl is waiting for a rebind (Sessions 3+).
-        if (m_fastbootVid != 0 && m_fastbootPid != 0 &&
-            device->GetVendorId() == m_fastbootVid &&
-            device->GetProductId() == m_fastbootPid)
-        {
+        // an existing impl is waiting for a rebind (Sessions 3+).  The device
+        // stays with the job it was booted by.
+        if (fastbootDevice && transport) {
             std::string serial;
-            if (FastBootDevice::ProbeSerial(device.get(), serial) && !serial.empty()) {
-                std::shared_ptr<AstraDevice> existing;
-                {
-                    std::lock_guard<std::mutex> lock(m_devicesMutex);
-                    auto it = m_fastbootDeviceBySerial.find(serial);
-                    if (it != m_fastbootDeviceBySerial.end()) {
-                        existing = it->second.lock();
-                        if (!existing) {
-                            // Weak pointer expired; prune the stale entry.
-                            m_fastbootDeviceBySerial.erase(it);
-                        }
-                    }
-                }
-                if (existing) {
-                    log(ASTRA_LOG_LEVEL_DEBUG) << "Rebinding fastboot device with serial " << serial << endLog;
-                    // Remove the path BEFORE Rebind() wakes the image loop.
-                    // Rebind() signals m_rebindCV, which immediately unblocks
-                    // WaitForRebind().  The loop can then serve the next image,
-                    // send fb_exit, and the device can reconnect — all before we
-                    // return here.  If the path is still in m_activeDevices at
-                    // that point, ProcessPendingDevices will skip the reconnect
-                    // as a duplicate open and Rebind() for the next session will
-                    // never be called.
-                    std::string rebindPath = device->GetUSBPath();
-                    m_fastbootTransport->RemoveActiveDevice(rebindPath);
-                    existing->Rebind(std::move(device));
-                    return;  // do NOT create a new AstraDevice or spawn a new thread
+            std::shared_ptr<AstraDevice> existing;
+
+            // Fast path: a board re-enumerating after fb_exit comes back on the
+            // port it left, with its UUID as the USB serial number, so the
+            // descriptor read by Open() identifies it without a fastboot
+            // command round trip.
+            std::string expectedSerial;
+            {
+                std::lock_guard<std::mutex> lock(m_devicesMutex);
+                auto it = m_expectedRebindSerialByPath.find(device->GetUSBPath());
+                if (it != m_expectedRebindSerialByPath.end()) {
+                    expectedSerial = it->second;
                 }
             }
+            if (!expectedSerial.empty() &&
+                device->Open([](USBDevice::USBEvent, uint8_t *, size_t) {}) >= 0 &&
+                device->GetSerialNumber() == expectedSerial)
+            {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Fastboot device on " << device->GetUSBPath()
+                    << " carries the expected serial " << expectedSerial << endLog;
+                serial = expectedSerial;
+                existing = FindFastbootDevice(serial);
+            }
+
+            if (!existing && FastBootDevice::ProbeSerial(device.get(), serial) && !serial.empty()) {
+                existing = FindFastbootDevice(serial);
+            }
+
+            if (existing) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Rebinding fastboot device with serial " << serial << endLog;
+                // Remove the path BEFORE Rebind() wakes the image loop.
+                // Rebind() resumes the image request task, which stops
+                // waiting for the rebind.  It can then serve the next image,
+                // send fb_exit, and the device can reconnect — all before we
+                // return here.  If the path is still in m_activeDevices at
+                // that point, ProcessPendingDevices will skip the reconnect
+                // as a duplicate open and Rebind() for the next session will
+                // never be called.
+                std::string rebindPath = device->GetUSBPath();
+                transport->RemoveActiveDevice(rebindPath);
+                AstraTraceSpan rebindSpan("Rebind", {{"device", existing->GetDeviceName()}, {"usb_path", rebindPath}});
+                existing->Rebind(std::move(device));
+                return;  // do NOT create a new AstraDevice or spawn a new thread
+            }
+        }
+
+        std::shared_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(m_devicesMutex);
+            job = FindJobLocked(transportType, *device);
+            if (!job) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "No job for device " << device->GetUSBPath()
+                    << ", holding it for the next one" << endLog;
+                const std::string usbPath = device->GetUSBPath();
+                m_heldDevices[usbPath] = HeldDevice{transportType, std::move(device)};
+                return;
+            }
         }
 
+        if (!m_runContinuously && job->m_completed.load()) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Boot/update already completed, ignoring spurious device arrival" << endLog;
+            return;
+        }
+
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Device added AstraDeviceManagerImpl::DeviceAddedCallback for job " << job->m_id << endLog;
+        AstraTraceStore::getInstance().AddInstant("DeviceAdded", {{"usb_path", device->GetUSBPath()}});
+
         // Normal path: new device arrival — create an impl and spawn a thread.
         std::shared_ptr<AstraDevice> astraDevice = std::make_shared<AstraDevice>(std::move(device), m_tempDir,
-            m_managerMode == ASTRA_DEVICE_MANAGER_MODE_BOOT, m_bootCommand, m_deviceSeries);
+            job->m_managerMode == ASTRA_DEVICE_MANAGER_MODE_BOOT, job->m_bootCommand, job->m_deviceSeries);
 
         // Inject registration callbacks so the impl can arm / disarm rebind-mode.
         auto weakDevice = std::weak_ptr<AstraDevice>(astraDevice);
@@ -578,12 +1335,38 @@ private:
             [this](const std::string &uuid) {
                 UnregisterFastbootSerial(uuid);
             });
+        astraDevice->SetImageStore(m_imageStore);
+        astraDevice->SetImageBroadcast(m_imageBroadcast);
+        astraDevice->SetBootPacketCache(m_bootPacketCache);
+        astraDevice->SetResponseTimes(m_responseTimes);
+        astraDevice->SetEventExecutor(m_eventExecutor);
+        astraDevice->SetDeviceScheduler(m_deviceScheduler);
+        astraDevice->SetTransferTuner(m_transferTuner);
+        astraDevice->SetUpdateCheckpoints(m_updateCheckpoints);
+        astraDevice->SetBootSessions(m_bootSessions, BootSessionJob(*job));
+        astraDevice->SetImageRequestTimeout(m_imageRequestTimeout);
 
         {
             std::lock_guard<std::mutex> lock(m_devicesMutex);
+            if (m_jobs.count(job->m_id) == 0) {
+                // Ended while this device was being set up.
+                if (transport) { transport->RemoveActiveDevice(astraDevice->GetUSBPath()); }
+                return;
+            }
             m_deviceFound = true;
-            m_devices.push_back(astraDevice);
-            std::thread(std::bind(&AstraDeviceManagerImpl::AstraDeviceThread, this, astraDevice)).detach();
+            job->m_devices.push_back(astraDevice);
+            {
+                std::lock_guard<std::mutex> threadLock(job->m_threadMutex);
+                ++job->m_activeThreads;
+            }
+            // The job outlives the manager's bookkeeping for it, so the
+            // count is dropped even after EndJob() stopped waiting.
+            m_deviceScheduler->Spawn([this, astraDevice, job]() {
+                AstraDeviceThread(astraDevice, job);
+                std::lock_guard<std::mutex> threadLock(job->m_threadMutex);
+                --job->m_activeThreads;
+                job->m_threadCV.notify_all();
+            });
         }
     }
 
@@ -592,13 +1375,70 @@ private:
 AstraDeviceManager::AstraDeviceManager(std::function<void(AstraDeviceManagerResponse)> responseCallback,
     bool runContinuously,
     AstraLogLevel minLogLevel, const std::string &logPath,
-    const std::string &tempDir, const std::string &filterPorts, bool usbDebug)
+    const std::string &tempDir, const std::string &filterPorts, bool usbDebug, bool trace,
+    bool mergeDeviceLogs, unsigned maxActiveTransfers, unsigned maxTransfersPerHub)
     : pImpl{std::make_unique<AstraDeviceManagerImpl>(responseCallback,
-        runContinuously, minLogLevel, logPath, tempDir, filterPorts, usbDebug)}
+        runContinuously, minLogLevel, logPath, tempDir, filterPorts, usbDebug, trace, mergeDeviceLogs,
+        maxActiveTransfers, maxTransfersPerHub)}
 {}
 
 AstraDeviceManager::~AstraDeviceManager() = default;
 
+void AstraDeviceManager::SetSimulator(const AstraSimulatorConfig &config)
+{
+    pImpl->SetSimulator(config);
+}
+
+void AstraDeviceManager::SetFilterPorts(const std::string &filterPorts)
+{
+    pImpl->SetFilterPorts(filterPorts);
+}
+
+void AstraDeviceManager::SetProgressInterval(unsigned milliseconds)
+{
+    pImpl->SetProgressInterval(milliseconds);
+}
+
+void AstraDeviceManager::EnableTransferTuning(const std::string &statePath)
+{
+    pImpl->EnableTransferTuning(statePath);
+}
+
+void AstraDeviceManager::EnableUpdateResume(unsigned windowSeconds, const std::string &statePath)
+{
+    pImpl->EnableUpdateResume(windowSeconds, statePath);
+}
+
+void AstraDeviceManager::SetTransferMemoryBudget(uint64_t budgetBytes)
+{
+    pImpl->SetTransferMemoryBudget(budgetBytes);
+}
+
+void AstraDeviceManager::SetImageRequestTimeout(unsigned seconds)
+{
+    pImpl->SetImageRequestTimeout(seconds);
+}
+
+void AstraDeviceManager::EnableImageBroadcast(uint64_t slackBytes)
+{
+    pImpl->EnableImageBroadcast(slackBytes);
+}
+
+void AstraDeviceManager::EnableProfiling()
+{
+    pImpl->EnableProfiling();
+}
+
+bool AstraDeviceManager::EnableMetrics(const std::string &address)
+{
+    return pImpl->EnableMetrics(address);
+}
+
+bool AstraDeviceManager::SetThreadPolicy(const std::string &spec, std::string &error)
+{
+    return ThreadPolicy::Configure(spec, error);
+}
+
 void AstraDeviceManager::Update(std::shared_ptr<FlashImage> flashImage, std::string bootImagePath)
 {
     pImpl->Update(flashImage, bootImagePath);
@@ -609,6 +1449,22 @@ void AstraDeviceManager::Boot(std::string bootImagesPath, std::string bootComman
     pImpl->Boot(bootImagesPath, bootCommand, bootStage);
 }
 
+int AstraDeviceManager::AddUpdateJob(std::shared_ptr<FlashImage> flashImage, std::string bootImagesPath,
+    const std::string &filterPorts, std::function<void(AstraDeviceManagerResponse)> responseCallback)
+{
+    return pImpl->AddUpdateJob(flashImage, bootImagesPath, filterPorts, responseCallback);
+}
+
+bool AstraDeviceManager::EndJob(int jobId)
+{
+    return pImpl->EndJob(jobId);
+}
+
+bool AstraDeviceManager::EndRun()
+{
+    return pImpl->EndRun();
+}
+
 bool AstraDeviceManager::Shutdown()
 {
     return pImpl->Shutdown();
@@ -618,3 +1474,18 @@ std::string AstraDeviceManager::GetLogFile() const
 {
     return pImpl->GetLogFile();
 }
+
+std::string AstraDeviceManager::GetTraceFile() const
+{
+    return pImpl->GetTraceFile();
+}
+
+std::string AstraDeviceManager::GetProfileFile() const
+{
+    return pImpl->GetProfileFile();
+}
+
+std::vector<BusTransferStats> AstraDeviceManager::GetBusTransferStats() const
+{
+    return pImpl->GetBusTransferStats();
+}
@@ -2,54 +2,36 @@
 // Copyright 2025 Synaptics Incorporated
 
 #include "astra_log.hpp"
+#include "thread_policy.hpp"
 #include <iostream>
 #include <mutex>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <condition_variable>
+#include <ctime>
+#include <exception>
+#include <thread>
+#include <vector>
 
 std::unique_ptr<AstraLogStore> AstraLogStore::instance;
 std::once_flag AstraLogStore::initInstanceFlag;
+thread_local std::shared_ptr<AstraLogSink> AstraLogStore::t_threadSink;
 
-AstraLog::AstraLog(const std::string &funcName) : m_funcName{funcName}, m_logLevel{ASTRA_LOG_LEVEL_NONE}
+void AstraLog::LogTrace(const char *message)
 {
     AstraLogStore::getInstance().Log(ASTRA_LOG_LEVEL_TRACE,
-        AstraLog::FormatLog(ASTRA_LOG_LEVEL_TRACE, m_funcName, "-> Entering"));
-}
-
-AstraLog::~AstraLog()
-{
-    AstraLogStore::getInstance().Log(ASTRA_LOG_LEVEL_TRACE,
-        AstraLog::FormatLog(ASTRA_LOG_LEVEL_TRACE, m_funcName, "<- Exiting"));
-}
-
-AstraLog & AstraLog::operator()(AstraLogLevel level) {
-    m_logLevel = level;
-    return *this;
-}
-
-AstraLog & AstraLog::operator<<(const char *str) {
-    m_os << str;
-    return *this;
-}
-
-AstraLog & AstraLog::operator<<(const std::string &str) {
-    m_os << str;
-    return *this;
-}
-
-AstraLog & AstraLog::operator<<(int val) {
-    m_os << val;
-    return *this;
-}
-
-AstraLog & AstraLog::operator<<(unsigned int val) {
-    m_os << val;
-    return *this;
+        AstraLog::FormatLog(ASTRA_LOG_LEVEL_TRACE, m_funcName, message));
 }
 
 AstraLog & endLog(AstraLog &log) {
+    if (!log.m_enabled) {
+        return log;
+    }
+
     AstraLogStore::getInstance().Log(log.m_logLevel,
-        AstraLog::FormatLog(log.m_logLevel, log.m_funcName, log.m_os.str()));
-    log.m_os.str("");
+        AstraLog::FormatLog(log.m_logLevel, log.m_funcName, log.m_os->str()));
+    log.m_os->str("");
     return log;
 }
 
@@ -83,7 +65,13 @@ std::string AstraLog::FormatLog(AstraLogLevel logLevel, const std::string &funcN
     std::ostringstream os;
     auto now = std::chrono::system_clock::now();
     auto t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&t);
+    // std::localtime shares one static buffer between all threads.
+    std::tm tm{};
+#if PLATFORM_WINDOWS
+    localtime_s(&tm, &t);
+#else
+    localtime_r(&t, &tm);
+#endif
 
     // Get microseconds
     auto us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()) % 1000000;
@@ -96,6 +84,141 @@ std::string AstraLog::FormatLog(AstraLogLevel logLevel, const std::string &funcN
     return os.str();
 }
 
+// Records are queued in a bounded ring and written in batches by one writer
+// thread per sink, so callers never block on file I/O unless the ring is full.
+class AstraLogSink {
+public:
+    AstraLogSink(const std::string &name) : m_name{name}, m_ring(kRingCapacity) {}
+
+    ~AstraLogSink()
+    {
+        Close();
+    }
+
+    void Open(const std::string &logPath)
+    {
+        if (logPath == "" || logPath == "stdout") {
+            m_logStream = std::make_unique<std::ostream>(std::cout.rdbuf());
+        } else {
+            m_logFile.open(logPath, std::ios::out | std::ios::app);
+            if (!m_logFile.is_open()) {
+                throw std::runtime_error("Failed to open log file: " + logPath);
+            }
+            m_logStream = std::make_unique<std::ostream>(m_logFile.rdbuf());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_ringMutex);
+            m_ringHead = 0;
+            m_ringCount = 0;
+            m_writerStop = false;
+            m_writerRunning = true;
+        }
+        m_writerThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-log", &AstraLogSink::WriterThread, this);
+    }
+
+    void Write(const std::string &message)
+    {
+        std::unique_lock<std::mutex> lock(m_ringMutex);
+
+        // Apply back-pressure rather than drop records when the writer falls behind.
+        m_ringSpaceCV.wait(lock, [this] { return m_ringCount < m_ring.size() || !m_writerRunning; });
+        if (!m_writerRunning) {
+            return;
+        }
+
+        m_ring[(m_ringHead + m_ringCount) % m_ring.size()] = message;
+        if (m_ringCount++ == 0) {
+            lock.unlock();
+            m_ringDataCV.notify_one();
+        }
+    }
+
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_ringMutex);
+        m_ringDrainedCV.wait(lock, [this] { return !m_writerRunning || (m_ringCount == 0 && !m_writerBusy); });
+    }
+
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_ringMutex);
+            if (m_writerRunning) {
+                m_writerStop = true;
+            }
+        }
+        m_ringDataCV.notify_one();
+        if (m_writerThread.joinable() && m_writerThread.get_id() != std::this_thread::get_id()) {
+            m_writerThread.join();
+        }
+
+        if (m_logStream) {
+            m_logStream->flush();
+        }
+        if (m_logFile.is_open()) {
+            m_logFile.close();
+        }
+    }
+
+    const std::string &GetName() const { return m_name; }
+
+private:
+    static constexpr size_t kRingCapacity = 4096;
+
+    void WriterThread()
+    {
+        std::vector<std::string> batch;
+        batch.reserve(m_ring.size());
+
+        std::unique_lock<std::mutex> lock(m_ringMutex);
+        while (true) {
+            m_ringDataCV.wait(lock, [this] { return m_ringCount > 0 || m_writerStop; });
+            if (m_ringCount == 0 && m_writerStop) {
+                break;
+            }
+
+            for (; m_ringCount > 0; --m_ringCount) {
+                batch.push_back(std::move(m_ring[m_ringHead]));
+                m_ringHead = (m_ringHead + 1) % m_ring.size();
+            }
+            m_writerBusy = true;
+            lock.unlock();
+            m_ringSpaceCV.notify_all();
+
+            for (const auto &record : batch) {
+                *m_logStream << record << '\n';
+            }
+            m_logStream->flush();
+            batch.clear();
+
+            lock.lock();
+            m_writerBusy = false;
+            m_ringDrainedCV.notify_all();
+        }
+
+        m_writerRunning = false;
+        m_ringSpaceCV.notify_all();
+        m_ringDrainedCV.notify_all();
+    }
+
+    std::string m_name;
+    std::unique_ptr<std::ostream> m_logStream;
+    std::ofstream m_logFile;
+
+    std::vector<std::string> m_ring;
+    size_t m_ringHead = 0;
+    size_t m_ringCount = 0;
+    bool m_writerRunning = false;
+    bool m_writerStop = false;
+    bool m_writerBusy = false;
+    std::mutex m_ringMutex;
+    std::condition_variable m_ringDataCV;
+    std::condition_variable m_ringSpaceCV;
+    std::condition_variable m_ringDrainedCV;
+    std::thread m_writerThread;
+};
+
 AstraLogStore::AstraLogStore() {}
 
 AstraLogStore::~AstraLogStore() {
@@ -110,30 +233,123 @@ AstraLogStore& AstraLogStore::getInstance() {
 }
 
 void AstraLogStore::Open(const std::string &logPath, AstraLogLevel minLogLevel) {
+    Close();
+
+    auto sink = std::make_shared<AstraLogSink>("");
+    sink->Open(logPath);
+    std::atomic_store(&m_mainSink, std::move(sink));
+
     m_minLogLevel = minLogLevel;
+    s_activeMinLogLevel.store(minLogLevel);
+
+    // Write out whatever is queued if the process dies through std::terminate,
+    // and on a normal exit that skips Close().
+    static std::once_flag handlersInstalled;
+    std::call_once(handlersInstalled, [this]() {
+        m_previousTerminateHandler = std::set_terminate(&AstraLogStore::TerminateHandler);
+        std::atexit([]() { AstraLogStore::getInstance().Close(); });
+    });
+}
+
+void AstraLogStore::EnableDeviceLogs(bool mergeIntoMainLog) {
+    m_deviceLogsEnabled = true;
+    m_mergeDeviceLogs = mergeIntoMainLog;
+}
 
-    if (logPath == "" || logPath == "stdout") {
-        m_logStream = std::make_unique<std::ostream>(std::cout.rdbuf());
-    } else {
-        m_logFile.open(logPath, std::ios::out | std::ios::app);
-        if (!m_logFile.is_open()) {
-            throw std::runtime_error("Failed to open log file");
+std::shared_ptr<AstraLogSink> AstraLogStore::OpenDeviceLog(const std::string &deviceName, const std::string &logPath) {
+    if (!m_deviceLogsEnabled) {
+        return nullptr;
+    }
+
+    auto sink = std::make_shared<AstraLogSink>(deviceName);
+    try {
+        sink->Open(logPath);
+    } catch (const std::exception &e) {
+        Log(ASTRA_LOG_LEVEL_WARNING, AstraLog::FormatLog(ASTRA_LOG_LEVEL_WARNING, __FUNCTION__, e.what()));
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_sinksMutex);
+    m_deviceSinks.erase(std::remove_if(m_deviceSinks.begin(), m_deviceSinks.end(),
+        [](const std::weak_ptr<AstraLogSink> &entry) { return entry.expired(); }), m_deviceSinks.end());
+    m_deviceSinks.push_back(sink);
+    return sink;
+}
+
+void AstraLogStore::SetThreadSink(std::shared_ptr<AstraLogSink> sink) {
+    t_threadSink = std::move(sink);
+}
+
+void AstraLogStore::Flush() {
+    std::shared_ptr<AstraLogSink> mainSink = std::atomic_load(&m_mainSink);
+    std::vector<std::shared_ptr<AstraLogSink>> deviceSinks;
+    {
+        std::lock_guard<std::mutex> lock(m_sinksMutex);
+        for (const auto &entry : m_deviceSinks) {
+            if (auto sink = entry.lock()) {
+                deviceSinks.push_back(std::move(sink));
+            }
         }
-        m_logStream = std::make_unique<std::ostream>(m_logFile.rdbuf());
+    }
+
+    for (const auto &sink : deviceSinks) {
+        sink->Flush();
+    }
+    if (mainSink) {
+        mainSink->Flush();
     }
 }
 
 void AstraLogStore::Close() {
-    if (m_logFile.is_open()) {
-        m_logFile.close();
+    s_activeMinLogLevel.store(ASTRA_LOG_LEVEL_NONE);
+
+    std::shared_ptr<AstraLogSink> mainSink = std::atomic_exchange(&m_mainSink, std::shared_ptr<AstraLogSink>());
+    std::vector<std::shared_ptr<AstraLogSink>> deviceSinks;
+    {
+        std::lock_guard<std::mutex> lock(m_sinksMutex);
+        for (const auto &entry : m_deviceSinks) {
+            if (auto sink = entry.lock()) {
+                deviceSinks.push_back(std::move(sink));
+            }
+        }
+        m_deviceSinks.clear();
+    }
+
+    for (const auto &sink : deviceSinks) {
+        sink->Close();
+    }
+    if (mainSink) {
+        mainSink->Close();
     }
 }
 
 void AstraLogStore::Log(AstraLogLevel level, const std::string& message) {
-    if (m_logStream) {
-        if (level >= m_minLogLevel) {
-            *m_logStream << message << std::endl;
-            m_logStream->flush();
+    if (level < m_minLogLevel) {
+        return;
+    }
+
+    // Device threads write to their own sink; the main log only sees their
+    // records when the merged view was requested.
+    const std::shared_ptr<AstraLogSink> &threadSink = t_threadSink;
+    if (threadSink) {
+        threadSink->Write(message);
+        if (!m_mergeDeviceLogs) {
+            return;
         }
     }
-}
\ No newline at end of file
+
+    std::shared_ptr<AstraLogSink> mainSink = std::atomic_load(&m_mainSink);
+    if (mainSink) {
+        mainSink->Write(threadSink ? "[" + threadSink->GetName() + "] " + message : message);
+    }
+}
+
+void AstraLogStore::TerminateHandler() {
+    AstraLogStore &store = AstraLogStore::getInstance();
+    store.Close();
+
+    if (store.m_previousTerminateHandler) {
+        store.m_previousTerminateHandler();
+    }
+    std::abort();
+}
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "astra_profile.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+#include "astra_log.hpp"
+
+std::unique_ptr<AstraProfileStore> AstraProfileStore::instance;
+std::once_flag AstraProfileStore::initInstanceFlag;
+thread_local AstraProfileStore::ThreadHandle AstraProfileStore::t_thread;
+
+AstraProfileSite::AstraProfileSite(const char *function, const char *file, int line)
+    : m_function{function}, m_file{file}, m_line{line}
+{
+    m_index = AstraProfileStore::getInstance().RegisterSite(this);
+}
+
+AstraProfileStore& AstraProfileStore::getInstance()
+{
+    std::call_once(initInstanceFlag, []() {
+        instance.reset(new AstraProfileStore);
+    });
+    return *instance;
+}
+
+AstraProfileStore::~AstraProfileStore()
+{
+    // Like the trace, an unwritten profile is dropped at exit.
+    s_enabled.store(false);
+    for (ThreadCounters *counters : m_threads) {
+        delete counters;
+    }
+}
+
+AstraProfileStore::ThreadCounters::~ThreadCounters()
+{
+    for (auto &chunk : m_chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+AstraProfileStore::ThreadHandle::~ThreadHandle()
+{
+    if (m_counters != nullptr && instance) {
+        instance->RetireThread(m_counters);
+    }
+}
+
+void AstraProfileStore::Open(const std::string &profilePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profilePath = profilePath;
+    m_origin = std::chrono::steady_clock::now();
+    s_enabled.store(true);
+}
+
+uint32_t AstraProfileStore::RegisterSite(const AstraProfileSite *site)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sites.push_back(site);
+    return static_cast<uint32_t>(m_sites.size() - 1);
+}
+
+AstraProfileStore::ThreadCounters *AstraProfileStore::AdoptThread()
+{
+    AstraProfileStore &store = getInstance();
+    ThreadCounters *counters = new ThreadCounters;
+    std::lock_guard<std::mutex> lock(store.m_mutex);
+    store.m_threads.push_back(counters);
+    t_thread.m_counters = counters;
+    return counters;
+}
+
+void AstraProfileStore::RetireThread(ThreadCounters *counters)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Accumulate(*counters, m_retired);
+    m_threads.erase(std::remove(m_threads.begin(), m_threads.end(), counters), m_threads.end());
+    delete counters;
+}
+
+void AstraProfileStore::Record(const AstraProfileSite &site, uint64_t durationNs)
+{
+    const uint32_t chunkIndex = site.m_index / kSitesPerChunk;
+    if (chunkIndex >= kMaxChunks) {
+        return;
+    }
+
+    ThreadCounters *counters = t_thread.m_counters;
+    if (counters == nullptr) {
+        counters = AdoptThread();
+    }
+
+    // Only this thread stores to its counters, so plain load/store pairs
+    // suffice and no read-modify-write is needed.
+    std::atomic<Counter *> &chunkSlot = counters->m_chunks[chunkIndex];
+    Counter *chunk = chunkSlot.load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new Counter[kSitesPerChunk];
+        chunkSlot.store(chunk, std::memory_order_release);
+    }
+
+    Counter &counter = chunk[site.m_index % kSitesPerChunk];
+    counter.m_calls.store(counter.m_calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    counter.m_totalNs.store(counter.m_totalNs.load(std::memory_order_relaxed) + durationNs, std::memory_order_relaxed);
+    if (durationNs > counter.m_maxNs.load(std::memory_order_relaxed)) {
+        counter.m_maxNs.store(durationNs, std::memory_order_relaxed);
+    }
+}
+
+void AstraProfileStore::Accumulate(const ThreadCounters &counters, std::vector<Totals> &totals)
+{
+    for (uint32_t chunkIndex = 0; chunkIndex < kMaxChunks; ++chunkIndex) {
+        const Counter *chunk = counters.m_chunks[chunkIndex].load(std::memory_order_acquire);
+        if (chunk == nullptr) {
+            continue;
+        }
+        for (uint32_t i = 0; i < kSitesPerChunk; ++i) {
+            const uint64_t calls = chunk[i].m_calls.load(std::memory_order_relaxed);
+            if (calls == 0) {
+                continue;
+            }
+            const size_t index = static_cast<size_t>(chunkIndex) * kSitesPerChunk + i;
+            if (totals.size() <= index) {
+                totals.resize(index + 1);
+            }
+            totals[index].m_calls += calls;
+            totals[index].m_totalNs += chunk[i].m_totalNs.load(std::memory_order_relaxed);
+            totals[index].m_maxNs = std::max(totals[index].m_maxNs, chunk[i].m_maxNs.load(std::memory_order_relaxed));
+        }
+    }
+}
+
+void AstraProfileStore::Close()
+{
+    if (!s_enabled.exchange(false)) {
+        return;
+    }
+
+    ASTRA_LOG;
+
+    std::vector<std::pair<const AstraProfileSite *, Totals>> rows;
+    double elapsedSeconds = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Threads still running may add a call or two while being read;
+        // that is noise next to the totals.
+        std::vector<Totals> totals = m_retired;
+        for (const ThreadCounters *counters : m_threads) {
+            Accumulate(*counters, totals);
+        }
+        for (size_t i = 0; i < totals.size() && i < m_sites.size(); ++i) {
+            if (totals[i].m_calls > 0) {
+                rows.emplace_back(m_sites[i], totals[i]);
+            }
+        }
+        elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_origin).count();
+        m_retired.clear();
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) {
+        return a.second.m_totalNs > b.second.m_totalNs;
+    });
+
+    std::ofstream file(m_profilePath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open profile file: " << m_profilePath << endLog;
+        return;
+    }
+
+    // Times are inclusive of callees, so nested functions add up to more
+    // than the wall time.
+    file << "# astra-update profile over " << std::fixed << std::setprecision(3) << elapsedSeconds << " s, "
+        << rows.size() << " functions\n";
+    file << std::setw(12) << "calls" << std::setw(14) << "total ms" << std::setw(12) << "mean us"
+        << std::setw(12) << "max us" << "  function (location)\n";
+    for (const auto &[site, totals] : rows) {
+        file << std::setw(12) << totals.m_calls
+            << std::setw(14) << std::setprecision(3) << totals.m_totalNs / 1e6
+            << std::setw(12) << std::setprecision(1) << totals.m_totalNs / 1e3 / totals.m_calls
+            << std::setw(12) << std::setprecision(1) << totals.m_maxNs / 1e3
+            << "  " << site->m_function << " (" << std::filesystem::path(site->m_file).filename().string()
+            << ":" << site->m_line << ")\n";
+    }
+
+    log(ASTRA_LOG_LEVEL_INFO) << "Profile of " << rows.size() << " functions written to " << m_profilePath << endLog;
+}
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "astra_trace.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+#include "astra_log.hpp"
+
+std::unique_ptr<AstraTraceStore> AstraTraceStore::instance;
+std::once_flag AstraTraceStore::initInstanceFlag;
+
+AstraTraceStore& AstraTraceStore::getInstance()
+{
+    std::call_once(initInstanceFlag, []() {
+        instance.reset(new AstraTraceStore);
+    });
+    return *instance;
+}
+
+AstraTraceStore::~AstraTraceStore()
+{
+    // Unwritten events are dropped: the log store may already be gone at exit.
+    m_enabled.store(false);
+}
+
+void AstraTraceStore::Open(const std::string &tracePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tracePath = tracePath;
+    m_origin = std::chrono::steady_clock::now();
+    m_events.clear();
+    m_enabled.store(true);
+}
+
+void AstraTraceStore::Close()
+{
+    if (!m_enabled.exchange(false)) {
+        return;
+    }
+
+    ASTRA_LOG;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::ofstream file(m_tracePath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open trace file: " << m_tracePath << endLog;
+        return;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"astra-update\"}}";
+    for (const auto &[threadId, threadName] : m_threadNames) {
+        file << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << threadId << ",\"args\":{\"name\":";
+        WriteString(file, threadName);
+        file << "}}";
+    }
+    for (const auto &event : m_events) {
+        file << ",\n{\"ph\":\"" << event.phase << "\",\"name\":";
+        WriteString(file, event.name);
+        file << ",\"pid\":1,\"tid\":" << event.threadId << ",\"ts\":" << event.startUs;
+        if (event.phase == 'X') {
+            file << ",\"dur\":" << event.durationUs;
+        } else {
+            file << ",\"s\":\"t\"";
+        }
+        if (!event.args.empty()) {
+            file << ",\"args\":{";
+            for (size_t i = 0; i < event.args.size(); ++i) {
+                if (i > 0) {
+                    file << ",";
+                }
+                WriteString(file, event.args[i].first);
+                file << ":";
+                WriteString(file, event.args[i].second);
+            }
+            file << "}";
+        }
+        file << "}";
+    }
+    file << "\n]}\n";
+
+    log(ASTRA_LOG_LEVEL_INFO) << "Wrote " << m_events.size() << " trace events to " << m_tracePath << endLog;
+
+    m_events.clear();
+    m_threadNames.clear();
+}
+
+void AstraTraceStore::SetThreadName(const std::string &name)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    const uint32_t threadId = CurrentThreadId();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &entry : m_threadNames) {
+        if (entry.first == threadId) {
+            entry.second = name;
+            return;
+        }
+    }
+    m_threadNames.emplace_back(threadId, name);
+}
+
+void AstraTraceStore::AddSpan(const std::string &name, int64_t startUs, int64_t durationUs, Args args)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.push_back({'X', name, CurrentThreadId(), startUs, durationUs, std::move(args)});
+}
+
+void AstraTraceStore::AddInstant(const std::string &name, Args args)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    const int64_t now = NowMicros();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.push_back({'i', name, CurrentThreadId(), now, 0, std::move(args)});
+}
+
+int64_t AstraTraceStore::NowMicros() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_origin).count();
+}
+
+uint32_t AstraTraceStore::CurrentThreadId()
+{
+    // Small sequential ids keep the trace viewer's track list readable.
+    static std::atomic<uint32_t> nextThreadId{1};
+    thread_local const uint32_t threadId = nextThreadId.fetch_add(1);
+    return threadId;
+}
+
+void AstraTraceStore::WriteString(std::ostream &os, const std::string &str)
+{
+    os << '"';
+    for (const unsigned char c : str) {
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        } else if (c < 0x20) {
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+               << std::dec << std::setfill(' ');
+        } else {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+AstraTraceSpan::AstraTraceSpan(const std::string &name, AstraTraceStore::Args args)
+{
+    AstraTraceStore &store = AstraTraceStore::getInstance();
+    if (store.IsEnabled()) {
+        m_name = name;
+        m_args = std::move(args);
+        m_startUs = store.NowMicros();
+        m_active = true;
+    }
+}
+
+AstraTraceSpan::~AstraTraceSpan()
+{
+    End();
+}
+
+void AstraTraceSpan::AddArg(const std::string &key, const std::string &value)
+{
+    if (m_active) {
+        m_args.emplace_back(key, value);
+    }
+}
+
+void AstraTraceSpan::End()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+
+    AstraTraceStore &store = AstraTraceStore::getInstance();
+    store.AddSpan(m_name, m_startUs, store.NowMicros() - m_startUs, std::move(m_args));
+}
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Session-wide timeline recorder.  When opened, spans and instant events from
+ * every thread are buffered in memory with steady_clock timestamps and written
+ * as Chrome trace event JSON on Close(), which can be loaded in Perfetto
+ * (ui.perfetto.dev) or chrome://tracing.  When not opened, recording is a
+ * single relaxed atomic load.
+ */
+class AstraTraceStore {
+public:
+    using Args = std::vector<std::pair<std::string, std::string>>;
+
+    static AstraTraceStore& getInstance();
+    ~AstraTraceStore();
+
+    void Open(const std::string &tracePath);
+    void Close();
+
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    std::string GetTracePath() const { return m_tracePath; }
+
+    /** Label the calling thread's track in the trace viewer. */
+    void SetThreadName(const std::string &name);
+
+    void AddSpan(const std::string &name, int64_t startUs, int64_t durationUs, Args args);
+    void AddInstant(const std::string &name, Args args);
+
+    /** @return microseconds since Open() on the steady clock. */
+    int64_t NowMicros() const;
+
+private:
+    AstraTraceStore() = default;
+    AstraTraceStore(const AstraTraceStore&) = delete;
+    AstraTraceStore& operator=(const AstraTraceStore&) = delete;
+
+    struct Event {
+        char phase;
+        std::string name;
+        uint32_t threadId;
+        int64_t startUs;
+        int64_t durationUs;
+        Args args;
+    };
+
+    static uint32_t CurrentThreadId();
+    static void WriteString(std::ostream &os, const std::string &str);
+
+    std::atomic<bool> m_enabled{false};
+    std::string m_tracePath;
+    std::chrono::steady_clock::time_point m_origin;
+    std::mutex m_mutex;
+    std::vector<Event> m_events;
+    std::vector<std::pair<uint32_t, std::string>> m_threadNames;
+    static std::unique_ptr<AstraTraceStore> instance;
+    static std::once_flag initInstanceFlag;
+};
+
+/**
+ * Records one complete ("X") event covering its lifetime, or until End().
+ * Does nothing if tracing was not enabled when the span started.
+ */
+class AstraTraceSpan {
+public:
+    explicit AstraTraceSpan(const std::string &name, AstraTraceStore::Args args = {});
+    ~AstraTraceSpan();
+
+    AstraTraceSpan(const AstraTraceSpan&) = delete;
+    AstraTraceSpan& operator=(const AstraTraceSpan&) = delete;
+
+    void AddArg(const std::string &key, const std::string &value);
+    void End();
+
+private:
+    std::string m_name;
+    AstraTraceStore::Args m_args;
+    int64_t m_startUs = 0;
+    bool m_active = false;
+};
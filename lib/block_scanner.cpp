@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <cstring>
+
+#include "block_scanner.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BLOCK_SCANNER_X86_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__)
+#define BLOCK_SCANNER_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#define BLOCK_SCANNER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Bytes compared between early-exit checks: most blocks that are not
+// uniform differ within the first few words.
+constexpr size_t kStride = 128;
+
+bool IsUniformPortable(const uint8_t *data, size_t size, uint32_t word)
+{
+    const uint64_t pattern = (static_cast<uint64_t>(word) << 32) | word;
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        uint64_t value;
+        std::memcpy(&value, data + offset, sizeof(value));
+        if (value != pattern) {
+            return false;
+        }
+    }
+    for (; offset < size; offset += 4) {
+        uint32_t value;
+        std::memcpy(&value, data + offset, sizeof(value));
+        if (value != word) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if BLOCK_SCANNER_X86_AVX2
+__attribute__((target("avx2")))
+bool ScanUniformAvx2(const uint8_t *data, size_t size, uint32_t word, size_t &offset)
+{
+    const __m256i pattern = _mm256_set1_epi32(static_cast<int>(word));
+    for (offset = 0; offset + kStride <= size; offset += kStride) {
+        __m256i diff = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + offset)), pattern);
+        for (size_t i = 32; i < kStride; i += 32) {
+            diff = _mm256_or_si256(diff, _mm256_xor_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + offset + i)), pattern));
+        }
+        if (!_mm256_testz_si256(diff, diff)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HasAvx2()
+{
+    // Runs from a static initialiser, possibly before the CPU model is set up.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+const bool kUseAvx2 = HasAvx2();
+#endif
+
+#if BLOCK_SCANNER_SSE2
+bool ScanUniformSse2(const uint8_t *data, size_t size, uint32_t word, size_t &offset)
+{
+    const __m128i pattern = _mm_set1_epi32(static_cast<int>(word));
+    for (offset = 0; offset + kStride <= size; offset += kStride) {
+        __m128i same = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + offset)), pattern);
+        for (size_t i = 16; i < kStride; i += 16) {
+            same = _mm_and_si128(same, _mm_cmpeq_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + offset + i)), pattern));
+        }
+        if (_mm_movemask_epi8(same) != 0xFFFF) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+#if BLOCK_SCANNER_NEON
+bool ScanUniformNeon(const uint8_t *data, size_t size, uint32_t word, size_t &offset)
+{
+    const uint32x4_t pattern = vdupq_n_u32(word);
+    for (offset = 0; offset + kStride <= size; offset += kStride) {
+        uint32x4_t diff = veorq_u32(vreinterpretq_u32_u8(vld1q_u8(data + offset)), pattern);
+        for (size_t i = 16; i < kStride; i += 16) {
+            diff = vorrq_u32(diff, veorq_u32(vreinterpretq_u32_u8(vld1q_u8(data + offset + i)), pattern));
+        }
+        const uint64x2_t wide = vreinterpretq_u64_u32(diff);
+        if ((vgetq_lane_u64(wide, 0) | vgetq_lane_u64(wide, 1)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+// Compare the whole strides with the widest unit available, leaving the
+// offset the portable loop continues from.  Returns false once one differs.
+bool ScanUniform(const uint8_t *data, size_t size, uint32_t word, size_t &offset)
+{
+#if BLOCK_SCANNER_X86_AVX2
+    if (kUseAvx2) {
+        return ScanUniformAvx2(data, size, word, offset);
+    }
+#endif
+#if BLOCK_SCANNER_SSE2
+    return ScanUniformSse2(data, size, word, offset);
+#elif BLOCK_SCANNER_NEON
+    return ScanUniformNeon(data, size, word, offset);
+#else
+    (void)data;
+    (void)size;
+    (void)word;
+    offset = 0;
+    return true;
+#endif
+}
+
+} // namespace
+
+bool BlockScanner::IsUniform(const uint8_t *data, size_t size, uint32_t &fillValue)
+{
+    if (size < 4 || (size % 4) != 0) {
+        return false;
+    }
+
+    uint32_t word;
+    std::memcpy(&word, data, sizeof(word));
+
+    size_t offset = 0;
+    if (!ScanUniform(data, size, word, offset) || !IsUniformPortable(data + offset, size - offset, word)) {
+        return false;
+    }
+
+    fillValue = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+        (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    return true;
+}
+
+std::vector<BlockScanner::Run> BlockScanner::FindUniformRuns(const uint8_t *data, size_t size, size_t blockSize)
+{
+    std::vector<Run> runs;
+    AppendUniformRuns(runs, data, size, blockSize, 0);
+    return runs;
+}
+
+void BlockScanner::AppendUniformRuns(std::vector<Run> &runs, const uint8_t *data, size_t size, size_t blockSize,
+    uint64_t firstBlock)
+{
+    if (blockSize == 0) {
+        return;
+    }
+
+    const uint64_t blocks = size / blockSize;
+    for (uint64_t block = 0; block < blocks; ++block) {
+        uint32_t fillValue = 0;
+        if (!IsUniform(data + block * blockSize, blockSize, fillValue)) {
+            continue;
+        }
+        if (!runs.empty() && runs.back().m_fillValue == fillValue &&
+            runs.back().m_firstBlock + runs.back().m_blocks == firstBlock + block)
+        {
+            ++runs.back().m_blocks;
+        } else {
+            runs.push_back({firstBlock + block, 1, fillValue});
+        }
+    }
+}
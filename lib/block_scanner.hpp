@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Finds the blocks of a raw image that repeat one 32-bit word, such as the
+ * 0x00 left by a wiped eMMC or the 0xFF of erased flash, so they can be sent
+ * as sparse FILL chunks instead of payload.  Uses AVX2 when the CPU has it,
+ * SSE2 or NEON where the build targets them and a portable loop otherwise.
+ */
+class BlockScanner {
+public:
+    /** Consecutive uniform blocks holding the same word. */
+    struct Run
+    {
+        uint64_t m_firstBlock = 0;
+        uint64_t m_blocks = 0;
+        uint32_t m_fillValue = 0;   // little-endian, as in a sparse FILL chunk
+    };
+
+    /**
+     * @return true if size bytes at data repeat their first four, with that
+     * word in fillValue.  size must be a non-zero multiple of 4.
+     */
+    static bool IsUniform(const uint8_t *data, size_t size, uint32_t &fillValue);
+
+    /** Runs of uniform blocks in data, in order.  A trailing partial block is never uniform. */
+    static std::vector<Run> FindUniformRuns(const uint8_t *data, size_t size, size_t blockSize);
+
+    /**
+     * Scan the next piece of an image read in order, whose first block is
+     * firstBlock, adding its runs to runs and extending the last one.
+     */
+    static void AppendUniformRuns(std::vector<Run> &runs, const uint8_t *data, size_t size, size_t blockSize,
+        uint64_t firstBlock);
+};
+
+/** The uniform runs of one image, shared between copies of it. */
+struct UniformBlockMap
+{
+    uint32_t m_blockSize = 0;
+    std::vector<BlockScanner::Run> m_runs;
+};
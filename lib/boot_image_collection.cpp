@@ -1,24 +1,192 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2025 Synaptics Incorporated
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include "boot_image_collection.hpp"
 #include "astra_boot_image.hpp"
 #include "image.hpp"
 #include "astra_log.hpp"
+#include "thread_policy.hpp"
 
-void BootImageCollection::LoadBootImage(const std::filesystem::path &path)
+std::shared_ptr<AstraBootImage> BootImageCollection::LoadBootImage(const std::filesystem::path &path)
 {
     ASTRA_LOG;
 
     if (std::filesystem::exists(path / "manifest.yaml")) {
-        AstraBootImage bootImage{path.string()};
+        auto bootImage = std::make_shared<AstraBootImage>(path.string());
 
-        if(bootImage.Load()) {
-            m_bootImages.push_back(std::make_shared<AstraBootImage>(bootImage));
+        if(bootImage->LoadHeader()) {
+            m_bootImages.push_back(bootImage);
+            return bootImage;
         }
     }
+
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<AstraBootImage>> BootImageCollection::LoadBootImages(
+    const std::vector<std::filesystem::path> &paths) const
+{
+    std::vector<std::shared_ptr<AstraBootImage>> bootImages(paths.size());
+
+    // Manifests are independent, so parse them on a few threads.  Each result
+    // lands in its own slot to keep the directory order.
+    std::atomic<size_t> next{0};
+    auto worker = [&paths, &bootImages, &next]() {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            if (!std::filesystem::exists(paths[i] / "manifest.yaml")) {
+                continue;
+            }
+            auto bootImage = std::make_shared<AstraBootImage>(paths[i].string());
+            if (bootImage->LoadHeader()) {
+                bootImages[i] = bootImage;
+            }
+        }
+    };
+
+    const size_t threadCount = std::min<size_t>(paths.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.push_back(ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-bootimg", worker));
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    return bootImages;
+}
+
+std::string BootImageCollection::ChipKey(const std::string &chipName, AstraSecureBootVersion secureBoot,
+    AstraMemoryLayout memoryLayout)
+{
+    return chipName + "/" + std::to_string(secureBoot) + "/" + std::to_string(memoryLayout);
+}
+
+void BootImageCollection::BuildLookupTables()
+{
+    m_deviceIds.clear();
+    m_bootImagesById.clear();
+    m_bootImagesByChip.clear();
+
+    for (const auto &bootImage : m_bootImages) {
+        m_deviceIds.push_back(std::make_tuple(bootImage->GetVendorId(), bootImage->GetProductId()));
+        // The first boot image with a given ID wins, as with the old linear search.
+        m_bootImagesById.emplace(bootImage->GetID(), bootImage);
+        m_bootImagesByChip[ChipKey(bootImage->GetChipName(), bootImage->GetSecureBootVersion(),
+            bootImage->GetMemoryLayout())].push_back(bootImage);
+    }
+}
+
+std::string BootImageCollection::IndexStamp(const std::filesystem::path &path)
+{
+    std::error_code ec;
+    const auto dirTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return "";
+    }
+    const auto manifestTime = std::filesystem::last_write_time(path / "manifest.yaml", ec);
+    if (ec) {
+        return "";
+    }
+    const auto manifestSize = std::filesystem::file_size(path / "manifest.yaml", ec);
+    if (ec) {
+        return "";
+    }
+
+    std::ostringstream stamp;
+    stamp << dirTime.time_since_epoch().count() << " " << manifestTime.time_since_epoch().count()
+          << " " << manifestSize;
+    return stamp.str();
+}
+
+std::map<std::string, BootImageCollection::IndexEntry> BootImageCollection::ReadIndex(
+    const std::filesystem::path &dir) const
+{
+    ASTRA_LOG;
+
+    std::map<std::string, IndexEntry> index;
+
+    std::ifstream file(dir / kIndexFileName);
+    if (!file) {
+        return index;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kIndexHeader) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring boot image index with unknown format" << endLog;
+        return index;
+    }
+
+    while (std::getline(file, line)) {
+        std::string stamp;
+        if (line.rfind("dir ", 0) != 0 || !std::getline(file, stamp) || stamp.rfind("stamp ", 0) != 0) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed boot image index" << endLog;
+            return {};
+        }
+
+        const std::string name = line.substr(4);
+        auto bootImage = std::make_shared<AstraBootImage>((dir / name).string());
+        if (!bootImage->ReadIndexEntry(file)) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed boot image index entry: " << name << endLog;
+            return {};
+        }
+        index[name] = IndexEntry{stamp.substr(6), bootImage};
+    }
+
+    return index;
+}
+
+void BootImageCollection::WriteIndex(const std::filesystem::path &dir,
+    const std::map<std::string, IndexEntry> &index) const
+{
+    ASTRA_LOG;
+
+    // Write a private temporary and rename it over the index, so a
+    // concurrent run never reads a partial file.
+    const std::filesystem::path indexPath = dir / kIndexFileName;
+    const std::filesystem::path tempPath = dir / (std::string(kIndexFileName) + "." +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::trunc);
+        if (!file) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Boot image collection is not writable, not caching the index" << endLog;
+            return;
+        }
+
+        file << kIndexHeader << "\n";
+        for (const auto &[name, entry] : index) {
+            file << "dir " << name << "\n";
+            file << "stamp " << entry.stamp << "\n";
+            entry.bootImage->WriteIndexEntry(file);
+        }
+
+        if (!file.flush()) {
+            log(ASTRA_LOG_LEVEL_WARNING) << "Failed to write boot image index " << tempPath << endLog;
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, indexPath, ec);
+    if (ec) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "Failed to replace boot image index: " << ec.message() << endLog;
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Wrote boot image index with " << index.size() << " entries" << endLog;
 }
 
 void BootImageCollection::Load()
@@ -31,40 +199,81 @@ void BootImageCollection::Load()
 
     if (std::filesystem::exists(dir)) {
         if (std::filesystem::is_directory(dir)) {
+            // Boot images whose directory and manifest are unchanged since the
+            // last run come from the index; only new or modified ones are parsed.
+            std::map<std::string, IndexEntry> index = ReadIndex(dir);
+            std::map<std::string, IndexEntry> updatedIndex;
+            size_t cachedCount = 0;
+
+            struct Scanned {
+                std::string name;
+                std::string stamp;
+                std::shared_ptr<AstraBootImage> bootImage;
+            };
+            std::vector<Scanned> scanned;
+            std::vector<std::filesystem::path> misses;
+            std::vector<size_t> missSlots;
+
             for (const auto& entry : std::filesystem::directory_iterator(dir)) {
-                if (std::filesystem::is_directory(entry.path())) {
-                    LoadBootImage(entry.path());
+                if (!std::filesystem::is_directory(entry.path())) {
+                    continue;
+                }
+
+                const std::string name = entry.path().filename().string();
+                const std::string stamp = IndexStamp(entry.path());
+                auto it = index.find(name);
+                if (!stamp.empty() && it != index.end() && it->second.stamp == stamp) {
+                    scanned.push_back(Scanned{name, stamp, it->second.bootImage});
+                    ++cachedCount;
+                    continue;
+                }
+
+                missSlots.push_back(scanned.size());
+                misses.push_back(entry.path());
+                scanned.push_back(Scanned{name, stamp, nullptr});
+            }
+
+            std::vector<std::shared_ptr<AstraBootImage>> parsed = LoadBootImages(misses);
+            for (size_t i = 0; i < parsed.size(); ++i) {
+                scanned[missSlots[i]].bootImage = parsed[i];
+            }
+
+            for (const auto &image : scanned) {
+                if (image.bootImage == nullptr) {
+                    continue;
+                }
+                m_bootImages.push_back(image.bootImage);
+                if (!image.stamp.empty()) {
+                    updatedIndex[image.name] = IndexEntry{image.stamp, image.bootImage};
                 }
             }
+
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Loaded " << m_bootImages.size() << " boot images, "
+                << cachedCount << " from the index" << endLog;
+
+            if (cachedCount != updatedIndex.size() || updatedIndex.size() != index.size()) {
+                WriteIndex(dir, updatedIndex);
+            }
         } else {
             LoadBootImage(dir);
         }
     } else {
         throw std::invalid_argument("Boot Images directory " + m_path + " not found");
     }
+
+    BuildLookupTables();
 }
 
 std::vector<std::tuple<uint16_t, uint16_t>> BootImageCollection::GetDeviceIDs() const
 {
-    ASTRA_LOG;
-
-    std::vector<std::tuple<uint16_t, uint16_t>> deviceIds;
-
-    for (const auto& bootImages : m_bootImages) {
-        deviceIds.push_back(std::make_tuple(bootImages->GetVendorId(), bootImages->GetProductId()));
-    }
-
-    return deviceIds;
+    return m_deviceIds;
 }
 
 AstraBootImage &BootImageCollection::GetBootImage(std::string id) const
 {
-    ASTRA_LOG;
-
-    for (const auto& bootImage : m_bootImages) {
-        if (bootImage->GetID() == id) {
-            return *bootImage;
-        }
+    auto it = m_bootImagesById.find(id);
+    if (it != m_bootImagesById.end()) {
+        return *it->second;
     }
 
     throw std::runtime_error("Boot Images not found");
@@ -84,31 +293,32 @@ std::vector<std::shared_ptr<AstraBootImage>> BootImageCollection::GetBootImagesF
     std::vector<std::shared_ptr<AstraBootImage>> bootImages;
 
     for (const auto& candidateChipName : chipNamesToTry) {
-        for (const auto& bootImage : m_bootImages) {
-            if (bootImage->GetChipName() == candidateChipName && bootImage->GetSecureBootVersion() == secureBoot
-              && bootImage->GetMemoryLayout() == memoryLayout)
-            {
-                bool boardImageMatch = false;
-
-                if (boardName.empty()) {
-                    boardImageMatch = true;
-                } else if (bootImage->GetBoardName() == boardName) {
-                    boardImageMatch = true;
-                }
+        auto it = m_bootImagesByChip.find(ChipKey(candidateChipName, secureBoot, memoryLayout));
+        if (it == m_bootImagesByChip.end()) {
+            continue;
+        }
 
-                // If DDR Type is not set to a specific value then do
-                // not use it for matching.
-                if (memoryDDRType == ASTRA_MEMORY_DDR_TYPE_NOT_SPECIFIED) {
-                    boardImageMatch = true;
-                } else if (bootImage->GetMemoryDDRType() == memoryDDRType) {
-                    boardImageMatch = true;
-                } else {
-                    boardImageMatch = false;
-                }
+        for (const auto& bootImage : it->second) {
+            bool boardImageMatch = false;
 
-                if (boardImageMatch) {
-                    bootImages.push_back(bootImage);
-                }
+            if (boardName.empty()) {
+                boardImageMatch = true;
+            } else if (bootImage->GetBoardName() == boardName) {
+                boardImageMatch = true;
+            }
+
+            // If DDR Type is not set to a specific value then do
+            // not use it for matching.
+            if (memoryDDRType == ASTRA_MEMORY_DDR_TYPE_NOT_SPECIFIED) {
+                boardImageMatch = true;
+            } else if (bootImage->GetMemoryDDRType() == memoryDDRType) {
+                boardImageMatch = true;
+            } else {
+                boardImageMatch = false;
+            }
+
+            if (boardImageMatch) {
+                bootImages.push_back(bootImage);
             }
         }
 
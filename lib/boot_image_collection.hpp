@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <filesystem>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include "astra_boot_image.hpp"
@@ -24,9 +27,37 @@ public:
         std::string boardName) const;
 
 private:
+    // Cached manifest data, keyed by boot image directory name, stored in
+    // kIndexFileName at the top of the collection.
+    struct IndexEntry {
+        std::string stamp;
+        std::shared_ptr<AstraBootImage> bootImage;
+    };
+
+    static constexpr const char *kIndexFileName = ".boot_image_index";
+    static constexpr const char *kIndexHeader = "astra-boot-index 1";
+
     std::string m_path;
     std::vector<std::shared_ptr<AstraBootImage>> m_bootImages;
 
-    void LoadBootImage(const std::filesystem::path &path);
+    // Lookup tables built once the collection has loaded.  Boot images only
+    // carry their manifest data until one is selected and LoadImages() is called.
+    std::vector<std::tuple<uint16_t, uint16_t>> m_deviceIds;
+    std::unordered_map<std::string, std::shared_ptr<AstraBootImage>> m_bootImagesById;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<AstraBootImage>>> m_bootImagesByChip;
+
+    std::shared_ptr<AstraBootImage> LoadBootImage(const std::filesystem::path &path);
+    std::vector<std::shared_ptr<AstraBootImage>> LoadBootImages(const std::vector<std::filesystem::path> &paths) const;
+    void BuildLookupTables();
+    static std::string ChipKey(const std::string &chipName, AstraSecureBootVersion secureBoot,
+        AstraMemoryLayout memoryLayout);
+    std::map<std::string, IndexEntry> ReadIndex(const std::filesystem::path &dir) const;
+    void WriteIndex(const std::filesystem::path &dir, const std::map<std::string, IndexEntry> &index) const;
+
+    /**
+     * Directory and manifest modification times plus manifest size; an index
+     * entry is reused only while this is unchanged.  Empty if any is unreadable.
+     */
+    static std::string IndexStamp(const std::filesystem::path &path);
 
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "boot_packet_cache.hpp"
+
+#include "astra_log.hpp"
+
+std::shared_ptr<const BootPacketSequence> BootPacketCache::Get(const std::string &key, const Builder &build)
+{
+    ASTRA_LOG;
+
+    // Held across the build: devices arriving meanwhile need the same packets
+    // and would only repeat the work.
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_sequences.find(key);
+    if (it != m_sequences.end()) {
+        return it->second;
+    }
+
+    auto sequence = std::make_shared<BootPacketSequence>();
+    if (!build(*sequence)) {
+        return nullptr;
+    }
+
+    size_t bytes = 0;
+    for (const auto &packet : *sequence) {
+        bytes += packet.header.size() + packet.payloadSize;
+    }
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Cached boot packets " << key << ": " << sequence->size()
+        << " packets, " << bytes << " bytes" << endLog;
+
+    m_sequences[key] = sequence;
+    return sequence;
+}
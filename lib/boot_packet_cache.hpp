@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** One write of a ROM boot handshake and the response expected after it. */
+struct BootPacket {
+    // Boot image file the packet carries, for status reports; empty for commands.
+    std::string imageName;
+    // Names the packet in error messages.
+    std::string description;
+    // Framing written ahead of the payload.
+    std::vector<uint8_t> header;
+    // Payload bytes, kept alive by payloadOwner: the shared file mapping or
+    // a copy read from disk.  Not copied into the packet.
+    const uint8_t *payload = nullptr;
+    size_t payloadSize = 0;
+    std::shared_ptr<const void> payloadOwner;
+    // Report send progress while writing (image payloads).
+    bool reportProgress = false;
+    bool waitForResponse = true;
+    bool rawResponse = false;
+    std::chrono::milliseconds timeout{5000};
+    // The device resets once it has this packet, so a disconnect is expected.
+    bool expectDisconnect = false;
+};
+
+using BootPacketSequence = std::vector<BootPacket>;
+
+/**
+ * Fully framed boot packet sequences, owned by the device manager.  Every
+ * device booted from the same boot image receives byte-identical packets, so
+ * each sequence is built once and the ROM handshake of later devices is only
+ * writes and response waits.
+ */
+class BootPacketCache {
+public:
+    using Builder = std::function<bool(BootPacketSequence &sequence)>;
+
+    /**
+     * Return the sequence cached under key, calling build to create it on
+     * first use.  Concurrent callers for a missing sequence wait for one build.
+     * @return nullptr if build fails; nothing is cached, so the next device retries.
+     */
+    std::shared_ptr<const BootPacketSequence> Get(const std::string &key, const Builder &build);
+
+private:
+    std::mutex m_mutex;
+    std::map<std::string, std::shared_ptr<const BootPacketSequence>> m_sequences;
+};
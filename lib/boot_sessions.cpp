@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "boot_sessions.hpp"
+
+void BootSessions::Record(const std::string &sessionUuid, const std::string &job)
+{
+    if (sessionUuid.empty() || job.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobBySession[sessionUuid] = job;
+}
+
+bool BootSessions::IsSessionOf(const std::string &sessionUuid, const std::string &job) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_jobBySession.find(sessionUuid);
+    return it != m_jobBySession.end() && !job.empty() && it->second == job;
+}
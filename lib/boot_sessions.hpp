@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * The session UUIDs the device manager wrote into uEnv.txt files, each with
+ * the job it booted the board for: its boot image, boot command and flash
+ * image.  Only a board reporting one of them as its serial#, for the same
+ * job, is known to be running that job's update script, so only such a
+ * board may skip its boot phase.
+ */
+class BootSessions {
+public:
+    /** Remember that sessionUuid was written into a uEnv.txt for job. */
+    void Record(const std::string &sessionUuid, const std::string &job);
+
+    /** True if sessionUuid was recorded, for job. */
+    bool IsSessionOf(const std::string &sessionUuid, const std::string &job) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::string> m_jobBySession;
+};
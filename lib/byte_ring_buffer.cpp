@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "byte_ring_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+ByteRingBuffer::ByteRingBuffer(size_t capacity) : m_buffer(std::max<size_t>(capacity, 1))
+{}
+
+void ByteRingBuffer::Grow(size_t minCapacity)
+{
+    size_t capacity = m_buffer.size();
+    while (capacity < minCapacity) {
+        capacity *= 2;
+    }
+
+    std::vector<uint8_t> buffer(capacity);
+    Peek(buffer.data(), m_size);
+    m_buffer.swap(buffer);
+    m_head = 0;
+}
+
+void ByteRingBuffer::Write(const uint8_t *data, size_t size)
+{
+    if (m_size + size > m_buffer.size()) {
+        Grow(m_size + size);
+    }
+
+    // At most two copies: up to the end of the storage, then from its start.
+    const size_t tail = (m_head + m_size) % m_buffer.size();
+    const size_t first = std::min(size, m_buffer.size() - tail);
+    std::memcpy(m_buffer.data() + tail, data, first);
+    if (size > first) {
+        std::memcpy(m_buffer.data(), data + first, size - first);
+    }
+    m_size += size;
+}
+
+size_t ByteRingBuffer::Peek(uint8_t *data, size_t size) const
+{
+    size = std::min(size, m_size);
+
+    const size_t first = std::min(size, m_buffer.size() - m_head);
+    std::memcpy(data, m_buffer.data() + m_head, first);
+    if (size > first) {
+        std::memcpy(data + first, m_buffer.data(), size - first);
+    }
+    return size;
+}
+
+size_t ByteRingBuffer::Read(uint8_t *data, size_t size)
+{
+    size = Peek(data, size);
+    m_head = (m_head + size) % m_buffer.size();
+    m_size -= size;
+    if (m_size == 0) {
+        m_head = 0;
+    }
+    return size;
+}
+
+size_t ByteRingBuffer::Discard(size_t size)
+{
+    size = std::min(size, m_size);
+    m_head = (m_head + size) % m_buffer.size();
+    m_size -= size;
+    if (m_size == 0) {
+        m_head = 0;
+    }
+    return size;
+}
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * FIFO of bytes in one contiguous allocation, filled and drained with bulk
+ * copies.  The capacity doubles when a write does not fit, so a reader that
+ * falls behind never loses data.  Not thread safe; callers hold their own lock.
+ */
+class ByteRingBuffer {
+public:
+    explicit ByteRingBuffer(size_t capacity = 4096);
+
+    size_t Size() const { return m_size; }
+    bool Empty() const { return m_size == 0; }
+    void Clear() { m_head = 0; m_size = 0; }
+
+    void Write(const uint8_t *data, size_t size);
+
+    /** Copy up to size bytes from the front without consuming them.  @return bytes copied. */
+    size_t Peek(uint8_t *data, size_t size) const;
+
+    /** Move up to size bytes from the front into data.  @return bytes read. */
+    size_t Read(uint8_t *data, size_t size);
+
+    /** Drop up to size bytes from the front.  @return bytes dropped. */
+    size_t Discard(size_t size);
+
+private:
+    void Grow(size_t minCapacity);
+
+    std::vector<uint8_t> m_buffer;
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
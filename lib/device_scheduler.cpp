@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "device_scheduler.hpp"
+
+#include <algorithm>
+
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+DeviceScheduler::TransferSlot::~TransferSlot()
+{
+    m_scheduler->ReleaseTransferSlot(m_hub, m_memoryBytes);
+}
+
+DeviceScheduler::DeviceScheduler(size_t maxActiveTransfers, size_t maxTransfersPerHub)
+    : m_maxActiveTransfers(maxActiveTransfers), m_maxTransfersPerHub(maxTransfersPerHub)
+{}
+
+DeviceScheduler::~DeviceScheduler()
+{
+    JoinAll(std::chrono::milliseconds(0));
+}
+
+void DeviceScheduler::Spawn(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(m_workerState->mutex);
+    ReapFinishedLocked();
+
+    Worker worker;
+    worker.done = std::make_shared<bool>(false);
+    worker.thread = ThreadPolicy::Start(THREAD_ROLE_TRANSFER, "astra-device", [state = m_workerState, done = worker.done, task = std::move(task)]() {
+        task();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        *done = true;
+        state->cv.notify_all();
+    });
+    m_workers.push_back(std::move(worker));
+}
+
+void DeviceScheduler::ReapFinishedLocked()
+{
+    for (auto it = m_workers.begin(); it != m_workers.end();) {
+        if (*it->done) {
+            it->thread.join();
+            it = m_workers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DeviceScheduler::JoinAll(std::chrono::milliseconds timeout)
+{
+    ASTRA_LOG;
+
+    std::vector<Grant> refused;
+    {
+        std::lock_guard<std::mutex> lock(m_slotMutex);
+        m_shuttingDown = true;
+        for (auto &waiter : m_waiters) {
+            refused.emplace_back(std::move(waiter.granted), nullptr);
+        }
+        m_waiters.clear();
+    }
+    RunGrants(refused);
+
+    std::unique_lock<std::mutex> lock(m_workerState->mutex);
+    const std::thread::id self = std::this_thread::get_id();
+    m_workerState->cv.wait_for(lock, timeout, [this, self]() {
+        return std::all_of(m_workers.begin(), m_workers.end(), [self](const Worker &worker) {
+            return *worker.done || worker.thread.get_id() == self;
+        });
+    });
+
+    for (auto &worker : m_workers) {
+        if (*worker.done) {
+            worker.thread.join();
+        } else {
+            // Still running (or this is the calling thread): let it finish on its own.
+            if (worker.thread.get_id() != self) {
+                log(ASTRA_LOG_LEVEL_WARNING) << "Device thread still running at shutdown, detaching" << endLog;
+            }
+            worker.thread.detach();
+        }
+    }
+    m_workers.clear();
+}
+
+std::string DeviceScheduler::HubFromUSBPath(const std::string &usbPath)
+{
+    const size_t dash = usbPath.find('-');
+    if (dash == 0 || dash == std::string::npos ||
+        usbPath.find_first_not_of("0123456789") != dash ||
+        usbPath.find_first_not_of("0123456789.", dash + 1) != std::string::npos)
+    {
+        return "";
+    }
+
+    const size_t lastDot = usbPath.rfind('.');
+    if (lastDot == std::string::npos || lastDot < dash) {
+        return usbPath.substr(0, dash);
+    }
+    return usbPath.substr(0, lastDot);
+}
+
+void DeviceScheduler::SetMemoryBudget(uint64_t budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+    m_memoryBudget = budgetBytes;
+}
+
+bool DeviceScheduler::HasCapacityLocked(const std::string &hub, uint64_t memoryBytes) const
+{
+    if (m_maxActiveTransfers > 0 && m_activeTransfers >= m_maxActiveTransfers) {
+        return false;
+    }
+    // Oversized requests still run once nothing else holds a slot.
+    if (m_memoryBudget > 0 && m_activeTransfers > 0 && m_memoryInUse + memoryBytes > m_memoryBudget) {
+        return false;
+    }
+    if (m_maxTransfersPerHub == 0 || hub.empty()) {
+        return true;
+    }
+    auto it = m_hubs.find(hub);
+    return it == m_hubs.end() || it->second.active < m_maxTransfersPerHub;
+}
+
+uint64_t DeviceScheduler::RequestTransferSlot(const std::string &deviceName, const std::string &usbPath,
+    uint64_t memoryBytes, SlotGranted granted)
+{
+    ASTRA_LOG;
+
+    const std::string hub = HubFromUSBPath(usbPath);
+
+    std::vector<Grant> grants;
+    uint64_t ticket = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_slotMutex);
+        if (m_shuttingDown) {
+            grants.emplace_back(std::move(granted), nullptr);
+        } else {
+            ticket = ++m_nextTicket;
+            m_waiters.push_back({ticket, deviceName, hub, memoryBytes, std::move(granted)});
+            GrantWaitersLocked(grants);
+
+            if (!m_waiters.empty() && m_waiters.back().ticket == ticket) {
+                log(ASTRA_LOG_LEVEL_INFO) << deviceName << " waiting for a transfer slot (" << m_activeTransfers
+                    << " active, " << (m_waiters.size() - 1) << " queued"
+                    << (hub.empty() ? "" : ", hub " + hub)
+                    << (m_memoryBudget == 0 ? "" : ", " + std::to_string(m_memoryInUse >> 20) + " of " +
+                        std::to_string(m_memoryBudget >> 20) + " MiB buffers in use") << ")" << endLog;
+            }
+        }
+    }
+    RunGrants(grants);
+
+    return ticket;
+}
+
+bool DeviceScheduler::CancelTransferSlotRequest(uint64_t ticket)
+{
+    std::vector<Grant> grants;
+    {
+        std::lock_guard<std::mutex> lock(m_slotMutex);
+        auto it = std::find_if(m_waiters.begin(), m_waiters.end(), [ticket](const Waiter &waiter) {
+            return waiter.ticket == ticket;
+        });
+        if (it == m_waiters.end()) {
+            return false;
+        }
+        m_waiters.erase(it);
+        GrantWaitersLocked(grants);
+    }
+    RunGrants(grants);
+
+    return true;
+}
+
+void DeviceScheduler::GrantWaitersLocked(std::vector<Grant> &grants)
+{
+    ASTRA_LOG;
+
+    // Each pass admits the earliest waiter whose hub, the station and the
+    // memory budget all have room; a later waiter on another hub may fit too.
+    for (;;) {
+        auto it = std::find_if(m_waiters.begin(), m_waiters.end(), [this](const Waiter &waiter) {
+            return HasCapacityLocked(waiter.hub, waiter.memoryBytes);
+        });
+        if (it == m_waiters.end()) {
+            return;
+        }
+
+        ++m_activeTransfers;
+        m_memoryInUse += it->memoryBytes;
+        HubState &hubState = m_hubs[it->hub];
+        if (hubState.active++ == 0) {
+            hubState.busySince = std::chrono::steady_clock::now();
+        }
+        ++hubState.devices;
+        log(ASTRA_LOG_LEVEL_DEBUG) << it->deviceName << " acquired transfer slot (" << m_activeTransfers << " active, hub '"
+            << it->hub << "' " << hubState.active << " active, " << it->memoryBytes << " buffer bytes)" << endLog;
+
+        grants.emplace_back(std::move(it->granted),
+            std::unique_ptr<TransferSlot>(new TransferSlot(this, it->hub, it->memoryBytes)));
+        m_waiters.erase(it);
+    }
+}
+
+void DeviceScheduler::RunGrants(std::vector<Grant> &grants)
+{
+    for (auto &grant : grants) {
+        grant.first(std::move(grant.second));
+    }
+    grants.clear();
+}
+
+void DeviceScheduler::TransferSlot::AddBytes(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_scheduler->m_slotMutex);
+    m_scheduler->m_hubs[m_hub].bytes += bytes;
+}
+
+void DeviceScheduler::ReleaseTransferSlot(const std::string &hub, uint64_t memoryBytes)
+{
+    std::vector<Grant> grants;
+    {
+        std::lock_guard<std::mutex> lock(m_slotMutex);
+        --m_activeTransfers;
+        m_memoryInUse -= memoryBytes;
+        HubState &hubState = m_hubs[hub];
+        if (--hubState.active == 0) {
+            hubState.busy += std::chrono::steady_clock::now() - hubState.busySince;
+        }
+        GrantWaitersLocked(grants);
+    }
+    RunGrants(grants);
+}
+
+std::vector<BusTransferStats> DeviceScheduler::GetBusTransferStats() const
+{
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<BusTransferStats> stats;
+    for (const auto &[hub, hubState] : m_hubs) {
+        if (hub.empty()) {
+            continue;
+        }
+        BusTransferStats hubStats;
+        hubStats.m_hub = hub;
+        hubStats.m_devices = hubState.devices;
+        hubStats.m_bytes = hubState.bytes;
+        auto busy = hubState.busy;
+        if (hubState.active > 0) {
+            busy += now - hubState.busySince;
+        }
+        hubStats.m_busySeconds = std::chrono::duration<double>(busy).count();
+        stats.push_back(hubStats);
+    }
+    return stats;
+}
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "astra_device.hpp"
+
+/**
+ * Owns the per-device session threads and limits how many devices may be in
+ * their bulk update phase at once, both overall and per USB hub.  Boot
+ * handshakes are never throttled; a device asks for a transfer slot only when
+ * it starts serving update images.  Waiters are admitted in arrival order,
+ * except that a device on an idle hub may pass one waiting for a busy hub so
+ * free bus bandwidth is not left unused.  An optional memory budget also
+ * caps the transfer buffers the admitted devices may hold between them.
+ */
+class DeviceScheduler {
+public:
+    /** Holds one transfer slot until destroyed. */
+    class TransferSlot {
+    public:
+        ~TransferSlot();
+
+        TransferSlot(const TransferSlot &) = delete;
+        TransferSlot &operator=(const TransferSlot &) = delete;
+
+        /** Count bytes sent while holding the slot towards its hub's throughput. */
+        void AddBytes(uint64_t bytes);
+
+    private:
+        friend class DeviceScheduler;
+        TransferSlot(DeviceScheduler *scheduler, const std::string &hub, uint64_t memoryBytes)
+            : m_scheduler(scheduler), m_hub(hub), m_memoryBytes(memoryBytes) {}
+
+        DeviceScheduler *m_scheduler;
+        std::string m_hub;
+        uint64_t m_memoryBytes;
+    };
+
+    /**
+     * @param maxActiveTransfers  Concurrent update phases allowed; 0 means unlimited.
+     * @param maxTransfersPerHub  Concurrent update phases allowed behind one
+     *                            hub or root port; 0 means unlimited.
+     */
+    explicit DeviceScheduler(size_t maxActiveTransfers, size_t maxTransfersPerHub = 0);
+    ~DeviceScheduler();
+
+    DeviceScheduler(const DeviceScheduler &) = delete;
+    DeviceScheduler &operator=(const DeviceScheduler &) = delete;
+
+    /** Run task on a new, tracked device thread.  Finished threads are joined here. */
+    void Spawn(std::function<void()> task);
+
+    /**
+     * Fail pending transfer slot requests, then wait up to timeout for the
+     * device threads to return and join them.  Threads still running after the
+     * timeout are detached so shutdown cannot hang on a stuck device.
+     */
+    void JoinAll(std::chrono::milliseconds timeout);
+
+    /**
+     * Limit the transfer buffers held by devices in their update phase to
+     * budgetBytes in total; 0 means unlimited.  Call before any device asks
+     * for a slot.
+     */
+    void SetMemoryBudget(uint64_t budgetBytes);
+
+    using SlotGranted = std::function<void(std::unique_ptr<TransferSlot> slot)>;
+
+    /**
+     * Ask for a transfer slot without waiting for it.  granted is called
+     * once a slot is free overall and on usbPath's hub, memoryBytes fit in
+     * what is left of the memory budget, and no earlier request could take
+     * it instead; a device needing more than the whole budget is admitted
+     * alone.  It is called with nullptr if the scheduler shuts down first.
+     * granted runs on whichever thread frees the slot, possibly before
+     * this returns, and must not call back into the scheduler.
+     * @return a ticket for CancelTransferSlotRequest().
+     */
+    uint64_t RequestTransferSlot(const std::string &deviceName, const std::string &usbPath,
+        uint64_t memoryBytes, SlotGranted granted);
+
+    /**
+     * Withdraw a request which has not been granted yet.  Its callback is
+     * not called.
+     * @return false if the slot was already granted (or refused).
+     */
+    bool CancelTransferSlotRequest(uint64_t ticket);
+
+    size_t GetMaxActiveTransfers() const { return m_maxActiveTransfers; }
+
+    /** @return accumulated update traffic for every hub seen so far. */
+    std::vector<BusTransferStats> GetBusTransferStats() const;
+
+    /**
+     * Hub that a libusb path ("<bus>-<port>.<port>...") hangs off: the path
+     * without its last port, or just the bus for a root port.  Returns an
+     * empty string for paths without topology (e.g. serial port names).
+     */
+    static std::string HubFromUSBPath(const std::string &usbPath);
+
+private:
+    // Shared with the threads so a detached straggler never touches a
+    // destroyed scheduler.
+    struct WorkerState {
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<bool> done;
+    };
+
+    struct Waiter {
+        uint64_t ticket;
+        std::string deviceName;
+        std::string hub;
+        uint64_t memoryBytes;
+        SlotGranted granted;
+    };
+
+    using Grant = std::pair<SlotGranted, std::unique_ptr<TransferSlot>>;
+
+    struct HubState {
+        size_t active = 0;
+        size_t devices = 0;
+        uint64_t bytes = 0;
+        std::chrono::steady_clock::duration busy{};
+        std::chrono::steady_clock::time_point busySince;
+    };
+
+    void ReleaseTransferSlot(const std::string &hub, uint64_t memoryBytes);
+    void ReapFinishedLocked();
+    bool HasCapacityLocked(const std::string &hub, uint64_t memoryBytes) const;
+    // Hand free slots to the earliest waiters which fit; call the grants
+    // with RunGrants() once the lock is dropped.
+    void GrantWaitersLocked(std::vector<Grant> &grants);
+    static void RunGrants(std::vector<Grant> &grants);
+
+    const size_t m_maxActiveTransfers;
+    const size_t m_maxTransfersPerHub;
+
+    std::shared_ptr<WorkerState> m_workerState = std::make_shared<WorkerState>();
+    std::list<Worker> m_workers;
+
+    mutable std::mutex m_slotMutex;
+    size_t m_activeTransfers = 0;
+    uint64_t m_memoryBudget = 0;
+    uint64_t m_memoryInUse = 0;
+    uint64_t m_nextTicket = 0;
+    std::deque<Waiter> m_waiters;
+    std::map<std::string, HubState> m_hubs;
+    bool m_shuttingDown = false;
+};
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2025 Synaptics Incorporated
 
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
@@ -9,6 +10,7 @@
 
 #include "image.hpp"
 #include "emmc_flash_image.hpp"
+#include "flash_image_bundle.hpp"
 #include "astra_log.hpp"
 
 int EmmcFlashImage::Load()
@@ -21,7 +23,9 @@ int EmmcFlashImage::Load()
         m_imagePath.erase(m_imagePath.size() - 1);
     }
 
-    if (std::filesystem::exists(m_imagePath) && std::filesystem::is_directory(m_imagePath)) {
+    if (m_bundle) {
+        LoadBundle();
+    } else if (std::filesystem::exists(m_imagePath) && std::filesystem::is_directory(m_imagePath)) {
         std::string directoryName = std::filesystem::path(m_imagePath).filename().string();
         m_flashCommand = "l2emmc " + directoryName;
         if (m_resetWhenComplete) {
@@ -31,12 +35,14 @@ int EmmcFlashImage::Load()
             log(ASTRA_LOG_LEVEL_DEBUG) << "Found file: " << entry.path() << endLog;
             std::string filename = entry.path().filename().string();
             if ((filename.find("emmc") != std::string::npos) ||
-                (filename.find("subimg") != std::string::npos))
+                (filename.find("subimg") != std::string::npos) ||
+                (entry.path().extension() == ".simg"))
             {
                 m_images.push_back(std::move(Image(entry.path().string(), ASTRA_IMAGE_TYPE_UPDATE_EMMC)));
             }
             // TAG-- files are handled separately by DetectChipFromTagFile() below.
         }
+        ApplyManifestImageProperties();
     }
 
 
@@ -56,24 +62,104 @@ int EmmcFlashImage::Load()
     }
     ParseEmmcImageList();
 
+    // Delta and verified updates need a digest of every image; those the
+    // manifest does not give come from the image index, as do the uniform
+    // blocks of raw images.
+    StartPreprocessing();
+
     return ret;
 }
 
+void EmmcFlashImage::ApplyManifestImageProperties()
+{
+    ASTRA_LOG;
+
+    if (!m_manifestMaps) {
+        return;
+    }
+
+    for (auto &image : m_images) {
+        const std::string filename = std::filesystem::path(image.GetPath()).filename().string();
+        for (const auto &manifestMap : *m_manifestMaps) {
+            auto typeIt = manifestMap.find("type");
+            auto fileIt = manifestMap.find("image_file");
+            if (typeIt == manifestMap.end() || typeIt->second != "image" || fileIt == manifestMap.end()
+                || (fileIt->second != filename && fileIt->second != image.GetName()))
+            {
+                continue;
+            }
+
+            // gzip only records the uncompressed size modulo 4 GiB, so the
+            // manifest can supply it for compressed subimages.
+            auto sizeIt = manifestMap.find("uncompressed_size");
+            if (sizeIt != manifestMap.end() && image.IsCompressed()) {
+                try {
+                    image.SetUncompressedSize(std::stoull(sizeIt->second, nullptr, 0));
+                } catch (const std::exception &) {
+                    log(ASTRA_LOG_LEVEL_WARNING) << "Invalid uncompressed_size for " << filename << ": "
+                        << sizeIt->second << endLog;
+                }
+            }
+
+            auto digestIt = manifestMap.find("sha256");
+            if (digestIt != manifestMap.end()) {
+                std::string digest = digestIt->second;
+                std::transform(digest.begin(), digest.end(), digest.begin(), ::tolower);
+                image.SetDigest(digest);
+            }
+            break;
+        }
+    }
+}
+
+void EmmcFlashImage::LoadBundle()
+{
+    ASTRA_LOG;
+
+    // U-Boot is told the directory the bundle was packed from, since that is
+    // the name the images were built for.
+    std::string directoryName = std::filesystem::path(m_imagePath).stem().string();
+    auto directoryIt = m_bundle->GetFields().find("directory");
+    if (directoryIt != m_bundle->GetFields().end() && !directoryIt->second.empty()) {
+        directoryName = directoryIt->second;
+    }
+    m_flashCommand = "l2emmc " + directoryName;
+    if (m_resetWhenComplete) {
+        m_flashCommand += m_resetCommand;
+    }
+
+    for (const auto &entry : m_bundle->GetEntries()) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Found bundled image: " << entry.m_name << endLog;
+        Image image((std::filesystem::path(m_imagePath) / entry.m_name).string(), ASTRA_IMAGE_TYPE_UPDATE_EMMC);
+        image.SetFileSlice(m_bundle->GetPath(), entry.m_offset);
+        image.SetMapping(m_bundle->GetView(entry));
+        image.SetDigest(entry.m_digest);
+        image.Load();
+        m_images.push_back(std::move(image));
+    }
+}
+
 void EmmcFlashImage::ParseEmmcImageList()
 {
     ASTRA_LOG;
 
-    std::string emmcPartImagePath;
+    std::stringstream file;
     for (const auto& image : m_images) {
         if (image.GetName() == "emmc_image_list") {
-            emmcPartImagePath = image.GetPath();
+            if (image.IsFileSlice() && image.GetMappedData() != nullptr) {
+                file.write(reinterpret_cast<const char *>(image.GetMappedData()),
+                    static_cast<std::streamsize>(image.GetSize()));
+            } else {
+                std::ifstream listFile(image.GetPath());
+                file << listFile.rdbuf();
+            }
             break;
         }
     }
 
-    std::ifstream file(emmcPartImagePath);
     std::string line;
     std::string lastEntryName;
+    m_imageOrder.clear();
 
     while (std::getline(file, line)) {
         std::istringstream iss(line);
@@ -85,6 +171,7 @@ void EmmcFlashImage::ParseEmmcImageList()
                 // When this is the final operation, waiting for a image request will cause a timeout and
                 // incorrectly report a failure.
                 lastEntryName = name;
+                m_imageOrder.push_back(name);
             }
         }
     }
@@ -19,5 +19,7 @@ public:
     int Load() override;
 
 private:
+    void ApplyManifestImageProperties();
+    void LoadBundle();
     void ParseEmmcImageList();
 };
\ No newline at end of file
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "event_executor.hpp"
+
+#include <algorithm>
+
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+EventExecutor::EventExecutor(size_t threadCount)
+{
+    ASTRA_LOG;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.push_back(ThreadPolicy::Start(THREAD_ROLE_USB, "astra-executor", &EventExecutor::WorkerThread, this));
+    }
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Event executor started with " << threadCount << " threads" << endLog;
+}
+
+EventExecutor::~EventExecutor()
+{
+    ASTRA_LOG;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto &thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void EventExecutor::Post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+EventExecutor::TimerId EventExecutor::PostAfter(std::chrono::steady_clock::duration delay, std::function<void()> task)
+{
+    const auto deadline = std::chrono::steady_clock::now() + delay;
+    TimerId id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = m_nextTimerId++;
+        m_timers.emplace(TimerKey(deadline, id), std::move(task));
+        m_timerDeadlines.emplace(id, deadline);
+    }
+    // Every worker may be waiting on a later deadline.
+    m_cv.notify_all();
+    return id;
+}
+
+bool EventExecutor::CancelTimer(TimerId id)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_timerDeadlines.find(id);
+    if (it != m_timerDeadlines.end()) {
+        m_timers.erase(TimerKey(it->second, id));
+        m_timerDeadlines.erase(it);
+        return true;
+    }
+    m_timerDoneCV.wait(lock, [this, id] { return m_runningTimers.count(id) == 0; });
+    return false;
+}
+
+void EventExecutor::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        if (m_tasks.empty() && !m_timers.empty() && !m_stop) {
+            const auto deadline = m_timers.begin()->first.first;
+            if (std::chrono::steady_clock::now() < deadline) {
+                m_cv.wait_until(lock, deadline);
+                continue;
+            }
+
+            // Due: run it as a task of its own so CancelTimer() can wait for it.
+            auto timer = m_timers.begin();
+            const TimerId id = timer->first.second;
+            std::function<void()> task = std::move(timer->second);
+            m_timers.erase(timer);
+            m_timerDeadlines.erase(id);
+            m_runningTimers.insert(id);
+            lock.unlock();
+            task();
+            lock.lock();
+            m_runningTimers.erase(id);
+            m_timerDoneCV.notify_all();
+            continue;
+        }
+
+        m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty() || !m_timers.empty(); });
+        if (m_tasks.empty()) {
+            if (m_stop) {
+                // Stopping, with everything posted already run.  Timers
+                // still pending are dropped.
+                break;
+            }
+            continue;
+        }
+
+        std::function<void()> task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * A small pool of threads, one per core unless told otherwise, owned by the
+ * device manager.  USB devices deliver their interrupt and disconnect
+ * callbacks on it, and each device serves its image requests as a task on
+ * it which is resumed by USB completions and timers instead of running on
+ * a thread of its own.  Tasks must not block: a task waiting on another
+ * task can stall the pool.
+ */
+class EventExecutor
+{
+public:
+    using TimerId = uint64_t;
+
+    /** @param threadCount  Number of threads; 0 uses one per core. */
+    explicit EventExecutor(size_t threadCount = 0);
+    ~EventExecutor();
+
+    EventExecutor(const EventExecutor &) = delete;
+    EventExecutor &operator=(const EventExecutor &) = delete;
+
+    /** Run task on one of the threads.  Tasks start in the order they were posted. */
+    void Post(std::function<void()> task);
+
+    /** Run task on one of the threads once delay has passed. */
+    TimerId PostAfter(std::chrono::steady_clock::duration delay, std::function<void()> task);
+
+    /**
+     * Drop a timer which has not run yet, or wait for it to return if it
+     * is running.  Must not be called from the timer's own task.
+     * @return true if the timer was dropped before it ran.
+     */
+    bool CancelTimer(TimerId id);
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+private:
+    void WorkerThread();
+
+    using TimerKey = std::pair<std::chrono::steady_clock::time_point, TimerId>;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_timerDoneCV;
+    std::deque<std::function<void()>> m_tasks;
+    std::map<TimerKey, std::function<void()>> m_timers;
+    std::map<TimerId, std::chrono::steady_clock::time_point> m_timerDeadlines;
+    std::set<TimerId> m_runningTimers;
+    TimerId m_nextTimerId = 1;
+    bool m_stop = false;
+    std::vector<std::thread> m_threads;
+};
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+#include <cstring>
+
+#include "fastboot_batch.hpp"
+
+namespace {
+
+void WriteU32LE(uint8_t *p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+uint32_t ReadU32LE(const uint8_t *p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+        (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+} // namespace
+
+size_t FastbootBatch::GetEncodedSize(const std::vector<size_t> &payloadSizes)
+{
+    size_t size = kHeaderSize + payloadSizes.size() * kEntrySize;
+    for (size_t payloadSize : payloadSizes) {
+        size = Align(size) + payloadSize;
+    }
+    return size;
+}
+
+std::vector<uint8_t> FastbootBatch::Encode(const std::vector<Entry> &entries)
+{
+    std::vector<size_t> payloadSizes;
+    for (const auto &entry : entries) {
+        payloadSizes.push_back(entry.m_data.size());
+    }
+
+    std::vector<uint8_t> batch(GetEncodedSize(payloadSizes), 0);
+    std::memcpy(batch.data(), kMagic, sizeof(kMagic));
+    WriteU32LE(&batch[8], kVersion);
+    WriteU32LE(&batch[12], static_cast<uint32_t>(entries.size()));
+
+    size_t offset = kHeaderSize + entries.size() * kEntrySize;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry &entry = entries[i];
+        uint8_t *tocEntry = &batch[kHeaderSize + i * kEntrySize];
+        offset = Align(offset);
+
+        std::memcpy(tocEntry, entry.m_name.data(), std::min(entry.m_name.size(), kMaxNameLength));
+        WriteU32LE(tocEntry + kMaxNameLength + 1, static_cast<uint32_t>(offset));
+        WriteU32LE(tocEntry + kMaxNameLength + 5, static_cast<uint32_t>(entry.m_data.size()));
+        if (!entry.m_data.empty()) {
+            std::memcpy(&batch[offset], entry.m_data.data(), entry.m_data.size());
+        }
+        offset += entry.m_data.size();
+    }
+
+    return batch;
+}
+
+bool FastbootBatch::DecodeNames(const uint8_t *data, size_t size, std::vector<std::string> &names)
+{
+    if (size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0 || ReadU32LE(data + 8) != kVersion) {
+        return false;
+    }
+
+    const size_t count = ReadU32LE(data + 12);
+    if (count > (size - kHeaderSize) / kEntrySize) {
+        return false;
+    }
+
+    names.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *tocEntry = data + kHeaderSize + i * kEntrySize;
+        const uint64_t end = static_cast<uint64_t>(ReadU32LE(tocEntry + kMaxNameLength + 1)) +
+            ReadU32LE(tocEntry + kMaxNameLength + 5);
+        if (end > size) {
+            return false;
+        }
+        const char *name = reinterpret_cast<const char *>(tocEntry);
+        names.emplace_back(name, strnlen(name, kMaxNameLength));
+    }
+
+    return true;
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Several small images staged as one fastboot download, so a batch pays the
+ * stage request, download and fb_exit round trips once.  The U-Boot staging
+ * script reports the layout version it unpacks as getvar:fb_batch.
+ *
+ * Layout, all integers little-endian:
+ *   header    "ASTRABAT", u32 version, u32 entry count
+ *   entries   char name[56] (NUL padded), u32 offset, u32 size
+ *   payloads  at the offsets given, each aligned to kPayloadAlignment
+ */
+class FastbootBatch
+{
+public:
+    struct Entry
+    {
+        std::string m_name;
+        std::vector<uint8_t> m_data;
+    };
+
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kMaxNameLength = 55;
+
+    /** Size of a batch whose payloads have the given sizes. */
+    static size_t GetEncodedSize(const std::vector<size_t> &payloadSizes);
+
+    static std::vector<uint8_t> Encode(const std::vector<Entry> &entries);
+
+    /** Image names listed in a batch, or false if data does not hold one. */
+    static bool DecodeNames(const uint8_t *data, size_t size, std::vector<std::string> &names);
+
+private:
+    static constexpr char kMagic[8] = {'A', 'S', 'T', 'R', 'A', 'B', 'A', 'T'};
+    static constexpr size_t kHeaderSize = 16;
+    static constexpr size_t kEntrySize = 64;
+    static constexpr size_t kPayloadAlignment = 64;
+
+    static size_t Align(size_t offset)
+    {
+        return (offset + kPayloadAlignment - 1) / kPayloadAlignment * kPayloadAlignment;
+    }
+};
@@ -3,14 +3,18 @@
 
 #include "fastboot_device.hpp"
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
 
 #include "astra_log.hpp"
+#include "sparse_image.hpp"
 
 FastBootDevice::FastBootDevice(USBDevice *usbDevice)
     : m_usbDevice(usbDevice)
@@ -219,8 +223,124 @@ bool FastBootDevice::GetVar(const std::string &name, std::string &value, int tim
     }
 }
 
+namespace {
+
+// Lets the blocking Stage*() calls wait for their transfer's resumes.
+class ResumeSignal {
+public:
+    std::function<void()> Callback()
+    {
+        return [this]() {
+            // Notify under the lock: the waiter may return and destroy this
+            // as soon as it sees m_resumed.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_resumed = true;
+            m_cv.notify_one();
+        };
+    }
+
+    bool Run(FastBootDevice::Transfer *transfer)
+    {
+        if (transfer == nullptr) {
+            return false;
+        }
+
+        int ret;
+        while ((ret = transfer->Continue()) == FastBootDevice::kTransferPending) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_resumed; });
+            m_resumed = false;
+        }
+        return ret == 0;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_resumed = false;
+};
+
+} // namespace
+
 bool FastBootDevice::StageFile(const std::string &path,
     std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ResumeSignal signal;
+    return signal.Run(StartStageFile(path, signal.Callback(), std::move(progressCb), timeoutMs).get());
+}
+
+bool FastBootDevice::StageStream(size_t size, ReadFunction readFn,
+    std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ResumeSignal signal;
+    return signal.Run(StartStageStream(size, std::move(readFn), signal.Callback(), std::move(progressCb), timeoutMs).get());
+}
+
+bool FastBootDevice::StageData(const uint8_t *data, size_t size,
+    std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ResumeSignal signal;
+    return signal.Run(StartStageData(data, size, signal.Callback(), std::move(progressCb), timeoutMs).get());
+}
+
+bool FastBootDevice::StageSparseFile(const std::string &path,
+    std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ResumeSignal signal;
+    return signal.Run(StartStageSparseFile(path, signal.Callback(), std::move(progressCb), timeoutMs).get());
+}
+
+bool FastBootDevice::StageSparseData(const std::string &path, uint64_t offset, const uint8_t *data, size_t size,
+    std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ResumeSignal signal;
+    return signal.Run(StartStageSparseData(path, offset, data, size, signal.Callback(), std::move(progressCb),
+        timeoutMs).get());
+}
+
+bool FastBootDevice::StageSparse(const SparseImage &sparse,
+    std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ResumeSignal signal;
+    return signal.Run(StartStageSparse(sparse, signal.Callback(), std::move(progressCb), timeoutMs).get());
+}
+
+size_t FastBootDevice::GetMaxDownloadSize()
+{
+    ASTRA_LOG;
+
+    if (m_maxDownloadSizeQueried) {
+        return m_maxDownloadSize;
+    }
+    m_maxDownloadSizeQueried = true;
+
+    std::string value;
+    if (!GetVar("max-download-size", value)) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: max-download-size not reported" << endLog;
+        return 0;
+    }
+
+    try {
+        // Reported as hex ("0x...") by most bootloaders, decimal by some.
+        m_maxDownloadSize = static_cast<size_t>(std::stoull(value, nullptr, 0));
+    } catch (const std::exception &) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "FastBootDevice: invalid max-download-size: " << value << endLog;
+        m_maxDownloadSize = 0;
+    }
+
+    return m_maxDownloadSize;
+}
+
+std::unique_ptr<FastBootDevice::Transfer> FastBootDevice::StartGetVar(const std::string &name,
+    std::function<void()> resume, int timeoutMs)
+{
+    std::unique_ptr<Transfer> transfer(new Transfer(this, std::move(resume), timeoutMs));
+    transfer->m_command = "getvar:" + name;
+    return transfer;
+}
+
+std::unique_ptr<FastBootDevice::Transfer> FastBootDevice::StartStageFile(const std::string &path,
+    std::function<void()> resume, std::function<void(size_t, size_t)> progressCb, int timeoutMs)
 {
     ASTRA_LOG;
 
@@ -230,76 +350,382 @@ bool FastBootDevice::StageFile(const std::string &path,
     if (ec) {
         log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: cannot stat file: " << path
             << " (" << ec.message() << ")" << endLog;
-        return false;
+        return nullptr;
     }
 
-    // Send download:<size> command
-    std::ostringstream cmdStream;
-    cmdStream << "download:" << std::setw(8) << std::setfill('0') << std::hex << fileSize;
-    const std::string downloadCmd = cmdStream.str();
-
-    uint32_t acceptedSize = 0;
-    const std::string result = ExecuteCommand(downloadCmd, acceptedSize, timeoutMs);
-    if (result != "DATA") {
-        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: download command failed (result=" << result << ")" << endLog;
-        return false;
+    auto file = std::make_shared<std::ifstream>(path, std::ios::binary);
+    if (!*file) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: cannot open file: " << path << endLog;
+        return nullptr;
     }
 
-    log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: device accepted download of " << acceptedSize << " bytes" << endLog;
+    std::unique_ptr<Transfer> transfer = StartStageStream(static_cast<size_t>(fileSize),
+        [file](uint8_t *data, size_t size) {
+            file->read(reinterpret_cast<char *>(data), static_cast<std::streamsize>(size));
+            return static_cast<int>(file->gcount());
+        }, std::move(resume), std::move(progressCb), timeoutMs);
+    transfer->m_description = path;
+    return transfer;
+}
 
-    // Stream the file in chunks
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
-        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: cannot open file: " << path << endLog;
-        return false;
-    }
+void FastBootDevice::AddStreamDownload(Transfer &transfer, size_t size, ReadFunction readFn)
+{
+    // Chunks are read straight into the buffers from
+    // USBDevice::AcquireWriteBuffer(), so data is copied only once.
+    transfer.m_downloads.push_back({size, [this, readFn = std::move(readFn)](size_t chunkSize) {
+        ASTRA_LOG;
 
-    std::vector<uint8_t> chunk(kDownloadChunkSize);
-    size_t totalSent = 0;
-    const size_t total = static_cast<size_t>(fileSize);
+        uint8_t *buffer = m_usbDevice->AcquireWriteBuffer(chunkSize);
+        if (buffer == nullptr) {
+            return -1;
+        }
 
-    while (totalSent < total) {
-        const size_t toRead = std::min(kDownloadChunkSize, total - totalSent);
-        file.read(reinterpret_cast<char *>(chunk.data()), static_cast<std::streamsize>(toRead));
-        const auto bytesRead = static_cast<size_t>(file.gcount());
-        if (bytesRead == 0) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: premature end of file: " << path << endLog;
-            return false;
+        const int length = readFn(buffer, chunkSize);
+        if (length <= 0) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: premature end of download data" << endLog;
+            m_usbDevice->CommitQueuedWrite(0);
+            return -1;
         }
 
-        int transferred = 0;
-        const int ret = m_usbDevice->Write(chunk.data(), bytesRead, &transferred);
-        if (ret < 0) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: file data write failed" << endLog;
-            return false;
+        if (m_usbDevice->CommitQueuedWrite(static_cast<size_t>(length)) < 0) {
+            return -1;
         }
+        return length;
+    }});
+}
+
+std::unique_ptr<FastBootDevice::Transfer> FastBootDevice::StartStageStream(size_t size, ReadFunction readFn,
+    std::function<void()> resume, std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    std::unique_ptr<Transfer> transfer(new Transfer(this, std::move(resume), timeoutMs));
+    AddStreamDownload(*transfer, size, std::move(readFn));
+    transfer->m_wireTotal = size;
+    transfer->m_progressCb = std::move(progressCb);
+    return transfer;
+}
 
-        totalSent += static_cast<size_t>(transferred);
-        if (progressCb) {
-            progressCb(totalSent, total);
+std::unique_ptr<FastBootDevice::Transfer> FastBootDevice::StartStageData(const uint8_t *data, size_t size,
+    std::function<void()> resume, std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    std::unique_ptr<Transfer> transfer(new Transfer(this, std::move(resume), timeoutMs));
+    // Chunks are queued straight from data without an intermediate copy.
+    transfer->m_downloads.push_back({size, [this, data, offset = size_t(0)](size_t chunkSize) mutable {
+        if (m_usbDevice->WriteQueued(data + offset, chunkSize) < 0) {
+            return -1;
         }
+        offset += chunkSize;
+        return static_cast<int>(chunkSize);
+    }});
+    transfer->m_wireTotal = size;
+    transfer->m_progressCb = std::move(progressCb);
+    return transfer;
+}
+
+std::unique_ptr<FastBootDevice::Transfer> FastBootDevice::StartStageSparseFile(const std::string &path,
+    std::function<void()> resume, std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ASTRA_LOG;
+
+    SparseImage sparse;
+    if (sparse.Parse(path) < 0) {
+        return nullptr;
     }
 
-    // Wait for final OKAY
-    std::string status;
-    std::string message;
-    // Use a generous timeout for the device to acknowledge the data
-    if (!ReadResponse(status, message, timeoutMs)) {
-        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: no response after data transfer" << endLog;
-        return false;
+    const size_t maxDownloadSize = GetMaxDownloadSize();
+    if (maxDownloadSize == 0 || sparse.GetFileSize() <= maxDownloadSize) {
+        return StartStageFile(path, std::move(resume), std::move(progressCb), timeoutMs);
     }
 
-    if (status != "OKAY") {
-        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: download not acknowledged: " << status
-            << " " << message << endLog;
-        return false;
+    return StartStageSparse(sparse, std::move(resume), std::move(progressCb), timeoutMs);
+}
+
+std::unique_ptr<FastBootDevice::Transfer> FastBootDevice::StartStageSparseData(const std::string &path,
+    uint64_t offset, const uint8_t *data, size_t size, std::function<void()> resume,
+    std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ASTRA_LOG;
+
+    SparseImage sparse;
+    if (sparse.Parse(path, offset, size) < 0) {
+        return nullptr;
+    }
+
+    const size_t maxDownloadSize = GetMaxDownloadSize();
+    if (maxDownloadSize == 0 || size <= maxDownloadSize) {
+        return StartStageData(data, size, std::move(resume), std::move(progressCb), timeoutMs);
+    }
+
+    return StartStageSparse(sparse, std::move(resume), std::move(progressCb), timeoutMs);
+}
+
+std::unique_ptr<FastBootDevice::Transfer> FastBootDevice::StartStageSparse(const SparseImage &sparse,
+    std::function<void()> resume, std::function<void(size_t, size_t)> progressCb, int timeoutMs)
+{
+    ASTRA_LOG;
+
+    const std::string &path = sparse.GetPath();
+    const size_t maxDownloadSize = GetMaxDownloadSize();
+    std::vector<SparseImage::Segment> segments = sparse.Split(maxDownloadSize);
+    if (segments.empty()) {
+        return nullptr;
     }
 
-    log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: stage complete for " << path
-        << " (" << totalSent << " bytes)" << endLog;
+    auto file = std::make_shared<std::ifstream>(path, std::ios::binary);
+    if (!*file) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: cannot open file: " << path << endLog;
+        return nullptr;
+    }
+
+    log(ASTRA_LOG_LEVEL_INFO) << "FastBootDevice: staging " << path << " as " << segments.size()
+        << " sparse segments (max-download-size " << maxDownloadSize << ")" << endLog;
+
+    std::unique_ptr<Transfer> transfer(new Transfer(this, std::move(resume), timeoutMs));
+    for (auto &segment : segments) {
+        const size_t segmentSize = segment.size;
+        transfer->m_wireTotal += segmentSize;
+
+        // Flatten the segment's generated headers and file ranges into one stream.
+        ReadFunction readSegment = [file, segment = std::move(segment), pieceIndex = size_t(0),
+                pieceOffset = size_t(0)](uint8_t *data, size_t size) mutable {
+            size_t filled = 0;
+            while (filled < size && pieceIndex < segment.pieces.size()) {
+                const SparseImage::Piece &piece = segment.pieces[pieceIndex];
+                const size_t pieceLength = (piece.fileLength > 0) ? piece.fileLength : piece.bytes.size();
+                const size_t count = std::min(size - filled, pieceLength - pieceOffset);
+                if (piece.fileLength > 0) {
+                    file->seekg(static_cast<std::streamoff>(piece.fileOffset + pieceOffset));
+                    if (!file->read(reinterpret_cast<char *>(data + filled), static_cast<std::streamsize>(count))) {
+                        return -1;
+                    }
+                } else {
+                    std::memcpy(data + filled, piece.bytes.data() + pieceOffset, count);
+                }
+                filled += count;
+                pieceOffset += count;
+                if (pieceOffset == pieceLength) {
+                    ++pieceIndex;
+                    pieceOffset = 0;
+                }
+            }
+            return static_cast<int>(filled);
+        };
+
+        AddStreamDownload(*transfer, segmentSize, std::move(readSegment));
+    }
+    transfer->m_description = path;
+    transfer->m_progressCb = std::move(progressCb);
+    return transfer;
+}
+
+bool FastBootDevice::Transfer::ReadPacket()
+{
+    ASTRA_LOG;
+
+    m_readResult = -1;
+    m_received = 0;
+    const int ret = m_device->m_usbDevice->ReadBulkAsync(m_packet, kRespBufferSize, m_timeoutMs,
+        [this](int result, int transferred) {
+            m_readResult = result;
+            m_received = transferred;
+            m_resume();
+        });
+    if (ret < 0) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: read response failed (ret=" << ret << ")" << endLog;
+        return false;
+    }
     return true;
 }
 
+int FastBootDevice::Transfer::Fail()
+{
+    ASTRA_LOG;
+
+    if (m_downloads.size() > 1) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: sparse segment " << (m_download + 1) << "/" << m_downloads.size()
+            << " failed for " << m_description << endLog;
+    } else if (!m_description.empty()) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: stage failed for " << m_description << endLog;
+    }
+
+    m_step = TRANSFER_STEP_DONE;
+    m_result = -1;
+    return m_result;
+}
+
+int FastBootDevice::Transfer::Continue()
+{
+    ASTRA_LOG;
+
+    USBDevice *usbDevice = m_device->m_usbDevice;
+
+    for (;;) {
+        switch (m_step) {
+        case TRANSFER_STEP_COMMAND: {
+            std::string command = m_command;
+            if (command.empty()) {
+                if (m_download == m_downloads.size()) {
+                    if (!m_description.empty()) {
+                        log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: stage complete for " << m_description
+                            << " (" << m_wireSent << " bytes in " << m_downloads.size() << " downloads)" << endLog;
+                    }
+                    m_step = TRANSFER_STEP_DONE;
+                    continue;
+                }
+                std::ostringstream cmdStream;
+                cmdStream << "download:" << std::setw(8) << std::setfill('0') << std::hex << m_downloads[m_download].size;
+                command = cmdStream.str();
+            }
+
+            if (command.size() > kCmdBufferSize) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: command too long: " << command.size() << endLog;
+                return Fail();
+            }
+
+            if (!usbDevice->PollWriteBuffer(m_resume)) {
+                return kTransferPending;
+            }
+            if (usbDevice->WriteQueued(reinterpret_cast<const uint8_t *>(command.data()), command.size()) < 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: send command failed: " << command << endLog;
+                return Fail();
+            }
+            log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: sent command: " << command << endLog;
+
+            m_step = TRANSFER_STEP_RESPONSE;
+            if (!ReadPacket()) {
+                return Fail();
+            }
+            return kTransferPending;
+        }
+
+        case TRANSFER_STEP_RESPONSE: {
+            // Collect how the command (or the data) write went first.
+            if (!usbDevice->PollQueuedWrites(m_resume)) {
+                return kTransferPending;
+            }
+            if (usbDevice->FlushQueuedWrites() < 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: send command failed" << endLog;
+                return Fail();
+            }
+
+            if (m_readResult < 0) {
+                // Logged at DEBUG: the device may have reset before
+                // answering (e.g. after fb_exit triggers a U-Boot reboot),
+                // and callers log the consequence.
+                log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: read response failed (ret=" << m_readResult << ")" << endLog;
+                if (m_dataSent) {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: no response after data transfer" << endLog;
+                }
+                return Fail();
+            }
+
+            if (m_received < 4) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: response too short: " << m_received << " bytes" << endLog;
+                return Fail();
+            }
+
+            m_packet[m_received] = '\0';
+            m_status = std::string(reinterpret_cast<char *>(m_packet), 4);
+            m_message = std::string(reinterpret_cast<char *>(m_packet + 4), static_cast<size_t>(m_received - 4));
+            log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: response status='" << m_status
+                << "' message='" << m_message << "'" << endLog;
+
+            if (m_status == "INFO") {
+                if (!m_downloads.empty()) {
+                    log(ASTRA_LOG_LEVEL_INFO) << "FastBootDevice INFO: " << m_message << endLog;
+                }
+                if (!ReadPacket()) {
+                    return Fail();
+                }
+                return kTransferPending;
+            }
+
+            if (m_downloads.empty()) {
+                m_step = TRANSFER_STEP_DONE;
+                continue;
+            }
+
+            if (!m_dataSent) {
+                if (m_status != "DATA") {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: download command failed (result=" << m_status
+                        << " " << m_message << ")" << endLog;
+                    return Fail();
+                }
+                log(ASTRA_LOG_LEVEL_DEBUG) << "FastBootDevice: device accepted download of " << m_message << " bytes" << endLog;
+                m_sent = 0;
+                m_step = TRANSFER_STEP_DATA;
+                continue;
+            }
+
+            if (m_status != "OKAY") {
+                log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: download not acknowledged: " << m_status
+                    << " " << m_message << endLog;
+                return Fail();
+            }
+            m_wireSent += m_downloads[m_download].size;
+            ++m_download;
+            m_dataSent = false;
+            m_step = TRANSFER_STEP_COMMAND;
+            continue;
+        }
+
+        case TRANSFER_STEP_DATA: {
+            Download &download = m_downloads[m_download];
+            while (m_sent < download.size) {
+                if (!usbDevice->PollWriteBuffer(m_resume)) {
+                    return kTransferPending;
+                }
+
+                const size_t chunkSize = std::min(m_device->m_downloadChunkSize, download.size - m_sent);
+                // Queue the chunk so the next one is prepared while this one transfers.
+                const int chunkLength = download.queueChunk(chunkSize);
+                if (chunkLength <= 0) {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: file data write failed" << endLog;
+                    m_step = TRANSFER_STEP_ABORT;
+                    break;
+                }
+
+                m_sent += static_cast<size_t>(chunkLength);
+                if (m_progressCb) {
+                    m_progressCb(m_wireSent + m_sent, m_wireTotal);
+                }
+            }
+            if (m_step == TRANSFER_STEP_DATA) {
+                m_step = TRANSFER_STEP_FLUSH;
+            }
+            continue;
+        }
+
+        case TRANSFER_STEP_FLUSH:
+            if (!usbDevice->PollQueuedWrites(m_resume)) {
+                return kTransferPending;
+            }
+            if (usbDevice->FlushQueuedWrites() < 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: file data write failed" << endLog;
+                return Fail();
+            }
+
+            // Wait for the final OKAY
+            m_dataSent = true;
+            m_step = TRANSFER_STEP_RESPONSE;
+            if (!ReadPacket()) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "FastBootDevice: no response after data transfer" << endLog;
+                return Fail();
+            }
+            return kTransferPending;
+
+        case TRANSFER_STEP_ABORT:
+            if (!usbDevice->PollQueuedWrites(m_resume)) {
+                return kTransferPending;
+            }
+            usbDevice->FlushQueuedWrites();
+            return Fail();
+
+        case TRANSFER_STEP_DONE:
+            return m_result;
+        }
+    }
+}
+
 bool FastBootDevice::Oem(const std::string &command, int timeoutMs)
 {
     ASTRA_LOG;
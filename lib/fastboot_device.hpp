@@ -6,10 +6,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "usb_device.hpp"
 
+class SparseImage;
+
 /**
  * FastBootDevice wraps a USBDevice that speaks the Android fastboot wire
  * protocol over bulk USB.  It does NOT own the USBDevice; the caller is
@@ -20,6 +25,17 @@
  */
 class FastBootDevice {
 public:
+    /**
+     * Reads up to size bytes into data.
+     * @return bytes read, 0 at end of data, or a negative value on error.
+     */
+    using ReadFunction = std::function<int(uint8_t *data, size_t size)>;
+
+    class Transfer;
+
+    /** Transfer::Continue() is waiting for the device. */
+    static constexpr int kTransferPending = 1;
+
     explicit FastBootDevice(USBDevice *usbDevice);
     ~FastBootDevice();
 
@@ -59,6 +75,116 @@ public:
         std::function<void(size_t, size_t)> progressCb = nullptr,
         int timeoutMs = 30000);
 
+    /**
+     * Download (stage) an in-memory buffer, e.g. a memory-mapped image.
+     * Chunks are queued straight from data without an intermediate copy.
+     *
+     * @param data        Buffer to send; must stay valid for the whole call.
+     * @param size        Number of bytes to send.
+     * @param progressCb  Optional progress callback(bytesSent, totalBytes).
+     * @param timeoutMs   Per-response timeout in milliseconds.
+     * @return true on success.
+     */
+    bool StageData(const uint8_t *data, size_t size,
+        std::function<void(size_t, size_t)> progressCb = nullptr,
+        int timeoutMs = 30000);
+
+    /**
+     * Download (stage) size bytes produced by readFn, e.g. a decompressing
+     * reader.  readFn fills the USB device's transfer buffers directly while
+     * earlier chunks are still queued on the bus.
+     *
+     * @param size        Number of bytes to send.
+     * @param readFn      Fills a buffer; returns bytes produced or -1.
+     * @param progressCb  Optional progress callback(bytesSent, totalBytes).
+     * @param timeoutMs   Per-response timeout in milliseconds.
+     * @return true on success.
+     */
+    bool StageStream(size_t size, ReadFunction readFn,
+        std::function<void(size_t, size_t)> progressCb = nullptr,
+        int timeoutMs = 30000);
+
+    /**
+     * Download (stage) an Android sparse image.  Files that fit the device's
+     * max-download-size are sent unchanged; larger files are re-sparsed into
+     * segments that each fit and are staged as successive downloads.
+     *
+     * @param path        Absolute path to the sparse image.
+     * @param progressCb  Optional progress callback(bytesSent, totalBytes)
+     *                    covering all segments.
+     * @param timeoutMs   Per-response timeout in milliseconds.
+     * @return true on success.
+     */
+    bool StageSparseFile(const std::string &path,
+        std::function<void(size_t, size_t)> progressCb = nullptr,
+        int timeoutMs = 30000);
+
+    /**
+     * As StageSparseFile(), for a sparse image size bytes long at offset of
+     * path, e.g. in a flash image bundle, which is mapped at data.  Images
+     * that fit max-download-size are sent from the mapping.
+     */
+    bool StageSparseData(const std::string &path, uint64_t offset, const uint8_t *data, size_t size,
+        std::function<void(size_t, size_t)> progressCb = nullptr,
+        int timeoutMs = 30000);
+
+    /**
+     * Download (stage) a parsed or generated sparse image, re-sparsed into
+     * segments that each fit max-download-size.  Data is read from the file
+     * the image describes.  Parameters as for StageSparseFile().
+     */
+    bool StageSparse(const SparseImage &sparse,
+        std::function<void(size_t, size_t)> progressCb = nullptr,
+        int timeoutMs = 30000);
+
+    /**
+     * Start "getvar:<name>" as a Transfer, e.g. for a variable the device
+     * answers only once it has a value or its own wait expires, such as
+     * "fb_command_wait:<ms>".  INFO packets sent while the device waits are
+     * skipped; the final status tells OKAY from a FAIL by a device which
+     * does not implement the variable.
+     *
+     * @param resume     Called whenever Continue() should run again.
+     * @param timeoutMs  Per-response timeout; must exceed any device-side wait.
+     */
+    std::unique_ptr<Transfer> StartGetVar(const std::string &name, std::function<void()> resume,
+        int timeoutMs = 5000);
+
+    /**
+     * Start the Stage*() call of the same name as a Transfer.  Anything the
+     * call needs up front (opening the file, max-download-size, splitting a
+     * sparse image) is done before returning; the data and the device's
+     * answers are waited for by Continue().  A data buffer must stay
+     * valid until the transfer finishes.
+     *
+     * @param resume  Called whenever Continue() should run again.
+     * @return the transfer, or nullptr if it could not be started.
+     */
+    std::unique_ptr<Transfer> StartStageFile(const std::string &path, std::function<void()> resume,
+        std::function<void(size_t, size_t)> progressCb = nullptr, int timeoutMs = 30000);
+    std::unique_ptr<Transfer> StartStageData(const uint8_t *data, size_t size, std::function<void()> resume,
+        std::function<void(size_t, size_t)> progressCb = nullptr, int timeoutMs = 30000);
+    std::unique_ptr<Transfer> StartStageStream(size_t size, ReadFunction readFn, std::function<void()> resume,
+        std::function<void(size_t, size_t)> progressCb = nullptr, int timeoutMs = 30000);
+    std::unique_ptr<Transfer> StartStageSparseFile(const std::string &path, std::function<void()> resume,
+        std::function<void(size_t, size_t)> progressCb = nullptr, int timeoutMs = 30000);
+    std::unique_ptr<Transfer> StartStageSparseData(const std::string &path, uint64_t offset, const uint8_t *data,
+        size_t size, std::function<void()> resume, std::function<void(size_t, size_t)> progressCb = nullptr,
+        int timeoutMs = 30000);
+    std::unique_ptr<Transfer> StartStageSparse(const SparseImage &sparse, std::function<void()> resume,
+        std::function<void(size_t, size_t)> progressCb = nullptr, int timeoutMs = 30000);
+
+    /**
+     * Query and cache the device's "max-download-size" variable.
+     * @return the limit in bytes, or 0 if the device does not report one.
+     */
+    size_t GetMaxDownloadSize();
+
+    /** Bytes queued per bulk write of a download; kDownloadChunkSize by default. */
+    void SetDownloadChunkSize(size_t chunkSize) { m_downloadChunkSize = chunkSize > 0 ? chunkSize : kDownloadChunkSize; }
+
+    static constexpr size_t kDownloadChunkSize = 4 * 1024 * 1024; // 4 MiB – fewer libusb round-trips per image
+
     /**
      * Send an OEM command ("oem <command>").
      * @return true if the device responds with OKAY.
@@ -95,10 +221,14 @@ private:
     bool m_opened = false;
     bool m_disconnected = false;
     std::function<void()> m_disconnectCallback;
+    bool m_maxDownloadSizeQueried = false;
+    size_t m_maxDownloadSize = 0;
+    size_t m_downloadChunkSize = kDownloadChunkSize;
 
     static constexpr size_t kCmdBufferSize = 64;
     static constexpr size_t kRespBufferSize = 64;
-    static constexpr size_t kDownloadChunkSize = 4 * 1024 * 1024; // 4 MiB – fewer libusb round-trips per image
+    /** Add a download of size bytes which readFn writes straight into the write buffers. */
+    void AddStreamDownload(Transfer &transfer, size_t size, ReadFunction readFn);
 
     /**
      * Send a raw ASCII fastboot command (no more than 64 bytes).
@@ -132,3 +262,69 @@ private:
 
     void USBEventHandler(USBDevice::USBEvent event, uint8_t *buf, size_t size);
 };
+
+/**
+ * A fastboot command and its response, or a stage of one or more downloads,
+ * driven by Continue() for callers which must not block, such as tasks on an
+ * EventExecutor.  Continue() runs until the transfer has to wait for the
+ * device and returns kTransferPending; the resume callback it was started
+ * with is then called once, from the USB transport's event thread, when
+ * Continue() should run again.  Continue() returns 0 once the device has
+ * answered the command, or acknowledged every download, and -1 on failure.
+ * A transfer must not be destroyed while a resume is still to come.
+ */
+class FastBootDevice::Transfer {
+public:
+    int Continue();
+
+    /** Final response once Continue() returned 0, e.g. "OKAY" or "FAIL". */
+    const std::string &GetStatus() const { return m_status; }
+    const std::string &GetMessage() const { return m_message; }
+
+private:
+    friend class FastBootDevice;
+
+    // One "download:" of a stage.  queueChunk queues up to chunkSize more
+    // bytes once a write buffer is free and returns the bytes it queued, or
+    // <= 0 on failure.
+    struct Download {
+        size_t size;
+        std::function<int(size_t chunkSize)> queueChunk;
+    };
+
+    enum Step {
+        TRANSFER_STEP_COMMAND,      // send the command, or the next download's
+        TRANSFER_STEP_RESPONSE,     // a response packet has been read
+        TRANSFER_STEP_DATA,         // queue the current download's data
+        TRANSFER_STEP_FLUSH,        // wait for the data to reach the device
+        TRANSFER_STEP_ABORT,        // wait for queued data after a failure
+        TRANSFER_STEP_DONE,
+    };
+
+    Transfer(FastBootDevice *device, std::function<void()> resume, int timeoutMs)
+        : m_device(device), m_resume(std::move(resume)), m_timeoutMs(timeoutMs) {}
+
+    bool ReadPacket();
+    int Fail();
+
+    FastBootDevice *m_device;
+    std::function<void()> m_resume;
+    int m_timeoutMs;
+    std::string m_command;                  // empty for a stage
+    std::string m_description;              // what a stage sends, for logs
+    std::vector<Download> m_downloads;
+    std::function<void(size_t, size_t)> m_progressCb;
+    Step m_step = TRANSFER_STEP_COMMAND;
+    int m_result = 0;
+    size_t m_download = 0;
+    bool m_dataSent = false;
+    size_t m_sent = 0;
+    size_t m_wireSent = 0;
+    size_t m_wireTotal = 0;
+
+    uint8_t m_packet[kRespBufferSize + 1] = {};
+    int m_readResult = 0;
+    int m_received = 0;
+    std::string m_status;
+    std::string m_message;
+};
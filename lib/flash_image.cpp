@@ -8,6 +8,9 @@
 #include <cctype>
 #include "flash_image.hpp"
 #include "astra_log.hpp"
+#include "flash_image_bundle.hpp"
+#include "image_index.hpp"
+#include "thread_policy.hpp"
 
 #include "emmc_flash_image.hpp"
 #include "spi_flash_image.hpp"
@@ -54,6 +57,14 @@ std::shared_ptr<FlashImage> FlashImage::FlashImageFactory(std::string imagePath,
 {
     ASTRA_LOG;
 
+    std::shared_ptr<const FlashImageBundle> bundle;
+    if (FlashImageBundle::IsBundle(imagePath)) {
+        bundle = FlashImageBundle::Open(imagePath);
+        if (!bundle) {
+            throw std::invalid_argument("Invalid flash image bundle " + imagePath);
+        }
+    }
+
     if (manifest == "") {
         manifest = imagePath + "/manifest.yaml";
     }
@@ -73,6 +84,16 @@ std::shared_ptr<FlashImage> FlashImage::FlashImageFactory(std::string imagePath,
     std::map<std::string, std::string> configMap = config;
     configMap["type"] = "config";
 
+    if (bundle) {
+        // A bundle carries its manifest settings; command line options still
+        // take precedence.
+        for (const auto &[key, value] : bundle->GetFields()) {
+            if (configMap.find(key) == configMap.end() && !value.empty()) {
+                configMap[key] = value;
+            }
+        }
+    }
+
     try {
         YAML::Node manifestNode = YAML::LoadFile(manifest);
 
@@ -80,7 +101,7 @@ std::shared_ptr<FlashImage> FlashImage::FlashImageFactory(std::string imagePath,
         // then have the command line options take precedence.
          for (YAML::const_iterator it = manifestNode.begin(); it != manifestNode.end(); ++it) {
             std::string key = it->first.as<std::string>();
-            const YAML::Node& value = it->second;
+            const YAML::Node value = it->second;
 
             if (configMap.find(key) == configMap.end()) {
                 if (value.IsScalar()) {
@@ -216,19 +237,73 @@ std::shared_ptr<FlashImage> FlashImage::FlashImageFactory(std::string imagePath,
         resetWhenComplete = configMap["reset"] == "enable";
     }
 
+    bool deltaUpdate = false;
+    if (configMap.find("delta") != configMap.end()) {
+        deltaUpdate = configMap["delta"] == "enable";
+    }
+
+    bool verifyUpdate = false;
+    if (configMap.find("verify") != configMap.end()) {
+        verifyUpdate = configMap["verify"] == "enable";
+    }
+
+    if (deltaUpdate && flashImageType == FLASH_IMAGE_TYPE_SPI && !SpiFlashImage::SupportsDeltaUpdate(chipName)) {
+        // The memory mapped flash commands of other chips cannot compare sectors.
+        throw std::invalid_argument("Delta SPI updates are only supported on SL2610 series chips");
+    }
+
+    std::shared_ptr<FlashImage> flashImage;
     switch (flashImageType) {
         case FLASH_IMAGE_TYPE_SPI:
-            return std::make_shared<SpiFlashImage>(imagePath, bootImage, chipName, boardName, secureBootVersion,
+            flashImage = std::make_shared<SpiFlashImage>(imagePath, bootImage, chipName, boardName, secureBootVersion,
                         memoryLayout, memoryDDRType, resetWhenComplete, std::move(manifestMaps));
+            break;
         case FLASH_IMAGE_TYPE_NAND:
-            return std::make_shared<NandFlashImage>(imagePath, bootImage, chipName, boardName, secureBootVersion,
+            flashImage = std::make_shared<NandFlashImage>(imagePath, bootImage, chipName, boardName, secureBootVersion,
                         memoryLayout, memoryDDRType, resetWhenComplete, std::move(manifestMaps));
+            break;
         case FLASH_IMAGE_TYPE_EMMC:
-            return std::make_shared<EmmcFlashImage>(imagePath, bootImage, chipName, boardName, secureBootVersion,
+            flashImage = std::make_shared<EmmcFlashImage>(imagePath, bootImage, chipName, boardName, secureBootVersion,
                 memoryLayout, memoryDDRType, resetWhenComplete, std::move(manifestMaps));
+            break;
         default:
             throw std::invalid_argument("Unknown FlashImageType");
     }
+
+    flashImage->SetDeltaUpdate(deltaUpdate);
+    flashImage->SetVerifyUpdate(verifyUpdate);
+    if (bundle) {
+        if (flashImageType != FLASH_IMAGE_TYPE_EMMC) {
+            throw std::invalid_argument("Flash image bundles hold eMMC images only");
+        }
+        flashImage->SetBundle(std::move(bundle));
+    }
+    return flashImage;
+}
+
+bool FlashImage::WriteBundle(const std::string &bundlePath, std::string &error) const
+{
+    return FlashImageBundle::Write(*this, bundlePath, error);
+}
+
+void FlashImage::StartPreprocessing()
+{
+    if (m_images.empty() || m_bundle) {
+        // A bundle's table of contents already holds every digest.
+        return;
+    }
+
+    // Images of one flash image share a directory.
+    const std::string directory = std::filesystem::path(m_images.front().GetPath()).parent_path().string();
+    const bool withDigests = m_deltaUpdate || m_verifyUpdate;
+    std::packaged_task<void()> preprocessing([this, directory, withDigests]() {
+        ImageIndex(directory).Apply(m_images, withDigests);
+    });
+    m_preprocessing = preprocessing.get_future().share();
+
+    // The destructor waits on m_preprocessing, which is ready once the task
+    // has run; the thread touches nothing of this image after that.
+    ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-preproc", std::move(preprocessing)).detach();
 }
 
 ChipDetectionResult DetectChipFromTagFile(const std::string& imagePath, const std::string& currentChipName)
@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "flash_image_bundle.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "astra_log.hpp"
+#include "flash_image.hpp"
+#include "image_store.hpp"
+#include "sha256.hpp"
+
+namespace {
+
+constexpr size_t kDigestSize = 64;
+
+void AppendU32LE(std::vector<uint8_t> &out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void AppendU64LE(std::vector<uint8_t> &out, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void AppendString(std::vector<uint8_t> &out, const std::string &value)
+{
+    AppendU32LE(out, static_cast<uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+uint64_t AlignUp(uint64_t value)
+{
+    return (value + FlashImageBundle::kAlignment - 1) / FlashImageBundle::kAlignment * FlashImageBundle::kAlignment;
+}
+
+// Bounds-checked reads from the mapped table of contents.
+class TocReader {
+public:
+    TocReader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+    bool ReadU32(uint32_t &value)
+    {
+        uint64_t wide = 0;
+        if (!ReadLE(4, wide)) {
+            return false;
+        }
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    bool ReadU64(uint64_t &value) { return ReadLE(8, value); }
+
+    bool ReadString(std::string &value)
+    {
+        uint32_t length = 0;
+        if (!ReadU32(length) || m_size - m_offset < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char *>(m_data + m_offset), length);
+        m_offset += length;
+        return true;
+    }
+
+private:
+    bool ReadLE(size_t bytes, uint64_t &value)
+    {
+        if (m_size - m_offset < bytes) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(m_data[m_offset + i]) << (8 * i);
+        }
+        m_offset += bytes;
+        return true;
+    }
+
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_offset = 0;
+};
+
+} // namespace
+
+bool FlashImageBundle::IsBundle(const std::string &path)
+{
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::array<char, sizeof(kMagic)> magic = {};
+    return file.read(magic.data(), magic.size()) && std::memcmp(magic.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+std::shared_ptr<const FlashImageBundle> FlashImageBundle::Open(const std::string &path)
+{
+    ASTRA_LOG;
+
+    std::shared_ptr<ImageMapping> mapping(new ImageMapping(path));
+    if (!mapping->Map()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<FlashImageBundle> bundle(new FlashImageBundle(path));
+    bundle->m_mapping = std::move(mapping);
+    if (!bundle->ReadTableOfContents()) {
+        return nullptr;
+    }
+
+    log(ASTRA_LOG_LEVEL_INFO) << "Opened flash image bundle " << path << ": " << bundle->m_entries.size()
+        << " images" << endLog;
+    return bundle;
+}
+
+bool FlashImageBundle::ReadTableOfContents()
+{
+    ASTRA_LOG;
+
+    const uint8_t *data = m_mapping->GetData();
+    const size_t size = m_mapping->GetSize();
+    if (size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Not a flash image bundle: " << m_path << endLog;
+        return false;
+    }
+
+    TocReader header(data + sizeof(kMagic), kHeaderSize - sizeof(kMagic));
+    uint32_t version = 0;
+    uint32_t alignment = 0;
+    uint32_t fieldCount = 0;
+    uint32_t entryCount = 0;
+    uint64_t tocSize = 0;
+    uint64_t fileSize = 0;
+    header.ReadU32(version);
+    header.ReadU32(alignment);
+    header.ReadU32(fieldCount);
+    header.ReadU32(entryCount);
+    header.ReadU64(tocSize);
+    header.ReadU64(fileSize);
+
+    if (version != kVersion) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Unsupported flash image bundle version " << version << ": " << m_path << endLog;
+        return false;
+    }
+    if (alignment == 0 || (alignment % kAlignment) != 0 || fileSize != size || tocSize > size - kHeaderSize) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Corrupt flash image bundle header: " << m_path << endLog;
+        return false;
+    }
+
+    TocReader toc(data + kHeaderSize, static_cast<size_t>(tocSize));
+    for (uint32_t i = 0; i < fieldCount; ++i) {
+        std::string key;
+        std::string value;
+        if (!toc.ReadString(key) || !toc.ReadString(value)) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Truncated flash image bundle fields: " << m_path << endLog;
+            return false;
+        }
+        m_fields[key] = value;
+    }
+
+    const uint64_t payloadStart = kHeaderSize + tocSize;
+    m_entries.reserve(entryCount);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        Entry entry;
+        if (!toc.ReadString(entry.m_name) || !toc.ReadU64(entry.m_offset) || !toc.ReadU64(entry.m_size) ||
+            !toc.ReadString(entry.m_digest))
+        {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Truncated flash image bundle entries: " << m_path << endLog;
+            return false;
+        }
+
+        // Images are named by the device, so a name is never a path.
+        if (entry.m_name.empty() || entry.m_name.find_first_of("/\\") != std::string::npos ||
+            (entry.m_offset % alignment) != 0 || entry.m_offset < payloadStart ||
+            entry.m_offset > size || entry.m_size > size - entry.m_offset)
+        {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Invalid flash image bundle entry " << i << " (" << entry.m_name << "): "
+                << m_path << endLog;
+            return false;
+        }
+        m_entries.push_back(std::move(entry));
+    }
+
+    return true;
+}
+
+std::shared_ptr<const ImageMapping> FlashImageBundle::GetView(const Entry &entry) const
+{
+    std::shared_ptr<ImageMapping> view(new ImageMapping(m_path + "/" + entry.m_name));
+    view->m_data = m_mapping->GetData() + entry.m_offset;
+    view->m_size = static_cast<size_t>(entry.m_size);
+    view->m_parent = m_mapping;
+    return view;
+}
+
+bool FlashImageBundle::Write(const FlashImage &flashImage, const std::string &bundlePath, std::string &error)
+{
+    ASTRA_LOG;
+
+    if (flashImage.GetFlashImageType() != FLASH_IMAGE_TYPE_EMMC) {
+        error = "Only eMMC flash images can be bundled";
+        return false;
+    }
+
+    const std::vector<Image> &images = flashImage.GetImages();
+    for (const Image &image : images) {
+        if (image.IsCompressed()) {
+            error = "Compressed image " + image.GetPath() + " cannot be bundled; decompress it first";
+            return false;
+        }
+    }
+
+    std::string directory = std::filesystem::path(flashImage.GetImagePath()).filename().string();
+    if (flashImage.GetBundle() != nullptr) {
+        auto it = flashImage.GetBundle()->GetFields().find("directory");
+        if (it != flashImage.GetBundle()->GetFields().end()) {
+            directory = it->second;
+        }
+    }
+
+    std::map<std::string, std::string> fields;
+    fields["directory"] = directory;
+    fields["image_type"] = "emmc";
+    fields["boot_image"] = flashImage.GetBootImageId();
+    fields["chip"] = flashImage.GetChipName();
+    fields["board"] = flashImage.GetBoardName();
+    fields["secure_boot"] = AstraSecureBootVersionToString(flashImage.GetSecureBootVersion());
+    fields["memory_layout"] = AstraMemoryLayoutToString(flashImage.GetMemoryLayout());
+    fields["ddr_type"] = AstraMemoryDDRTypeToString(flashImage.GetMemoryDDRType());
+
+    // The digests are only known once the images are copied, so the table
+    // is written with empty ones first and again at the end.
+    std::vector<Entry> entries;
+    uint64_t tocSize = 0;
+    for (const auto &[key, value] : fields) {
+        tocSize += 8 + key.size() + value.size();
+    }
+    for (const Image &image : images) {
+        Entry entry;
+        entry.m_name = image.GetName();
+        std::error_code ec;
+        entry.m_size = image.IsFileSlice() ? image.GetSize() : std::filesystem::file_size(image.GetPath(), ec);
+        if (ec) {
+            error = "Cannot stat " + image.GetPath() + ": " + ec.message();
+            return false;
+        }
+        entry.m_digest.assign(kDigestSize, '0');
+        tocSize += 4 + entry.m_name.size() + 16 + 4 + kDigestSize;
+        entries.push_back(std::move(entry));
+    }
+
+    uint64_t offset = AlignUp(kHeaderSize + tocSize);
+    for (Entry &entry : entries) {
+        entry.m_offset = offset;
+        offset = AlignUp(offset + entry.m_size);
+    }
+    const uint64_t fileSize = entries.empty() ? kHeaderSize + tocSize : entries.back().m_offset + entries.back().m_size;
+
+    auto buildTableOfContents = [&]() {
+        std::vector<uint8_t> out(kMagic, kMagic + sizeof(kMagic));
+        AppendU32LE(out, kVersion);
+        AppendU32LE(out, kAlignment);
+        AppendU32LE(out, static_cast<uint32_t>(fields.size()));
+        AppendU32LE(out, static_cast<uint32_t>(entries.size()));
+        AppendU64LE(out, tocSize);
+        AppendU64LE(out, fileSize);
+        out.resize(kHeaderSize, 0);
+        for (const auto &[key, value] : fields) {
+            AppendString(out, key);
+            AppendString(out, value);
+        }
+        for (const Entry &entry : entries) {
+            AppendString(out, entry.m_name);
+            AppendU64LE(out, entry.m_offset);
+            AppendU64LE(out, entry.m_size);
+            AppendString(out, entry.m_digest);
+        }
+        return out;
+    };
+
+    const std::string tempPath = bundlePath + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "Cannot create " + tempPath;
+        return false;
+    }
+
+    std::vector<uint8_t> toc = buildTableOfContents();
+    out.write(reinterpret_cast<const char *>(toc.data()), static_cast<std::streamsize>(toc.size()));
+
+    constexpr size_t kCopyBlockSize = 4 * 1024 * 1024;
+    std::vector<char> buffer(kCopyBlockSize);
+    Sha256 sha256;
+    for (size_t i = 0; i < entries.size() && out; ++i) {
+        Entry &entry = entries[i];
+        const Image &image = images[i];
+        out.seekp(static_cast<std::streamoff>(entry.m_offset));
+
+        sha256.Reset();
+        if (image.IsFileSlice()) {
+            // Repacking a bundle copies from its mapping.
+            sha256.Update(image.GetMappedData(), static_cast<size_t>(entry.m_size));
+            out.write(reinterpret_cast<const char *>(image.GetMappedData()), static_cast<std::streamsize>(entry.m_size));
+        } else {
+            std::ifstream in(image.GetPath(), std::ios::binary);
+            uint64_t copied = 0;
+            while (in && copied < entry.m_size) {
+                in.read(buffer.data(), static_cast<std::streamsize>(std::min<uint64_t>(buffer.size(), entry.m_size - copied)));
+                const std::streamsize bytesRead = in.gcount();
+                if (bytesRead <= 0) {
+                    break;
+                }
+                sha256.Update(reinterpret_cast<const uint8_t *>(buffer.data()), static_cast<size_t>(bytesRead));
+                out.write(buffer.data(), bytesRead);
+                copied += static_cast<uint64_t>(bytesRead);
+            }
+            if (copied != entry.m_size) {
+                error = "Failed to read " + image.GetPath();
+                out.close();
+                std::filesystem::remove(tempPath);
+                return false;
+            }
+        }
+        entry.m_digest = sha256.FinalHex();
+
+        if (!image.GetDigest().empty() && image.GetDigest() != entry.m_digest) {
+            error = image.GetName() + " does not match its manifest sha256";
+            out.close();
+            std::filesystem::remove(tempPath);
+            return false;
+        }
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Bundled " << entry.m_name << ": " << entry.m_size << " bytes at "
+            << entry.m_offset << endLog;
+    }
+
+    toc = buildTableOfContents();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(toc.data()), static_cast<std::streamsize>(toc.size()));
+    out.close();
+    if (!out) {
+        error = "Failed to write " + tempPath;
+        std::filesystem::remove(tempPath);
+        return false;
+    }
+
+    // Ends exactly after the last image, even an empty one.
+    std::error_code ec;
+    std::filesystem::resize_file(tempPath, fileSize, ec);
+    if (!ec) {
+        std::filesystem::rename(tempPath, bundlePath, ec);
+    }
+    if (ec) {
+        error = "Cannot finish " + bundlePath + ": " + ec.message();
+        std::filesystem::remove(tempPath);
+        return false;
+    }
+
+    log(ASTRA_LOG_LEVEL_INFO) << "Wrote flash image bundle " << bundlePath << ": " << entries.size() << " images, "
+        << fileSize << " bytes" << endLog;
+    return true;
+}
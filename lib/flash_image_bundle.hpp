@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FlashImage;
+class ImageMapping;
+
+/**
+ * A flash image packed into one file, so it is copied as one file and
+ * loaded without listing a directory or opening its images.  The file is a
+ * header, a table of contents and the images, each starting on a
+ * kAlignment boundary so it can be mapped and served in place:
+ *
+ *   header    magic "ASTRAFIB", then u32 version, alignment, field count
+ *             and entry count, u64 TOC size and u64 file size, padded to
+ *             kHeaderSize bytes
+ *   fields    per field: u32 key length, key, u32 value length, value
+ *   entries   per image: u32 name length, name, u64 offset, u64 size,
+ *             u32 digest length, digest (lowercase hex SHA-256)
+ *   payloads  the images, at their offsets
+ *
+ * Integers are little endian.  The fields hold the image settings which
+ * otherwise come from manifest.yaml and the TAG file, e.g. chip and
+ * image_type, and "directory", the image directory name U-Boot is given.
+ */
+class FlashImageBundle {
+public:
+    struct Entry {
+        std::string m_name;
+        uint64_t m_offset = 0;
+        uint64_t m_size = 0;
+        std::string m_digest;
+    };
+
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kAlignment = 4096;
+    static constexpr size_t kHeaderSize = 64;
+
+    /** @return true if path is a file starting with the bundle magic. */
+    static bool IsBundle(const std::string &path);
+
+    /**
+     * Map the bundle at path and read its table of contents.
+     * @return nullptr if it cannot be mapped or is malformed.
+     */
+    static std::shared_ptr<const FlashImageBundle> Open(const std::string &path);
+
+    /**
+     * Pack a loaded flash image into a bundle at bundlePath, with the settings
+     * it was loaded with as fields.  Only eMMC images are supported, and
+     * compressed images are refused: bundled images are served straight
+     * from the mapping.
+     * @return false with error set on failure.
+     */
+    static bool Write(const FlashImage &flashImage, const std::string &bundlePath, std::string &error);
+
+    const std::string &GetPath() const { return m_path; }
+    const std::map<std::string, std::string> &GetFields() const { return m_fields; }
+    const std::vector<Entry> &GetEntries() const { return m_entries; }
+
+    /** A view of entry's bytes in the bundle mapping, keeping the mapping alive. */
+    std::shared_ptr<const ImageMapping> GetView(const Entry &entry) const;
+
+private:
+    static constexpr char kMagic[8] = {'A', 'S', 'T', 'R', 'A', 'F', 'I', 'B'};
+
+    explicit FlashImageBundle(const std::string &path) : m_path(path) {}
+    bool ReadTableOfContents();
+
+    std::string m_path;
+    std::shared_ptr<const ImageMapping> m_mapping;
+    std::map<std::string, std::string> m_fields;
+    std::vector<Entry> m_entries;
+};
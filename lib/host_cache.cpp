@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+
+#if defined(PLATFORM_MACOS) || defined(PLATFORM_LINUX)
+#include <unistd.h>
+#endif
+
+#include "host_cache.hpp"
+
+std::string HostCacheFilePath(const std::string &name)
+{
+    std::filesystem::path cacheDir;
+    std::string hostname;
+
+#if defined(PLATFORM_WINDOWS)
+    if (const char *localAppData = std::getenv("LOCALAPPDATA")) {
+        cacheDir = localAppData;
+    }
+    if (const char *computerName = std::getenv("COMPUTERNAME")) {
+        hostname = computerName;
+    }
+#else
+    if (const char *xdgCache = std::getenv("XDG_CACHE_HOME"); xdgCache != nullptr && xdgCache[0] != '\0') {
+        cacheDir = xdgCache;
+    } else if (const char *home = std::getenv("HOME"); home != nullptr && home[0] != '\0') {
+        cacheDir = std::filesystem::path(home) / ".cache";
+    }
+    char hostName[256] = {};
+    if (gethostname(hostName, sizeof(hostName) - 1) == 0) {
+        hostname = hostName;
+    }
+#endif
+
+    if (cacheDir.empty()) {
+        return "";
+    }
+
+    std::replace(hostname.begin(), hostname.end(), '/', '_');
+    if (hostname.empty()) {
+        hostname = "localhost";
+    }
+    return (cacheDir / "astra-update" / (name + "-" + hostname)).string();
+}
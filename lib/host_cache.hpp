@@ -0,0 +1,14 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <string>
+
+/**
+ * Path of the per-user cache file name for this host, e.g.
+ * ~/.cache/astra-update/<name>-<hostname>, or empty if there is no home
+ * directory.  What is learned about the USB bus belongs to one host, so a
+ * home directory shared between hosts keeps one file per host.
+ */
+std::string HostCacheFilePath(const std::string &name);
@@ -1,20 +1,87 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2025 Synaptics Incorporated
 
+#include <algorithm>
 #include <filesystem>
 #include <vector>
 #include <iostream>
 #include <cstring>
 
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "image.hpp"
+#include "image_decompressor.hpp"
+#include "image_store.hpp"
 #include "astra_log.hpp"
 
+Image &Image::operator=(const Image &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    if (m_fp) {
+        fclose(m_fp);
+    }
+
+    m_imagePath = other.m_imagePath;
+    m_imageName = other.m_imageName;
+    m_imageSize = other.m_imageSize;
+    m_imageType = other.m_imageType;
+    m_fp = nullptr;
+    m_mapping = other.m_mapping;
+    m_readOffset = 0;
+    m_compression = other.m_compression;
+    m_uncompressedSize = other.m_uncompressedSize;
+    m_decompressor.reset();
+    m_digest = other.m_digest;
+    m_uniformBlocks = other.m_uniformBlocks;
+    m_filePath = other.m_filePath;
+    m_fileOffset = other.m_fileOffset;
+    return *this;
+}
+
+AstraImageCompression Image::CompressionFromPath(const std::string &path)
+{
+    const std::string extension = std::filesystem::path(path).extension().string();
+    if (extension == ".gz") {
+        return ASTRA_IMAGE_COMPRESSION_GZIP;
+    } else if (extension == ".zst") {
+        return ASTRA_IMAGE_COMPRESSION_ZSTD;
+    }
+    return ASTRA_IMAGE_COMPRESSION_NONE;
+}
+
+std::string Image::NameFromPath(const std::string &path, AstraImageCompression compression)
+{
+    std::filesystem::path filename = std::filesystem::path(path).filename();
+    if (compression != ASTRA_IMAGE_COMPRESSION_NONE) {
+        // The device requests the uncompressed name.
+        filename.replace_extension();
+    }
+    return filename.string();
+}
+
 int Image::Load()
 {
     ASTRA_LOG;
 
     log(ASTRA_LOG_LEVEL_DEBUG) << "Loading image: " << m_imagePath << endLog;
-    m_imageName = std::filesystem::path(m_imagePath).filename().string();
+    m_imageName = NameFromPath(m_imagePath, m_compression);
+
+    if (m_compression != ASTRA_IMAGE_COMPRESSION_NONE) {
+        return LoadCompressed();
+    }
+
+    if (m_mapping) {
+        m_imageSize = m_mapping->GetSize();
+        m_readOffset = 0;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Image size: " << m_imageSize << " (mapped)" << endLog;
+        return 0;
+    }
 
     if (std::filesystem::exists(m_imagePath) == false) {
         log(ASTRA_LOG_LEVEL_ERROR) << "Image file does not exist: " << m_imagePath << endLog;
@@ -41,10 +108,105 @@ int Image::Load()
     return 0;
 }
 
+int Image::LoadCompressed()
+{
+    ASTRA_LOG;
+
+    if (ImageDecompressor::DetectCompression(m_imagePath) != m_compression) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Image contents do not match its compression extension: " << m_imagePath << endLog;
+        return -1;
+    }
+
+    if (!ImageDecompressor::IsSupported(m_compression)) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "This build does not support decompressing " << m_imagePath << endLog;
+        return -1;
+    }
+
+    auto decompressor = std::make_shared<ImageDecompressor>();
+    if (decompressor->Open(m_imagePath, m_compression) < 0) {
+        return -1;
+    }
+
+    if (m_uncompressedSize != 0) {
+        decompressor->SetUncompressedSize(m_uncompressedSize);
+    }
+
+    if (decompressor->GetUncompressedSize() == 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Uncompressed size of " << m_imagePath
+            << " is unknown; set uncompressed_size in the manifest" << endLog;
+        return -1;
+    }
+
+    m_imageSize = static_cast<size_t>(decompressor->GetUncompressedSize());
+    m_readOffset = 0;
+    m_decompressor = std::move(decompressor);
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Image size: " << m_imageSize << " (compressed)" << endLog;
+
+    return 0;
+}
+
+const uint8_t *Image::GetMappedData() const
+{
+    // A mapping of a compressed file holds the compressed bytes.
+    return (m_mapping && !IsCompressed()) ? m_mapping->GetData() : nullptr;
+}
+
+void Image::Prefetch() const
+{
+    // Enough to cover the first transfers; sequential read-ahead takes over after that.
+    constexpr size_t kPrefetchBytes = 64 * 1024 * 1024;
+
+    if (m_mapping) {
+        m_mapping->Prefetch(kPrefetchBytes);
+        return;
+    }
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+    int fd = open(m_imagePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+#if defined(PLATFORM_LINUX)
+    posix_fadvise(fd, 0, static_cast<off_t>(kPrefetchBytes), POSIX_FADV_WILLNEED);
+#else
+    struct radvisory advisory;
+    advisory.ra_offset = 0;
+    advisory.ra_count = static_cast<int>(kPrefetchBytes);
+    fcntl(fd, F_RDADVISE, &advisory);
+#endif
+    close(fd);
+#endif
+}
+
 int Image::GetDataBlock(uint8_t *data, size_t size)
 {
     ASTRA_LOG;
 
+    if (m_decompressor) {
+        const size_t readSize = std::min(size, m_imageSize - m_readOffset);
+        if (readSize == 0) {
+            return 0;
+        }
+        const int ret = m_decompressor->Read(data, readSize);
+        if (ret != static_cast<int>(readSize)) {
+            return -1;
+        }
+        m_readOffset += readSize;
+        if (m_readOffset == m_imageSize && m_decompressor->Finish() < 0) {
+            return -1;
+        }
+        return ret;
+    }
+
+    if (m_mapping) {
+        const size_t readSize = std::min(size, m_imageSize - m_readOffset);
+        if (readSize > 0) {
+            std::memcpy(data, m_mapping->GetData() + m_readOffset, readSize);
+        }
+        m_readOffset += readSize;
+        return static_cast<int>(readSize);
+    }
+
     int readSize = size;
     if (m_imageSize < size) {
         readSize = m_imageSize;
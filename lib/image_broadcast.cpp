@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "image_broadcast.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+class ImageBroadcast::Stream {
+public:
+    Stream(const Image &image, size_t slackBlocks) : m_image{image}, m_slackBlocks{slackBlocks}
+    {}
+
+    ~Stream()
+    {
+        ASTRA_LOG;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_progressCV.notify_all();
+        if (m_readerThread.joinable()) {
+            m_readerThread.join();
+        }
+    }
+
+    Stream(const Stream &) = delete;
+    Stream &operator=(const Stream &) = delete;
+
+    bool Open()
+    {
+        if (m_image.Load() < 0) {
+            return false;
+        }
+        m_size = m_image.GetSize();
+        return true;
+    }
+
+    uint64_t GetSize() const
+    {
+        return m_size;
+    }
+
+    // Add reader at the front of the image.  Fails once the head of the
+    // stream was recycled, as the reader could not start from it, or once
+    // the stream ended short of the end of the image.
+    bool Attach(Reader &reader)
+    {
+        ASTRA_LOG;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_firstBlock > 0 || m_readError || (m_finished && !m_endOfData) || m_stop) {
+            return false;
+        }
+        reader.m_block = 0;
+        m_readers.push_back(&reader);
+        if (!m_readerThread.joinable()) {
+            m_readerThread = ThreadPolicy::Start(THREAD_ROLE_TRANSFER, "astra-broadcast", &Stream::ReaderThread, this);
+        }
+        return true;
+    }
+
+    void Detach(Reader &reader)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = std::find(m_readers.begin(), m_readers.end(), &reader);
+            if (it == m_readers.end()) {
+                return;
+            }
+            m_readers.erase(it);
+        }
+        m_progressCV.notify_all();
+    }
+
+    // Copy up to size bytes at reader's position into data.  Stops short at
+    // the end of the image or, setting dropped, if reader was dropped.
+    int Read(Reader &reader, uint8_t *data, size_t size, bool &dropped)
+    {
+        size_t copied = 0;
+        while (copied < size) {
+            std::shared_ptr<const Block> block;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_blockReadCV.wait(lock, [this, &reader] {
+                    return !IsAttached(reader) || reader.m_block < m_readBlocks || m_readError || m_endOfData;
+                });
+                if (!IsAttached(reader)) {
+                    dropped = true;
+                    return static_cast<int>(copied);
+                }
+                if (reader.m_block >= m_readBlocks) {
+                    return m_readError ? -1 : static_cast<int>(copied);
+                }
+                block = m_blocks[reader.m_block - m_firstBlock];
+            }
+
+            // Blocks are never written once read, so copy without the lock.
+            const size_t length = std::min(size - copied, block->m_length - reader.m_blockOffset);
+            std::memcpy(data + copied, block->m_data.data() + reader.m_blockOffset, length);
+            copied += length;
+            reader.m_blockOffset += length;
+
+            if (reader.m_blockOffset == block->m_length) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    ++reader.m_block;
+                    reader.m_blockOffset = 0;
+                }
+                m_progressCV.notify_all();
+            }
+        }
+        return static_cast<int>(copied);
+    }
+
+private:
+    struct Block {
+        std::vector<uint8_t> m_data;
+        size_t m_length = 0;
+    };
+
+    // Blocks read ahead of the fastest reader.
+    static constexpr uint64_t kReadAheadBlocks = 2;
+
+    bool IsAttached(const Reader &reader) const
+    {
+        return std::find(m_readers.begin(), m_readers.end(), &reader) != m_readers.end();
+    }
+
+    uint64_t FastestBlock() const
+    {
+        uint64_t fastest = 0;
+        for (const Reader *reader : m_readers) {
+            fastest = std::max(fastest, reader->m_block);
+        }
+        return fastest;
+    }
+
+    uint64_t SlowestBlock() const
+    {
+        uint64_t slowest = m_readBlocks;
+        for (const Reader *reader : m_readers) {
+            slowest = std::min(slowest, reader->m_block);
+        }
+        return slowest;
+    }
+
+    std::shared_ptr<Block> TakeFreeBlock()
+    {
+        if (!m_freeBlocks.empty()) {
+            std::shared_ptr<Block> block = std::move(m_freeBlocks.back());
+            m_freeBlocks.pop_back();
+            return block;
+        }
+        auto block = std::make_shared<Block>();
+        block->m_data.resize(kBlockSize);
+        return block;
+    }
+
+    // Drop the readers more than the slack behind the fastest, then recycle
+    // the blocks every remaining reader has passed and the fastest is more
+    // than the slack past, so a late reader may still join at the head.
+    // Called with m_mutex held.
+    void TrimReaders()
+    {
+        ASTRA_LOG;
+
+        const uint64_t fastest = FastestBlock();
+        const size_t attached = m_readers.size();
+        m_readers.erase(std::remove_if(m_readers.begin(), m_readers.end(), [this, fastest](const Reader *reader) {
+            return fastest - reader->m_block > m_slackBlocks;
+        }), m_readers.end());
+        if (m_readers.size() != attached) {
+            log(ASTRA_LOG_LEVEL_INFO) << (attached - m_readers.size()) << " device(s) fell behind the shared read of "
+                << m_image.GetName() << " and read it on their own" << endLog;
+            m_blockReadCV.notify_all();
+        }
+
+        const uint64_t slowest = SlowestBlock();
+        while (!m_blocks.empty() && m_firstBlock < slowest && fastest - m_firstBlock > m_slackBlocks) {
+            // A block still being copied by a dropped reader is left to it.
+            if (m_blocks.front().use_count() == 1) {
+                m_freeBlocks.push_back(std::const_pointer_cast<Block>(std::move(m_blocks.front())));
+            }
+            m_blocks.pop_front();
+            ++m_firstBlock;
+        }
+    }
+
+    void ReaderThread()
+    {
+        ASTRA_LOG;
+
+        uint64_t remaining = m_size;
+        while (remaining > 0) {
+            std::shared_ptr<Block> block;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_progressCV.wait(lock, [this] {
+                    return m_stop || m_readers.empty() || FastestBlock() + kReadAheadBlocks > m_readBlocks;
+                });
+                if (m_stop || m_readers.empty()) {
+                    m_finished = true;
+                    return;
+                }
+                TrimReaders();
+                block = TakeFreeBlock();
+            }
+
+            // Only this thread writes blocks, and readers never see one
+            // before it is added, so read without the lock.
+            const size_t toRead = static_cast<size_t>(std::min<uint64_t>(kBlockSize, remaining));
+            size_t length = 0;
+            while (length < toRead) {
+                const int bytesRead = m_image.GetDataBlock(block->m_data.data() + length, toRead - length);
+                if (bytesRead <= 0) {
+                    break;
+                }
+                length += static_cast<size_t>(bytesRead);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (length != toRead) {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "Shared read of " << m_image.GetName() << " failed with "
+                        << remaining << " bytes remaining" << endLog;
+                    m_readError = true;
+                    m_finished = true;
+                    m_blockReadCV.notify_all();
+                    return;
+                }
+                block->m_length = length;
+                m_blocks.push_back(std::move(block));
+                ++m_readBlocks;
+            }
+            m_blockReadCV.notify_all();
+
+            remaining -= length;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_endOfData = true;
+            m_finished = true;
+        }
+        m_blockReadCV.notify_all();
+    }
+
+    // Only touched by the reader thread once it runs.
+    Image m_image;
+    uint64_t m_size = 0;
+    const size_t m_slackBlocks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_blockReadCV;
+    std::condition_variable m_progressCV;
+    std::vector<Reader *> m_readers;
+    // Blocks m_firstBlock up to m_readBlocks, held until the slowest reader passes them.
+    std::deque<std::shared_ptr<const Block>> m_blocks;
+    std::vector<std::shared_ptr<Block>> m_freeBlocks;
+    uint64_t m_firstBlock = 0;
+    uint64_t m_readBlocks = 0;
+    bool m_endOfData = false;
+    bool m_readError = false;
+    bool m_finished = false;
+    bool m_stop = false;
+    std::thread m_readerThread;
+};
+
+ImageBroadcast::ImageBroadcast(uint64_t slackBytes)
+    : m_slackBlocks{static_cast<size_t>(std::max<uint64_t>(slackBytes / kBlockSize, 1))}
+{}
+
+std::unique_ptr<ImageBroadcast::Reader> ImageBroadcast::Join(Image &image)
+{
+    ASTRA_LOG;
+
+    if (!image.IsCompressed()) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::weak_ptr<Stream> &entry = m_streams[image.GetPath()];
+    if (std::shared_ptr<Stream> stream = entry.lock()) {
+        std::unique_ptr<Reader> reader(new Reader(stream, image));
+        if (stream->Attach(*reader)) {
+            image.SetLoadedSize(static_cast<size_t>(stream->GetSize()));
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Joined the shared read of " << image.GetName() << endLog;
+            return reader;
+        }
+    }
+
+    // Too late for the last stream, if any: start the next one.
+    auto stream = std::make_shared<Stream>(image, m_slackBlocks);
+    if (!stream->Open()) {
+        return nullptr;
+    }
+    std::unique_ptr<Reader> reader(new Reader(stream, image));
+    if (!stream->Attach(*reader)) {
+        return nullptr;
+    }
+    entry = stream;
+    image.SetLoadedSize(static_cast<size_t>(stream->GetSize()));
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Started a shared read of " << image.GetName() << endLog;
+    return reader;
+}
+
+ImageBroadcast::Reader::Reader(std::shared_ptr<Stream> stream, const Image &image)
+    : m_stream{std::move(stream)}, m_image{image}
+{}
+
+ImageBroadcast::Reader::~Reader()
+{
+    m_stream->Detach(*this);
+}
+
+int ImageBroadcast::Reader::Read(uint8_t *data, size_t size)
+{
+    size_t copied = 0;
+    if (!m_dropped) {
+        const int ret = m_stream->Read(*this, data, size, m_dropped);
+        if (ret < 0) {
+            return -1;
+        }
+        copied = static_cast<size_t>(ret);
+        m_position += copied;
+        if (!m_dropped) {
+            return ret;
+        }
+    }
+
+    const int ret = ReadIndependently(data + copied, size - copied);
+    return ret < 0 ? -1 : static_cast<int>(copied) + ret;
+}
+
+int ImageBroadcast::Reader::ReadIndependently(uint8_t *data, size_t size)
+{
+    ASTRA_LOG;
+
+    if (!m_imageLoaded) {
+        if (m_image.Load() < 0) {
+            return -1;
+        }
+        m_imageLoaded = true;
+
+        // A decompressor cannot seek, so skip what the stream delivered.
+        std::vector<uint8_t> skipped(kBlockSize);
+        uint64_t skippedBytes = 0;
+        while (skippedBytes < m_position) {
+            const int bytesRead = m_image.GetDataBlock(skipped.data(),
+                static_cast<size_t>(std::min<uint64_t>(skipped.size(), m_position - skippedBytes)));
+            if (bytesRead <= 0) {
+                return -1;
+            }
+            skippedBytes += static_cast<uint64_t>(bytesRead);
+        }
+    }
+
+    size_t copied = 0;
+    while (copied < size) {
+        const int bytesRead = m_image.GetDataBlock(data + copied, size - copied);
+        if (bytesRead < 0) {
+            return -1;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        copied += static_cast<size_t>(bytesRead);
+    }
+    m_position += copied;
+    return static_cast<int>(copied);
+}
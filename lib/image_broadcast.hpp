@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "image.hpp"
+
+/**
+ * Shares one read of a compressed update image between the devices that
+ * send it at the same time.  Mapped images are already shared through the
+ * ImageStore, but every device decompresses a compressed image on its own.
+ * Here the first device to send an image starts a stream: a reader thread
+ * decompresses it into a ring of reference-counted blocks, paced by the
+ * fastest device, and later devices consume the same blocks.  The head of
+ * the stream stays resident until the fastest device is more than the
+ * slack past it, so a device starting within the slack of the first still
+ * joins at the start.  Other blocks are recycled once the slowest device
+ * has passed them.  A device more than the slack behind the fastest is
+ * dropped from the stream and goes on reading the image by itself.
+ */
+class ImageBroadcast {
+public:
+    static constexpr size_t kBlockSize = 1024 * 1024;
+
+    explicit ImageBroadcast(uint64_t slackBytes);
+
+    class Stream;
+
+    /** One device's position in a stream. */
+    class Reader {
+    public:
+        ~Reader();
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        /**
+         * Read the next size bytes of the image into data, fewer only at its
+         * end, as Image::GetDataBlock() would.
+         * @return bytes read, 0 at the end of the image, or -1 on error.
+         */
+        int Read(uint8_t *data, size_t size);
+
+    private:
+        friend class ImageBroadcast;
+        friend class Stream;
+
+        Reader(std::shared_ptr<Stream> stream, const Image &image);
+        int ReadIndependently(uint8_t *data, size_t size);
+
+        std::shared_ptr<Stream> m_stream;
+        // Block index and offset into it, maintained under the stream mutex.
+        uint64_t m_block = 0;
+        size_t m_blockOffset = 0;
+        bool m_dropped = false;
+
+        // The path taken once dropped: a private copy read from m_position.
+        Image m_image;
+        uint64_t m_position = 0;
+        bool m_imageLoaded = false;
+    };
+
+    /**
+     * Join the stream of image, or start one.  image need not be loaded:
+     * the stream decompresses its own copy, whose size image takes, and the
+     * reader only loads a copy of image if it is dropped.
+     * @return null if image is not compressed or cannot be opened; it is
+     *         then read directly.
+     */
+    std::unique_ptr<Reader> Join(Image &image);
+
+private:
+    size_t m_slackBlocks;
+
+    std::mutex m_mutex;
+    // The latest stream of each image, by path.
+    std::unordered_map<std::string, std::weak_ptr<Stream>> m_streams;
+};
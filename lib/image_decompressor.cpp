@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "image_decompressor.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#ifdef ASTRA_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ASTRA_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "astra_log.hpp"
+
+struct ImageDecompressor::Stream {
+#ifdef ASTRA_HAVE_ZLIB
+    z_stream zlib{};
+    bool zlibInitialized = false;
+#endif
+#ifdef ASTRA_HAVE_ZSTD
+    ZSTD_DStream *zstd = nullptr;
+#endif
+};
+
+ImageDecompressor::ImageDecompressor() = default;
+
+ImageDecompressor::~ImageDecompressor()
+{
+    Close();
+}
+
+AstraImageCompression ImageDecompressor::DetectCompression(const std::string &path)
+{
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) {
+        return ASTRA_IMAGE_COMPRESSION_NONE;
+    }
+
+    std::array<uint8_t, 4> magic = {};
+    const size_t bytesRead = fread(magic.data(), 1, magic.size(), fp);
+    fclose(fp);
+
+    if (bytesRead >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+        return ASTRA_IMAGE_COMPRESSION_GZIP;
+    }
+    if (bytesRead == 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+        return ASTRA_IMAGE_COMPRESSION_ZSTD;
+    }
+    return ASTRA_IMAGE_COMPRESSION_NONE;
+}
+
+bool ImageDecompressor::IsSupported(AstraImageCompression compression)
+{
+    switch (compression) {
+        case ASTRA_IMAGE_COMPRESSION_NONE:
+            return true;
+#ifdef ASTRA_HAVE_ZLIB
+        case ASTRA_IMAGE_COMPRESSION_GZIP:
+            return true;
+#endif
+#ifdef ASTRA_HAVE_ZSTD
+        case ASTRA_IMAGE_COMPRESSION_ZSTD:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+int ImageDecompressor::Open(const std::string &path, AstraImageCompression compression)
+{
+    ASTRA_LOG;
+
+    Close();
+
+    if (compression == ASTRA_IMAGE_COMPRESSION_NONE || !IsSupported(compression)) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Unsupported compression for image: " << path << endLog;
+        return -1;
+    }
+
+    m_fp = fopen(path.c_str(), "rb");
+    if (m_fp == nullptr) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open file: " << path << " (" << strerror(errno) << ")" << endLog;
+        return -1;
+    }
+
+    m_path = path;
+    m_compression = compression;
+    m_stream = std::make_unique<Stream>();
+    m_input.resize(kInputBufferSize);
+
+#ifdef ASTRA_HAVE_ZLIB
+    if (compression == ASTRA_IMAGE_COMPRESSION_GZIP) {
+        // The gzip trailer ends with ISIZE: the uncompressed length modulo 2^32.
+        std::array<uint8_t, 4> trailer = {};
+        if (fseek(m_fp, -4, SEEK_END) == 0 && fread(trailer.data(), 1, trailer.size(), m_fp) == trailer.size()) {
+            m_uncompressedSize = static_cast<uint64_t>(trailer[0]) | (static_cast<uint64_t>(trailer[1]) << 8) |
+                (static_cast<uint64_t>(trailer[2]) << 16) | (static_cast<uint64_t>(trailer[3]) << 24);
+        }
+        rewind(m_fp);
+
+        // windowBits + 32 enables gzip header detection.
+        if (inflateInit2(&m_stream->zlib, 15 + 32) != Z_OK) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "inflateInit2 failed for " << path << endLog;
+            Close();
+            return -1;
+        }
+        m_stream->zlibInitialized = true;
+    }
+#endif
+#ifdef ASTRA_HAVE_ZSTD
+    if (compression == ASTRA_IMAGE_COMPRESSION_ZSTD) {
+        std::array<uint8_t, ZSTD_FRAMEHEADERSIZE_MAX> header = {};
+        const size_t headerSize = fread(header.data(), 1, header.size(), m_fp);
+        const unsigned long long contentSize = ZSTD_getFrameContentSize(header.data(), headerSize);
+        if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize != ZSTD_CONTENTSIZE_ERROR) {
+            m_uncompressedSize = contentSize;
+        }
+        rewind(m_fp);
+
+        m_stream->zstd = ZSTD_createDStream();
+        if (m_stream->zstd == nullptr || ZSTD_isError(ZSTD_initDStream(m_stream->zstd))) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "ZSTD_initDStream failed for " << path << endLog;
+            Close();
+            return -1;
+        }
+    }
+#endif
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Opened compressed image " << path << " (uncompressed size "
+        << m_uncompressedSize << ")" << endLog;
+    return 0;
+}
+
+void ImageDecompressor::Close()
+{
+    if (m_stream) {
+#ifdef ASTRA_HAVE_ZLIB
+        if (m_stream->zlibInitialized) {
+            inflateEnd(&m_stream->zlib);
+        }
+#endif
+#ifdef ASTRA_HAVE_ZSTD
+        if (m_stream->zstd) {
+            ZSTD_freeDStream(m_stream->zstd);
+        }
+#endif
+        m_stream.reset();
+    }
+
+    if (m_fp) {
+        fclose(m_fp);
+        m_fp = nullptr;
+    }
+
+    m_inputPos = 0;
+    m_inputLen = 0;
+    m_inputEof = false;
+    m_streamEnd = false;
+    m_produced = 0;
+}
+
+bool ImageDecompressor::FillInput()
+{
+    if (m_inputEof) {
+        return false;
+    }
+
+    const size_t bytesRead = fread(m_input.data(), 1, m_input.size(), m_fp);
+    if (bytesRead == 0) {
+        m_inputEof = true;
+        return false;
+    }
+
+    m_inputPos = 0;
+    m_inputLen = bytesRead;
+    return true;
+}
+
+int ImageDecompressor::Read(uint8_t *data, size_t size)
+{
+    ASTRA_LOG;
+
+    if (m_stream == nullptr) {
+        return -1;
+    }
+#if !defined(ASTRA_HAVE_ZLIB) && !defined(ASTRA_HAVE_ZSTD)
+    (void)data;
+#endif
+
+    size_t produced = 0;
+    while (produced < size && !m_streamEnd) {
+        const bool haveInput = (m_inputPos < m_inputLen) || FillInput();
+        if (!haveInput && ferror(m_fp)) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to read compressed image: " << m_path << endLog;
+            return -1;
+        }
+
+        const size_t producedBefore = produced;
+#ifdef ASTRA_HAVE_ZLIB
+        if (m_compression == ASTRA_IMAGE_COMPRESSION_GZIP) {
+            z_stream &zlib = m_stream->zlib;
+            zlib.next_in = m_input.data() + m_inputPos;
+            zlib.avail_in = static_cast<uInt>(m_inputLen - m_inputPos);
+            zlib.next_out = data + produced;
+            zlib.avail_out = static_cast<uInt>(size - produced);
+
+            const int ret = inflate(&zlib, Z_NO_FLUSH);
+            m_inputPos = m_inputLen - zlib.avail_in;
+            produced = size - zlib.avail_out;
+
+            if (ret == Z_STREAM_END) {
+                // Concatenated gzip members decode as one stream.
+                if ((m_inputPos < m_inputLen) || FillInput()) {
+                    inflateReset(&zlib);
+                } else {
+                    m_streamEnd = true;
+                }
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to decompress " << m_path << ": "
+                    << (zlib.msg ? zlib.msg : "inflate error") << endLog;
+                return -1;
+            }
+        }
+#endif
+#ifdef ASTRA_HAVE_ZSTD
+        if (m_compression == ASTRA_IMAGE_COMPRESSION_ZSTD) {
+            ZSTD_inBuffer in = { m_input.data(), m_inputLen, m_inputPos };
+            ZSTD_outBuffer out = { data, size, produced };
+
+            const size_t ret = ZSTD_decompressStream(m_stream->zstd, &out, &in);
+            if (ZSTD_isError(ret)) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to decompress " << m_path << ": "
+                    << ZSTD_getErrorName(ret) << endLog;
+                return -1;
+            }
+            m_inputPos = in.pos;
+            produced = out.pos;
+
+            // 0 means a frame was completed and fully flushed.
+            if (ret == 0 && !((m_inputPos < m_inputLen) || FillInput())) {
+                m_streamEnd = true;
+            }
+        }
+#endif
+
+        if (!haveInput && produced == producedBefore && !m_streamEnd) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Compressed image is truncated: " << m_path << endLog;
+            return -1;
+        }
+    }
+
+    m_produced += produced;
+    if (m_streamEnd && m_uncompressedSize != 0 && m_produced != m_uncompressedSize) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Decompressed " << m_produced << " bytes from " << m_path
+            << ", expected " << m_uncompressedSize << endLog;
+        return -1;
+    }
+
+    return static_cast<int>(produced);
+}
+
+int ImageDecompressor::Finish()
+{
+    ASTRA_LOG;
+
+    uint8_t extra = 0;
+    const int ret = Read(&extra, 1);
+    if (ret != 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Compressed image " << m_path << " does not end at the expected size "
+            << m_uncompressedSize << "; set uncompressed_size in the manifest" << endLog;
+        return -1;
+    }
+    return 0;
+}
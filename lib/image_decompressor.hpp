@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+
+/**
+ * Streaming decompressor for gzip and zstd compressed images.  Data is
+ * decompressed on demand in Read(), which the send pipeline calls as it fills
+ * transfer buffers, so no uncompressed copy is ever written to disk.
+ *
+ * Support for each format depends on the libraries found at build time
+ * (ASTRA_HAVE_ZLIB, ASTRA_HAVE_ZSTD).
+ */
+class ImageDecompressor {
+public:
+    ImageDecompressor();
+    ~ImageDecompressor();
+
+    ImageDecompressor(const ImageDecompressor &) = delete;
+    ImageDecompressor &operator=(const ImageDecompressor &) = delete;
+
+    /** @return the compression format of path, detected from its magic bytes. */
+    static AstraImageCompression DetectCompression(const std::string &path);
+
+    /** @return true if this build can decompress the given format. */
+    static bool IsSupported(AstraImageCompression compression);
+
+    /**
+     * Open path for decompression and read the uncompressed size from the
+     * zstd frame header or the gzip trailer.
+     * @return 0 on success, -1 on failure.
+     */
+    int Open(const std::string &path, AstraImageCompression compression);
+    void Close();
+
+    /**
+     * @return the uncompressed size, or 0 if the stream does not record it.
+     * gzip only stores the size modulo 4 GiB; Read() rejects a stream whose
+     * decompressed length does not match the expected size.
+     */
+    uint64_t GetUncompressedSize() const { return m_uncompressedSize; }
+
+    /** Override the expected uncompressed size, e.g. from the image manifest. */
+    void SetUncompressedSize(uint64_t size) { m_uncompressedSize = size; }
+
+    /**
+     * Decompress up to size bytes into data.  Fills the whole buffer unless
+     * the end of the stream is reached.
+     * @return bytes produced, 0 at end of stream, -1 on error.
+     */
+    int Read(uint8_t *data, size_t size);
+
+    /**
+     * Check that the stream ends once the expected size has been read.
+     * @return 0 if no data remains, -1 if the stream is longer or corrupt.
+     */
+    int Finish();
+
+private:
+    struct Stream;
+
+    static constexpr size_t kInputBufferSize = 256 * 1024;
+
+    bool FillInput();
+
+    AstraImageCompression m_compression = ASTRA_IMAGE_COMPRESSION_NONE;
+    std::string m_path;
+    FILE *m_fp = nullptr;
+    std::unique_ptr<Stream> m_stream;
+    std::vector<uint8_t> m_input;
+    size_t m_inputPos = 0;
+    size_t m_inputLen = 0;
+    bool m_inputEof = false;
+    bool m_streamEnd = false;
+    uint64_t m_uncompressedSize = 0;
+    uint64_t m_produced = 0;
+};
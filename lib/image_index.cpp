@@ -0,0 +1,331 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "image_index.hpp"
+#include "sha256.hpp"
+#include "sparse_image.hpp"
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+void ImageIndex::Apply(std::vector<Image> &images, bool withDigests)
+{
+    ASTRA_LOG;
+
+    const std::map<std::string, IndexEntry> index = ReadIndex();
+    std::map<std::string, IndexEntry> updatedIndex;
+    size_t cachedCount = 0;
+
+    struct Miss {
+        size_t slot;
+        uint64_t size;
+        bool withDigest;
+        bool withBlocks;
+        IndexEntry entry;
+    };
+    std::vector<Miss> misses;
+
+    for (size_t i = 0; i < images.size(); ++i) {
+        Image &image = images[i];
+        if (SparseImage::IsSparse(image.GetPath())) {
+            continue;
+        }
+
+        const std::filesystem::path path(image.GetPath());
+        const std::string stamp = IndexStamp(path);
+        if (stamp.empty()) {
+            continue;
+        }
+
+        // Keep what is still current, even if this run does not need it.
+        const std::string filename = path.filename().string();
+        IndexEntry entry{stamp, "", nullptr};
+        auto it = index.find(filename);
+        if (it != index.end() && it->second.stamp == stamp) {
+            entry = it->second;
+        }
+
+        const bool wantDigest = withDigests && image.GetDigest().empty();
+        const bool wantBlocks = WantsUniformBlocks(image);
+        if (!wantDigest && !wantBlocks) {
+            if (it != index.end() && it->second.stamp == stamp) {
+                updatedIndex[filename] = entry;
+                ++cachedCount;
+            }
+            continue;
+        }
+
+        const bool needDigest = wantDigest && entry.digest.empty();
+        const bool needBlocks = wantBlocks && entry.blocks == nullptr;
+        if (!needDigest && !needBlocks) {
+            if (wantDigest) {
+                image.SetDigest(entry.digest);
+            }
+            image.SetUniformBlocks(entry.blocks);
+            updatedIndex[filename] = entry;
+            ++cachedCount;
+            continue;
+        }
+
+        std::error_code ec;
+        const uint64_t size = std::filesystem::file_size(path, ec);
+        misses.push_back(Miss{i, ec ? 0 : size, needDigest, needBlocks, entry});
+    }
+
+    if (!misses.empty()) {
+        log(ASTRA_LOG_LEVEL_INFO) << "Preprocessing " << misses.size() << " image(s) in "
+            << m_directory.string() << endLog;
+
+        // Images are independent, so read them on a few threads, starting
+        // with the largest so one big image does not finish last.
+        std::sort(misses.begin(), misses.end(), [](const Miss &a, const Miss &b) {
+            return a.size > b.size;
+        });
+        std::atomic<size_t> next{0};
+        auto worker = [&images, &misses, &next]() {
+            for (size_t i = next++; i < misses.size(); i = next++) {
+                Miss &miss = misses[i];
+                ComputeEntry(images[miss.slot], miss.withDigest, miss.withBlocks, miss.entry);
+            }
+        };
+
+        const size_t threadCount = std::min<size_t>(misses.size(), std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threadCount; ++i) {
+            threads.push_back(ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-index", worker));
+        }
+        worker();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        for (const auto &miss : misses) {
+            Image &image = images[miss.slot];
+            if (withDigests && image.GetDigest().empty()) {
+                image.SetDigest(miss.entry.digest);
+            }
+            image.SetUniformBlocks(miss.entry.blocks);
+            if (!miss.entry.digest.empty() || miss.entry.blocks != nullptr) {
+                updatedIndex[std::filesystem::path(image.GetPath()).filename().string()] = miss.entry;
+            }
+        }
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Image index: " << cachedCount << " image(s) from the index, "
+        << misses.size() << " read" << endLog;
+
+    if (cachedCount != updatedIndex.size() || updatedIndex.size() != index.size()) {
+        WriteIndex(updatedIndex);
+    }
+}
+
+std::string ImageIndex::IndexStamp(const std::filesystem::path &path)
+{
+    std::error_code ec;
+    const auto fileTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return "";
+    }
+    const auto fileSize = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return "";
+    }
+
+    std::ostringstream stamp;
+    stamp << fileSize << " " << fileTime.time_since_epoch().count();
+    return stamp.str();
+}
+
+bool ImageIndex::WantsUniformBlocks(const Image &image)
+{
+    // Only raw eMMC images can be sent sparse, and small ones gain little.
+    constexpr uint64_t kMinScannedSize = 1024 * 1024;
+
+    if (image.GetImageType() != ASTRA_IMAGE_TYPE_UPDATE_EMMC || image.IsCompressed()) {
+        return false;
+    }
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(image.GetPath(), ec);
+    return !ec && size >= kMinScannedSize;
+}
+
+void ImageIndex::ComputeEntry(const Image &image, bool withDigest, bool withBlocks, IndexEntry &entry)
+{
+    ASTRA_LOG;
+
+    // A private copy: it opens its own file handle and decompressor.
+    Image reader(image);
+    if (reader.Load() < 0) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "Cannot read " << image.GetPath() << " to preprocess it" << endLog;
+        return;
+    }
+
+    Sha256 sha256;
+    std::vector<BlockScanner::Run> runs;
+    std::vector<uint8_t> buffer(kReadBlockSize);
+    size_t offset = 0;
+    while (offset < reader.GetSize()) {
+        const int bytesRead = reader.GetDataBlock(buffer.data(), std::min(buffer.size(), reader.GetSize() - offset));
+        if (bytesRead <= 0) {
+            log(ASTRA_LOG_LEVEL_WARNING) << "Failed to read " << image.GetPath() << " to preprocess it" << endLog;
+            return;
+        }
+        if (withDigest) {
+            sha256.Update(buffer.data(), static_cast<size_t>(bytesRead));
+        }
+        // A short read leaves later blocks misaligned; stop mapping there.
+        if (withBlocks && offset % kUniformBlockSize == 0) {
+            BlockScanner::AppendUniformRuns(runs, buffer.data(), static_cast<size_t>(bytesRead), kUniformBlockSize,
+                offset / kUniformBlockSize);
+        }
+        offset += static_cast<size_t>(bytesRead);
+    }
+
+    if (withDigest) {
+        entry.digest = sha256.FinalHex();
+    }
+    if (withBlocks) {
+        auto blocks = std::make_shared<UniformBlockMap>();
+        blocks->m_blockSize = kUniformBlockSize;
+        for (const auto &run : runs) {
+            if (run.m_blocks >= kMinIndexedRunBlocks) {
+                blocks->m_runs.push_back(run);
+            }
+        }
+        entry.blocks = std::move(blocks);
+    }
+}
+
+std::string ImageIndex::FormatBlocks(const UniformBlockMap &blocks)
+{
+    std::ostringstream text;
+    text << blocks.m_blockSize;
+    for (const auto &run : blocks.m_runs) {
+        text << " " << run.m_firstBlock << ":" << run.m_blocks << ":" << std::hex << run.m_fillValue << std::dec;
+    }
+    return text.str();
+}
+
+std::shared_ptr<const UniformBlockMap> ImageIndex::ParseBlocks(const std::string &text)
+{
+    std::istringstream stream(text);
+    auto blocks = std::make_shared<UniformBlockMap>();
+    if (!(stream >> blocks->m_blockSize) || blocks->m_blockSize != kUniformBlockSize) {
+        return nullptr;
+    }
+
+    std::string field;
+    while (stream >> field) {
+        BlockScanner::Run run;
+        char separator1 = 0;
+        char separator2 = 0;
+        std::istringstream fieldStream(field);
+        if (!(fieldStream >> run.m_firstBlock >> separator1 >> run.m_blocks >> separator2 >> std::hex >> run.m_fillValue) ||
+            separator1 != ':' || separator2 != ':')
+        {
+            return nullptr;
+        }
+        blocks->m_runs.push_back(run);
+    }
+    return blocks;
+}
+
+std::map<std::string, ImageIndex::IndexEntry> ImageIndex::ReadIndex() const
+{
+    ASTRA_LOG;
+
+    std::map<std::string, IndexEntry> index;
+
+    std::ifstream file(m_directory / kIndexFileName);
+    if (!file) {
+        return index;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kIndexHeader) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring image index with unknown format" << endLog;
+        return index;
+    }
+
+    // Each image line is followed by its stamp and whatever was learned.
+    IndexEntry *entry = nullptr;
+    while (std::getline(file, line)) {
+        if (line.rfind("image ", 0) == 0) {
+            entry = &index[line.substr(6)];
+            if (!std::getline(file, line) || line.rfind("stamp ", 0) != 0) {
+                entry = nullptr;
+            } else {
+                entry->stamp = line.substr(6);
+                continue;
+            }
+        } else if (entry != nullptr && line.rfind("sha256 ", 0) == 0) {
+            entry->digest = line.substr(7);
+            continue;
+        } else if (entry != nullptr && line.rfind("uniform ", 0) == 0) {
+            entry->blocks = ParseBlocks(line.substr(8));
+            if (entry->blocks != nullptr) {
+                continue;
+            }
+        }
+
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed image index" << endLog;
+        return {};
+    }
+
+    return index;
+}
+
+void ImageIndex::WriteIndex(const std::map<std::string, IndexEntry> &index) const
+{
+    ASTRA_LOG;
+
+    // Write a private temporary and rename it over the index, so a
+    // concurrent run never reads a partial file.
+    const std::filesystem::path indexPath = m_directory / kIndexFileName;
+    const std::filesystem::path tempPath = m_directory / (std::string(kIndexFileName) + "." +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::trunc);
+        if (!file) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Image directory is not writable, not caching the image index" << endLog;
+            return;
+        }
+
+        file << kIndexHeader << "\n";
+        for (const auto &[name, entry] : index) {
+            file << "image " << name << "\n";
+            file << "stamp " << entry.stamp << "\n";
+            if (!entry.digest.empty()) {
+                file << "sha256 " << entry.digest << "\n";
+            }
+            if (entry.blocks != nullptr) {
+                file << "uniform " << FormatBlocks(*entry.blocks) << "\n";
+            }
+        }
+
+        if (!file.flush()) {
+            log(ASTRA_LOG_LEVEL_WARNING) << "Failed to write image index " << tempPath << endLog;
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, indexPath, ec);
+    if (ec) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "Failed to replace image index: " << ec.message() << endLog;
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Wrote image index with " << index.size() << " entries" << endLog;
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "block_scanner.hpp"
+#include "image.hpp"
+
+/**
+ * What is learned by reading the update images in one directory, cached in
+ * kIndexFileName next to them: the SHA-256 of each image's uncompressed
+ * contents and the uniform blocks of raw eMMC images.  Each entry records
+ * the file's size and modification time, so a multi-gigabyte image is read
+ * once rather than on every run.  Missing or stale entries are recomputed
+ * in one pass over each image, the largest first, one image per core, and
+ * the index is rewritten.
+ */
+class ImageIndex
+{
+public:
+    explicit ImageIndex(const std::string &directory) : m_directory{directory}
+    {}
+
+    /**
+     * Attach the uniform block map of every raw eMMC image and, if
+     * withDigests, set the digest of every image without one (e.g. from the
+     * manifest).  Sparse images are skipped: the device digests the expanded
+     * partition, not the file, and their empty space is already left out.
+     */
+    void Apply(std::vector<Image> &images, bool withDigests);
+
+    /** Block size of the uniform block maps, that of a sparse image. */
+    static constexpr uint32_t kUniformBlockSize = 4096;
+
+private:
+    struct IndexEntry {
+        std::string stamp;
+        std::string digest;     // empty if not computed
+        std::shared_ptr<const UniformBlockMap> blocks;     // null if not scanned
+    };
+
+    static constexpr const char *kIndexFileName = ".image_index";
+    static constexpr const char *kIndexHeader = "astra-image-index 1";
+    static constexpr size_t kReadBlockSize = 4 * 1024 * 1024;
+    // Shorter runs save too little to be worth a line in the index.
+    static constexpr uint64_t kMinIndexedRunBlocks = 16;
+
+    std::filesystem::path m_directory;
+
+    std::map<std::string, IndexEntry> ReadIndex() const;
+    void WriteIndex(const std::map<std::string, IndexEntry> &index) const;
+
+    /** File size and modification time; empty if the file is unreadable. */
+    static std::string IndexStamp(const std::filesystem::path &path);
+
+    /** True if the uniform blocks of the image are worth knowing. */
+    static bool WantsUniformBlocks(const Image &image);
+
+    /**
+     * Read the image once, hashing it if withDigest and mapping its uniform
+     * blocks if withBlocks.  On a read error entry is left without either.
+     */
+    static void ComputeEntry(const Image &image, bool withDigest, bool withBlocks, IndexEntry &entry);
+
+    static std::string FormatBlocks(const UniformBlockMap &blocks);
+    static std::shared_ptr<const UniformBlockMap> ParseBlocks(const std::string &text);
+};
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "image_store.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#ifdef PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "astra_log.hpp"
+
+ImageMapping::~ImageMapping()
+{
+    ASTRA_LOG;
+
+#ifdef PLATFORM_WINDOWS
+    if (m_data && !m_arena && !m_parent) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mappingHandle) {
+        CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+    }
+    if (m_fileHandle) {
+        CloseHandle(static_cast<HANDLE>(m_fileHandle));
+    }
+#else
+    if (m_data && !m_arena && !m_parent) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+#endif
+}
+
+bool ImageMapping::Map()
+{
+    ASTRA_LOG;
+
+    std::error_code ec;
+    m_writeTime = std::filesystem::last_write_time(m_path, ec);
+    if (ec) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to stat image: " << m_path << " (" << ec.message() << ")" << endLog;
+        return false;
+    }
+
+#ifdef PLATFORM_WINDOWS
+    HANDLE file = CreateFileA(m_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open image for mapping: " << m_path
+            << " error: " << GetLastError() << endLog;
+        return false;
+    }
+    m_fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to query image size: " << m_path << endLog;
+        return false;
+    }
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    if (m_size == 0) {
+        // Zero-length files cannot be mapped; an empty view is still valid.
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "CreateFileMapping failed for " << m_path
+            << " error: " << GetLastError() << endLog;
+        return false;
+    }
+    m_mappingHandle = mapping;
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "MapViewOfFile failed for " << m_path
+            << " error: " << GetLastError() << endLog;
+        return false;
+    }
+    m_data = static_cast<const uint8_t *>(view);
+#else
+    int fd = open(m_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to open image for mapping: " << m_path
+            << " (" << strerror(errno) << ")" << endLog;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to query image size: " << m_path << endLog;
+        close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) {
+        // Zero-length files cannot be mapped; an empty view is still valid.
+        close(fd);
+        return true;
+    }
+
+    void *addr = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "mmap failed for " << m_path << " (" << strerror(errno) << ")" << endLog;
+        m_size = 0;
+        return false;
+    }
+
+    // Images are streamed front to back.
+    madvise(addr, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t *>(addr);
+#endif
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Mapped image " << m_path << " (" << m_size << " bytes)" << endLog;
+    return true;
+}
+
+void ImageMapping::Prefetch(size_t length) const
+{
+#ifndef PLATFORM_WINDOWS
+    if (m_data && !m_arena) {
+        madvise(const_cast<uint8_t *>(m_data), std::min(length, m_size), MADV_WILLNEED);
+    }
+#else
+    (void)length;
+#endif
+}
+
+bool ImageMapping::IsCurrent() const
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(m_path, ec);
+    if (ec || size != m_size) {
+        return false;
+    }
+
+    const auto writeTime = std::filesystem::last_write_time(m_path, ec);
+    return !ec && writeTime == m_writeTime;
+}
+
+std::shared_ptr<const ImageMapping> ImageStore::Acquire(const std::string &path)
+{
+    ASTRA_LOG;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_mappings.find(path);
+    if (it != m_mappings.end()) {
+        std::shared_ptr<const ImageMapping> existing = it->second.lock();
+        if (existing && existing->IsCurrent()) {
+            return existing;
+        }
+        // Expired, or the file was replaced on disk; map it again.
+        m_mappings.erase(it);
+    }
+
+    std::shared_ptr<ImageMapping> mapping(new ImageMapping(path));
+    if (!mapping->Map()) {
+        return nullptr;
+    }
+
+    m_mappings[path] = mapping;
+    return mapping;
+}
+
+std::vector<std::shared_ptr<const ImageMapping>> ImageStore::AcquireArena(const std::vector<std::string> &paths)
+{
+    std::string key;
+    for (const auto &path : paths) {
+        key += path + "\n";
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_arenas.find(key);
+    if (it != m_arenas.end()) {
+        std::vector<std::shared_ptr<const ImageMapping>> views;
+        for (const auto &weakView : it->second) {
+            std::shared_ptr<const ImageMapping> view = weakView.lock();
+            if (!view || !view->IsCurrent()) {
+                break;
+            }
+            views.push_back(std::move(view));
+        }
+        if (views.size() == paths.size()) {
+            return views;
+        }
+        // Expired, or a file was replaced on disk; read the set again.
+        m_arenas.erase(it);
+    }
+
+    std::vector<std::shared_ptr<const ImageMapping>> views = LoadArena(paths);
+    if (!views.empty()) {
+        m_arenas[key].assign(views.begin(), views.end());
+    }
+    return views;
+}
+
+std::vector<std::shared_ptr<const ImageMapping>> ImageStore::LoadArena(const std::vector<std::string> &paths)
+{
+    ASTRA_LOG;
+
+    // Offset table first, so the arena is allocated once.
+    std::vector<size_t> offsets;
+    std::vector<size_t> sizes;
+    std::vector<std::filesystem::file_time_type> writeTimes;
+    size_t arenaSize = 0;
+    for (const auto &path : paths) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        if (!ec) {
+            writeTimes.push_back(std::filesystem::last_write_time(path, ec));
+        }
+        if (ec) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Cannot stat " << path << " for the image arena: " << ec.message() << endLog;
+            return {};
+        }
+        arenaSize = (arenaSize + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+        offsets.push_back(arenaSize);
+        sizes.push_back(static_cast<size_t>(size));
+        arenaSize += sizes.back();
+        if (arenaSize > kMaxArenaSize) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Image set exceeds " << kMaxArenaSize << " bytes, not loading it into an arena" << endLog;
+            return {};
+        }
+    }
+
+    // Aligned storage, so the image offsets rounded to kArenaAlignment are
+    // aligned addresses too.
+    std::shared_ptr<uint8_t> arena(
+        static_cast<uint8_t *>(::operator new[](arenaSize, std::align_val_t(kArenaAlignment))),
+        [](uint8_t *data) { ::operator delete[](data, std::align_val_t(kArenaAlignment)); });
+    std::vector<std::shared_ptr<const ImageMapping>> views;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        std::ifstream file(paths[i], std::ios::binary);
+        file.read(reinterpret_cast<char *>(arena.get() + offsets[i]), static_cast<std::streamsize>(sizes[i]));
+        if (!file) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Failed to read " << paths[i] << " into the image arena" << endLog;
+            return {};
+        }
+
+        std::shared_ptr<ImageMapping> view(new ImageMapping(paths[i]));
+        view->m_arena = arena;
+        view->m_data = arena.get() + offsets[i];
+        view->m_size = sizes[i];
+        view->m_writeTime = writeTimes[i];
+        views.push_back(std::move(view));
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Loaded " << paths.size() << " images into a " << arenaSize << " byte arena" << endLog;
+    return views;
+}
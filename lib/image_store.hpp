@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Read-only memory mapping of an image file.  Instances are created by
+ * ImageStore and shared between every Image that refers to the same path.
+ * A mapping may instead be a view into an arena holding a whole image set,
+ * or into the mapping of a flash image bundle.
+ */
+class ImageMapping {
+public:
+    ~ImageMapping();
+
+    ImageMapping(const ImageMapping &) = delete;
+    ImageMapping &operator=(const ImageMapping &) = delete;
+
+    const uint8_t *GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+    const std::string &GetPath() const { return m_path; }
+
+    /** Start paging in up to length bytes from the front of the mapping. */
+    void Prefetch(size_t length) const;
+
+private:
+    friend class ImageStore;
+    friend class FlashImageBundle;
+
+    ImageMapping(const std::string &path) : m_path(path) {}
+    bool Map();
+    bool IsCurrent() const;
+
+    std::string m_path;
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+    std::filesystem::file_time_type m_writeTime{};
+    // Set for a view into an arena, which owns m_data.
+    std::shared_ptr<const uint8_t> m_arena;
+    // Set for a view into a bundle, whose mapping holds m_data.
+    std::shared_ptr<const ImageMapping> m_parent;
+#if defined(PLATFORM_WINDOWS)
+    void *m_fileHandle = nullptr;
+    void *m_mappingHandle = nullptr;
+#endif
+};
+
+/**
+ * Process-wide store of image mappings, owned by the device manager.  Each
+ * file is mapped once and the mapping is handed out to every device thread.
+ * Mappings are reference counted: the file is unmapped when the last Image
+ * using it is destroyed, and remapped if it changes on disk in between.
+ */
+class ImageStore {
+public:
+    /**
+     * Return the shared mapping for path, mapping the file if needed.
+     * @return nullptr if the file cannot be mapped; callers fall back to
+     *         regular file reads.
+     */
+    std::shared_ptr<const ImageMapping> Acquire(const std::string &path);
+
+    /**
+     * Read the files at paths once into one contiguous read-only arena and
+     * return a view of each, in the same order.  Boot image sets are served
+     * back to back and sometimes more than once, so they are kept in memory
+     * rather than paged in from their files.  The arena is shared like a
+     * mapping and read again if one of its files changes on disk.
+     * @return an empty vector if the files cannot be read or do not fit
+     *         kMaxArenaSize; callers fall back to Acquire().
+     */
+    std::vector<std::shared_ptr<const ImageMapping>> AcquireArena(const std::vector<std::string> &paths);
+
+    static constexpr size_t kMaxArenaSize = 64 * 1024 * 1024;
+
+private:
+    // Of the arena itself and of each image in it.
+    static constexpr size_t kArenaAlignment = 64;
+
+    static std::vector<std::shared_ptr<const ImageMapping>> LoadArena(const std::vector<std::string> &paths);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::weak_ptr<const ImageMapping>> m_mappings;
+    // Arena views by their files' paths, joined with newlines.
+    std::unordered_map<std::string, std::vector<std::weak_ptr<const ImageMapping>>> m_arenas;
+};
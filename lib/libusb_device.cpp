@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <new>
 
 #include "libusb_device.hpp"
 #include "astra_log.hpp"
@@ -346,6 +347,52 @@ int LibUSBDevice::ReadBulk(uint8_t *data, size_t size, int *transferred, int tim
     return (ret == LIBUSB_ERROR_TIMEOUT && actualTransferred == 0) ? LIBUSB_ERROR_TIMEOUT : 0;
 }
 
+int LibUSBDevice::ReadBulkAsync(uint8_t *data, size_t size, int timeoutMs, std::function<void(int result, int transferred)> done)
+{
+    ASTRA_LOG;
+
+    if (!m_running.load()) {
+        return -1;
+    }
+
+    if (m_bulkInEndpoint == 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Bulk IN endpoint not available" << endLog;
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_bulkReadMutex);
+    if (m_bulkReadInFlight) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Bulk read already in flight" << endLog;
+        return -1;
+    }
+
+    if (m_bulkReadXfer == nullptr) {
+        m_bulkReadXfer = libusb_alloc_transfer(0);
+        if (m_bulkReadXfer == nullptr) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to allocate bulk in transfer" << endLog;
+            return -1;
+        }
+    }
+
+    libusb_fill_bulk_transfer(m_bulkReadXfer, m_handle, m_bulkInEndpoint, data, static_cast<int>(size),
+        HandleBulkReadTransfer, this, static_cast<unsigned int>(timeoutMs));
+
+    m_bulkReadDone = std::move(done);
+    int ret = libusb_submit_transfer(m_bulkReadXfer);
+    if (ret < 0) {
+        m_bulkReadDone = nullptr;
+        if (ret == LIBUSB_ERROR_NO_DEVICE) {
+            m_running.store(false);
+        }
+        const auto level = (ret == LIBUSB_ERROR_PIPE || ret == LIBUSB_ERROR_NO_DEVICE) ? ASTRA_LOG_LEVEL_DEBUG : ASTRA_LOG_LEVEL_ERROR;
+        log(level) << "ReadBulkAsync failed: " << libusb_error_name(ret) << endLog;
+        return ret;
+    }
+    m_bulkReadInFlight = true;
+
+    return 0;
+}
+
 int LibUSBDevice::EnableInterrupts()
 {
     ASTRA_LOG;
@@ -357,14 +404,10 @@ void LibUSBDevice::Close()
     ASTRA_LOG;
 
     m_writeCompleteCV.notify_all();
+    m_writeQueueCV.notify_all();
 
     // Stop callback thread
-    if (m_callbackThreadRunning.exchange(false)) {
-        m_callbackQueueCV.notify_all();
-        if (m_callbackThread.joinable()) {
-            m_callbackThread.join();
-        }
-    }
+    StopCallbackWorker();
 
     std::lock_guard<std::mutex> lock(m_closeMutex);
     if (!m_shutdown.exchange(true))
@@ -397,11 +440,40 @@ void LibUSBDevice::Close()
             }
         }
 
+        bool waitForBulkRead = false;
+        {
+            std::lock_guard<std::mutex> readLock(m_bulkReadMutex);
+            if (m_bulkReadInFlight && libusb_cancel_transfer(m_bulkReadXfer) == 0) {
+                waitForBulkRead = true;
+            }
+        }
+
+        // Queued writes signal completion (including cancellation) by
+        // dropping m_writeQueueInFlight, so there is no per-slot flag to track.
+        {
+            std::lock_guard<std::mutex> queueLock(m_writeQueueMutex);
+            for (auto &slot : m_writeQueue) {
+                if (slot.inFlight) {
+                    libusb_cancel_transfer(slot.xfer);
+                }
+            }
+        }
+        const bool waitForQueuedWrites = m_writeQueueInFlight.load() > 0;
+
         // Wait for cancellation callbacks to complete.
         // If cancellation exceeds the soft timeout, continue waiting up to a hard timeout.
-        if (waitForInputInterrupt || waitForOutputInterrupt || waitForBulkWrite) {
+        if (waitForInputInterrupt || waitForOutputInterrupt || waitForBulkWrite || waitForQueuedWrites || waitForBulkRead) {
             auto allCancelled = [&]() {
                 bool allDone = true;
+                if (waitForBulkRead) {
+                    std::lock_guard<std::mutex> readLock(m_bulkReadMutex);
+                    if (m_bulkReadInFlight) {
+                        allDone = false;
+                    }
+                }
+                if (waitForQueuedWrites && m_writeQueueInFlight.load() > 0) {
+                    allDone = false;
+                }
                 if (waitForInputInterrupt && !m_inputInterruptCancelled.load()) {
                     allDone = false;
                 }
@@ -468,6 +540,49 @@ void LibUSBDevice::Close()
             m_bulkWriteXfer = nullptr;
         }
 
+        {
+            std::lock_guard<std::mutex> readLock(m_bulkReadMutex);
+            if (m_bulkReadXfer) {
+                if (!m_bulkReadInFlight) {
+                    libusb_free_transfer(m_bulkReadXfer);
+                } else {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "Leaking bulk read transfer to avoid unsafe free while cancellation is pending" << endLog;
+                }
+                m_bulkReadXfer = nullptr;
+            }
+        }
+
+        std::vector<std::function<void()>> waiters;
+        {
+            std::unique_lock<std::mutex> queueLock(m_writeQueueMutex);
+            // A writer filling a buffer from AcquireWriteBuffer() commits (and
+            // fails, as m_running is clear) once it is done with it.
+            if (!m_writeQueueCV.wait_for(queueLock, std::chrono::seconds(10), [this] { return !m_writeBufferReserved; })) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Reserved write buffer was not committed; leaking it" << endLog;
+                m_writeQueue[m_writeQueueHead].buffer = nullptr;
+                m_writeQueue[m_writeQueueHead].capacity = 0;
+                m_writeBufferReserved = false;
+            }
+            for (auto &slot : m_writeQueue) {
+                if (slot.inFlight) {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "Leaking queued bulk write transfer to avoid unsafe free while cancellation is pending" << endLog;
+                } else {
+                    if (slot.xfer) {
+                        libusb_free_transfer(slot.xfer);
+                    }
+                    // Device memory must be released before the handle is closed below.
+                    FreeSlotBuffer(slot);
+                }
+                slot = QueuedWrite{};
+            }
+            m_writeQueueHead = 0;
+            TakeWriteQueueWaitersLocked(waiters, true);
+        }
+        // Pollers find the device closed when they resume.
+        for (auto &waiter : waiters) {
+            waiter();
+        }
+
         delete[] m_interruptInBuffer;
         m_interruptInBuffer = nullptr;
 
@@ -500,19 +615,31 @@ int LibUSBDevice::Write(uint8_t *data, size_t size, int *transferred)
         return -1;
     }
 
+    // Keep the byte stream ordered with respect to any writes still queued.
+    if (m_writeQueueInFlight.load() > 0 && FlushQueuedWrites() < 0) {
+        return -1;
+    }
+
     m_actualBytesWritten = 0;
 
-    log(ASTRA_LOG_LEVEL_DEBUG) << "Writing to USB device" << endLog;
-    log(ASTRA_LOG_LEVEL_DEBUG) << "  Bulk Out Endpoint: " << static_cast<int>(m_bulkOutEndpoint) << endLog;
-    log(ASTRA_LOG_LEVEL_DEBUG) << "  Length: " << size << endLog;
-    log(ASTRA_LOG_LEVEL_DEBUG) << "  Data: ";
-    for (size_t i = 0; i < 16 && i < size; ++i) {
-        log << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]) << " ";
+    if (ASTRA_LOG_ENABLED(ASTRA_LOG_LEVEL_DEBUG)) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Writing to USB device" << endLog;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "  Bulk Out Endpoint: " << static_cast<int>(m_bulkOutEndpoint) << endLog;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "  Length: " << size << endLog;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "  Data: ";
+        for (size_t i = 0; i < 16 && i < size; ++i) {
+            log << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]) << " ";
+        }
+        log << std::dec << endLog;
     }
-    log << std::dec << endLog;
 
     libusb_fill_bulk_transfer(m_bulkWriteXfer, m_handle, m_bulkOutEndpoint, data, size, HandleTransfer, this, m_bulkTransferTimeout);
 
+    if (m_transferStats) {
+        m_transferStats->MarkWrite();
+    }
+    const auto submitTime = std::chrono::steady_clock::now();
+
     for (;;) {
         int ret = libusb_submit_transfer(m_bulkWriteXfer);
         if (ret < 0) {
@@ -556,12 +683,282 @@ int LibUSBDevice::Write(uint8_t *data, size_t size, int *transferred)
 
     *transferred = m_actualBytesWritten;
 
+    if (m_transferStats && !writeError) {
+        m_transferStats->RecordWriteLatency(std::chrono::steady_clock::now() - submitTime);
+    }
+
     log(ASTRA_LOG_LEVEL_DEBUG) << "Write Complete: bytes written: " << m_actualBytesWritten
         << (writeError ? " [ERROR]" : "") << endLog;
 
     return writeError ? -1 : 0;
 }
 
+int LibUSBDevice::WriteQueued(const uint8_t *data, size_t size)
+{
+    ASTRA_LOG;
+
+    if (size == 0) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+    QueuedWrite *slot = ReserveWriteSlot(lock, size);
+    if (slot == nullptr) {
+        return -1;
+    }
+
+    std::memcpy(slot->buffer, data, size);
+
+    return SubmitQueuedWrite(*slot, size);
+}
+
+uint8_t *LibUSBDevice::AcquireWriteBuffer(size_t size)
+{
+    ASTRA_LOG;
+
+    std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+    if (m_writeBufferReserved) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Write buffer already reserved" << endLog;
+        return nullptr;
+    }
+
+    QueuedWrite *slot = ReserveWriteSlot(lock, std::max<size_t>(size, 1));
+    if (slot == nullptr) {
+        return nullptr;
+    }
+
+    // The caller fills the buffer without the lock; Close() waits for the
+    // commit before freeing it.
+    m_writeBufferReserved = true;
+    return slot->buffer;
+}
+
+int LibUSBDevice::CommitQueuedWrite(size_t size)
+{
+    ASTRA_LOG;
+
+    std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+    if (!m_writeBufferReserved) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Commit without a reserved write buffer" << endLog;
+        return -1;
+    }
+    m_writeBufferReserved = false;
+    m_writeQueueCV.notify_all();
+
+    if (size == 0) {
+        return 0;
+    }
+
+    QueuedWrite &slot = m_writeQueue[m_writeQueueHead];
+    if (!m_running.load()) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Queued write aborted: device shut down" << endLog;
+        return -1;
+    }
+
+    if (size > slot.capacity) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Commit of " << size << " bytes exceeds reserved buffer of "
+            << slot.capacity << " bytes" << endLog;
+        return -1;
+    }
+
+    return SubmitQueuedWrite(slot, size);
+}
+
+LibUSBDevice::QueuedWrite *LibUSBDevice::ReserveWriteSlot(std::unique_lock<std::mutex> &lock, size_t size)
+{
+    ASTRA_LOG;
+
+    // Slots are reused in submission order, so waiting on the head slot also
+    // preserves the order in which completions are collected.
+    QueuedWrite &slot = m_writeQueue[m_writeQueueHead];
+    m_writeQueueCV.wait(lock, [this, &slot] {
+        return !slot.inFlight || !m_running.load();
+    });
+
+    if (!m_running.load()) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Queued write aborted: device shut down" << endLog;
+        return nullptr;
+    }
+
+    if (m_writeQueueError.load()) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Earlier queued write failed, not queueing more data" << endLog;
+        return nullptr;
+    }
+
+    if (slot.xfer == nullptr) {
+        slot.xfer = libusb_alloc_transfer(0);
+        if (slot.xfer == nullptr) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to allocate queued bulk out transfer" << endLog;
+            return nullptr;
+        }
+    }
+
+    if (slot.capacity < size && !AllocSlotBuffer(slot, size)) {
+        return nullptr;
+    }
+
+    return &slot;
+}
+
+bool LibUSBDevice::AllocSlotBuffer(QueuedWrite &slot, size_t size)
+{
+    ASTRA_LOG;
+
+    FreeSlotBuffer(slot);
+
+    slot.buffer = libusb_dev_mem_alloc(m_handle, size);
+    slot.devMem = (slot.buffer != nullptr);
+    if (!slot.devMem) {
+        // Not supported by this backend, or the usbfs memory limit was reached.
+        if (!m_devMemUnavailableLogged) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "libusb_dev_mem_alloc unavailable, using heap transfer buffers" << endLog;
+            m_devMemUnavailableLogged = true;
+        }
+        slot.buffer = static_cast<uint8_t *>(::operator new[](size, std::align_val_t(kTransferBufferAlignment),
+            std::nothrow));
+        if (slot.buffer == nullptr) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to allocate " << size << " byte transfer buffer" << endLog;
+            return false;
+        }
+    }
+    slot.capacity = size;
+
+    return true;
+}
+
+void LibUSBDevice::FreeSlotBuffer(QueuedWrite &slot)
+{
+    if (slot.buffer != nullptr) {
+        if (slot.devMem) {
+            libusb_dev_mem_free(m_handle, slot.buffer, slot.capacity);
+        } else {
+            ::operator delete[](slot.buffer, std::align_val_t(kTransferBufferAlignment));
+        }
+    }
+    slot.buffer = nullptr;
+    slot.capacity = 0;
+    slot.devMem = false;
+}
+
+int LibUSBDevice::SubmitQueuedWrite(QueuedWrite &slot, size_t size)
+{
+    ASTRA_LOG;
+
+    libusb_fill_bulk_transfer(slot.xfer, m_handle, m_bulkOutEndpoint, slot.buffer, static_cast<int>(size),
+        HandleQueuedWriteTransfer, this, m_bulkTransferTimeout);
+
+    if (m_transferStats) {
+        m_transferStats->MarkWrite();
+    }
+    slot.submitTime = std::chrono::steady_clock::now();
+
+    for (;;) {
+        int ret = libusb_submit_transfer(slot.xfer);
+        if (ret < 0) {
+            if (ret == LIBUSB_ERROR_NO_DEVICE) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "USB device is no longer available" << endLog;
+                m_running.store(false);
+            } else if (ret == LIBUSB_ERROR_PIPE && m_writeQueueInFlight.load() == 0) {
+                log(ASTRA_LOG_LEVEL_WARNING) << "Endpoint halted, clearing halt" << endLog;
+                ret = libusb_clear_halt(m_handle, m_bulkOutEndpoint);
+                if (ret < 0) {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "Failed to clear halt on endpoint: " << libusb_error_name(ret) << endLog;
+                } else {
+                    log(ASTRA_LOG_LEVEL_INFO) << "Halt cleared, retrying transfer" << endLog;
+                    continue;
+                }
+            } else {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to queue write to USB device: " << libusb_error_name(ret) << endLog;
+            }
+            return -1;
+        }
+        break;
+    }
+
+    slot.inFlight = true;
+    m_writeQueueInFlight.fetch_add(1);
+    m_writeQueueHead = (m_writeQueueHead + 1) % m_writeQueueDepth;
+
+    return 0;
+}
+
+size_t LibUSBDevice::GetWriteQueueDepth() const
+{
+    std::lock_guard<std::mutex> lock(m_writeQueueMutex);
+    return m_writeQueueDepth;
+}
+
+bool LibUSBDevice::SetWriteQueueDepth(size_t depth)
+{
+    ASTRA_LOG;
+
+    std::lock_guard<std::mutex> lock(m_writeQueueMutex);
+    if (depth == 0 || depth > kMaxWriteQueueDepth || m_writeQueueInFlight.load() > 0 || m_writeBufferReserved) {
+        return false;
+    }
+
+    // Shrinking frees the buffers of the slots no longer used.
+    for (size_t i = depth; i < m_writeQueueDepth; ++i) {
+        FreeSlotBuffer(m_writeQueue[i]);
+    }
+    m_writeQueueDepth = depth;
+    m_writeQueueHead = 0;
+    return true;
+}
+
+int LibUSBDevice::FlushQueuedWrites()
+{
+    ASTRA_LOG;
+
+    std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+    m_writeQueueCV.wait(lock, [this] {
+        return m_writeQueueInFlight.load() == 0 || !m_running.load();
+    });
+
+    const bool writeError = m_writeQueueError.exchange(false);
+
+    if (m_writeQueueInFlight.load() > 0) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Flush aborted: device shut down" << endLog;
+        return -1;
+    }
+
+    return writeError ? -1 : 0;
+}
+
+bool LibUSBDevice::PollWriteBuffer(std::function<void()> onReady)
+{
+    std::lock_guard<std::mutex> lock(m_writeQueueMutex);
+    if (!m_writeQueue[m_writeQueueHead].inFlight || !m_running.load()) {
+        return true;
+    }
+
+    m_writeBufferWaiter = std::move(onReady);
+    return false;
+}
+
+bool LibUSBDevice::PollQueuedWrites(std::function<void()> onFlushed)
+{
+    std::lock_guard<std::mutex> lock(m_writeQueueMutex);
+    if (m_writeQueueInFlight.load() == 0 || !m_running.load()) {
+        return true;
+    }
+
+    m_flushWaiter = std::move(onFlushed);
+    return false;
+}
+
+void LibUSBDevice::TakeWriteQueueWaitersLocked(std::vector<std::function<void()>> &ready, bool force)
+{
+    if (m_writeBufferWaiter && (force || !m_writeQueue[m_writeQueueHead].inFlight)) {
+        ready.push_back(std::move(m_writeBufferWaiter));
+        m_writeBufferWaiter = nullptr;
+    }
+    if (m_flushWaiter && (force || m_writeQueueInFlight.load() == 0)) {
+        ready.push_back(std::move(m_flushWaiter));
+        m_flushWaiter = nullptr;
+    }
+}
+
 int LibUSBDevice::WriteInterruptData(const uint8_t *data, size_t size)
 {
     ASTRA_LOG;
@@ -570,14 +967,16 @@ int LibUSBDevice::WriteInterruptData(const uint8_t *data, size_t size)
         return -1;
     }
 
-    log(ASTRA_LOG_LEVEL_DEBUG) << "Sending interrupt out transfer" << endLog;
-    log(ASTRA_LOG_LEVEL_DEBUG) << "  Interrupt Out Endpoint: " << static_cast<int>(m_interruptOutEndpoint) << endLog;
-    log(ASTRA_LOG_LEVEL_DEBUG) << "  Length: " << size << endLog;
-    log(ASTRA_LOG_LEVEL_DEBUG) << "  Data: ";
-    for (size_t i = 0; i < 16 && i < size; ++i) {
-        log << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]) << " ";
+    if (ASTRA_LOG_ENABLED(ASTRA_LOG_LEVEL_DEBUG)) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Sending interrupt out transfer" << endLog;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "  Interrupt Out Endpoint: " << static_cast<int>(m_interruptOutEndpoint) << endLog;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "  Length: " << size << endLog;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "  Data: ";
+        for (size_t i = 0; i < 16 && i < size; ++i) {
+            log << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]) << " ";
+        }
+        log << std::dec << endLog;
     }
-    log << std::dec << endLog;
 
     std::memcpy(m_interruptOutBuffer, data, size);
 
@@ -626,14 +1025,7 @@ void LibUSBDevice::HandleTransfer(struct libusb_transfer *transfer)
     bool resubmit = false;
 
     auto queueEvent = [device](USBDevice::USBEvent event, uint8_t *buf, size_t size) {
-        CallbackEvent cbEvent;
-        cbEvent.event = event;
-        if (buf && size > 0) {
-            cbEvent.data.assign(buf, buf + size);
-        }
-        std::lock_guard<std::mutex> lock(device->m_callbackQueueMutex);
-        device->m_callbackQueue.push(std::move(cbEvent));
-        device->m_callbackQueueCV.notify_one();
+        device->QueueCallbackEvent(event, buf, size);
     };
 
     if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
@@ -768,3 +1160,126 @@ void LibUSBDevice::HandleTransfer(struct libusb_transfer *transfer)
         }
     }
 }
+
+void LibUSBDevice::HandleQueuedWriteTransfer(struct libusb_transfer *transfer)
+{
+    ASTRA_LOG;
+
+    LibUSBDevice *device = static_cast<LibUSBDevice*>(transfer->user_data);
+
+    bool writeError = true;
+    bool noDevice = false;
+    std::vector<std::function<void()>> waiters;
+
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+        if (transfer->actual_length == transfer->length) {
+            writeError = false;
+        } else {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Short queued write: " << transfer->actual_length
+                << " of " << transfer->length << " bytes" << endLog;
+        }
+    } else if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
+        device->m_running.store(false);
+        noDevice = true;
+        log(ASTRA_LOG_LEVEL_INFO) << "Device is no longer there during queued write" << endLog;
+    } else if (transfer->status == LIBUSB_TRANSFER_CANCELLED) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Queued write cancelled" << endLog;
+    } else {
+        // Later slots may already be in flight, so a stalled chunk cannot be
+        // resubmitted without reordering the stream; fail the write instead.
+        log(ASTRA_LOG_LEVEL_ERROR) << "Queued write failed: " << libusb_error_name(transfer->status) << endLog;
+        if (transfer->status == LIBUSB_TRANSFER_STALL) {
+            int ret = libusb_clear_halt(device->m_handle, transfer->endpoint);
+            if (ret < 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to clear halt on endpoint: " << libusb_error_name(ret) << endLog;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(device->m_writeQueueMutex);
+        for (auto &slot : device->m_writeQueue) {
+            if (slot.xfer == transfer) {
+                slot.inFlight = false;
+                if (device->m_transferStats && !writeError) {
+                    device->m_transferStats->RecordWriteLatency(std::chrono::steady_clock::now() - slot.submitTime);
+                }
+                break;
+            }
+        }
+        if (writeError) {
+            device->m_writeQueueError.store(true);
+        }
+        device->m_writeQueueInFlight.fetch_sub(1);
+        // After a failure the pollers resume to collect it.
+        device->TakeWriteQueueWaitersLocked(waiters, writeError || !device->m_running.load());
+    }
+    device->m_writeQueueCV.notify_all();
+    for (auto &waiter : waiters) {
+        waiter();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(device->m_cancellationMutex);
+    }
+    device->m_cancellationCV.notify_one();
+
+    if (noDevice) {
+        device->QueueCallbackEvent(USB_DEVICE_EVENT_NO_DEVICE);
+    }
+}
+
+void LibUSBDevice::HandleBulkReadTransfer(struct libusb_transfer *transfer)
+{
+    ASTRA_LOG;
+
+    LibUSBDevice *device = static_cast<LibUSBDevice*>(transfer->user_data);
+    const int transferred = transfer->actual_length;
+
+    // The results libusb_bulk_transfer() gives ReadBulk().
+    int result;
+    switch (transfer->status) {
+    case LIBUSB_TRANSFER_COMPLETED:
+        result = 0;
+        break;
+    case LIBUSB_TRANSFER_TIMED_OUT:
+        result = transferred > 0 ? 0 : LIBUSB_ERROR_TIMEOUT;
+        break;
+    case LIBUSB_TRANSFER_NO_DEVICE:
+        device->m_running.store(false);
+        result = LIBUSB_ERROR_NO_DEVICE;
+        break;
+    case LIBUSB_TRANSFER_CANCELLED:
+        result = LIBUSB_ERROR_INTERRUPTED;
+        break;
+    case LIBUSB_TRANSFER_STALL:
+        result = LIBUSB_ERROR_PIPE;
+        break;
+    default:
+        result = LIBUSB_ERROR_IO;
+        break;
+    }
+
+    if (result < 0 && result != LIBUSB_ERROR_TIMEOUT) {
+        // As for ReadBulk(), PIPE errors are expected when the device resets mid-transfer.
+        const auto level = (result == LIBUSB_ERROR_IO) ? ASTRA_LOG_LEVEL_ERROR : ASTRA_LOG_LEVEL_DEBUG;
+        log(level) << "ReadBulkAsync failed: " << libusb_error_name(result) << endLog;
+    }
+
+    std::function<void(int result, int transferred)> done;
+    {
+        std::lock_guard<std::mutex> lock(device->m_bulkReadMutex);
+        done = std::move(device->m_bulkReadDone);
+        device->m_bulkReadDone = nullptr;
+        device->m_bulkReadInFlight = false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(device->m_cancellationMutex);
+    }
+    device->m_cancellationCV.notify_one();
+
+    if (done) {
+        done(result, transferred);
+    }
+}
@@ -6,6 +6,8 @@
 #include "usb_device.hpp"
 #include "astra_log.hpp"
 
+#include <array>
+#include <chrono>
 #include <libusb-1.0/libusb.h>
 
 class LibUSBDevice : public USBDevice {
@@ -36,6 +38,16 @@ public:
 
     int Write(uint8_t *data, size_t size, int *transferred) override;
     int ReadBulk(uint8_t *data, size_t size, int *transferred, int timeoutMs = 5000) override;
+    int WriteQueued(const uint8_t *data, size_t size) override;
+    int FlushQueuedWrites() override;
+    bool PollWriteBuffer(std::function<void()> onReady) override;
+    bool PollQueuedWrites(std::function<void()> onFlushed) override;
+    int ReadBulkAsync(uint8_t *data, size_t size, int timeoutMs, std::function<void(int result, int transferred)> done) override;
+    uint8_t *AcquireWriteBuffer(size_t size) override;
+    int CommitQueuedWrite(size_t size) override;
+    size_t GetWriteQueueDepth() const override;
+    size_t GetMaxWriteQueueDepth() const override { return kMaxWriteQueueDepth; }
+    bool SetWriteQueueDepth(size_t depth) override;
 
     int WriteInterruptData(const uint8_t *data, size_t size) override;
     uint16_t GetVendorId() const override;
@@ -70,5 +82,50 @@ protected:
 
     int m_bulkTransferTimeout;
 
+    // Ring of bulk OUT transfers used by WriteQueued().  Each slot owns its
+    // buffer so the caller can reuse its own buffer as soon as the call returns.
+    // Buffers come from libusb_dev_mem_alloc() when the backend supports it,
+    // so usbfs can submit them without copying into kernel memory.
+    struct QueuedWrite {
+        struct libusb_transfer *xfer = nullptr;
+        uint8_t *buffer = nullptr;
+        size_t capacity = 0;
+        bool devMem = false;
+        bool inFlight = false;
+        std::chrono::steady_clock::time_point submitTime{};
+    };
+    static constexpr size_t kDefaultWriteQueueDepth = 4;
+    static constexpr size_t kMaxWriteQueueDepth = 8;
+    std::array<QueuedWrite, kMaxWriteQueueDepth> m_writeQueue;
+    // Slots in use; the rest keep no buffer until the depth grows.
+    size_t m_writeQueueDepth = kDefaultWriteQueueDepth;
+    size_t m_writeQueueHead = 0;
+    std::atomic<size_t> m_writeQueueInFlight{0};
+    std::atomic<bool> m_writeQueueError{false};
+    mutable std::mutex m_writeQueueMutex;
+    std::condition_variable m_writeQueueCV;
+    // Head slot handed out by AcquireWriteBuffer() and not yet committed.
+    bool m_writeBufferReserved = false;
+    bool m_devMemUnavailableLogged = false;
+    // PollWriteBuffer() and PollQueuedWrites() callbacks still to be called.
+    std::function<void()> m_writeBufferWaiter;
+    std::function<void()> m_flushWaiter;
+
+    // ReadBulkAsync() transfer, allocated on first use.
+    struct libusb_transfer *m_bulkReadXfer = nullptr;
+    std::function<void(int result, int transferred)> m_bulkReadDone;
+    bool m_bulkReadInFlight = false;
+    std::mutex m_bulkReadMutex;
+
+    QueuedWrite *ReserveWriteSlot(std::unique_lock<std::mutex> &lock, size_t size);
+    int SubmitQueuedWrite(QueuedWrite &slot, size_t size);
+    bool AllocSlotBuffer(QueuedWrite &slot, size_t size);
+    void FreeSlotBuffer(QueuedWrite &slot);
+
     static void LIBUSB_CALL HandleTransfer(struct libusb_transfer *transfer);
+    static void LIBUSB_CALL HandleQueuedWriteTransfer(struct libusb_transfer *transfer);
+    static void LIBUSB_CALL HandleBulkReadTransfer(struct libusb_transfer *transfer);
+
+    // Take the poll callbacks which may run now; call with m_writeQueueMutex held.
+    void TakeWriteQueueWaitersLocked(std::vector<std::function<void()>> &ready, bool force);
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2025 Synaptics Incorporated
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <libusb-1.0/libusb.h>
@@ -13,6 +14,7 @@
 
 #include "libusb_transport.hpp"
 #include "astra_log.hpp"
+#include "thread_policy.hpp"
 
 LibUSBTransport::~LibUSBTransport()
 {
@@ -31,12 +33,17 @@ void LibUSBTransport::DeviceMonitorThread()
 
     int ret;
 
+    // Block until libusb has work: transfer completions and hotplug events are
+    // dispatched as soon as they arrive, libusb wakes up on its own for the next
+    // transfer timeout, and Shutdown() breaks the wait with
+    // libusb_interrupt_event_handler().  Synchronous calls such as ReadBulk()
+    // wait as event waiters and are signalled on each completion, so no
+    // polling tick is needed.
     while (m_running.load()) {
-        struct timeval tv = { 0, 100000 }; // 100 ms – reduces worst-case delay when synchronous ReadBulk
-        ret = libusb_handle_events_timeout_completed(m_ctx, &tv, nullptr);
+        ret = libusb_handle_events_completed(m_ctx, nullptr);
         if (ret < 0) {
             if (ret == LIBUSB_ERROR_INTERRUPTED) {
-                log(ASTRA_LOG_LEVEL_DEBUG) << "libusb_handle_events_timeout_completed interrupted" << endLog;
+                log(ASTRA_LOG_LEVEL_DEBUG) << "libusb_handle_events_completed interrupted" << endLog;
                 continue;
             }
             log(ASTRA_LOG_LEVEL_ERROR) << "Failed to handle events: " << libusb_error_name(ret) << endLog;
@@ -76,24 +83,7 @@ int LibUSBTransport::Init(std::vector<USBVendorProductId> vendorProductIds, cons
         log(ASTRA_LOG_LEVEL_DEBUG) << "Hotplug is supported" << endLog;
 
         for (const auto& [vid, pid] : m_supportedDevices) {
-            libusb_hotplug_callback_handle handle = 0;
-            ret = libusb_hotplug_register_callback(m_ctx,
-                                                    LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
-                                                    LIBUSB_HOTPLUG_ENUMERATE,
-                                                    vid,
-                                                    pid,
-                                                    LIBUSB_HOTPLUG_MATCH_ANY,
-                                                    HotplugEventCallback,
-                                                    this,
-                                                    &handle);
-            if (ret == LIBUSB_SUCCESS) {
-                m_callbackHandles.push_back(handle);
-            } else {
-                log(ASTRA_LOG_LEVEL_ERROR) << "Failed to register hotplug callback for VID:0x"
-                    << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << vid
-                    << " PID:0x" << std::setw(4) << std::setfill('0') << pid << std::dec
-                    << ": " << libusb_error_name(ret) << endLog;
-            }
+            RegisterHotplugCallback(vid, pid);
         }
         ret = m_callbackHandles.empty() ? LIBUSB_ERROR_NOT_FOUND : LIBUSB_SUCCESS;
 
@@ -106,6 +96,93 @@ int LibUSBTransport::Init(std::vector<USBVendorProductId> vendorProductIds, cons
     return ret;
 }
 
+bool LibUSBTransport::RegisterHotplugCallback(uint16_t vendorId, uint16_t productId)
+{
+    ASTRA_LOG;
+
+    libusb_hotplug_callback_handle handle = 0;
+    int ret = libusb_hotplug_register_callback(m_ctx,
+                                            LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                            LIBUSB_HOTPLUG_ENUMERATE,
+                                            vendorId,
+                                            productId,
+                                            LIBUSB_HOTPLUG_MATCH_ANY,
+                                            HotplugEventCallback,
+                                            this,
+                                            &handle);
+    if (ret != LIBUSB_SUCCESS) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to register hotplug callback for VID:0x"
+            << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << vendorId
+            << " PID:0x" << std::setw(4) << std::setfill('0') << productId << std::dec
+            << ": " << libusb_error_name(ret) << endLog;
+        return false;
+    }
+
+    m_callbackHandles.push_back(handle);
+    return true;
+}
+
+int LibUSBTransport::Reconfigure(const std::vector<USBVendorProductId> &vendorProductIds, const std::string &filterPorts)
+{
+    ASTRA_LOG;
+
+    std::lock_guard<std::mutex> shutdownLock(m_shutdownMutex);
+    if (!m_running.load() || !libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        return -1;
+    }
+
+    std::vector<USBVendorProductId> previousDevices;
+    std::vector<std::string> previousPorts;
+    std::vector<USBVendorProductId> addedDevices;
+    {
+        std::lock_guard<std::mutex> lock(m_filterMutex);
+        previousDevices = m_supportedDevices;
+        previousPorts = m_filterPorts;
+        m_filterPorts = ParseFilterPortString(filterPorts);
+        for (const auto &id : vendorProductIds) {
+            if (std::find(m_supportedDevices.begin(), m_supportedDevices.end(), id) == m_supportedDevices.end()) {
+                m_supportedDevices.push_back(id);
+                addedDevices.push_back(id);
+            }
+        }
+    }
+
+    // Hotplug only reports arrivals, so devices that were connected on a
+    // newly covered port, and filtered out then, have to be found here.
+    if (!previousPorts.empty()) {
+        libusb_device **deviceList = nullptr;
+        const ssize_t count = libusb_get_device_list(m_ctx, &deviceList);
+        for (ssize_t i = 0; i < count; ++i) {
+            libusb_device *device = deviceList[i];
+            libusb_device_descriptor desc;
+            if (libusb_get_device_descriptor(device, &desc) < 0 ||
+                std::find(previousDevices.begin(), previousDevices.end(),
+                    USBVendorProductId{desc.idVendor, desc.idProduct}) == previousDevices.end())
+            {
+                continue;
+            }
+
+            const std::string usbPath = ConstructUSBPath(device);
+            if (!IsPortInFilter(usbPath, previousPorts) && IsValidPort(device, usbPath)) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Device " << usbPath << " is on a newly monitored port" << endLog;
+                QueueArrival(device, usbPath);
+            }
+        }
+        if (count >= 0) {
+            libusb_free_device_list(deviceList, 1);
+        }
+    }
+
+    // New IDs get their own callbacks, which enumerate the connected devices.
+    for (const auto &[vid, pid] : addedDevices) {
+        if (!RegisterHotplugCallback(vid, pid)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 void LibUSBTransport::Shutdown()
 {
     ASTRA_LOG;
@@ -117,6 +194,9 @@ void LibUSBTransport::Shutdown()
         }
         m_callbackHandles.clear();
 
+        // DeviceMonitorThread blocks without a timeout; wake it so it sees
+        // m_running is false.  The interrupt is latched, so it is not lost if
+        // the thread is between two waits.
         libusb_interrupt_event_handler(m_ctx);
         if (m_deviceMonitorThread.joinable()) {
             m_deviceMonitorThread.join();
@@ -140,8 +220,8 @@ void LibUSBTransport::StartDeviceMonitor()
 {
     ASTRA_LOG;
 
-    m_deviceMonitorThread = std::thread(&LibUSBTransport::DeviceMonitorThread, this);
-    m_callbackWorkerThread = std::thread(&LibUSBTransport::CallbackWorkerThread, this);
+    m_deviceMonitorThread = ThreadPolicy::Start(THREAD_ROLE_USB, "astra-usb-event", &LibUSBTransport::DeviceMonitorThread, this);
+    m_callbackWorkerThread = ThreadPolicy::Start(THREAD_ROLE_USB, "astra-usb-cb", &LibUSBTransport::CallbackWorkerThread, this);
 }
 
 void LibUSBTransport::CallbackWorkerThread()
@@ -199,17 +279,12 @@ bool LibUSBTransport::IsValidPort(libusb_device *device, const std::string &devi
 {
     ASTRA_LOG;
 
+    std::lock_guard<std::mutex> lock(m_filterMutex);
     if (m_filterPorts.empty()) {
         return true;
     }
 
-    for (const auto& port : m_filterPorts) {
-        if (devicePath.rfind(port, 0) == 0) {
-            return true;
-        }
-    }
-
-    return false;
+    return IsPortInFilter(devicePath, m_filterPorts);
 }
 
 int LIBUSB_CALL LibUSBTransport::HotplugEventCallback(libusb_context *ctx, libusb_device *device,
@@ -253,29 +328,36 @@ int LIBUSB_CALL LibUSBTransport::HotplugEventCallback(libusb_context *ctx, libus
             return 0;
         }
 
-        // Validate device is accessible before passing to callback
-        // If the device is in a bad state (e.g., kernel failed to configure it),
-        // skip it and wait for re-enumeration
-        libusb_device_handle *handle = nullptr;
-        ret = libusb_open(device, &handle);
-        if (ret < 0) {
-            log(ASTRA_LOG_LEVEL_WARNING) << "Device not accessible (" << libusb_error_name(ret)
-                << "), skipping and waiting for re-enumeration" << endLog;
-            return 0;
-        }
-
-        std::unique_ptr<USBDevice> usbDevice = std::make_unique<LibUSBDevice>(device, usbPath, transport->m_ctx, handle);
-        // Enqueue for the callback worker thread instead of calling directly.
-        // The hotplug callback runs on the libusb event thread; calling user code
-        // (which may invoke Write() and block on a condition variable) from here
-        // would deadlock because the event thread would be unable to process the
-        // transfer-completion event needed to unblock Write().
-        {
-            std::lock_guard<std::mutex> lk(transport->m_callbackMutex);
-            transport->m_pendingCallbacks.push(std::move(usbDevice));
-        }
-        transport->m_callbackCV.notify_one();
+        transport->QueueArrival(device, usbPath);
     }
 
     return 0;
+}
+
+void LibUSBTransport::QueueArrival(libusb_device *device, const std::string &usbPath)
+{
+    ASTRA_LOG;
+
+    // Validate device is accessible before passing to callback
+    // If the device is in a bad state (e.g., kernel failed to configure it),
+    // skip it and wait for re-enumeration
+    libusb_device_handle *handle = nullptr;
+    int ret = libusb_open(device, &handle);
+    if (ret < 0) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "Device not accessible (" << libusb_error_name(ret)
+            << "), skipping and waiting for re-enumeration" << endLog;
+        return;
+    }
+
+    std::unique_ptr<USBDevice> usbDevice = std::make_unique<LibUSBDevice>(device, usbPath, m_ctx, handle);
+    // Enqueue for the callback worker thread instead of calling directly.
+    // The hotplug callback runs on the libusb event thread; calling user code
+    // (which may invoke Write() and block on a condition variable) from here
+    // would deadlock because the event thread would be unable to process the
+    // transfer-completion event needed to unblock Write().
+    {
+        std::lock_guard<std::mutex> lk(m_callbackMutex);
+        m_pendingCallbacks.push(std::move(usbDevice));
+    }
+    m_callbackCV.notify_one();
 }
\ No newline at end of file
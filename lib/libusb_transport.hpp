@@ -25,16 +25,25 @@ public:
     virtual void UnblockDeviceEnumeration() {}
     virtual void RemoveActiveDevice(const std::string& usbPath) {}
 
+    // Needs hotplug support; the device IDs and ports can only grow.
+    int Reconfigure(const std::vector<USBVendorProductId> &vendorProductIds, const std::string &filterPorts) override;
+
     void StartDeviceMonitor();
 
 protected:
     libusb_context *m_ctx;
     std::vector<libusb_hotplug_callback_handle> m_callbackHandles;
     std::function<void(std::unique_ptr<USBDevice>)> m_deviceAddedCallback;
+    // Guards m_filterPorts and m_supportedDevices against Reconfigure().
+    std::mutex m_filterMutex;
 
     void DeviceMonitorThread();
     std::string ConstructUSBPath(libusb_device *device);
     bool IsValidPort(libusb_device *device, const std::string &portString);
+    bool RegisterHotplugCallback(uint16_t vendorId, uint16_t productId);
+
+    // Open device and hand it to the callback worker thread.
+    void QueueArrival(libusb_device *device, const std::string &usbPath);
 
     static int LIBUSB_CALL HotplugEventCallback(libusb_context *ctx, libusb_device *device,
                                                 libusb_hotplug_event event, void *user_data);
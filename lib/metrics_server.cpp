@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "metrics_server.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#if defined(PLATFORM_WINDOWS)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+#if defined(PLATFORM_WINDOWS)
+#define poll WSAPoll
+#endif
+
+#if defined(PLATFORM_LINUX)
+// A scraper hanging up early must not raise SIGPIPE.
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+MetricsServer::~MetricsServer()
+{
+    Stop();
+}
+
+bool MetricsServer::Start(const std::string &address)
+{
+    ASTRA_LOG;
+
+    Stop();
+    m_stop = false;
+
+    bool listening = false;
+    const size_t colon = address.rfind(':');
+    if (address.find('/') == std::string::npos && colon != std::string::npos) {
+        listening = ListenTcp(address.substr(0, colon), address.substr(colon + 1));
+    } else {
+        listening = ListenUnix(address);
+    }
+    if (!listening) {
+        return false;
+    }
+
+    log(ASTRA_LOG_LEVEL_INFO) << "Serving metrics on " << address << endLog;
+    m_thread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-metrics", &MetricsServer::ServeThread, this);
+    return true;
+}
+
+void MetricsServer::Stop()
+{
+    ASTRA_LOG;
+
+    m_stop = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_listenSocket != kInvalidSocket) {
+        CloseSocket(m_listenSocket);
+        m_listenSocket = kInvalidSocket;
+    }
+#if !defined(PLATFORM_WINDOWS)
+    if (!m_unixPath.empty()) {
+        unlink(m_unixPath.c_str());
+        m_unixPath.clear();
+    }
+#endif
+}
+
+bool MetricsServer::ListenTcp(const std::string &host, const std::string &port)
+{
+    ASTRA_LOG;
+
+#if defined(PLATFORM_WINDOWS)
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to initialize Winsock for the metrics endpoint" << endLog;
+        return false;
+    }
+#endif
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Invalid metrics address " << host << ":" << port << endLog;
+        return false;
+    }
+
+    for (addrinfo *info = result; info != nullptr; info = info->ai_next) {
+        SocketHandle listenSocket = static_cast<SocketHandle>(socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+        if (listenSocket == kInvalidSocket) {
+            continue;
+        }
+        const int reuse = 1;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+        if (bind(listenSocket, info->ai_addr, static_cast<int>(info->ai_addrlen)) == 0 && listen(listenSocket, 8) == 0) {
+            m_listenSocket = listenSocket;
+            break;
+        }
+        CloseSocket(listenSocket);
+    }
+    freeaddrinfo(result);
+
+    if (m_listenSocket == kInvalidSocket) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to listen for metrics on " << host << ":" << port << endLog;
+        return false;
+    }
+    return true;
+}
+
+bool MetricsServer::ListenUnix(const std::string &path)
+{
+    ASTRA_LOG;
+
+#if defined(PLATFORM_WINDOWS)
+    log(ASTRA_LOG_LEVEL_ERROR) << "Metrics address must be [host]:port on Windows: " << path << endLog;
+    return false;
+#else
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Invalid metrics socket path: " << path << endLog;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    // Replace a socket left behind by a run which did not exit cleanly.
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(path.c_str());
+    }
+
+    SocketHandle listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket == kInvalidSocket) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to create metrics socket: " << std::strerror(errno) << endLog;
+        return false;
+    }
+    if (bind(listenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listenSocket, 8) != 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to listen for metrics on " << path << ": " << std::strerror(errno) << endLog;
+        CloseSocket(listenSocket);
+        return false;
+    }
+
+    m_listenSocket = listenSocket;
+    m_unixPath = path;
+    return true;
+#endif
+}
+
+void MetricsServer::ServeThread()
+{
+    ASTRA_LOG;
+
+    while (!m_stop) {
+        pollfd pfd{};
+        pfd.fd = m_listenSocket;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, kPollIntervalMs) <= 0 || (pfd.revents & POLLIN) == 0) {
+            continue;
+        }
+
+        SocketHandle client = static_cast<SocketHandle>(accept(m_listenSocket, nullptr, nullptr));
+        if (client == kInvalidSocket) {
+            continue;
+        }
+#if defined(PLATFORM_MACOS)
+        const int noSigPipe = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+        ServeClient(client);
+        CloseSocket(client);
+    }
+}
+
+void MetricsServer::ServeClient(SocketHandle client)
+{
+    ASTRA_LOG;
+
+    // Only the request line matters; read up to the end of the headers.
+    std::string request;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kClientTimeoutMs);
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos &&
+        request.size() < kMaxRequestSize)
+    {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        pollfd pfd{};
+        pfd.fd = client;
+        pfd.events = POLLIN;
+        if (remaining <= 0 || m_stop || poll(&pfd, 1, static_cast<int>(remaining)) <= 0) {
+            return;
+        }
+        char buffer[1024];
+        const int received = static_cast<int>(recv(client, buffer, sizeof(buffer), 0));
+        if (received <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    const size_t methodEnd = request.find(' ');
+    const size_t pathEnd = methodEnd == std::string::npos ? std::string::npos : request.find(' ', methodEnd + 1);
+    const std::string method = request.substr(0, methodEnd);
+    std::string path = pathEnd == std::string::npos ? "" : request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    path = path.substr(0, path.find('?'));
+
+    std::string status = "200 OK";
+    std::string contentType = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if ((method == "GET" || method == "HEAD") && (path == "/metrics" || path == "/")) {
+        body = m_render();
+    } else {
+        status = "404 Not Found";
+        contentType = "text/plain; charset=utf-8";
+        body = "Not found\n";
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\nContent-Type: " + contentType + "\r\nContent-Length: " +
+        std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    if (method != "HEAD") {
+        response += body;
+    }
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        const int ret = static_cast<int>(send(client, response.data() + sent, static_cast<int>(response.size() - sent), kSendFlags));
+        if (ret <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(ret);
+    }
+}
+
+void MetricsServer::CloseSocket(SocketHandle socket)
+{
+#if defined(PLATFORM_WINDOWS)
+    closesocket(static_cast<SOCKET>(socket));
+#else
+    close(socket);
+#endif
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * Minimal HTTP/1.0 server for the metrics endpoint.  GET /metrics (or /)
+ * answers with the text render() returns; anything else gets a 404.  Clients
+ * are served one at a time on a single thread, which is plenty for a
+ * scraper polling every few seconds and keeps the cost near zero between
+ * scrapes.
+ */
+class MetricsServer
+{
+public:
+    using RenderFunction = std::function<std::string()>;
+
+    explicit MetricsServer(RenderFunction render) : m_render{std::move(render)}
+    {}
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    /**
+     * Listen on address and start serving.  address is "[host]:port" for
+     * TCP, all interfaces if host is empty, or the path of a Unix domain
+     * socket (not on Windows), which is replaced if stale.
+     */
+    bool Start(const std::string &address);
+
+    void Stop();
+
+private:
+#if defined(PLATFORM_WINDOWS)
+    // SOCKET and INVALID_SOCKET, without pulling Winsock into every includer.
+    using SocketHandle = uintptr_t;
+    static constexpr SocketHandle kInvalidSocket = ~static_cast<SocketHandle>(0);
+#else
+    using SocketHandle = int;
+    static constexpr SocketHandle kInvalidSocket = -1;
+#endif
+
+    static constexpr int kPollIntervalMs = 200;
+    static constexpr int kClientTimeoutMs = 2000;
+    static constexpr size_t kMaxRequestSize = 8192;
+
+    bool ListenTcp(const std::string &host, const std::string &port);
+    bool ListenUnix(const std::string &path);
+    void ServeThread();
+    void ServeClient(SocketHandle client);
+    static void CloseSocket(SocketHandle socket);
+
+    RenderFunction m_render;
+    SocketHandle m_listenSocket = kInvalidSocket;
+    std::string m_unixPath;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+};
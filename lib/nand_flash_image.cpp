@@ -90,5 +90,8 @@ int NandFlashImage::Load()
         m_flashCommand += m_resetCommand;
     }
 
+    // Digests for delta and verified updates come from the image index.
+    StartPreprocessing();
+
     return ret;
 }
\ No newline at end of file
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "posix_cdc_reactor.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(PLATFORM_LINUX)
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+PosixCDCReactor::PosixCDCReactor() : m_readBuffer(kReadBufferSize)
+{
+    ASTRA_LOG;
+
+#if defined(PLATFORM_LINUX)
+    m_pollFd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    m_pollFd = kqueue();
+#endif
+    if (m_pollFd < 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to create CDC reactor: " << strerror(errno) << endLog;
+        return;
+    }
+
+    if (pipe(m_wakePipe) != 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to create CDC reactor wake pipe: " << strerror(errno) << endLog;
+        close(m_pollFd);
+        m_pollFd = -1;
+        return;
+    }
+    fcntl(m_wakePipe[0], F_SETFL, fcntl(m_wakePipe[0], F_GETFL, 0) | O_NONBLOCK);
+
+#if defined(PLATFORM_LINUX)
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = m_wakePipe[0];
+    epoll_ctl(m_pollFd, EPOLL_CTL_ADD, m_wakePipe[0], &event);
+#else
+    struct kevent event;
+    EV_SET(&event, m_wakePipe[0], EVFILT_READ, EV_ADD, 0, 0, nullptr);
+    kevent(m_pollFd, &event, 1, nullptr, 0, nullptr);
+#endif
+
+    m_running.store(true);
+    m_thread = ThreadPolicy::Start(THREAD_ROLE_USB, "astra-cdc-io", &PosixCDCReactor::Run, this);
+}
+
+PosixCDCReactor::~PosixCDCReactor()
+{
+    ASTRA_LOG;
+
+    m_running.store(false);
+    Wake();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    for (int &fd : m_wakePipe) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (m_pollFd >= 0) {
+        close(m_pollFd);
+        m_pollFd = -1;
+    }
+}
+
+int PosixCDCReactor::Add(int fd, ReadHandler handler)
+{
+    ASTRA_LOG;
+
+    if (m_pollFd < 0 || !m_running.load()) {
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_handlersMutex);
+        m_handlers[fd] = std::move(handler);
+    }
+
+#if defined(PLATFORM_LINUX)
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    const int ret = epoll_ctl(m_pollFd, EPOLL_CTL_ADD, fd, &event);
+#else
+    struct kevent event;
+    EV_SET(&event, fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+    const int ret = kevent(m_pollFd, &event, 1, nullptr, 0, nullptr);
+#endif
+    if (ret < 0) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to watch CDC fd " << fd << ": " << strerror(errno) << endLog;
+        std::lock_guard<std::mutex> lock(m_handlersMutex);
+        m_handlers.erase(fd);
+        return -1;
+    }
+
+    return 0;
+}
+
+void PosixCDCReactor::Remove(int fd)
+{
+    ASTRA_LOG;
+
+    // A handler never removes its own fd this way, but avoid self-deadlock if it does.
+    std::unique_lock<std::mutex> dispatchLock(m_dispatchMutex, std::defer_lock);
+    if (std::this_thread::get_id() != m_thread.get_id()) {
+        dispatchLock.lock();
+    }
+
+    Unwatch(fd);
+}
+
+void PosixCDCReactor::Unwatch(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_handlersMutex);
+        if (m_handlers.erase(fd) == 0) {
+            return;
+        }
+    }
+
+#if defined(PLATFORM_LINUX)
+    epoll_ctl(m_pollFd, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    struct kevent event;
+    EV_SET(&event, fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    kevent(m_pollFd, &event, 1, nullptr, 0, nullptr);
+#endif
+}
+
+void PosixCDCReactor::Wake()
+{
+    if (m_wakePipe[1] >= 0) {
+        const char c = 0;
+        (void)write(m_wakePipe[1], &c, 1);
+    }
+}
+
+bool PosixCDCReactor::Dispatch(int fd, bool hangup)
+{
+    ReadHandler *handler = nullptr;
+    {
+        // Elements of an unordered_map keep their address across rehashing,
+        // and only Remove()/Unwatch() erase them, which m_dispatchMutex excludes.
+        std::lock_guard<std::mutex> lock(m_handlersMutex);
+        auto it = m_handlers.find(fd);
+        if (it == m_handlers.end()) {
+            return true;
+        }
+        handler = &it->second;
+    }
+
+    // Drain what is buffered now; level-triggered readiness brings us back for more.
+    for (size_t reads = 0; reads < 16; ++reads) {
+        const ssize_t bytesRead = read(fd, m_readBuffer.data(), m_readBuffer.size());
+        if (bytesRead > 0) {
+            if (!(*handler)(m_readBuffer.data(), static_cast<size_t>(bytesRead), 0)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (bytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (bytesRead == 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+            // No data: a hangup with nothing left to read means the port is gone.
+            if (hangup) {
+                return (*handler)(nullptr, 0, EIO);
+            }
+            return true;
+        }
+
+        return (*handler)(nullptr, 0, errno);
+    }
+
+    return true;
+}
+
+void PosixCDCReactor::Run()
+{
+    ASTRA_LOG;
+
+#if defined(PLATFORM_LINUX)
+    std::array<epoll_event, 16> events = {};
+#else
+    std::array<struct kevent, 16> events = {};
+#endif
+
+    while (m_running.load()) {
+#if defined(PLATFORM_LINUX)
+        const int count = epoll_wait(m_pollFd, events.data(), static_cast<int>(events.size()), -1);
+#else
+        const int count = kevent(m_pollFd, nullptr, 0, events.data(), static_cast<int>(events.size()), nullptr);
+#endif
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log(ASTRA_LOG_LEVEL_ERROR) << "CDC reactor wait failed: " << strerror(errno) << endLog;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+#if defined(PLATFORM_LINUX)
+            const int fd = events[i].data.fd;
+            const bool hangup = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+#else
+            const int fd = static_cast<int>(events[i].ident);
+            const bool hangup = (events[i].flags & (EV_EOF | EV_ERROR)) != 0;
+#endif
+            if (fd == m_wakePipe[0]) {
+                char drain[64];
+                while (read(m_wakePipe[0], drain, sizeof(drain)) > 0) {
+                }
+                continue;
+            }
+
+            std::lock_guard<std::mutex> dispatchLock(m_dispatchMutex);
+            if (!Dispatch(fd, hangup)) {
+                Unwatch(fd);
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * One reader thread for every open CDC serial port.  Ports are watched with
+ * epoll (Linux) or kqueue (macOS) and data is handed to each device's read
+ * handler as soon as it arrives, instead of one polling thread per device.
+ */
+class PosixCDCReactor {
+public:
+    /**
+     * Called on the reactor thread.  data/size carry the bytes read; on a
+     * read error or hangup data is null and error holds the errno value.
+     * Return false to stop watching the fd.
+     */
+    using ReadHandler = std::function<bool(const uint8_t *data, size_t size, int error)>;
+
+    PosixCDCReactor();
+    ~PosixCDCReactor();
+
+    PosixCDCReactor(const PosixCDCReactor &) = delete;
+    PosixCDCReactor &operator=(const PosixCDCReactor &) = delete;
+
+    /** Start watching a non-blocking fd.  @return 0 on success, -1 on failure. */
+    int Add(int fd, ReadHandler handler);
+
+    /**
+     * Stop watching fd.  Once this returns the handler is not running and will
+     * not be called again, so the caller may close the fd.
+     */
+    void Remove(int fd);
+
+private:
+    static constexpr size_t kReadBufferSize = 4096;
+
+    void Run();
+    void Wake();
+    bool Dispatch(int fd, bool hangup);
+    void Unwatch(int fd);
+
+    int m_pollFd = -1;
+    int m_wakePipe[2] = {-1, -1};
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+
+    std::mutex m_handlersMutex;
+    std::unordered_map<int, ReadHandler> m_handlers;
+
+    // Held by the reactor thread while a handler runs; Remove() takes it to
+    // wait out an in-flight dispatch.
+    std::mutex m_dispatchMutex;
+    std::vector<uint8_t> m_readBuffer;
+};
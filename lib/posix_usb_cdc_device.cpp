@@ -3,17 +3,20 @@
 
 #include "posix_usb_cdc_device.hpp"
 
-#include <array>
-#include <chrono>
+#include <algorithm>
+
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
 #include <termios.h>
 #include <unistd.h>
 
 #include "astra_log.hpp"
 
-PosixUSBCDCDevice::PosixUSBCDCDevice(const std::string &usbPath, uint16_t vendorId, uint16_t productId, uint8_t numInterfaces)
-    : USBCDCDevice(usbPath, vendorId, productId, numInterfaces), m_fd(-1)
+PosixUSBCDCDevice::PosixUSBCDCDevice(const std::string &usbPath, std::shared_ptr<PosixCDCReactor> reactor,
+    uint16_t vendorId, uint16_t productId, uint8_t numInterfaces)
+    : USBCDCDevice(usbPath, vendorId, productId, numInterfaces), m_reactor(std::move(reactor)), m_fd(-1)
 {
     ASTRA_LOG;
 }
@@ -65,8 +68,15 @@ int PosixUSBCDCDevice::Open(std::function<void(USBEvent event, uint8_t *buf, siz
     log(ASTRA_LOG_LEVEL_WARNING) << "B230400 unavailable, using B115200 for CDC serial port" << endLog;
 #endif
     tty.c_cflag |= static_cast<tcflag_t>(CLOCAL | CREAD);
+    // CDC ACM ignores the line settings, but software or hardware flow
+    // control left on by the tty defaults would stall bulk uploads.
+    tty.c_iflag &= ~static_cast<tcflag_t>(IXON | IXOFF | IXANY);
+#ifdef CRTSCTS
+    tty.c_cflag &= ~static_cast<tcflag_t>(CRTSCTS);
+#endif
+    // The fd stays non-blocking; the reactor only reads once data is ready.
     tty.c_cc[VMIN] = 0;
-    tty.c_cc[VTIME] = 1;
+    tty.c_cc[VTIME] = 0;
 
     if (tcsetattr(m_fd, TCSANOW, &tty) != 0) {
         log(ASTRA_LOG_LEVEL_ERROR) << "tcsetattr failed for " << m_usbPath << " errno: " << errno << endLog;
@@ -75,14 +85,25 @@ int PosixUSBCDCDevice::Open(std::function<void(USBEvent event, uint8_t *buf, siz
         return -1;
     }
 
-    int flags = fcntl(m_fd, F_GETFL, 0);
-    if (flags >= 0) {
-        fcntl(m_fd, F_SETFL, flags & ~O_NONBLOCK);
+    {
+        std::lock_guard<std::mutex> writeLock(m_writeMutex);
+        m_coalesced.clear();
+        m_coalesced.reserve(kCoalesceBytes);
+        m_writeError = false;
     }
 
     m_shutdown.store(false);
     m_running.store(true);
-    m_readerThread = std::thread(&PosixUSBCDCDevice::ReaderThread, this);
+
+    if (m_reactor == nullptr || m_reactor->Add(m_fd, std::bind(&PosixUSBCDCDevice::HandleRead, this,
+            std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)) < 0)
+    {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to register " << m_usbPath << " with the CDC reactor" << endLog;
+        m_running.store(false);
+        close(m_fd);
+        m_fd = -1;
+        return -1;
+    }
 
     return 0;
 }
@@ -99,16 +120,14 @@ void PosixUSBCDCDevice::Close()
             m_running.store(false);
 
             if (m_fd >= 0) {
+                // Remove() waits out any read in progress, so the fd can be closed safely.
+                m_reactor->Remove(m_fd);
                 close(m_fd);
                 m_fd = -1;
             }
         }
     }
 
-    if (m_readerThread.joinable()) {
-        m_readerThread.join();
-    }
-
     StopCallbackWorker();
 }
 
@@ -116,92 +135,168 @@ int PosixUSBCDCDevice::Write(uint8_t *data, size_t size, int *transferred)
 {
     ASTRA_LOG;
 
-    if (!m_running.load() || m_fd < 0) {
-        if (transferred) {
-            *transferred = 0;
-        }
-        return -1;
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    const size_t pending = m_coalesced.size();
+    const WriteSegment segment = {data, size};
+    size_t written = 0;
+    const int ret = (!m_running.load() || m_fd < 0) ? -1 : WritePending(&segment, 1, &written);
+
+    if (transferred) {
+        *transferred = static_cast<int>(written > pending ? written - pending : 0);
     }
 
-    ssize_t bytesWritten = write(m_fd, data, size);
-    if (bytesWritten < 0) {
-        log(ASTRA_LOG_LEVEL_ERROR) << "Serial write failed on " << m_usbPath << " errno: " << errno << endLog;
+    return ret;
+}
 
-        if (errno == ENODEV || errno == EIO || errno == EBADF) {
-            CallbackEvent event;
-            event.event = USB_DEVICE_EVENT_NO_DEVICE;
-            {
-                std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
-                m_callbackQueue.push(std::move(event));
-            }
-            m_callbackQueueCV.notify_one();
-            m_running.store(false);
-        }
+int PosixUSBCDCDevice::WriteQueued(const uint8_t *data, size_t size)
+{
+    const WriteSegment segment = {data, size};
+    return WriteQueuedGather(&segment, 1);
+}
 
-        if (transferred) {
-            *transferred = 0;
-        }
+int PosixUSBCDCDevice::WriteQueuedGather(const WriteSegment *segments, size_t count)
+{
+    ASTRA_LOG;
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size += segments[i].size;
+    }
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    if (!m_running.load() || m_fd < 0 || m_writeError) {
         return -1;
     }
 
-    if (transferred) {
-        *transferred = static_cast<int>(bytesWritten);
+    if (m_coalesced.size() + size <= kCoalesceBytes) {
+        for (size_t i = 0; i < count; ++i) {
+            m_coalesced.insert(m_coalesced.end(), segments[i].data, segments[i].data + segments[i].size);
+        }
+        return 0;
     }
 
-    return 0;
+    size_t written = 0;
+    return WritePending(segments, count, &written);
 }
 
-void PosixUSBCDCDevice::ReaderThread()
+int PosixUSBCDCDevice::FlushQueuedWrites()
 {
     ASTRA_LOG;
 
-    std::array<uint8_t, 4096> buffer = {};
-    while (m_running.load()) {
-        ssize_t bytesRead = read(m_fd, buffer.data(), buffer.size());
-        if (bytesRead > 0) {
-            CallbackEvent event;
-            event.event = USB_DEVICE_EVENT_INTERRUPT;
-            event.data.assign(buffer.begin(), buffer.begin() + bytesRead);
-            {
-                std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
-                m_callbackQueue.push(std::move(event));
-            }
-            m_callbackQueueCV.notify_one();
-            continue;
-        }
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    if (m_writeError) {
+        // Report a failed queued write once, like the other devices.
+        m_writeError = false;
+        return -1;
+    }
+    if (m_coalesced.empty()) {
+        return 0;
+    }
+    if (!m_running.load() || m_fd < 0) {
+        m_coalesced.clear();
+        return -1;
+    }
 
-        if (bytesRead == 0) {
-            continue;
+    size_t written = 0;
+    return WritePending(nullptr, 0, &written);
+}
+
+int PosixUSBCDCDevice::WritePending(const WriteSegment *segments, size_t count, size_t *written)
+{
+    m_iov.clear();
+    if (!m_coalesced.empty()) {
+        m_iov.push_back({m_coalesced.data(), m_coalesced.size()});
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (segments[i].size > 0) {
+            m_iov.push_back({const_cast<uint8_t *>(segments[i].data), segments[i].size});
         }
+    }
 
-        if (errno == EINTR) {
+    const auto submitTime = std::chrono::steady_clock::now();
+    if (m_transferStats) {
+        m_transferStats->MarkWrite();
+    }
+    const int ret = WriteVector(m_iov.data(), m_iov.size(), written);
+    if (ret == 0 && m_transferStats) {
+        m_transferStats->RecordWriteLatency(std::chrono::steady_clock::now() - submitTime);
+    }
+
+    m_coalesced.clear();
+    if (ret < 0) {
+        m_writeError = true;
+    }
+    return ret;
+}
+
+int PosixUSBCDCDevice::WriteVector(iovec *iov, size_t count, size_t *written)
+{
+    ASTRA_LOG;
+
+    *written = 0;
+    while (count > 0) {
+        // The fd is non-blocking for the reactor, so wait for room instead
+        // of failing when the tty output buffer is full.
+        const ssize_t ret = writev(m_fd, iov, static_cast<int>(std::min<size_t>(count, IOV_MAX)));
+        if (ret > 0) {
+            *written += static_cast<size_t>(ret);
+            size_t advance = static_cast<size_t>(ret);
+            while (count > 0 && advance >= iov->iov_len) {
+                advance -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (advance > 0) {
+                iov->iov_base = static_cast<uint8_t *>(iov->iov_base) + advance;
+                iov->iov_len -= advance;
+            }
             continue;
         }
-
-        if ((errno == EAGAIN || errno == EWOULDBLOCK) && m_running.load()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (ret < 0 && errno == EINTR) {
             continue;
         }
-
-        if (!m_running.load()) {
-            break;
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd = {m_fd, POLLOUT, 0};
+            const int pollRet = poll(&pfd, 1, kWriteTimeoutMs);
+            if (pollRet > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) == 0) {
+                continue;
+            }
+            if (pollRet == 0) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Serial write timed out on " << m_usbPath << endLog;
+                return -1;
+            }
+            if (pollRet > 0) {
+                errno = EIO;
+            }
         }
 
-        CallbackEvent event;
+        log(ASTRA_LOG_LEVEL_ERROR) << "Serial write failed on " << m_usbPath << " errno: " << errno << endLog;
+
         if (errno == ENODEV || errno == EIO || errno == EBADF) {
-            event.event = USB_DEVICE_EVENT_NO_DEVICE;
-        } else {
-            event.event = USB_DEVICE_EVENT_TRANSFER_ERROR;
+            QueueCallbackEvent(USB_DEVICE_EVENT_NO_DEVICE);
+            m_running.store(false);
         }
+        return -1;
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
-            m_callbackQueue.push(std::move(event));
-        }
-        m_callbackQueueCV.notify_one();
-        m_running.store(false);
-        break;
+    return 0;
+}
+
+bool PosixUSBCDCDevice::HandleRead(const uint8_t *data, size_t size, int error)
+{
+    if (!m_running.load()) {
+        return false;
     }
+
+    if (data != nullptr) {
+        QueueCallbackEvent(USB_DEVICE_EVENT_INTERRUPT, data, size);
+        return true;
+    }
+
+    QueueCallbackEvent((error == ENODEV || error == EIO || error == EBADF) ?
+        USB_DEVICE_EVENT_NO_DEVICE : USB_DEVICE_EVENT_TRANSFER_ERROR);
+    m_running.store(false);
+    return false;
 }
 
 uint16_t PosixUSBCDCDevice::GetVendorId() const
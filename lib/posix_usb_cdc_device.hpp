@@ -4,24 +4,55 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include <sys/uio.h>
+
+#include "posix_cdc_reactor.hpp"
 #include "usb_cdc_device.hpp"
 
 class PosixUSBCDCDevice : public USBCDCDevice {
 public:
-    PosixUSBCDCDevice(const std::string &usbPath, uint16_t vendorId = 0, uint16_t productId = 0, uint8_t numInterfaces = 0);
+    // Reads are delivered by the transport's shared reactor rather than a
+    // per-device reader thread.
+    PosixUSBCDCDevice(const std::string &usbPath, std::shared_ptr<PosixCDCReactor> reactor,
+        uint16_t vendorId = 0, uint16_t productId = 0, uint8_t numInterfaces = 0);
     ~PosixUSBCDCDevice() override;
 
     int Open(std::function<void(USBEvent event, uint8_t *buf, size_t size)> usbEventCallback) override;
     void Close() override;
     int Write(uint8_t *data, size_t size, int *transferred) override;
+
+    // Small queued writes are coalesced and sent together with the next
+    // large one, or by FlushQueuedWrites(); gathered writes go out with a
+    // single writev() instead of being staged in one buffer.
+    int WriteQueued(const uint8_t *data, size_t size) override;
+    int WriteQueuedGather(const WriteSegment *segments, size_t count) override;
+    int FlushQueuedWrites() override;
     uint16_t GetVendorId() const override;
     uint16_t GetProductId() const override;
     uint8_t GetNumInterfaces() const override;
 
 private:
-    void ReaderThread();
+    static constexpr int kWriteTimeoutMs = 5000;
+    // Queued writes smaller than this wait for more data before a syscall.
+    static constexpr size_t kCoalesceBytes = 64 * 1024;
+
+    bool HandleRead(const uint8_t *data, size_t size, int error);
 
+    // Write the coalesced bytes followed by count segments, waiting for
+    // room as needed.  Called with m_writeMutex held.
+    int WritePending(const WriteSegment *segments, size_t count, size_t *written);
+    int WriteVector(iovec *iov, size_t count, size_t *written);
+
+    std::shared_ptr<PosixCDCReactor> m_reactor;
     int m_fd;
+
+    std::mutex m_writeMutex;
+    std::vector<uint8_t> m_coalesced;
+    std::vector<iovec> m_iov;
+    bool m_writeError = false;
 };
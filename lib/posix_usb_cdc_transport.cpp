@@ -8,8 +8,11 @@
 #include "posix_usb_cdc_transport.hpp"
 #include "posix_usb_cdc_transport_impl.hpp"
 
+#include <algorithm>
 #include <filesystem>
 
+#include <sys/stat.h>
+
 #include "astra_log.hpp"
 #include "posix_usb_cdc_device.hpp"
 
@@ -22,29 +25,37 @@ void PosixUSBCDCTransport::ProcessPendingDevices()
     ASTRA_LOG;
 
     const auto candidatePorts = EnumerateCandidatePorts();
+    PruneIdentities(candidatePorts);
+
     for (const auto &candidatePort : candidatePorts) {
         const std::string normalizedPort = NormalizePortPath(candidatePort);
         if (!IsValidPort(normalizedPort)) {
             continue;
         }
 
-        if (!MatchesVendorProduct(normalizedPort)) {
+        {
+            std::lock_guard<std::mutex> lock(m_activeDevicesMutex);
+            if (m_activeDevices.find(normalizedPort) != m_activeDevices.end()) {
+                continue;
+            }
+        }
+
+        const auto identity = LookupIdentity(normalizedPort);
+        if (!MatchesVendorProduct(identity)) {
             continue;
         }
 
         {
             std::lock_guard<std::mutex> lock(m_activeDevicesMutex);
-            if (m_activeDevices.find(normalizedPort) != m_activeDevices.end()) {
+            if (!m_activeDevices.insert(normalizedPort).second) {
                 continue;
             }
-            m_activeDevices.insert(normalizedPort);
         }
 
         // Extract vendor/product IDs and interface count from device identity
         uint16_t vendorId = 0;
         uint16_t productId = 0;
         uint8_t numInterfaces = 0;
-        const auto identity = ReadPosixIdentity(normalizedPort);
         if (identity.has_value()) {
             if (identity->vendorId.has_value()) {
                 vendorId = identity->vendorId.value();
@@ -58,7 +69,7 @@ void PosixUSBCDCTransport::ProcessPendingDevices()
             }
         }
 
-        std::unique_ptr<USBDevice> usbDevice = std::make_unique<PosixUSBCDCDevice>(normalizedPort,
+        std::unique_ptr<USBDevice> usbDevice = std::make_unique<PosixUSBCDCDevice>(normalizedPort, m_reactor,
             vendorId, productId, numInterfaces);
         if (m_deviceAddedCallback) {
             try {
@@ -104,7 +115,7 @@ std::vector<std::string> PosixUSBCDCTransport::EnumerateCandidatePorts() const
     return ports;
 }
 
-bool PosixUSBCDCTransport::MatchesVendorProduct(const std::string& portPath) const
+bool PosixUSBCDCTransport::MatchesVendorProduct(const std::optional<DeviceIdentityInfo> &identity) const
 {
     ASTRA_LOG;
 
@@ -112,7 +123,6 @@ bool PosixUSBCDCTransport::MatchesVendorProduct(const std::string& portPath) con
         return true;
     }
 
-    const auto identity = ReadPosixIdentity(portPath);
     if (!identity.has_value() || !identity->vendorId.has_value() || !identity->productId.has_value()) {
         // If platform metadata is unavailable, do not block detection.
         return true;
@@ -126,3 +136,75 @@ bool PosixUSBCDCTransport::MatchesVendorProduct(const std::string& portPath) con
     return false;
 }
 
+bool PosixUSBCDCTransport::StatPort(const std::string &portPath, uint64_t &device, uint64_t &inode)
+{
+    struct stat info;
+    if (stat(portPath.c_str(), &info) != 0) {
+        return false;
+    }
+    device = static_cast<uint64_t>(info.st_rdev);
+    inode = static_cast<uint64_t>(info.st_ino);
+    return true;
+}
+
+std::optional<DeviceIdentityInfo> PosixUSBCDCTransport::LookupCachedIdentity(const std::string &portPath)
+{
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    if (!StatPort(portPath, device, inode)) {
+        ForgetIdentity(portPath);
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(m_identityMutex);
+    const auto it = m_identities.find(portPath);
+    if (it == m_identities.end() || it->second.m_device != device || it->second.m_inode != inode) {
+        return std::nullopt;
+    }
+    return it->second.m_identity;
+}
+
+std::optional<DeviceIdentityInfo> PosixUSBCDCTransport::LookupIdentity(const std::string &portPath)
+{
+    ASTRA_LOG;
+
+    if (auto identity = LookupCachedIdentity(portPath); identity.has_value()) {
+        return identity;
+    }
+
+    const auto identity = ReadPosixIdentity(portPath);
+    if (identity.has_value()) {
+        CacheIdentity(portPath, identity.value());
+    }
+    return identity;
+}
+
+void PosixUSBCDCTransport::CacheIdentity(const std::string &portPath, const DeviceIdentityInfo &identity)
+{
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    if (!StatPort(portPath, device, inode)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_identityMutex);
+    m_identities[portPath] = CachedIdentity{device, inode, identity};
+}
+
+void PosixUSBCDCTransport::ForgetIdentity(const std::string &portPath)
+{
+    std::lock_guard<std::mutex> lock(m_identityMutex);
+    m_identities.erase(portPath);
+}
+
+void PosixUSBCDCTransport::PruneIdentities(const std::vector<std::string> &presentPorts)
+{
+    std::lock_guard<std::mutex> lock(m_identityMutex);
+    for (auto it = m_identities.begin(); it != m_identities.end();) {
+        if (std::find(presentPorts.begin(), presentPorts.end(), it->first) == presentPorts.end()) {
+            it = m_identities.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -4,7 +4,12 @@
 #pragma once
 
 #include "usb_cdc_transport.hpp"
+#include "posix_cdc_reactor.hpp"
+#include "posix_usb_cdc_transport_impl.hpp"
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 
 #if defined(PLATFORM_LINUX)
 struct udev_device;
@@ -21,7 +26,19 @@ private:
     void ProcessPendingDevices() override;
     void StartDeviceMonitor() override;
     std::vector<std::string> EnumerateCandidatePorts() const;
-    bool MatchesVendorProduct(const std::string& portPath) const;
+    bool MatchesVendorProduct(const std::optional<DeviceIdentityInfo> &identity) const;
+
+    // Port identities keyed by devnode.  Hotplug events keep the cache
+    // current, so a port already seen costs a stat() instead of a sysfs or
+    // IOKit registry walk.  An entry is only trusted while the devnode is
+    // the same node it was read from, which catches a device replaced
+    // between two polls.
+    std::optional<DeviceIdentityInfo> LookupIdentity(const std::string &portPath);
+    // Like LookupIdentity() but never reads the platform metadata.
+    std::optional<DeviceIdentityInfo> LookupCachedIdentity(const std::string &portPath);
+    void CacheIdentity(const std::string &portPath, const DeviceIdentityInfo &identity);
+    void ForgetIdentity(const std::string &portPath);
+    void PruneIdentities(const std::vector<std::string> &presentPorts);
 
 #if defined(PLATFORM_LINUX)
     void UdevMonitorThread();
@@ -33,6 +50,20 @@ private:
     static void IOKitDeviceRemoved(void *ctx, io_iterator_t iter);
 #endif
 
+    struct CachedIdentity {
+        uint64_t m_device;
+        uint64_t m_inode;
+        DeviceIdentityInfo m_identity;
+    };
+
+    static bool StatPort(const std::string &portPath, uint64_t &device, uint64_t &inode);
+
+    std::mutex m_identityMutex;
+    std::map<std::string, CachedIdentity> m_identities;
+
+    // Serves reads for every device this transport opens.
+    std::shared_ptr<PosixCDCReactor> m_reactor = std::make_shared<PosixCDCReactor>();
+
     // Platform-specific state is held in Impl (defined in the platform .cpp).
     // Only one platform file is compiled per build, so there is no ODR issue.
     struct Impl;
@@ -18,6 +18,7 @@
 
 #include "astra_log.hpp"
 #include "posix_usb_cdc_device.hpp"
+#include "thread_policy.hpp"
 
 // ---------------------------------------------------------------------------
 // Platform-specific Impl struct
@@ -167,7 +168,7 @@ void PosixUSBCDCTransport::StartDeviceMonitor()
         return;
     }
 
-    m_impl->m_udevThread = std::thread(&PosixUSBCDCTransport::UdevMonitorThread, this);
+    m_impl->m_udevThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-udev", &PosixUSBCDCTransport::UdevMonitorThread, this);
 }
 
 // ---------------------------------------------------------------------------
@@ -195,11 +196,19 @@ void PosixUSBCDCTransport::ProcessUdevDevice(udev_device *dev)
 
     // Read VID/PID/numInterfaces directly from the USB device parent — these
     // are guaranteed to be present by the time udev dispatches the event.
+    // A repeated event for a node already seen is answered from the cache.
     uint16_t vendorId = 0;
     uint16_t productId = 0;
     uint8_t numInterfaces = 0;
 
-    udev_device *usbdev = udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+    udev_device *usbdev = nullptr;
+    if (const auto cached = LookupCachedIdentity(portPath); cached.has_value()) {
+        vendorId = cached->vendorId.value_or(0);
+        productId = cached->productId.value_or(0);
+        numInterfaces = static_cast<uint8_t>(cached->numInterfaces.value_or(0));
+    } else {
+        usbdev = udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+    }
     if (usbdev) {
         auto parseHex = [](const char *s) -> std::optional<uint16_t> {
             if (!s) return std::nullopt;
@@ -240,6 +249,12 @@ void PosixUSBCDCTransport::ProcessUdevDevice(udev_device *dev)
         // 0xEF/0x02 (Misc/Multi-Function, used with IAD per USB ECN).
         const bool isComposite = (devClass == 0x00) || (devClass == 0xEF && devSubClass == 0x02);
         numInterfaces = isComposite ? uint8_t{2} : uint8_t{1};
+
+        DeviceIdentityInfo identity;
+        identity.vendorId = vendorId;
+        identity.productId = productId;
+        identity.numInterfaces = numInterfaces;
+        CacheIdentity(portPath, identity);
     }
 
     // If VID/PID are known, filter against the supported device list.
@@ -258,7 +273,7 @@ void PosixUSBCDCTransport::ProcessUdevDevice(udev_device *dev)
         m_activeDevices.insert(portPath);
     }
 
-    auto usbDevice = std::make_unique<PosixUSBCDCDevice>(portPath, vendorId, productId, numInterfaces);
+    auto usbDevice = std::make_unique<PosixUSBCDCDevice>(portPath, m_reactor, vendorId, productId, numInterfaces);
     if (m_deviceAddedCallback) {
         try {
             m_deviceAddedCallback(std::move(usbDevice));
@@ -339,7 +354,10 @@ void PosixUSBCDCTransport::UdevMonitorThread()
                         ProcessUdevDevice(dev);
                     } else if (strcmp(action, "remove") == 0) {
                         const char *devnode = udev_device_get_devnode(dev);
-                        if (devnode) RemoveActiveDevice(std::string(devnode));
+                        if (devnode) {
+                            ForgetIdentity(NormalizePortPath(std::string(devnode)));
+                            RemoveActiveDevice(std::string(devnode));
+                        }
                     }
                 }
                 udev_device_unref(dev);
@@ -20,6 +20,7 @@
 
 #include "astra_log.hpp"
 #include "posix_usb_cdc_device.hpp"
+#include "thread_policy.hpp"
 
 // ---------------------------------------------------------------------------
 // Platform-specific Impl struct
@@ -245,7 +246,7 @@ std::optional<DeviceIdentityInfo> ReadPosixIdentity(const std::string &portPath)
 void PosixUSBCDCTransport::StartDeviceMonitor()
 {
     ASTRA_LOG;
-    m_impl->m_ioKitThread = std::thread(&PosixUSBCDCTransport::IOKitMonitorThread, this);
+    m_impl->m_ioKitThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-iokit", &PosixUSBCDCTransport::IOKitMonitorThread, this);
 }
 
 // ---------------------------------------------------------------------------
@@ -275,6 +276,7 @@ void PosixUSBCDCTransport::IOKitDeviceRemoved(void *ctx, io_iterator_t iter)
             if (CFGetTypeID(calloutRef) == CFStringGetTypeID()) {
                 const std::string path = CFStringToStdString(static_cast<CFStringRef>(calloutRef));
                 if (!path.empty()) {
+                    self->ForgetIdentity(path);
                     self->RemoveActiveDevice(path);
                 }
             }
@@ -339,6 +341,12 @@ void PosixUSBCDCTransport::ProcessIOKitService(io_object_t service)
     const bool isComposite = (devClass == 0x00) || (devClass == 0xEF && devSubClass == 0x02);
     const uint8_t numInterfaces = isComposite ? uint8_t{2} : uint8_t{1};
 
+    DeviceIdentityInfo identity;
+    identity.vendorId = vendorId;
+    identity.productId = productId;
+    identity.numInterfaces = numInterfaces;
+    CacheIdentity(portPath, identity);
+
     log(ASTRA_LOG_LEVEL_DEBUG) << "ProcessIOKitService: " << portPath
         << " bDeviceClass=0x"    << std::hex << devClass
         << " bDeviceSubClass=0x" << devSubClass
@@ -367,7 +375,7 @@ void PosixUSBCDCTransport::ProcessIOKitService(io_object_t service)
         m_activeDevices.insert(portPath);
     }
 
-    auto device = std::make_unique<PosixUSBCDCDevice>(portPath, vendorId, productId, numInterfaces);
+    auto device = std::make_unique<PosixUSBCDCDevice>(portPath, m_reactor, vendorId, productId, numInterfaces);
     if (m_deviceAddedCallback) {
         try {
             m_deviceAddedCallback(std::move(device));
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "response_dispatcher.hpp"
+#include "astra_trace.hpp"
+#include "thread_policy.hpp"
+
+struct ResponseDispatcher::State
+{
+    struct Delivery
+    {
+        Callback m_callback;
+        AstraDeviceManagerResponse m_response;
+    };
+
+    std::atomic<std::chrono::milliseconds::rep> m_progressIntervalMs{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idleCV;
+    std::deque<Delivery> m_milestones;
+    // Latest undelivered progress, by device name.
+    std::map<std::string, Delivery> m_progress;
+    std::chrono::steady_clock::time_point m_nextProgress;
+    std::thread::id m_threadId;
+    unsigned m_flushWaiters = 0;
+    bool m_delivering = false;
+    bool m_stop = false;
+    bool m_exited = false;
+
+    // Called with m_mutex held.
+    bool ProgressDue() const
+    {
+        return !m_progress.empty() && (m_stop || m_flushWaiters > 0 ||
+            std::chrono::steady_clock::now() >= m_nextProgress);
+    }
+
+    // Called with m_mutex held.
+    bool Idle() const
+    {
+        return m_milestones.empty() && m_progress.empty() && !m_delivering;
+    }
+};
+
+ResponseDispatcher::ResponseDispatcher(std::chrono::milliseconds progressInterval)
+    : m_state{std::make_shared<State>()}
+{
+    SetProgressInterval(progressInterval);
+    m_thread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-dispatch", &ResponseDispatcher::DispatchThread, m_state);
+}
+
+ResponseDispatcher::~ResponseDispatcher()
+{
+    Stop();
+}
+
+void ResponseDispatcher::SetProgressInterval(std::chrono::milliseconds progressInterval)
+{
+    m_state->m_progressIntervalMs = progressInterval.count();
+}
+
+void ResponseDispatcher::Post(Callback callback, AstraDeviceManagerResponse response)
+{
+    if (!callback) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    if (m_state->m_exited) {
+        lock.unlock();
+        callback(response);
+        return;
+    }
+
+    if (response.IsDeviceResponse() && response.GetDeviceResponse().m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS) {
+        const std::string deviceName = response.GetDeviceResponse().m_deviceName;
+        const bool wasEmpty = m_state->m_progress.empty();
+        m_state->m_progress.insert_or_assign(deviceName, State::Delivery{std::move(callback), std::move(response)});
+        if (wasEmpty) {
+            m_state->m_cv.notify_one();
+        }
+        return;
+    }
+
+    // Progress posted before this milestone must not arrive after it.
+    if (response.IsDeviceResponse()) {
+        auto it = m_state->m_progress.find(response.GetDeviceResponse().m_deviceName);
+        if (it != m_state->m_progress.end()) {
+            m_state->m_milestones.push_back(std::move(it->second));
+            m_state->m_progress.erase(it);
+        }
+    }
+    m_state->m_milestones.push_back(State::Delivery{std::move(callback), std::move(response)});
+    m_state->m_cv.notify_one();
+}
+
+void ResponseDispatcher::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_state->m_mutex);
+    if (std::this_thread::get_id() == m_state->m_threadId) {
+        return;
+    }
+
+    ++m_state->m_flushWaiters;
+    m_state->m_cv.notify_one();
+    m_state->m_idleCV.wait(lock, [this]() { return m_state->Idle() || m_state->m_exited; });
+    --m_state->m_flushWaiters;
+}
+
+void ResponseDispatcher::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->m_mutex);
+        m_state->m_stop = true;
+    }
+    m_state->m_cv.notify_one();
+
+    if (!m_thread.joinable()) {
+        return;
+    }
+    if (std::this_thread::get_id() == m_thread.get_id()) {
+        m_thread.detach();
+    } else {
+        m_thread.join();
+    }
+}
+
+void ResponseDispatcher::DispatchThread(std::shared_ptr<State> state)
+{
+    AstraTraceStore::getInstance().SetThreadName("response dispatcher");
+
+    std::unique_lock<std::mutex> lock(state->m_mutex);
+    state->m_threadId = std::this_thread::get_id();
+
+    std::vector<State::Delivery> batch;
+    while (true) {
+        if (state->m_milestones.empty() && !state->ProgressDue()) {
+            if (state->m_stop) {
+                break;
+            }
+            if (state->m_progress.empty()) {
+                state->m_cv.wait(lock);
+            } else {
+                state->m_cv.wait_until(lock, state->m_nextProgress);
+            }
+            continue;
+        }
+
+        // Milestones first: any progress still pending was posted after them.
+        for (auto &delivery : state->m_milestones) {
+            batch.push_back(std::move(delivery));
+        }
+        state->m_milestones.clear();
+        if (state->ProgressDue()) {
+            for (auto &[deviceName, delivery] : state->m_progress) {
+                batch.push_back(std::move(delivery));
+            }
+            state->m_progress.clear();
+            state->m_nextProgress = std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(state->m_progressIntervalMs.load());
+        }
+
+        state->m_delivering = true;
+        lock.unlock();
+        for (auto &delivery : batch) {
+            delivery.m_callback(delivery.m_response);
+        }
+        batch.clear();
+        lock.lock();
+        state->m_delivering = false;
+
+        if (state->Idle()) {
+            state->m_idleCV.notify_all();
+        }
+    }
+
+    state->m_exited = true;
+    state->m_idleCV.notify_all();
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "astra_device_manager.hpp"
+
+/**
+ * Delivers manager and device responses to the application's callbacks on
+ * its own thread, so a slow callback never stalls a device's USB transfers.
+ * Responses reach each callback in the order they were posted.  Image send
+ * progress is coalesced: only the latest progress of each device is kept and
+ * it is published at most once per progress interval.  Every other response
+ * is a milestone and is always delivered.
+ */
+class ResponseDispatcher
+{
+public:
+    using Callback = std::function<void(AstraDeviceManagerResponse)>;
+
+    static constexpr std::chrono::milliseconds kDefaultProgressInterval{100};
+
+    /** @param progressInterval  Minimum time between progress updates; 0 delivers them all. */
+    explicit ResponseDispatcher(std::chrono::milliseconds progressInterval);
+    ~ResponseDispatcher();
+
+    ResponseDispatcher(const ResponseDispatcher &) = delete;
+    ResponseDispatcher &operator=(const ResponseDispatcher &) = delete;
+
+    void SetProgressInterval(std::chrono::milliseconds progressInterval);
+
+    /** Queue response for callback.  Never waits for a callback to run. */
+    void Post(Callback callback, AstraDeviceManagerResponse response);
+
+    /**
+     * Wait until everything posted so far, including pending progress, has
+     * been delivered.  Returns at once when called from a callback.
+     */
+    void Flush();
+
+    /**
+     * Deliver what is left and stop the dispatch thread.  Responses posted
+     * afterwards are delivered on the posting thread.  When called from a
+     * callback, e.g. by destroying the manager on SHUTDOWN, the thread is
+     * detached and finishes delivering on its own.
+     */
+    void Stop();
+
+private:
+    struct State;
+
+    static void DispatchThread(std::shared_ptr<State> state);
+
+    // Shared with the dispatch thread, which may outlive a detaching Stop().
+    std::shared_ptr<State> m_state;
+    std::thread m_thread;
+};
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "response_times.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+std::chrono::milliseconds ResponseTimes::Learned(const Estimate &estimate, unsigned multiplier,
+    std::chrono::milliseconds floor, std::chrono::milliseconds ceiling)
+{
+    if (estimate.m_samples < kMinSamples) {
+        return ceiling;
+    }
+
+    const double marginMs = (estimate.m_smoothedMs + 4 * estimate.m_variationMs) * multiplier;
+    const auto learned = std::chrono::milliseconds(static_cast<int64_t>(std::ceil(marginMs)));
+    return std::min(std::max(learned, floor), ceiling);
+}
+
+std::chrono::milliseconds ResponseTimes::ExpectedTime(const std::string &key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_estimates.find(key);
+    if (it == m_estimates.end() || it->second.m_samples < kMinSamples) {
+        return std::chrono::milliseconds::zero();
+    }
+    return Learned(it->second, 1, std::chrono::milliseconds::zero(), std::chrono::milliseconds::max());
+}
+
+std::chrono::milliseconds ResponseTimes::ProbeTimeout(const std::string &key,
+    std::chrono::milliseconds ceiling) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_estimates.find(key);
+    if (it == m_estimates.end()) {
+        return ceiling;
+    }
+
+    if (it->second.m_misses >= kMinSamples) {
+        return std::min(kSilentTimeout, ceiling);
+    }
+    return Learned(it->second, 1, kMinProbeTimeout, ceiling);
+}
+
+void ResponseTimes::Observe(const std::string &key, Duration elapsed)
+{
+    const double elapsedMs = std::chrono::duration<double, std::milli>(elapsed).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Estimate &estimate = m_estimates[key];
+    estimate.m_misses = 0;
+    if (estimate.m_samples == 0) {
+        estimate.m_smoothedMs = elapsedMs;
+        estimate.m_variationMs = elapsedMs / 2;
+    } else {
+        // RFC 6298 gains: 1/4 for the variation, 1/8 for the smoothed time.
+        estimate.m_variationMs += (std::abs(estimate.m_smoothedMs - elapsedMs) - estimate.m_variationMs) / 4;
+        estimate.m_smoothedMs += (elapsedMs - estimate.m_smoothedMs) / 8;
+    }
+    ++estimate.m_samples;
+}
+
+void ResponseTimes::ObserveMiss(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Estimate &estimate = m_estimates[key];
+    // Start over from the worst case rather than trust an estimate which was
+    // just too tight.
+    estimate.m_samples = 0;
+    estimate.m_smoothedMs = 0;
+    estimate.m_variationMs = 0;
+    ++estimate.m_misses;
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * Learns how long each boot stage takes to answer each request, owned by
+ * the device manager.  Boards on a station are alike, so once a few devices
+ * have answered a probe its timeout shrinks from the protocol's fixed worst
+ * case to a margin over what was seen, the way TCP derives its
+ * retransmission timeout from a smoothed round trip time and its variance.
+ * A timeout returns the request to its worst case.  Responses the flow
+ * cannot do without always get their worst case: a shorter wait only turns
+ * a late answer, e.g. behind a busy hub, into a failed boot.
+ */
+class ResponseTimes {
+public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    /**
+     * The learned margin over the answers to key, for reporting answers
+     * which came later than usual; zero until key has kMinSamples answers.
+     */
+    std::chrono::milliseconds ExpectedTime(const std::string &key) const;
+
+    /**
+     * Timeout for a response the flow can do without, such as a version
+     * query.  Once the last kMinSamples requests went unanswered, the stage
+     * is taken not to answer and only kSilentTimeout is spent on it.
+     */
+    std::chrono::milliseconds ProbeTimeout(const std::string &key, std::chrono::milliseconds ceiling) const;
+
+    /** Record an answer which arrived elapsed after the request was written. */
+    void Observe(const std::string &key, Duration elapsed);
+
+    /** Record a request which went unanswered within its timeout. */
+    void ObserveMiss(const std::string &key);
+
+    static constexpr unsigned kMinSamples = 3;
+    static constexpr std::chrono::milliseconds kMinProbeTimeout{100};
+    static constexpr std::chrono::milliseconds kSilentTimeout{10};
+
+private:
+    struct Estimate {
+        double m_smoothedMs = 0;
+        double m_variationMs = 0;
+        unsigned m_samples = 0;
+        unsigned m_misses = 0;
+    };
+
+    // A margin of four variations over the smoothed time, like TCP's RTO.
+    static std::chrono::milliseconds Learned(const Estimate &estimate, unsigned multiplier,
+        std::chrono::milliseconds floor, std::chrono::milliseconds ceiling);
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, Estimate> m_estimates;
+};
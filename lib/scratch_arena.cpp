@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+
+#include "scratch_arena.hpp"
+
+ByteSpan ScratchArena::Allocate(size_t size)
+{
+    size_t offset = (m_offset + kAlignment - 1) / kAlignment * kAlignment;
+
+    // Move on to the next block that fits; blocks past m_block are free.
+    while (m_block < m_blocks.size() && offset + size > m_blocks[m_block].m_size) {
+        ++m_block;
+        offset = 0;
+    }
+
+    if (m_block == m_blocks.size()) {
+        Block block;
+        block.m_size = std::max(m_blockSize, size);
+        block.m_data.reset(new uint8_t[block.m_size]);
+        m_blocks.push_back(std::move(block));
+        offset = 0;
+    }
+
+    m_offset = offset + size;
+    return ByteSpan{m_blocks[m_block].m_data.get() + offset, size};
+}
+
+void ScratchArena::Release()
+{
+    m_blocks.clear();
+    m_block = 0;
+    m_offset = 0;
+}
+
+size_t ScratchArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const auto &block : m_blocks) {
+        capacity += block.m_size;
+    }
+    return capacity;
+}
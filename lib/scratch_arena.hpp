@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/** Bytes borrowed from a ScratchArena or any other buffer the holder does not own. */
+struct ByteSpan
+{
+    uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+
+    uint8_t *data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    uint8_t &operator[](size_t index) const { return m_data[index]; }
+};
+
+/**
+ * Bump allocator for the short-lived buffers of one device session, such
+ * as protocol headers and response frames.  Allocations come from a few
+ * blocks that are kept for reuse: a Scope hands everything allocated inside
+ * it back when it ends, and Release() frees the blocks in bulk.  Not thread
+ * safe; owned by the thread running the protocol.
+ */
+class ScratchArena {
+public:
+    explicit ScratchArena(size_t blockSize = 4096) : m_blockSize{blockSize} {}
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    /** size bytes, uninitialised, valid until the enclosing Scope ends. */
+    ByteSpan Allocate(size_t size);
+
+    /** Rewinds the arena to where it was when the scope began. */
+    class Scope {
+    public:
+        explicit Scope(ScratchArena &arena) : m_arena{arena}, m_block{arena.m_block}, m_offset{arena.m_offset} {}
+        ~Scope()
+        {
+            m_arena.m_block = m_block;
+            m_arena.m_offset = m_offset;
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        ScratchArena &m_arena;
+        const size_t m_block;
+        const size_t m_offset;
+    };
+
+    /** Free every block.  Must not be called inside a Scope. */
+    void Release();
+
+    /** Bytes held in blocks, allocated or not. */
+    size_t GetCapacity() const;
+
+private:
+    static constexpr size_t kAlignment = 16;
+
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> m_data;
+        size_t m_size = 0;
+    };
+
+    const size_t m_blockSize;
+    std::vector<Block> m_blocks;
+    // Block being allocated from and the first free byte in it.
+    size_t m_block = 0;
+    size_t m_offset = 0;
+};
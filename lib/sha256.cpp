@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+#include <cstring>
+
+#include "sha256.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SHA256_X86_SHA_NI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t RotateRight(uint32_t value, int bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+void ProcessBlocksPortable(uint32_t *state, const uint8_t *data, size_t blocks)
+{
+    uint32_t w[64];
+    while (blocks-- > 0) {
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (static_cast<uint32_t>(data[i * 4]) << 24) | (static_cast<uint32_t>(data[i * 4 + 1]) << 16) |
+                (static_cast<uint32_t>(data[i * 4 + 2]) << 8) | static_cast<uint32_t>(data[i * 4 + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            const uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            const uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+            const uint32_t ch = (e & f) ^ (~e & g);
+            const uint32_t t1 = h + s1 + ch + kRoundConstants[i] + w[i];
+            const uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+            const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            const uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        data += 64;
+    }
+}
+
+#if SHA256_X86_SHA_NI
+bool HasShaExtensions()
+{
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool ssse3 = (ecx & (1U << 9)) != 0;
+    const bool sse41 = (ecx & (1U << 19)) != 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool sha = (ebx & (1U << 29)) != 0;
+    return ssse3 && sse41 && sha;
+}
+
+// Four rounds per step; the message schedule for later steps is built
+// alongside with SHA256MSG1/SHA256MSG2 in a ring of four registers.
+__attribute__((target("sha,sse4.1,ssse3")))
+void ProcessBlocksShaNi(uint32_t *state, const uint8_t *data, size_t blocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions take the state as ABEF / CDGH.
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0])), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    while (blocks-- > 0) {
+        const __m128i savedState0 = state0;
+        const __m128i savedState1 = state1;
+        __m128i msg[4];
+
+        for (int i = 0; i < 16; ++i) {
+            __m128i &current = msg[i & 3];
+            if (i < 4) {
+                current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16)),
+                    byteSwap);
+            }
+
+            __m128i words = _mm_add_epi32(current,
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&kRoundConstants[i * 4])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+
+            if (i >= 3 && i < 15) {
+                __m128i &next = msg[(i + 1) & 3];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, msg[(i + 3) & 3], 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+
+            words = _mm_shuffle_epi32(words, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, words);
+
+            if (i >= 1 && i < 13) {
+                __m128i &previous = msg[(i + 3) & 3];
+                previous = _mm_sha256msg1_epu32(previous, current);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, savedState0);
+        state1 = _mm_add_epi32(state1, savedState1);
+        data += 64;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+
+const bool kUseShaExtensions = HasShaExtensions();
+#endif
+
+}
+
+void Sha256::Reset()
+{
+    m_state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    m_blockSize = 0;
+    m_totalSize = 0;
+}
+
+void Sha256::ProcessBlocks(const uint8_t *data, size_t blocks)
+{
+#if SHA256_X86_SHA_NI
+    if (kUseShaExtensions) {
+        ProcessBlocksShaNi(m_state.data(), data, blocks);
+        return;
+    }
+#endif
+    ProcessBlocksPortable(m_state.data(), data, blocks);
+}
+
+void Sha256::Update(const uint8_t *data, size_t size)
+{
+    m_totalSize += size;
+
+    if (m_blockSize > 0) {
+        const size_t copySize = std::min(size, m_block.size() - m_blockSize);
+        std::memcpy(m_block.data() + m_blockSize, data, copySize);
+        m_blockSize += copySize;
+        data += copySize;
+        size -= copySize;
+        if (m_blockSize < m_block.size()) {
+            return;
+        }
+        ProcessBlocks(m_block.data(), 1);
+        m_blockSize = 0;
+    }
+
+    const size_t blocks = size / m_block.size();
+    if (blocks > 0) {
+        ProcessBlocks(data, blocks);
+        data += blocks * m_block.size();
+        size -= blocks * m_block.size();
+    }
+
+    if (size > 0) {
+        std::memcpy(m_block.data(), data, size);
+        m_blockSize = size;
+    }
+}
+
+std::string Sha256::FinalHex()
+{
+    const uint64_t totalBits = m_totalSize * 8;
+
+    // Pad with 0x80, zeros and the big-endian bit count to a block boundary.
+    uint8_t padding[72] = {0x80};
+    const size_t padSize = (m_blockSize < 56 ? 56 : 120) - m_blockSize;
+    for (int i = 0; i < 8; ++i) {
+        padding[padSize + i] = static_cast<uint8_t>(totalBits >> (56 - i * 8));
+    }
+    Update(padding, padSize + 8);
+
+    static const char kHexDigits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(m_state.size() * 8);
+    for (uint32_t word : m_state) {
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            hex.push_back(kHexDigits[(word >> shift) & 0xF]);
+        }
+    }
+    return hex;
+}
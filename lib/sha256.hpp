@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Incremental SHA-256.  Uses the x86 SHA extensions when the CPU has them
+ * and a portable implementation otherwise.  Not thread safe.
+ */
+class Sha256 {
+public:
+    Sha256() { Reset(); }
+
+    void Reset();
+    void Update(const uint8_t *data, size_t size);
+
+    /** Finish the digest.  @return lowercase hex, as in manifest.yaml.  Reset() before reuse. */
+    std::string FinalHex();
+
+private:
+    std::array<uint32_t, 8> m_state;
+    std::array<uint8_t, 64> m_block;
+    size_t m_blockSize = 0;
+    uint64_t m_totalSize = 0;
+
+    void ProcessBlocks(const uint8_t *data, size_t blocks);
+};
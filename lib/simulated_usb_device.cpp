@@ -0,0 +1,1030 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "simulated_usb_device.hpp"
+#include "astra_log.hpp"
+#include "fastboot_batch.hpp"
+#include "thread_policy.hpp"
+
+namespace {
+
+constexpr uint8_t kHostSync1 = 0x5B;
+constexpr uint8_t kHostSync2 = 0x5A;
+constexpr size_t kHostHeaderSize = 8;
+constexpr size_t kOpHeaderSize = 32;
+
+constexpr uint8_t kServiceIdBoot = 0x33;
+constexpr uint8_t kHostApiServiceId = 0x0D;
+
+constexpr uint8_t kOpcodeVersion = 0x0A;
+constexpr uint8_t kOpcodeRunImage = 0x0B;
+constexpr uint8_t kOpcodeExec0C = 0x0C;
+constexpr uint8_t kOpcodeUpload = 0x12;
+constexpr uint8_t kOpcodeUploadM52Bl = 0x04;
+
+constexpr uint32_t kImgTypeOptee = 0x00020014;
+
+constexpr uint32_t kSimulatedVersion = 0x00010000;
+constexpr uint32_t kResponseUnsupported = 7;
+
+// SL16XX image request packets are a fixed-size interrupt transfer.
+const std::string kImageRequestString = "i*m*g*r*q*";
+constexpr size_t kImageRequestPacketSize = 64;
+constexpr uint8_t kBootImageType = 0x00;
+// Above 0x79 the host records the image size for the 07_IMAGE request.
+constexpr uint8_t kUpdateImageType = 0x80;
+constexpr size_t kSL16XXHeaderSize = sizeof(uint32_t) * 2;
+
+const std::string kUbootPrompt = "\r\n=> ";
+constexpr std::chrono::seconds kPromptRepeat{1};
+
+constexpr const char *kMaxDownloadSize = "0x10000000";
+constexpr size_t kMaxCapturedDownload = 1024 * 1024;
+
+void AppendU32LE(std::vector<uint8_t> &buffer, uint32_t value)
+{
+    buffer.push_back(static_cast<uint8_t>(value & 0xFF));
+    buffer.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+    buffer.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+    buffer.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+}
+
+uint32_t ReadU32LE(const uint8_t *ptr)
+{
+    return static_cast<uint32_t>(ptr[0]) |
+        (static_cast<uint32_t>(ptr[1]) << 8) |
+        (static_cast<uint32_t>(ptr[2]) << 16) |
+        (static_cast<uint32_t>(ptr[3]) << 24);
+}
+
+}
+
+SimulatedLink::Clock::time_point SimulatedLink::Reserve(size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Clock::time_point start = std::max(Clock::now(), m_busyUntil);
+    m_busyUntil = start;
+    if (m_bytesPerSecond > 0) {
+        m_busyUntil += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(size) / m_bytesPerSecond));
+    }
+
+    return m_busyUntil;
+}
+
+SimulatedUSBDevice::SimulatedUSBDevice(std::shared_ptr<SimulatedBoard> board,
+    std::shared_ptr<const SimulatedDeviceScript> script, const AstraSimulatorConfig &config,
+    ResetCallback resetCallback)
+    : USBDevice(board->m_usbPath), m_board{board}, m_script{script}, m_resetCallback{resetCallback},
+    m_link{config.m_linkMBps * 1000000.0}, m_latency{config.m_latencyUs}, m_resetDelay{config.m_resetMs},
+    m_interruptImage{config.m_interruptImage}, m_stage{board->m_stage}
+{
+    ASTRA_LOG;
+
+    m_vendorId = m_script->m_vendorId;
+    m_productId = m_script->m_productId;
+    switch (m_stage) {
+        case SIMULATED_BOARD_STAGE_BOOTROM:
+            // The SL26XX boot ROM exposes a second interface; M52BL has one.
+            m_numInterfaces = m_script->m_series == ASTRA_SERIES_SL26XX ? 2 : 1;
+            m_headerWanted = m_script->m_series == ASTRA_SERIES_SL26XX ? kOpHeaderSize : kSL16XXHeaderSize;
+            break;
+        case SIMULATED_BOARD_STAGE_M52BL:
+            m_headerWanted = kOpHeaderSize;
+            break;
+        case SIMULATED_BOARD_STAGE_SYSMGR:
+            if (m_script->m_sysMgrVendorId != 0) {
+                m_vendorId = m_script->m_sysMgrVendorId;
+                m_productId = m_script->m_sysMgrProductId;
+            }
+            m_headerWanted = kHostHeaderSize;
+            break;
+        case SIMULATED_BOARD_STAGE_FASTBOOT:
+            m_vendorId = m_script->m_fastbootVendorId;
+            m_productId = m_script->m_fastbootProductId;
+            m_stageImage = NextStageImage();
+            break;
+    }
+}
+
+SimulatedUSBDevice::~SimulatedUSBDevice()
+{
+    ASTRA_LOG;
+
+    Close();
+}
+
+int SimulatedUSBDevice::Open(std::function<void(USBEvent event, uint8_t *buf, size_t size)> usbEventCallback)
+{
+    ASTRA_LOG;
+
+    if (m_shutdown.load()) {
+        return -1;
+    }
+
+    // Opened again when a fastboot serial probe hands the device on.
+    m_usbEventCallback = usbEventCallback;
+
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+    if (!m_eventThreadRunning) {
+        m_eventThreadRunning = true;
+        m_eventThread = ThreadPolicy::Start(THREAD_ROLE_USB, "astra-sim-board", &SimulatedUSBDevice::EventThread, this);
+    }
+    m_opened = true;
+    m_running.store(true);
+    if (m_stage == SIMULATED_BOARD_STAGE_FASTBOOT) {
+        // U-Boot's fastboot gadget reports serial# as its iSerialNumber.
+        m_serialNumber = GetSerial();
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated device opened: " << m_usbPath << " stage " << m_stage << endLog;
+
+    return 0;
+}
+
+int SimulatedUSBDevice::EnableInterrupts()
+{
+    ASTRA_LOG;
+
+    if (m_callbackThreadRunning.load()) {
+        return 0;
+    }
+
+    int ret = USBDevice::EnableInterrupts();
+    if (ret < 0) {
+        return ret;
+    }
+
+    // The SL16XX boot ROM starts asking for images as soon as it is serviced.
+    if (m_script->m_series != ASTRA_SERIES_SL26XX && m_stage == SIMULATED_BOARD_STAGE_BOOTROM) {
+        std::lock_guard<std::mutex> lock(m_protocolMutex);
+        if (m_imageRequests.empty() && !m_bootComplete) {
+            for (const auto &name : m_script->m_bootImages) {
+                m_imageRequests.push_back({name, kBootImageType});
+            }
+            ImageReceived(Clock::now());
+        }
+    }
+
+    return 0;
+}
+
+void SimulatedUSBDevice::Close()
+{
+    ASTRA_LOG;
+
+    {
+        std::lock_guard<std::mutex> lock(m_closeMutex);
+        if (m_shutdown.exchange(true)) {
+            return;
+        }
+    }
+
+    m_running.store(false);
+
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        m_eventThreadRunning = false;
+        m_events.clear();
+    }
+    m_eventCV.notify_all();
+    if (m_eventThread.joinable()) {
+        m_eventThread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_bulkInMutex);
+        m_disconnected.store(true);
+    }
+    m_bulkInCV.notify_all();
+    CompleteBulkRead(0);
+
+    StopCallbackWorker();
+
+    // Closed without the board resetting: the host is done with it, so it is
+    // unplugged.  A device the host never opened is still on the bus.
+    bool opened = false;
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        opened = m_opened;
+    }
+    std::lock_guard<std::mutex> lock(m_protocolMutex);
+    if (opened && !m_resetPending) {
+        m_resetPending = true;
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated board unplugged: " << m_usbPath << endLog;
+        ReplaceBoard();
+    }
+}
+
+SimulatedUSBDevice::Clock::time_point SimulatedUSBDevice::ReserveLink(size_t size)
+{
+    Clock::time_point completion = m_link.Reserve(size);
+    if (m_board->m_hubLink != nullptr) {
+        completion = std::max(completion, m_board->m_hubLink->Reserve(size));
+    }
+
+    return completion;
+}
+
+void SimulatedUSBDevice::RetireWrite(Clock::time_point completion, Clock::time_point submitTime)
+{
+    {
+        // Writes in flight end as soon as the board drops off the bus.
+        std::unique_lock<std::mutex> lock(m_bulkInMutex);
+        m_bulkInCV.wait_until(lock, completion, [this]() { return m_disconnected.load(); });
+    }
+    if (m_transferStats) {
+        m_transferStats->RecordWriteLatency(completion - submitTime);
+    }
+}
+
+int SimulatedUSBDevice::Write(uint8_t *data, size_t size, int *transferred)
+{
+    ASTRA_LOG;
+
+    *transferred = 0;
+
+    // Keep the byte stream ordered with respect to any writes still queued.
+    if (!m_writesInFlight.empty() && FlushQueuedWrites() < 0) {
+        return -1;
+    }
+
+    if (m_disconnected.load()) {
+        return -1;
+    }
+
+    if (m_transferStats) {
+        m_transferStats->MarkWrite();
+    }
+    const Clock::time_point submitTime = Clock::now();
+    const Clock::time_point completion = ReserveLink(size);
+    RetireWrite(completion, submitTime);
+
+    {
+        std::lock_guard<std::mutex> lock(m_protocolMutex);
+        ReceiveData(data, size, completion);
+    }
+
+    *transferred = static_cast<int>(size);
+    return 0;
+}
+
+int SimulatedUSBDevice::WriteQueued(const uint8_t *data, size_t size)
+{
+    ASTRA_LOG;
+
+    if (m_disconnected.load()) {
+        return -1;
+    }
+
+    while (m_writesInFlight.size() >= m_writeQueueDepth) {
+        RetireWrite(m_writesInFlight.front().completion, m_writesInFlight.front().submitTime);
+        m_writesInFlight.pop_front();
+    }
+
+    if (m_transferStats) {
+        m_transferStats->MarkWrite();
+    }
+    const Clock::time_point submitTime = Clock::now();
+    const Clock::time_point completion = ReserveLink(size);
+    m_writesInFlight.push_back({submitTime, completion});
+
+    // The device sees the data when it has crossed the bus.
+    std::lock_guard<std::mutex> lock(m_protocolMutex);
+    ReceiveData(data, size, completion);
+
+    return 0;
+}
+
+int SimulatedUSBDevice::FlushQueuedWrites()
+{
+    ASTRA_LOG;
+
+    while (!m_writesInFlight.empty()) {
+        RetireWrite(m_writesInFlight.front().completion, m_writesInFlight.front().submitTime);
+        m_writesInFlight.pop_front();
+    }
+
+    return m_disconnected.load() ? -1 : 0;
+}
+
+bool SimulatedUSBDevice::SetWriteQueueDepth(size_t depth)
+{
+    if (depth == 0 || depth > kMaxWritesInFlight || !m_writesInFlight.empty()) {
+        return false;
+    }
+    m_writeQueueDepth = depth;
+    return true;
+}
+
+int SimulatedUSBDevice::ReadBulk(uint8_t *data, size_t size, int *transferred, int timeoutMs)
+{
+    ASTRA_LOG;
+
+    *transferred = 0;
+
+    std::unique_lock<std::mutex> lock(m_bulkInMutex);
+    m_bulkInCV.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] {
+        return !m_bulkIn.empty() || m_disconnected.load();
+    });
+    if (m_bulkIn.empty()) {
+        return -1;
+    }
+
+    const std::string reply = std::move(m_bulkIn.front());
+    m_bulkIn.pop_front();
+
+    const size_t count = std::min(size, reply.size());
+    std::memcpy(data, reply.data(), count);
+    *transferred = static_cast<int>(count);
+
+    return 0;
+}
+
+int SimulatedUSBDevice::ReadBulkAsync(uint8_t *data, size_t size, int timeoutMs,
+    std::function<void(int result, int transferred)> done)
+{
+    ASTRA_LOG;
+
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(m_bulkInMutex);
+        if (m_bulkRead.done) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Bulk read already in flight" << endLog;
+            return -1;
+        }
+        if (m_bulkIn.empty() && !m_disconnected.load()) {
+            id = ++m_bulkReadId;
+            m_bulkRead = BulkRead{data, size, std::move(done)};
+        } else {
+            id = 0;
+        }
+    }
+
+    if (id == 0) {
+        // A reply is already waiting, or none will come.
+        int transferred = 0;
+        const int ret = ReadBulk(data, size, &transferred, 0);
+        done(ret, transferred);
+        return 0;
+    }
+
+    Schedule(Clock::now() + std::chrono::milliseconds(timeoutMs), [this, id]() { CompleteBulkRead(id); });
+    return 0;
+}
+
+int SimulatedUSBDevice::WriteInterruptData(const uint8_t *data, size_t size)
+{
+    ASTRA_LOG;
+
+    if (m_disconnected.load()) {
+        return -1;
+    }
+
+    const Clock::time_point arrival = Clock::now() + m_latency;
+
+    std::lock_guard<std::mutex> lock(m_protocolMutex);
+    m_consoleLine.append(reinterpret_cast<const char *>(data), size);
+
+    size_t end;
+    while ((end = m_consoleLine.find('\n')) != std::string::npos) {
+        std::string line = m_consoleLine.substr(0, end);
+        m_consoleLine.erase(0, end + 1);
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        ReceiveConsoleLine(line, arrival);
+    }
+
+    return 0;
+}
+
+void SimulatedUSBDevice::EventThread()
+{
+    ASTRA_LOG;
+
+    std::unique_lock<std::mutex> lock(m_eventMutex);
+    while (m_eventThreadRunning) {
+        if (m_events.empty()) {
+            m_eventCV.wait(lock);
+            continue;
+        }
+
+        auto it = m_events.begin();
+        // Copy the due time: the entry may be erased while waiting.
+        const Clock::time_point due = it->first;
+        if (Clock::now() < due) {
+            m_eventCV.wait_until(lock, due);
+            continue;
+        }
+
+        std::function<void()> action = std::move(it->second);
+        m_events.erase(it);
+
+        lock.unlock();
+        action();
+        lock.lock();
+    }
+}
+
+void SimulatedUSBDevice::Schedule(Clock::time_point due, std::function<void()> action)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        if (!m_eventThreadRunning) {
+            return;
+        }
+        m_events.emplace(due, std::move(action));
+    }
+    m_eventCV.notify_one();
+}
+
+void SimulatedUSBDevice::SendInterrupt(Clock::time_point arrival, std::vector<uint8_t> data)
+{
+    Schedule(arrival + m_latency, [this, data = std::move(data)]() {
+        QueueCallbackEvent(USB_DEVICE_EVENT_INTERRUPT, data.data(), data.size());
+    });
+}
+
+void SimulatedUSBDevice::SendBulkIn(Clock::time_point arrival, std::string reply)
+{
+    Schedule(arrival + m_latency, [this, reply = std::move(reply)]() {
+        {
+            std::lock_guard<std::mutex> lock(m_bulkInMutex);
+            m_bulkIn.push_back(reply);
+        }
+        m_bulkInCV.notify_all();
+        CompleteBulkRead(0);
+    });
+}
+
+void SimulatedUSBDevice::CompleteBulkRead(uint64_t id)
+{
+    std::function<void(int result, int transferred)> done;
+    int ret = -1;
+    int transferred = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_bulkInMutex);
+        if (!m_bulkRead.done || (id != 0 && id != m_bulkReadId)) {
+            return;
+        }
+        if (!m_bulkIn.empty()) {
+            const std::string reply = std::move(m_bulkIn.front());
+            m_bulkIn.pop_front();
+
+            const size_t count = std::min(m_bulkRead.size, reply.size());
+            std::memcpy(m_bulkRead.data, reply.data(), count);
+            transferred = static_cast<int>(count);
+            ret = 0;
+        } else if (id == 0 && !m_disconnected.load()) {
+            // Woken by nothing this read can use.
+            return;
+        }
+        done = std::move(m_bulkRead.done);
+        m_bulkRead = BulkRead{};
+    }
+
+    done(ret, transferred);
+}
+
+void SimulatedUSBDevice::Reset(SimulatedBoardStage stage, std::chrono::microseconds disconnectAfter)
+{
+    ASTRA_LOG;
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated board " << m_usbPath << " resetting into stage " << stage << endLog;
+
+    m_resetPending = true;
+    m_board->m_stage = stage;
+    Schedule(Clock::now() + disconnectAfter, [this]() { Disconnect(); });
+    m_resetCallback(m_board, m_resetDelay);
+}
+
+void SimulatedUSBDevice::FinishCycle(std::chrono::microseconds disconnectAfter)
+{
+    ASTRA_LOG;
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated board " << m_usbPath << " finished" << endLog;
+
+    m_resetPending = true;
+    Schedule(Clock::now() + disconnectAfter, [this]() { Disconnect(); });
+    ReplaceBoard();
+}
+
+void SimulatedUSBDevice::ReplaceBoard()
+{
+    ASTRA_LOG;
+
+    if (m_board->m_cyclesLeft <= 1) {
+        m_board->m_cyclesLeft = 0;
+        return;
+    }
+
+    // The next board goes into the same port once this one has been pulled.
+    --m_board->m_cyclesLeft;
+    ++m_board->m_cycle;
+    m_board->m_stage = SIMULATED_BOARD_STAGE_BOOTROM;
+    m_board->m_serial.clear();
+    m_board->m_bootImageStaged = false;
+    m_board->m_nextUpdateImage = 0;
+    m_board->m_resumeImage.clear();
+    m_board->m_interrupted = false;
+    m_resetCallback(m_board, 2 * m_resetDelay);
+}
+
+void SimulatedUSBDevice::Interrupt()
+{
+    ASTRA_LOG;
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated board " << m_usbPath << " dropping off the bus" << endLog;
+
+    // U-Boot comes back in fastboot with the same serial# and starts its
+    // image list over.
+    m_board->m_interrupted = true;
+    m_board->m_nextUpdateImage = 0;
+    m_interruptDownload = false;
+    Reset(SIMULATED_BOARD_STAGE_FASTBOOT, m_latency);
+}
+
+void SimulatedUSBDevice::Disconnect()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_bulkInMutex);
+        m_disconnected.store(true);
+    }
+    m_bulkInCV.notify_all();
+    CompleteBulkRead(0);
+
+    // Bulk-only fastboot has no transfer pending to report the disconnect.
+    if (m_stage != SIMULATED_BOARD_STAGE_FASTBOOT) {
+        QueueCallbackEvent(USB_DEVICE_EVENT_NO_DEVICE);
+    }
+}
+
+void SimulatedUSBDevice::ReceiveData(const uint8_t *data, size_t size, Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    size_t offset = 0;
+    while (offset < size && !m_resetPending) {
+        if (m_payloadRemaining > 0) {
+            if (m_interruptDownload) {
+                Interrupt();
+                return;
+            }
+            const size_t count = std::min(m_payloadRemaining, size - offset);
+            if (m_captureDownload) {
+                m_download.append(reinterpret_cast<const char *>(data + offset), count);
+            }
+            m_payloadRemaining -= count;
+            offset += count;
+            if (m_payloadRemaining == 0) {
+                ReceivePayload(arrival);
+            }
+            continue;
+        }
+
+        if (m_stage == SIMULATED_BOARD_STAGE_FASTBOOT) {
+            ReceiveFastbootCommand(std::string(reinterpret_cast<const char *>(data + offset), size - offset), arrival);
+            return;
+        }
+
+        const size_t count = std::min(m_headerWanted - m_header.size(), size - offset);
+        m_header.insert(m_header.end(), data + offset, data + offset + count);
+        offset += count;
+        if (m_header.size() == m_headerWanted) {
+            ReceiveHeader(arrival);
+        }
+    }
+}
+
+void SimulatedUSBDevice::ReceiveHeader(Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    switch (m_stage) {
+        case SIMULATED_BOARD_STAGE_BOOTROM:
+            if (m_script->m_series == ASTRA_SERIES_SL26XX) {
+                ReceiveBootRomPacket(arrival);
+            } else {
+                m_payloadRemaining = ReadU32LE(m_header.data());
+                m_header.clear();
+                if (m_payloadRemaining == 0) {
+                    ReceivePayload(arrival);
+                }
+            }
+            break;
+        case SIMULATED_BOARD_STAGE_M52BL:
+            ReceiveM52BLPacket(arrival);
+            break;
+        case SIMULATED_BOARD_STAGE_SYSMGR:
+            if (m_headerWanted == kHostHeaderSize) {
+                // The host header gives the size of the operation that follows.
+                m_headerWanted += ReadU32LE(&m_header[4]);
+                if (m_headerWanted > kHostHeaderSize) {
+                    break;
+                }
+            }
+            ReceiveSysMgrPacket(arrival);
+            m_headerWanted = kHostHeaderSize;
+            break;
+        case SIMULATED_BOARD_STAGE_FASTBOOT:
+            break;
+    }
+}
+
+void SimulatedUSBDevice::ReceivePayload(Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    switch (m_stage) {
+        case SIMULATED_BOARD_STAGE_BOOTROM:
+            if (m_script->m_series == ASTRA_SERIES_SL26XX) {
+                SendPacketResponse(arrival, 0, true);
+                if (m_opcode == kOpcodeUploadM52Bl) {
+                    // M52BL starts and enumerates with a single interface.
+                    Reset(SIMULATED_BOARD_STAGE_M52BL, m_resetDelay);
+                }
+            } else {
+                ImageReceived(arrival);
+            }
+            break;
+        case SIMULATED_BOARD_STAGE_M52BL:
+            SendPacketResponse(arrival, 0, true);
+            break;
+        case SIMULATED_BOARD_STAGE_SYSMGR:
+            SendPacketResponse(arrival, 0, false);
+            break;
+        case SIMULATED_BOARD_STAGE_FASTBOOT:
+            m_captureDownload = false;
+            m_stageReceived = m_stageRequested;
+            SendBulkIn(arrival, "OKAY");
+            break;
+    }
+}
+
+void SimulatedUSBDevice::RequestNextImage(Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    const ImageRequest request = m_imageRequests.front();
+    m_imageRequests.pop_front();
+
+    std::vector<uint8_t> packet(kImageRequestPacketSize, 0);
+    std::memcpy(packet.data(), kImageRequestString.data(), kImageRequestString.size());
+    packet[kImageRequestString.size()] = request.type;
+    std::memcpy(packet.data() + kImageRequestString.size() + 1, request.name.data(),
+        std::min(request.name.size(), kImageRequestPacketSize - kImageRequestString.size() - 1));
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated board " << m_usbPath << " requesting " << request.name << endLog;
+    SendInterrupt(arrival, std::move(packet));
+}
+
+void SimulatedUSBDevice::ImageReceived(Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    if (!m_imageRequests.empty()) {
+        RequestNextImage(arrival);
+        return;
+    }
+
+    if (!m_bootComplete) {
+        m_bootComplete = true;
+        if (m_script->m_usbConsole && !m_script->m_bootOnly) {
+            // U-Boot waits at its prompt for the host to type the flash command.
+            m_awaitingCommand = true;
+            ShowPrompt(arrival);
+            return;
+        }
+
+        m_updateRequested = true;
+        for (const auto &name : m_script->m_updateImages) {
+            m_imageRequests.push_back({name, kUpdateImageType});
+        }
+        if (!m_imageRequests.empty()) {
+            RequestNextImage(arrival);
+            return;
+        }
+    }
+
+    if (m_script->m_usbConsole) {
+        m_awaitingCommand = true;
+        ShowPrompt(arrival);
+        return;
+    }
+
+    FinishCycle(m_resetDelay);
+}
+
+void SimulatedUSBDevice::ShowPrompt(Clock::time_point arrival)
+{
+    SendInterrupt(arrival, std::vector<uint8_t>(kUbootPrompt.begin(), kUbootPrompt.end()));
+
+    // Print the prompt again for a host that was not yet watching the console.
+    Schedule(arrival + kPromptRepeat, [this]() {
+        std::lock_guard<std::mutex> lock(m_protocolMutex);
+        if (m_awaitingCommand && !m_resetPending) {
+            ShowPrompt(Clock::now());
+        }
+    });
+}
+
+void SimulatedUSBDevice::ReceiveConsoleLine(const std::string &line, Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    if (!m_awaitingCommand || line.empty() || m_resetPending) {
+        return;
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated board " << m_usbPath << " console: " << line << endLog;
+    m_awaitingCommand = false;
+
+    if (!m_updateRequested) {
+        // Any command at the first prompt is taken to be the flash command.
+        m_updateRequested = true;
+        for (const auto &name : m_script->m_updateImages) {
+            m_imageRequests.push_back({name, kUpdateImageType});
+        }
+        ImageReceived(arrival);
+    } else if (line == "reset") {
+        FinishCycle(m_resetDelay);
+    } else {
+        m_awaitingCommand = true;
+        ShowPrompt(arrival);
+    }
+}
+
+void SimulatedUSBDevice::SendPacketResponse(Clock::time_point arrival, uint32_t value, bool rawMode)
+{
+    std::vector<uint8_t> response;
+    response.push_back(kHostSync1);
+    response.push_back(kHostSync2);
+    response.push_back(rawMode ? kServiceIdBoot : kHostApiServiceId);
+    response.push_back(m_opcode);
+    if (!rawMode) {
+        AppendU32LE(response, sizeof(uint32_t));
+    }
+    AppendU32LE(response, value);
+
+    SendInterrupt(arrival, std::move(response));
+}
+
+void SimulatedUSBDevice::ReceiveBootRomPacket(Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    // Key, SPK and M52BL uploads: the header gives the unpadded payload size.
+    m_opcode = m_header[3];
+    m_payloadRemaining = ReadU32LE(&m_header[4]);
+    m_header.clear();
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated boot ROM upload opcode " << static_cast<int>(m_opcode)
+        << ", " << m_payloadRemaining << " bytes" << endLog;
+
+    if (m_payloadRemaining == 0) {
+        ReceivePayload(arrival);
+    }
+}
+
+void SimulatedUSBDevice::ReceiveM52BLPacket(Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    m_opcode = m_header[3];
+    const uint32_t numWords = ReadU32LE(&m_header[8]);
+    m_header.clear();
+
+    if (m_opcode == kOpcodeVersion) {
+        // The version word follows the sync bytes, then one trailing word.
+        std::vector<uint8_t> response = {kHostSync1, kHostSync2, kServiceIdBoot, kOpcodeVersion};
+        AppendU32LE(response, kSimulatedVersion);
+        AppendU32LE(response, 0);
+        SendInterrupt(arrival, std::move(response));
+    } else if (m_opcode == kOpcodeUpload) {
+        // Upload setup; numWords carries the byte count of the image that follows.
+        SendPacketResponse(arrival, 0, true);
+        m_payloadRemaining = numWords;
+        if (m_payloadRemaining == 0) {
+            ReceivePayload(arrival);
+        }
+    } else if (m_opcode == kOpcodeRunImage) {
+        Reset(SIMULATED_BOARD_STAGE_SYSMGR, m_resetDelay);
+    } else {
+        SendPacketResponse(arrival, kResponseUnsupported, true);
+    }
+}
+
+void SimulatedUSBDevice::ReceiveSysMgrPacket(Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    const uint8_t *op = m_header.data() + kHostHeaderSize;
+    if (m_header.size() < kHostHeaderSize + kOpHeaderSize) {
+        m_opcode = m_header[3];
+        m_header.clear();
+        SendPacketResponse(arrival, kResponseUnsupported, false);
+        return;
+    }
+
+    m_opcode = op[3];
+    const uint32_t numWords = ReadU32LE(&op[8]);
+    const uint32_t imageType = ReadU32LE(&op[20]);
+    m_header.clear();
+
+    if (m_opcode == kOpcodeVersion) {
+        SendPacketResponse(arrival, kSimulatedVersion, false);
+    } else if (m_opcode == kOpcodeUpload) {
+        m_imageType = imageType;
+        SendPacketResponse(arrival, 0, false);
+        m_payloadRemaining = numWords;
+        if (m_payloadRemaining == 0) {
+            ReceivePayload(arrival);
+        }
+    } else if (m_opcode == kOpcodeExec0C) {
+        if (m_imageType != kImgTypeOptee) {
+            SendPacketResponse(arrival, 0, false);
+        } else if (m_script->m_fastbootVendorId != 0) {
+            // The A-Core runs U-Boot, which enumerates as a fastboot device.
+            Reset(SIMULATED_BOARD_STAGE_FASTBOOT, m_resetDelay);
+        }
+        // Without fastboot the board stays booted until the host lets it go.
+    } else {
+        SendPacketResponse(arrival, kResponseUnsupported, false);
+    }
+}
+
+std::string SimulatedUSBDevice::NextStageImage() const
+{
+    if (!m_board->m_bootImageStaged && !m_script->m_bootImages.empty()) {
+        return m_script->m_bootImages.back();
+    }
+    if (m_board->m_nextUpdateImage < m_script->m_updateImages.size()) {
+        return m_script->m_updateImages[m_board->m_nextUpdateImage];
+    }
+
+    return "";
+}
+
+std::string SimulatedUSBDevice::GetSerial() const
+{
+    if (!m_board->m_serial.empty()) {
+        return m_board->m_serial;
+    }
+
+    std::ostringstream serial;
+    serial << "SIM" << std::setw(4) << std::setfill('0') << m_board->m_boardNumber << "-" << m_board->m_cycle;
+    return serial.str();
+}
+
+void SimulatedUSBDevice::ReceiveFastbootCommand(const std::string &command, Clock::time_point arrival)
+{
+    ASTRA_LOG;
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated fastboot command: " << command << endLog;
+
+    const std::string getVar = "getvar:";
+    const std::string commandWait = "fb_command_wait:";
+    if (command.rfind(getVar, 0) == 0) {
+        const std::string name = command.substr(getVar.size());
+        if (name == "serialno") {
+            SendBulkIn(arrival, "OKAY" + GetSerial());
+        } else if (name == "fb_resume") {
+            SendBulkIn(arrival, "OKAY" + m_board->m_resumeImage);
+        } else if (name == "fb_batch") {
+            SendBulkIn(arrival, "OKAY" + std::to_string(FastbootBatch::kVersion));
+        } else if (name == "max-download-size") {
+            SendBulkIn(arrival, std::string("OKAY") + kMaxDownloadSize);
+        } else if (name == "fb_command" || name.rfind(commandWait, 0) == 0) {
+            if (!m_stageImage.empty() && !m_stageRequested) {
+                m_stageRequested = true;
+                SendBulkIn(arrival, "OKAYstage " + m_stageImage);
+            } else if (name == "fb_command") {
+                SendBulkIn(arrival, "OKAY");
+            } else {
+                // Nothing to request: hold the reply for the wait the host asked for.
+                int waitMs = 0;
+                try {
+                    waitMs = std::stoi(name.substr(commandWait.size()));
+                } catch (const std::exception &) {
+                }
+                SendBulkIn(arrival + std::chrono::milliseconds(std::max(waitMs, 0)), "OKAY");
+            }
+        } else {
+            SendBulkIn(arrival, "FAILunknown variable");
+        }
+        return;
+    }
+
+    const std::string download = "download:";
+    if (command.rfind(download, 0) == 0) {
+        size_t size = 0;
+        try {
+            size = std::stoul(command.substr(download.size()), nullptr, 16);
+        } catch (const std::exception &) {
+            SendBulkIn(arrival, "FAILinvalid size");
+            return;
+        }
+
+        std::ostringstream reply;
+        reply << "DATA" << std::setw(8) << std::setfill('0') << std::hex << size;
+        SendBulkIn(arrival, reply.str());
+
+        // Keep uEnv.txt, which carries the serial# U-Boot reports after the
+        // reboot, and batches, whose TOC says where the image list continues.
+        m_download.clear();
+        m_captureDownload = m_stageRequested && size <= kMaxCapturedDownload;
+        m_interruptDownload = m_stageRequested && m_board->m_bootImageStaged && !m_board->m_interrupted &&
+            m_board->m_nextUpdateImage + 1 == m_interruptImage;
+        m_payloadRemaining = size;
+        if (m_payloadRemaining == 0) {
+            ReceivePayload(arrival);
+        }
+        return;
+    }
+
+    if (command == "oem run:setenv fb_exit 1") {
+        ExitFastboot();
+        return;
+    }
+
+    if (command.rfind("oem run:setenv fb_ret ", 0) == 0) {
+        // A skipped image is done with, as if it had been staged.
+        if (command == "oem run:setenv fb_ret SKIP") {
+            m_stageReceived = m_stageRequested;
+        } else if (command == "oem run:setenv fb_ret BATCH" &&
+            !FastbootBatch::DecodeNames(reinterpret_cast<const uint8_t *>(m_download.data()), m_download.size(),
+                m_batchImages))
+        {
+            SendBulkIn(arrival, "FAILinvalid batch");
+            return;
+        }
+        SendBulkIn(arrival, "OKAY");
+        return;
+    }
+
+    const std::string setResume = "oem run:setenv fb_resume ";
+    if (command.rfind(setResume, 0) == 0) {
+        m_board->m_resumeImage = command.substr(setResume.size());
+        SendBulkIn(arrival, "OKAY");
+        return;
+    }
+
+    SendBulkIn(arrival, "FAILunknown command");
+}
+
+void SimulatedUSBDevice::ExitFastboot()
+{
+    ASTRA_LOG;
+
+    // U-Boot leaves fastboot without replying, so nothing more gets through.
+    {
+        std::lock_guard<std::mutex> lock(m_bulkInMutex);
+        m_disconnected.store(true);
+    }
+    m_bulkInCV.notify_all();
+    CompleteBulkRead(0);
+
+    if (m_stageReceived) {
+        if (!m_board->m_bootImageStaged && !m_script->m_bootImages.empty()) {
+            m_board->m_bootImageStaged = true;
+
+            const std::string serialKey = "serial# ";
+            const size_t start = m_download.find(serialKey);
+            if (start != std::string::npos) {
+                const size_t begin = start + serialKey.size();
+                const size_t end = m_download.find_first_of("; \t\r\n", begin);
+                m_board->m_serial = m_download.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+            }
+        } else {
+            ++m_board->m_nextUpdateImage;
+            if (!m_batchImages.empty()) {
+                // The list continues after the last image of the batch.
+                const auto &images = m_script->m_updateImages;
+                auto it = std::find(images.begin() + static_cast<std::ptrdiff_t>(m_board->m_nextUpdateImage - 1),
+                    images.end(), m_batchImages.back());
+                if (it != images.end()) {
+                    m_board->m_nextUpdateImage = static_cast<size_t>(it - images.begin()) + 1;
+                }
+            }
+            if (!m_board->m_resumeImage.empty()) {
+                const auto &images = m_script->m_updateImages;
+                auto it = std::find(images.begin(), images.end(), m_board->m_resumeImage);
+                if (it != images.end()) {
+                    m_board->m_nextUpdateImage = static_cast<size_t>(it - images.begin());
+                }
+                m_board->m_resumeImage.clear();
+            }
+        }
+    }
+
+    if (!NextStageImage().empty()) {
+        Reset(SIMULATED_BOARD_STAGE_FASTBOOT, m_latency);
+    } else {
+        FinishCycle(m_latency);
+    }
+}
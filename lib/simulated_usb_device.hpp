@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "astra_device.hpp"
+#include "astra_device_manager.hpp"
+#include "usb_device.hpp"
+
+/**
+ * Bulk OUT bandwidth shared by every transfer reserved on it: one device's
+ * link, or the upstream port of a simulated hub.  Transfers are serialised,
+ * so a busy link delays the next reservation.
+ */
+class SimulatedLink {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @param bytesPerSecond  Link bandwidth; 0 means unlimited. */
+    explicit SimulatedLink(double bytesPerSecond) : m_bytesPerSecond(bytesPerSecond) {}
+
+    /** Reserve the link for size bytes.  @return when they have been transferred. */
+    Clock::time_point Reserve(size_t size);
+
+private:
+    const double m_bytesPerSecond;
+    std::mutex m_mutex;
+    Clock::time_point m_busyUntil{};
+};
+
+/** What simulated boards ask the host for, taken from the boot and flash images. */
+struct SimulatedDeviceScript
+{
+    AstraDeviceSeries m_series = ASTRA_SERIES_SL16XX;
+    uint16_t m_vendorId = 0;
+    uint16_t m_productId = 0;
+    uint16_t m_sysMgrVendorId = 0;
+    uint16_t m_sysMgrProductId = 0;
+    uint16_t m_fastbootVendorId = 0;
+    uint16_t m_fastbootProductId = 0;
+    bool m_bootOnly = false;
+    bool m_usbConsole = false;                  // SL16XX: U-Boot waits at a USB console prompt for the flash command
+    std::vector<std::string> m_bootImages;      // SL16XX boot requests, final boot image last
+    std::vector<std::string> m_updateImages;    // requested once booted, final update image (or 07_IMAGE) last
+};
+
+enum SimulatedBoardStage {
+    SIMULATED_BOARD_STAGE_BOOTROM,
+    SIMULATED_BOARD_STAGE_M52BL,
+    SIMULATED_BOARD_STAGE_SYSMGR,
+    SIMULATED_BOARD_STAGE_FASTBOOT,
+};
+
+/**
+ * State of one simulated board that survives its resets: each enumeration
+ * is a new SimulatedUSBDevice picking up where the previous one left off.
+ */
+struct SimulatedBoard
+{
+    std::string m_usbPath;
+    unsigned m_boardNumber = 0;
+    unsigned m_cyclesLeft = 1;                  // boards still to run on this port, this one included
+    unsigned m_cycle = 0;
+    std::shared_ptr<SimulatedLink> m_hubLink;
+    SimulatedBoardStage m_stage = SIMULATED_BOARD_STAGE_BOOTROM;
+    std::string m_serial;
+    bool m_bootImageStaged = false;            // fastboot: uEnv.txt has been staged
+    size_t m_nextUpdateImage = 0;
+    std::string m_resumeImage;                 // fastboot: fb_resume, the image to continue the list at
+    bool m_interrupted = false;
+};
+
+/**
+ * USBDevice backed by a simulated board instead of hardware.  Bulk OUT data
+ * is timed against the link bandwidth and parsed by the board's protocol:
+ * the SL16XX image-request loop, the SL26XX boot ROM / M52BL / SysMgr packet
+ * protocol, or the U-Boot fastboot stage loop.  Replies and image requests
+ * arrive after the configured device latency, and a board that resets asks
+ * the transport to enumerate it again.  Payloads are only counted, so a
+ * simulated update costs the host what a real one does minus the bus.
+ */
+class SimulatedUSBDevice : public USBDevice {
+public:
+    /** Called when the board resets; it reappears on the bus after delay. */
+    using ResetCallback = std::function<void(std::shared_ptr<SimulatedBoard> board, std::chrono::milliseconds delay)>;
+
+    SimulatedUSBDevice(std::shared_ptr<SimulatedBoard> board, std::shared_ptr<const SimulatedDeviceScript> script,
+        const AstraSimulatorConfig &config, ResetCallback resetCallback);
+    ~SimulatedUSBDevice() override;
+
+    int Open(std::function<void(USBEvent event, uint8_t *buf, size_t size)> usbEventCallback) override;
+    int EnableInterrupts() override;
+    void Close() override;
+
+    int Write(uint8_t *data, size_t size, int *transferred) override;
+    int ReadBulk(uint8_t *data, size_t size, int *transferred, int timeoutMs = 5000) override;
+    int ReadBulkAsync(uint8_t *data, size_t size, int timeoutMs, std::function<void(int result, int transferred)> done) override;
+    int WriteQueued(const uint8_t *data, size_t size) override;
+    int FlushQueuedWrites() override;
+    size_t GetWriteQueueDepth() const override { return m_writeQueueDepth; }
+    size_t GetMaxWriteQueueDepth() const override { return kMaxWritesInFlight; }
+    bool SetWriteQueueDepth(size_t depth) override;
+    int WriteInterruptData(const uint8_t *data, size_t size) override;
+
+    uint16_t GetVendorId() const override { return m_vendorId; }
+    uint16_t GetProductId() const override { return m_productId; }
+    uint8_t GetNumInterfaces() const override { return m_numInterfaces; }
+
+private:
+    using Clock = SimulatedLink::Clock;
+
+    static constexpr size_t kMaxWritesInFlight = 8;
+    size_t m_writeQueueDepth = 4;
+
+    std::shared_ptr<SimulatedBoard> m_board;
+    std::shared_ptr<const SimulatedDeviceScript> m_script;
+    ResetCallback m_resetCallback;
+    SimulatedLink m_link;
+    const std::chrono::microseconds m_latency;
+    const std::chrono::milliseconds m_resetDelay;
+    const unsigned m_interruptImage;
+    const SimulatedBoardStage m_stage;
+    uint16_t m_vendorId = 0;
+    uint16_t m_productId = 0;
+    uint8_t m_numInterfaces = 1;
+
+    // Queued writes still on the simulated bus, oldest first.
+    struct WriteInFlight {
+        Clock::time_point submitTime;
+        Clock::time_point completion;
+    };
+    std::deque<WriteInFlight> m_writesInFlight;
+
+    // Device-side actions (replies, image requests, disconnect) run at their
+    // due time on m_eventThread while the device is open.
+    std::mutex m_eventMutex;
+    std::condition_variable m_eventCV;
+    std::multimap<Clock::time_point, std::function<void()>> m_events;
+    std::thread m_eventThread;
+    bool m_eventThreadRunning = false;
+    bool m_opened = false;
+
+    // Fastboot replies waiting for ReadBulk().
+    std::mutex m_bulkInMutex;
+    std::condition_variable m_bulkInCV;
+    std::deque<std::string> m_bulkIn;
+    std::atomic<bool> m_disconnected{false};
+
+    // A ReadBulkAsync() waiting for a reply.  Its timeout carries its id so
+    // it cannot end a later read.
+    struct BulkRead {
+        uint8_t *data = nullptr;
+        size_t size = 0;
+        std::function<void(int result, int transferred)> done;
+    };
+    BulkRead m_bulkRead;
+    uint64_t m_bulkReadId = 0;
+
+    // Protocol state; bulk OUT data, console input and the first image
+    // request may come from different host threads.
+    std::mutex m_protocolMutex;
+    bool m_resetPending = false;
+    std::vector<uint8_t> m_header;
+    size_t m_headerWanted = 0;
+    size_t m_payloadRemaining = 0;
+    uint8_t m_opcode = 0;
+    uint32_t m_imageType = 0;
+
+    // SL16XX image requests still to make, and the console line being typed.
+    struct ImageRequest {
+        std::string name;
+        uint8_t type;
+    };
+    std::deque<ImageRequest> m_imageRequests;
+    bool m_bootComplete = false;
+    bool m_updateRequested = false;
+    bool m_awaitingCommand = false;
+    std::string m_consoleLine;
+
+    // Fastboot stage request of this session, and the staged uEnv.txt.
+    std::string m_stageImage;
+    bool m_stageRequested = false;
+    bool m_stageReceived = false;
+    std::string m_download;
+    bool m_captureDownload = false;
+    std::vector<std::string> m_batchImages;   // images of a batch answered with fb_ret BATCH
+    bool m_interruptDownload = false;
+
+    void EventThread();
+    void Schedule(Clock::time_point due, std::function<void()> action);
+    void SendInterrupt(Clock::time_point arrival, std::vector<uint8_t> data);
+    void SendBulkIn(Clock::time_point arrival, std::string reply);
+    // Finish the waiting ReadBulkAsync() with the next reply, or a failure
+    // if there is none; id 0 matches any read.
+    void CompleteBulkRead(uint64_t id);
+    void Reset(SimulatedBoardStage stage, std::chrono::microseconds disconnectAfter);
+    void FinishCycle(std::chrono::microseconds disconnectAfter);
+    void ReplaceBoard();
+    void Disconnect();
+    void Interrupt();
+
+    void ReceiveData(const uint8_t *data, size_t size, Clock::time_point arrival);
+    void ReceiveHeader(Clock::time_point arrival);
+    void ReceivePayload(Clock::time_point arrival);
+
+    void RequestNextImage(Clock::time_point arrival);
+    void ImageReceived(Clock::time_point arrival);
+    void ShowPrompt(Clock::time_point arrival);
+    void ReceiveConsoleLine(const std::string &line, Clock::time_point arrival);
+
+    void SendPacketResponse(Clock::time_point arrival, uint32_t value, bool rawMode);
+    void ReceiveBootRomPacket(Clock::time_point arrival);
+    void ReceiveM52BLPacket(Clock::time_point arrival);
+    void ReceiveSysMgrPacket(Clock::time_point arrival);
+
+    void ReceiveFastbootCommand(const std::string &command, Clock::time_point arrival);
+    void ExitFastboot();
+
+    Clock::time_point ReserveLink(size_t size);
+    void RetireWrite(Clock::time_point completion, Clock::time_point submitTime);
+    std::string NextStageImage() const;
+    std::string GetSerial() const;
+};
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+#include <iomanip>
+
+#include "simulated_usb_transport.hpp"
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+namespace {
+
+const std::string kUEnvFilename = "uEnv.txt";
+const std::string kSizeRequestImageFilename = "07_IMAGE";
+
+}
+
+SimulatedUSBTransport::SimulatedUSBTransport(bool usbDebug, const AstraSimulatorConfig &config,
+    std::shared_ptr<const SimulatedDeviceScript> script)
+    : USBTransport(usbDebug), m_config{config}, m_script{script}
+{}
+
+SimulatedUSBTransport::~SimulatedUSBTransport()
+{
+    ASTRA_LOG;
+
+    Shutdown();
+}
+
+int SimulatedUSBTransport::Init(std::vector<USBVendorProductId> vendorProductIds, const std::string filterPorts,
+    std::function<void(std::unique_ptr<USBDevice>)> deviceAddedCallback)
+{
+    ASTRA_LOG;
+
+    if (vendorProductIds.empty()) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Vendor/product ID list cannot be empty" << endLog;
+        return -1;
+    }
+
+    m_supportedDevices = vendorProductIds;
+    m_filterPorts = ParseFilterPortString(filterPorts);
+    m_deviceAddedCallback = deviceAddedCallback;
+
+    const unsigned devicesPerHub = std::max(m_config.m_devicesPerHub, 1U);
+    std::shared_ptr<SimulatedLink> hubLink;
+    for (unsigned i = 0; i < m_config.m_deviceCount; ++i) {
+        const unsigned hub = i / devicesPerHub + 1;
+        const unsigned port = i % devicesPerHub + 1;
+        if (port == 1 && m_config.m_hubMBps > 0) {
+            hubLink = std::make_shared<SimulatedLink>(m_config.m_hubMBps * 1000000.0);
+        }
+
+        auto board = std::make_shared<SimulatedBoard>();
+        board->m_usbPath = "100-" + std::to_string(hub) + "." + std::to_string(port);
+        board->m_boardNumber = i + 1;
+        board->m_cyclesLeft = std::max(m_config.m_cycles, 1U);
+        board->m_hubLink = hubLink;
+        m_boards.push_back(board);
+        ScheduleArrival(m_arrivalQueue, board, std::chrono::milliseconds(0));
+    }
+
+    log(ASTRA_LOG_LEVEL_INFO) << "Simulating " << m_config.m_deviceCount << " device(s) on "
+        << (m_config.m_deviceCount + devicesPerHub - 1) / devicesPerHub << " hub(s), "
+        << m_config.m_linkMBps << " MB/s per device, " << m_config.m_latencyUs << " us latency" << endLog;
+
+    m_running.store(true);
+    m_deviceMonitorThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-sim-mon", &SimulatedUSBTransport::DeviceMonitorThread, this);
+
+    return 0;
+}
+
+void SimulatedUSBTransport::Shutdown()
+{
+    ASTRA_LOG;
+
+    std::lock_guard<std::mutex> lock(m_shutdownMutex);
+    if (m_running.exchange(false)) {
+        {
+            std::lock_guard<std::mutex> queueLock(m_arrivalQueue->mutex);
+            m_arrivalQueue->running = false;
+            m_arrivalQueue->arrivals.clear();
+        }
+        m_arrivalQueue->cv.notify_all();
+
+        if (m_deviceMonitorThread.joinable()) {
+            m_deviceMonitorThread.join();
+        }
+    }
+}
+
+void SimulatedUSBTransport::ScheduleArrival(const std::shared_ptr<ArrivalQueue> &queue,
+    std::shared_ptr<SimulatedBoard> board, std::chrono::milliseconds delay)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->running) {
+            return;
+        }
+        queue->arrivals.emplace(Clock::now() + delay, std::move(board));
+    }
+    queue->cv.notify_all();
+}
+
+void SimulatedUSBTransport::DeviceMonitorThread()
+{
+    ASTRA_LOG;
+
+    // Devices re-enumerate through a weak reference so a late reset after
+    // Shutdown() finds the queue stopped rather than a destroyed transport.
+    std::weak_ptr<ArrivalQueue> weakQueue = m_arrivalQueue;
+    SimulatedUSBDevice::ResetCallback resetCallback =
+        [weakQueue](std::shared_ptr<SimulatedBoard> board, std::chrono::milliseconds delay) {
+            if (auto queue = weakQueue.lock()) {
+                ScheduleArrival(queue, std::move(board), delay);
+            }
+        };
+
+    std::unique_lock<std::mutex> lock(m_arrivalQueue->mutex);
+    while (m_arrivalQueue->running) {
+        if (m_arrivalQueue->arrivals.empty()) {
+            m_arrivalQueue->cv.wait(lock);
+            continue;
+        }
+
+        auto it = m_arrivalQueue->arrivals.begin();
+        // Copy the due time: the entry may be erased while waiting.
+        const Clock::time_point due = it->first;
+        if (Clock::now() < due) {
+            m_arrivalQueue->cv.wait_until(lock, due);
+            continue;
+        }
+
+        std::shared_ptr<SimulatedBoard> board = std::move(it->second);
+        m_arrivalQueue->arrivals.erase(it);
+        lock.unlock();
+
+        if (IsValidPort(board->m_usbPath)) {
+            auto device = std::make_unique<SimulatedUSBDevice>(board, m_script, m_config, resetCallback);
+            if (IsSupportedDevice(device->GetVendorId(), device->GetProductId())) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Simulated device arrived: " << board->m_usbPath << " VID:0x"
+                    << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << device->GetVendorId()
+                    << " PID:0x" << std::setw(4) << std::setfill('0') << device->GetProductId() << std::dec << endLog;
+                // Called from this thread only, so arrivals are handled one at a time as with libusb.
+                m_deviceAddedCallback(std::move(device));
+            } else {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring simulated device with unsupported VID/PID: "
+                    << board->m_usbPath << endLog;
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+bool SimulatedUSBTransport::IsValidPort(const std::string &usbPath) const
+{
+    if (m_filterPorts.empty()) {
+        return true;
+    }
+
+    return IsPortInFilter(usbPath, m_filterPorts);
+}
+
+bool SimulatedUSBTransport::IsSupportedDevice(uint16_t vendorId, uint16_t productId) const
+{
+    return std::find(m_supportedDevices.begin(), m_supportedDevices.end(),
+        USBVendorProductId{vendorId, productId}) != m_supportedDevices.end();
+}
+
+std::shared_ptr<SimulatedDeviceScript> SimulatedUSBTransport::BuildScript(const AstraBootImage &bootImage,
+    std::shared_ptr<FlashImage> flashImage, AstraDeviceSeries series, const std::string &bootCommand)
+{
+    auto script = std::make_shared<SimulatedDeviceScript>();
+    script->m_series = series;
+    script->m_vendorId = bootImage.GetVendorId();
+    script->m_productId = bootImage.GetProductId();
+    script->m_sysMgrVendorId = bootImage.GetSysMgrVendorId();
+    script->m_sysMgrProductId = bootImage.GetSysMgrProductId();
+    script->m_fastbootVendorId = bootImage.GetFastbootVendorId();
+    script->m_fastbootProductId = bootImage.GetFastbootProductId();
+    script->m_bootOnly = flashImage == nullptr;
+    script->m_usbConsole = series != ASTRA_SERIES_SL26XX && !bootImage.GetUEnvSupport() &&
+        bootImage.GetUbootConsole() == ASTRA_UBOOT_CONSOLE_USB;
+
+    // The final boot image is chosen as AstraDeviceImpl::BuildBootImageList() does.
+    std::vector<std::string> bootImageNames;
+    for (const auto &image : bootImage.GetImages()) {
+        bootImageNames.push_back(image.GetName());
+    }
+    std::sort(bootImageNames.begin(), bootImageNames.end());
+
+    const bool uEnvMissing = bootImage.GetUEnvSupport() &&
+        std::find(bootImageNames.begin(), bootImageNames.end(), kUEnvFilename) == bootImageNames.end();
+    std::string finalBootImage = bootImage.GetFinalBootImage();
+    if ((uEnvMissing && bootCommand.empty()) || (!script->m_bootOnly && bootImage.IsLinuxBoot())) {
+        finalBootImage = kUEnvFilename;
+    }
+    if (uEnvMissing) {
+        bootImageNames.push_back(kUEnvFilename);
+    }
+
+    if (series == ASTRA_SERIES_SL26XX) {
+        // U-Boot fastboot only stages uEnv.txt: the rest is uploaded by packet.
+        if (!finalBootImage.empty()) {
+            script->m_bootImages.push_back(finalBootImage);
+        }
+    } else {
+        for (const auto &name : bootImageNames) {
+            if (finalBootImage.empty() || name.find(finalBootImage) == std::string::npos) {
+                script->m_bootImages.push_back(name);
+            }
+        }
+        if (!finalBootImage.empty()) {
+            script->m_bootImages.push_back(finalBootImage);
+        }
+    }
+
+    if (flashImage == nullptr) {
+        // Boot-only SL16XX completes on the size request.
+        if (series != ASTRA_SERIES_SL26XX) {
+            script->m_updateImages.push_back(kSizeRequestImageFilename);
+        }
+        return script;
+    }
+
+    // Update images in the order the manifest expects them, final image last.
+    const std::vector<Image> &images = flashImage->GetImages();
+    const std::string &finalImage = flashImage->GetFinalImage();
+    std::vector<bool> used(images.size(), false);
+    const Image *last = nullptr;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!finalImage.empty() && images[i].GetName().find(finalImage) != std::string::npos) {
+            used[i] = true;
+            last = &images[i];
+            break;
+        }
+    }
+    for (const auto &entry : flashImage->GetImageOrder()) {
+        for (size_t i = 0; i < images.size(); ++i) {
+            if (!used[i] && images[i].GetName().find(entry) != std::string::npos) {
+                used[i] = true;
+                script->m_updateImages.push_back(images[i].GetName());
+                break;
+            }
+        }
+    }
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!used[i]) {
+            script->m_updateImages.push_back(images[i].GetName());
+        }
+    }
+    if (last != nullptr) {
+        script->m_updateImages.push_back(last->GetName());
+
+        if (series != ASTRA_SERIES_SL26XX && (last->GetImageType() == ASTRA_IMAGE_TYPE_UPDATE_EMMC ||
+            last->GetImageType() == ASTRA_IMAGE_TYPE_UPDATE_SPI))
+        {
+            script->m_updateImages.push_back(kSizeRequestImageFilename);
+        }
+    }
+
+    return script;
+}
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "astra_boot_image.hpp"
+#include "astra_device_manager.hpp"
+#include "simulated_usb_device.hpp"
+#include "usb_transport.hpp"
+
+/**
+ * USBTransport serving simulated boards (see SimulatedUSBDevice) instead of
+ * the USB bus.  Boards sit on simulated hubs at USB paths "100-<hub>.<port>",
+ * so per-hub scheduling sees them as it would real hubs, and each arrival is
+ * handed to the device-added callback like a hotplugged device.
+ */
+class SimulatedUSBTransport : public USBTransport {
+public:
+    SimulatedUSBTransport(bool usbDebug, const AstraSimulatorConfig &config,
+        std::shared_ptr<const SimulatedDeviceScript> script);
+    ~SimulatedUSBTransport() override;
+
+    int Init(std::vector<USBVendorProductId> vendorProductIds, const std::string filterPorts,
+        std::function<void(std::unique_ptr<USBDevice>)> deviceAddedCallback) override;
+    void Shutdown() override;
+
+    /**
+     * Describe what a simulated board asks for when booted with bootImage
+     * and, unless flashImage is nullptr (boot only), updated with flashImage.
+     */
+    static std::shared_ptr<SimulatedDeviceScript> BuildScript(const AstraBootImage &bootImage,
+        std::shared_ptr<FlashImage> flashImage, AstraDeviceSeries series, const std::string &bootCommand);
+
+private:
+    using Clock = SimulatedLink::Clock;
+
+    // Boards due to enumerate.  Shared with the devices' reset callbacks,
+    // which may outlive the transport.
+    struct ArrivalQueue {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::multimap<Clock::time_point, std::shared_ptr<SimulatedBoard>> arrivals;
+        bool running = true;
+    };
+
+    AstraSimulatorConfig m_config;
+    std::shared_ptr<const SimulatedDeviceScript> m_script;
+    std::shared_ptr<ArrivalQueue> m_arrivalQueue = std::make_shared<ArrivalQueue>();
+    std::vector<std::shared_ptr<SimulatedBoard>> m_boards;
+
+    void DeviceMonitorThread();
+    bool IsValidPort(const std::string &usbPath) const;
+    bool IsSupportedDevice(uint16_t vendorId, uint16_t productId) const;
+    static void ScheduleArrival(const std::shared_ptr<ArrivalQueue> &queue, std::shared_ptr<SimulatedBoard> board,
+        std::chrono::milliseconds delay);
+};
@@ -0,0 +1,341 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "sparse_image.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#include "astra_log.hpp"
+
+namespace {
+
+uint16_t ReadU16LE(const uint8_t *ptr)
+{
+    return static_cast<uint16_t>(ptr[0] | (ptr[1] << 8));
+}
+
+uint32_t ReadU32LE(const uint8_t *ptr)
+{
+    return static_cast<uint32_t>(ptr[0]) |
+        (static_cast<uint32_t>(ptr[1]) << 8) |
+        (static_cast<uint32_t>(ptr[2]) << 16) |
+        (static_cast<uint32_t>(ptr[3]) << 24);
+}
+
+void AppendU16LE(std::vector<uint8_t> &out, uint16_t value)
+{
+    out.push_back(static_cast<uint8_t>(value & 0xFF));
+    out.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+}
+
+void AppendU32LE(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value & 0xFF));
+    out.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+    out.push_back(static_cast<uint8_t>((value >> 16) & 0xFF));
+    out.push_back(static_cast<uint8_t>((value >> 24) & 0xFF));
+}
+
+} // namespace
+
+bool SparseImage::IsSparse(const std::string &path, uint64_t offset)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::array<uint8_t, 4> magic = {};
+    if (!file.seekg(static_cast<std::streamoff>(offset)) || !file.read(reinterpret_cast<char *>(magic.data()), magic.size())) {
+        return false;
+    }
+
+    return ReadU32LE(magic.data()) == kSparseMagic;
+}
+
+int SparseImage::Parse(const std::string &path, uint64_t base, uint64_t length)
+{
+    ASTRA_LOG;
+
+    m_path = path;
+    m_chunks.clear();
+
+    std::error_code ec;
+    m_fileSize = length;
+    if (length == 0) {
+        m_fileSize = std::filesystem::file_size(path, ec);
+    }
+    if (ec) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Cannot stat sparse image: " << path << endLog;
+        return -1;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::array<uint8_t, kFileHeaderSize> header = {};
+    if (!file.seekg(static_cast<std::streamoff>(base)) || !file.read(reinterpret_cast<char *>(header.data()), header.size())) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to read sparse header: " << path << endLog;
+        return -1;
+    }
+
+    const uint32_t magic = ReadU32LE(&header[0]);
+    const uint16_t majorVersion = ReadU16LE(&header[4]);
+    const uint16_t fileHeaderSize = ReadU16LE(&header[8]);
+    const uint16_t chunkHeaderSize = ReadU16LE(&header[10]);
+    m_blockSize = ReadU32LE(&header[12]);
+    m_totalBlocks = ReadU32LE(&header[16]);
+    const uint32_t totalChunks = ReadU32LE(&header[20]);
+
+    if (magic != kSparseMagic || majorVersion != 1 || fileHeaderSize < kFileHeaderSize
+        || chunkHeaderSize < kChunkHeaderSize || m_blockSize == 0 || (m_blockSize % 4) != 0)
+    {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Invalid sparse header: " << path << endLog;
+        return -1;
+    }
+
+    uint64_t offset = fileHeaderSize;
+    uint32_t block = 0;
+    for (uint32_t i = 0; i < totalChunks; ++i) {
+        std::array<uint8_t, kChunkHeaderSize + 4> chunkHeader = {};
+        file.seekg(static_cast<std::streamoff>(base + offset));
+        if (!file.read(reinterpret_cast<char *>(chunkHeader.data()), kChunkHeaderSize)) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Truncated sparse chunk " << i << ": " << path << endLog;
+            return -1;
+        }
+
+        const uint16_t type = ReadU16LE(&chunkHeader[0]);
+        const uint32_t blocks = ReadU32LE(&chunkHeader[4]);
+        const uint32_t totalSize = ReadU32LE(&chunkHeader[8]);
+        const uint64_t dataOffset = base + offset + chunkHeaderSize;
+        const uint64_t dataSize = (totalSize >= chunkHeaderSize) ? totalSize - chunkHeaderSize : UINT64_MAX;
+
+        Chunk chunk{static_cast<ChunkType>(type), block, blocks, dataOffset, 0};
+        bool valid = false;
+        switch (type) {
+        case CHUNK_TYPE_RAW:
+            valid = (dataSize == static_cast<uint64_t>(blocks) * m_blockSize);
+            break;
+        case CHUNK_TYPE_FILL:
+            valid = (dataSize == 4);
+            if (valid) {
+                file.seekg(static_cast<std::streamoff>(dataOffset));
+                valid = static_cast<bool>(file.read(reinterpret_cast<char *>(&chunkHeader[kChunkHeaderSize]), 4));
+                chunk.fillValue = ReadU32LE(&chunkHeader[kChunkHeaderSize]);
+            }
+            break;
+        case CHUNK_TYPE_DONT_CARE:
+            valid = (dataSize == 0);
+            break;
+        case CHUNK_TYPE_CRC32:
+            valid = (dataSize == 4 && blocks == 0);
+            break;
+        default:
+            break;
+        }
+
+        if (!valid || offset + totalSize > m_fileSize) {
+            log(ASTRA_LOG_LEVEL_ERROR) << "Invalid sparse chunk " << i << " (type 0x" << std::hex << type
+                << std::dec << "): " << path << endLog;
+            return -1;
+        }
+
+        // CRC32 chunks cover the whole image and become invalid once split.
+        if (type != CHUNK_TYPE_CRC32) {
+            m_chunks.push_back(chunk);
+        }
+
+        block += blocks;
+        offset += totalSize;
+    }
+
+    if (block != m_totalBlocks) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Sparse chunks cover " << block << " of " << m_totalBlocks
+            << " blocks: " << path << endLog;
+        return -1;
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Sparse image " << path << ": " << m_chunks.size() << " chunks, "
+        << m_fileSize << " bytes on the wire, " << GetExpandedSize() << " bytes expanded" << endLog;
+
+    return 0;
+}
+
+int SparseImage::FromRaw(const std::string &path, uint64_t size, uint32_t blockSize,
+    const std::vector<BlockScanner::Run> &uniformRuns, uint64_t offset)
+{
+    ASTRA_LOG;
+
+    m_path = path;
+    m_chunks.clear();
+
+    if (size == 0 || blockSize == 0 || (blockSize % 4) != 0 || (size % blockSize) != 0 ||
+        size / blockSize > std::numeric_limits<uint32_t>::max())
+    {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Raw image " << path << " of " << size << " bytes is not a whole number of "
+            << blockSize << " byte blocks" << endLog;
+        return -1;
+    }
+    m_blockSize = blockSize;
+    m_totalBlocks = static_cast<uint32_t>(size / blockSize);
+    m_fileSize = kFileHeaderSize;
+
+    auto addRaw = [this, offset](uint32_t startBlock, uint32_t endBlock) {
+        if (endBlock > startBlock) {
+            const uint32_t blocks = endBlock - startBlock;
+            m_chunks.push_back({CHUNK_TYPE_RAW, startBlock, blocks, offset + static_cast<uint64_t>(startBlock) * m_blockSize, 0});
+            m_fileSize += kChunkHeaderSize + static_cast<uint64_t>(blocks) * m_blockSize;
+        }
+    };
+
+    uint32_t block = 0;
+    for (const auto &run : uniformRuns) {
+        if (run.m_firstBlock < block || run.m_firstBlock + run.m_blocks > m_totalBlocks || run.m_blocks == 0) {
+            continue;
+        }
+        addRaw(block, static_cast<uint32_t>(run.m_firstBlock));
+        m_chunks.push_back({CHUNK_TYPE_FILL, static_cast<uint32_t>(run.m_firstBlock),
+            static_cast<uint32_t>(run.m_blocks), 0, run.m_fillValue});
+        m_fileSize += kChunkHeaderSize + 4;
+        block = static_cast<uint32_t>(run.m_firstBlock + run.m_blocks);
+    }
+    addRaw(block, m_totalBlocks);
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Raw image " << path << " as sparse: " << m_chunks.size() << " chunks, "
+        << m_fileSize << " bytes on the wire, " << GetExpandedSize() << " bytes expanded" << endLog;
+
+    return 0;
+}
+
+std::vector<SparseImage::Segment> SparseImage::Split(size_t maxSize) const
+{
+    ASTRA_LOG;
+
+    std::vector<Segment> segments;
+
+    // Every segment carries a file header plus a leading and trailing DONT_CARE
+    // chunk, and must fit at least one RAW block.
+    const size_t overhead = kFileHeaderSize + 2 * kChunkHeaderSize;
+    if (maxSize > 0 && maxSize < overhead + kChunkHeaderSize + m_blockSize) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "max-download-size " << maxSize << " too small for sparse block size "
+            << m_blockSize << endLog;
+        return segments;
+    }
+    const size_t budget = (maxSize > 0) ? maxSize - overhead : std::numeric_limits<size_t>::max();
+
+    std::vector<Piece> body;
+    size_t bodySize = 0;
+    uint32_t bodyChunks = 0;
+    uint32_t startBlock = 0;
+    uint32_t endBlock = 0;
+
+    auto closeSegment = [&]() {
+        if (bodyChunks == 0) {
+            return;
+        }
+
+        const bool leadingSkip = startBlock > 0;
+        const bool trailingSkip = endBlock < m_totalBlocks;
+
+        Segment segment;
+        Piece headerPiece;
+        AppendFileHeader(headerPiece.bytes, m_blockSize, m_totalBlocks,
+            bodyChunks + (leadingSkip ? 1 : 0) + (trailingSkip ? 1 : 0));
+        if (leadingSkip) {
+            AppendChunkHeader(headerPiece.bytes, CHUNK_TYPE_DONT_CARE, startBlock, kChunkHeaderSize);
+        }
+        segment.size = headerPiece.bytes.size() + bodySize;
+        segment.pieces.push_back(std::move(headerPiece));
+        for (auto &piece : body) {
+            segment.pieces.push_back(std::move(piece));
+        }
+        if (trailingSkip) {
+            Piece trailer;
+            AppendChunkHeader(trailer.bytes, CHUNK_TYPE_DONT_CARE, m_totalBlocks - endBlock, kChunkHeaderSize);
+            segment.size += trailer.bytes.size();
+            segment.pieces.push_back(std::move(trailer));
+        }
+        segments.push_back(std::move(segment));
+
+        body.clear();
+        bodySize = 0;
+        bodyChunks = 0;
+    };
+
+    auto addChunk = [&](uint32_t chunkStart, uint32_t blocks, Piece &&headerPiece, Piece &&dataPiece) {
+        if (bodyChunks == 0) {
+            startBlock = chunkStart;
+        }
+        bodySize += headerPiece.bytes.size() + dataPiece.bytes.size() + dataPiece.fileLength;
+        body.push_back(std::move(headerPiece));
+        if (!dataPiece.bytes.empty() || dataPiece.fileLength > 0) {
+            body.push_back(std::move(dataPiece));
+        }
+        ++bodyChunks;
+        endBlock = chunkStart + blocks;
+    };
+
+    for (const auto &chunk : m_chunks) {
+        if (chunk.type == CHUNK_TYPE_RAW) {
+            uint32_t done = 0;
+            while (done < chunk.blocks) {
+                if (budget - bodySize < kChunkHeaderSize + m_blockSize) {
+                    closeSegment();
+                }
+
+                const uint32_t fit = static_cast<uint32_t>((budget - bodySize - kChunkHeaderSize) / m_blockSize);
+                const uint32_t blocks = std::min(chunk.blocks - done, fit);
+                const size_t dataSize = static_cast<size_t>(blocks) * m_blockSize;
+
+                Piece headerPiece;
+                AppendChunkHeader(headerPiece.bytes, CHUNK_TYPE_RAW, blocks,
+                    static_cast<uint32_t>(kChunkHeaderSize + dataSize));
+                Piece dataPiece;
+                dataPiece.fileOffset = chunk.dataOffset + static_cast<uint64_t>(done) * m_blockSize;
+                dataPiece.fileLength = dataSize;
+                addChunk(chunk.startBlock + done, blocks, std::move(headerPiece), std::move(dataPiece));
+
+                done += blocks;
+            }
+            continue;
+        }
+
+        const size_t wireSize = kChunkHeaderSize + ((chunk.type == CHUNK_TYPE_FILL) ? 4 : 0);
+        if (budget - bodySize < wireSize) {
+            closeSegment();
+        }
+
+        Piece headerPiece;
+        AppendChunkHeader(headerPiece.bytes, chunk.type, chunk.blocks, static_cast<uint32_t>(wireSize));
+        if (chunk.type == CHUNK_TYPE_FILL) {
+            AppendU32LE(headerPiece.bytes, chunk.fillValue);
+        }
+        addChunk(chunk.startBlock, chunk.blocks, std::move(headerPiece), Piece{});
+    }
+    closeSegment();
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Split sparse image " << m_path << " into " << segments.size()
+        << " segments of at most " << maxSize << " bytes" << endLog;
+
+    return segments;
+}
+
+void SparseImage::AppendFileHeader(std::vector<uint8_t> &out, uint32_t blockSize, uint32_t totalBlocks,
+    uint32_t totalChunks)
+{
+    AppendU32LE(out, kSparseMagic);
+    AppendU16LE(out, 1);    // major version
+    AppendU16LE(out, 0);    // minor version
+    AppendU16LE(out, static_cast<uint16_t>(kFileHeaderSize));
+    AppendU16LE(out, static_cast<uint16_t>(kChunkHeaderSize));
+    AppendU32LE(out, blockSize);
+    AppendU32LE(out, totalBlocks);
+    AppendU32LE(out, totalChunks);
+    AppendU32LE(out, 0);    // image checksum (unused)
+}
+
+void SparseImage::AppendChunkHeader(std::vector<uint8_t> &out, uint16_t type, uint32_t blocks, uint32_t totalSize)
+{
+    AppendU16LE(out, type);
+    AppendU16LE(out, 0);
+    AppendU32LE(out, blocks);
+    AppendU32LE(out, totalSize);
+}
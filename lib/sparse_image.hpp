@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "block_scanner.hpp"
+
+/**
+ * Reader for Android sparse images (.simg).  A sparse image only carries the
+ * RAW chunks of a partition; FILL and DONT_CARE chunks describe the rest, so
+ * staging the file as-is already keeps empty space off the wire.
+ *
+ * When the image is larger than the device's max-download-size, Split()
+ * re-sparses it into segments that each fit the limit.  Every segment is a
+ * valid sparse image covering the full partition: blocks outside the
+ * segment are expressed as DONT_CARE.
+ *
+ * FromRaw() describes a raw image the same way, so its uniform blocks go
+ * out as FILL chunks and only the rest is read from the file.
+ */
+class SparseImage {
+public:
+    static constexpr uint32_t kSparseMagic = 0xED26FF3A;
+
+    /** One contiguous piece of a segment: generated header bytes or file data. */
+    struct Piece {
+        std::vector<uint8_t> bytes;     // used when fileLength == 0
+        uint64_t fileOffset = 0;
+        size_t fileLength = 0;
+    };
+
+    struct Segment {
+        std::vector<Piece> pieces;
+        size_t size = 0;
+    };
+
+    /**
+     * @return true if the file at path starts with the sparse magic at
+     *         offset, where an image inside a bundle starts.
+     */
+    static bool IsSparse(const std::string &path, uint64_t offset = 0);
+
+    /**
+     * Parse the sparse header and chunk table, of the whole file or of the
+     * length bytes at offset.  Pieces then address the file itself.
+     * @return 0 on success, -1 if the file is not a valid sparse image.
+     */
+    int Parse(const std::string &path, uint64_t offset = 0, uint64_t length = 0);
+
+    /**
+     * Describe the raw image at offset of path, size bytes long, as a sparse
+     * image with blockSize blocks: uniformRuns become FILL chunks, the
+     * blocks between them RAW chunks of the file.
+     * @return 0 on success, -1 if size is not a whole number of blocks.
+     */
+    int FromRaw(const std::string &path, uint64_t size, uint32_t blockSize,
+        const std::vector<BlockScanner::Run> &uniformRuns, uint64_t offset = 0);
+
+    /** Split into segments of at most maxSize bytes each; 0 keeps one segment. */
+    std::vector<Segment> Split(size_t maxSize) const;
+
+    /** Bytes of the image in sparse form, as staged unsplit. */
+    uint64_t GetFileSize() const { return m_fileSize; }
+    uint64_t GetExpandedSize() const { return static_cast<uint64_t>(m_blockSize) * m_totalBlocks; }
+    const std::string &GetPath() const { return m_path; }
+
+private:
+    enum ChunkType : uint16_t {
+        CHUNK_TYPE_RAW = 0xCAC1,
+        CHUNK_TYPE_FILL = 0xCAC2,
+        CHUNK_TYPE_DONT_CARE = 0xCAC3,
+        CHUNK_TYPE_CRC32 = 0xCAC4,
+    };
+
+    struct Chunk {
+        ChunkType type;
+        uint32_t startBlock;
+        uint32_t blocks;
+        uint64_t dataOffset;   // file offset of RAW data
+        uint32_t fillValue;    // FILL pattern
+    };
+
+    static constexpr size_t kFileHeaderSize = 28;
+    static constexpr size_t kChunkHeaderSize = 12;
+
+    static void AppendFileHeader(std::vector<uint8_t> &out, uint32_t blockSize, uint32_t totalBlocks,
+        uint32_t totalChunks);
+    static void AppendChunkHeader(std::vector<uint8_t> &out, uint16_t type, uint32_t blocks, uint32_t totalSize);
+
+    std::string m_path;
+    uint64_t m_fileSize = 0;
+    uint32_t m_blockSize = 0;
+    uint32_t m_totalBlocks = 0;
+    std::vector<Chunk> m_chunks;
+};
@@ -51,6 +51,18 @@ void SpiFlashImage::ParseSpiFlashConfig(const std::map<std::string, std::string>
     m_spiImageConfigs.push_back(spiConfig);
 }
 
+std::string SpiFlashImage::EraseTailCommand(const std::string &writeAddress, const std::string &writeLength,
+    const std::string &eraseStartAddress, const std::string &eraseLength)
+{
+    // setexpr does one operation at a time: round the image end up to a
+    // sector, then take the length left to the end of the erase range.
+    const std::string sectorSize = kSpiEraseSectorSize;
+    return "setexpr sf_tail " + writeAddress + " + " + writeLength + "; setexpr sf_tail ${sf_tail} + "
+        + kSpiEraseSectorMask + "; setexpr sf_tail ${sf_tail} / " + sectorSize + "; setexpr sf_tail ${sf_tail} * " + sectorSize
+        + "; setexpr sf_tail_len " + eraseStartAddress + " + " + eraseLength
+        + "; setexpr sf_tail_len ${sf_tail_len} - ${sf_tail}; if itest ${sf_tail_len} -gt 0; then sf erase ${sf_tail} ${sf_tail_len}; fi; ";
+}
+
 int SpiFlashImage::Load()
 {
     ASTRA_LOG;
@@ -109,6 +121,19 @@ int SpiFlashImage::Load()
     if (m_chipName.compare(0, 5, "sl261") == 0) {
         log(ASTRA_LOG_LEVEL_DEBUG) << "Using SL2610 SPI flash command sequence" << endLog;
         for (const auto &imageConfig : m_spiImageConfigs) {
+            if (m_deltaUpdate) {
+                // sf update reads back each sector and only erases and
+                // writes those which differ from the image.  The rest of
+                // each erase range is erased as a full update would.
+                m_flashCommand += "usbload "  + imageConfig.imageFile + " " + imageConfig.readAddress + "; sf probe; sf update "
+                    + imageConfig.readAddress + " " + imageConfig.writeFirstCopyAddress + " " + imageConfig.writeLength + "; "
+                    + EraseTailCommand(imageConfig.writeFirstCopyAddress, imageConfig.writeLength,
+                        imageConfig.eraseFirstStartAddress, imageConfig.eraseFirstLength)
+                    + "sf update " + imageConfig.readAddress + " " + imageConfig.writeSecondCopyAddress + " " + imageConfig.writeLength + "; "
+                    + EraseTailCommand(imageConfig.writeSecondCopyAddress, imageConfig.writeLength,
+                        imageConfig.eraseSecondStartAddress, imageConfig.eraseSecondLength);
+                continue;
+            }
              m_flashCommand += "usbload "  + imageConfig.imageFile + " " + imageConfig.readAddress + "; sf probe; sf erase " + imageConfig.eraseFirstStartAddress + " " + imageConfig.eraseFirstLength
                 + "; sf write " + imageConfig.readAddress + " " + imageConfig.writeFirstCopyAddress + " " + imageConfig.writeLength + "; sf erase " + imageConfig.eraseSecondStartAddress
                 + " " + imageConfig.eraseSecondLength + "; sf write " + imageConfig.readAddress + " " + imageConfig.writeSecondCopyAddress + " " + imageConfig.writeLength + "; ";
@@ -132,5 +157,8 @@ int SpiFlashImage::Load()
         m_flashCommand += m_resetCommand;
     }
 
+    // Digests for delta and verified updates come from the image index.
+    StartPreprocessing();
+
     return ret;
 }
\ No newline at end of file
@@ -18,6 +18,12 @@ public:
 
     int Load() override;
 
+    /** Only the SL2610 series flash commands (sf) can compare sectors for a delta update. */
+    static bool SupportsDeltaUpdate(const std::string &chipName)
+    {
+        return chipName.compare(0, 5, "sl261") == 0;
+    }
+
 private:
     struct SpiImageConfig {
         SpiImageConfig(const std::string chipName)
@@ -47,4 +53,16 @@ private:
     std::vector<SpiImageConfig> m_spiImageConfigs;
 
     void ParseSpiFlashConfig(const std::map<std::string, std::string> &config, std::string imageFile);
+
+    // Smallest erase sector of the SPI NOR parts sf drives, and its mask,
+    // in hex as setexpr reads them.
+    static constexpr const char *kSpiEraseSectorSize = "0x1000";
+    static constexpr const char *kSpiEraseSectorMask = "0xfff";
+
+    /**
+     * sf commands erasing what follows the image in an erase range, from the
+     * first sector past writeLength bytes at writeAddress to the range end.
+     */
+    static std::string EraseTailCommand(const std::string &writeAddress, const std::string &writeLength,
+        const std::string &eraseStartAddress, const std::string &eraseLength);
 };
\ No newline at end of file
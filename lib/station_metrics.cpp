@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "station_metrics.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+const std::vector<double> kBootBounds{0.5, 1, 2, 5, 10, 20, 30, 60, 120};
+const std::vector<double> kUpdateBounds{10, 30, 60, 120, 300, 600, 1200, 1800, 3600};
+const std::vector<double> kImageBounds{0.1, 0.5, 1, 2, 5, 10, 30, 60, 120, 300, 600};
+const std::vector<double> kRebindBounds{0.1, 0.25, 0.5, 1, 2, 5, 10};
+
+double SecondsSince(StationMetrics::Clock::time_point start, StationMetrics::Clock::time_point now)
+{
+    return std::chrono::duration<double>(now - start).count();
+}
+
+} // namespace
+
+void StationMetrics::Histogram::Observe(double value)
+{
+    for (size_t i = 0; i < m_bounds.size(); ++i) {
+        if (value <= m_bounds[i]) {
+            ++m_counts[i];
+        }
+    }
+    ++m_count;
+    m_sum += value;
+}
+
+StationMetrics::StationMetrics() : m_start{Clock::now()}, m_bootSeconds{kBootBounds},
+    m_updateSeconds{kUpdateBounds}, m_rebindSeconds{kRebindBounds}
+{}
+
+void StationMetrics::Observe(const AstraDeviceManagerResponse &response, bool bootOnly)
+{
+    if (response.IsDeviceStatsResponse()) {
+        const DeviceTransferStats &stats = response.GetDeviceStatsResponse();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bytesSent += stats.m_bytesSent;
+        for (const auto &image : stats.m_images) {
+            if (image.m_skipped) {
+                ++m_imagesSkipped;
+                continue;
+            }
+            m_imageSeconds.try_emplace(image.m_imageName, kImageBounds).first->second.Observe(image.m_seconds);
+        }
+        for (double seconds : stats.m_rebindDurations) {
+            m_rebindSeconds.Observe(seconds);
+        }
+        return;
+    }
+
+    if (!response.IsDeviceResponse()) {
+        return;
+    }
+
+    const DeviceResponse &device = response.GetDeviceResponse();
+    if (device.m_status == ASTRA_DEVICE_STATUS_BOOT_PROGRESS || device.m_status == ASTRA_DEVICE_STATUS_UPDATE_PROGRESS ||
+        device.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS)
+    {
+        return;
+    }
+
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_statusCounts[device.m_status];
+
+    switch (device.m_status) {
+    case ASTRA_DEVICE_STATUS_BOOT_START:
+        m_bootStarts[device.m_deviceName] = now;
+        break;
+    case ASTRA_DEVICE_STATUS_BOOT_COMPLETE:
+    case ASTRA_DEVICE_STATUS_BOOT_FAIL:
+        if (auto it = m_bootStarts.find(device.m_deviceName); it != m_bootStarts.end()) {
+            if (device.m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE) {
+                m_bootSeconds.Observe(SecondsSince(it->second, now));
+            }
+            m_bootStarts.erase(it);
+        }
+        if (bootOnly && device.m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE) {
+            RecordDeviceDone(now);
+        }
+        break;
+    case ASTRA_DEVICE_STATUS_UPDATE_START:
+        m_updateStarts[device.m_deviceName] = now;
+        break;
+    case ASTRA_DEVICE_STATUS_UPDATE_COMPLETE:
+    case ASTRA_DEVICE_STATUS_UPDATE_FAIL:
+        if (auto it = m_updateStarts.find(device.m_deviceName); it != m_updateStarts.end()) {
+            if (device.m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE) {
+                m_updateSeconds.Observe(SecondsSince(it->second, now));
+            }
+            m_updateStarts.erase(it);
+        }
+        if (device.m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE) {
+            RecordDeviceDone(now);
+        }
+        break;
+    case ASTRA_DEVICE_STATUS_CLOSED:
+        m_bootStarts.erase(device.m_deviceName);
+        m_updateStarts.erase(device.m_deviceName);
+        break;
+    default:
+        break;
+    }
+}
+
+void StationMetrics::RecordDeviceDone(Clock::time_point now)
+{
+    ++m_devicesDone;
+    m_recentDone.push_back(now);
+    while (!m_recentDone.empty() && now - m_recentDone.front() > kRateWindow) {
+        m_recentDone.pop_front();
+    }
+}
+
+std::string StationMetrics::EscapeLabel(const std::string &value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void StationMetrics::RenderHistogram(std::ostringstream &out, const std::string &name, const std::string &labels,
+    const Histogram &histogram)
+{
+    const std::string separator = labels.empty() ? "" : ",";
+    for (size_t i = 0; i < histogram.m_bounds.size(); ++i) {
+        out << name << "_bucket{" << labels << separator << "le=\"" << histogram.m_bounds[i] << "\"} "
+            << histogram.m_counts[i] << "\n";
+    }
+    out << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << histogram.m_count << "\n";
+    const std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    out << name << "_sum" << braces << " " << histogram.m_sum << "\n";
+    out << name << "_count" << braces << " " << histogram.m_count << "\n";
+}
+
+std::string StationMetrics::Render(const std::vector<BusTransferStats> &busStats) const
+{
+    const Clock::time_point now = Clock::now();
+    const double uptime = SecondsSince(m_start, now);
+
+    std::ostringstream out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    out << "# HELP astra_uptime_seconds Time since the device manager started.\n"
+        << "# TYPE astra_uptime_seconds gauge\n"
+        << "astra_uptime_seconds " << uptime << "\n";
+
+    // Over the last hour, or extrapolated from a shorter uptime of at least
+    // a minute so the first device does not read as thousands per hour.
+    const uint64_t recentDone = std::count_if(m_recentDone.begin(), m_recentDone.end(),
+        [now](Clock::time_point done) { return now - done <= kRateWindow; });
+    const double windowHours = std::clamp(uptime, 60.0, std::chrono::duration<double>(kRateWindow).count()) / 3600.0;
+    out << "# HELP astra_devices_done_total Devices which finished their update, or their boot for boot jobs.\n"
+        << "# TYPE astra_devices_done_total counter\n"
+        << "astra_devices_done_total " << m_devicesDone << "\n"
+        << "# HELP astra_devices_per_hour Devices done per hour over the last hour.\n"
+        << "# TYPE astra_devices_per_hour gauge\n"
+        << "astra_devices_per_hour " << static_cast<double>(recentDone) / windowHours << "\n";
+
+    out << "# HELP astra_device_status_total Device status changes, by status.\n"
+        << "# TYPE astra_device_status_total counter\n";
+    for (const auto &[status, count] : m_statusCounts) {
+        out << "astra_device_status_total{status=\"" << AstraDevice::AstraDeviceStatusToString(status) << "\"} "
+            << count << "\n";
+    }
+
+    out << "# HELP astra_devices_in_phase Devices currently booting or updating.\n"
+        << "# TYPE astra_devices_in_phase gauge\n"
+        << "astra_devices_in_phase{phase=\"boot\"} " << m_bootStarts.size() << "\n"
+        << "astra_devices_in_phase{phase=\"update\"} " << m_updateStarts.size() << "\n";
+
+    out << "# HELP astra_boot_seconds Boot start until boot complete, per device.\n"
+        << "# TYPE astra_boot_seconds histogram\n";
+    RenderHistogram(out, "astra_boot_seconds", "", m_bootSeconds);
+    out << "# HELP astra_update_seconds Update start until update complete, per device.\n"
+        << "# TYPE astra_update_seconds histogram\n";
+    RenderHistogram(out, "astra_update_seconds", "", m_updateSeconds);
+    out << "# HELP astra_rebind_seconds SL26XX fastboot exit until the device was rebound.\n"
+        << "# TYPE astra_rebind_seconds histogram\n";
+    RenderHistogram(out, "astra_rebind_seconds", "", m_rebindSeconds);
+    out << "# HELP astra_image_seconds Image request until its send completed, by image.\n"
+        << "# TYPE astra_image_seconds histogram\n";
+    for (const auto &[image, histogram] : m_imageSeconds) {
+        RenderHistogram(out, "astra_image_seconds", "image=\"" + EscapeLabel(image) + "\"", histogram);
+    }
+
+    out << "# HELP astra_image_bytes_total Image bytes sent by devices which finished.\n"
+        << "# TYPE astra_image_bytes_total counter\n"
+        << "astra_image_bytes_total " << m_bytesSent << "\n"
+        << "# HELP astra_images_skipped_total Images not sent because the device already held them.\n"
+        << "# TYPE astra_images_skipped_total counter\n"
+        << "astra_images_skipped_total " << m_imagesSkipped << "\n";
+
+    out << "# HELP astra_bus_bytes_total Update bytes sent through a USB hub or root port.\n"
+        << "# TYPE astra_bus_bytes_total counter\n";
+    for (const auto &bus : busStats) {
+        out << "astra_bus_bytes_total{hub=\"" << EscapeLabel(bus.m_hub) << "\"} " << bus.m_bytes << "\n";
+    }
+    out << "# HELP astra_bus_busy_seconds_total Time at least one device behind a hub was updating.\n"
+        << "# TYPE astra_bus_busy_seconds_total counter\n";
+    for (const auto &bus : busStats) {
+        out << "astra_bus_busy_seconds_total{hub=\"" << EscapeLabel(bus.m_hub) << "\"} " << bus.m_busySeconds << "\n";
+    }
+    out << "# HELP astra_bus_megabytes_per_second Hub throughput while busy.\n"
+        << "# TYPE astra_bus_megabytes_per_second gauge\n";
+    for (const auto &bus : busStats) {
+        out << "astra_bus_megabytes_per_second{hub=\"" << EscapeLabel(bus.m_hub) << "\"} " << bus.GetMBps() << "\n";
+    }
+    out << "# HELP astra_bus_devices_total Update sessions admitted behind a hub.\n"
+        << "# TYPE astra_bus_devices_total counter\n";
+    for (const auto &bus : busStats) {
+        out << "astra_bus_devices_total{hub=\"" << EscapeLabel(bus.m_hub) << "\"} " << bus.m_devices << "\n";
+    }
+
+    return out.str();
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "astra_device.hpp"
+#include "astra_device_manager.hpp"
+
+/**
+ * Station-wide telemetry for the metrics endpoint, built from the same
+ * responses the manager delivers to the application: device statuses and
+ * the transfer stats each device reports when it finishes.  Progress
+ * responses are ignored, so observing costs a map update per milestone.
+ * Rendered in the Prometheus text exposition format.
+ */
+class StationMetrics
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StationMetrics();
+
+    /**
+     * Account for one response.  bootOnly is set for boot jobs, whose
+     * devices are done once booted.
+     */
+    void Observe(const AstraDeviceManagerResponse &response, bool bootOnly);
+
+    /** Metrics in Prometheus text format, with the hub traffic gathered by the caller. */
+    std::string Render(const std::vector<BusTransferStats> &busStats) const;
+
+private:
+    // Cumulative buckets as Prometheus expects, plus the implicit +Inf bucket.
+    struct Histogram
+    {
+        explicit Histogram(std::vector<double> bounds) : m_bounds{std::move(bounds)}, m_counts(m_bounds.size(), 0)
+        {}
+
+        void Observe(double value);
+
+        std::vector<double> m_bounds;
+        std::vector<uint64_t> m_counts;
+        uint64_t m_count = 0;
+        double m_sum = 0.0;
+    };
+
+    static constexpr std::chrono::hours kRateWindow{1};
+
+    static void RenderHistogram(std::ostringstream &out, const std::string &name, const std::string &labels,
+        const Histogram &histogram);
+    static std::string EscapeLabel(const std::string &value);
+
+    void RecordDeviceDone(Clock::time_point now);
+
+    const Clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::map<AstraDeviceStatus, uint64_t> m_statusCounts;
+    // Start of the phase each device is in, by device name.
+    std::map<std::string, Clock::time_point> m_bootStarts;
+    std::map<std::string, Clock::time_point> m_updateStarts;
+    // Devices done in the last kRateWindow, oldest first.
+    std::deque<Clock::time_point> m_recentDone;
+    uint64_t m_devicesDone = 0;
+    uint64_t m_bytesSent = 0;
+    uint64_t m_imagesSkipped = 0;
+    Histogram m_bootSeconds;
+    Histogram m_updateSeconds;
+    Histogram m_rebindSeconds;
+    std::map<std::string, Histogram> m_imageSeconds;
+};
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "stream_digest.hpp"
+
+#include <cstring>
+
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+StreamDigest::StreamDigest()
+{
+    m_workerThread = ThreadPolicy::Start(THREAD_ROLE_TRANSFER, "astra-digest", &StreamDigest::WorkerThread, this);
+}
+
+StreamDigest::~StreamDigest()
+{
+    ASTRA_LOG;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_chunkQueuedCV.notify_all();
+
+    if (m_workerThread.joinable()) {
+        m_workerThread.join();
+    }
+}
+
+void StreamDigest::Start()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_chunkHashedCV.wait(lock, [this] { return m_chunks.empty() && !m_hashing; });
+    m_sha256.Reset();
+}
+
+void StreamDigest::Update(const uint8_t *data, size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+
+    std::vector<uint8_t> buffer;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        // Always admit one chunk so a block larger than the limit cannot stall.
+        m_chunkHashedCV.wait(lock, [this, size] {
+            return m_queuedBytes == 0 || m_queuedBytes + size <= kMaxQueuedBytes;
+        });
+        m_queuedBytes += size;
+        if (!m_spareBuffers.empty()) {
+            buffer = std::move(m_spareBuffers.back());
+            m_spareBuffers.pop_back();
+        }
+    }
+
+    buffer.resize(size);
+    std::memcpy(buffer.data(), data, size);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Chunk chunk;
+        chunk.data = buffer.data();
+        chunk.size = size;
+        chunk.copy = std::move(buffer);
+        m_chunks.push_back(std::move(chunk));
+    }
+    m_chunkQueuedCV.notify_one();
+}
+
+void StreamDigest::UpdateShared(const uint8_t *data, size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Chunk chunk;
+        chunk.data = data;
+        chunk.size = size;
+        m_chunks.push_back(std::move(chunk));
+    }
+    m_chunkQueuedCV.notify_one();
+}
+
+std::string StreamDigest::Finish()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_chunkHashedCV.wait(lock, [this] { return m_chunks.empty() && !m_hashing; });
+    return m_sha256.FinalHex();
+}
+
+void StreamDigest::WorkerThread()
+{
+    ASTRA_LOG;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_chunkQueuedCV.wait(lock, [this] { return !m_chunks.empty() || m_stop; });
+        if (m_chunks.empty()) {
+            return;
+        }
+
+        Chunk chunk = std::move(m_chunks.front());
+        m_chunks.pop_front();
+        m_hashing = true;
+        lock.unlock();
+
+        // Only this thread touches m_sha256 while m_hashing is set.
+        m_sha256.Update(chunk.data, chunk.size);
+
+        lock.lock();
+        m_hashing = false;
+        if (!chunk.copy.empty()) {
+            m_queuedBytes -= chunk.size;
+            m_spareBuffers.push_back(std::move(chunk.copy));
+        }
+        m_chunkHashedCV.notify_all();
+    }
+}
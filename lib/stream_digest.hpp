@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sha256.hpp"
+
+/**
+ * SHA-256 of an image computed on a worker thread while it is sent.  The
+ * sender hands over each block as it goes onto the bus and only waits when
+ * more than kMaxQueuedBytes copied data is still unhashed, so hashing
+ * overlaps the transfer instead of following it.
+ */
+class StreamDigest {
+public:
+    static constexpr size_t kMaxQueuedBytes = 8 * 1024 * 1024;
+
+    StreamDigest();
+    ~StreamDigest();
+
+    StreamDigest(const StreamDigest &) = delete;
+    StreamDigest &operator=(const StreamDigest &) = delete;
+
+    /** Begin a new digest, discarding the previous one. */
+    void Start();
+
+    /** Queue a copy of data, e.g. a transfer buffer which is reused once written. */
+    void Update(const uint8_t *data, size_t size);
+
+    /** Queue data without copying it; it must stay valid until Finish() returns. */
+    void UpdateShared(const uint8_t *data, size_t size);
+
+    /** Wait for the queued data to be hashed.  @return the digest as lowercase hex. */
+    std::string Finish();
+
+private:
+    struct Chunk {
+        std::vector<uint8_t> copy;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+    };
+
+    void WorkerThread();
+
+    Sha256 m_sha256;
+    std::deque<Chunk> m_chunks;
+    std::vector<std::vector<uint8_t>> m_spareBuffers;
+    size_t m_queuedBytes = 0;
+    bool m_hashing = false;
+    bool m_stop = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_chunkQueuedCV;
+    std::condition_variable m_chunkHashedCV;
+    std::thread m_workerThread;
+};
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "thread_policy.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+
+#if defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(PLATFORM_LINUX)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(PLATFORM_MACOS)
+#include <mach/mach.h>
+#include <mach/thread_policy.h>
+#include <pthread/qos.h>
+#endif
+
+#include "astra_log.hpp"
+
+namespace {
+
+std::mutex g_policyMutex;
+std::array<ThreadPolicy::RolePolicy, THREAD_ROLE_COUNT> g_policies;
+std::array<std::atomic<bool>, THREAD_ROLE_COUNT> g_warned{};
+
+const char *RoleName(ThreadRole role)
+{
+    switch (role) {
+        case THREAD_ROLE_USB:
+            return "usb";
+        case THREAD_ROLE_TRANSFER:
+            return "transfer";
+        case THREAD_ROLE_BACKGROUND:
+            return "background";
+        default:
+            return "unknown";
+    }
+}
+
+std::string Trim(const std::string &value)
+{
+    const size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return value.substr(begin, value.find_last_not_of(" \t") - begin + 1);
+}
+
+bool ParseCpuList(const std::string &list, std::vector<unsigned> &cpus)
+{
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item = Trim(item);
+        try {
+            size_t used = 0;
+            const size_t dash = item.find('-');
+            const unsigned first = static_cast<unsigned>(std::stoul(item.substr(0, dash), &used));
+            unsigned last = first;
+            if (dash != std::string::npos) {
+                last = static_cast<unsigned>(std::stoul(item.substr(dash + 1), &used));
+                used += dash + 1;
+            }
+            if (used != item.size() || last < first || last >= 1024) {
+                return false;
+            }
+            for (unsigned cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception &) {
+            return false;
+        }
+    }
+    return !cpus.empty();
+}
+
+} // namespace
+
+bool ThreadPolicy::Configure(const std::string &spec, std::string &error)
+{
+    std::array<RolePolicy, THREAD_ROLE_COUNT> policies;
+    {
+        std::lock_guard<std::mutex> lock(g_policyMutex);
+        policies = g_policies;
+    }
+
+    std::istringstream stream(spec);
+    std::string entry;
+    while (std::getline(stream, entry, ';')) {
+        entry = Trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+
+        const size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            error = "Thread policy entry is not role=priority[:cpus]: " + entry;
+            return false;
+        }
+        const std::string roleName = Trim(entry.substr(0, equals));
+        std::string priorityName = Trim(entry.substr(equals + 1));
+        std::string cpuList;
+        const size_t colon = priorityName.find(':');
+        if (colon != std::string::npos) {
+            cpuList = priorityName.substr(colon + 1);
+            priorityName = Trim(priorityName.substr(0, colon));
+        }
+
+        int role = 0;
+        while (role < THREAD_ROLE_COUNT && roleName != RoleName(static_cast<ThreadRole>(role))) {
+            ++role;
+        }
+        if (role == THREAD_ROLE_COUNT) {
+            error = "Unknown thread role: " + roleName;
+            return false;
+        }
+
+        RolePolicy policy;
+        if (priorityName == "normal") {
+            policy.m_priority = ASTRA_THREAD_PRIORITY_NORMAL;
+        } else if (priorityName == "high") {
+            policy.m_priority = ASTRA_THREAD_PRIORITY_HIGH;
+        } else if (priorityName == "realtime") {
+            policy.m_priority = ASTRA_THREAD_PRIORITY_REALTIME;
+        } else {
+            error = "Unknown thread priority: " + priorityName;
+            return false;
+        }
+        if (colon != std::string::npos && !ParseCpuList(cpuList, policy.m_cpus)) {
+            error = "Invalid CPU list for thread role " + roleName + ": " + cpuList;
+            return false;
+        }
+        policies[role] = policy;
+    }
+
+    std::lock_guard<std::mutex> lock(g_policyMutex);
+    g_policies = policies;
+    return true;
+}
+
+ThreadPolicy::RolePolicy ThreadPolicy::GetRolePolicy(ThreadRole role)
+{
+    std::lock_guard<std::mutex> lock(g_policyMutex);
+    return g_policies[role];
+}
+
+void ThreadPolicy::Apply(ThreadRole role, const char *name)
+{
+    ASTRA_LOG;
+
+#if defined(PLATFORM_LINUX)
+    // The kernel keeps 15 characters and the terminator.
+    char shortName[16] = {};
+    std::snprintf(shortName, sizeof(shortName), "%s", name);
+    pthread_setname_np(pthread_self(), shortName);
+#elif defined(PLATFORM_MACOS)
+    pthread_setname_np(name);
+#elif defined(PLATFORM_WINDOWS)
+    // SetThreadDescription() is only in Windows 10 1607 and later.
+    using SetThreadDescriptionFunction = HRESULT (WINAPI *)(HANDLE, PCWSTR);
+    static const auto setThreadDescription = reinterpret_cast<SetThreadDescriptionFunction>(
+        GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+    if (setThreadDescription != nullptr) {
+        const std::string narrow(name);
+        const std::wstring wide(narrow.begin(), narrow.end());
+        setThreadDescription(GetCurrentThread(), wide.c_str());
+    }
+#endif
+
+    const RolePolicy policy = GetRolePolicy(role);
+    if (policy.m_priority == ASTRA_THREAD_PRIORITY_NORMAL && policy.m_cpus.empty()) {
+        return;
+    }
+
+    const bool priorityApplied = ApplyPriority(policy.m_priority);
+    const bool affinityApplied = ApplyAffinity(policy.m_cpus);
+    if ((!priorityApplied || !affinityApplied) && !g_warned[role].exchange(true)) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "Cannot apply the " << RoleName(role) << " thread policy"
+            << (priorityApplied ? "" : " priority") << (affinityApplied ? "" : " CPUs")
+            << " to " << name << "; the host may not allow it" << endLog;
+    }
+}
+
+bool ThreadPolicy::ApplyPriority(ThreadPriority priority)
+{
+    if (priority == ASTRA_THREAD_PRIORITY_NORMAL) {
+        return true;
+    }
+
+#if defined(PLATFORM_WINDOWS)
+    const int level = priority == ASTRA_THREAD_PRIORITY_REALTIME ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST;
+    return SetThreadPriority(GetCurrentThread(), level) != 0;
+#else
+    if (priority == ASTRA_THREAD_PRIORITY_REALTIME) {
+        // Mid-range, above the defaults other real-time software tends to use.
+        sched_param param = {};
+        param.sched_priority = (sched_get_priority_min(SCHED_FIFO) + sched_get_priority_max(SCHED_FIFO)) / 2;
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    }
+#if defined(PLATFORM_LINUX)
+    // Linux keeps a nice value per thread.
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), -10) == 0;
+#elif defined(PLATFORM_MACOS)
+    return pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#else
+    return false;
+#endif
+#endif
+}
+
+bool ThreadPolicy::ApplyAffinity(const std::vector<unsigned> &cpus)
+{
+    if (cpus.empty()) {
+        return true;
+    }
+
+#if defined(PLATFORM_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(PLATFORM_WINDOWS)
+    DWORD_PTR mask = 0;
+    for (unsigned cpu : cpus) {
+        if (cpu < sizeof(DWORD_PTR) * 8) {
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(PLATFORM_MACOS)
+    // macOS cannot pin a thread; threads sharing an affinity tag are kept
+    // on the same L2 cache, which is the nearest it offers.
+    thread_affinity_policy_data_t affinity = {static_cast<integer_t>(cpus.front() + 1)};
+    return thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_AFFINITY_POLICY,
+        reinterpret_cast<thread_policy_t>(&affinity), THREAD_AFFINITY_POLICY_COUNT) == KERN_SUCCESS;
+#else
+    return false;
+#endif
+}
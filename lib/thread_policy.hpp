@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+enum ThreadRole {
+    THREAD_ROLE_USB,         // USB and CDC event handling: libusb events, callbacks, image request tasks, CDC I/O
+    THREAD_ROLE_TRANSFER,    // device flows and what feeds their transfers: decompression, digests
+    THREAD_ROLE_BACKGROUND,  // everything else: logs, enumeration, metrics, response delivery
+    THREAD_ROLE_COUNT,
+};
+
+enum ThreadPriority {
+    ASTRA_THREAD_PRIORITY_NORMAL,
+    ASTRA_THREAD_PRIORITY_HIGH,      // above other processes' threads, still time-shared
+    ASTRA_THREAD_PRIORITY_REALTIME,  // SCHED_FIFO, time-critical on Windows
+};
+
+/**
+ * The priority and CPUs of each thread role, set once per process before
+ * the device manager starts any thread.  Every thread the library creates
+ * starts through Start(), which names it and applies the policy of its
+ * role.  A policy the host does not allow, e.g. real-time priority without
+ * the privilege, is reported once per role and the thread runs as before.
+ */
+class ThreadPolicy {
+public:
+    struct RolePolicy {
+        ThreadPriority m_priority = ASTRA_THREAD_PRIORITY_NORMAL;
+        std::vector<unsigned> m_cpus;  // empty for any CPU
+    };
+
+    /**
+     * Parse and install spec, a ';' separated list of role=priority[:cpus],
+     * e.g. "usb=realtime:2,3;transfer=high:0-3".  Roles are usb, transfer
+     * and background; priorities normal, high and realtime; cpus a ','
+     * separated list of CPU numbers and ranges.  Roles not named keep
+     * their policy.
+     * @return false with error set if spec is malformed; nothing is changed.
+     */
+    static bool Configure(const std::string &spec, std::string &error);
+
+    static RolePolicy GetRolePolicy(ThreadRole role);
+
+    /** Name the calling thread, at most 15 characters, and apply role's policy to it. */
+    static void Apply(ThreadRole role, const char *name);
+
+    /** std::thread(function, args...) which first calls Apply(role, name). */
+    template <typename Function, typename... Args>
+    static std::thread Start(ThreadRole role, const char *name, Function &&function, Args &&...args)
+    {
+        return std::thread([role, name, function = std::forward<Function>(function),
+            arguments = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            Apply(role, name);
+            std::apply(std::move(function), std::move(arguments));
+        });
+    }
+
+private:
+    static bool ApplyPriority(ThreadPriority priority);
+    static bool ApplyAffinity(const std::vector<unsigned> &cpus);
+};
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+
+#include "transfer_stats.hpp"
+
+TransferStats::TransferStats()
+{
+    for (auto &bucket : m_latencyBuckets) {
+        bucket.store(0);
+    }
+}
+
+void TransferStats::RecordWriteLatency(Clock::duration latency)
+{
+    const int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+
+    // Bucket i holds [2^i, 2^(i+1)) microseconds; bucket 0 also takes < 1 us.
+    size_t bucket = 0;
+    for (uint64_t value = static_cast<uint64_t>(micros > 0 ? micros : 0); value > 1; value >>= 1) {
+        ++bucket;
+    }
+    if (bucket >= m_latencyBuckets.size()) {
+        bucket = m_latencyBuckets.size() - 1;
+    }
+
+    m_latencyBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TransferStats::ArmFirstWrite()
+{
+    m_firstWriteNs.store(0);
+}
+
+void TransferStats::MarkWrite()
+{
+    if (m_firstWriteNs.load(std::memory_order_relaxed) != 0) {
+        return;
+    }
+
+    int64_t expected = 0;
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+    m_firstWriteNs.compare_exchange_strong(expected, now);
+}
+
+bool TransferStats::GetFirstWriteTime(Clock::time_point &time) const
+{
+    const int64_t ns = m_firstWriteNs.load();
+    if (ns == 0) {
+        return false;
+    }
+
+    time = Clock::time_point(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(ns)));
+    return true;
+}
+
+void TransferStats::RecordImage(const ImageTransferStats &stats, Clock::time_point requestTime,
+    Clock::time_point endTime)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_images.empty()) {
+        m_firstRequestTime = requestTime;
+    }
+    m_lastCompleteTime = endTime;
+    m_images.push_back(stats);
+}
+
+void TransferStats::RecordRebind(Clock::duration latency)
+{
+    const double seconds = std::chrono::duration<double>(latency).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_rebindCount;
+    m_rebindSeconds += seconds;
+    m_maxRebindSeconds = std::max(m_maxRebindSeconds, seconds);
+    m_rebindDurations.push_back(seconds);
+}
+
+DeviceTransferStats TransferStats::Snapshot(const std::string &deviceName) const
+{
+    DeviceTransferStats snapshot;
+    snapshot.m_deviceName = deviceName;
+
+    for (size_t i = 0; i < m_latencyBuckets.size(); ++i) {
+        snapshot.m_writeLatencyHistogram[i] = m_latencyBuckets[i].load();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    snapshot.m_images = m_images;
+    for (const auto &image : m_images) {
+        snapshot.m_bytesSent += image.m_bytes;
+        snapshot.m_transferSeconds += image.m_seconds;
+    }
+    if (!m_images.empty()) {
+        snapshot.m_wallSeconds = std::chrono::duration<double>(m_lastCompleteTime - m_firstRequestTime).count();
+    }
+    snapshot.m_rebindCount = m_rebindCount;
+    snapshot.m_rebindSeconds = m_rebindSeconds;
+    snapshot.m_maxRebindSeconds = m_maxRebindSeconds;
+    snapshot.m_rebindDurations = m_rebindDurations;
+
+    return snapshot;
+}
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "astra_device.hpp"
+
+/**
+ * Per-device transfer counters shared between an AstraDeviceImpl and the
+ * USBDevice it is currently bound to.  The USB side records write latencies
+ * from its completion callbacks; the image-request loop records per-image
+ * timings.  Held by shared_ptr so it survives SL26XX rebinds.
+ */
+class TransferStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TransferStats();
+
+    /** Record the submit-to-completion time of one bulk OUT write. */
+    void RecordWriteLatency(Clock::duration latency);
+
+    /** Forget the first-write timestamp; called when an image request arrives. */
+    void ArmFirstWrite();
+
+    /** Called on every bulk OUT submission; remembers the first one after ArmFirstWrite(). */
+    void MarkWrite();
+
+    /** @return true and the time of the first write since ArmFirstWrite(), if any. */
+    bool GetFirstWriteTime(Clock::time_point &time) const;
+
+    void RecordImage(const ImageTransferStats &stats, Clock::time_point requestTime, Clock::time_point endTime);
+
+    /** Record how long a device took to come back after leaving a session. */
+    void RecordRebind(Clock::duration latency);
+
+    DeviceTransferStats Snapshot(const std::string &deviceName) const;
+
+private:
+    std::array<std::atomic<uint64_t>, DeviceTransferStats::kLatencyBucketCount> m_latencyBuckets;
+    std::atomic<int64_t> m_firstWriteNs{0};
+
+    mutable std::mutex m_mutex;
+    std::vector<ImageTransferStats> m_images;
+    Clock::time_point m_firstRequestTime{};
+    Clock::time_point m_lastCompleteTime{};
+    unsigned m_rebindCount = 0;
+    double m_rebindSeconds = 0.0;
+    double m_maxRebindSeconds = 0.0;
+    std::vector<double> m_rebindDurations;
+};
@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "transfer_tuner.hpp"
+#include "astra_log.hpp"
+#include "host_cache.hpp"
+
+TransferTuner::TransferTuner(const std::string &statePath) : m_statePath{statePath}
+{
+    if (!m_statePath.empty()) {
+        m_saved = ReadState(m_statePath);
+    }
+}
+
+TransferTuner::Parameters TransferTuner::Select(const std::string &link, uint64_t bytes,
+    const std::vector<size_t> &chunkSizes, const std::vector<size_t> &queueDepths)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    LinkState &state = GetLinkLocked(link, chunkSizes, queueDepths);
+    if (state.m_tuned || bytes < kMinSampleBytes) {
+        return state.m_best;
+    }
+
+    // Devices on the same link measure different candidates side by side.
+    for (auto &candidate : state.m_candidates) {
+        if (!candidate.m_measured && candidate.m_pending == 0) {
+            ++candidate.m_pending;
+            return candidate.m_parameters;
+        }
+    }
+    return state.m_best;
+}
+
+void TransferTuner::Report(const std::string &link, const Parameters &parameters, uint64_t bytes,
+    std::chrono::steady_clock::duration elapsed)
+{
+    ASTRA_LOG;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto linkIt = m_links.find(link);
+    if (linkIt == m_links.end() || linkIt->second.m_tuned) {
+        return;
+    }
+    LinkState &state = linkIt->second;
+
+    auto it = std::find_if(state.m_candidates.begin(), state.m_candidates.end(), [&parameters](const Candidate &c) {
+        return c.m_parameters == parameters && c.m_pending > 0;
+    });
+    if (it == state.m_candidates.end()) {
+        return;
+    }
+
+    --it->m_pending;
+    it->m_measured = true;
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    // A failed transfer scores zero, so its parameters are never chosen.
+    it->m_mbps = seconds > 0 ? static_cast<double>(bytes) / seconds / 1e6 : 0;
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Transfer tuning " << link << ": chunk " << parameters.m_chunkSize
+        << " depth " << parameters.m_queueDepth << ": " << it->m_mbps << " MB/s" << endLog;
+
+    AdvanceLocked(link, state);
+}
+
+TransferTuner::LinkState &TransferTuner::GetLinkLocked(const std::string &link, const std::vector<size_t> &chunkSizes,
+    const std::vector<size_t> &queueDepths)
+{
+    auto it = m_links.find(link);
+    if (it != m_links.end()) {
+        return it->second;
+    }
+
+    LinkState &state = m_links[link];
+    state.m_chunkSizes = chunkSizes;
+    state.m_queueDepths = queueDepths;
+    state.m_best = Parameters{chunkSizes.empty() ? 0 : chunkSizes.front(), queueDepths.empty() ? 0 : queueDepths.front()};
+
+    auto savedIt = m_saved.find(link);
+    if (savedIt != m_saved.end()) {
+        const Parameters &saved = savedIt->second.m_parameters;
+        // Only trust a saved result the current protocol and device still allow.
+        if (std::find(chunkSizes.begin(), chunkSizes.end(), saved.m_chunkSize) != chunkSizes.end() &&
+            std::find(queueDepths.begin(), queueDepths.end(), saved.m_queueDepth) != queueDepths.end())
+        {
+            state.m_best = saved;
+            state.m_bestMBps = savedIt->second.m_mbps;
+            state.m_tuned = true;
+            return state;
+        }
+    }
+
+    AddCandidatesLocked(state, {state.m_best.m_chunkSize}, queueDepths);
+    if (state.m_candidates.size() < 2) {
+        // Nothing to choose between at the default chunk size.
+        AdvanceLocked(link, state);
+    }
+    return state;
+}
+
+void TransferTuner::AddCandidatesLocked(LinkState &state, const std::vector<size_t> &chunkSizes,
+    const std::vector<size_t> &queueDepths)
+{
+    for (size_t chunkSize : chunkSizes) {
+        for (size_t queueDepth : queueDepths) {
+            const Parameters parameters{chunkSize, queueDepth};
+            if (!(parameters == state.m_best) && chunkSize * queueDepth > kMaxQueuedBytes) {
+                continue;
+            }
+            const bool known = std::any_of(state.m_candidates.begin(), state.m_candidates.end(),
+                [&parameters](const Candidate &c) { return c.m_parameters == parameters; });
+            if (!known) {
+                state.m_candidates.push_back(Candidate{parameters});
+            }
+        }
+    }
+}
+
+void TransferTuner::AdvanceLocked(const std::string &link, LinkState &state)
+{
+    ASTRA_LOG;
+
+    while (true) {
+        const bool pending = std::any_of(state.m_candidates.begin(), state.m_candidates.end(),
+            [](const Candidate &c) { return !c.m_measured; });
+        // A single candidate needs no measurement.
+        if (pending && state.m_candidates.size() > 1) {
+            return;
+        }
+
+        // The current best is kept unless another candidate is clearly faster.
+        for (const auto &candidate : state.m_candidates) {
+            if (candidate.m_parameters == state.m_best) {
+                state.m_bestMBps = candidate.m_mbps;
+            }
+        }
+        for (const auto &candidate : state.m_candidates) {
+            if (candidate.m_measured && candidate.m_mbps > state.m_bestMBps * kMinSpeedup) {
+                state.m_best = candidate.m_parameters;
+                state.m_bestMBps = candidate.m_mbps;
+            }
+        }
+
+        if (state.m_tuningChunkSize || state.m_chunkSizes.size() < 2) {
+            break;
+        }
+
+        // The measured default-chunk candidates stay, so the best depth is
+        // not measured twice.
+        state.m_tuningChunkSize = true;
+        AddCandidatesLocked(state, state.m_chunkSizes, {state.m_best.m_queueDepth});
+    }
+
+    state.m_tuned = true;
+    state.m_candidates.clear();
+
+    if (state.m_bestMBps <= 0) {
+        // Nothing was measured, so there is nothing worth keeping.
+        return;
+    }
+
+    log(ASTRA_LOG_LEVEL_INFO) << "Transfer tuning " << link << ": using chunk size " << state.m_best.m_chunkSize
+        << " and queue depth " << state.m_best.m_queueDepth << " (" << state.m_bestMBps << " MB/s)" << endLog;
+
+    m_saved[link] = SavedLink{state.m_best, state.m_bestMBps};
+    WriteStateLocked();
+}
+
+std::map<std::string, TransferTuner::SavedLink> TransferTuner::ReadState(const std::string &path)
+{
+    ASTRA_LOG;
+
+    std::map<std::string, SavedLink> saved;
+
+    std::ifstream file(path);
+    if (!file) {
+        return saved;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kStateHeader) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring transfer tuning state with unknown format" << endLog;
+        return saved;
+    }
+
+    while (std::getline(file, line)) {
+        std::string parametersLine;
+        if (line.rfind("link ", 0) != 0 || !std::getline(file, parametersLine) ||
+            parametersLine.rfind("parameters ", 0) != 0)
+        {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed transfer tuning state" << endLog;
+            return {};
+        }
+
+        SavedLink link;
+        std::istringstream fields(parametersLine.substr(11));
+        if (!(fields >> link.m_parameters.m_chunkSize >> link.m_parameters.m_queueDepth >> link.m_mbps)) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed transfer tuning state" << endLog;
+            return {};
+        }
+        saved[line.substr(5)] = link;
+    }
+
+    return saved;
+}
+
+void TransferTuner::WriteStateLocked() const
+{
+    ASTRA_LOG;
+
+    if (m_statePath.empty()) {
+        return;
+    }
+
+    // Keep links another session tuned since this one started.
+    std::map<std::string, SavedLink> state = ReadState(m_statePath);
+    for (const auto &[link, saved] : m_saved) {
+        state[link] = saved;
+    }
+
+    const std::filesystem::path statePath(m_statePath);
+    std::error_code ec;
+    if (statePath.has_parent_path()) {
+        std::filesystem::create_directories(statePath.parent_path(), ec);
+    }
+
+    // Write a private temporary and rename it over the state, so a
+    // concurrent run never reads a partial file.
+    const std::filesystem::path tempPath = statePath.string() + "." +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::trunc);
+        if (!file) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Cannot write " << tempPath << ", not saving transfer tuning" << endLog;
+            return;
+        }
+
+        file << kStateHeader << "\n";
+        for (const auto &[link, saved] : state) {
+            file << "link " << link << "\n";
+            file << "parameters " << saved.m_parameters.m_chunkSize << " " << saved.m_parameters.m_queueDepth
+                << " " << saved.m_mbps << "\n";
+        }
+
+        if (!file.flush()) {
+            log(ASTRA_LOG_LEVEL_WARNING) << "Failed to write transfer tuning state " << tempPath << endLog;
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, statePath, ec);
+    if (ec) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "Failed to replace transfer tuning state: " << ec.message() << endLog;
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    log(ASTRA_LOG_LEVEL_DEBUG) << "Saved transfer tuning for " << state.size() << " link(s) to " << m_statePath << endLog;
+}
+
+std::string TransferTuner::DefaultStatePath()
+{
+    return HostCacheFilePath("transfer-tuning");
+}
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Learns the bulk write chunk size and write queue depth that move update
+ * images fastest on each link, e.g. one protocol behind one USB hub.  The
+ * first large images of a session each try one candidate: the queue depths
+ * at the default chunk size, then the chunk sizes at the best depth.  Once
+ * every candidate has been measured the link keeps the fastest, and the
+ * result is saved so later sessions on this host start tuned.
+ */
+class TransferTuner
+{
+public:
+    struct Parameters
+    {
+        size_t m_chunkSize = 0;
+        size_t m_queueDepth = 0;
+
+        bool operator==(const Parameters &other) const
+        {
+            return m_chunkSize == other.m_chunkSize && m_queueDepth == other.m_queueDepth;
+        }
+    };
+
+    // Smaller transfers are dominated by per-image latency and not measured.
+    static constexpr uint64_t kMinSampleBytes = 8 * 1024 * 1024;
+    // Queued bytes allowed in flight per device; usbfs limits the total.
+    static constexpr size_t kMaxQueuedBytes = 16 * 1024 * 1024;
+
+    /** @param statePath  File holding the learned parameters; empty to keep them in memory. */
+    explicit TransferTuner(const std::string &statePath);
+
+    /**
+     * Parameters for sending bytes on link.  chunkSizes and queueDepths are
+     * the values the protocol and device allow, the defaults first.  While
+     * the link is being tuned, a large enough transfer gets the next
+     * candidate to measure and must be followed by Report().
+     */
+    Parameters Select(const std::string &link, uint64_t bytes, const std::vector<size_t> &chunkSizes,
+        const std::vector<size_t> &queueDepths);
+
+    /** Record a transfer from Select(), with an elapsed time of zero if it failed. */
+    void Report(const std::string &link, const Parameters &parameters, uint64_t bytes,
+        std::chrono::steady_clock::duration elapsed);
+
+    /** Per-user state file for this host, or empty if there is no home directory. */
+    static std::string DefaultStatePath();
+
+private:
+    struct Candidate
+    {
+        Parameters m_parameters;
+        double m_mbps = 0;
+        unsigned m_pending = 0;
+        bool m_measured = false;
+    };
+
+    struct LinkState
+    {
+        std::vector<size_t> m_chunkSizes;
+        std::vector<size_t> m_queueDepths;
+        Parameters m_best;
+        double m_bestMBps = 0;
+        bool m_tuned = false;
+        // Queue depths first, then chunk sizes.
+        bool m_tuningChunkSize = false;
+        std::vector<Candidate> m_candidates;
+    };
+
+    struct SavedLink
+    {
+        Parameters m_parameters;
+        double m_mbps = 0;
+    };
+
+    // Measurement noise must not move a link off its default.
+    static constexpr double kMinSpeedup = 1.05;
+
+    static constexpr const char *kStateHeader = "astra-transfer-tuning 1";
+
+    LinkState &GetLinkLocked(const std::string &link, const std::vector<size_t> &chunkSizes,
+        const std::vector<size_t> &queueDepths);
+    void AddCandidatesLocked(LinkState &state, const std::vector<size_t> &chunkSizes,
+        const std::vector<size_t> &queueDepths);
+    void AdvanceLocked(const std::string &link, LinkState &state);
+
+    static std::map<std::string, SavedLink> ReadState(const std::string &path);
+    void WriteStateLocked() const;
+
+    const std::string m_statePath;
+    std::mutex m_mutex;
+    std::map<std::string, LinkState> m_links;
+    // Links tuned in an earlier session, or in this one.
+    std::map<std::string, SavedLink> m_saved;
+};
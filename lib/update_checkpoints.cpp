@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "update_checkpoints.hpp"
+#include "astra_log.hpp"
+#include "host_cache.hpp"
+
+UpdateCheckpoints::UpdateCheckpoints(const std::string &statePath, std::chrono::seconds window)
+    : m_statePath{statePath}, m_window{window}
+{
+    if (!m_statePath.empty()) {
+        m_sessions = ReadState();
+    }
+}
+
+void UpdateCheckpoints::Record(const std::string &sessionUuid, const Image &image)
+{
+    const std::string fingerprint = Fingerprint(image);
+    if (sessionUuid.empty() || fingerprint.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Session &session = m_sessions[sessionUuid];
+    session.m_lastRecord = Now();
+    session.m_images[image.GetName()] = fingerprint;
+    m_cleared.erase(sessionUuid);
+    WriteStateLocked();
+}
+
+bool UpdateCheckpoints::IsRecorded(const std::string &sessionUuid, const Image &image)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_sessions.find(sessionUuid);
+    if (it == m_sessions.end() || IsExpired(it->second)) {
+        return false;
+    }
+
+    auto imageIt = it->second.m_images.find(image.GetName());
+    return imageIt != it->second.m_images.end() && imageIt->second == Fingerprint(image);
+}
+
+void UpdateCheckpoints::RecordJob(const std::string &sessionUuid, const std::string &job)
+{
+    if (sessionUuid.empty() || job.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Session &session = m_sessions[sessionUuid];
+    session.m_lastRecord = Now();
+    session.m_job = job;
+    m_cleared.erase(sessionUuid);
+    WriteStateLocked();
+}
+
+bool UpdateCheckpoints::IsSessionOf(const std::string &sessionUuid, const std::string &job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_sessions.find(sessionUuid);
+    return it != m_sessions.end() && !IsExpired(it->second) && !job.empty() && it->second.m_job == job;
+}
+
+void UpdateCheckpoints::Clear(const std::string &sessionUuid)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_sessions.erase(sessionUuid) == 0) {
+        return;
+    }
+    m_cleared.insert(sessionUuid);
+    WriteStateLocked();
+}
+
+std::string UpdateCheckpoints::Fingerprint(const Image &image)
+{
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(image.GetFilePath(), ec);
+    if (ec) {
+        return "";
+    }
+    const auto modified = std::filesystem::last_write_time(image.GetFilePath(), ec);
+    if (ec) {
+        return "";
+    }
+    std::string fingerprint = std::to_string(size) + " " + std::to_string(modified.time_since_epoch().count());
+    if (image.IsFileSlice()) {
+        // Images in one bundle share its size and time.
+        fingerprint += " @" + std::to_string(image.GetFileOffset());
+    }
+    return fingerprint;
+}
+
+int64_t UpdateCheckpoints::Now()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool UpdateCheckpoints::IsExpired(const Session &session) const
+{
+    return Now() - session.m_lastRecord > m_window.count();
+}
+
+std::map<std::string, UpdateCheckpoints::Session> UpdateCheckpoints::ReadState() const
+{
+    ASTRA_LOG;
+
+    std::map<std::string, Session> sessions;
+
+    std::ifstream file(m_statePath);
+    if (!file) {
+        return sessions;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kStateHeader) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring update checkpoints with unknown format" << endLog;
+        return sessions;
+    }
+
+    Session *session = nullptr;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string keyword;
+        fields >> keyword;
+        if (keyword == "session") {
+            std::string uuid;
+            int64_t lastRecord = 0;
+            if (!(fields >> uuid >> lastRecord)) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed update checkpoints" << endLog;
+                return {};
+            }
+            session = &sessions[uuid];
+            session->m_lastRecord = lastRecord;
+        } else if (keyword == "job" && session != nullptr) {
+            if (!(fields >> session->m_job)) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed update checkpoints" << endLog;
+                return {};
+            }
+        } else if (keyword == "image" && session != nullptr) {
+            // The name is last, so it may contain spaces.
+            std::string size;
+            std::string modified;
+            std::string name;
+            if (!(fields >> size >> modified) || !std::getline(fields >> std::ws, name) || name.empty()) {
+                log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed update checkpoints" << endLog;
+                return {};
+            }
+            session->m_images[name] = size + " " + modified;
+        } else {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Ignoring malformed update checkpoints" << endLog;
+            return {};
+        }
+    }
+
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        it = IsExpired(it->second) ? sessions.erase(it) : std::next(it);
+    }
+    return sessions;
+}
+
+void UpdateCheckpoints::WriteStateLocked() const
+{
+    ASTRA_LOG;
+
+    if (m_statePath.empty()) {
+        return;
+    }
+
+    // Keep sessions other runs recorded since this one started.
+    std::map<std::string, Session> state = ReadState();
+    for (const auto &uuid : m_cleared) {
+        state.erase(uuid);
+    }
+    for (const auto &[uuid, session] : m_sessions) {
+        if (!IsExpired(session)) {
+            state[uuid] = session;
+        }
+    }
+
+    const std::filesystem::path statePath(m_statePath);
+    std::error_code ec;
+    if (statePath.has_parent_path()) {
+        std::filesystem::create_directories(statePath.parent_path(), ec);
+    }
+
+    // Write a private temporary and rename it over the state, so a
+    // concurrent run never reads a partial file.
+    const std::filesystem::path tempPath = statePath.string() + "." +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::trunc);
+        if (!file) {
+            log(ASTRA_LOG_LEVEL_DEBUG) << "Cannot write " << tempPath << ", not saving update checkpoints" << endLog;
+            return;
+        }
+
+        file << kStateHeader << "\n";
+        for (const auto &[uuid, session] : state) {
+            file << "session " << uuid << " " << session.m_lastRecord << "\n";
+            if (!session.m_job.empty()) {
+                file << "job " << session.m_job << "\n";
+            }
+            for (const auto &[name, fingerprint] : session.m_images) {
+                file << "image " << fingerprint << " " << name << "\n";
+            }
+        }
+
+        if (!file.flush()) {
+            log(ASTRA_LOG_LEVEL_WARNING) << "Failed to write update checkpoints " << tempPath << endLog;
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tempPath, statePath, ec);
+    if (ec) {
+        log(ASTRA_LOG_LEVEL_WARNING) << "Failed to replace update checkpoints: " << ec.message() << endLog;
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+std::string UpdateCheckpoints::DefaultStatePath()
+{
+    return HostCacheFilePath("update-checkpoints");
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "image.hpp"
+
+/**
+ * Remembers which update images each board has been sent, by the session
+ * UUID U-Boot reports as its serial#.  A board which re-attaches with the
+ * same UUID within the resume window, e.g. after a cable glitch, skips the
+ * images it already holds instead of starting the update over.  Images are
+ * recognised by name, size and modification time, so a rebuilt update
+ * image is sent again.  Checkpoints are saved so a later run can resume.
+ */
+class UpdateCheckpoints
+{
+public:
+    /**
+     * @param statePath  File holding the checkpoints; empty to keep them in memory.
+     * @param window     How long after its last checkpoint a session may resume.
+     */
+    UpdateCheckpoints(const std::string &statePath, std::chrono::seconds window);
+
+    /** Record that the board of sessionUuid was sent image and acknowledged it. */
+    void Record(const std::string &sessionUuid, const Image &image);
+
+    /** True if image was recorded for sessionUuid within the window and is unchanged since. */
+    bool IsRecorded(const std::string &sessionUuid, const Image &image);
+
+    /** Record that sessionUuid was written into a uEnv.txt for job, as in BootSessions. */
+    void RecordJob(const std::string &sessionUuid, const std::string &job);
+
+    /** True if sessionUuid was recorded for job within the window. */
+    bool IsSessionOf(const std::string &sessionUuid, const std::string &job);
+
+    /** Forget sessionUuid once its update has completed. */
+    void Clear(const std::string &sessionUuid);
+
+    /** Per-user state file for this host, or empty if there is no home directory. */
+    static std::string DefaultStatePath();
+
+private:
+    struct Session
+    {
+        // Seconds since the epoch; sessions are resumed across runs.
+        int64_t m_lastRecord = 0;
+        // The job the session was booted for, if recorded.
+        std::string m_job;
+        // Image name to "<size> <modification time>".
+        std::map<std::string, std::string> m_images;
+    };
+
+    static constexpr const char *kStateHeader = "astra-update-checkpoints 1";
+
+    static std::string Fingerprint(const Image &image);
+    static int64_t Now();
+    bool IsExpired(const Session &session) const;
+
+    std::map<std::string, Session> ReadState() const;
+    void WriteStateLocked() const;
+
+    const std::string m_statePath;
+    const std::chrono::seconds m_window;
+    std::mutex m_mutex;
+    std::map<std::string, Session> m_sessions;
+    // Completed in this run, so they are dropped from the saved state too.
+    std::set<std::string> m_cleared;
+};
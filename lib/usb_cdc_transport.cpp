@@ -7,6 +7,7 @@
 #include <filesystem>
 
 #include "astra_log.hpp"
+#include "thread_policy.hpp"
 
 USBCDCTransport::~USBCDCTransport()
 {
@@ -60,7 +61,7 @@ void USBCDCTransport::StartDeviceMonitor()
 {
     ASTRA_LOG;
 
-    m_deviceMonitorThread = std::thread(&USBCDCTransport::DeviceMonitorThread, this);
+    m_deviceMonitorThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-cdc-mon", &USBCDCTransport::DeviceMonitorThread, this);
 }
 
 void USBCDCTransport::DeviceMonitorThread()
@@ -99,10 +100,15 @@ bool USBCDCTransport::IsValidPort(const std::string& portPath) const
         return true;
     }
 
-    const std::string normalizedPort = NormalizePortPath(portPath);
+    return IsPortInFilter(portPath, m_filterPorts);
+}
+
+bool USBCDCTransport::IsPortInFilter(const std::string &usbPath, const std::vector<std::string> &filterPorts) const
+{
+    const std::string normalizedPort = NormalizePortPath(usbPath);
     const std::string shortName = std::filesystem::path(normalizedPort).filename().string();
 
-    for (const auto &filterPort : m_filterPorts) {
+    for (const auto &filterPort : filterPorts) {
         const std::string normalizedFilter = NormalizePortPath(filterPort);
 
         if (normalizedPort == normalizedFilter || shortName == normalizedFilter) {
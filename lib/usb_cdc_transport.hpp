@@ -30,6 +30,7 @@ public:
     bool BlockDeviceEnumeration() override { return true; }
     void UnblockDeviceEnumeration() override {}
     void RemoveActiveDevice(const std::string& usbPath) override;
+    bool IsPortInFilter(const std::string &usbPath, const std::vector<std::string> &filterPorts) const override;
 
     virtual void StartDeviceMonitor();
 
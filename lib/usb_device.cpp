@@ -8,56 +8,273 @@
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <new>
 
 #include "usb_device.hpp"
 #include "astra_log.hpp"
+#include "event_executor.hpp"
+#include "thread_policy.hpp"
 
 USBDevice::~USBDevice()
 {
     ASTRA_LOG;
+
+    if (m_writeBuffer != nullptr) {
+        ::operator delete[](m_writeBuffer, std::align_val_t(kTransferBufferAlignment));
+    }
 }
 
 int USBDevice::EnableInterrupts()
 {
     ASTRA_LOG;
 
+    if (m_eventExecutor) {
+        // Interrupts queued since Open() go out with the first drain.
+        m_callbackThreadRunning.store(true);
+        ScheduleCallbackDrain();
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Delivering events on the shared event executor" << endLog;
+        return 0;
+    }
+
     // Start callback worker thread to process queued interrupts
     // Interrupt transfer was already submitted in Open(), so interrupts are already queuing
     m_callbackThreadRunning.store(true);
-    m_callbackThread = std::thread([this]() { this->CallbackWorkerThread(); });
+    m_callbackThread = ThreadPolicy::Start(THREAD_ROLE_USB, "astra-usb-cb", [this]() { this->CallbackWorkerThread(); });
 
     log(ASTRA_LOG_LEVEL_DEBUG) << "Callback worker thread started, processing queued interrupts" << endLog;
 
     return 0;
 }
 
-void USBDevice::CallbackWorkerThread()
+int USBDevice::WriteQueued(const uint8_t *data, size_t size)
 {
     ASTRA_LOG;
 
-    while (m_callbackThreadRunning.load()) {
-        CallbackEvent event;
-        {
-            std::unique_lock<std::mutex> lock(m_callbackQueueMutex);
-            m_callbackQueueCV.wait(lock, [this] {
-                return !m_callbackQueue.empty() || !m_callbackThreadRunning.load();
-            });
+    size_t offset = 0;
+    while (offset < size) {
+        int transferred = 0;
+        const int ret = Write(const_cast<uint8_t *>(data + offset), size - offset, &transferred);
+        if (ret < 0 || transferred <= 0) {
+            return -1;
+        }
 
-            if (!m_callbackThreadRunning.load() && m_callbackQueue.empty()) {
-                break;
-            }
+        offset += static_cast<size_t>(transferred);
+    }
+
+    return 0;
+}
+
+int USBDevice::WriteQueuedGather(const WriteSegment *segments, size_t count)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size += segments[i].size;
+    }
+    if (size == 0) {
+        return 0;
+    }
+
+    uint8_t *buffer = AcquireWriteBuffer(size);
+    if (buffer == nullptr) {
+        return -1;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (segments[i].size > 0) {
+            std::memcpy(buffer + offset, segments[i].data, segments[i].size);
+            offset += segments[i].size;
+        }
+    }
+
+    return CommitQueuedWrite(size);
+}
 
-            if (!m_callbackQueue.empty()) {
-                event = std::move(m_callbackQueue.front());
-                m_callbackQueue.pop();
-            } else {
-                continue;
+uint8_t *USBDevice::AcquireWriteBuffer(size_t size)
+{
+    if (m_writeBufferCapacity < size) {
+        if (m_writeBuffer != nullptr) {
+            ::operator delete[](m_writeBuffer, std::align_val_t(kTransferBufferAlignment));
+        }
+        m_writeBuffer = static_cast<uint8_t *>(::operator new[](size, std::align_val_t(kTransferBufferAlignment)));
+        m_writeBufferCapacity = size;
+    }
+
+    return m_writeBuffer;
+}
+
+int USBDevice::CommitQueuedWrite(size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+
+    return WriteQueued(m_writeBuffer, size);
+}
+
+void USBDevice::QueueCallbackEvent(USBEvent event, const uint8_t *data, size_t size)
+{
+    if (data == nullptr) {
+        size = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> producerLock(m_callbackProducerMutex);
+
+        const size_t tail = m_callbackTail.load(std::memory_order_relaxed);
+        if (m_callbackOverflowCount.load() == 0 && size <= kCallbackEventDataSize &&
+            tail - m_callbackHead.load(std::memory_order_acquire) < kCallbackEventSlots)
+        {
+            CallbackSlot &slot = m_callbackSlots[tail % kCallbackEventSlots];
+            slot.event = event;
+            slot.size = size;
+            if (size > 0) {
+                std::memcpy(slot.data.data(), data, size);
+            }
+            m_callbackTail.store(tail + 1);
+        } else {
+            CallbackEvent callbackEvent;
+            callbackEvent.event = event;
+            callbackEvent.data.assign(data, data + size);
+            {
+                std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
+                m_callbackOverflow.push(std::move(callbackEvent));
             }
+            m_callbackOverflowCount.fetch_add(1);
+        }
+    }
+
+    if (m_eventExecutor) {
+        // A drain already posted sees this event: it checks for events
+        // again after clearing the flag.
+        if (!m_callbackDrainScheduled.load()) {
+            ScheduleCallbackDrain();
+        }
+    } else if (m_callbackWaiting.load()) {
+        WakeCallbackWorker();
+    }
+}
+
+void USBDevice::ScheduleCallbackDrain()
+{
+    // Under the mutex so StopCallbackWorker() never returns with a drain
+    // about to be posted.
+    std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
+    if (!m_callbackThreadRunning.load() || m_callbackDrainScheduled.exchange(true)) {
+        return;
+    }
+    m_eventExecutor->Post([this]() { DrainCallbackEvents(); });
+}
+
+void USBDevice::DrainCallbackEvents()
+{
+    // A few events per turn, so one busy device does not hold a thread the
+    // others are waiting for.
+    for (size_t i = 0; i < kCallbackEventsPerDrain || !m_callbackThreadRunning.load(); ++i) {
+        if (!DispatchCallbackEvent()) {
+            break;
         }
+    }
+
+    std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
+    m_callbackDrainScheduled.store(false);
+    if (m_callbackThreadRunning.load() && CallbackEventPending()) {
+        m_callbackDrainScheduled.store(true);
+        m_eventExecutor->Post([this]() { DrainCallbackEvents(); });
+        return;
+    }
+    // The device may be destroyed as soon as the mutex is released.
+    m_callbackQueueCV.notify_all();
+}
 
-        // Call the callback outside the lock to avoid blocking the queue
+void USBDevice::StopCallbackWorker()
+{
+    ASTRA_LOG;
+
+    if (m_eventExecutor) {
+        std::unique_lock<std::mutex> lock(m_callbackQueueMutex);
+        if (!m_callbackThreadRunning.exchange(false)) {
+            return;
+        }
+        m_callbackQueueCV.wait(lock, [this] { return !m_callbackDrainScheduled.load(); });
+        lock.unlock();
+        // Deliver what arrived after the last drain, as the worker does.
+        while (DispatchCallbackEvent()) {
+        }
+        return;
+    }
+
+    if (m_callbackThreadRunning.exchange(false)) {
+        WakeCallbackWorker();
+        if (m_callbackThread.joinable()) {
+            m_callbackThread.join();
+        }
+    }
+}
+
+void USBDevice::WakeCallbackWorker()
+{
+    // Taking the mutex orders the notify after the worker's predicate check.
+    std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
+    m_callbackQueueCV.notify_all();
+}
+
+bool USBDevice::CallbackEventPending() const
+{
+    return m_callbackHead.load(std::memory_order_relaxed) != m_callbackTail.load() ||
+        m_callbackOverflowCount.load() > 0;
+}
+
+bool USBDevice::DispatchCallbackEvent()
+{
+    const size_t head = m_callbackHead.load(std::memory_order_relaxed);
+    if (head != m_callbackTail.load(std::memory_order_acquire)) {
+        CallbackSlot &slot = m_callbackSlots[head % kCallbackEventSlots];
         if (m_usbEventCallback) {
-            m_usbEventCallback(event.event, event.data.empty() ? nullptr : event.data.data(), event.data.size());
+            m_usbEventCallback(slot.event, slot.size > 0 ? slot.data.data() : nullptr, slot.size);
+        }
+        // Only now may a producer reuse the slot.
+        m_callbackHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // The ring is drained, so spilled events are next in order.
+    if (m_callbackOverflowCount.load() == 0) {
+        return false;
+    }
+
+    CallbackEvent event;
+    {
+        std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
+        event = std::move(m_callbackOverflow.front());
+        m_callbackOverflow.pop();
+    }
+    if (m_usbEventCallback) {
+        m_usbEventCallback(event.event, event.data.empty() ? nullptr : event.data.data(), event.data.size());
+    }
+    m_callbackOverflowCount.fetch_sub(1);
+    return true;
+}
+
+void USBDevice::CallbackWorkerThread()
+{
+    ASTRA_LOG;
+
+    for (;;) {
+        // Call the callback without holding any lock so producers never wait on it.
+        if (DispatchCallbackEvent()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_callbackQueueMutex);
+        m_callbackWaiting.store(true);
+        m_callbackQueueCV.wait(lock, [this] {
+            return CallbackEventPending() || !m_callbackThreadRunning.load();
+        });
+        m_callbackWaiting.store(false);
+
+        if (!m_callbackThreadRunning.load() && !CallbackEventPending()) {
+            break;
         }
     }
 }
@@ -2,11 +2,13 @@
 // Copyright 2025 Synaptics Incorporated
 
 #pragma once
+#include <array>
 #include <cstdint>
 #include <cstddef>
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
@@ -14,6 +16,9 @@
 
 #include "device.hpp"
 #include "astra_log.hpp"
+#include "transfer_stats.hpp"
+
+class EventExecutor;
 
 class USBDevice : public Device {
 public:
@@ -38,6 +43,8 @@ public:
     virtual uint16_t GetVendorId() const { return 0; }
     virtual uint16_t GetProductId() const { return 0; }
     virtual uint8_t GetNumInterfaces() const { return 0; }
+    /** The iSerialNumber string read by Open(); empty before then or if the device has none. */
+    const std::string &GetSerialNumber() const { return m_serialNumber; }
 
     int Write(uint8_t *data, size_t size, int *transferred) override = 0;
 
@@ -47,9 +54,133 @@ public:
         return -1;
     }
 
+    /**
+     * Queue a bulk OUT write without waiting for it to reach the device.
+     * Data is copied before returning, so the caller may reuse its buffer.
+     * Queued writes complete in order; call FlushQueuedWrites() before
+     * waiting on a response from the device.  The default implementation
+     * writes synchronously.
+     *
+     * @return 0 on success, -1 if the write (or an earlier queued write) failed.
+     */
+    virtual int WriteQueued(const uint8_t *data, size_t size);
+
+    /** One piece of a gathered write. */
+    struct WriteSegment {
+        const uint8_t *data;
+        size_t size;
+    };
+
+    /**
+     * Queue the concatenation of count segments as a single write, e.g.
+     * protocol headers, a payload and its padding, without the caller
+     * staging them in one buffer first.  Ordering and error reporting are
+     * as for WriteQueued().  The default implementation gathers the
+     * segments straight into the AcquireWriteBuffer() buffer.
+     *
+     * @return 0 on success, -1 on failure.
+     */
+    virtual int WriteQueuedGather(const WriteSegment *segments, size_t count);
+
+    /**
+     * Wait for every write queued by WriteQueued() to complete.
+     *
+     * @return 0 if all queued writes succeeded, -1 otherwise.
+     */
+    virtual int FlushQueuedWrites() { return 0; }
+
+    /**
+     * Reserve the buffer for the next queued write so the caller can fill it
+     * in place, then send it with CommitQueuedWrite().  This avoids the copy
+     * WriteQueued() makes: libusb devices hand out DMA-able memory where the
+     * platform supports it (usbfs mmap on Linux), others an aligned heap
+     * buffer.  Only one buffer may be reserved at a time and it must be
+     * committed before any other write.
+     *
+     * @return a buffer of at least size bytes, or nullptr on failure.
+     */
+    virtual uint8_t *AcquireWriteBuffer(size_t size);
+
+    /**
+     * Queue the first size bytes of the buffer from AcquireWriteBuffer().
+     * A size of 0 releases the buffer without sending anything.
+     *
+     * @return 0 on success, -1 on failure.
+     */
+    virtual int CommitQueuedWrite(size_t size);
+
+    /**
+     * For callers which must not block, e.g. tasks on an EventExecutor:
+     * ask whether AcquireWriteBuffer() and WriteQueued() can go ahead
+     * without waiting for an earlier queued write.  If not, onReady is
+     * called once, from the transport's event thread, when they can or
+     * when the device fails or closes.  The default implementation never
+     * waits.
+     *
+     * @return true if the next queued write will not wait.
+     */
+    virtual bool PollWriteBuffer(std::function<void()> onReady)
+    {
+        (void)onReady;
+        return true;
+    }
+
+    /** As PollWriteBuffer(), for FlushQueuedWrites(). */
+    virtual bool PollQueuedWrites(std::function<void()> onFlushed)
+    {
+        (void)onFlushed;
+        return true;
+    }
+
+    /**
+     * Start a bulk IN read without waiting for it.  done is called once,
+     * from the transport's event thread, with what ReadBulk() would have
+     * returned and the bytes transferred.  One read may be outstanding at
+     * a time.  The default implementation reads synchronously and calls
+     * done before returning.
+     *
+     * @return 0 if the read was started, < 0 if not (done is not called).
+     */
+    virtual int ReadBulkAsync(uint8_t *data, size_t size, int timeoutMs, std::function<void(int result, int transferred)> done)
+    {
+        int transferred = 0;
+        const int ret = ReadBulk(data, size, &transferred, timeoutMs);
+        done(ret, transferred);
+        return 0;
+    }
+
+    /** @return how many queued writes may be in flight at once. */
+    virtual size_t GetWriteQueueDepth() const { return 1; }
+
+    /** @return the largest depth SetWriteQueueDepth() accepts. */
+    virtual size_t GetMaxWriteQueueDepth() const { return GetWriteQueueDepth(); }
+
+    /**
+     * Change how many queued writes may be in flight, between transfers.
+     * @return false if depth is not supported or writes are still queued.
+     */
+    virtual bool SetWriteQueueDepth(size_t depth) { return depth == GetWriteQueueDepth(); }
+
     virtual int WriteInterruptData(const uint8_t *data, size_t size) = 0;
 
+    /**
+     * Record bulk OUT write latencies and submission times into stats.
+     * Set before the first transfer; may be nullptr.
+     */
+    void SetTransferStats(std::shared_ptr<TransferStats> stats) { m_transferStats = std::move(stats); }
+
+    /**
+     * Deliver events on executor, shared with other devices, instead of on
+     * a callback worker thread of this device.  Set before
+     * EnableInterrupts(); may be nullptr.
+     */
+    void SetEventExecutor(std::shared_ptr<EventExecutor> executor) { m_eventExecutor = std::move(executor); }
+
 protected:
+    static constexpr size_t kTransferBufferAlignment = 4096;
+
+    std::shared_ptr<TransferStats> m_transferStats;
+
     int m_actualBytesWritten;
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_shutdown{false};
@@ -62,16 +193,29 @@ protected:
     std::condition_variable m_writeCompleteCV;
     std::atomic<bool> m_writeComplete = false;
 
+    // Default AcquireWriteBuffer() storage, grown on demand.
+    uint8_t *m_writeBuffer = nullptr;
+    size_t m_writeBufferCapacity = 0;
+
     std::function<void(USBEvent event, uint8_t *buf, size_t size)> m_usbEventCallback;
 
-    // Async callback processing
-    struct CallbackEvent {
-        USBEvent event;
-        std::vector<uint8_t> data;
-    };
-    std::queue<CallbackEvent> m_callbackQueue;
-    std::mutex m_callbackQueueMutex;
-    std::condition_variable m_callbackQueueCV;
+    /**
+     * Hand an event, and a copy of its data, to the callback worker thread.
+     * Safe to call from any transport thread.  Events are delivered in the
+     * order they were queued.
+     */
+    void QueueCallbackEvent(USBEvent event, const uint8_t *data = nullptr, size_t size = 0);
+
+    /** Wake the callback worker, e.g. after clearing m_callbackThreadRunning. */
+    void WakeCallbackWorker();
+
+    /**
+     * Stop delivering events: deliver those already queued, then join the
+     * callback worker or wait for the executor to finish with this device.
+     * No callback runs once this returns.
+     */
+    void StopCallbackWorker();
+
     std::thread m_callbackThread;
     std::atomic<bool> m_callbackThreadRunning{false};
 
@@ -83,4 +227,52 @@ protected:
     std::condition_variable m_cancellationCV;
 
     void CallbackWorkerThread();
+
+private:
+    // Events normally pass through a ring of preallocated slots: producers
+    // copy into the tail slot and the worker hands the slot's buffer straight
+    // to the callback, so nothing is allocated per event.  The transport's
+    // event thread is usually the only producer; m_callbackProducerMutex
+    // only serialises the rare second one (e.g. a failed write).
+    static constexpr size_t kCallbackEventSlots = 32;
+    static constexpr size_t kCallbackEventDataSize = 4096;
+
+    struct CallbackSlot {
+        USBEvent event;
+        size_t size;
+        std::array<uint8_t, kCallbackEventDataSize> data;
+    };
+
+    // Spill-over for a full ring or an oversized event.  While it holds
+    // events nothing is added to the ring, which keeps delivery in order.
+    struct CallbackEvent {
+        USBEvent event;
+        std::vector<uint8_t> data;
+    };
+
+    bool CallbackEventPending() const;
+    bool DispatchCallbackEvent();
+
+    // Executor delivery: at most one drain of this device's events is posted
+    // or running at a time, which keeps them in order.
+    static constexpr size_t kCallbackEventsPerDrain = 16;
+    void ScheduleCallbackDrain();
+    void DrainCallbackEvents();
+
+    std::shared_ptr<EventExecutor> m_eventExecutor;
+    std::atomic<bool> m_callbackDrainScheduled{false};
+
+    std::unique_ptr<CallbackSlot[]> m_callbackSlots = std::make_unique<CallbackSlot[]>(kCallbackEventSlots);
+    std::atomic<size_t> m_callbackHead{0};
+    std::atomic<size_t> m_callbackTail{0};
+    std::mutex m_callbackProducerMutex;
+
+    std::queue<CallbackEvent> m_callbackOverflow;
+    std::atomic<size_t> m_callbackOverflowCount{0};
+
+    // The worker blocks on m_callbackQueueCV only when there is nothing to
+    // deliver; producers take the mutex to notify only while it is waiting.
+    std::mutex m_callbackQueueMutex;
+    std::condition_variable m_callbackQueueCV;
+    std::atomic<bool> m_callbackWaiting{false};
 };
\ No newline at end of file
@@ -16,6 +16,17 @@
 
 USBTransport::~USBTransport() = default;
 
+bool USBTransport::IsPortInFilter(const std::string &usbPath, const std::vector<std::string> &filterPorts) const
+{
+    for (const auto &port : filterPorts) {
+        if (usbPath.rfind(port, 0) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 std::vector<std::string> USBTransport::ParseFilterPortString(const std::string & filterPorts)
 {
     ASTRA_LOG;
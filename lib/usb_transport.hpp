@@ -36,6 +36,19 @@ public:
     virtual void UnblockDeviceEnumeration() {}
     virtual void RemoveActiveDevice(const std::string& usbPath) {}
 
+    /**
+     * Serve vendorProductIds on filterPorts (every port if empty) from now on,
+     * as if they had been given to Init().  Connected devices this makes
+     * eligible are reported like new arrivals; devices already reported are not.
+     * @return -1 if the transport can only be set up by Init().
+     */
+    virtual int Reconfigure(const std::vector<USBVendorProductId> &, const std::string &) { return -1; }
+
+    /** @return true if usbPath is one of filterPorts, or a device behind one. */
+    virtual bool IsPortInFilter(const std::string &usbPath, const std::vector<std::string> &filterPorts) const;
+
+    static std::vector<std::string> ParseFilterPortString(const std::string& filterPorts);
+
     void StartDeviceMonitor();
 
 protected:
@@ -46,6 +59,4 @@ protected:
     std::mutex m_shutdownMutex;
     std::vector<USBVendorProductId> m_supportedDevices;
     std::vector<std::string> m_filterPorts;
-
-    std::vector<std::string> ParseFilterPortString(const std::string& filterPorts);
 };
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "win_cdc_completion_port.hpp"
+
+#include "astra_log.hpp"
+#include "thread_policy.hpp"
+
+WinCDCCompletionPort::WinCDCCompletionPort()
+{
+    ASTRA_LOG;
+
+    m_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, kWorkerThreads);
+    if (m_port == nullptr) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to create CDC completion port: " << GetLastError() << endLog;
+        return;
+    }
+
+    for (DWORD i = 0; i < kWorkerThreads; ++i) {
+        m_threads.push_back(ThreadPolicy::Start(THREAD_ROLE_USB, "astra-cdc-iocp", &WinCDCCompletionPort::WorkerThread, this));
+    }
+}
+
+WinCDCCompletionPort::~WinCDCCompletionPort()
+{
+    ASTRA_LOG;
+
+    if (m_port == nullptr) {
+        return;
+    }
+
+    // A completion without an OVERLAPPED tells one worker to exit.
+    for (size_t i = 0; i < m_threads.size(); ++i) {
+        PostQueuedCompletionStatus(m_port, 0, 0, nullptr);
+    }
+    for (auto &thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    CloseHandle(m_port);
+    m_port = nullptr;
+}
+
+int WinCDCCompletionPort::Associate(HANDLE handle)
+{
+    ASTRA_LOG;
+
+    if (m_port == nullptr) {
+        return -1;
+    }
+
+    if (CreateIoCompletionPort(handle, m_port, 0, 0) == nullptr) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to associate CDC handle with completion port: " << GetLastError() << endLog;
+        return -1;
+    }
+
+    // Completions are only ever collected from the port, so skip signalling the handle.
+    SetFileCompletionNotificationModes(handle, FILE_SKIP_SET_EVENT_ON_HANDLE);
+
+    return 0;
+}
+
+void WinCDCCompletionPort::WorkerThread()
+{
+    ASTRA_LOG;
+
+    for (;;) {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED *overlapped = nullptr;
+        const BOOL result = GetQueuedCompletionStatus(m_port, &bytes, &key, &overlapped, INFINITE);
+        if (overlapped == nullptr) {
+            if (!result) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "CDC completion port wait failed: " << GetLastError() << endLog;
+            }
+            break;
+        }
+
+        Request *request = static_cast<Request *>(overlapped);
+        request->onComplete(result ? static_cast<DWORD>(ERROR_SUCCESS) : GetLastError(), bytes);
+    }
+}
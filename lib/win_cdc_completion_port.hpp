@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <windows.h>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ * I/O completion port shared by every open CDC serial port.  Devices keep
+ * several overlapped reads and writes outstanding on their handle and a small
+ * pool of threads runs the completion handlers, instead of one blocking
+ * reader thread per device.
+ */
+class WinCDCCompletionPort {
+public:
+    /**
+     * One overlapped operation.  Pass the request as the OVERLAPPED of a
+     * ReadFile/WriteFile on an associated handle; onComplete then runs on a
+     * pool thread with the Win32 error (ERROR_SUCCESS on success) and the
+     * byte count.  The request must stay alive until onComplete has been called.
+     */
+    struct Request : OVERLAPPED {
+        Request() : OVERLAPPED() {}
+
+        std::function<void(DWORD error, DWORD bytes)> onComplete;
+    };
+
+    WinCDCCompletionPort();
+    ~WinCDCCompletionPort();
+
+    WinCDCCompletionPort(const WinCDCCompletionPort &) = delete;
+    WinCDCCompletionPort &operator=(const WinCDCCompletionPort &) = delete;
+
+    /** Route completions for an overlapped handle to this port.  @return 0 on success, -1 on failure. */
+    int Associate(HANDLE handle);
+
+private:
+    static constexpr DWORD kWorkerThreads = 2;
+
+    void WorkerThread();
+
+    HANDLE m_port = nullptr;
+    std::vector<std::thread> m_threads;
+};
@@ -3,10 +3,14 @@
 
 #include "win_libusb_transport.hpp"
 #include "astra_log.hpp"
+#include "thread_policy.hpp"
 #include <initguid.h>
 #include <devpkey.h>
 #include <usbiodef.h>
 
+#include <cctype>
+#include <string>
+
 WinLibUSBTransport::~WinLibUSBTransport()
 {
     ASTRA_LOG;
@@ -56,9 +60,9 @@ int WinLibUSBTransport::Init(std::vector<USBVendorProductId> vendorProductIds, c
 
     // Start device enumeration worker thread
     m_enumerationThreadRunning.store(true);
-    m_deviceEnumerationThread = std::thread(&WinLibUSBTransport::DeviceEnumerationWorker, this);
+    m_deviceEnumerationThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-usb-enum", &WinLibUSBTransport::DeviceEnumerationWorker, this);
 
-    m_hotplugThread = std::thread(&WinLibUSBTransport::RunHotplugHandler, this);
+    m_hotplugThread = ThreadPolicy::Start(THREAD_ROLE_USB, "astra-usb-event", &WinLibUSBTransport::RunHotplugHandler, this);
 
     StartDeviceMonitor();
 
@@ -90,8 +94,7 @@ void WinLibUSBTransport::Shutdown()
         }
 
         // Interrupt the libusb event handler so DeviceMonitorThread returns
-        // from libusb_handle_events_timeout_completed() immediately instead
-        // of sleeping up to the 100 ms timeout.
+        // from its blocking libusb_handle_events_completed() call.
         if (m_ctx) {
             libusb_interrupt_event_handler(m_ctx);
         }
@@ -159,7 +162,7 @@ LRESULT CALLBACK WinLibUSBTransport::WndProc(HWND hWnd, UINT message, WPARAM wPa
             if (pHdr->dbch_devicetype == DBT_DEVTYP_DEVICEINTERFACE) {
                 PDEV_BROADCAST_DEVICEINTERFACE pDevInf = reinterpret_cast<PDEV_BROADCAST_DEVICEINTERFACE>(pHdr);
                 log(ASTRA_LOG_LEVEL_DEBUG) << "Device Arrived: " << pDevInf->dbcc_name << endLog;
-                if (handler) {
+                if (handler && handler->ArrivalMayMatch(pDevInf->dbcc_name)) {
                     handler->OnDeviceArrived();
                 }
             }
@@ -171,6 +174,42 @@ LRESULT CALLBACK WinLibUSBTransport::WndProc(HWND hWnd, UINT message, WPARAM wPa
     return DefWindowProc(hWnd, message, wParam, lParam);
 }
 
+bool WinLibUSBTransport::ArrivalMayMatch(const TCHAR *interfaceName) const
+{
+    // The interface name embeds the IDs, e.g. \\?\USB#VID_06CB&PID_00B1#...,
+    // so arrivals of keyboards, hubs and the like need no libusb sweep.
+    const std::basic_string<TCHAR> name(interfaceName);
+    std::string upper;
+    upper.reserve(name.size());
+    for (TCHAR c : name) {
+        upper.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c & 0x7F))));
+    }
+
+    const size_t vidPos = upper.find("VID_");
+    const size_t pidPos = upper.find("PID_");
+    if (vidPos == std::string::npos || pidPos == std::string::npos ||
+        vidPos + 8 > upper.size() || pidPos + 8 > upper.size())
+    {
+        return true;
+    }
+
+    uint16_t vendorId = 0;
+    uint16_t productId = 0;
+    try {
+        vendorId = static_cast<uint16_t>(std::stoul(upper.substr(vidPos + 4, 4), nullptr, 16));
+        productId = static_cast<uint16_t>(std::stoul(upper.substr(pidPos + 4, 4), nullptr, 16));
+    } catch (...) {
+        return true;
+    }
+
+    for (const auto &[vid, pid] : m_supportedDevices) {
+        if (vendorId == vid && productId == pid) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void WinLibUSBTransport::OnDeviceArrived()
 {
     ASTRA_LOG;
@@ -188,9 +227,18 @@ void WinLibUSBTransport::DeviceEnumerationWorker()
     while (m_enumerationThreadRunning.load()) {
         {
             std::unique_lock<std::mutex> lock(m_pendingDevicesMutex);
-            m_pendingDevicesCV.wait(lock, [this] {
+            auto ready = [this] {
                 return m_hasPendingDevices.load() || !m_enumerationThreadRunning.load();
-            });
+            };
+            // A device skipped while another instance held the critical
+            // section is retried shortly, without waiting for an arrival.
+            if (m_deferredDevices) {
+                if (!m_pendingDevicesCV.wait_for(lock, kDeferredRetryInterval, ready)) {
+                    m_hasPendingDevices.store(true);
+                }
+            } else {
+                m_pendingDevicesCV.wait(lock, ready);
+            }
 
             if (!m_enumerationThreadRunning.load()) {
                 break;
@@ -209,26 +257,7 @@ void WinLibUSBTransport::ProcessPendingDevices()
     ASTRA_LOG;
 
     bool retry = false;
-    DWORD mutexAcquired = WAIT_FAILED;
-
-    // Acquire mutex for entire enumeration to prevent race with critical section
-    // This serializes enumeration across all instances but prevents:
-    // - Enumeration during critical section (device resetting)
-    // - Critical section starting during enumeration
-    if (m_hCriticalSectionMutex) {
-        mutexAcquired = WaitForSingleObject(m_hCriticalSectionMutex, 30000); // 30 second timeout
-        if (mutexAcquired == WAIT_OBJECT_0) {
-            log(ASTRA_LOG_LEVEL_DEBUG) << "Acquired mutex for enumeration" << endLog;
-        } else if (mutexAcquired == WAIT_ABANDONED) {
-            log(ASTRA_LOG_LEVEL_WARNING) << "Acquired abandoned mutex for enumeration (previous owner crashed)" << endLog;
-        } else if (mutexAcquired == WAIT_TIMEOUT) {
-            log(ASTRA_LOG_LEVEL_WARNING) << "Timeout waiting for enumeration mutex, skipping" << endLog;
-            return;
-        } else {
-            log(ASTRA_LOG_LEVEL_WARNING) << "Failed to acquire enumeration mutex: " << mutexAcquired << ", skipping" << endLog;
-            return;
-        }
-    }
+    m_deferredDevices = false;
 
     // Let devices settle. Waiting here will make it less likely we need to retry and will
     // actually improve overall detection time.
@@ -239,9 +268,6 @@ void WinLibUSBTransport::ProcessPendingDevices()
         ssize_t count = libusb_get_device_list(m_ctx, &device_list);
         if (count < 0) {
             log(ASTRA_LOG_LEVEL_ERROR) << "Failed to get device list: " << libusb_error_name(count) << endLog;
-            if (m_hCriticalSectionMutex && (mutexAcquired == WAIT_OBJECT_0 || mutexAcquired == WAIT_ABANDONED)) {
-                ReleaseMutex(m_hCriticalSectionMutex);
-            }
             return;
         }
 
@@ -284,8 +310,27 @@ void WinLibUSBTransport::ProcessPendingDevices()
                 // we are probably already using the device. But, LIBUSB_ERROR_ACCESS is only
                 // returned if the device is open by another process. For single instances of astra-update / astra-boot
                 // we also rely on active device tracking to prevent duplicate opens.
+                // Only opening a device can disturb one resetting in another
+                // instance's critical section, so only the open waits on it.
+                // Rather than blocking the sweep, skip the device for now.
+                bool ownsCriticalSection = false;
+                if (m_hCriticalSectionMutex) {
+                    const DWORD waitResult = WaitForSingleObject(m_hCriticalSectionMutex, 0);
+                    if (waitResult == WAIT_ABANDONED) {
+                        log(ASTRA_LOG_LEVEL_WARNING) << "Acquired abandoned critical section mutex (previous owner crashed)" << endLog;
+                    } else if (waitResult != WAIT_OBJECT_0) {
+                        log(ASTRA_LOG_LEVEL_DEBUG) << "Device: " << usbPath << " deferred, critical section busy" << endLog;
+                        m_deferredDevices = true;
+                        continue;
+                    }
+                    ownsCriticalSection = true;
+                }
+
                 libusb_device_handle *handle;
                 ret = libusb_open(device, &handle);
+                if (ownsCriticalSection) {
+                    ReleaseMutex(m_hCriticalSectionMutex);
+                }
                 if (ret == LIBUSB_ERROR_ACCESS) {
                     log(ASTRA_LOG_LEVEL_DEBUG) << "Device: " << usbPath << " open reported LIBUSB_ERROR_ACCESS" << endLog;
                     continue;
@@ -330,12 +375,6 @@ void WinLibUSBTransport::ProcessPendingDevices()
             break;
         }
     }
-
-    // Release mutex after enumeration completes
-    if (m_hCriticalSectionMutex && (mutexAcquired == WAIT_OBJECT_0 || mutexAcquired == WAIT_ABANDONED)) {
-        ReleaseMutex(m_hCriticalSectionMutex);
-        log(ASTRA_LOG_LEVEL_DEBUG) << "Released mutex after enumeration" << endLog;
-    }
 }
 
 bool WinLibUSBTransport::BlockDeviceEnumeration()
@@ -376,6 +415,11 @@ void WinLibUSBTransport::UnblockDeviceEnumeration()
         } else {
             log(ASTRA_LOG_LEVEL_DEBUG) << "Released critical section mutex" << endLog;
         }
+
+        // Open whatever arrived while the section was held.
+        if (m_deferredDevices) {
+            OnDeviceArrived();
+        }
     }
 }
 
@@ -5,6 +5,8 @@
 
 #include <windows.h>
 #include <dbt.h>
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <memory>
 #include <set>
@@ -26,6 +28,7 @@ public:
 private:
     void RunHotplugHandler();
     static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+    bool ArrivalMayMatch(const TCHAR *interfaceName) const;
     void OnDeviceArrived();
     void DeviceEnumerationWorker();
     void ProcessPendingDevices();
@@ -35,6 +38,9 @@ private:
     HDEVNOTIFY m_hDevNotify;
     HANDLE m_hCriticalSectionMutex;  // Serializes critical boot section across all instances
     bool m_enableSerialUpdate{false};
+    // Set when a sweep skipped a device because the critical section was held.
+    std::atomic<bool> m_deferredDevices{false};
+    static constexpr std::chrono::milliseconds kDeferredRetryInterval{250};
     std::thread m_hotplugThread;
     std::thread m_deviceEnumerationThread;
     std::atomic<bool> m_enumerationThreadRunning{false};
@@ -3,22 +3,35 @@
 
 #include "win_usb_cdc_device.hpp"
 
-#include <array>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <limits>
 
 #include "astra_log.hpp"
 
 namespace {
 constexpr DWORD kWriteWaitTimeoutMs = 15000;
-constexpr DWORD kReadPollIntervalMs = 100;
+constexpr DWORD kReadTimeoutMs = 1000;
 } // namespace
 
-WinUSBCDCDevice::WinUSBCDCDevice(const std::string &usbPath, uint16_t vendorId, uint16_t productId, uint8_t numInterfaces)
-    : USBCDCDevice(usbPath, vendorId, productId, numInterfaces), m_handle(INVALID_HANDLE_VALUE)
+WinUSBCDCDevice::WinUSBCDCDevice(const std::string &usbPath, std::shared_ptr<WinCDCCompletionPort> completionPort,
+    uint16_t vendorId, uint16_t productId, uint8_t numInterfaces)
+    : USBCDCDevice(usbPath, vendorId, productId, numInterfaces), m_completionPort(std::move(completionPort)),
+      m_handle(INVALID_HANDLE_VALUE)
 {
     ASTRA_LOG;
+
+    for (auto &slot : m_readSlots) {
+        slot.request.onComplete = [this, &slot](DWORD error, DWORD bytes) {
+            HandleReadComplete(slot, error, bytes);
+        };
+    }
+    for (auto &slot : m_writeQueue) {
+        slot.request.onComplete = [this, &slot](DWORD error, DWORD bytes) {
+            HandleWriteComplete(slot, error, bytes);
+        };
+    }
 }
 
 WinUSBCDCDevice::~WinUSBCDCDevice()
@@ -110,9 +123,11 @@ int WinUSBCDCDevice::Open(std::function<void(USBEvent event, uint8_t *buf, size_
     }
 
     COMMTIMEOUTS timeouts = {};
-    timeouts.ReadIntervalTimeout = 50;
-    timeouts.ReadTotalTimeoutConstant = 50;
-    timeouts.ReadTotalTimeoutMultiplier = 10;
+    // Complete a read as soon as any data is available, or after
+    // kReadTimeoutMs with nothing so the slot is simply resubmitted.
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = kReadTimeoutMs;
+    timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
     timeouts.WriteTotalTimeoutConstant = 1000;
     timeouts.WriteTotalTimeoutMultiplier = 10;
 
@@ -126,9 +141,46 @@ int WinUSBCDCDevice::Open(std::function<void(USBEvent event, uint8_t *buf, size_
     SetupComm(m_handle, 64 * 1024, 64 * 1024);
     PurgeComm(m_handle, PURGE_RXCLEAR | PURGE_TXCLEAR | PURGE_RXABORT | PURGE_TXABORT);
 
+    if (!m_completionPort || m_completionPort->Associate(m_handle) < 0) {
+        CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> writeLock(m_writeQueueMutex);
+        m_writeQueueHead = 0;
+        m_writeQueueError = false;
+    }
+
     m_shutdown.store(false);
     m_running.store(true);
-    m_readerThread = std::thread(&WinUSBCDCDevice::ReaderThread, this);
+
+    bool readsQueued = true;
+    {
+        std::lock_guard<std::mutex> readLock(m_readMutex);
+        m_readDeliverIndex = 0;
+        for (auto &slot : m_readSlots) {
+            slot.complete = false;
+        }
+        for (auto &slot : m_readSlots) {
+            if (!SubmitRead(slot)) {
+                m_running.store(false);
+                readsQueued = false;
+                break;
+            }
+        }
+    }
+
+    if (!readsQueued) {
+        // Wait for the reads already issued to be cancelled before closing.
+        CancelIoEx(m_handle, nullptr);
+        std::unique_lock<std::mutex> pendingLock(m_pendingMutex);
+        m_pendingCV.wait(pendingLock, [this] { return m_pendingOps == 0; });
+        CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
+        return -1;
+    }
 
     return 0;
 }
@@ -151,16 +203,24 @@ void WinUSBCDCDevice::Close()
             m_running.store(false);
 
             if (m_handle != INVALID_HANDLE_VALUE) {
+                // Submitters check m_running under these locks, so once both
+                // have been taken no new operation can follow the cancel.
+                { std::lock_guard<std::mutex> readLock(m_readMutex); }
+                { std::lock_guard<std::mutex> writeLock(m_writeQueueMutex); }
+
                 CancelIoEx(m_handle, nullptr);
+                {
+                    std::unique_lock<std::mutex> pendingLock(m_pendingMutex);
+                    m_pendingCV.wait(pendingLock, [this] { return m_pendingOps == 0; });
+                }
+
                 CloseHandle(m_handle);
                 m_handle = INVALID_HANDLE_VALUE;
             }
         }
     }
 
-    if (m_readerThread.joinable()) {
-        m_readerThread.join();
-    }
+    m_writeQueueCV.notify_all();
 
     StopCallbackWorker();
 }
@@ -176,176 +236,248 @@ int WinUSBCDCDevice::Write(uint8_t *data, size_t size, int *transferred)
         return -1;
     }
 
+    int ret = WriteQueued(data, size);
+    if (FlushQueuedWrites() < 0) {
+        ret = -1;
+    }
+
+    if (transferred) {
+        *transferred = (ret == 0) ? static_cast<int>(size) : 0;
+    }
+
+    return ret;
+}
+
+int WinUSBCDCDevice::WriteQueued(const uint8_t *data, size_t size)
+{
+    const WriteSegment segment = {data, size};
+    return WriteQueuedGather(&segment, 1);
+}
+
+int WinUSBCDCDevice::WriteQueuedGather(const WriteSegment *segments, size_t count)
+{
+    ASTRA_LOG;
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size += segments[i].size;
+    }
+    if (size == 0) {
+        return 0;
+    }
+
     if (size > static_cast<size_t>((std::numeric_limits<DWORD>::max)())) {
         log(ASTRA_LOG_LEVEL_ERROR) << "Write size exceeds DWORD limit on " << m_usbPath << ": " << size << endLog;
-        if (transferred) {
-            *transferred = 0;
-        }
         return -1;
     }
 
-    auto queueWriteFailure = [this, transferred](DWORD error) {
-        CallbackEvent event;
-        if (error == ERROR_DEVICE_NOT_CONNECTED || error == ERROR_INVALID_HANDLE || error == ERROR_GEN_FAILURE) {
-            event.event = USB_DEVICE_EVENT_NO_DEVICE;
-            m_running.store(false);
-        } else {
-            event.event = USB_DEVICE_EVENT_TRANSFER_ERROR;
-        }
+    std::unique_lock<std::mutex> lock(m_writeQueueMutex);
 
-        {
-            std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
-            m_callbackQueue.push(std::move(event));
-        }
-        m_callbackQueueCV.notify_one();
+    // Slots are reused in submission order, so waiting on the head slot also
+    // preserves the order in which completions are collected.
+    WriteSlot &slot = m_writeQueue[m_writeQueueHead];
+    m_writeQueueCV.wait(lock, [this, &slot] {
+        return !slot.inFlight || !m_running.load();
+    });
 
-        if (transferred) {
-            *transferred = 0;
-        }
-    };
+    if (!m_running.load()) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Queued write aborted: device shut down" << endLog;
+        return -1;
+    }
 
-    OVERLAPPED overlapped = {};
-    overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
-    if (overlapped.hEvent == nullptr) {
-        const DWORD error = GetLastError();
-        log(ASTRA_LOG_LEVEL_ERROR) << "CreateEvent failed for write on " << m_usbPath << ": " << error << endLog;
-        queueWriteFailure(error);
+    if (m_writeQueueError) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "Earlier queued write failed, not queueing more data" << endLog;
         return -1;
     }
 
-    DWORD bytesWritten = 0;
-    BOOL result = WriteFile(m_handle, data, static_cast<DWORD>(size), &bytesWritten, &overlapped);
-    if (!result) {
-        DWORD error = GetLastError();
+    // The overlapped write needs its own copy anyway; gather into it directly.
+    slot.buffer.resize(size);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (segments[i].size > 0) {
+            std::memcpy(slot.buffer.data() + offset, segments[i].data, segments[i].size);
+            offset += segments[i].size;
+        }
+    }
+    static_cast<OVERLAPPED &>(slot.request) = {};
+
+    if (m_transferStats) {
+        m_transferStats->MarkWrite();
+    }
+    slot.submitTime = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> pendingLock(m_pendingMutex);
+        ++m_pendingOps;
+    }
+    if (!WriteFile(m_handle, slot.buffer.data(), static_cast<DWORD>(size), nullptr, &slot.request)) {
+        const DWORD error = GetLastError();
         if (error != ERROR_IO_PENDING) {
+            FinishOperation();
             log(ASTRA_LOG_LEVEL_ERROR) << "WriteFile failed on " << m_usbPath << ": " << error << endLog;
-            CloseHandle(overlapped.hEvent);
-            queueWriteFailure(error);
+            QueueFailure(error);
             return -1;
         }
+    }
 
-        const DWORD waitStatus = WaitForSingleObject(overlapped.hEvent, kWriteWaitTimeoutMs);
-        if (waitStatus == WAIT_TIMEOUT) {
-            CancelIoEx(m_handle, &overlapped);
-            log(ASTRA_LOG_LEVEL_ERROR) << "WriteFile timed out on " << m_usbPath << " after " << kWriteWaitTimeoutMs
-                                       << "ms for " << size << " bytes" << endLog;
-            CloseHandle(overlapped.hEvent);
-            queueWriteFailure(ERROR_TIMEOUT);
-            return -1;
-        }
+    // Even an immediate success is reported through the completion port,
+    // which blocks on m_writeQueueMutex until the slot is marked in flight.
+    slot.inFlight = true;
+    ++m_writeQueueInFlight;
+    m_writeQueueHead = (m_writeQueueHead + 1) % kWriteQueueDepth;
 
-        if (waitStatus != WAIT_OBJECT_0) {
-            error = GetLastError();
-            log(ASTRA_LOG_LEVEL_ERROR) << "WaitForSingleObject failed during write on " << m_usbPath
-                                       << ": " << error << endLog;
-            CancelIoEx(m_handle, &overlapped);
-            CloseHandle(overlapped.hEvent);
-            queueWriteFailure(error);
-            return -1;
-        }
+    return 0;
+}
 
-        result = GetOverlappedResult(m_handle, &overlapped, &bytesWritten, FALSE);
-        if (!result) {
-            error = GetLastError();
-            log(ASTRA_LOG_LEVEL_ERROR) << "GetOverlappedResult failed on write for " << m_usbPath
-                                       << ": " << error << endLog;
-            CloseHandle(overlapped.hEvent);
-            queueWriteFailure(error);
-            return -1;
+int WinUSBCDCDevice::FlushQueuedWrites()
+{
+    ASTRA_LOG;
+
+    std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+    auto drained = [this] {
+        return m_writeQueueInFlight == 0 || !m_running.load();
+    };
+
+    if (!m_writeQueueCV.wait_for(lock, std::chrono::milliseconds(kWriteWaitTimeoutMs), drained)) {
+        log(ASTRA_LOG_LEVEL_ERROR) << "WriteFile timed out on " << m_usbPath << " after " << kWriteWaitTimeoutMs
+                                   << "ms with " << m_writeQueueInFlight << " writes pending" << endLog;
+        for (auto &slot : m_writeQueue) {
+            if (slot.inFlight) {
+                CancelIoEx(m_handle, &slot.request);
+            }
         }
+        m_writeQueueCV.wait(lock, drained);
+        m_writeQueueError = false;
+        QueueFailure(ERROR_TIMEOUT);
+        return -1;
     }
 
-    CloseHandle(overlapped.hEvent);
+    const bool writeError = m_writeQueueError;
+    m_writeQueueError = false;
 
-    if (transferred) {
-        *transferred = static_cast<int>(bytesWritten);
+    if (m_writeQueueInFlight > 0) {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Flush aborted: device shut down" << endLog;
+        return -1;
     }
 
-    return 0;
+    return writeError ? -1 : 0;
 }
 
-void WinUSBCDCDevice::ReaderThread()
+void WinUSBCDCDevice::HandleWriteComplete(WriteSlot &slot, DWORD error, DWORD bytes)
 {
     ASTRA_LOG;
 
-    std::array<uint8_t, 4096> buffer = {};
-    while (m_running.load()) {
-        OVERLAPPED overlapped = {};
-        overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
-        if (overlapped.hEvent == nullptr) {
-            const DWORD error = GetLastError();
-            log(ASTRA_LOG_LEVEL_ERROR) << "CreateEvent failed for read on " << m_usbPath << ": " << error << endLog;
-            break;
+    {
+        std::lock_guard<std::mutex> lock(m_writeQueueMutex);
+
+        if (error != ERROR_SUCCESS || bytes != slot.buffer.size()) {
+            m_writeQueueError = true;
+            // A cancelled write was either shut down or already reported by FlushQueuedWrites().
+            if (m_running.load() && error != ERROR_OPERATION_ABORTED) {
+                log(ASTRA_LOG_LEVEL_ERROR) << "Write failed on " << m_usbPath << ": error " << error << ", "
+                                           << bytes << " of " << slot.buffer.size() << " bytes written" << endLog;
+                // A short write means the port's write timeout expired.
+                QueueFailure(error == ERROR_SUCCESS ? static_cast<DWORD>(ERROR_TIMEOUT) : error);
+            }
+        } else if (m_transferStats) {
+            m_transferStats->RecordWriteLatency(std::chrono::steady_clock::now() - slot.submitTime);
         }
 
-        DWORD bytesRead = 0;
-        BOOL result = ReadFile(m_handle, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, &overlapped);
+        slot.inFlight = false;
+        --m_writeQueueInFlight;
+        m_writeQueueCV.notify_all();
+    }
 
-        if (!result && GetLastError() == ERROR_IO_PENDING) {
-            DWORD waitStatus = WAIT_TIMEOUT;
-            while (waitStatus == WAIT_TIMEOUT && m_running.load()) {
-                waitStatus = WaitForSingleObject(overlapped.hEvent, kReadPollIntervalMs);
-            }
+    FinishOperation();
+}
 
-            if (waitStatus == WAIT_OBJECT_0) {
-                result = GetOverlappedResult(m_handle, &overlapped, &bytesRead, FALSE);
-            } else {
-                CancelIoEx(m_handle, &overlapped);
-                CloseHandle(overlapped.hEvent);
-                if (!m_running.load()) {
-                    break;
-                }
+bool WinUSBCDCDevice::SubmitRead(ReadSlot &slot)
+{
+    ASTRA_LOG;
 
-                const DWORD error = (waitStatus == WAIT_FAILED) ? GetLastError() : ERROR_OPERATION_ABORTED;
-                CallbackEvent event;
-                event.event = USB_DEVICE_EVENT_TRANSFER_ERROR;
-                {
-                    std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
-                    m_callbackQueue.push(std::move(event));
-                }
-                m_callbackQueueCV.notify_one();
-                m_running.store(false);
-                log(ASTRA_LOG_LEVEL_ERROR) << "Read wait failed on " << m_usbPath << ": " << error << endLog;
-                break;
-            }
+    static_cast<OVERLAPPED &>(slot.request) = {};
+
+    {
+        std::lock_guard<std::mutex> pendingLock(m_pendingMutex);
+        ++m_pendingOps;
+    }
+    if (!ReadFile(m_handle, slot.buffer.data(), static_cast<DWORD>(slot.buffer.size()), nullptr,
+        &slot.request))
+    {
+        const DWORD error = GetLastError();
+        if (error != ERROR_IO_PENDING) {
+            FinishOperation();
+            log(ASTRA_LOG_LEVEL_ERROR) << "ReadFile failed on " << m_usbPath << ": " << error << endLog;
+            QueueFailure(error);
+            return false;
         }
+    }
+
+    return true;
+}
+
+void WinUSBCDCDevice::HandleReadComplete(ReadSlot &slot, DWORD error, DWORD bytes)
+{
+    ASTRA_LOG;
+
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
 
-        if (!result) {
-            const DWORD error = GetLastError();
-            CloseHandle(overlapped.hEvent);
-            if (!m_running.load() || error == ERROR_OPERATION_ABORTED) {
+        slot.complete = true;
+        slot.error = error;
+        slot.bytes = bytes;
+
+        // Deliver every read that is done, oldest first, and put its slot back in flight.
+        for (;;) {
+            ReadSlot &next = m_readSlots[m_readDeliverIndex];
+            if (!next.complete) {
                 break;
             }
+            next.complete = false;
+            m_readDeliverIndex = (m_readDeliverIndex + 1) % kReadsInFlight;
 
-            CallbackEvent event;
-            if (error == ERROR_DEVICE_NOT_CONNECTED || error == ERROR_INVALID_HANDLE || error == ERROR_GEN_FAILURE) {
-                event.event = USB_DEVICE_EVENT_NO_DEVICE;
-            } else {
-                event.event = USB_DEVICE_EVENT_TRANSFER_ERROR;
+            if (!m_running.load()) {
+                continue;
             }
 
-            {
-                std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
-                m_callbackQueue.push(std::move(event));
+            if (next.error != ERROR_SUCCESS) {
+                if (next.error != ERROR_OPERATION_ABORTED) {
+                    log(ASTRA_LOG_LEVEL_ERROR) << "Read failed on " << m_usbPath << ": " << next.error << endLog;
+                    QueueFailure(next.error);
+                }
+                m_running.store(false);
+                continue;
             }
-            m_callbackQueueCV.notify_one();
-            m_running.store(false);
-            break;
-        }
 
-        CloseHandle(overlapped.hEvent);
+            if (next.bytes > 0) {
+                QueueCallbackEvent(USB_DEVICE_EVENT_INTERRUPT, next.buffer.data(), next.bytes);
+            }
 
-        if (bytesRead > 0) {
-            CallbackEvent event;
-            event.event = USB_DEVICE_EVENT_INTERRUPT;
-            event.data.assign(buffer.begin(), buffer.begin() + bytesRead);
-            {
-                std::lock_guard<std::mutex> lock(m_callbackQueueMutex);
-                m_callbackQueue.push(std::move(event));
+            if (!SubmitRead(next)) {
+                m_running.store(false);
             }
-            m_callbackQueueCV.notify_one();
         }
     }
+
+    FinishOperation();
+}
+
+void WinUSBCDCDevice::FinishOperation()
+{
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    if (--m_pendingOps == 0) {
+        m_pendingCV.notify_all();
+    }
+}
+
+void WinUSBCDCDevice::QueueFailure(DWORD error)
+{
+    if (error == ERROR_DEVICE_NOT_CONNECTED || error == ERROR_INVALID_HANDLE || error == ERROR_GEN_FAILURE) {
+        QueueCallbackEvent(USB_DEVICE_EVENT_NO_DEVICE);
+        m_running.store(false);
+    } else {
+        QueueCallbackEvent(USB_DEVICE_EVENT_TRANSFER_ERROR);
+    }
 }
 
 uint16_t WinUSBCDCDevice::GetVendorId() const
@@ -5,14 +5,24 @@
 
 #include <windows.h>
 
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "usb_cdc_device.hpp"
+#include "win_cdc_completion_port.hpp"
 
 class WinUSBCDCDevice : public USBCDCDevice {
 public:
-    WinUSBCDCDevice(const std::string &usbPath, uint16_t vendorId = 0, uint16_t productId = 0, uint8_t numInterfaces = 0);
+    // Reads and writes complete on the transport's shared completion port
+    // rather than a per-device reader thread.
+    WinUSBCDCDevice(const std::string &usbPath, std::shared_ptr<WinCDCCompletionPort> completionPort,
+        uint16_t vendorId = 0, uint16_t productId = 0, uint8_t numInterfaces = 0);
     ~WinUSBCDCDevice() override;
 
     int Open(std::function<void(USBEvent event, uint8_t *buf, size_t size)> usbEventCallback) override;
@@ -20,13 +30,59 @@ public:
     void Close() override;
 
     int Write(uint8_t *data, size_t size, int *transferred) override;
+    int WriteQueued(const uint8_t *data, size_t size) override;
+    int WriteQueuedGather(const WriteSegment *segments, size_t count) override;
+    int FlushQueuedWrites() override;
     uint16_t GetVendorId() const override;
     uint16_t GetProductId() const override;
     uint8_t GetNumInterfaces() const override;
 
 private:
+    static constexpr size_t kReadsInFlight = 4;
+    static constexpr size_t kReadBufferSize = 4096;
+    static constexpr size_t kWriteQueueDepth = 4;
+
+    struct ReadSlot {
+        WinCDCCompletionPort::Request request;
+        std::array<uint8_t, kReadBufferSize> buffer = {};
+        bool complete = false;
+        DWORD error = ERROR_SUCCESS;
+        DWORD bytes = 0;
+    };
+
+    struct WriteSlot {
+        WinCDCCompletionPort::Request request;
+        std::vector<uint8_t> buffer;
+        bool inFlight = false;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
     std::string ToComDevicePath(const std::string& portName) const;
-    void ReaderThread();
+    bool SubmitRead(ReadSlot &slot);
+    void HandleReadComplete(ReadSlot &slot, DWORD error, DWORD bytes);
+    void HandleWriteComplete(WriteSlot &slot, DWORD error, DWORD bytes);
+    void FinishOperation();
+    void QueueFailure(DWORD error);
 
+    std::shared_ptr<WinCDCCompletionPort> m_completionPort;
     HANDLE m_handle;
+
+    // Overlapped operations not yet completed; Close() waits for zero before
+    // the slots they point at can go away.
+    std::mutex m_pendingMutex;
+    std::condition_variable m_pendingCV;
+    size_t m_pendingOps = 0;
+
+    // Reads are resubmitted round-robin, so delivering them in slot order
+    // keeps data in arrival order even when pool threads race.
+    std::mutex m_readMutex;
+    std::array<ReadSlot, kReadsInFlight> m_readSlots;
+    size_t m_readDeliverIndex = 0;
+
+    std::mutex m_writeQueueMutex;
+    std::condition_variable m_writeQueueCV;
+    std::array<WriteSlot, kWriteQueueDepth> m_writeQueue;
+    size_t m_writeQueueHead = 0;
+    size_t m_writeQueueInFlight = 0;
+    bool m_writeQueueError = false;
 };
@@ -4,16 +4,17 @@
 #include "win_usb_cdc_transport.hpp"
 
 #include "astra_log.hpp"
+#include "thread_policy.hpp"
 #include "win_usb_cdc_device.hpp"
 
 #include <algorithm>
 #include <chrono>
 #include <cctype>
+#include <cwctype>
 #include <devguid.h>
 #include <initguid.h>
-#include <setupapi.h>
+#include <ntddser.h>
 #include <sstream>
-#include <usbiodef.h>
 
 WinUSBCDCTransport::~WinUSBCDCTransport()
 {
@@ -37,10 +38,26 @@ int WinUSBCDCTransport::Init(std::vector<USBVendorProductId> vendorProductIds, c
 
     m_running.store(true);
 
-    m_enumerationThreadRunning.store(true);
-    m_deviceEnumerationThread = std::thread(&WinUSBCDCTransport::DeviceEnumerationWorker, this);
+    // Register before the initial enumeration so no arrival falls in between;
+    // a port reported by both is simply read twice.
+    CM_NOTIFY_FILTER filter = {};
+    filter.cbSize = sizeof(filter);
+    filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+    filter.u.DeviceInterface.ClassGuid = GUID_DEVINTERFACE_COMPORT;
+    const CONFIGRET cr = CM_Register_Notification(&filter, this, &WinUSBCDCTransport::OnNotification, &m_notification);
+    if (cr != CR_SUCCESS) {
+        m_notification = nullptr;
+        log(ASTRA_LOG_LEVEL_WARNING) << "Failed to register COM port notifications (" << cr
+            << "), sweeping ports every " << kSweepInterval.count() << " ms" << endLog;
+    } else {
+        std::lock_guard<std::mutex> lock(m_pendingDevicesMutex);
+        for (auto &symbolicLink : EnumerateComPortInterfaces()) {
+            m_portEvents.push_back({true, std::move(symbolicLink)});
+        }
+    }
 
-    m_hotplugThread = std::thread(&WinUSBCDCTransport::RunHotplugHandler, this);
+    m_enumerationThreadRunning.store(true);
+    m_deviceEnumerationThread = ThreadPolicy::Start(THREAD_ROLE_BACKGROUND, "astra-cdc-enum", &WinUSBCDCTransport::DeviceEnumerationWorker, this);
 
     // Trigger initial pass so already attached devices are discovered.
     m_hasPendingDevices.store(true);
@@ -55,6 +72,12 @@ void WinUSBCDCTransport::Shutdown()
 
     std::lock_guard<std::mutex> lock(m_shutdownMutex);
     if (m_running.exchange(false)) {
+        // Waits for callbacks in progress, so none touches this after.
+        if (m_notification) {
+            CM_Unregister_Notification(m_notification);
+            m_notification = nullptr;
+        }
+
         if (m_enumerationThreadRunning.exchange(false)) {
             m_pendingDevicesCV.notify_all();
             if (m_deviceEnumerationThread.joinable()) {
@@ -62,97 +85,33 @@ void WinUSBCDCTransport::Shutdown()
             }
         }
 
-        if (m_hWnd) {
-            PostMessage(m_hWnd, WM_QUIT, 0, 0);
-            if (m_hotplugThread.joinable()) {
-                m_hotplugThread.join();
-            }
-
-            if (m_hDevNotify) {
-                UnregisterDeviceNotification(m_hDevNotify);
-                m_hDevNotify = nullptr;
-            }
-
-            DestroyWindow(m_hWnd);
-            UnregisterClassA("AstraCDCDeviceManager", GetModuleHandle(nullptr));
-            m_hWnd = nullptr;
-        } else if (m_hotplugThread.joinable()) {
-            m_hotplugThread.join();
-        }
-
         std::lock_guard<std::mutex> activeLock(m_activeDevicesMutex);
         m_activeDevices.clear();
     }
 }
 
-void WinUSBCDCTransport::RunHotplugHandler()
+DWORD CALLBACK WinUSBCDCTransport::OnNotification(HCMNOTIFICATION notification, PVOID context,
+    CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA eventData, DWORD eventDataSize)
 {
-    ASTRA_LOG;
+    (void)notification;
+    (void)eventDataSize;
 
-    WNDCLASSA wc = {};
-    wc.lpfnWndProc = WinUSBCDCTransport::WndProc;
-    wc.hInstance = GetModuleHandle(nullptr);
-    wc.lpszClassName = "AstraCDCDeviceManager";
-
-    if (!RegisterClassA(&wc)) {
-        const DWORD error = GetLastError();
-        if (error != ERROR_CLASS_ALREADY_EXISTS) {
-            log(ASTRA_LOG_LEVEL_ERROR) << "Failed to register CDC window class: " << error << endLog;
-            return;
-        }
+    if (action != CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL && action != CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL) {
+        return ERROR_SUCCESS;
     }
 
-    m_hWnd = CreateWindowA(wc.lpszClassName, "AstraCDCDeviceManager", 0,
-        0, 0, 0, 0, nullptr, nullptr, wc.hInstance, this);
-    if (!m_hWnd) {
-        const DWORD error = GetLastError();
-        log(ASTRA_LOG_LEVEL_ERROR) << "Failed to create CDC window: " << error << endLog;
-        return;
-    }
-
-    DEV_BROADCAST_DEVICEINTERFACE_A dbi = {};
-    dbi.dbcc_size = sizeof(dbi);
-    dbi.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
-    dbi.dbcc_classguid = GUID_DEVINTERFACE_USB_DEVICE;
-
-    m_hDevNotify = RegisterDeviceNotificationA(m_hWnd, &dbi, DEVICE_NOTIFY_WINDOW_HANDLE);
-    if (!m_hDevNotify) {
-        log(ASTRA_LOG_LEVEL_WARNING) << "Failed to register CDC device notifications: " << GetLastError() << endLog;
-    }
-
-    MSG msg;
-    while (GetMessage(&msg, nullptr, 0, 0) > 0) {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
-    }
-}
-
-LRESULT CALLBACK WinUSBCDCTransport::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
-{
-    ASTRA_LOG;
-
-    if (message == WM_CREATE) {
-        auto *create = reinterpret_cast<CREATESTRUCT *>(lParam);
-        SetWindowLongPtr(hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(create->lpCreateParams));
-        return DefWindowProc(hWnd, message, wParam, lParam);
-    }
-
-    if (message == WM_DEVICECHANGE) {
-        auto *handler = reinterpret_cast<WinUSBCDCTransport *>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
-        if (handler && (wParam == DBT_DEVICEARRIVAL || wParam == DBT_DEVICEREMOVECOMPLETE)) {
-            handler->OnDeviceChange();
-        }
+    // Runs on a system thread pool thread: queue the event and return,
+    // leaving the SetupDi reads to the enumeration worker.
+    auto *transport = static_cast<WinUSBCDCTransport *>(context);
+    {
+        std::lock_guard<std::mutex> lock(transport->m_pendingDevicesMutex);
+        transport->m_portEvents.push_back({action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL,
+            eventData->u.DeviceInterface.SymbolicLink});
+        transport->m_hasPendingDevices.store(true);
     }
+    transport->m_pendingDevicesCV.notify_one();
 
-    return DefWindowProc(hWnd, message, wParam, lParam);
-}
-
-void WinUSBCDCTransport::OnDeviceChange()
-{
-    ASTRA_LOG;
-
-    m_hasPendingDevices.store(true);
-    m_pendingDevicesCV.notify_one();
+    return ERROR_SUCCESS;
 }
 
 void WinUSBCDCTransport::DeviceEnumerationWorker()
@@ -162,9 +121,14 @@ void WinUSBCDCTransport::DeviceEnumerationWorker()
     while (m_enumerationThreadRunning.load()) {
         {
             std::unique_lock<std::mutex> lock(m_pendingDevicesMutex);
-            m_pendingDevicesCV.wait(lock, [this] {
+            auto ready = [this] {
                 return m_hasPendingDevices.load() || !m_enumerationThreadRunning.load();
-            });
+            };
+            if (m_notification) {
+                m_pendingDevicesCV.wait(lock, ready);
+            } else {
+                m_pendingDevicesCV.wait_for(lock, kSweepInterval, ready);
+            }
 
             if (!m_enumerationThreadRunning.load()) {
                 break;
@@ -181,29 +145,82 @@ void WinUSBCDCTransport::ProcessPendingDevices()
 {
     ASTRA_LOG;
 
+    std::vector<PortEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingDevicesMutex);
+        events.swap(m_portEvents);
+    }
+
+    if (!m_notification) {
+        SweepPorts();
+    } else if (!events.empty()) {
+        // Let a new port's friendly name settle before reading it.
+        if (std::any_of(events.begin(), events.end(), [](const PortEvent &event) { return event.m_arrival; })) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        for (const auto &event : events) {
+            ApplyPortEvent(event);
+        }
+    }
+
+    OfferPorts();
+}
+
+void WinUSBCDCTransport::ApplyPortEvent(const PortEvent &event)
+{
+    ASTRA_LOG;
+
+    const std::wstring key = NormalizeSymbolicLink(event.m_symbolicLink);
+    if (event.m_arrival) {
+        if (auto port = ReadInterfaceIdentity(event.m_symbolicLink); port.has_value()) {
+            m_ports[key] = std::move(port.value());
+        }
+        return;
+    }
+
+    const auto it = m_ports.find(key);
+    if (it != m_ports.end()) {
+        // Let a genuine re-plug of the same port be detected.
+        RemoveActiveDevice(it->second.m_port);
+        m_ports.erase(it);
+    }
+}
+
+void WinUSBCDCTransport::SweepPorts()
+{
+    ASTRA_LOG;
+
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
-    const auto ports = EnumerateMatchingPorts();
+    m_ports.clear();
+    for (auto &port : EnumerateMatchingPorts()) {
+        const std::wstring key(port.m_port.begin(), port.m_port.end());
+        m_ports[key] = std::move(port);
+    }
 
-    // Build the set of currently-present normalized port names so we can purge
-    // stale entries from m_activeDevices. This allows genuine re-plugs to be
-    // detected after a device physically disconnects.
+    // Purge ports which are gone so that genuine re-plugs are detected after
+    // a device physically disconnects.
     std::set<std::string> presentPorts;
-    for (const auto &enumeratedPort : ports) {
-        presentPorts.insert(NormalizePortPath(enumeratedPort.m_port));
+    for (const auto &[key, port] : m_ports) {
+        presentPorts.insert(NormalizePortPath(port.m_port));
     }
-    {
-        std::lock_guard<std::mutex> lock(m_activeDevicesMutex);
-        for (auto it = m_activeDevices.begin(); it != m_activeDevices.end(); ) {
-            if (presentPorts.find(*it) == presentPorts.end()) {
-                it = m_activeDevices.erase(it);
-            } else {
-                ++it;
-            }
+    std::lock_guard<std::mutex> lock(m_activeDevicesMutex);
+    for (auto it = m_activeDevices.begin(); it != m_activeDevices.end(); ) {
+        if (presentPorts.find(*it) == presentPorts.end()) {
+            it = m_activeDevices.erase(it);
+        } else {
+            ++it;
         }
     }
+}
 
-    for (const auto &enumeratedPort : ports) {
+void WinUSBCDCTransport::OfferPorts()
+{
+    ASTRA_LOG;
+
+    // Ports seen before are offered again from the cache once their device
+    // closes, without asking SetupDi again.
+    for (const auto &[key, enumeratedPort] : m_ports) {
         const std::string port = NormalizePortPath(enumeratedPort.m_port);
         if (!IsValidPort(port)) {
             continue;
@@ -217,7 +234,7 @@ void WinUSBCDCTransport::ProcessPendingDevices()
             m_activeDevices.insert(port);
         }
 
-        std::unique_ptr<USBDevice> usbDevice = std::make_unique<WinUSBCDCDevice>(port,
+        std::unique_ptr<USBDevice> usbDevice = std::make_unique<WinUSBCDCDevice>(port, m_completionPort,
             enumeratedPort.m_vendorId, enumeratedPort.m_productId, enumeratedPort.m_numInterfaces);
         if (m_deviceAddedCallback) {
             try {
@@ -231,62 +248,144 @@ void WinUSBCDCTransport::ProcessPendingDevices()
     }
 }
 
-std::vector<WinUSBCDCTransport::EnumeratedPort> WinUSBCDCTransport::EnumerateMatchingPorts() const
+std::vector<std::wstring> WinUSBCDCTransport::EnumerateComPortInterfaces() const
 {
     ASTRA_LOG;
 
-    std::vector<EnumeratedPort> ports;
+    std::vector<std::wstring> symbolicLinks;
 
-    HDEVINFO deviceInfoSet = SetupDiGetClassDevs(&GUID_DEVCLASS_PORTS, nullptr, nullptr, DIGCF_PRESENT);
+    HDEVINFO deviceInfoSet = SetupDiGetClassDevsW(&GUID_DEVINTERFACE_COMPORT, nullptr, nullptr,
+        DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
     if (deviceInfoSet == INVALID_HANDLE_VALUE) {
-        return ports;
+        return symbolicLinks;
     }
 
-    SP_DEVINFO_DATA deviceInfoData = {};
-    deviceInfoData.cbSize = sizeof(deviceInfoData);
-
-    for (DWORD index = 0; SetupDiEnumDeviceInfo(deviceInfoSet, index, &deviceInfoData); ++index) {
-        char friendlyName[512] = {};
-        DWORD regType = 0;
+    SP_DEVICE_INTERFACE_DATA interfaceData = {};
+    interfaceData.cbSize = sizeof(interfaceData);
+    for (DWORD index = 0; SetupDiEnumDeviceInterfaces(deviceInfoSet, nullptr, &GUID_DEVINTERFACE_COMPORT,
+            index, &interfaceData); ++index)
+    {
         DWORD requiredSize = 0;
-
-        if (!SetupDiGetDeviceRegistryPropertyA(deviceInfoSet, &deviceInfoData, SPDRP_FRIENDLYNAME,
-                &regType, reinterpret_cast<PBYTE>(friendlyName), sizeof(friendlyName), &requiredSize)) {
+        SetupDiGetDeviceInterfaceDetailW(deviceInfoSet, &interfaceData, nullptr, 0, &requiredSize, nullptr);
+        if (requiredSize == 0) {
             continue;
         }
 
-        const std::string port = ExtractComPortFromFriendlyName(friendlyName);
-        if (port.empty()) {
-            continue;
+        std::vector<uint8_t> buffer(requiredSize);
+        auto *detail = reinterpret_cast<SP_DEVICE_INTERFACE_DETAIL_DATA_W *>(buffer.data());
+        detail->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W);
+        if (SetupDiGetDeviceInterfaceDetailW(deviceInfoSet, &interfaceData, detail, requiredSize, nullptr, nullptr)) {
+            symbolicLinks.emplace_back(detail->DevicePath);
         }
+    }
+
+    SetupDiDestroyDeviceInfoList(deviceInfoSet);
+    return symbolicLinks;
+}
+
+std::optional<WinUSBCDCTransport::EnumeratedPort> WinUSBCDCTransport::ReadInterfaceIdentity(
+    const std::wstring &symbolicLink) const
+{
+    ASTRA_LOG;
+
+    // A device info set holding just this interface's device, so the cost
+    // does not grow with the number of ports attached.
+    HDEVINFO deviceInfoSet = SetupDiCreateDeviceInfoList(nullptr, nullptr);
+    if (deviceInfoSet == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
 
-        uint16_t detectedVid = 0;
-        uint16_t detectedPid = 0;
-        uint8_t detectedNumInterfaces = 0;
-        char hardwareIds[1024] = {};
-        if (SetupDiGetDeviceRegistryPropertyA(deviceInfoSet, &deviceInfoData, SPDRP_HARDWAREID,
-                &regType, reinterpret_cast<PBYTE>(hardwareIds), sizeof(hardwareIds), &requiredSize)) {
-            const std::string hwId(hardwareIds);
-            ExtractVidPid(hwId, detectedVid, detectedPid);
-            std::string upper = hwId;
-            std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) {
-                return static_cast<char>(std::toupper(c));
-            });
-            detectedNumInterfaces = (upper.find("MI_") != std::string::npos) ? uint8_t{2} : uint8_t{1};
+    std::optional<EnumeratedPort> port;
+    SP_DEVICE_INTERFACE_DATA interfaceData = {};
+    interfaceData.cbSize = sizeof(interfaceData);
+    if (SetupDiOpenDeviceInterfaceW(deviceInfoSet, symbolicLink.c_str(), 0, &interfaceData)) {
+        DWORD requiredSize = 0;
+        SetupDiGetDeviceInterfaceDetailW(deviceInfoSet, &interfaceData, nullptr, 0, &requiredSize, nullptr);
+        if (requiredSize > 0) {
+            std::vector<uint8_t> buffer(requiredSize);
+            auto *detail = reinterpret_cast<SP_DEVICE_INTERFACE_DETAIL_DATA_W *>(buffer.data());
+            detail->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W);
+            SP_DEVINFO_DATA deviceInfoData = {};
+            deviceInfoData.cbSize = sizeof(deviceInfoData);
+            if (SetupDiGetDeviceInterfaceDetailW(deviceInfoSet, &interfaceData, detail, requiredSize, nullptr,
+                    &deviceInfoData))
+            {
+                port = ReadPortIdentity(deviceInfoSet, deviceInfoData);
+            }
         }
+    } else {
+        log(ASTRA_LOG_LEVEL_DEBUG) << "Failed to open COM port interface: " << GetLastError() << endLog;
+    }
+
+    SetupDiDestroyDeviceInfoList(deviceInfoSet);
+    return port;
+}
 
-        bool vidPidMatches = m_supportedDevices.empty();
-        if (!vidPidMatches && (detectedVid != 0 || detectedPid != 0)) {
-            for (const auto& [vid, pid] : m_supportedDevices) {
-                if (detectedVid == vid && detectedPid == pid) {
-                    vidPidMatches = true;
-                    break;
-                }
+std::optional<WinUSBCDCTransport::EnumeratedPort> WinUSBCDCTransport::ReadPortIdentity(HDEVINFO deviceInfoSet,
+    SP_DEVINFO_DATA &deviceInfoData) const
+{
+    char friendlyName[512] = {};
+    DWORD regType = 0;
+    DWORD requiredSize = 0;
+
+    if (!SetupDiGetDeviceRegistryPropertyA(deviceInfoSet, &deviceInfoData, SPDRP_FRIENDLYNAME,
+            &regType, reinterpret_cast<PBYTE>(friendlyName), sizeof(friendlyName), &requiredSize)) {
+        return std::nullopt;
+    }
+
+    const std::string port = ExtractComPortFromFriendlyName(friendlyName);
+    if (port.empty()) {
+        return std::nullopt;
+    }
+
+    uint16_t detectedVid = 0;
+    uint16_t detectedPid = 0;
+    uint8_t detectedNumInterfaces = 0;
+    char hardwareIds[1024] = {};
+    if (SetupDiGetDeviceRegistryPropertyA(deviceInfoSet, &deviceInfoData, SPDRP_HARDWAREID,
+            &regType, reinterpret_cast<PBYTE>(hardwareIds), sizeof(hardwareIds), &requiredSize)) {
+        const std::string hwId(hardwareIds);
+        ExtractVidPid(hwId, detectedVid, detectedPid);
+        std::string upper = hwId;
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) {
+            return static_cast<char>(std::toupper(c));
+        });
+        detectedNumInterfaces = (upper.find("MI_") != std::string::npos) ? uint8_t{2} : uint8_t{1};
+    }
+
+    bool vidPidMatches = m_supportedDevices.empty();
+    if (!vidPidMatches && (detectedVid != 0 || detectedPid != 0)) {
+        for (const auto& [vid, pid] : m_supportedDevices) {
+            if (detectedVid == vid && detectedPid == pid) {
+                vidPidMatches = true;
+                break;
             }
         }
+    }
+
+    if (!vidPidMatches) {
+        return std::nullopt;
+    }
+    return EnumeratedPort{port, detectedVid, detectedPid, detectedNumInterfaces};
+}
+
+std::vector<WinUSBCDCTransport::EnumeratedPort> WinUSBCDCTransport::EnumerateMatchingPorts() const
+{
+    ASTRA_LOG;
 
-        if (vidPidMatches) {
-            ports.push_back({port, detectedVid, detectedPid, detectedNumInterfaces});
+    std::vector<EnumeratedPort> ports;
+
+    HDEVINFO deviceInfoSet = SetupDiGetClassDevs(&GUID_DEVCLASS_PORTS, nullptr, nullptr, DIGCF_PRESENT);
+    if (deviceInfoSet == INVALID_HANDLE_VALUE) {
+        return ports;
+    }
+
+    SP_DEVINFO_DATA deviceInfoData = {};
+    deviceInfoData.cbSize = sizeof(deviceInfoData);
+
+    for (DWORD index = 0; SetupDiEnumDeviceInfo(deviceInfoSet, index, &deviceInfoData); ++index) {
+        if (auto port = ReadPortIdentity(deviceInfoSet, deviceInfoData); port.has_value()) {
+            ports.push_back(std::move(port.value()));
         }
     }
 
@@ -294,6 +393,16 @@ std::vector<WinUSBCDCTransport::EnumeratedPort> WinUSBCDCTransport::EnumerateMat
     return ports;
 }
 
+std::wstring WinUSBCDCTransport::NormalizeSymbolicLink(const std::wstring &symbolicLink)
+{
+    // Arrival and removal may report the link in different case.
+    std::wstring normalized = symbolicLink;
+    std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](wchar_t c) {
+        return static_cast<wchar_t>(std::towupper(c));
+    });
+    return normalized;
+}
+
 std::string WinUSBCDCTransport::ExtractComPortFromFriendlyName(const std::string& friendlyName)
 {
     const std::size_t openParen = friendlyName.rfind('(');
@@ -4,23 +4,28 @@
 #pragma once
 
 #include <windows.h>
-#include <dbt.h>
+#include <cfgmgr32.h>
+#include <setupapi.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "usb_cdc_transport.hpp"
+#include "win_cdc_completion_port.hpp"
 
 class WinUSBCDCTransport : public USBCDCTransport {
 public:
     explicit WinUSBCDCTransport(bool usbDebug)
-        : USBCDCTransport(usbDebug), m_hWnd(nullptr), m_hDevNotify(nullptr)
+        : USBCDCTransport(usbDebug), m_notification(nullptr)
     {}
     ~WinUSBCDCTransport() override;
 
@@ -38,27 +43,48 @@ private:
         uint8_t m_numInterfaces{0};
     };
 
-    void RunHotplugHandler();
-    static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
-    void OnDeviceChange();
+    // A COM port interface arrival or removal, queued by the notification
+    // callback for the enumeration worker.
+    struct PortEvent {
+        bool m_arrival;
+        std::wstring m_symbolicLink;
+    };
+
+    static DWORD CALLBACK OnNotification(HCMNOTIFICATION notification, PVOID context, CM_NOTIFY_ACTION action,
+        PCM_NOTIFY_EVENT_DATA eventData, DWORD eventDataSize);
     void DeviceEnumerationWorker();
     void ProcessPendingDevices() override;
+    void ApplyPortEvent(const PortEvent &event);
+    void SweepPorts();
+    void OfferPorts();
+    std::vector<std::wstring> EnumerateComPortInterfaces() const;
+    std::optional<EnumeratedPort> ReadInterfaceIdentity(const std::wstring &symbolicLink) const;
+    std::optional<EnumeratedPort> ReadPortIdentity(HDEVINFO deviceInfoSet, SP_DEVINFO_DATA &deviceInfoData) const;
     std::vector<EnumeratedPort> EnumerateMatchingPorts() const;
     std::string NormalizePortPath(const std::string& portPath) const override;
 
     static std::string ExtractComPortFromFriendlyName(const std::string& friendlyName);
     static bool ExtractVidPid(const std::string& hardwareId, uint16_t &vendorId, uint16_t &productId);
+    static std::wstring NormalizeSymbolicLink(const std::wstring &symbolicLink);
+
+    // Without notifications (registration failed), sweep the ports this often.
+    static constexpr std::chrono::milliseconds kSweepInterval{1000};
 
-    HWND m_hWnd;
-    HDEVNOTIFY m_hDevNotify;
+    HCMNOTIFICATION m_notification;
 
-    std::thread m_hotplugThread;
     std::thread m_deviceEnumerationThread;
     std::atomic<bool> m_enumerationThreadRunning{false};
     std::atomic<bool> m_hasPendingDevices{false};
     std::mutex m_pendingDevicesMutex;
     std::condition_variable m_pendingDevicesCV;
+    std::vector<PortEvent> m_portEvents;
+
+    // Matching ports by interface symbolic link, read once on arrival.
+    // Only touched by the enumeration worker.
+    std::map<std::wstring, EnumeratedPort> m_ports;
 
     std::set<std::string> m_activeDevices;
     std::mutex m_activeDevicesMutex;
+
+    std::shared_ptr<WinCDCCompletionPort> m_completionPort = std::make_shared<WinCDCCompletionPort>();
 };
@@ -111,6 +111,8 @@ int main(int argc, char* argv[])
         ("T,temp-dir", "Temporary directory", cxxopts::value<std::string>()->default_value(""))
         ("M,manifest", "Manifest file path", cxxopts::value<std::string>())
         ("u,usb-debug", "Enable USB debug logging", cxxopts::value<bool>()->default_value("false"))
+        ("trace", "Write a Chrome/Perfetto trace of the session next to the log file", cxxopts::value<bool>()->default_value("false"))
+        ("merge-device-logs", "In continuous mode, also copy per-device log lines into the main log", cxxopts::value<bool>()->default_value("false"))
         ("S,simple-progress", "Disable progress bars and report progress messages", cxxopts::value<bool>()->default_value("false"))
         ("o,boot-command", "Boot command", cxxopts::value<std::string>()->default_value(""))
         ("boot-image", "Boot Image Path", cxxopts::value<std::string>())
@@ -155,6 +157,8 @@ int main(int argc, char* argv[])
     bool exitOnError = result["exit-on-error"].as<bool>();
     AstraLogLevel logLevel = debug ?  ASTRA_LOG_LEVEL_DEBUG : ASTRA_LOG_LEVEL_INFO;
     bool usbDebug = result["usb-debug"].as<bool>();
+    bool trace = result["trace"].as<bool>();
+    bool mergeDeviceLogs = result["merge-device-logs"].as<bool>();
     bool simpleProgress = result["simple-progress"].as<bool>();
     std::string bootCommand = result["boot-command"].as<std::string>();
     std::string filterPorts = result["port"].as<std::string>();
@@ -181,7 +185,7 @@ int main(int argc, char* argv[])
 
     std::cout << "Astra Boot\n" << std::endl;
 
-    AstraDeviceManager deviceManager(AstraDeviceManagerResponseCallback, continuous, logLevel, logFilePath, tempDir, filterPorts, usbDebug);
+    AstraDeviceManager deviceManager(AstraDeviceManagerResponseCallback, continuous, logLevel, logFilePath, tempDir, filterPorts, usbDebug, trace, mergeDeviceLogs);
 
     try {
         deviceManager.Boot(bootImagePath, bootCommand, bootStage);
@@ -246,7 +250,11 @@ int main(int argc, char* argv[])
     }
     indicators::show_console_cursor(true);
 
-    if (deviceManager.Shutdown()) {
+    const bool failed = deviceManager.Shutdown();
+    if (trace) {
+        std::cout << "Trace written to: " << deviceManager.GetTraceFile() << std::endl;
+    }
+    if (failed) {
         std::cerr << "Error reported: please check the log file for more information: " << deviceManager.GetLogFile() << std::endl;
         return -1;
     }
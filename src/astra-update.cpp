@@ -1,40 +1,32 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2025 Synaptics Incorporated
 
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <vector>
 #include <queue>
 #include <condition_variable>
 #include <functional>
 #include <cxxopts.hpp>
-#include <indicators/progress_bar.hpp>
-#include <indicators/dynamic_progress.hpp>
-#include <unordered_map>
+#include <indicators/cursor_control.hpp>
 #include <csignal>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <sstream>
 
 #include "astra_device_manager.hpp"
 #include "flash_image.hpp"
 #include "astra_device.hpp"
+#include "job_channel.hpp"
+#include "progress_display.hpp"
 
 const std::string astraUpdateVersion = "2.0.2";
 
-// Define a struct to hold the two strings
-struct DeviceImageKey {
-    std::string deviceName;
-    std::string imageName;
-
-    bool operator==(const DeviceImageKey& other) const {
-        return deviceName == other.deviceName && imageName == other.imageName;
-    }
-};
-
-// Implement a custom hash function for the struct
-struct DeviceImageKeyHash {
-    std::size_t operator()(const DeviceImageKey& key) const {
-        return std::hash<std::string>()(key.deviceName) ^ std::hash<std::string>()(key.imageName);
-    }
-};
-
 std::queue<AstraDeviceManagerResponse> managerResponses;
 std::condition_variable managerResponsesCV;
 std::mutex managerResponsesMutex;
@@ -47,37 +39,27 @@ void AstraDeviceManagerResponseCallback(AstraDeviceManagerResponse response)
     managerResponsesCV.notify_one();
 }
 
-void UpdateProgressBars(DeviceResponse &deviceResponse,
-    indicators::DynamicProgress<indicators::ProgressBar> &dynamicProgress,
-    std::unordered_map<DeviceImageKey, size_t, DeviceImageKeyHash> &progressBars)
+// Console line for a device status; empty for image progress, which the
+// progress display or UpdateSimpleProgress() shows.
+std::string DeviceStatusMessage(const DeviceResponse &deviceResponse)
 {
-    DeviceImageKey key{deviceResponse.m_deviceName, deviceResponse.m_imageName};
-
-    // Ensure a progress bar exists for this image
-    if (progressBars.find(key) == progressBars.end()) {
-        auto progress_bar = std::make_unique<indicators::ProgressBar>(
-            indicators::option::BarWidth{50},
-            indicators::option::Start{"["},
-            indicators::option::Fill{"="},
-            indicators::option::Lead{">"},
-            indicators::option::Remainder{" "},
-            indicators::option::End{"]"},
-            indicators::option::PostfixText{deviceResponse.m_imageName},
-            indicators::option::PrefixText{deviceResponse.m_deviceName + ": "},
-            indicators::option::ForegroundColor{indicators::Color::green},
-            indicators::option::ShowElapsedTime{true},
-            indicators::option::ShowRemainingTime{true},
-            indicators::option::MaxProgress{100}
-        );
-        size_t bardId = dynamicProgress.push_back(std::move(progress_bar));
-        progressBars[key] = bardId;
-    }
-
-    auto& progressBar = dynamicProgress[progressBars[key]];
-    progressBar.set_progress(deviceResponse.m_progress);
-
-    if (deviceResponse.m_progress == 100) {
-        progressBar.mark_as_completed();
+    switch (deviceResponse.m_status) {
+    case ASTRA_DEVICE_STATUS_ADDED:
+        return "Detected Device: " + deviceResponse.m_deviceName;
+    case ASTRA_DEVICE_STATUS_BOOT_START:
+        return "Booting Device: " + deviceResponse.m_deviceName;
+    case ASTRA_DEVICE_STATUS_BOOT_COMPLETE:
+        return "Booting " + deviceResponse.m_deviceName + " is complete";
+    case ASTRA_DEVICE_STATUS_UPDATE_START:
+        return "Updating Device: " + deviceResponse.m_deviceName;
+    case ASTRA_DEVICE_STATUS_UPDATE_COMPLETE:
+        return "Device: " + deviceResponse.m_deviceName + " Update Complete";
+    case ASTRA_DEVICE_STATUS_BOOT_FAIL:
+        return "Device: " + deviceResponse.m_deviceName + " Boot Failed: " + deviceResponse.m_message;
+    case ASTRA_DEVICE_STATUS_UPDATE_FAIL:
+        return "Device: " + deviceResponse.m_deviceName + " Update Failed: " + deviceResponse.m_message;
+    default:
+        return "";
     }
 }
 
@@ -88,6 +70,56 @@ void UpdateSimpleProgress(DeviceResponse &deviceResponse)
                 << " Progress: " << deviceResponse.m_progress << std::endl;
 }
 
+void PrintTransferSummary(const std::vector<DeviceTransferStats> &deviceStats)
+{
+    if (deviceStats.empty()) {
+        return;
+    }
+
+    std::cout << "\nTransfer Summary:" << std::endl;
+    for (const auto &stats : deviceStats) {
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  " << stats.m_deviceName << ": "
+                  << static_cast<double>(stats.m_bytesSent) / 1e6 << " MB in " << stats.m_wallSeconds << " s ("
+                  << stats.GetMBps() << " MB/s while sending), USB write latency p50 <= "
+                  << stats.GetWriteLatencyPercentileUs(50) << " us, p99 <= "
+                  << stats.GetWriteLatencyPercentileUs(99) << " us" << std::endl;
+        if (stats.m_rebindCount > 0) {
+            std::cout << "      fastboot rebinds: " << stats.m_rebindCount << ", "
+                      << stats.m_rebindSeconds * 1000 / stats.m_rebindCount << " ms average, "
+                      << stats.m_maxRebindSeconds * 1000 << " ms max" << std::endl;
+        }
+        for (const auto &image : stats.m_images) {
+            std::cout << "      " << std::left << std::setw(32) << image.m_imageName << std::right;
+            if (image.m_skipped) {
+                std::cout << " unchanged" << std::endl;
+                continue;
+            }
+            std::cout << std::setw(10) << static_cast<double>(image.m_bytes) / 1e6 << " MB "
+                      << std::setw(8) << image.m_seconds << " s "
+                      << std::setw(8) << image.GetMBps() << " MB/s  first write "
+                      << image.m_firstWriteLatencyMs << " ms" << std::endl;
+        }
+    }
+    std::cout << std::defaultfloat;
+}
+
+void PrintHubSummary(const std::vector<BusTransferStats> &hubStats)
+{
+    if (hubStats.empty()) {
+        return;
+    }
+
+    std::cout << "\nUSB Hub Throughput:" << std::endl;
+    for (const auto &stats : hubStats) {
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  " << std::left << std::setw(16) << stats.m_hub << std::right << " "
+                  << stats.m_devices << " device(s), " << static_cast<double>(stats.m_bytes) / 1e6 << " MB in "
+                  << stats.m_busySeconds << " s busy (" << stats.GetMBps() << " MB/s)" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
 void SignalHandler(int signal)
 {
     if (signal == SIGINT) {
@@ -96,6 +128,409 @@ void SignalHandler(int signal)
     }
 }
 
+// Settings of one update job.  Daemon and --jobs lines start from the
+// command line settings and may override them.
+struct JobSettings {
+    std::string flashImagePath;
+    std::string manifest;
+    std::string filterPorts;
+    std::string bootImagesPath;
+    std::map<std::string, std::string> config;
+    unsigned timeoutSeconds = 0;
+};
+
+// A loaded flash image kept between jobs, valid while its files are unchanged.
+struct CachedFlashImage {
+    std::string key;
+    std::string stamp;
+    std::shared_ptr<FlashImage> flashImage;
+};
+
+constexpr int kDaemonPollMs = 100;
+constexpr size_t kMaxCachedFlashImages = 4;
+
+// Job lines are a command followed by key=value words.  Values containing
+// spaces or quotes are double-quoted, with \" \\ and \n escapes.
+std::string QuoteJobValue(const std::string &value)
+{
+    if (!value.empty() && value.find_first_of(" \t\"\\\n\r") == std::string::npos) {
+        return value;
+    }
+
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (c == '\n') {
+            quoted += "\\n";
+        } else if (c != '\r') {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+bool ParseJobLine(const std::string &line, std::string &command, std::map<std::string, std::string> &args)
+{
+    std::vector<std::string> words;
+    std::string word;
+    bool inWord = false;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quoted) {
+            if (c == '\\' && i + 1 < line.size()) {
+                const char next = line[++i];
+                word += next == 'n' ? '\n' : next;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                word += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+            inWord = true;
+        } else if (c == ' ' || c == '\t') {
+            if (inWord) {
+                words.push_back(word);
+                word.clear();
+                inWord = false;
+            }
+        } else {
+            word += c;
+            inWord = true;
+        }
+    }
+    if (quoted) {
+        return false;
+    }
+    if (inWord) {
+        words.push_back(word);
+    }
+    if (words.empty()) {
+        return false;
+    }
+
+    command = words[0];
+    for (size_t i = 1; i < words.size(); ++i) {
+        const size_t equals = words[i].find('=');
+        if (equals == std::string::npos || equals == 0) {
+            return false;
+        }
+        args[words[i].substr(0, equals)] = words[i].substr(equals + 1);
+    }
+    return true;
+}
+
+bool ParseJobFlag(const std::string &value)
+{
+    return value == "1" || value == "true" || value == "yes" || value == "enable";
+}
+
+// Apply the key=value words of a job line to settings.
+bool ApplyJobArgs(const std::map<std::string, std::string> &args, JobSettings &settings, std::string &error)
+{
+    static const std::map<std::string, std::string> configKeys = {
+        {"board", "board"}, {"chip", "chip"}, {"boot-image-id", "boot_image"}, {"image-type", "image_type"},
+        {"secure-boot", "secure_boot"}, {"memory-layout", "memory_layout"}, {"ddr-type", "ddr_type"},
+    };
+    for (const auto &[name, value] : args) {
+        if (name == "flash") {
+            settings.flashImagePath = value;
+        } else if (name == "manifest") {
+            settings.manifest = value;
+        } else if (name == "port") {
+            settings.filterPorts = value;
+        } else if (name == "timeout") {
+            settings.timeoutSeconds = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (name == "delta" || name == "verify") {
+            if (ParseJobFlag(value)) {
+                settings.config[name] = "enable";
+            } else {
+                settings.config.erase(name);
+            }
+        } else if (name == "disable-reset") {
+            settings.config["reset"] = ParseJobFlag(value) ? "disable" : "enable";
+        } else if (configKeys.count(name)) {
+            settings.config[configKeys.at(name)] = value;
+        } else {
+            error = "Unknown job setting: " + name;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Modification time of the flash image path and size and time of each image.
+std::string FlashImageStamp(const std::string &flashImagePath, const FlashImage *flashImage)
+{
+    std::ostringstream stamp;
+    std::error_code ec;
+    stamp << std::filesystem::last_write_time(flashImagePath, ec).time_since_epoch().count();
+    if (flashImage != nullptr) {
+        for (const auto &image : flashImage->GetImages()) {
+            stamp << " " << std::filesystem::file_size(image.GetFilePath(), ec)
+                  << ":" << std::filesystem::last_write_time(image.GetFilePath(), ec).time_since_epoch().count();
+        }
+    }
+    return stamp.str();
+}
+
+std::shared_ptr<FlashImage> LoadCachedFlashImage(std::list<CachedFlashImage> &cache, const std::string &flashImagePath,
+    std::map<std::string, std::string> config, const std::string &manifest, std::string &error)
+{
+    std::string key = flashImagePath + "\n" + manifest;
+    for (const auto &[name, value] : config) {
+        key += "\n" + name + "=" + value;
+    }
+
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->key == key) {
+            if (it->stamp == FlashImageStamp(flashImagePath, it->flashImage.get())) {
+                cache.splice(cache.begin(), cache, it);
+                return cache.front().flashImage;
+            }
+            cache.erase(it);
+            break;
+        }
+    }
+
+    std::shared_ptr<FlashImage> flashImage;
+    try {
+        flashImage = FlashImage::FlashImageFactory(flashImagePath, config, manifest);
+    } catch (const std::exception& e) {
+        error = std::string("Failed to load flash image: ") + e.what();
+        return nullptr;
+    }
+    if (flashImage->Load() < 0) {
+        error = "Failed to load flash image";
+        return nullptr;
+    }
+
+    cache.push_front(CachedFlashImage{key, FlashImageStamp(flashImagePath, flashImage.get()), flashImage});
+    if (cache.size() > kMaxCachedFlashImages) {
+        cache.pop_back();
+    }
+    return flashImage;
+}
+
+// Forward a manager response to the client.  Sets failure for a failed device.
+void SendJobResponse(JobChannel &channel, const AstraDeviceManagerResponse &response, std::string &failure)
+{
+    std::ostringstream line;
+    if (response.IsDeviceManagerResponse()) {
+        const auto &managerResponse = response.GetDeviceManagerResponse();
+        if (managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_SHUTDOWN) {
+            return;
+        }
+        line << (managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_FAILURE ? "error" : "info")
+             << " message=" << QuoteJobValue(managerResponse.m_managerMessage);
+        if (managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_FAILURE) {
+            failure = managerResponse.m_managerMessage;
+        }
+    } else if (response.IsDeviceStatsResponse()) {
+        const auto &stats = response.GetDeviceStatsResponse();
+        line << "stats name=" << QuoteJobValue(stats.m_deviceName) << " bytes=" << stats.m_bytesSent
+             << " seconds=" << stats.m_wallSeconds << " mbps=" << stats.GetMBps();
+    } else if (response.IsDeviceResponse()) {
+        const auto &deviceResponse = response.GetDeviceResponse();
+        std::string status = AstraDevice::AstraDeviceStatusToString(deviceResponse.m_status);
+        status.erase(0, std::string("ASTRA_DEVICE_STATUS_").size());
+        line << "device name=" << QuoteJobValue(deviceResponse.m_deviceName) << " status=" << status;
+        if (!deviceResponse.m_imageName.empty()) {
+            line << " image=" << QuoteJobValue(deviceResponse.m_imageName) << " progress=" << deviceResponse.m_progress;
+        }
+        if (!deviceResponse.m_message.empty()) {
+            line << " message=" << QuoteJobValue(deviceResponse.m_message);
+        }
+        if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_BOOT_FAIL ||
+            deviceResponse.m_status == ASTRA_DEVICE_STATUS_UPDATE_FAIL)
+        {
+            failure = deviceResponse.m_deviceName + ": " + deviceResponse.m_message;
+        }
+    }
+    channel.WriteLine(line.str());
+}
+
+// Run one update job until its device completes or fails, then report the result.
+void RunDaemonJob(AstraDeviceManager &deviceManager, JobChannel &channel, const std::map<std::string, std::string> &args,
+    const JobSettings &defaults, std::list<CachedFlashImage> &flashImageCache)
+{
+    JobSettings settings = defaults;
+    std::string failure;
+    if (!ApplyJobArgs(args, settings, failure)) {
+        channel.WriteLine("result status=fail message=" + QuoteJobValue(failure));
+        return;
+    }
+    const std::string &filterPorts = settings.filterPorts;
+    const unsigned timeoutSeconds = settings.timeoutSeconds;
+
+    std::cout << "Job: " << settings.flashImagePath << (filterPorts.empty() ? "" : " on port " + filterPorts) << std::endl;
+
+    std::shared_ptr<FlashImage> flashImage = LoadCachedFlashImage(flashImageCache, settings.flashImagePath,
+        settings.config, settings.manifest, failure);
+    if (!flashImage) {
+        std::cout << "Job failed: " << failure << std::endl;
+        channel.WriteLine("result status=fail message=" + QuoteJobValue(failure));
+        return;
+    }
+
+    {
+        // Anything left over belongs to the previous job.
+        std::lock_guard<std::mutex> lock(managerResponsesMutex);
+        managerResponses = {};
+    }
+
+    deviceManager.SetFilterPorts(filterPorts);
+    try {
+        deviceManager.Update(flashImage, defaults.bootImagesPath);
+    } catch (const std::exception& e) {
+        deviceManager.EndRun();
+        channel.WriteLine("result status=fail message=" + QuoteJobValue(std::string("Failed to initialize update: ") + e.what()));
+        return;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
+    bool finished = false;
+    bool clientGone = false;
+    while (!finished && failure.empty()) {
+        std::vector<AstraDeviceManagerResponse> responses;
+        {
+            std::unique_lock<std::mutex> lock(managerResponsesMutex);
+            managerResponsesCV.wait_for(lock, std::chrono::milliseconds(kDaemonPollMs),
+                []{ return !managerResponses.empty() || !running.load(); });
+            while (!managerResponses.empty()) {
+                responses.push_back(managerResponses.front());
+                managerResponses.pop();
+            }
+        }
+
+        for (const auto &response : responses) {
+            if (response.IsDeviceManagerResponse() &&
+                response.GetDeviceManagerResponse().m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_SHUTDOWN)
+            {
+                finished = true;
+            }
+            SendJobResponse(channel, response, failure);
+        }
+
+        if (!running.load()) {
+            failure = "Daemon is shutting down";
+        } else if (!channel.Poll(0)) {
+            // Nobody is waiting for the result any more; free the port for the next job.
+            clientGone = true;
+            failure = "Client disconnected";
+        } else if (timeoutSeconds > 0 && std::chrono::steady_clock::now() >= deadline) {
+            failure = "Timed out";
+        }
+    }
+
+    const bool runFailed = deviceManager.EndRun();
+    if (failure.empty() && runFailed) {
+        failure = "Error reported: please check the log file for more information: " + deviceManager.GetLogFile();
+    }
+
+    std::cout << "Job " << (failure.empty() ? "complete" : "failed: " + failure) << std::endl;
+    if (!clientGone) {
+        channel.WriteLine(failure.empty() ? "result status=ok" : "result status=fail message=" + QuoteJobValue(failure));
+    }
+}
+
+// Keep the device manager, its transports and the loaded images resident and
+// run update jobs sent over socketPath, one at a time.
+int RunDaemon(AstraDeviceManager &deviceManager, const std::string &socketPath, const JobSettings &defaults)
+{
+    JobChannel channel;
+    if (!channel.Listen(socketPath)) {
+        return -1;
+    }
+    std::cout << "Waiting for jobs on " << socketPath << "\n" << std::endl;
+
+    std::list<CachedFlashImage> flashImageCache;
+    while (running.load()) {
+        if (!channel.WaitForClient(kDaemonPollMs)) {
+            continue;
+        }
+
+        std::string line;
+        if (channel.HasOversizedLine()) {
+            channel.WriteLine("result status=fail message=" + QuoteJobValue("Job line exceeds " +
+                std::to_string(JobChannel::kMaxLineSize) + " bytes"));
+            channel.CloseClient();
+            continue;
+        }
+        if (!channel.ReadLine(line)) {
+            if (!channel.Poll(kDaemonPollMs)) {
+                channel.CloseClient();
+            }
+            continue;
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        std::string command;
+        std::map<std::string, std::string> args;
+        if (!ParseJobLine(line, command, args)) {
+            channel.WriteLine("result status=fail message=" + QuoteJobValue("Malformed job: " + line));
+        } else if (command == "update") {
+            RunDaemonJob(deviceManager, channel, args, defaults, flashImageCache);
+        } else {
+            channel.WriteLine("result status=fail message=" + QuoteJobValue("Unknown command: " + command));
+        }
+    }
+
+    return 0;
+}
+
+// Read the update jobs in jobsPath, one "update key=value..." line each as
+// for the daemon.  Blank lines and lines starting with # are skipped.
+bool ReadJobsFile(const std::string &jobsPath, const JobSettings &defaults, std::vector<JobSettings> &jobs)
+{
+    std::ifstream file(jobsPath);
+    if (!file) {
+        std::cerr << "Failed to open jobs file: " << jobsPath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    for (unsigned lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.find_first_not_of(" \t") == std::string::npos || line[line.find_first_not_of(" \t")] == '#') {
+            continue;
+        }
+
+        std::string command;
+        std::map<std::string, std::string> args;
+        std::string error = "Malformed job";
+        JobSettings settings = defaults;
+        if (!ParseJobLine(line, command, args) || command != "update" || !ApplyJobArgs(args, settings, error)) {
+            std::cerr << jobsPath << ":" << lineNumber << ": " << error << std::endl;
+            return false;
+        }
+        jobs.push_back(settings);
+    }
+
+    if (jobs.empty()) {
+        std::cerr << "No jobs in " << jobsPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PrintFlashImage(const FlashImage &flashImage)
+{
+    std::cout << "Update Image: " << flashImage.GetChipName() << " " << flashImage.GetBoardName() << std::endl;
+    std::cout << "    Image Type: " << AstraFlashImageTypeToString(flashImage.GetFlashImageType()) << std::endl;
+    std::cout << "    Secure Boot: " << AstraSecureBootVersionToString(flashImage.GetSecureBootVersion()) << std::endl;
+    std::cout << "    Memory Layout: " << AstraMemoryLayoutToString(flashImage.GetMemoryLayout()) << std::endl;
+    std::cout << "    DDR Type: " << AstraMemoryDDRTypeToString(flashImage.GetMemoryDDRType()) << std::endl;
+    std::cout << "    Boot Image ID: " << flashImage.GetBootImageId() << "\n" << std::endl;
+}
+
 int main(int argc, char* argv[])
 {
     cxxopts::Options options("AstraUpdate", "Astra Update Utility");
@@ -119,10 +554,36 @@ int main(int argc, char* argv[])
         ("m,memory-layout", "Memory layout", cxxopts::value<std::string>())
         ("d,ddr-type", "DDR type", cxxopts::value<std::string>()->default_value("not_specified"))
         ("u,usb-debug", "Enable USB debug logging", cxxopts::value<bool>()->default_value("false"))
+        ("trace", "Write a Chrome/Perfetto trace of the session next to the log file", cxxopts::value<bool>()->default_value("false"))
+        ("profile", "Write per-function call counts and times of the session next to the log file", cxxopts::value<bool>()->default_value("false"))
+        ("merge-device-logs", "In continuous mode, also copy per-device log lines into the main log", cxxopts::value<bool>()->default_value("false"))
+        ("max-transfers", "Maximum number of devices updating at once; others wait after booting (0 = unlimited)", cxxopts::value<unsigned>()->default_value("0"))
+        ("max-transfers-per-hub", "Maximum number of devices updating at once behind one USB hub (0 = unlimited)", cxxopts::value<unsigned>()->default_value("0"))
+        ("memory-budget", "MiB of host memory the transfer buffers of all updating devices may use; others wait (0 = unlimited)", cxxopts::value<unsigned>()->default_value("0"))
+        ("metrics", "Serve Prometheus metrics over HTTP on [host]:port, or on this Unix socket path", cxxopts::value<std::string>())
+        ("thread-policy", "Priority and CPUs of the USB, transfer and background threads, e.g. usb=realtime:2,3;transfer=high", cxxopts::value<std::string>())
+        ("broadcast", "Decompress each compressed image once for the devices sending it together; a device this many MiB behind reads it alone (0 = disabled)", cxxopts::value<unsigned>()->default_value("0"))
         ("S,simple-progress", "Disable progress bars and report progress messages", cxxopts::value<bool>()->default_value("false"))
+        ("table", "Show one status line per device instead of progress bars, for many devices", cxxopts::value<bool>()->default_value("false"))
+        ("progress-interval", "Minimum milliseconds between progress updates of a device (0 = every update)", cxxopts::value<unsigned>()->default_value("100"))
+        ("tune-transfers", "Find the fastest transfer chunk size and queue depth per USB hub and remember it", cxxopts::value<bool>()->default_value("false"))
+        ("resume-window", "Resume an update interrupted less than this many seconds ago instead of starting over (0 = disabled)", cxxopts::value<unsigned>()->default_value("0"))
+        ("image-request-timeout", "Seconds to wait for a device's next image request; a device still booting then fails", cxxopts::value<unsigned>()->default_value("10"))
         ("p,port", "Filter based on USB port", cxxopts::value<std::string>()->default_value(""))
         ("r,disable-reset", "Reset the device after a successful update", cxxopts::value<bool>()->default_value("false"))
         ("e,exit-on-error", "Exit if an error occurs when running in continuous mode", cxxopts::value<bool>()->default_value("false"))
+        ("delta", "Skip images whose manifest sha256 matches the device", cxxopts::value<bool>()->default_value("false"))
+        ("verify", "Check each update image against its manifest sha256 and the digest reported by the device", cxxopts::value<bool>()->default_value("false"))
+        ("simulate", "Update this many simulated devices instead of USB devices (0 = disabled)", cxxopts::value<unsigned>()->default_value("0"))
+        ("simulate-bandwidth", "Bulk transfer bandwidth of each simulated device in MB/s (0 = unlimited)", cxxopts::value<double>()->default_value("40"))
+        ("simulate-hub-bandwidth", "Bandwidth shared by the simulated devices behind one hub in MB/s (0 = unlimited)", cxxopts::value<double>()->default_value("0"))
+        ("simulate-hub-size", "Number of simulated devices behind each simulated hub", cxxopts::value<unsigned>()->default_value("7"))
+        ("simulate-latency", "Response latency of simulated devices in microseconds", cxxopts::value<unsigned>()->default_value("200"))
+        ("simulate-cycles", "Number of simulated devices updated on each port, one after another", cxxopts::value<unsigned>()->default_value("1"))
+        ("simulate-interrupt", "Drop each simulated fastboot device off the bus once while sending this update image (0 = never)", cxxopts::value<unsigned>()->default_value("0"))
+        ("daemon", "Stay running and accept update jobs on this Unix socket or named pipe", cxxopts::value<std::string>())
+        ("jobs", "Run the update jobs listed in this file side by side, routed by port and chip", cxxopts::value<std::string>())
+        ("pack-bundle", "Pack the eMMC flash image into this single-file bundle and exit", cxxopts::value<std::string>())
         ("v,version", "Print version");
 
     cxxopts::ParseResult result;
@@ -160,9 +621,30 @@ int main(int argc, char* argv[])
     bool exitOnError = result["exit-on-error"].as<bool>();
     AstraLogLevel logLevel = debug ?  ASTRA_LOG_LEVEL_DEBUG : ASTRA_LOG_LEVEL_INFO;
     bool usbDebug = result["usb-debug"].as<bool>();
+    bool trace = result["trace"].as<bool>();
+    bool profile = result["profile"].as<bool>();
+    bool mergeDeviceLogs = result["merge-device-logs"].as<bool>();
+    unsigned maxTransfers = result["max-transfers"].as<unsigned>();
+    unsigned maxTransfersPerHub = result["max-transfers-per-hub"].as<unsigned>();
+    unsigned memoryBudgetMiB = result["memory-budget"].as<unsigned>();
+    unsigned broadcastSlackMiB = result["broadcast"].as<unsigned>();
     bool simpleProgress = result["simple-progress"].as<bool>();
+    bool tableView = result["table"].as<bool>();
+    unsigned progressIntervalMs = result["progress-interval"].as<unsigned>();
+    bool tuneTransfers = result["tune-transfers"].as<bool>();
+    unsigned resumeWindow = result["resume-window"].as<unsigned>();
+    unsigned imageRequestTimeout = result["image-request-timeout"].as<unsigned>();
     std::string filterPorts = result["port"].as<std::string>();
 
+    AstraSimulatorConfig simulatorConfig;
+    simulatorConfig.m_deviceCount = result["simulate"].as<unsigned>();
+    simulatorConfig.m_linkMBps = result["simulate-bandwidth"].as<double>();
+    simulatorConfig.m_hubMBps = result["simulate-hub-bandwidth"].as<double>();
+    simulatorConfig.m_devicesPerHub = result["simulate-hub-size"].as<unsigned>();
+    simulatorConfig.m_latencyUs = result["simulate-latency"].as<unsigned>();
+    simulatorConfig.m_cycles = result["simulate-cycles"].as<unsigned>();
+    simulatorConfig.m_interruptImage = result["simulate-interrupt"].as<unsigned>();
+
     if (usbDebug) {
         // Use simple progress when USB debugging is enabled
         // because libusb will output to stdout and conflict with progress bars
@@ -199,45 +681,157 @@ int main(int argc, char* argv[])
     if (result.count("disable-reset")) {
         config["reset"] = result["disable-reset"].as<bool>() ? "disable" : "enable";
     }
+    if (result["delta"].as<bool>()) {
+        config["delta"] = "enable";
+    }
+    if (result["verify"].as<bool>()) {
+        config["verify"] = "enable";
+    }
 
-    // DynamicProgress to manage multiple progress bars
-    indicators::DynamicProgress<indicators::ProgressBar> dynamicProgress;
-    std::unordered_map<DeviceImageKey, size_t, DeviceImageKeyHash> progressBars;
+    if (result.count("thread-policy")) {
+        std::string error;
+        if (!AstraDeviceManager::SetThreadPolicy(result["thread-policy"].as<std::string>(), error)) {
+            std::cerr << error << std::endl;
+            return -1;
+        }
+    }
 
-    dynamicProgress.set_option(indicators::option::HideBarWhenComplete{false});
+    std::vector<DeviceTransferStats> deviceStats;
 
     std::cout << "Astra Update\n" << std::endl;
 
-    std::shared_ptr<FlashImage> flashImage;
-    try {
-        flashImage = FlashImage::FlashImageFactory(flashImagePath, config, manifest);
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to load flash image: " << e.what() << std::endl;
-        return -1;
+    if (result.count("pack-bundle")) {
+        std::string error;
+        std::list<CachedFlashImage> cache;
+        std::shared_ptr<FlashImage> flashImage = LoadCachedFlashImage(cache, flashImagePath, config, manifest, error);
+        if (!flashImage || !flashImage->WriteBundle(result["pack-bundle"].as<std::string>(), error)) {
+            std::cerr << error << std::endl;
+            return -1;
+        }
+        std::cout << "Wrote " << result["pack-bundle"].as<std::string>() << std::endl;
+        return 0;
     }
 
-    int ret = flashImage->Load();
-    if (ret < 0) {
-        std::cerr << "Failed to load flash image" << std::endl;
-        return -1;
+    JobSettings defaults{flashImagePath, manifest, filterPorts, bootImagesPath, config};
+
+    if (result.count("daemon")) {
+        if (continuous || result.count("jobs")) {
+            std::cerr << "--daemon cannot be combined with --continuous or --jobs" << std::endl;
+            return -1;
+        }
+
+        AstraDeviceManager deviceManager(AstraDeviceManagerResponseCallback, false, logLevel, logFilePath, tempDir, filterPorts, usbDebug, trace, mergeDeviceLogs, maxTransfers, maxTransfersPerHub);
+        deviceManager.SetProgressInterval(progressIntervalMs);
+        deviceManager.SetImageRequestTimeout(imageRequestTimeout);
+        if (profile) {
+            deviceManager.EnableProfiling();
+        }
+        if (simulatorConfig.m_deviceCount > 0) {
+            deviceManager.SetSimulator(simulatorConfig);
+        }
+        if (tuneTransfers) {
+            deviceManager.EnableTransferTuning();
+        }
+        if (resumeWindow > 0) {
+            deviceManager.EnableUpdateResume(resumeWindow);
+        }
+        if (memoryBudgetMiB > 0) {
+            deviceManager.SetTransferMemoryBudget(static_cast<uint64_t>(memoryBudgetMiB) * 1024 * 1024);
+        }
+        if (broadcastSlackMiB > 0) {
+            deviceManager.EnableImageBroadcast(static_cast<uint64_t>(broadcastSlackMiB) * 1024 * 1024);
+        }
+        if (result.count("metrics") && !deviceManager.EnableMetrics(result["metrics"].as<std::string>())) {
+            std::cerr << "Failed to serve metrics on " << result["metrics"].as<std::string>() << std::endl;
+            deviceManager.Shutdown();
+            return -1;
+        }
+
+        int ret = RunDaemon(deviceManager, result["daemon"].as<std::string>(), defaults);
+        if (deviceManager.Shutdown()) {
+            std::cout << "Log file: " << deviceManager.GetLogFile() << std::endl;
+        }
+        return ret;
     }
 
-    std::cout << "Update Image: " << flashImage->GetChipName() << " " << flashImage->GetBoardName() << std::endl;
-    std::cout << "    Image Type: " << AstraFlashImageTypeToString(flashImage->GetFlashImageType()) << std::endl;
-    std::cout << "    Secure Boot: " << AstraSecureBootVersionToString(flashImage->GetSecureBootVersion()) << std::endl;
-    std::cout << "    Memory Layout: " << AstraMemoryLayoutToString(flashImage->GetMemoryLayout()) << std::endl;
-    std::cout << "    DDR Type: " << AstraMemoryDDRTypeToString(flashImage->GetMemoryDDRType()) << std::endl;
-    std::cout << "    Boot Image ID: " << flashImage->GetBootImageId() << "\n" << std::endl;
+    std::vector<JobSettings> jobs;
+    if (result.count("jobs")) {
+        if (!ReadJobsFile(result["jobs"].as<std::string>(), defaults, jobs)) {
+            return -1;
+        }
+    } else {
+        jobs.push_back(defaults);
+    }
 
-    AstraDeviceManager deviceManager(AstraDeviceManagerResponseCallback, continuous, logLevel, logFilePath, tempDir, filterPorts, usbDebug);
+    // Jobs naming the same image share one loaded copy.
+    std::list<CachedFlashImage> flashImageCache;
+    std::vector<std::shared_ptr<FlashImage>> flashImages;
+    for (const auto &job : jobs) {
+        std::string error;
+        std::shared_ptr<FlashImage> flashImage = LoadCachedFlashImage(flashImageCache, job.flashImagePath,
+            job.config, job.manifest, error);
+        if (!flashImage) {
+            std::cerr << error << std::endl;
+            return -1;
+        }
+        PrintFlashImage(*flashImage);
+        flashImages.push_back(flashImage);
+    }
+
+    AstraDeviceManager deviceManager(AstraDeviceManagerResponseCallback, continuous, logLevel, logFilePath, tempDir, filterPorts, usbDebug, trace, mergeDeviceLogs, maxTransfers, maxTransfersPerHub);
+    deviceManager.SetProgressInterval(progressIntervalMs);
+    deviceManager.SetImageRequestTimeout(imageRequestTimeout);
+    if (profile) {
+        deviceManager.EnableProfiling();
+    }
+
+    if (simulatorConfig.m_deviceCount > 0) {
+        deviceManager.SetSimulator(simulatorConfig);
+    }
+    if (tuneTransfers) {
+        deviceManager.EnableTransferTuning();
+    }
+    if (resumeWindow > 0) {
+        deviceManager.EnableUpdateResume(resumeWindow);
+    }
+    if (memoryBudgetMiB > 0) {
+        deviceManager.SetTransferMemoryBudget(static_cast<uint64_t>(memoryBudgetMiB) * 1024 * 1024);
+    }
+    if (broadcastSlackMiB > 0) {
+        deviceManager.EnableImageBroadcast(static_cast<uint64_t>(broadcastSlackMiB) * 1024 * 1024);
+    }
+    if (result.count("metrics") && !deviceManager.EnableMetrics(result["metrics"].as<std::string>())) {
+        std::cerr << "Failed to serve metrics on " << result["metrics"].as<std::string>() << std::endl;
+        deviceManager.Shutdown();
+        return -1;
+    }
 
     try {
-        deviceManager.Update(flashImage, bootImagesPath);
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            deviceManager.AddUpdateJob(flashImages[i], bootImagesPath, jobs[i].filterPorts);
+        }
      } catch (const std::exception& e) {
         std::cerr << "Failed to initialize update: " << e.what() << std::endl;
+        deviceManager.Shutdown();
         return -1;
      }
 
+    // Each job reports SHUTDOWN once its devices are done.
+    size_t pendingJobs = jobs.size();
+
+    // Repaints progress on its own thread; null prints simple progress lines.
+    std::unique_ptr<ProgressDisplay> display;
+    if (!simpleProgress) {
+        display = std::make_unique<ProgressDisplay>(tableView ? ProgressDisplay::Mode::Table : ProgressDisplay::Mode::Bars);
+    }
+    auto print = [&display](const std::string &line) {
+        if (display) {
+            display->Print(line);
+        } else {
+            std::cout << line << std::endl;
+        }
+    };
+
     indicators::show_console_cursor(false);
 
     if (running.load()) {
@@ -251,60 +845,69 @@ int main(int argc, char* argv[])
 
             auto status = managerResponses.front();
             managerResponses.pop();
+            // Let the manager queue more responses while this one is shown.
+            lock.unlock();
 
             if (status.IsDeviceManagerResponse()) {
                 auto managerResponse = status.GetDeviceManagerResponse();
-                if (managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_INFO) {
-                    std::cout << managerResponse.m_managerMessage << "\n" << std::endl;
+                if (managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_INFO ||
+                    managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_START)
+                {
+                    print(managerResponse.m_managerMessage);
+                    print("");
                 } else if (managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_SHUTDOWN) {
-                    break;
-                } else if (managerResponse.m_managerStatus == ASTRA_DEVICE_MANAGER_STATUS_START) {
-                    std::cout << managerResponse.m_managerMessage << "\n" << std::endl;
+                    if (--pendingJobs == 0) {
+                        break;
+                    }
                 } else {
-                    std::cout << "Device Manager status: " << managerResponse.m_managerStatus
-                            << " Message: " << managerResponse.m_managerMessage << std::endl;
+                    print("Device Manager status: " + std::to_string(managerResponse.m_managerStatus) +
+                        " Message: " + managerResponse.m_managerMessage);
                 }
+            } else if (status.IsDeviceStatsResponse()) {
+                deviceStats.push_back(status.GetDeviceStatsResponse());
             } else if (status.IsDeviceResponse()) {
                 auto deviceResponse = status.GetDeviceResponse();
+                const bool failed = deviceResponse.m_status == ASTRA_DEVICE_STATUS_BOOT_FAIL ||
+                    deviceResponse.m_status == ASTRA_DEVICE_STATUS_UPDATE_FAIL;
 
-                if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_ADDED) {
-                    std::cout << "Detected Device: " << deviceResponse.m_deviceName << std::endl;
-                } else if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_BOOT_START) {
-                    std::cout << "Booting Device: " << deviceResponse.m_deviceName << std::endl;
-                } else if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_BOOT_COMPLETE) {
-                    std::cout << "Booting " << deviceResponse.m_deviceName << " is complete" << std::endl;
-                } else if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_UPDATE_START) {
-                    std::cout << "Updating Device: " << deviceResponse.m_deviceName << std::endl;
-                } else if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_UPDATE_COMPLETE) {
-                    std::cout << "Device: " << deviceResponse.m_deviceName << " Update Complete" << std::endl;
-                } else if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_BOOT_FAIL) {
-                    std::cout << "Device: " << deviceResponse.m_deviceName << " Boot Failed: " << deviceResponse.m_message << std::endl;
-                    if (continuous && exitOnError) {
-                        running.store(false);
-                        break;
-                    }
-                } else if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_UPDATE_FAIL) {
-                    std::cout << "Device: " << deviceResponse.m_deviceName << " Update Failed: " << deviceResponse.m_message << std::endl;
-                    if (continuous && exitOnError) {
-                        running.store(false);
-                        break;
-                    }
+                if (display) {
+                    display->Update(deviceResponse);
                 } else if (deviceResponse.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_START ||
                     deviceResponse.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS ||
                     deviceResponse.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE)
                 {
-                    if (simpleProgress) {
-                        UpdateSimpleProgress(deviceResponse);
-                    } else {
-                        UpdateProgressBars(deviceResponse, dynamicProgress, progressBars);
-                    }
+                    UpdateSimpleProgress(deviceResponse);
+                }
+
+                // The table shows each device's state; only failures go to the scrollback.
+                const std::string message = DeviceStatusMessage(deviceResponse);
+                if (!message.empty() && (!tableView || failed)) {
+                    print(message);
+                }
+
+                if (failed && continuous && exitOnError) {
+                    running.store(false);
+                    break;
                 }
             }
         }
     }
+    if (display) {
+        display->Stop();
+    }
     indicators::show_console_cursor(true);
 
-    if (deviceManager.Shutdown()) {
+    PrintTransferSummary(deviceStats);
+
+    const bool failed = deviceManager.Shutdown();
+    PrintHubSummary(deviceManager.GetBusTransferStats());
+    if (trace) {
+        std::cout << "Trace written to: " << deviceManager.GetTraceFile() << std::endl;
+    }
+    if (profile) {
+        std::cout << "Profile written to: " << deviceManager.GetProfileFile() << std::endl;
+    }
+    if (failed) {
         std::cerr << "Error reported: please check the log file for more information: " << deviceManager.GetLogFile() << std::endl;
         return -1;
     }
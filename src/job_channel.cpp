@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "job_channel.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#if !defined(PLATFORM_WINDOWS)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if defined(PLATFORM_WINDOWS)
+
+JobChannel::~JobChannel()
+{
+    if (m_pipe != INVALID_HANDLE_VALUE) {
+        CancelIo(m_pipe);
+        if (m_connected) {
+            DisconnectNamedPipe(m_pipe);
+        }
+        CloseHandle(m_pipe);
+    }
+    if (m_event != NULL) {
+        CloseHandle(m_event);
+    }
+}
+
+bool JobChannel::Listen(const std::string &path)
+{
+    m_path = path;
+
+    m_event = CreateEventA(NULL, TRUE, FALSE, NULL);
+    if (m_event == NULL) {
+        std::cerr << "Failed to create pipe event: " << GetLastError() << std::endl;
+        return false;
+    }
+
+    // One instance: jobs are served one client at a time.
+    m_pipe = CreateNamedPipeA(path.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        1, kReadBlockSize, kReadBlockSize, 0, NULL);
+    if (m_pipe == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to create named pipe " << path << ": " << GetLastError() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool JobChannel::WaitForClient(int timeoutMs)
+{
+    if (m_connected) {
+        return true;
+    }
+
+    if (!m_connectPending) {
+        ResetEvent(m_event);
+        m_overlapped = OVERLAPPED{};
+        m_overlapped.hEvent = m_event;
+        if (ConnectNamedPipe(m_pipe, &m_overlapped)) {
+            m_connected = true;
+            return true;
+        }
+
+        const DWORD error = GetLastError();
+        if (error == ERROR_PIPE_CONNECTED) {
+            m_connected = true;
+            return true;
+        }
+        if (error != ERROR_IO_PENDING) {
+            std::cerr << "Failed to wait for a client on " << m_path << ": " << error << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return false;
+        }
+        m_connectPending = true;
+    }
+
+    if (WaitForSingleObject(m_event, static_cast<DWORD>(timeoutMs)) != WAIT_OBJECT_0) {
+        return false;
+    }
+
+    DWORD transferred = 0;
+    m_connectPending = false;
+    m_connected = GetOverlappedResult(m_pipe, &m_overlapped, &transferred, FALSE) != FALSE;
+    return m_connected;
+}
+
+bool JobChannel::HasClient() const
+{
+    return m_connected;
+}
+
+int JobChannel::CompleteTransfer(BOOL started)
+{
+    if (!started && GetLastError() != ERROR_IO_PENDING) {
+        return -1;
+    }
+
+    DWORD transferred = 0;
+    if (!GetOverlappedResult(m_pipe, &m_overlapped, &transferred, TRUE)) {
+        return -1;
+    }
+    return static_cast<int>(transferred);
+}
+
+bool JobChannel::Poll(int timeoutMs)
+{
+    if (!m_connected) {
+        return false;
+    }
+
+    // Pipes cannot be waited on for readability, so peek until input arrives.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        DWORD available = 0;
+        if (!PeekNamedPipe(m_pipe, NULL, 0, NULL, &available, NULL)) {
+            return false;
+        }
+
+        if (available > 0) {
+            char buffer[kReadBlockSize];
+            ResetEvent(m_event);
+            m_overlapped = OVERLAPPED{};
+            m_overlapped.hEvent = m_event;
+            const DWORD toRead = std::min<DWORD>(available, sizeof(buffer));
+            const int bytesRead = CompleteTransfer(ReadFile(m_pipe, buffer, toRead, NULL, &m_overlapped));
+            if (bytesRead <= 0) {
+                return false;
+            }
+            BufferInput(buffer, static_cast<size_t>(bytesRead));
+            return true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - now,
+            std::chrono::milliseconds(10)));
+    }
+}
+
+bool JobChannel::WriteLine(const std::string &line)
+{
+    if (!m_connected) {
+        return false;
+    }
+
+    const std::string data = line + "\n";
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ResetEvent(m_event);
+        m_overlapped = OVERLAPPED{};
+        m_overlapped.hEvent = m_event;
+        const int written = CompleteTransfer(WriteFile(m_pipe, data.data() + offset,
+            static_cast<DWORD>(data.size() - offset), NULL, &m_overlapped));
+        if (written <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void JobChannel::CloseClient()
+{
+    if (m_connected) {
+        FlushFileBuffers(m_pipe);
+        DisconnectNamedPipe(m_pipe);
+        m_connected = false;
+    }
+    m_input.clear();
+}
+
+#else
+
+JobChannel::~JobChannel()
+{
+    CloseClient();
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        unlink(m_path.c_str());
+    }
+}
+
+bool JobChannel::Listen(const std::string &path)
+{
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid daemon socket path: " << path << std::endl;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // A previous daemon that did not exit cleanly leaves its socket behind.
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path.c_str());
+    }
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenFd < 0) {
+        std::cerr << "Failed to create daemon socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        listen(m_listenFd, 4) < 0)
+    {
+        std::cerr << "Failed to listen on " << path << ": " << strerror(errno) << std::endl;
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    m_path = path;
+    return true;
+}
+
+bool JobChannel::WaitForClient(int timeoutMs)
+{
+    if (m_clientFd >= 0) {
+        return true;
+    }
+
+    pollfd pfd{m_listenFd, POLLIN, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0) {
+        return false;
+    }
+
+    m_clientFd = accept(m_listenFd, nullptr, nullptr);
+    if (m_clientFd < 0) {
+        return false;
+    }
+#if defined(SO_NOSIGPIPE)
+    int noSigPipe = 1;
+    setsockopt(m_clientFd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+    return true;
+}
+
+bool JobChannel::HasClient() const
+{
+    return m_clientFd >= 0;
+}
+
+bool JobChannel::Poll(int timeoutMs)
+{
+    if (m_clientFd < 0) {
+        return false;
+    }
+
+    pollfd pfd{m_clientFd, POLLIN, 0};
+    const int ret = poll(&pfd, 1, timeoutMs);
+    if (ret < 0) {
+        return errno == EINTR;
+    }
+    if (ret == 0) {
+        return true;
+    }
+
+    char buffer[kReadBlockSize];
+    const ssize_t bytesRead = recv(m_clientFd, buffer, sizeof(buffer), 0);
+    if (bytesRead < 0) {
+        return errno == EINTR || errno == EAGAIN;
+    }
+    if (bytesRead == 0) {
+        return false;
+    }
+    BufferInput(buffer, static_cast<size_t>(bytesRead));
+    return true;
+}
+
+bool JobChannel::WriteLine(const std::string &line)
+{
+    if (m_clientFd < 0) {
+        return false;
+    }
+
+#if defined(MSG_NOSIGNAL)
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    const std::string data = line + "\n";
+    size_t offset = 0;
+    while (offset < data.size()) {
+        const ssize_t written = send(m_clientFd, data.data() + offset, data.size() - offset, flags);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void JobChannel::CloseClient()
+{
+    if (m_clientFd >= 0) {
+        close(m_clientFd);
+        m_clientFd = -1;
+    }
+    m_input.clear();
+}
+
+#endif
+
+void JobChannel::BufferInput(const char *data, size_t size)
+{
+    m_input.append(data, size);
+
+    // A client which never ends its line must not grow the buffer forever.
+    const size_t lastLineEnd = m_input.rfind('\n');
+    const size_t lastLineStart = lastLineEnd == std::string::npos ? 0 : lastLineEnd + 1;
+    if (m_input.size() - lastLineStart > kMaxLineSize + 1) {
+        m_input.resize(lastLineStart + kMaxLineSize + 1);
+    }
+}
+
+bool JobChannel::HasOversizedLine() const
+{
+    return std::min(m_input.find('\n'), m_input.size()) > kMaxLineSize;
+}
+
+bool JobChannel::ReadLine(std::string &line)
+{
+    const size_t end = m_input.find('\n');
+    if (end == std::string::npos) {
+        return false;
+    }
+
+    line = m_input.substr(0, end);
+    m_input.erase(0, end + 1);
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <string>
+
+#if defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+/**
+ * Local, line-oriented connection between the astra-update daemon and one
+ * client at a time: a Unix domain socket, or a named pipe such as
+ * \\.\pipe\astra-update on Windows.  Every call takes a timeout so the
+ * daemon can keep servicing the device manager while it waits.
+ */
+class JobChannel
+{
+public:
+    JobChannel() = default;
+    ~JobChannel();
+
+    JobChannel(const JobChannel &) = delete;
+    JobChannel &operator=(const JobChannel &) = delete;
+
+    /** Create the socket or pipe at path, replacing a stale socket file. */
+    bool Listen(const std::string &path);
+
+    /** Wait up to timeoutMs for a client.  @return true once one is connected. */
+    bool WaitForClient(int timeoutMs);
+
+    bool HasClient() const;
+
+    /**
+     * Wait up to timeoutMs for input and buffer whatever arrived.
+     * @return false once the client has disconnected.
+     */
+    bool Poll(int timeoutMs);
+
+    /** Take one buffered line, without its line ending.  @return false if none is complete. */
+    bool ReadLine(std::string &line);
+
+    /**
+     * True if the next line is longer than kMaxLineSize, complete or not.
+     * Input past that is dropped; the client should be turned away.
+     */
+    bool HasOversizedLine() const;
+
+    static constexpr size_t kMaxLineSize = 64 * 1024;
+
+    /** Send line and a newline.  @return false if the client has gone. */
+    bool WriteLine(const std::string &line);
+
+    void CloseClient();
+
+private:
+    static constexpr size_t kReadBlockSize = 4096;
+
+    /** Append data to m_input, keeping at most kMaxLineSize + 1 bytes of its last line. */
+    void BufferInput(const char *data, size_t size);
+
+    std::string m_path;
+    std::string m_input;
+#if defined(PLATFORM_WINDOWS)
+    HANDLE m_pipe = INVALID_HANDLE_VALUE;
+    HANDLE m_event = NULL;
+    OVERLAPPED m_overlapped{};
+    bool m_connectPending = false;
+    bool m_connected = false;
+
+    /** Run an overlapped read or write to completion.  @return the bytes moved, or -1. */
+    int CompleteTransfer(BOOL started);
+#else
+    int m_listenFd = -1;
+    int m_clientFd = -1;
+#endif
+};
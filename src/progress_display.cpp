@@ -0,0 +1,295 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#include "progress_display.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <indicators/cursor_movement.hpp>
+#include <indicators/dynamic_progress.hpp>
+#include <indicators/progress_bar.hpp>
+#include <indicators/terminal_size.hpp>
+
+struct ProgressDisplay::Bars
+{
+    indicators::DynamicProgress<indicators::ProgressBar> m_dynamicProgress;
+    // The bars are owned by m_dynamicProgress; their addresses are stable.
+    std::map<std::string, indicators::ProgressBar *> m_bars;
+};
+
+ProgressDisplay::ProgressDisplay(Mode mode) : m_mode{mode}
+{
+    if (m_mode == Mode::Bars) {
+        m_bars = std::make_unique<Bars>();
+        m_bars->m_dynamicProgress.set_option(indicators::option::HideBarWhenComplete{false});
+    }
+    // The renderer is the application's thread, not the library's, so
+    // --thread-policy, which sets the library's ThreadPolicy, leaves it as
+    // it is: terminal output should not compete with the USB threads.
+    m_thread = std::thread(&ProgressDisplay::RenderThread, this);
+}
+
+ProgressDisplay::~ProgressDisplay()
+{
+    Stop();
+}
+
+void ProgressDisplay::Update(const DeviceResponse &response)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const bool imageEvent = response.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_START ||
+        response.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS ||
+        response.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE;
+
+    if (m_mode == Mode::Bars) {
+        if (!imageEvent) {
+            return;
+        }
+        ImageProgress &image = m_images[response.m_deviceName + "\n" + response.m_imageName];
+        image.m_deviceName = response.m_deviceName;
+        image.m_imageName = response.m_imageName;
+        image.m_progress = response.m_progress;
+        image.m_changed = true;
+        m_dirty = true;
+        return;
+    }
+
+    DeviceRow &row = m_devices[response.m_deviceName];
+    if (response.m_status == ASTRA_DEVICE_STATUS_ADDED) {
+        // Continuous mode serves the next board on a port under the same name.
+        row = DeviceRow{};
+    }
+    if (imageEvent || response.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL) {
+        row.m_imageName = response.m_imageName;
+        row.m_progress = response.m_progress;
+    }
+    if (response.m_status != ASTRA_DEVICE_STATUS_IMAGE_SEND_PROGRESS &&
+        response.m_status != ASTRA_DEVICE_STATUS_IMAGE_SEND_COMPLETE)
+    {
+        row.m_status = response.m_status;
+    }
+    if (!response.m_message.empty()) {
+        row.m_message = response.m_message;
+    }
+    m_dirty = true;
+}
+
+void ProgressDisplay::Print(const std::string &line)
+{
+    if (m_mode == Mode::Bars) {
+        std::lock_guard<std::mutex> lock(m_paintMutex);
+        std::cout << line << std::endl;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_messages.push_back(line);
+    m_dirty = true;
+}
+
+void ProgressDisplay::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void ProgressDisplay::RenderThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait_for(lock, kFrameInterval, [this]() { return m_stop; });
+        const bool stop = m_stop;
+
+        if (m_dirty) {
+            m_dirty = false;
+            std::vector<std::string> messages;
+            messages.swap(m_messages);
+            lock.unlock();
+            if (m_mode == Mode::Bars) {
+                RenderBars();
+            } else {
+                RenderTable(messages);
+            }
+            lock.lock();
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+}
+
+void ProgressDisplay::RenderBars()
+{
+    std::vector<ImageProgress> changed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &[key, image] : m_images) {
+            if (image.m_changed) {
+                changed.push_back(image);
+                image.m_changed = false;
+            }
+        }
+    }
+    if (changed.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_paintMutex);
+    for (const auto &image : changed) {
+        const std::string key = image.m_deviceName + "\n" + image.m_imageName;
+        auto it = m_bars->m_bars.find(key);
+        if (it == m_bars->m_bars.end()) {
+            auto progressBar = std::make_unique<indicators::ProgressBar>(
+                indicators::option::BarWidth{50},
+                indicators::option::Start{"["},
+                indicators::option::Fill{"="},
+                indicators::option::Lead{">"},
+                indicators::option::Remainder{" "},
+                indicators::option::End{"]"},
+                indicators::option::PostfixText{image.m_imageName},
+                indicators::option::PrefixText{image.m_deviceName + ": "},
+                indicators::option::ForegroundColor{indicators::Color::green},
+                indicators::option::ShowElapsedTime{true},
+                indicators::option::ShowRemainingTime{true},
+                indicators::option::MaxProgress{100}
+            );
+            indicators::ProgressBar *bar = progressBar.get();
+            m_bars->m_dynamicProgress.push_back(std::move(progressBar));
+            it = m_bars->m_bars.emplace(key, bar).first;
+        }
+
+        // Bars owned by a DynamicProgress do not draw themselves.
+        it->second->set_progress(image.m_progress);
+        if (image.m_progress >= 100) {
+            it->second->mark_as_completed();
+        }
+    }
+
+    // Indexing the DynamicProgress redraws all of its bars, once per frame.
+    m_bars->m_dynamicProgress[0];
+}
+
+void ProgressDisplay::RenderTable(std::vector<std::string> &messages)
+{
+    std::map<std::string, DeviceRow> devices;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        devices = m_devices;
+    }
+
+    size_t nameWidth = 0;
+    size_t booting = 0;
+    size_t updating = 0;
+    size_t complete = 0;
+    size_t failed = 0;
+    for (const auto &[deviceName, row] : devices) {
+        nameWidth = std::max(nameWidth, deviceName.size());
+        switch (row.m_status) {
+        case ASTRA_DEVICE_STATUS_UPDATE_COMPLETE:
+            ++complete;
+            break;
+        case ASTRA_DEVICE_STATUS_BOOT_FAIL:
+        case ASTRA_DEVICE_STATUS_UPDATE_FAIL:
+            ++failed;
+            break;
+        case ASTRA_DEVICE_STATUS_ADDED:
+        case ASTRA_DEVICE_STATUS_BOOT_START:
+        case ASTRA_DEVICE_STATUS_BOOT_PROGRESS:
+            ++booting;
+            break;
+        default:
+            ++updating;
+            break;
+        }
+    }
+
+    std::vector<std::string> lines = std::move(messages);
+    if (!devices.empty()) {
+        std::ostringstream summary;
+        summary << devices.size() << " device(s): " << booting << " booting, " << updating << " updating, "
+                << complete << " complete, " << failed << " failed";
+        lines.push_back(summary.str());
+        for (const auto &[deviceName, row] : devices) {
+            lines.push_back(FormatRow(deviceName, row, nameWidth));
+        }
+    }
+
+    // Keep every line on one terminal row so moving up by the line count
+    // lands on the start of the table.
+    size_t width = indicators::terminal_width();
+    width = width > 1 ? width - 1 : 79;
+
+    std::lock_guard<std::mutex> lock(m_paintMutex);
+    std::string frame;
+    for (const auto &line : lines) {
+        std::string text = line.substr(0, width);
+        text.resize(width, ' ');
+        frame += text + "\n";
+    }
+    if (m_tableLines > 0) {
+        indicators::move_up(static_cast<int>(m_tableLines));
+    }
+    std::cout << frame << std::flush;
+    m_tableLines = devices.empty() ? 0 : devices.size() + 1;
+}
+
+std::string ProgressDisplay::FormatRow(const std::string &deviceName, const DeviceRow &row, size_t nameWidth) const
+{
+    std::string state;
+    switch (row.m_status) {
+    case ASTRA_DEVICE_STATUS_ADDED:
+    case ASTRA_DEVICE_STATUS_OPENED:
+        state = "detected";
+        break;
+    case ASTRA_DEVICE_STATUS_BOOT_START:
+    case ASTRA_DEVICE_STATUS_BOOT_PROGRESS:
+        state = "booting";
+        break;
+    case ASTRA_DEVICE_STATUS_BOOT_COMPLETE:
+        state = "booted";
+        break;
+    case ASTRA_DEVICE_STATUS_IMAGE_SEND_START:
+        state = "sending";
+        break;
+    case ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL:
+        state = "retrying";
+        break;
+    case ASTRA_DEVICE_STATUS_UPDATE_COMPLETE:
+        state = "complete";
+        break;
+    case ASTRA_DEVICE_STATUS_BOOT_FAIL:
+    case ASTRA_DEVICE_STATUS_UPDATE_FAIL:
+        state = "FAILED";
+        break;
+    case ASTRA_DEVICE_STATUS_CLOSED:
+        state = "closed";
+        break;
+    default:
+        state = "updating";
+        break;
+    }
+
+    const size_t filled = static_cast<size_t>(std::clamp(row.m_progress, 0.0, 100.0) * kBarWidth / 100);
+    std::ostringstream line;
+    line << std::left << std::setw(static_cast<int>(nameWidth)) << deviceName << "  "
+         << std::setw(9) << state << " "
+         << std::setw(static_cast<int>(kImageColumnWidth)) << row.m_imageName.substr(0, kImageColumnWidth) << " ["
+         << std::string(filled, '=') << std::string(kBarWidth - filled, ' ') << "] "
+         << std::right << std::fixed << std::setprecision(1) << std::setw(5) << row.m_progress << "%";
+    if (!row.m_message.empty() && (row.m_status == ASTRA_DEVICE_STATUS_BOOT_FAIL ||
+        row.m_status == ASTRA_DEVICE_STATUS_UPDATE_FAIL || row.m_status == ASTRA_DEVICE_STATUS_IMAGE_SEND_FAIL))
+    {
+        line << "  " << row.m_message;
+    }
+    return line.str();
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 Synaptics Incorporated
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "astra_device.hpp"
+
+/**
+ * Console view of the devices' progress, repainted by its own thread at a
+ * fixed frame rate from the latest recorded state.  Recording a response
+ * only updates that state, so the response loop never waits on the
+ * terminal, and a frame redraws once however many responses arrived.
+ *
+ * Bars shows one progress bar per device and image.  Table keeps one line
+ * per device, rewritten in place, and suits a station with dozens of boards.
+ */
+class ProgressDisplay
+{
+public:
+    enum class Mode {
+        Bars,
+        Table,
+    };
+
+    explicit ProgressDisplay(Mode mode);
+    ~ProgressDisplay();
+
+    ProgressDisplay(const ProgressDisplay &) = delete;
+    ProgressDisplay &operator=(const ProgressDisplay &) = delete;
+
+    void Update(const DeviceResponse &response);
+
+    /** Print a message line, above the table in table mode. */
+    void Print(const std::string &line);
+
+    /** Paint the final frame and stop the render thread. */
+    void Stop();
+
+private:
+    static constexpr std::chrono::milliseconds kFrameInterval{100};
+    static constexpr size_t kBarWidth = 20;
+    static constexpr size_t kImageColumnWidth = 24;
+
+    struct ImageProgress
+    {
+        std::string m_deviceName;
+        std::string m_imageName;
+        double m_progress = 0;
+        bool m_changed = true;
+    };
+
+    struct DeviceRow
+    {
+        AstraDeviceStatus m_status = ASTRA_DEVICE_STATUS_ADDED;
+        std::string m_imageName;
+        double m_progress = 0;
+        std::string m_message;
+    };
+
+    void RenderThread();
+    void RenderBars();
+    void RenderTable(std::vector<std::string> &messages);
+    std::string FormatRow(const std::string &deviceName, const DeviceRow &row, size_t nameWidth) const;
+
+    const Mode m_mode;
+
+    // State recorded by Update() and Print(), guarded by m_mutex.
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<std::string, ImageProgress> m_images;  // by device name and image name
+    std::map<std::string, DeviceRow> m_devices;
+    std::vector<std::string> m_messages;
+    bool m_dirty = false;
+    bool m_stop = false;
+
+    // Owned by the render thread, and by Print() in bars mode under m_paintMutex.
+    std::mutex m_paintMutex;
+    size_t m_tableLines = 0;
+
+    struct Bars;
+    std::unique_ptr<Bars> m_bars;
+
+    std::thread m_thread;
+};